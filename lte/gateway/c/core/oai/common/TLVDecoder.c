@@ -26,6 +26,7 @@
 
 #include "lte/gateway/c/core/oai/lib/bstr/bstrlib.h"
 #include "lte/gateway/c/core/oai/common/TLVDecoder.h"
+#include "lte/gateway/c/core/oai/common/nas_decode_arena.h"
 
 int errorCodeDecoder = 0;
 
@@ -37,7 +38,12 @@ int decode_bstring(bstring* bstr, const uint16_t pdulen,
   }
 
   if ((bstr) && (buffer)) {
-    *bstr = blk2bstr(buffer, pdulen);
+    nas_decode_arena_t* arena = nas_decode_arena_current();
+    if (arena) {
+      *bstr = nas_decode_arena_slice(arena, buffer, pdulen);
+    } else {
+      *bstr = blk2bstr(buffer, pdulen);
+    }
     return pdulen;
   } else {
     return TLV_BUFFER_TOO_SHORT;
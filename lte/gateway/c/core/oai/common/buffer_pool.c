@@ -0,0 +1,184 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "lte/gateway/c/core/oai/common/assertions.h"
+#include "lte/gateway/c/core/oai/common/buffer_pool.h"
+
+typedef struct buffer_hdr_s {
+  buffer_pool_t* pool;
+  struct buffer_hdr_s* next;
+  bool from_slab;
+} buffer_hdr_t;
+
+// Keep the payload 16 bytes aligned so it can be cast to protocol headers
+#define BUFFER_HDR_SIZE ((sizeof(buffer_hdr_t) + 15) & ~((size_t)15))
+#define BUFFER_HDR(bUF) ((buffer_hdr_t*)((uint8_t*)(bUF)-BUFFER_HDR_SIZE))
+#define BUFFER_DATA(hDR) ((uint8_t*)(hDR) + BUFFER_HDR_SIZE)
+
+struct buffer_pool_s {
+  pthread_mutex_t lock;
+  uint8_t* slab;
+  size_t buffer_size;
+  size_t stride;
+  buffer_hdr_t* free_list;
+  uint32_t capacity;
+  uint32_t available;
+  uint32_t outstanding;
+  uint64_t overflow;
+  bool destroyed;
+};
+
+//------------------------------------------------------------------------------
+buffer_pool_t* buffer_pool_create(size_t buffer_size, uint32_t num_buffers) {
+  buffer_pool_t* pool = calloc(1, sizeof(buffer_pool_t));
+  DevAssert(pool != NULL);
+  pthread_mutex_init(&pool->lock, NULL);
+  pool->buffer_size = buffer_size;
+  pool->stride = (BUFFER_HDR_SIZE + buffer_size + 15) & ~((size_t)15);
+  pool->capacity = num_buffers;
+  pool->available = num_buffers;
+
+  if (num_buffers) {
+    pool->slab = calloc(num_buffers, pool->stride);
+    DevAssert(pool->slab != NULL);
+  }
+  // Thread the free list so that the first buffers handed out are the first
+  // ones in the slab; that keeps a lightly loaded pool cache friendly.
+  for (uint32_t i = num_buffers; i > 0; i--) {
+    buffer_hdr_t* hdr = (buffer_hdr_t*)(pool->slab + (i - 1) * pool->stride);
+    hdr->pool = pool;
+    hdr->from_slab = true;
+    hdr->next = pool->free_list;
+    pool->free_list = hdr;
+  }
+  return pool;
+}
+
+//------------------------------------------------------------------------------
+static void buffer_pool_free(buffer_pool_t* pool) {
+  pthread_mutex_destroy(&pool->lock);
+  free(pool->slab);
+  free(pool);
+}
+
+//------------------------------------------------------------------------------
+void buffer_pool_destroy(buffer_pool_t* pool) {
+  if (!pool) return;
+  pthread_mutex_lock(&pool->lock);
+  bool release_now = (pool->outstanding == 0);
+  pool->destroyed = true;
+  pthread_mutex_unlock(&pool->lock);
+  if (release_now) {
+    buffer_pool_free(pool);
+  }
+}
+
+//------------------------------------------------------------------------------
+size_t buffer_pool_buffer_size(const buffer_pool_t* pool) {
+  return pool->buffer_size;
+}
+
+//------------------------------------------------------------------------------
+void buffer_pool_get_bulk(buffer_pool_t* pool, uint8_t** buffers,
+                          uint32_t count) {
+  uint32_t taken = 0;
+
+  pthread_mutex_lock(&pool->lock);
+  while (taken < count && pool->free_list) {
+    buffer_hdr_t* hdr = pool->free_list;
+    pool->free_list = hdr->next;
+    hdr->next = NULL;
+    buffers[taken++] = BUFFER_DATA(hdr);
+  }
+  pool->available -= taken;
+  pool->overflow += count - taken;
+  pool->outstanding += count;
+  pthread_mutex_unlock(&pool->lock);
+
+  // Slab exhausted, do not make the caller deal with it
+  for (; taken < count; taken++) {
+    buffer_hdr_t* hdr = malloc(BUFFER_HDR_SIZE + pool->buffer_size);
+    DevAssert(hdr != NULL);
+    hdr->pool = pool;
+    hdr->next = NULL;
+    hdr->from_slab = false;
+    buffers[taken] = BUFFER_DATA(hdr);
+  }
+}
+
+//------------------------------------------------------------------------------
+uint8_t* buffer_pool_get(buffer_pool_t* pool) {
+  uint8_t* buffer = NULL;
+  buffer_pool_get_bulk(pool, &buffer, 1);
+  return buffer;
+}
+
+//------------------------------------------------------------------------------
+void buffer_pool_put_bulk(uint8_t** buffers, uint32_t count) {
+  buffer_pool_t* pool = NULL;
+  buffer_hdr_t* heap_list = NULL;
+  uint32_t returned = 0;
+
+  for (uint32_t i = 0; i < count; i++) {
+    if (buffers[i]) {
+      pool = BUFFER_HDR(buffers[i])->pool;
+      break;
+    }
+  }
+  if (!pool) return;
+
+  pthread_mutex_lock(&pool->lock);
+  for (uint32_t i = 0; i < count; i++) {
+    if (!buffers[i]) continue;
+    buffer_hdr_t* hdr = BUFFER_HDR(buffers[i]);
+    DevAssert(hdr->pool == pool);
+    if (hdr->from_slab) {
+      hdr->next = pool->free_list;
+      pool->free_list = hdr;
+      pool->available++;
+    } else {
+      hdr->next = heap_list;
+      heap_list = hdr;
+    }
+    returned++;
+  }
+  pool->outstanding -= returned;
+  bool release_pool = pool->destroyed && (pool->outstanding == 0);
+  pthread_mutex_unlock(&pool->lock);
+
+  while (heap_list) {
+    buffer_hdr_t* next = heap_list->next;
+    free(heap_list);
+    heap_list = next;
+  }
+  if (release_pool) {
+    buffer_pool_free(pool);
+  }
+}
+
+//------------------------------------------------------------------------------
+void buffer_pool_put(uint8_t* buffer) { buffer_pool_put_bulk(&buffer, 1); }
+
+//------------------------------------------------------------------------------
+void buffer_pool_get_stats(buffer_pool_t* pool, buffer_pool_stats_t* stats) {
+  pthread_mutex_lock(&pool->lock);
+  stats->capacity = pool->capacity;
+  stats->available = pool->available;
+  stats->overflow = pool->overflow;
+  stats->outstanding = pool->outstanding;
+  pthread_mutex_unlock(&pool->lock);
+}
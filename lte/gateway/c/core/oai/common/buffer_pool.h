@@ -0,0 +1,77 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Fixed size buffer pool shared between threads.
+ *
+ * Buffers are carved out of a single slab at creation time. A buffer is
+ * taken by one thread (e.g. the UDP task filling a receive ring) and may be
+ * returned by another one (e.g. the S11 task once it has freed the ITTI
+ * message referencing it), so the free list is protected by a mutex that is
+ * taken once per bulk operation.
+ *
+ * When the slab is exhausted the pool falls back to heap allocated buffers of
+ * the same size, so callers never have to handle an allocation failure on
+ * the fast path. Those buffers are freed instead of being recycled when they
+ * are returned.
+ */
+typedef struct buffer_pool_s buffer_pool_t;
+
+typedef struct buffer_pool_stats_s {
+  uint32_t capacity;     /* Number of buffers in the slab */
+  uint32_t available;    /* Slab buffers currently on the free list */
+  uint64_t overflow;     /* Heap fallbacks since creation */
+  uint32_t outstanding;  /* Buffers (slab or heap) not yet returned */
+} buffer_pool_stats_t;
+
+/* Create a pool of num_buffers buffers of buffer_size bytes each. */
+buffer_pool_t* buffer_pool_create(size_t buffer_size, uint32_t num_buffers);
+
+/*
+ * Release the pool. Buffers still held by other tasks stay valid; the slab
+ * is freed once the last of them is returned.
+ */
+void buffer_pool_destroy(buffer_pool_t* pool);
+
+size_t buffer_pool_buffer_size(const buffer_pool_t* pool);
+
+/* Take one buffer. Never returns NULL. */
+uint8_t* buffer_pool_get(buffer_pool_t* pool);
+
+/* Fill buffers[0..count) under a single lock acquisition. */
+void buffer_pool_get_bulk(buffer_pool_t* pool, uint8_t** buffers,
+                          uint32_t count);
+
+/* Return a buffer to the pool it was taken from. NULL is ignored. */
+void buffer_pool_put(uint8_t* buffer);
+
+/*
+ * Return buffers[0..count), which must all come from the same pool, under a
+ * single lock acquisition. NULL entries are ignored.
+ */
+void buffer_pool_put_bulk(uint8_t** buffers, uint32_t count);
+
+void buffer_pool_get_stats(buffer_pool_t* pool, buffer_pool_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -415,6 +415,8 @@ typedef struct partial_list_s {
 } partial_list_t;
 
 typedef enum {
+  // Returned by subscriberdb, reported as experimental over gRPC
+  DIAMETER_AUTHENTICATION_REJECTED = 4001,
   DIAMETER_AUTHENTICATION_DATA_UNAVAILABLE = 4181,
   DIAMETER_ERROR_USER_UNKNOWN = 5001,
   DIAMETER_ERROR_ROAMING_NOT_ALLOWED = 5004,
@@ -422,6 +424,8 @@ typedef enum {
   DIAMETER_ERROR_RAT_NOT_ALLOWED = 5421,
   DIAMETER_ERROR_EQUIPMENT_UNKNOWN = 5422,
   DIAMETER_ERROR_UNKOWN_SERVING_NODE = 5423,
+  // Returned by subscriberdb, reported as experimental over gRPC
+  DIAMETER_ERROR_UNAUTHORIZED_SERVICE = 5511,
 } s6a_experimental_result_t;
 
 typedef enum {
@@ -26,6 +26,7 @@
 
 #include "lte/gateway/c/core/oai/common/dynamic_memory_check.h"
 #include "lte/gateway/c/core/oai/common/assertions.h"
+#include "lte/gateway/c/core/oai/common/buffer_pool.h"
 #include "lte/gateway/c/core/oai/lib/3gpp/3gpp_24.008.h"
 #include "lte/gateway/c/core/oai/lib/3gpp/3gpp_36.413.h"
 #include "lte/gateway/c/core/oai/lib/itti/intertask_interface.h"
@@ -239,6 +240,8 @@ void itti_free_msg_content(MessageDef* const message_p) {
 
     case SCTP_DATA_REQ:
       bdestroy_wrapper(&message_p->ittiMsg.sctp_data_req.payload);
+      shared_buffer_unref(message_p->ittiMsg.sctp_data_req.shared_payload);
+      message_p->ittiMsg.sctp_data_req.shared_payload = NULL;
       break;
 
     case SCTP_DATA_IND:
@@ -254,6 +257,11 @@ void itti_free_msg_content(MessageDef* const message_p) {
       // DO nothing
       break;
 
+    case UDP_DATA_IND:
+      buffer_pool_put(message_p->ittiMsg.udp_data_ind.msgBuf);
+      message_p->ittiMsg.udp_data_ind.msgBuf = NULL;
+      break;
+
     // AMF and NGAP Clean up messages
     case NGAP_INITIAL_UE_MESSAGE:
       bdestroy(NGAP_INITIAL_UE_MESSAGE(message_p).nas);
@@ -50,6 +50,9 @@
  ******************************************************************************/
 
 #define S6A_CONF_FILE "../S6A/freediameter/s6a.conf"
+#define S6A_LOCAL_HSS_STORE_FILE "/var/opt/magma/mme_subscribers.store"
+#define S6A_LOCAL_HSS_SYNC_INTERVAL_SEC (60)
+#define S6A_LOCAL_HSS_AMF "8000"
 
 /*******************************************************************************
  * SCTP Constants
@@ -0,0 +1,137 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lte/gateway/c/core/oai/common/assertions.h"
+#include "lte/gateway/c/core/oai/common/nas_decode_arena.h"
+
+struct nas_decode_arena_chunk_s {
+  nas_decode_arena_chunk_t* next;
+  size_t size;
+  size_t used;
+  uint8_t data[] __attribute__((aligned(16)));
+};
+
+#define ARENA_ALIGN(sIZE) (((sIZE) + 15) & ~((size_t)15))
+
+// Borrowed strings are marked like bstrlib marks its static strings
+#define BORROWED_MLEN (-1)
+
+static __thread nas_decode_arena_t* current_arena = NULL;
+
+//------------------------------------------------------------------------------
+void nas_decode_arena_init(nas_decode_arena_t* arena) {
+  arena->inline_used = 0;
+  arena->chunks = NULL;
+  arena->allocations = 0;
+  arena->heap_allocations = 0;
+  arena->previous = NULL;
+}
+
+//------------------------------------------------------------------------------
+void* nas_decode_arena_alloc(nas_decode_arena_t* arena, size_t size) {
+  size = ARENA_ALIGN(size ? size : 1);
+  arena->allocations++;
+
+  if (arena->inline_used + size <= NAS_DECODE_ARENA_INLINE_SIZE) {
+    void* ptr = &arena->inline_buffer[arena->inline_used];
+    arena->inline_used += size;
+    return ptr;
+  }
+
+  nas_decode_arena_chunk_t* chunk = arena->chunks;
+  if (!chunk || chunk->used + size > chunk->size) {
+    size_t chunk_size = size > NAS_DECODE_ARENA_CHUNK_SIZE
+                            ? size
+                            : NAS_DECODE_ARENA_CHUNK_SIZE;
+    chunk = malloc(sizeof(nas_decode_arena_chunk_t) + chunk_size);
+    DevAssert(chunk != NULL);
+    chunk->size = chunk_size;
+    chunk->used = 0;
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    arena->heap_allocations++;
+  }
+  void* ptr = &chunk->data[chunk->used];
+  chunk->used += size;
+  return ptr;
+}
+
+//------------------------------------------------------------------------------
+void nas_decode_arena_release(nas_decode_arena_t* arena) {
+  DevAssert(current_arena != arena);
+  while (arena->chunks) {
+    nas_decode_arena_chunk_t* next = arena->chunks->next;
+    free(arena->chunks);
+    arena->chunks = next;
+  }
+  arena->inline_used = 0;
+}
+
+//------------------------------------------------------------------------------
+bstring nas_decode_arena_slice(nas_decode_arena_t* arena, const uint8_t* data,
+                               int len) {
+  bstring b = nas_decode_arena_alloc(arena, sizeof(struct tagbstring));
+  b->mlen = BORROWED_MLEN;
+  b->slen = len;
+  b->data = (unsigned char*)data;
+  return b;
+}
+
+//------------------------------------------------------------------------------
+bstring nas_decode_arena_copy(nas_decode_arena_t* arena, const uint8_t* data,
+                              int len) {
+  // Keep a terminating NUL like bstrlib does, bdata() users may rely on it
+  uint8_t* copy = nas_decode_arena_alloc(arena, len + 1);
+  if (len > 0) {
+    memcpy(copy, data, len);
+  }
+  copy[len] = '\0';
+  return nas_decode_arena_slice(arena, copy, len);
+}
+
+//------------------------------------------------------------------------------
+void nas_decode_arena_enter(nas_decode_arena_t* arena) {
+  arena->previous = current_arena;
+  current_arena = arena;
+}
+
+//------------------------------------------------------------------------------
+void nas_decode_arena_leave(nas_decode_arena_t* arena) {
+  DevAssert(current_arena == arena);
+  current_arena = arena->previous;
+  arena->previous = NULL;
+}
+
+//------------------------------------------------------------------------------
+nas_decode_arena_t* nas_decode_arena_current(void) { return current_arena; }
+
+//------------------------------------------------------------------------------
+bstring nas_decode_blk2bstr(const void* data, int len) {
+  if (current_arena) {
+    return nas_decode_arena_copy(current_arena, data, len);
+  }
+  return blk2bstr(data, len);
+}
+
+//------------------------------------------------------------------------------
+bstring nas_decode_bstring_own(bstring* b) {
+  bstring owned = *b;
+  if (nas_decode_bstring_is_borrowed(owned)) {
+    owned = blk2bstr(owned->data, owned->slen);
+  }
+  *b = NULL;
+  return owned;
+}
@@ -0,0 +1,108 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lte/gateway/c/core/oai/lib/bstr/bstrlib.h"
+
+/*
+ * Per-message arena for NAS decoding.
+ *
+ * While an arena is entered on the calling thread, decode_bstring() and the
+ * IE decoders built on it return "borrowed" bstrings instead of heap copies:
+ * the tagbstring lives in the arena and its data points either into the
+ * received PDU or into arena memory. A borrowed bstring has mlen <= 0, which
+ * makes bdestroy() a no-op on it, so the existing per-IE bdestroy calls of the
+ * message handlers keep working unchanged. Everything is released at once by
+ * nas_decode_arena_release().
+ *
+ * Small messages fit in the inline buffer, so an arena declared on the stack
+ * decodes them without any heap allocation. Larger ones spill over to heap
+ * chunks.
+ *
+ * A handler that keeps a decoded bstring beyond the message (e.g. in a
+ * procedure context or an ITTI message) must take it with
+ * nas_decode_bstring_own(), which copies borrowed strings and steals heap
+ * ones.
+ */
+#define NAS_DECODE_ARENA_INLINE_SIZE 1024
+#define NAS_DECODE_ARENA_CHUNK_SIZE 4096
+
+typedef struct nas_decode_arena_chunk_s nas_decode_arena_chunk_t;
+
+typedef struct nas_decode_arena_s {
+  uint8_t inline_buffer[NAS_DECODE_ARENA_INLINE_SIZE]
+      __attribute__((aligned(16)));
+  size_t inline_used;
+  nas_decode_arena_chunk_t* chunks;
+  uint32_t allocations;       /* Allocations served since init */
+  uint32_t heap_allocations;  /* Chunks taken from the heap since init */
+  struct nas_decode_arena_s* previous; /* Arena entered before this one */
+} nas_decode_arena_t;
+
+void nas_decode_arena_init(nas_decode_arena_t* arena);
+
+/* Never returns NULL; the memory is 16 bytes aligned and not zeroed. */
+void* nas_decode_arena_alloc(nas_decode_arena_t* arena, size_t size);
+
+/* Free the heap chunks; the arena can be reused after init. */
+void nas_decode_arena_release(nas_decode_arena_t* arena);
+
+/*
+ * Borrowed bstring over data[0..len), which must outlive the arena. Unlike
+ * bstrlib strings it is not NUL terminated.
+ */
+bstring nas_decode_arena_slice(nas_decode_arena_t* arena, const uint8_t* data,
+                               int len);
+
+/* Borrowed bstring over a copy of data[0..len) made in the arena. */
+bstring nas_decode_arena_copy(nas_decode_arena_t* arena, const uint8_t* data,
+                              int len);
+
+/*
+ * Make the arena current on the calling thread until the matching leave.
+ * Arenas nest: leaving restores the previously entered one.
+ */
+void nas_decode_arena_enter(nas_decode_arena_t* arena);
+void nas_decode_arena_leave(nas_decode_arena_t* arena);
+
+/* Arena entered on the calling thread, NULL if none. */
+nas_decode_arena_t* nas_decode_arena_current(void);
+
+static inline bool nas_decode_bstring_is_borrowed(const_bstring b) {
+  return b && b->mlen <= 0;
+}
+
+/*
+ * Borrowed copy of data[0..len) when an arena is current, heap copy
+ * otherwise. For IEs whose decoded value is not a plain slice of the PDU.
+ */
+bstring nas_decode_blk2bstr(const void* data, int len);
+
+/*
+ * Take ownership of *b, leaving NULL behind: a borrowed bstring is copied to
+ * the heap, a heap one is returned as is.
+ */
+bstring nas_decode_bstring_own(bstring* b);
+
+#ifdef __cplusplus
+}
+#endif
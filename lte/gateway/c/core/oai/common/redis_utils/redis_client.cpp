@@ -27,11 +27,18 @@ extern "C" {
 }
 #endif
 
+#include <algorithm>
+
 #include "orc8r/gateway/c/common/config/includes/ServiceConfigLoader.h"
 #include <yaml-cpp/yaml.h>  // IWYU pragma: keep
 
 using google::protobuf::Message;
 
+namespace {
+// Keys read by a single MGET
+constexpr size_t MGET_BATCH_SIZE = 256;
+}  // namespace
+
 namespace magma {
 namespace lte {
 
@@ -130,6 +137,37 @@ int RedisClient::read_version(const std::string& key) {
   return wrapper_proto.version();
 }
 
+status_code_e RedisClient::read_redis_states(
+    const std::vector<std::string>& keys,
+    std::map<std::string, orc8r::RedisState>& states_out) {
+  for (size_t begin = 0; begin < keys.size(); begin += MGET_BATCH_SIZE) {
+    std::vector<std::string> batch(
+        keys.begin() + begin,
+        keys.begin() + std::min(keys.size(), begin + MGET_BATCH_SIZE));
+    auto db_read_fut = db_client_->mget(batch);
+    db_client_->sync_commit();
+    auto db_read_reply = db_read_fut.get();
+
+    if (db_read_reply.is_error() || !db_read_reply.is_array()) {
+      return RETURNerror;
+    }
+
+    const auto& values = db_read_reply.as_array();
+    for (size_t idx = 0; idx < values.size() && idx < batch.size(); idx++) {
+      // Keys removed since they were listed have no value
+      if (!values[idx].is_string()) {
+        continue;
+      }
+      orc8r::RedisState state;
+      if (deserialize(state, values[idx].as_string()) != RETURNok) {
+        return RETURNerror;
+      }
+      states_out[batch[idx]] = std::move(state);
+    }
+  }
+  return RETURNok;
+}
+
 status_code_e RedisClient::clear_keys(
     const std::vector<std::string>& keys_to_clear) {
 #if !MME_UNIT_TEST
@@ -17,7 +17,9 @@
 
 #pragma once
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include <cpp_redis/cpp_redis>
 #include <google/protobuf/message.h>
@@ -83,6 +85,17 @@ class RedisClient {
 
   int read_version(const std::string& key);
 
+  /**
+   * Reads the wrapped values of keys with MGET, in batches of keys, instead
+   * of a round trip per key
+   * @param keys
+   * @param states_out wrapped values by key, keys without value are skipped
+   * @return response code of operation
+   */
+  status_code_e read_redis_states(
+      const std::vector<std::string>& keys,
+      std::map<std::string, orc8r::RedisState>& states_out);
+
   status_code_e clear_keys(const std::vector<std::string>& keys_to_clear);
 
   std::vector<std::string> get_keys(const std::string& pattern);
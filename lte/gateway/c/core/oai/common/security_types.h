@@ -57,6 +57,14 @@
 #define AUTN_LENGTH_BITS (128)
 #define AUTN_LENGTH_OCTETS (AUTN_LENGTH_BITS / 8)
 
+/* AUTN fields and Milenage outputs, TS 33.102 and TS 35.206 */
+#define SQN_LENGTH_OCTETS (6)
+#define AK_LENGTH_OCTETS (6)
+#define AMF_LENGTH_OCTETS (2)
+#define MAC_LENGTH_OCTETS (8)
+#define MILENAGE_RES_LENGTH_OCTETS (8)
+#define AUTS_LENGTH_OCTETS (SQN_LENGTH_OCTETS + MAC_LENGTH_OCTETS)
+
 /* Some methods to convert a string to an int64_t */
 /*
 #define STRING_TO_64BITS(sTRING, cONTAINER)    \
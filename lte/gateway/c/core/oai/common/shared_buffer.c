@@ -0,0 +1,69 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+
+#include "lte/gateway/c/core/oai/common/assertions.h"
+#include "lte/gateway/c/core/oai/common/shared_buffer.h"
+
+struct shared_buffer_s {
+  uint32_t refcount;
+  uint32_t length;
+  uint8_t* data;
+};
+
+//------------------------------------------------------------------------------
+shared_buffer_t* shared_buffer_wrap(uint8_t* data, uint32_t length) {
+  shared_buffer_t* buffer = malloc(sizeof(shared_buffer_t));
+  DevAssert(buffer != NULL);
+  buffer->refcount = 1;
+  buffer->length = length;
+  buffer->data = data;
+  return buffer;
+}
+
+//------------------------------------------------------------------------------
+shared_buffer_t* shared_buffer_ref(shared_buffer_t* buffer) {
+  if (buffer) {
+    __atomic_add_fetch(&buffer->refcount, 1, __ATOMIC_RELAXED);
+  }
+  return buffer;
+}
+
+//------------------------------------------------------------------------------
+void shared_buffer_unref(shared_buffer_t* buffer) {
+  if (buffer == NULL) {
+    return;
+  }
+  // Release so that the freeing thread sees every access made through the
+  // other references
+  if (__atomic_sub_fetch(&buffer->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+    free(buffer->data);
+    free(buffer);
+  }
+}
+
+//------------------------------------------------------------------------------
+const uint8_t* shared_buffer_data(const shared_buffer_t* buffer) {
+  return buffer->data;
+}
+
+//------------------------------------------------------------------------------
+uint32_t shared_buffer_length(const shared_buffer_t* buffer) {
+  return buffer->length;
+}
+
+//------------------------------------------------------------------------------
+uint32_t shared_buffer_refcount(const shared_buffer_t* buffer) {
+  return __atomic_load_n(&buffer->refcount, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,50 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * Immutable, reference counted byte buffer.
+ *
+ * Used to hand the same encoded PDU to several ITTI messages (e.g. one
+ * SCTP_DATA_REQ per eNB for a paging fan-out) without copying it for each of
+ * them. The reference count is atomic since the last reference is usually
+ * dropped by another task than the one that created the buffer.
+ */
+typedef struct shared_buffer_s shared_buffer_t;
+
+/*
+ * Take ownership of data, which must have been allocated with malloc (as
+ * asn1c encoders do). The buffer is returned with one reference held.
+ */
+shared_buffer_t* shared_buffer_wrap(uint8_t* data, uint32_t length);
+
+/* Returns buffer with one more reference held. NULL is ignored. */
+shared_buffer_t* shared_buffer_ref(shared_buffer_t* buffer);
+
+/* Drop one reference, freeing the buffer with the last one. */
+void shared_buffer_unref(shared_buffer_t* buffer);
+
+const uint8_t* shared_buffer_data(const shared_buffer_t* buffer);
+uint32_t shared_buffer_length(const shared_buffer_t* buffer);
+uint32_t shared_buffer_refcount(const shared_buffer_t* buffer);
+
+#ifdef __cplusplus
+}
+#endif
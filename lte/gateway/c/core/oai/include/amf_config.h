@@ -49,6 +49,12 @@
 #define AMF_CONFIG_STRING_AMF_SET_ID "AMF_SET_ID"
 #define AMF_CONFIG_STRING_AMF_POINTER "AMF_POINTER"
 
+#define AMF_CONFIG_STRING_SUCI_PROFILES "SUCI_PROFILES"
+#define AMF_CONFIG_STRING_HOME_NETWORK_PUBLIC_KEY_IDENTIFIER \
+  "HOME_NETWORK_PUBLIC_KEY_IDENTIFIER"
+#define AMF_CONFIG_STRING_PROTECTION_SCHEME "PROTECTION_SCHEME"
+#define AMF_CONFIG_STRING_HOME_NETWORK_PRIVATE_KEY "HOME_NETWORK_PRIVATE_KEY"
+
 typedef struct nas5g_config_s {
   uint8_t preferred_integrity_algorithm[8];
   uint8_t preferred_ciphering_algorithm[8];
@@ -146,6 +152,19 @@ typedef struct plmn_support_list_s {
   plmn_support_t plmn_support[MAX_PLMN_SUPPORT];
 } plmn_support_list_t;
 
+typedef struct suci_profile_s {
+  uint8_t home_network_public_key_identifier;
+  // Protection scheme identifier of TS 24.501, 1 for profile A, 2 for B
+  uint8_t protection_scheme;
+  bstring home_network_private_key; /*hex*/
+} suci_profile_t;
+
+typedef struct suci_profile_list_s {
+#define MAX_SUCI_PROFILES 16
+  uint8_t nb;
+  suci_profile_t profiles[MAX_SUCI_PROFILES];
+} suci_profile_list_t;
+
 typedef struct amf_config_s {
   /* Reader/writer lock for this configuration */
   pthread_rwlock_t rw_lock;
@@ -179,6 +198,7 @@ typedef struct amf_config_s {
   } ipv4;
   bstring amf_name;
   bstring default_dnn;
+  suci_profile_list_t suci_profile_list;
 } amf_config_t;
 
 int amf_app_init(amf_config_t*);
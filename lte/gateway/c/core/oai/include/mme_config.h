@@ -112,6 +112,15 @@
 #define MME_CONFIG_STRING_S6A_CONF_FILE_PATH "S6A_CONF"
 #define MME_CONFIG_STRING_S6A_HSS_HOSTNAME "HSS_HOSTNAME"
 #define MME_CONFIG_STRING_S6A_HSS_REALM "HSS_REALM"
+#define MME_CONFIG_STRING_S6A_LOCAL_HSS "LOCAL_HSS"
+#define MME_CONFIG_STRING_S6A_LOCAL_HSS_STORE_FILE "LOCAL_HSS_STORE_FILE"
+#define MME_CONFIG_STRING_S6A_LOCAL_HSS_SYNC_INTERVAL "LOCAL_HSS_SYNC_INTERVAL"
+#define MME_CONFIG_STRING_S6A_LOCAL_HSS_OP "LOCAL_HSS_OP"
+#define MME_CONFIG_STRING_S6A_LOCAL_HSS_AMF "LOCAL_HSS_AMF"
+#define MME_CONFIG_STRING_S6A_LOCAL_HSS_MAX_UL_BIT_RATE \
+  "LOCAL_HSS_MAX_UL_BIT_RATE"
+#define MME_CONFIG_STRING_S6A_LOCAL_HSS_MAX_DL_BIT_RATE \
+  "LOCAL_HSS_MAX_DL_BIT_RATE"
 
 #define MME_CONFIG_STRING_SCTP_CONFIG "SCTP"
 #define MME_CONFIG_STRING_SCTP_UPSTREAM_SOCK "SCTP_UPSTREAM_SOCK"
@@ -285,6 +294,17 @@ typedef struct s6a_config_s {
   bstring conf_file;
   bstring hss_host_name;
   bstring hss_realm;
+  // Vectors and subscriber data from subscribers synced from subscriberdb,
+  // S6A over gRPC builds only
+  bool local_hss_enabled;
+  bstring local_hss_store_file;
+  uint32_t local_hss_sync_interval_sec;
+  // Hex strings
+  bstring local_hss_op;
+  bstring local_hss_amf;
+  // AMBR of the default subscription profile
+  uint64_t local_hss_max_ul_bit_rate;
+  uint64_t local_hss_max_dl_bit_rate;
 } s6a_config_t;
 
 typedef struct itti_config_s {
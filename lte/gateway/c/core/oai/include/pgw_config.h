@@ -81,6 +81,16 @@
 
 #define PGW_CONFIG_STRING_NAT_ENABLED "ENABLE_NAT"
 
+#define PGW_CONFIG_STRING_DELEGATED_IP_ALLOCATION "DELEGATED_IP_ALLOCATION"
+#define PGW_CONFIG_STRING_DELEGATED_IP_ALLOCATION_ENABLED "ENABLED"
+#define PGW_CONFIG_STRING_LEASE_PREFIX_LEN "LEASE_PREFIX_LEN"
+#define PGW_CONFIG_STRING_LEASE_LOW_WATERMARK "LEASE_LOW_WATERMARK"
+#define PGW_CONFIG_STRING_LEASE_RENEW_BEFORE_SECS "LEASE_RENEW_BEFORE_SECS"
+#define PGW_CONFIG_STRING_SYNC_INTERVAL_MSEC "SYNC_INTERVAL_MSEC"
+#define PGW_CONFIG_STRING_MAX_SYNC_BATCH "MAX_SYNC_BATCH"
+// Identity of the SPGW task as holder of mobilityd IP block leases
+#define SPGW_IP_LEASE_HOLDER "spgw_app"
+
 // may be more
 #define PGW_MAX_ALLOCATED_PDN_ADDRESSES 1024
 #define PGW_NUM_UE_POOL_MAX 16
@@ -133,6 +143,16 @@ typedef struct pgw_config_s {
     struct in6_addr ipv6_addr;
   } pcscf;
 
+  // Local IPv4 allocation out of sub-blocks leased from mobilityd
+  struct {
+    bool enabled;
+    uint32_t lease_prefix_len;
+    uint32_t low_watermark;
+    uint32_t renew_before_secs;
+    uint32_t sync_interval_msec;
+    uint32_t max_sync_batch;
+  } delegated_ip_alloc;
+
   struct {
     struct in6_addr dns_ipv6_addr;
   } ipv6;
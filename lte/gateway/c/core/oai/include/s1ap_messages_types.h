@@ -90,6 +90,7 @@
 #define S1AP_HANDOVER_REQUEST_ACK(mSGpTR) \
   (mSGpTR)->ittiMsg.s1ap_handover_request_ack
 #define S1AP_HANDOVER_NOTIFY(mSGpTR) (mSGpTR)->ittiMsg.s1ap_handover_notify
+#define S1AP_MME_OVERLOAD_IND(mSGpTR) (mSGpTR)->ittiMsg.s1ap_mme_overload_ind
 
 // NOT a ITTI message
 typedef struct s1ap_initial_ue_message_s {
@@ -412,4 +413,11 @@ typedef struct itti_s1ap_handover_notify_s {
   enb_ue_s1ap_id_t target_enb_ue_s1ap_id;
   e_rab_admitted_list_t e_rab_admitted_list;
 } itti_s1ap_handover_notify_t;
+
+// Sent by MME_APP when it enters or leaves overload, S1AP forwards it to all
+// eNBs as S1AP Overload Start / Overload Stop
+typedef struct itti_s1ap_mme_overload_ind_s {
+  bool overload_start;
+  uint8_t traffic_reduction_percent;  // 1-99, only with overload_start
+} itti_s1ap_mme_overload_ind_t;
 #endif /* FILE_S1AP_MESSAGES_TYPES_SEEN */
@@ -36,6 +36,7 @@
 #ifndef FILE_S6A_MESSAGES_TYPES_SEEN
 #define FILE_S6A_MESSAGES_TYPES_SEEN
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "lte/gateway/c/core/oai/lib/3gpp/3gpp_23.003.h"
@@ -115,6 +116,11 @@ typedef struct s6a_auth_info_req_s {
    * Only present and interpreted if re_synchronization == 1.
    */
   uint8_t resync_param[RAND_LENGTH_OCTETS + AUTS_LENGTH];
+  /* Non zero if sent to stock the MME authentication vector cache rather
+   * than for a UE: the sequence number the cache tagged the AIR with, the
+   * answer carries it back.
+   */
+  uint64_t prefetch_seq;
 } s6a_auth_info_req_t;
 
 typedef struct s6a_auth_info_ans_s {
@@ -125,6 +131,8 @@ typedef struct s6a_auth_info_ans_s {
   s6a_result_t result;
   /* Authentication info containing the vector(s) */
   authentication_info_t auth_info;
+  /* Answer to a prefetch request, see s6a_auth_info_req_t */
+  uint64_t prefetch_seq;
 } s6a_auth_info_ans_t;
 
 typedef struct s6a_cancel_location_req_s {
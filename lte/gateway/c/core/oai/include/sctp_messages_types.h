@@ -43,6 +43,7 @@
 #include "lte/gateway/c/core/oai/lib/bstr/bstrlib.h"
 
 #include "lte/gateway/c/core/oai/common/common_types.h"
+#include "lte/gateway/c/core/oai/common/shared_buffer.h"
 
 typedef uint32_t sctp_ppid_t;
 
@@ -71,6 +72,8 @@ typedef struct sctp_data_cnf_s {
 
 typedef struct sctp_data_req_s {
   bstring payload;
+  // Sent instead of payload when set; one reference is owned by the message
+  shared_buffer_t* shared_payload;
   sctp_assoc_id_t assoc_id;
   sctp_stream_id_t stream;
   uint32_t agw_ue_xap_id;  // it will be set to mme_ue_s1ap_id or amf_ue_ngap_id
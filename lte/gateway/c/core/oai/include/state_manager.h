@@ -208,6 +208,8 @@ class StateManager {
         OAILOG_ERROR(log_task, "Failed to remove UE state from db");
         return;
       }
+      // A UE written again after removal is not skipped as unchanged
+      this->ue_state_hash.erase(imsi_str);
       OAILOG_DEBUG(log_task, "Removing UE state for IMSI %s", imsi_str.c_str());
     }
   }
@@ -45,7 +45,9 @@ typedef struct {
 } udp_data_req_t;
 
 typedef struct {
-  uint8_t msgBuf[UDP_DATA_MAX_MSG_LEN];
+  /* Buffer taken from the UDP task receive pool, UDP_DATA_MAX_MSG_LEN long.
+   * Owned by the message: it goes back to the pool in itti_free_msg_content */
+  uint8_t* msgBuf;
   uint32_t buffer_length;
   uint16_t local_port;
   union {
@@ -46,6 +46,7 @@
 #include "lte/gateway/c/core/oai/lib/3gpp/3gpp_24.008.h"
 #include "lte/gateway/c/core/oai/common/TLVDecoder.h"
 #include "lte/gateway/c/core/oai/common/TLVEncoder.h"
+#include "lte/gateway/c/core/oai/common/nas_decode_arena.h"
 
 //******************************************************************************
 // 10.5.6 Session management information elements
@@ -76,13 +77,20 @@ int decode_access_point_name_ie(access_point_name_t* access_point_name,
   CHECK_LENGTH_DECODER(len - decoded, ielen);
 
   if (1 <= ielen) {
+    // The labels and their '.' separators are never longer than the IE
+    uint8_t apn[UINT8_MAX];
+    int apn_length = 0;
     int length_apn = *(buffer + decoded);
     decoded++;
-    *access_point_name = blk2bstr((void*)(buffer + decoded), length_apn);
+    if (length_apn > ielen - 1) {
+      return TLV_VALUE_DOESNT_MATCH;
+    }
+    memcpy(apn, buffer + decoded, length_apn);
+    apn_length = length_apn;
     decoded += length_apn;
     ielen = ielen - 1 - length_apn;
     while (1 <= ielen) {
-      bconchar(*access_point_name, '.');
+      apn[apn_length++] = '.';
       length_apn = *(buffer + decoded);
       decoded++;
       ielen = ielen - 1;
@@ -92,11 +100,13 @@ int decode_access_point_name_ie(access_point_name_t* access_point_name,
         AssertFatal(ielen >= length_apn,
                     "Mismatch in lengths remaining ielen %d apn length %d",
                     ielen, length_apn);
-        bcatblk(*access_point_name, (void*)(buffer + decoded), length_apn);
+        memcpy(apn + apn_length, buffer + decoded, length_apn);
+        apn_length += length_apn;
         decoded += length_apn;
         ielen = ielen - length_apn;
       }
     }
+    *access_point_name = nas_decode_blk2bstr(apn, apn_length);
   }
   return decoded;
 }
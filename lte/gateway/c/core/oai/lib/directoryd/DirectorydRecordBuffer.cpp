@@ -0,0 +1,149 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lte/gateway/c/core/oai/lib/directoryd/DirectorydRecordBuffer.h"
+
+#include <utility>
+
+namespace magma {
+
+DirectorydRecordBuffer::DirectorydRecordBuffer(size_t max_pending,
+                                               size_t max_deleted)
+    : max_pending_(max_pending),
+      max_deleted_(max_deleted),
+      dropped_(0),
+      elided_(0) {}
+
+DirectorydRecordWrite* DirectorydRecordBuffer::get_pending_write(
+    const std::string& id) {
+  auto it = pending_.find(id);
+  if (it != pending_.end()) {
+    return &it->second;
+  }
+  if (pending_.size() >= max_pending_) {
+    dropped_++;
+    return nullptr;
+  }
+  order_.push_back(id);
+  if (deleted_.count(id) != 0) {
+    created_.insert(id);
+  }
+  auto& write = pending_[id];
+  write.id = id;
+  write.delete_record = false;
+  write.update_record = false;
+  return &write;
+}
+
+bool DirectorydRecordBuffer::update_record(const std::string& id,
+                                           const std::string& location) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto* write = get_pending_write(id);
+  if (write == nullptr) {
+    return false;
+  }
+  write->update_record = true;
+  write->location = location;
+  return true;
+}
+
+bool DirectorydRecordBuffer::update_record_field(const std::string& id,
+                                                 const std::string& key,
+                                                 const std::string& value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto* write = get_pending_write(id);
+  if (write == nullptr) {
+    return false;
+  }
+  write->update_record = true;
+  write->fields[key] = value;
+  return true;
+}
+
+bool DirectorydRecordBuffer::delete_record(const std::string& id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = pending_.find(id);
+  if (it != pending_.end() && it->second.update_record &&
+      !it->second.delete_record && created_.count(id) != 0) {
+    // Created since this process deleted it and never written, there is
+    // nothing to delete
+    pending_.erase(it);
+    created_.erase(id);
+    elided_++;
+    return true;
+  }
+  auto* write = get_pending_write(id);
+  if (write == nullptr) {
+    return false;
+  }
+  write->delete_record = true;
+  write->update_record = false;
+  write->location.clear();
+  write->fields.clear();
+  return true;
+}
+
+std::vector<DirectorydRecordWrite> DirectorydRecordBuffer::take_pending() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<DirectorydRecordWrite> writes;
+  writes.reserve(pending_.size());
+  for (const auto& id : order_) {
+    // Elided records and records written again after that are left in order_
+    auto it = pending_.find(id);
+    if (it == pending_.end()) {
+      continue;
+    }
+    if (it->second.update_record) {
+      deleted_.erase(id);
+    } else {
+      remember_deleted(id);
+    }
+    writes.push_back(std::move(it->second));
+    pending_.erase(it);
+  }
+  order_.clear();
+  created_.clear();
+  return writes;
+}
+
+void DirectorydRecordBuffer::remember_deleted(const std::string& id) {
+  if (max_deleted_ == 0 || deleted_.count(id) != 0) {
+    return;
+  }
+  // Forgetting a record only costs the elision of its next create and
+  // delete. Ids written again since they were deleted linger in
+  // deleted_order_ until they are evicted here.
+  while (deleted_order_.size() >= max_deleted_) {
+    deleted_.erase(deleted_order_.front());
+    deleted_order_.pop_front();
+  }
+  deleted_.insert(id);
+  deleted_order_.push_back(id);
+}
+
+size_t DirectorydRecordBuffer::get_pending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_.size();
+}
+
+uint64_t DirectorydRecordBuffer::get_dropped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_;
+}
+
+uint64_t DirectorydRecordBuffer::get_elided() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return elided_;
+}
+
+}  // namespace magma
@@ -0,0 +1,110 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace magma {
+
+/**
+ * Coalesced writes of one directoryd record, sent in this order
+ */
+struct DirectorydRecordWrite {
+  std::string id;
+  // Delete the record before any update below
+  bool delete_record;
+  // Update the record with the location and fields below
+  bool update_record;
+  std::string location;
+  std::map<std::string, std::string> fields;
+};
+
+/**
+ * Buffers the directoryd writes of the MME and SGW-S8 tasks per record id
+ * until they are flushed, so that the several writes of one attach go out as
+ * a single record update:
+ *  - updates of the same record are merged, the last value of a field wins
+ *  - a delete drops the updates buffered before it
+ *  - a record deleted by a flush of this process, then created again and
+ *    deleted before the next flush, is not written at all. Records this
+ *    process has not deleted, e.g. ones written before it restarted, are
+ *    always deleted.
+ *
+ * Writes of records which are not buffered yet are dropped once max_pending
+ * records are buffered. At most max_deleted deleted records are remembered,
+ * the oldest ones are forgotten first.
+ *
+ * All methods are thread safe.
+ */
+class DirectorydRecordBuffer {
+ public:
+  static constexpr size_t DEFAULT_MAX_PENDING = 16384;
+  static constexpr size_t DEFAULT_MAX_DELETED = 65536;
+
+  explicit DirectorydRecordBuffer(size_t max_pending = DEFAULT_MAX_PENDING,
+                                  size_t max_deleted = DEFAULT_MAX_DELETED);
+
+  /**
+   * @return false if the write was dropped
+   */
+  bool update_record(const std::string& id, const std::string& location);
+
+  bool update_record_field(const std::string& id, const std::string& key,
+                           const std::string& value);
+
+  bool delete_record(const std::string& id);
+
+  /**
+   * Take the buffered writes, in the order their records were first written
+   */
+  std::vector<DirectorydRecordWrite> take_pending();
+
+  size_t get_pending() const;
+
+  // Writes dropped because the buffer was full
+  uint64_t get_dropped() const;
+
+  // Records created and deleted again before they were flushed
+  uint64_t get_elided() const;
+
+ private:
+  // Must be called with mutex_ held
+  DirectorydRecordWrite* get_pending_write(const std::string& id);
+
+  // Must be called with mutex_ held
+  void remember_deleted(const std::string& id);
+
+  const size_t max_pending_;
+  const size_t max_deleted_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, DirectorydRecordWrite> pending_;
+  std::deque<std::string> order_;
+  // Pending records first written while they were known to be deleted
+  std::unordered_set<std::string> created_;
+  // Records deleted by a flush and not written since, oldest first in
+  // deleted_order_
+  std::unordered_set<std::string> deleted_;
+  std::deque<std::string> deleted_order_;
+  uint64_t dropped_;
+  uint64_t elided_;
+};
+
+}  // namespace magma
@@ -63,6 +63,17 @@ bool GatewayDirectoryServiceClient::UpdateRecord(
   return GatewayDirectoryServiceClient::updateRecordImpl(request, callback);
 }
 
+bool GatewayDirectoryServiceClient::UpdateRecord(
+    const std::string& id, const std::string& location,
+    const std::map<std::string, std::string>& fields,
+    std::function<void(Status, Void)> callback) {
+  UpdateRecordRequest request;
+  request.set_id(id);
+  request.set_location(location);
+  request.mutable_fields()->insert(fields.begin(), fields.end());
+  return GatewayDirectoryServiceClient::updateRecordImpl(request, callback);
+}
+
 bool GatewayDirectoryServiceClient::UpdateRecordField(
     const std::string& id, const std::string& field_key,
     const std::string& field_value,
@@ -20,6 +20,7 @@
 #include <grpc++/grpc++.h>
 #include <stdint.h>
 #include <functional>
+#include <map>
 #include <memory>
 #include <string>
 
@@ -52,6 +53,10 @@ class GatewayDirectoryServiceClient : public GRPCReceiver {
   static bool UpdateRecord(const std::string& id, const std::string& location,
                            std::function<void(Status, Void)> callback);
 
+  static bool UpdateRecord(const std::string& id, const std::string& location,
+                           const std::map<std::string, std::string>& fields,
+                           std::function<void(Status, Void)> callback);
+
   static bool UpdateRecordField(const std::string& id,
                                 const std::string& field_key,
                                 const std::string& field_value,
@@ -16,56 +16,169 @@
  */
 
 #include <grpcpp/impl/codegen/status.h>
-#include <string>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include "lte/gateway/c/core/oai/lib/directoryd/DirectorydRecordBuffer.h"
 #include "lte/gateway/c/core/oai/lib/directoryd/GatewayDirectorydClient.h"
 #include "lte/gateway/c/core/oai/lib/directoryd/directoryd.h"
+#include "orc8r/gateway/c/common/service303/includes/MetricsHelpers.h"
 #include "orc8r/protos/common.pb.h"
 #include "orc8r/protos/directoryd.pb.h"
 
 static void directoryd_rpc_call_done(const grpc::Status& status);
 
+namespace {
+
+// Writes are buffered for this long after the first one before being flushed
+constexpr std::chrono::milliseconds FLUSH_WINDOW(100);
+
+/**
+ * Flushes the buffered directoryd writes from a thread of its own, once per
+ * FLUSH_WINDOW while there are writes pending. Each flush sends a single
+ * update per record, after its delete if it was deleted in the meantime.
+ */
+class DirectorydRecordFlusher {
+ public:
+  static DirectorydRecordFlusher& get_instance() {
+    static DirectorydRecordFlusher instance;
+    return instance;
+  }
+
+  /**
+   * Apply a write to the buffer and wake up the flush thread
+   * @return false if the write was dropped
+   */
+  template <typename Apply>
+  bool write(Apply&& apply) {
+    bool buffered = apply(buffer_);
+    if (!buffered) {
+      increment_counter("directoryd_record_dropped", 1, 1, "reason",
+                        "queue_full");
+    }
+    set_gauge("directoryd_record_queue_depth", buffer_.get_pending(), 0);
+    {
+      // Do not notify between the check and the wait of the flush thread
+      std::lock_guard<std::mutex> lock(mutex_);
+    }
+    cv_.notify_one();
+    return buffered;
+  }
+
+  DirectorydRecordFlusher(DirectorydRecordFlusher const&) = delete;
+  void operator=(DirectorydRecordFlusher const&) = delete;
+
+ private:
+  DirectorydRecordFlusher() : elided_(0) {
+    std::thread flush_thread([this]() { run(); });
+    flush_thread.detach();
+  }
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [this]() { return buffer_.get_pending() > 0; });
+      lock.unlock();
+      std::this_thread::sleep_for(FLUSH_WINDOW);
+      flush();
+      lock.lock();
+    }
+  }
+
+  void flush() {
+    auto writes = buffer_.take_pending();
+    set_gauge("directoryd_record_queue_depth", buffer_.get_pending(), 0);
+    uint64_t elided = buffer_.get_elided();
+    if (elided > elided_) {
+      increment_counter("directoryd_record_elided", elided - elided_, 0);
+      elided_ = elided;
+    }
+    for (auto& write : writes) {
+      send(std::move(write));
+    }
+  }
+
+  static void send(magma::DirectorydRecordWrite write) {
+    if (!write.delete_record) {
+      send_update(write);
+      return;
+    }
+    // The update of a record deleted and created again waits for the delete
+    // to be answered, so that its fields do not get deleted
+    auto id = write.id;
+    magma::GatewayDirectoryServiceClient::DeleteRecord(
+        id, [write](grpc::Status status, magma::Void response) {
+          // Records which were never written are not found
+          if (status.error_code() != grpc::NOT_FOUND) {
+            directoryd_rpc_call_done(status);
+          }
+          if (write.update_record) {
+            send_update(write);
+          }
+        });
+  }
+
+  static void send_update(const magma::DirectorydRecordWrite& write) {
+    magma::GatewayDirectoryServiceClient::UpdateRecord(
+        write.id, write.location, write.fields,
+        [](grpc::Status status, magma::Void response) {
+          directoryd_rpc_call_done(status);
+        });
+  }
+
+  magma::DirectorydRecordBuffer buffer_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  // Elided records already counted
+  uint64_t elided_;
+};
+
+}  // namespace
+
 bool directoryd_report_location(char* imsi) {
   // Actual GW_ID will be filled in the cloud
-  magma::GatewayDirectoryServiceClient::UpdateRecord(
-      "IMSI" + std::string(imsi), std::string("GW_ID"),
-      [&](grpc::Status status, magma::Void response) {
-        directoryd_rpc_call_done(status);
+  std::string id = "IMSI" + std::string(imsi);
+  return DirectorydRecordFlusher::get_instance().write(
+      [&id](magma::DirectorydRecordBuffer& buffer) {
+        return buffer.update_record(id, "GW_ID");
       });
-  return true;
 }
 
 bool directoryd_remove_location(char* imsi) {
-  magma::GatewayDirectoryServiceClient::DeleteRecord(
-      "IMSI" + std::string(imsi),
-      [&](grpc::Status status, magma::Void response) {
-        directoryd_rpc_call_done(status);
+  std::string id = "IMSI" + std::string(imsi);
+  return DirectorydRecordFlusher::get_instance().write(
+      [&id](magma::DirectorydRecordBuffer& buffer) {
+        return buffer.delete_record(id);
       });
-  return true;
 }
 
 bool directoryd_update_location(char* imsi, char* location) {
-  magma::GatewayDirectoryServiceClient::UpdateRecord(
-      "IMSI" + std::string(imsi), std::string(location),
-      [&](grpc::Status status, magma::Void response) {
-        directoryd_rpc_call_done(status);
+  std::string id = "IMSI" + std::string(imsi);
+  return DirectorydRecordFlusher::get_instance().write(
+      [&id, location](magma::DirectorydRecordBuffer& buffer) {
+        return buffer.update_record(id, location);
       });
-  return true;
 }
 
 bool directoryd_update_record_field(char* imsi, char* key, char* value) {
   // Actual GW_ID will be filled in the cloud
-  magma::GatewayDirectoryServiceClient::UpdateRecordField(
-      "IMSI" + std::string(imsi), std::string(key), std::string(value),
-      [&](grpc::Status status, magma::Void response) {
-        directoryd_rpc_call_done(status);
+  std::string id = "IMSI" + std::string(imsi);
+  return DirectorydRecordFlusher::get_instance().write(
+      [&id, key, value](magma::DirectorydRecordBuffer& buffer) {
+        return buffer.update_record_field(id, key, value);
       });
-  return true;
 }
 
 void directoryd_rpc_call_done(const grpc::Status& status) {
   if (!status.ok()) {
+    increment_counter("directoryd_record_dropped", 1, 1, "reason",
+                      "rpc_failure");
     std::cerr << "Directoryd RPC failed with code " << status.error_code()
               << ", msg: " << status.error_message() << std::endl;
   }
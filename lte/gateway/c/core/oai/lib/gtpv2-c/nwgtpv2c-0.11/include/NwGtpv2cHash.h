@@ -0,0 +1,136 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __NW_GTPV2C_HASH_H__
+#define __NW_GTPV2C_HASH_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @file NwGtpv2cHash.h
+ * @brief Intrusive chained hash tables, used the same way as the RB trees of
+ * tree.h: the link lives in the element, so inserting or removing never
+ * allocates. The bucket array doubles when the load factor exceeds one.
+ *
+ * HASH_GENERATE(name, type, field, hashfn, cmp) expects
+ *   uint32_t hashfn(struct type*) and
+ *   int cmp(struct type*, struct type*) returning 0 for equal keys.
+ */
+
+#define HASH_HEAD(name, type) \
+  struct name {               \
+    struct type** hth_table;  \
+    uint32_t hth_mask;        \
+    uint32_t hth_count;       \
+  }
+
+#define HASH_ENTRY(type)    \
+  struct {                  \
+    struct type* hte_next;  \
+    uint32_t hte_hash;      \
+  }
+
+#define HASH_COUNT(head) ((head)->hth_count)
+#define HASH_EMPTY(head) ((head)->hth_count == 0)
+
+#define HASH_PROTOTYPE(name, type, field, hashfn, cmp)               \
+  int name##_HASH_INIT(struct name*, uint32_t);                      \
+  void name##_HASH_FINALIZE(struct name*);                           \
+  struct type* name##_HASH_FIND(struct name*, struct type*);         \
+  struct type* name##_HASH_INSERT(struct name*, struct type*);       \
+  struct type* name##_HASH_REMOVE(struct name*, struct type*);
+
+#define HASH_GENERATE(name, type, field, hashfn, cmp)                         \
+  int name##_HASH_INIT(struct name* head, uint32_t size) {                    \
+    uint32_t buckets = 1;                                                     \
+    while (buckets < size) buckets <<= 1;                                     \
+    head->hth_table = (struct type**)calloc(buckets, sizeof(struct type*));   \
+    head->hth_mask = buckets - 1;                                             \
+    head->hth_count = 0;                                                      \
+    return head->hth_table ? 0 : -1;                                          \
+  }                                                                           \
+                                                                              \
+  void name##_HASH_FINALIZE(struct name* head) {                              \
+    free(head->hth_table);                                                    \
+    head->hth_table = NULL;                                                   \
+    head->hth_mask = 0;                                                       \
+    head->hth_count = 0;                                                      \
+  }                                                                           \
+                                                                              \
+  static void name##_HASH_GROW(struct name* head) {                           \
+    uint32_t buckets = (head->hth_mask + 1) << 1;                             \
+    struct type** table =                                                     \
+        (struct type**)calloc(buckets, sizeof(struct type*));                 \
+    struct type *elm, *next;                                                  \
+    uint32_t i;                                                               \
+    if (!table) return; /* Keep going with longer chains */                   \
+    for (i = 0; i <= head->hth_mask; i++) {                                   \
+      for (elm = head->hth_table[i]; elm; elm = next) {                       \
+        next = elm->field.hte_next;                                           \
+        elm->field.hte_next = table[elm->field.hte_hash & (buckets - 1)];     \
+        table[elm->field.hte_hash & (buckets - 1)] = elm;                     \
+      }                                                                       \
+    }                                                                         \
+    free(head->hth_table);                                                    \
+    head->hth_table = table;                                                  \
+    head->hth_mask = buckets - 1;                                             \
+  }                                                                           \
+                                                                              \
+  struct type* name##_HASH_FIND(struct name* head, struct type* key) {        \
+    uint32_t hash = hashfn(key);                                              \
+    struct type* elm;                                                         \
+    for (elm = head->hth_table[hash & head->hth_mask]; elm;                   \
+         elm = elm->field.hte_next) {                                         \
+      if (elm->field.hte_hash == hash && cmp(key, elm) == 0) return elm;      \
+    }                                                                         \
+    return NULL;                                                              \
+  }                                                                           \
+                                                                              \
+  /* Returns the colliding element, if any, like RB_INSERT */                 \
+  struct type* name##_HASH_INSERT(struct name* head, struct type* elm) {      \
+    uint32_t hash = hashfn(elm);                                              \
+    struct type* tmp;                                                         \
+    for (tmp = head->hth_table[hash & head->hth_mask]; tmp;                   \
+         tmp = tmp->field.hte_next) {                                         \
+      if (tmp->field.hte_hash == hash && cmp(elm, tmp) == 0) return tmp;      \
+    }                                                                         \
+    elm->field.hte_hash = hash;                                               \
+    elm->field.hte_next = head->hth_table[hash & head->hth_mask];             \
+    head->hth_table[hash & head->hth_mask] = elm;                             \
+    if (++head->hth_count > head->hth_mask + 1) name##_HASH_GROW(head);       \
+    return NULL;                                                              \
+  }                                                                           \
+                                                                              \
+  /* Unlinks elm by identity, returns NULL if it was not in the table */      \
+  struct type* name##_HASH_REMOVE(struct name* head, struct type* elm) {      \
+    uint32_t bucket = elm->field.hte_hash & head->hth_mask;                   \
+    struct type** pp;                                                         \
+    for (pp = &head->hth_table[bucket]; *pp; pp = &(*pp)->field.hte_next) {   \
+      if (*pp == elm) {                                                       \
+        *pp = elm->field.hte_next;                                            \
+        elm->field.hte_next = NULL;                                           \
+        head->hth_count--;                                                    \
+        return elm;                                                           \
+      }                                                                       \
+    }                                                                         \
+    return NULL;                                                              \
+  }
+
+#define HASH_INIT(name, x, y) name##_HASH_INIT(x, y)
+#define HASH_FINALIZE(name, x) name##_HASH_FINALIZE(x)
+#define HASH_FIND(name, x, y) name##_HASH_FIND(x, y)
+#define HASH_INSERT(name, x, y) name##_HASH_INSERT(x, y)
+#define HASH_REMOVE(name, x, y) name##_HASH_REMOVE(x, y)
+
+#endif /* __NW_GTPV2C_HASH_H__ */
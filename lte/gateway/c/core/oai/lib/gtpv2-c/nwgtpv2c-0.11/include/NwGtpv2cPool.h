@@ -0,0 +1,59 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __NW_GTPV2C_POOL_H__
+#define __NW_GTPV2C_POOL_H__
+
+#include <stdint.h>
+
+/**
+ * @file NwGtpv2cPool.h
+ * @brief Fixed size object pool owned by a stack instance.
+ *
+ * Objects are carved out of slabs of objsPerSlab objects and recycled
+ * through a free list, so steady state allocation does not touch the heap.
+ * A stack is only driven from its own task, the pool is not thread safe.
+ * All slabs are released with the pool, including objects still in use.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct nw_gtpv2c_pool_s {
+  void* freeList;
+  void* slabList;
+  uint32_t objSize;     /**< Object stride, rounded up for alignment */
+  uint32_t objsPerSlab;
+  uint32_t capacity;    /**< Objects carved out of slabs so far */
+  uint32_t inUse;
+} nw_gtpv2c_pool_t;
+
+void nwGtpv2cPoolInit(nw_gtpv2c_pool_t* thiz, uint32_t objSize,
+                      uint32_t objsPerSlab);
+
+/**
+ * Take a zeroed object from the pool, growing it by one slab if needed.
+ * Returns NULL only if the slab allocation fails.
+ */
+void* nwGtpv2cPoolAlloc(nw_gtpv2c_pool_t* thiz);
+
+void nwGtpv2cPoolFree(nw_gtpv2c_pool_t* thiz, void* obj);
+
+void nwGtpv2cPoolFinalize(nw_gtpv2c_pool_t* thiz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NW_GTPV2C_POOL_H__ */
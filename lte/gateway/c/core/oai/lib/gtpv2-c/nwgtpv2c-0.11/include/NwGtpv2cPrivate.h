@@ -34,11 +34,13 @@
 #ifndef __NW_GTPV2C_PRIVATE_H__
 #define __NW_GTPV2C_PRIVATE_H__
 
-#include <sys/time.h>
+#include <time.h>
 
 #include "lte/gateway/c/core/oai/common/assertions.h"
 #include "lte/gateway/c/core/oai/lib/gtpv2-c/nwgtpv2c-0.11/include/tree.h"
 #include "lte/gateway/c/core/oai/lib/gtpv2-c/nwgtpv2c-0.11/include/queue.h"
+#include "lte/gateway/c/core/oai/lib/gtpv2-c/nwgtpv2c-0.11/include/NwGtpv2cHash.h"
+#include "lte/gateway/c/core/oai/lib/gtpv2-c/nwgtpv2c-0.11/include/NwGtpv2cPool.h"
 
 #include "lte/gateway/c/core/oai/lib/gtpv2-c/nwgtpv2c-0.11/shared/NwTypes.h"
 #include "lte/gateway/c/core/oai/lib/gtpv2-c/nwgtpv2c-0.11/shared/NwError.h"
@@ -85,10 +87,55 @@ extern "C" {
     }                                                                      \
   } while (0)
 
+/*--------------------------------------------------------------------------*
+ * Timeout Info Type Definition
+ *--------------------------------------------------------------------------*/
+
+/**
+ * gtpv2c timeout info
+ */
+
+typedef struct nw_gtpv2c_timeout_info_s {
+  nw_gtpv2c_stack_handle_t hStack;
+  void* timeoutArg;
+  nw_rc_t (*timeoutCallbackFunc)(void*);
+  uint32_t rounds; /**< Wheel revolutions left before expiry */
+  bool armed;
+  LIST_ENTRY(nw_gtpv2c_timeout_info_s)
+  wheelSlotEntry; /**< Timer wheel slot list node */
+} nw_gtpv2c_timeout_info_t;
+
+/**
+ * Retransmission timer wheel.
+ *
+ * All stack timers are one shot and hashed into a slot by their expiry tick,
+ * timers further away than one revolution count down their rounds. A single
+ * repetitive ULP timer, running only while stack timers are armed, drives
+ * the wheel, so starting and stopping a stack timer is O(1) and never calls
+ * into the ULP timer manager.
+ */
+
+#define NW_GTPV2C_TMR_WHEEL_TICK_MS (100)
+#define NW_GTPV2C_TMR_WHEEL_SLOTS (512) /**< Power of two, 51.2s/revolution */
+
+typedef struct nw_gtpv2c_timer_wheel_s {
+  LIST_HEAD(NwGtpv2cTmrWheelSlot, nw_gtpv2c_timeout_info_s)
+  slots[NW_GTPV2C_TMR_WHEEL_SLOTS];
+  struct timespec epoch;
+  uint64_t currTick; /**< Last tick processed */
+  uint32_t activeTimers;
+  bool ticking;
+  nw_gtpv2c_timeout_info_t tickInfo; /**< Argument of the ULP tick timer */
+  nw_gtpv2c_timer_handle_t hTickTmr;
+} nw_gtpv2c_timer_wheel_t;
+
 /*--------------------------------------------------------------------------*
  *  G T P V 2 C   S T A C K   O B J E C T   T Y P E    D E F I N I T I O N  *
  *--------------------------------------------------------------------------*/
 
+#define NW_GTPV2C_TUNNEL_MAP_INITIAL_SIZE (1024)
+#define NW_GTPV2C_TRXN_MAP_INITIAL_SIZE (256)
+
 /**
  * gtpv2c stack class definition
  */
@@ -106,37 +153,19 @@ typedef struct nw_gtpv2c_stack_s {
   uint32_t restartCounter;
 
   nw_gtpv2c_msg_ie_parse_info_t* pGtpv2cMsgIeParseInfo[NW_GTP_MSG_END];
-  struct nw_gtpv2c_timeout_info_s* activeTimerInfo;
 
-  RB_HEAD(NwGtpv2cTunnelMap, nw_gtpv2c_tunnel_s) tunnelMap;
-  RB_HEAD(NwGtpv2cOutstandingTxSeqNumTrxnMap, nw_gtpv2c_trxn_s)
+  HASH_HEAD(NwGtpv2cTunnelMap, nw_gtpv2c_tunnel_s) tunnelMap;
+  HASH_HEAD(NwGtpv2cOutstandingTxSeqNumTrxnMap, nw_gtpv2c_trxn_s)
   outstandingTxSeqNumMap;
-  RB_HEAD(NwGtpv2cOutstandingRxSeqNumTrxnMap, nw_gtpv2c_trxn_s)
+  HASH_HEAD(NwGtpv2cOutstandingRxSeqNumTrxnMap, nw_gtpv2c_trxn_s)
   outstandingRxSeqNumMap;
-  RB_HEAD(NwGtpv2cActiveTimerList, nw_gtpv2c_timeout_info_s) activeTimerList;
-  NwPtrT hTmrMinHeap;
-} nw_gtpv2c_stack_t;
+  nw_gtpv2c_timer_wheel_t tmrWheel;
 
-/*--------------------------------------------------------------------------*
- * Timeout Info Type Definition
- *--------------------------------------------------------------------------*/
-
-/**
- * gtpv2c timeout info
- */
-
-typedef struct nw_gtpv2c_timeout_info_s {
-  nw_gtpv2c_stack_handle_t hStack;
-  struct timeval tvTimeout;
-  uint32_t tmrType;
-  void* timeoutArg;
-  nw_rc_t (*timeoutCallbackFunc)(void*);
-  nw_gtpv2c_timer_handle_t hTimer;
-  RB_ENTRY(nw_gtpv2c_timeout_info_s)
-  activeTimerListRbtNode; /**< RB Tree Data Structure Node        */
-  uint32_t timerMinHeapIndex;
-  struct nw_gtpv2c_timeout_info_s* next;
-} nw_gtpv2c_timeout_info_t;
+  nw_gtpv2c_pool_t msgPool;
+  nw_gtpv2c_pool_t trxnPool;
+  nw_gtpv2c_pool_t tunnelPool;
+  nw_gtpv2c_pool_t timeoutInfoPool;
+} nw_gtpv2c_stack_t;
 
 /*---------------------------------------------------------------------------
  * GTPv2c Message Container Definition
@@ -167,7 +196,6 @@ typedef struct nw_gtpv2c_msg_s {
   uint8_t* pIe[NW_GTPV2C_IE_TYPE_MAXIMUM][NW_GTPV2C_IE_INSTANCE_MAXIMUM];
   uint8_t msgBuf[NW_GTPV2C_MAX_MSG_LEN];
   nw_gtpv2c_stack_handle_t hStack;
-  struct nw_gtpv2c_msg_s* next;
 } nw_gtpv2c_msg_t;
 
 /**
@@ -196,11 +224,10 @@ typedef struct nw_gtpv2c_trxn_s {
   nw_gtpv2c_tunnel_handle_t hTunnel; /**< Handle to local tunnel context     */
   nw_gtpv2c_ulp_trxn_handle_t hUlpTrxn; /**< Handle to ULP tunnel context */
   uint8_t trx_flags; /**< Flags in the trx to be signalized back. */
-  RB_ENTRY(nw_gtpv2c_trxn_s)
-  outstandingTxSeqNumMapRbtNode; /**< RB Tree Data Structure Node        */
-  RB_ENTRY(nw_gtpv2c_trxn_s)
-  outstandingRxSeqNumMapRbtNode; /**< RB Tree Data Structure Node        */
-  struct nw_gtpv2c_trxn_s* next;
+  HASH_ENTRY(nw_gtpv2c_trxn_s)
+  outstandingTxSeqNumMapHashNode; /**< Hash Table Chain Node */
+  HASH_ENTRY(nw_gtpv2c_trxn_s)
+  outstandingRxSeqNumMapHashNode; /**< Hash Table Chain Node */
 } nw_gtpv2c_trxn_t;
 
 /**
@@ -218,17 +245,17 @@ typedef struct NwGtpv2cPathS {
   RB_ENTRY(NwGtpv2cPathS) pathMapRbtNode;
 } NwGtpv2cPathT;
 
-RB_PROTOTYPE(NwGtpv2cTunnelMap, nw_gtpv2c_tunnel_s, tunnelMapRbtNode,
-             nwGtpv2cCompareTunnel)
-RB_PROTOTYPE(NwGtpv2cOutstandingTxSeqNumTrxnMap, nw_gtpv2c_trxn_s,
-             outstandingTxSeqNumMapRbtNode, nwGtpv2cCompareSeqNum)
-RB_PROTOTYPE(NwGtpv2cOutstandingRxSeqNumTrxnMap, nw_gtpv2c_trxn_s,
-             outstandingRxSeqNumMapRbtNode, nwGtpv2cCompareSeqNum)
-RB_PROTOTYPE(NwGtpv2cActiveTimerList, nw_gtpv2c_timeout_info_s,
-             activeTimerListRbtNode, nwGtpv2cCompareOutstandingTxRexmitTime)
+HASH_PROTOTYPE(NwGtpv2cTunnelMap, nw_gtpv2c_tunnel_s, tunnelMapHashNode,
+               nwGtpv2cHashTunnel, nwGtpv2cCompareTunnel)
+HASH_PROTOTYPE(NwGtpv2cOutstandingTxSeqNumTrxnMap, nw_gtpv2c_trxn_s,
+               outstandingTxSeqNumMapHashNode, nwGtpv2cHashTxTrxn,
+               nwGtpv2cCompareOutstandingTxSeqNumTrxn)
+HASH_PROTOTYPE(NwGtpv2cOutstandingRxSeqNumTrxnMap, nw_gtpv2c_trxn_s,
+               outstandingRxSeqNumMapHashNode, nwGtpv2cHashRxTrxn,
+               nwGtpv2cCompareOutstandingRxSeqNumTrxn)
 
 /**
- * Start Timer with ULP Timer Manager
+ * Start a one shot stack timer on the timer wheel
  */
 
 nw_rc_t nwGtpv2cStartTimer(nw_gtpv2c_stack_t* thiz, uint32_t timeoutSec,
@@ -238,7 +265,7 @@ nw_rc_t nwGtpv2cStartTimer(nw_gtpv2c_stack_t* thiz, uint32_t timeoutSec,
                            nw_gtpv2c_timer_handle_t* phTimer);
 
 /**
- * Stop Timer with ULP Timer Manager
+ * Stop a stack timer that has not expired yet
  */
 
 nw_rc_t nwGtpv2cStopTimer(nw_gtpv2c_stack_t* thiz,
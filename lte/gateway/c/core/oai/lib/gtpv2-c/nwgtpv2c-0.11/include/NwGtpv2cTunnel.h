@@ -38,7 +38,7 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "lte/gateway/c/core/oai/lib/gtpv2-c/nwgtpv2c-0.11/include/tree.h"
+#include "lte/gateway/c/core/oai/lib/gtpv2-c/nwgtpv2c-0.11/include/NwGtpv2cHash.h"
 #include "lte/gateway/c/core/oai/lib/gtpv2-c/nwgtpv2c-0.11/shared/NwTypes.h"
 #include "lte/gateway/c/core/oai/lib/gtpv2-c/nwgtpv2c-0.11/shared/NwUtils.h"
 #include "lte/gateway/c/core/oai/lib/gtpv2-c/nwgtpv2c-0.11/shared/NwError.h"
@@ -58,9 +58,8 @@ typedef struct nw_gtpv2c_tunnel_s {
   } ipAddrRemote;
 
   nw_gtpv2c_ulp_tunnel_handle_t hUlpTunnel;
-  RB_ENTRY(nw_gtpv2c_tunnel_s)
-  tunnelMapRbtNode; /**< RB Tree Data Structure Node        */
-  struct nw_gtpv2c_tunnel_s* next;
+  HASH_ENTRY(nw_gtpv2c_tunnel_s)
+  tunnelMapHashNode; /**< Hash Table Chain Node */
 } nw_gtpv2c_tunnel_t;
 
 nw_gtpv2c_tunnel_t* nwGtpv2cTunnelNew(struct nw_gtpv2c_stack_s* hStack,
@@ -51,38 +51,6 @@
 #include "lte/gateway/c/core/oai/common/gcc_diag.h"
 #include "lte/gateway/c/core/oai/common/log.h"
 
-#ifdef _NWGTPV2C_HAVE_TIMERADD
-#define NW_GTPV2C_TIMER_ADD(tvp, uvp, vvp) timeradd((tvp), (uvp), (vvp))
-#define NW_GTPV2C_TIMER_SUB(tvp, uvp, vvp) timersub((tvp), (uvp), (vvp))
-#define NW_GTPV2C_TIMER_CMP_P(a, b, CMP) timercmp(a, b, CMP)
-#else
-
-#define NW_GTPV2C_TIMER_ADD(tvp, uvp, vvp)            \
-  do {                                                \
-    (vvp)->tv_sec = (tvp)->tv_sec + (uvp)->tv_sec;    \
-    (vvp)->tv_usec = (tvp)->tv_usec + (uvp)->tv_usec; \
-    if ((vvp)->tv_usec >= 1000000) {                  \
-      (vvp)->tv_sec++;                                \
-      (vvp)->tv_usec -= 1000000;                      \
-    }                                                 \
-  } while (0)
-
-#define NW_GTPV2C_TIMER_SUB(tvp, uvp, vvp)            \
-  do {                                                \
-    (vvp)->tv_sec = (tvp)->tv_sec - (uvp)->tv_sec;    \
-    (vvp)->tv_usec = (tvp)->tv_usec - (uvp)->tv_usec; \
-    if ((vvp)->tv_usec < 0) {                         \
-      (vvp)->tv_sec--;                                \
-      (vvp)->tv_usec += 1000000;                      \
-    }                                                 \
-  } while (0)
-
-#define NW_GTPV2C_TIMER_CMP_P(a, b, CMP)                         \
-  (((a)->tv_sec == (b)->tv_sec) ? ((a)->tv_usec CMP(b)->tv_usec) \
-                                : ((a)->tv_sec CMP(b)->tv_sec))
-
-#endif
-
 #define NW_GTPV2C_INIT_MSG_IE_PARSE_INFO(__thiz, __msgType)               \
   do {                                                                    \
     __thiz->pGtpv2cMsgIeParseInfo[__msgType] = nwGtpv2cMsgIeParseInfoNew( \
@@ -95,118 +63,6 @@
 extern "C" {
 #endif
 
-static nw_gtpv2c_timeout_info_t* gpGtpv2cTimeoutInfoPool = NULL;
-
-typedef struct {
-  int currSize;
-  int maxSize;
-  nw_gtpv2c_timeout_info_t** pHeap;
-} NwGtpv2cTmrMinHeapT;
-
-#define NW_HEAP_PARENT_INDEX(__child) (((__child)-1) / 2)
-
-NwGtpv2cTmrMinHeapT* nwGtpv2cTmrMinHeapNew(int maxSize) {
-  NwGtpv2cTmrMinHeapT* thiz =
-      (NwGtpv2cTmrMinHeapT*)malloc(sizeof(NwGtpv2cTmrMinHeapT));
-
-  if (thiz) {
-    thiz->currSize = 0;
-    thiz->maxSize = maxSize;
-    thiz->pHeap = (nw_gtpv2c_timeout_info_t**)malloc(
-        maxSize * sizeof(nw_gtpv2c_timeout_info_t*));
-  }
-
-  return thiz;
-}
-
-void nwGtpv2cTmrMinHeapDelete(NwGtpv2cTmrMinHeapT* thiz) {
-  free_wrapper((void**)&thiz->pHeap);
-  free_wrapper((void**)&thiz);
-}
-
-static nw_rc_t nwGtpv2cTmrMinHeapInsert(NwGtpv2cTmrMinHeapT* thiz,
-                                        nw_gtpv2c_timeout_info_t* pTimerEvent) {
-  int holeIndex = thiz->currSize++;
-
-  NW_ASSERT(thiz->currSize < thiz->maxSize);
-
-  while ((holeIndex > 0) &&
-         NW_GTPV2C_TIMER_CMP_P(
-             &(thiz->pHeap[NW_HEAP_PARENT_INDEX(holeIndex)])->tvTimeout,
-             &(pTimerEvent->tvTimeout), >)) {
-    thiz->pHeap[holeIndex] = thiz->pHeap[NW_HEAP_PARENT_INDEX(holeIndex)];
-    thiz->pHeap[holeIndex]->timerMinHeapIndex = holeIndex;
-    holeIndex = NW_HEAP_PARENT_INDEX(holeIndex);
-  }
-
-  thiz->pHeap[holeIndex] = pTimerEvent;
-  pTimerEvent->timerMinHeapIndex = holeIndex;
-  return holeIndex;
-}
-
-#define NW_MIN_HEAP_INDEX_INVALID (0xFFFFFFFF)
-static nw_rc_t nwGtpv2cTmrMinHeapRemove(NwGtpv2cTmrMinHeapT* thiz,
-                                        int minHeapIndex) {
-  nw_gtpv2c_timeout_info_t* pTimerEvent = NULL;
-  int holeIndex = minHeapIndex;
-  int minChild = 0, maxChild = 0;
-
-  if (minHeapIndex == NW_MIN_HEAP_INDEX_INVALID) return NW_FAILURE;
-
-  if (minHeapIndex < thiz->currSize) {
-    thiz->pHeap[minHeapIndex]->timerMinHeapIndex = NW_MIN_HEAP_INDEX_INVALID;
-    thiz->currSize--;
-    pTimerEvent = thiz->pHeap[thiz->currSize];
-    holeIndex = minHeapIndex;
-    minChild = (2 * holeIndex) + 1;
-    maxChild = minChild + 1;
-
-    while ((maxChild) <= thiz->currSize) {
-      if (NW_GTPV2C_TIMER_CMP_P(&(thiz->pHeap[minChild]->tvTimeout),
-                                &(thiz->pHeap[maxChild]->tvTimeout), >))
-        minChild = maxChild;
-
-      if (NW_GTPV2C_TIMER_CMP_P(&(pTimerEvent->tvTimeout),
-                                &(thiz->pHeap[minChild]->tvTimeout), <)) {
-        break;
-      }
-
-      thiz->pHeap[holeIndex] = thiz->pHeap[minChild];
-      thiz->pHeap[holeIndex]->timerMinHeapIndex = holeIndex;
-      holeIndex = minChild;
-      minChild = (2 * holeIndex) + 1;
-      maxChild = minChild + 1;
-    }
-
-    while ((holeIndex > 0) &&
-           NW_GTPV2C_TIMER_CMP_P(
-               &((thiz->pHeap[NW_HEAP_PARENT_INDEX(holeIndex)])->tvTimeout),
-               &(pTimerEvent->tvTimeout), >)) {
-      thiz->pHeap[holeIndex] = thiz->pHeap[NW_HEAP_PARENT_INDEX(holeIndex)];
-      thiz->pHeap[holeIndex]->timerMinHeapIndex = holeIndex;
-      holeIndex = NW_HEAP_PARENT_INDEX(holeIndex);
-    }
-
-    if (holeIndex < thiz->currSize) {
-      thiz->pHeap[holeIndex] = pTimerEvent;
-      pTimerEvent->timerMinHeapIndex = holeIndex;
-    }
-
-    thiz->pHeap[thiz->currSize] = NULL;
-    return NW_OK;
-  }
-
-  return NW_FAILURE;
-}
-
-static nw_gtpv2c_timeout_info_t* nwGtpv2cTmrMinHeapPeek(
-    NwGtpv2cTmrMinHeapT* thiz) {
-  if (thiz->currSize) {
-    return thiz->pHeap[0];
-  }
-
-  return NULL;
-}
 /*--------------------------------------------------------------------------*
                       P R I V A T E    F U N C T I O N S
   --------------------------------------------------------------------------*/
@@ -342,9 +198,51 @@ static void nwGtpv2cDisplayBanner(nw_gtpv2c_stack_t* thiz) {
 }
 
 /*---------------------------------------------------------------------------
-   Tunnel RBTree Search Data Structure
+   Peer key hashing
   --------------------------------------------------------------------------*/
 
+/**
+  Hash an identifier (TEID or sequence number) together with the peer
+  address, and optionally the peer port. Fields hashed here must be a subset
+  of the ones the matching comparator looks at.
+
+  @param[in] id: TEID or sequence number.
+  @param[in] peer: Peer address, AF_INET or AF_INET6.
+  @param[in] port: Peer port, 0 if not part of the key.
+  @return The 32 bit hash.
+*/
+
+static inline uint32_t nwGtpv2cHashPeerKey(uint32_t id, struct sockaddr* peer,
+                                           uint32_t port) {
+  uint32_t hash = id * 0x9e3779b1 ^ peer->sa_family;
+
+  if (peer->sa_family == AF_INET) {
+    hash = (hash ^ ((struct sockaddr_in*)peer)->sin_addr.s_addr) * 0x85ebca6b;
+  } else {
+    uint32_t word;
+    for (int i = 0; i < 16; i += 4) {
+      memcpy(&word, &((struct sockaddr_in6*)peer)->sin6_addr.s6_addr[i], 4);
+      hash = (hash ^ word) * 0x85ebca6b;
+    }
+  }
+  hash ^= port;
+  // Final avalanche (murmur3 fmix32)
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6b;
+  hash ^= hash >> 13;
+  hash *= 0xc2b2ae35;
+  hash ^= hash >> 16;
+  return hash;
+}
+
+/*---------------------------------------------------------------------------
+   Tunnel Hash Table Search Data Structure
+  --------------------------------------------------------------------------*/
+
+static inline uint32_t nwGtpv2cHashTunnel(struct nw_gtpv2c_tunnel_s* a) {
+  return nwGtpv2cHashPeerKey(a->teid, (struct sockaddr*)&a->ipAddrRemote, 0);
+}
+
 /**
   Comparator funtion for comparing two sequence number transactions.
 
@@ -390,12 +288,22 @@ static inline int32_t nwGtpv2cCompareTunnel(struct nw_gtpv2c_tunnel_s* a,
   return 0;
 }
 
-RB_GENERATE(NwGtpv2cTunnelMap, nw_gtpv2c_tunnel_s, tunnelMapRbtNode,
-            nwGtpv2cCompareTunnel)
+HASH_GENERATE(NwGtpv2cTunnelMap, nw_gtpv2c_tunnel_s, tunnelMapHashNode,
+              nwGtpv2cHashTunnel, nwGtpv2cCompareTunnel)
 
 /*---------------------------------------------------------------------------
-   Transaction RBTree Search Data Structure
+   Transaction Hash Table Search Data Structures
   --------------------------------------------------------------------------*/
+
+static inline uint32_t nwGtpv2cHashTxTrxn(struct nw_gtpv2c_trxn_s* a) {
+  return nwGtpv2cHashPeerKey(a->seqNum, (struct sockaddr*)&a->peer_ip, 0);
+}
+
+static inline uint32_t nwGtpv2cHashRxTrxn(struct nw_gtpv2c_trxn_s* a) {
+  return nwGtpv2cHashPeerKey(a->seqNum, (struct sockaddr*)&a->peer_ip,
+                             a->peerPort);
+}
+
 /**
   Comparator funtion for comparing two outstancing TX transactions.
 
@@ -439,9 +347,9 @@ static inline int32_t nwGtpv2cCompareOutstandingTxSeqNumTrxn(
   return 0;
 }
 
-RB_GENERATE(NwGtpv2cOutstandingTxSeqNumTrxnMap, nw_gtpv2c_trxn_s,
-            outstandingTxSeqNumMapRbtNode,
-            nwGtpv2cCompareOutstandingTxSeqNumTrxn)
+HASH_GENERATE(NwGtpv2cOutstandingTxSeqNumTrxnMap, nw_gtpv2c_trxn_s,
+              outstandingTxSeqNumMapHashNode, nwGtpv2cHashTxTrxn,
+              nwGtpv2cCompareOutstandingTxSeqNumTrxn)
 
 /**
   Comparator funtion for comparing outstanding RX transactions.
@@ -478,8 +386,10 @@ static inline int32_t nwGtpv2cCompareOutstandingRxSeqNumTrxn(
   } else {
     DevAssert(((struct sockaddr*)&a->peer_ip)->sa_family == AF_INET6);
     /** Should return 1 if a is bigger. */
-    return memcmp(((struct sockaddr_in6*)&a->peer_ip)->sin6_addr.s6_addr,
-                  ((struct sockaddr_in6*)&b->peer_ip)->sin6_addr.s6_addr, 16);
+    int32_t rc =
+        memcmp(((struct sockaddr_in6*)&a->peer_ip)->sin6_addr.s6_addr,
+               ((struct sockaddr_in6*)&b->peer_ip)->sin6_addr.s6_addr, 16);
+    if (rc) return rc;
   }
 
   if (a->peerPort > b->peerPort) return 1;
@@ -489,33 +399,9 @@ static inline int32_t nwGtpv2cCompareOutstandingRxSeqNumTrxn(
   return 0;
 }
 
-RB_GENERATE(NwGtpv2cOutstandingRxSeqNumTrxnMap, nw_gtpv2c_trxn_s,
-            outstandingRxSeqNumMapRbtNode,
-            nwGtpv2cCompareOutstandingRxSeqNumTrxn)
-
-/*---------------------------------------------------------------------------
-   Timer RB-tree data structure.
-  --------------------------------------------------------------------------*/
-/**
-  Comparator funtion for comparing two outstancing TX transactions.
-
-  @param[in] a: Pointer to session a.
-  @param[in] b: Pointer to session b.
-  @return  An integer greater than, equal to or less than zero according to
-  whether the object pointed to by a is greater than, equal to or less than the
-  object pointed to by b.
-*/
-static inline int32_t nwGtpv2cCompareOutstandingTxRexmitTime(
-    struct nw_gtpv2c_timeout_info_s* a, struct nw_gtpv2c_timeout_info_s* b) {
-  if (NW_GTPV2C_TIMER_CMP_P(&a->tvTimeout, &b->tvTimeout, >)) return 1;
-
-  if (NW_GTPV2C_TIMER_CMP_P(&a->tvTimeout, &b->tvTimeout, <)) return -1;
-
-  return 0;
-}
-
-RB_GENERATE(NwGtpv2cActiveTimerList, nw_gtpv2c_timeout_info_s,
-            activeTimerListRbtNode, nwGtpv2cCompareOutstandingTxRexmitTime)
+HASH_GENERATE(NwGtpv2cOutstandingRxSeqNumTrxnMap, nw_gtpv2c_trxn_s,
+              outstandingRxSeqNumMapHashNode, nwGtpv2cHashRxTrxn,
+              nwGtpv2cCompareOutstandingRxSeqNumTrxn)
 
 /**
    Send msg to peer via data request to UDP Entity
@@ -622,7 +508,8 @@ static nw_rc_t nwGtpv2cCreateLocalTunnel(
   pTunnel = nwGtpv2cTunnelNew(thiz, teid, fa, hUlpTunnel);
 
   if (pTunnel) {
-    pCollision = RB_INSERT(NwGtpv2cTunnelMap, &(thiz->tunnelMap), pTunnel);
+    pCollision =
+        HASH_INSERT(NwGtpv2cTunnelMap, &(thiz->tunnelMap), pTunnel);
 
     if (pCollision) {
       rc = nwGtpv2cTunnelDelete(thiz, pTunnel);
@@ -658,8 +545,8 @@ static nw_rc_t nwGtpv2cDeleteLocalTunnel(
 
   OAILOG_FUNC_IN(LOG_GTPV2C);
 
-  pTunnel = RB_REMOVE(NwGtpv2cTunnelMap, &(thiz->tunnelMap),
-                      (nw_gtpv2c_tunnel_t*)hTunnel);
+  pTunnel = HASH_REMOVE(NwGtpv2cTunnelMap, &(thiz->tunnelMap),
+                        (nw_gtpv2c_tunnel_t*)hTunnel);
   NW_ASSERT(pTunnel == (nw_gtpv2c_tunnel_t*)hTunnel);
 
   inet_ntop(((struct sockaddr*)&pTunnel->ipAddrRemote)->sa_family,
@@ -712,9 +599,9 @@ static nw_rc_t nwGtpv2cHandleUlpInitialReq(NW_IN nw_gtpv2c_stack_t* thiz,
               ? sizeof(struct sockaddr_in)
               : sizeof(struct sockaddr_in6));
 
-      pLocalTunnel = RB_FIND(NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
+      pLocalTunnel =
+          HASH_FIND(NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
       if (!pLocalTunnel) {
-        pLocalTunnel = RB_MIN(NwGtpv2cTunnelMap, &(thiz->tunnelMap));
         OAILOG_WARNING(
             LOG_GTPV2C,
             "Request message received on non-existent teid 0x%x received! "
@@ -772,8 +659,8 @@ static nw_rc_t nwGtpv2cHandleUlpInitialReq(NW_IN nw_gtpv2c_stack_t* thiz,
 
       // Insert into search tree
 
-      pTrxn = RB_INSERT(NwGtpv2cOutstandingTxSeqNumTrxnMap,
-                        &(thiz->outstandingTxSeqNumMap), pTrxn);
+      pTrxn = HASH_INSERT(NwGtpv2cOutstandingTxSeqNumTrxnMap,
+                          &(thiz->outstandingTxSeqNumMap), pTrxn);
       NW_ASSERT(pTrxn == NULL);
     } else {
       rc = nwGtpv2cTrxnDelete(&pTrxn);
@@ -828,8 +715,8 @@ static nw_rc_t nwGtpv2cHandleUlpTriggeredReq(
 
       // Insert into search tree
 
-      RB_INSERT(NwGtpv2cOutstandingTxSeqNumTrxnMap,
-                &(thiz->outstandingTxSeqNumMap), pTrxn);
+      HASH_INSERT(NwGtpv2cOutstandingTxSeqNumTrxnMap,
+                  &(thiz->outstandingTxSeqNumMap), pTrxn);
 
       if (!pUlpReq->u_api_info.triggeredReqInfo.hTunnel) {
         rc = nwGtpv2cCreateLocalTunnel(
@@ -931,7 +818,8 @@ static nw_rc_t nwGtpv2cHandleUlpTriggeredRsp(
                ? sizeof(struct sockaddr_in)
                : sizeof(struct sockaddr_in6));
 
-    pLocalTunnel = RB_FIND(NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
+    pLocalTunnel =
+        HASH_FIND(NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
     char ip[INET6_ADDRSTRLEN];
     inet_ntop(AF_INET, (void*)&pReqTrxn->peer_ip, ip,
               ((struct sockaddr*)&pReqTrxn->peer_ip)->sa_family == AF_INET
@@ -988,8 +876,8 @@ static nw_rc_t nwGtpv2cHandleUlpTriggeredAck(
 
   /** A transaction of the initial request (cmd) for the triggered request
    * should exist. */
-  pAckTrxn = RB_FIND(NwGtpv2cOutstandingTxSeqNumTrxnMap,
-                     &(thiz->outstandingTxSeqNumMap), &keyTrxn);
+  pAckTrxn = HASH_FIND(NwGtpv2cOutstandingTxSeqNumTrxnMap,
+                       &(thiz->outstandingTxSeqNumMap), &keyTrxn);
 
   if (pAckTrxn) {
     OAILOG_INFO(
@@ -1055,7 +943,7 @@ static nw_rc_t nwGtpv2cHandleUlpCreateLocalTunnel(
       pUlpReq->u_api_info.createLocalTunnelInfo.peerIp,
       pUlpReq->u_api_info.triggeredRspInfo.hUlpTunnel);
   NW_ASSERT(pTunnel);
-  pCollision = RB_INSERT(NwGtpv2cTunnelMap, &(thiz->tunnelMap), pTunnel);
+  pCollision = HASH_INSERT(NwGtpv2cTunnelMap, &(thiz->tunnelMap), pTunnel);
 
   if (pCollision) {
     rc = nwGtpv2cTunnelDelete(thiz, pTunnel);
@@ -1199,7 +1087,8 @@ static nw_rc_t nwGtpv2cHandleUlpFindLocalTunnel(
          (((struct sockaddr*)&keyTunnel.ipAddrRemote)->sa_family == AF_INET)
              ? sizeof(struct sockaddr_in)
              : sizeof(struct sockaddr_in6));
-  pLocalTunnel = RB_FIND(NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
+  pLocalTunnel =
+      HASH_FIND(NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
   pUlpReq->u_api_info.findLocalTunnelInfo.hTunnel =
       (nw_gtpv2c_tunnel_handle_t)pLocalTunnel;
 
@@ -1287,7 +1176,8 @@ static nw_rc_t nwGtpv2cHandleInitialReq(NW_IN nw_gtpv2c_stack_t* thiz,
     memcpy((void*)&keyTunnel.ipAddrRemote, peerIp,
            (peerIp->sa_family == AF_INET) ? sizeof(struct sockaddr_in)
                                           : sizeof(struct sockaddr_in6));
-    pLocalTunnel = RB_FIND(NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
+    pLocalTunnel =
+        HASH_FIND(NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
 
     if (!pLocalTunnel) {
       OAILOG_WARNING(
@@ -1370,16 +1260,16 @@ static nw_rc_t nwGtpv2cHandleTriggeredReq(
 
   /** A transaction of the initial request (cmd) for the triggered request
    * should exist. */
-  pTrxn = RB_FIND(NwGtpv2cOutstandingTxSeqNumTrxnMap,
-                  &(thiz->outstandingTxSeqNumMap), &keyTrxn);
+  pTrxn = HASH_FIND(NwGtpv2cOutstandingTxSeqNumTrxnMap,
+                    &(thiz->outstandingTxSeqNumMap), &keyTrxn);
 
   if (pTrxn) {
     /**
      * We remove the transaction of the initial request and create a new
      * transaction the the received triggered request.
      */
-    RB_REMOVE(NwGtpv2cOutstandingTxSeqNumTrxnMap,
-              &(thiz->outstandingTxSeqNumMap), pTrxn);
+    HASH_REMOVE(NwGtpv2cOutstandingTxSeqNumTrxnMap,
+                &(thiz->outstandingTxSeqNumMap), pTrxn);
     rc = nwGtpv2cTrxnDelete(&pTrxn);
     NW_ASSERT(NW_OK == rc);
   } else {
@@ -1397,7 +1287,8 @@ static nw_rc_t nwGtpv2cHandleTriggeredReq(
     memcpy((void*)&keyTunnel.ipAddrRemote, peerIp,
            (peerIp->sa_family == AF_INET) ? sizeof(struct sockaddr_in)
                                           : sizeof(struct sockaddr_in6));
-    pLocalTunnel = RB_FIND(NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
+    pLocalTunnel =
+        HASH_FIND(NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
 
     if (!pLocalTunnel) {
       OAILOG_WARNING(
@@ -1469,8 +1360,8 @@ static nw_rc_t nwGtpv2cHandleTriggeredRsp(
       "%x.\n",
       msgType, msgBufLen, keyTrxn.seqNum);
 
-  pTrxn = RB_FIND(NwGtpv2cOutstandingTxSeqNumTrxnMap,
-                  &(thiz->outstandingTxSeqNumMap), &keyTrxn);
+  pTrxn = HASH_FIND(NwGtpv2cOutstandingTxSeqNumTrxnMap,
+                    &(thiz->outstandingTxSeqNumMap), &keyTrxn);
   uint8_t trx_flags = 0;
   if (pTrxn) {
     uint32_t hUlpTunnel;
@@ -1538,8 +1429,8 @@ static nw_rc_t nwGtpv2cHandleTriggeredRsp(
           "%x in conclusion (not late response). \n",
           msgType, keyTrxn.seqNum);
       /** Remove the transaction. */
-      RB_REMOVE(NwGtpv2cOutstandingTxSeqNumTrxnMap,
-                &(thiz->outstandingTxSeqNumMap), pTrxn);
+      HASH_REMOVE(NwGtpv2cOutstandingTxSeqNumTrxnMap,
+                  &(thiz->outstandingTxSeqNumMap), pTrxn);
       rc = nwGtpv2cTrxnDelete(&pTrxn);
       NW_ASSERT(NW_OK == rc);
       remove = false;
@@ -1584,13 +1475,35 @@ nw_rc_t nwGtpv2cInitialize(
     thiz->id = (uint32_t)thiz;
     thiz->seqNum = ((uint32_t)thiz) & 0x0000FFFF;
     OAI_GCC_DIAG_ON("-Wpointer-to-int-cast");
-    RB_INIT(&(thiz->tunnelMap));
-    RB_INIT(&(thiz->outstandingTxSeqNumMap));
-    RB_INIT(&(thiz->outstandingRxSeqNumMap));
-    RB_INIT(&(thiz->activeTimerList));
-    OAI_GCC_DIAG_OFF("-Wpointer-to-int-cast");
-    thiz->hTmrMinHeap = (NwPtrT)nwGtpv2cTmrMinHeapNew(10000);
-    OAI_GCC_DIAG_ON("-Wpointer-to-int-cast");
+    if (HASH_INIT(NwGtpv2cTunnelMap, &(thiz->tunnelMap),
+                  NW_GTPV2C_TUNNEL_MAP_INITIAL_SIZE) ||
+        HASH_INIT(NwGtpv2cOutstandingTxSeqNumTrxnMap,
+                  &(thiz->outstandingTxSeqNumMap),
+                  NW_GTPV2C_TRXN_MAP_INITIAL_SIZE) ||
+        HASH_INIT(NwGtpv2cOutstandingRxSeqNumTrxnMap,
+                  &(thiz->outstandingRxSeqNumMap),
+                  NW_GTPV2C_TRXN_MAP_INITIAL_SIZE)) {
+      HASH_FINALIZE(NwGtpv2cTunnelMap, &(thiz->tunnelMap));
+      HASH_FINALIZE(NwGtpv2cOutstandingTxSeqNumTrxnMap,
+                    &(thiz->outstandingTxSeqNumMap));
+      HASH_FINALIZE(NwGtpv2cOutstandingRxSeqNumTrxnMap,
+                    &(thiz->outstandingRxSeqNumMap));
+      free_wrapper((void**)&thiz);
+      *hGtpcStackHandle = (nw_gtpv2c_stack_handle_t)0;
+      return NW_FAILURE;
+    }
+
+    for (int i = 0; i < NW_GTPV2C_TMR_WHEEL_SLOTS; i++) {
+      LIST_INIT(&(thiz->tmrWheel.slots[i]));
+    }
+    clock_gettime(CLOCK_MONOTONIC, &(thiz->tmrWheel.epoch));
+    thiz->tmrWheel.tickInfo.hStack = (nw_gtpv2c_stack_handle_t)thiz;
+
+    nwGtpv2cPoolInit(&(thiz->msgPool), sizeof(nw_gtpv2c_msg_t), 32);
+    nwGtpv2cPoolInit(&(thiz->trxnPool), sizeof(nw_gtpv2c_trxn_t), 256);
+    nwGtpv2cPoolInit(&(thiz->tunnelPool), sizeof(nw_gtpv2c_tunnel_t), 256);
+    nwGtpv2cPoolInit(&(thiz->timeoutInfoPool),
+                     sizeof(nw_gtpv2c_timeout_info_t), 256);
     NW_GTPV2C_INIT_MSG_IE_PARSE_INFO(thiz, NW_GTP_ECHO_RSP);
 
     // For S11 interface
@@ -1762,11 +1675,22 @@ nw_rc_t nwGtpv2cFinalize(NW_IN nw_gtpv2c_stack_handle_t hGtpcStackHandle) {
       ((nw_gtpv2c_stack_t*)hGtpcStackHandle)
           ->pGtpv2cMsgIeParseInfo[NW_GTP_IDENTIFICATION_RSP]);
 
-  OAI_GCC_DIAG_OFF("-Wint-to-pointer-cast");
-  nwGtpv2cTmrMinHeapDelete(
-      (NwGtpv2cTmrMinHeapT*)((nw_gtpv2c_stack_t*)hGtpcStackHandle)
-          ->hTmrMinHeap);
-  OAI_GCC_DIAG_ON("-Wint-to-pointer-cast");
+  nw_gtpv2c_stack_t* thiz = (nw_gtpv2c_stack_t*)hGtpcStackHandle;
+  if (thiz->tmrWheel.ticking) {
+    thiz->tmrMgr.tmrStopCallback(thiz->tmrMgr.tmrMgrHandle,
+                                 thiz->tmrWheel.hTickTmr);
+    thiz->tmrWheel.ticking = false;
+  }
+  HASH_FINALIZE(NwGtpv2cTunnelMap, &(thiz->tunnelMap));
+  HASH_FINALIZE(NwGtpv2cOutstandingTxSeqNumTrxnMap,
+                &(thiz->outstandingTxSeqNumMap));
+  HASH_FINALIZE(NwGtpv2cOutstandingRxSeqNumTrxnMap,
+                &(thiz->outstandingRxSeqNumMap));
+  // Messages, transactions and tunnels still in use go with their slabs
+  nwGtpv2cPoolFinalize(&(thiz->msgPool));
+  nwGtpv2cPoolFinalize(&(thiz->trxnPool));
+  nwGtpv2cPoolFinalize(&(thiz->tunnelPool));
+  nwGtpv2cPoolFinalize(&(thiz->timeoutInfoPool));
   free_wrapper((void**)&hGtpcStackHandle);
   return NW_OK;
 }
@@ -2071,144 +1995,93 @@ nw_rc_t nwGtpv2cProcessUlpReq(NW_IN nw_gtpv2c_stack_handle_t hGtpcStackHandle,
 }
 
 /**
-   Process Timer timeout Request from Timer ULP Manager
+   Current timer wheel tick, counted from the stack epoch
 */
 
-nw_rc_t nwGtpv2cProcessTimeoutOld(void* arg) {
-  nw_rc_t rc = NW_FAILURE;
-  nw_gtpv2c_stack_t* thiz = NULL;
-  nw_gtpv2c_timeout_info_t* timeoutInfo = (nw_gtpv2c_timeout_info_t*)arg;
-  nw_gtpv2c_timeout_info_t* pNextTimeoutInfo = NULL;
-  struct timeval tv = {0};
-
-  NW_ASSERT(timeoutInfo != NULL);
-  thiz = (nw_gtpv2c_stack_t*)(((nw_gtpv2c_timeout_info_t*)timeoutInfo)->hStack);
-  NW_ASSERT(thiz != NULL);
-  OAILOG_FUNC_IN(LOG_GTPV2C);
-
-  if (thiz->activeTimerInfo == timeoutInfo) {
-    thiz->activeTimerInfo = NULL;
-    RB_REMOVE(NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-    timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-    gpGtpv2cTimeoutInfoPool = timeoutInfo;
-    rc = ((timeoutInfo)->timeoutCallbackFunc)(timeoutInfo->timeoutArg);
-  } else {
-    OAILOG_WARNING(
-        LOG_GTPV2C,
-        "Received timeout event from ULP for non-existent timeoutInfo 0x%p and "
-        "activeTimer 0x%p!\n",
-        timeoutInfo, thiz->activeTimerInfo);
-    OAILOG_FUNC_RETURN(LOG_GTPV2C, NW_OK);
-  }
-
-  NW_ASSERT(gettimeofday(&tv, NULL) == 0);
-
-  for ((timeoutInfo) =
-           RB_MIN(NwGtpv2cActiveTimerList, &(thiz->activeTimerList));
-       (timeoutInfo) != NULL;) {
-    if (NW_GTPV2C_TIMER_CMP_P(&timeoutInfo->tvTimeout, &tv, >)) break;
+static inline uint64_t nwGtpv2cTmrWheelNow(nw_gtpv2c_timer_wheel_t* wheel) {
+  struct timespec ts;
+  uint64_t elapsedMs;
 
-    pNextTimeoutInfo =
-        RB_NEXT(NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-    RB_REMOVE(NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-    timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-    gpGtpv2cTimeoutInfoPool = timeoutInfo;
-    rc = ((timeoutInfo)->timeoutCallbackFunc)(timeoutInfo->timeoutArg);
-    timeoutInfo = pNextTimeoutInfo;
-  }
-
-  // activeTimerInfo may be reset by the timeoutCallbackFunc call above
-  if (thiz->activeTimerInfo == NULL) {
-    timeoutInfo = RB_MIN(NwGtpv2cActiveTimerList, &(thiz->activeTimerList));
-
-    if (timeoutInfo) {
-      NW_GTPV2C_TIMER_SUB(&timeoutInfo->tvTimeout, &tv, &tv);
-      rc = thiz->tmrMgr.tmrStartCallback(
-          thiz->tmrMgr.tmrMgrHandle, tv.tv_sec * 1000 + tv.tv_usec / 1000,
-          timeoutInfo->tmrType, (void*)timeoutInfo, &timeoutInfo->hTimer);
-      NW_ASSERT(NW_OK == rc);
-      thiz->activeTimerInfo = timeoutInfo;
-    }
-  }
-
-  OAILOG_FUNC_RETURN(LOG_GTPV2C, rc);
+  NW_ASSERT(clock_gettime(CLOCK_MONOTONIC, &ts) == 0);
+  elapsedMs = (uint64_t)(ts.tv_sec - wheel->epoch.tv_sec) * 1000 +
+              (ts.tv_nsec - wheel->epoch.tv_nsec) / 1000000;
+  return elapsedMs / NW_GTPV2C_TMR_WHEEL_TICK_MS;
 }
 
+/**
+   Process Timer timeout Request from Timer ULP Manager
+*/
+
 nw_rc_t nwGtpv2cProcessTimeoutExt(zloop_t* loop, int timer_id, void* arg) {
   return nwGtpv2cProcessTimeout(arg);
 }
 
 nw_rc_t nwGtpv2cProcessTimeout(void* arg) {
-  nw_rc_t rc = NW_FAILURE;
+  nw_rc_t rc = NW_OK;
   nw_gtpv2c_stack_t* thiz = NULL;
+  nw_gtpv2c_timer_wheel_t* wheel = NULL;
   nw_gtpv2c_timeout_info_t* timeoutInfo = (nw_gtpv2c_timeout_info_t*)arg;
-  struct timeval tv = {0};
+  nw_gtpv2c_timeout_info_t* pNextTimeoutInfo = NULL;
+  LIST_HEAD(, nw_gtpv2c_timeout_info_s) expired;
+  uint64_t now;
 
   NW_ASSERT(timeoutInfo != NULL);
   thiz = (nw_gtpv2c_stack_t*)(timeoutInfo->hStack);
   NW_ASSERT(thiz != NULL);
   OAILOG_FUNC_IN(LOG_GTPV2C);
+  wheel = &thiz->tmrWheel;
 
-  if (thiz->activeTimerInfo == timeoutInfo) {
-    thiz->activeTimerInfo = NULL;
-    OAI_GCC_DIAG_OFF("-Wint-to-pointer-cast");
-    rc = nwGtpv2cTmrMinHeapRemove((NwGtpv2cTmrMinHeapT*)thiz->hTmrMinHeap,
-                                  timeoutInfo->timerMinHeapIndex);
-    OAI_GCC_DIAG_ON("-Wint-to-pointer-cast");
-    timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-    gpGtpv2cTimeoutInfoPool = timeoutInfo;
-    rc = ((timeoutInfo)->timeoutCallbackFunc)(timeoutInfo->timeoutArg);
-  } else {
+  if ((timeoutInfo != &wheel->tickInfo) || !wheel->ticking) {
     OAILOG_WARNING(LOG_GTPV2C,
                    "Received timeout event from ULP for "
-                   "non-existent timeoutInfo 0x%p and activeTimer 0x%p!\n",
-                   timeoutInfo, thiz->activeTimerInfo);
+                   "non-existent timeoutInfo 0x%p!\n",
+                   timeoutInfo);
     OAILOG_FUNC_RETURN(LOG_GTPV2C, NW_OK);
   }
 
-  NW_ASSERT(gettimeofday(&tv, NULL) == 0);
-  OAI_GCC_DIAG_OFF("-Wint-to-pointer-cast");
-  timeoutInfo = nwGtpv2cTmrMinHeapPeek((NwGtpv2cTmrMinHeapT*)thiz->hTmrMinHeap);
-  OAI_GCC_DIAG_ON("-Wint-to-pointer-cast");
-
-  while ((timeoutInfo) != NULL) {
-    if (NW_GTPV2C_TIMER_CMP_P(&timeoutInfo->tvTimeout, &tv, >)) break;
-
-    OAI_GCC_DIAG_OFF("-Wint-to-pointer-cast");
-    rc = nwGtpv2cTmrMinHeapRemove((NwGtpv2cTmrMinHeapT*)thiz->hTmrMinHeap,
-                                  timeoutInfo->timerMinHeapIndex);
-    OAI_GCC_DIAG_ON("-Wint-to-pointer-cast");
-    timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-    gpGtpv2cTimeoutInfoPool = timeoutInfo;
-    rc = ((timeoutInfo)->timeoutCallbackFunc)(timeoutInfo->timeoutArg);
-    OAI_GCC_DIAG_OFF("-Wint-to-pointer-cast");
-    timeoutInfo =
-        nwGtpv2cTmrMinHeapPeek((NwGtpv2cTmrMinHeapT*)thiz->hTmrMinHeap);
-    OAI_GCC_DIAG_ON("-Wint-to-pointer-cast");
+  LIST_INIT(&expired);
+  now = nwGtpv2cTmrWheelNow(wheel);
+  while (wheel->currTick < now) {
+    wheel->currTick++;
+    timeoutInfo = LIST_FIRST(
+        &wheel->slots[wheel->currTick & (NW_GTPV2C_TMR_WHEEL_SLOTS - 1)]);
+    while (timeoutInfo) {
+      pNextTimeoutInfo = LIST_NEXT(timeoutInfo, wheelSlotEntry);
+      if (timeoutInfo->rounds) {
+        timeoutInfo->rounds--;
+      } else {
+        LIST_REMOVE(timeoutInfo, wheelSlotEntry);
+        LIST_INSERT_HEAD(&expired, timeoutInfo, wheelSlotEntry);
+      }
+      timeoutInfo = pNextTimeoutInfo;
+    }
   }
 
-  // activeTimerInfo may be reset by the timeoutCallbackFunc call above
-  if (thiz->activeTimerInfo == NULL) {
-    OAI_GCC_DIAG_OFF("-Wint-to-pointer-cast");
-    timeoutInfo =
-        nwGtpv2cTmrMinHeapPeek((NwGtpv2cTmrMinHeapT*)thiz->hTmrMinHeap);
-    OAI_GCC_DIAG_ON("-Wint-to-pointer-cast");
-
-    if (timeoutInfo) {
-      NW_GTPV2C_TIMER_SUB(&timeoutInfo->tvTimeout, &tv, &tv);
-      rc = thiz->tmrMgr.tmrStartCallback(
-          thiz->tmrMgr.tmrMgrHandle, tv.tv_sec * 1000 + tv.tv_usec / 1000,
-          timeoutInfo->tmrType, (void*)timeoutInfo, &timeoutInfo->hTimer);
-      NW_ASSERT(NW_OK == rc);
-      thiz->activeTimerInfo = timeoutInfo;
-    }
+  // Callbacks may start or stop other timers, including expired ones
+  while ((timeoutInfo = LIST_FIRST(&expired)) != NULL) {
+    nw_rc_t (*timeoutCallbackFunc)(void*) = timeoutInfo->timeoutCallbackFunc;
+    void* timeoutArg = timeoutInfo->timeoutArg;
+
+    LIST_REMOVE(timeoutInfo, wheelSlotEntry);
+    timeoutInfo->armed = false;
+    wheel->activeTimers--;
+    nwGtpv2cPoolFree(&thiz->timeoutInfoPool, timeoutInfo);
+    rc = timeoutCallbackFunc(timeoutArg);
+  }
+
+  if (wheel->activeTimers == 0 && wheel->ticking) {
+    rc = thiz->tmrMgr.tmrStopCallback(thiz->tmrMgr.tmrMgrHandle,
+                                      wheel->hTickTmr);
+    wheel->ticking = false;
+    OAILOG_DEBUG(LOG_GTPV2C, "Stopped timer wheel tick 0x%" PRIxPTR "\n",
+                 wheel->hTickTmr);
   }
 
   OAILOG_FUNC_RETURN(LOG_GTPV2C, rc);
 }
 
 /**
-   Start Timer with ULP Timer Manager
+   Start Timer on the stack timer wheel
 */
 
 nw_rc_t nwGtpv2cStartTimer(nw_gtpv2c_stack_t* thiz, uint32_t timeoutSec,
@@ -2217,77 +2090,49 @@ nw_rc_t nwGtpv2cStartTimer(nw_gtpv2c_stack_t* thiz, uint32_t timeoutSec,
                            void* timeoutCallbackArg,
                            nw_gtpv2c_timer_handle_t* phTimer) {
   nw_rc_t rc = NW_OK;
-  struct timeval tv = {0};
+  nw_gtpv2c_timer_wheel_t* wheel = &thiz->tmrWheel;
   nw_gtpv2c_timeout_info_t* timeoutInfo = NULL;
+  uint64_t timeoutMs = (uint64_t)timeoutSec * 1000 + timeoutUsec / 1000;
+  uint64_t ticks, now, expiry;
 
   OAILOG_FUNC_IN(LOG_GTPV2C);
+  NW_ASSERT(tmrType == NW_GTPV2C_TMR_TYPE_ONE_SHOT);
 
-  if (gpGtpv2cTimeoutInfoPool) {
-    timeoutInfo = gpGtpv2cTimeoutInfoPool;
-    gpGtpv2cTimeoutInfoPool = gpGtpv2cTimeoutInfoPool->next;
-  } else {
-    NW_GTPV2C_MALLOC(thiz, sizeof(nw_gtpv2c_timeout_info_t), timeoutInfo,
-                     nw_gtpv2c_timeout_info_t*);
+  timeoutInfo = (nw_gtpv2c_timeout_info_t*)nwGtpv2cPoolAlloc(
+      &thiz->timeoutInfoPool);
+  if (!timeoutInfo) {
+    *phTimer = (nw_gtpv2c_timer_handle_t)0;
+    OAILOG_FUNC_RETURN(LOG_GTPV2C, NW_FAILURE);
   }
 
-  if (timeoutInfo) {
-    timeoutInfo->tmrType = tmrType;
-    timeoutInfo->timeoutArg = timeoutCallbackArg;
-    timeoutInfo->timeoutCallbackFunc = timeoutCallbackFunc;
-    timeoutInfo->hStack = (nw_gtpv2c_stack_handle_t)thiz;
-    NW_ASSERT(gettimeofday(&tv, NULL) == 0);
-    NW_ASSERT(gettimeofday(&timeoutInfo->tvTimeout, NULL) == 0);
-    timeoutInfo->tvTimeout.tv_sec = timeoutSec;
-    timeoutInfo->tvTimeout.tv_usec = timeoutUsec;
-    NW_GTPV2C_TIMER_ADD(&tv, &timeoutInfo->tvTimeout, &timeoutInfo->tvTimeout);
-    OAI_GCC_DIAG_OFF("-Wint-to-pointer-cast");
-    rc = nwGtpv2cTmrMinHeapInsert((NwGtpv2cTmrMinHeapT*)thiz->hTmrMinHeap,
-                                  timeoutInfo);
-    OAI_GCC_DIAG_ON("-Wint-to-pointer-cast");
-#if 0
-
-      do {
-        collision = RB_INSERT (NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-
-        if (!collision)
-          break;
-
-        OAILOG_WARNING (LOG_GTPV2C,  "timer collision!\n");
-        timeoutInfo->tvTimeout.tv_usec++;       /* HACK: In case there is a collision, schedule this event 1 usec later */
-
-        if (timeoutInfo->tvTimeout.tv_usec > (999999 /*1000000 - 1 */ )) {
-          timeoutInfo->tvTimeout.tv_usec = 0;
-          timeoutInfo->tvTimeout.tv_sec++;
-        }
-      } while (1);
-
-#endif
-
-    if (thiz->activeTimerInfo) {
-      if (NW_GTPV2C_TIMER_CMP_P(&(thiz->activeTimerInfo->tvTimeout),
-                                &(timeoutInfo->tvTimeout), >)) {
-        //          OAILOG_DEBUG (LOG_GTPV2C, "Stopping active timer 0x%"
-        //          PRIxPTR " for info 0x%p!\n", thiz->activeTimerInfo->hTimer,
-        //          thiz->activeTimerInfo);
-        rc = thiz->tmrMgr.tmrStopCallback(thiz->tmrMgr.tmrMgrHandle,
-                                          thiz->activeTimerInfo->hTimer);
-        NW_ASSERT(NW_OK == rc);
-      } else {
-        OAILOG_DEBUG(LOG_GTPV2C,
-                     "Already Started timer 0x%" PRIxPTR " for info 0x%p!\n",
-                     thiz->activeTimerInfo->hTimer, thiz->activeTimerInfo);
-        *phTimer = (nw_gtpv2c_timer_handle_t)timeoutInfo;
-        OAILOG_FUNC_RETURN(LOG_GTPV2C, NW_OK);
-      }
-    }
-
+  timeoutInfo->timeoutArg = timeoutCallbackArg;
+  timeoutInfo->timeoutCallbackFunc = timeoutCallbackFunc;
+  timeoutInfo->hStack = (nw_gtpv2c_stack_handle_t)thiz;
+
+  // Round up and count from the end of the current, partly elapsed tick, a
+  // timer never fires early
+  ticks = (timeoutMs + NW_GTPV2C_TMR_WHEEL_TICK_MS - 1) /
+          NW_GTPV2C_TMR_WHEEL_TICK_MS;
+  if (ticks == 0) ticks = 1;
+  now = nwGtpv2cTmrWheelNow(wheel);
+  if (wheel->activeTimers == 0) wheel->currTick = now;
+  expiry = now + ticks + 1;
+  timeoutInfo->rounds =
+      (uint32_t)((expiry - wheel->currTick - 1) / NW_GTPV2C_TMR_WHEEL_SLOTS);
+  LIST_INSERT_HEAD(&wheel->slots[expiry & (NW_GTPV2C_TMR_WHEEL_SLOTS - 1)],
+                   timeoutInfo, wheelSlotEntry);
+  timeoutInfo->armed = true;
+  wheel->activeTimers++;
+
+  if (!wheel->ticking) {
     rc = thiz->tmrMgr.tmrStartCallback(
-        thiz->tmrMgr.tmrMgrHandle, timeoutSec * 1000 + timeoutUsec / 1000,
-        tmrType, (void*)timeoutInfo, &timeoutInfo->hTimer);
-    OAILOG_DEBUG(LOG_GTPV2C, "Started timer 0x%" PRIxPTR " for info 0x%p!\n",
-                 timeoutInfo->hTimer, timeoutInfo);
+        thiz->tmrMgr.tmrMgrHandle, NW_GTPV2C_TMR_WHEEL_TICK_MS,
+        NW_GTPV2C_TMR_TYPE_REPETITIVE, (void*)&wheel->tickInfo,
+        &wheel->hTickTmr);
     NW_ASSERT(NW_OK == rc);
-    thiz->activeTimerInfo = timeoutInfo;
+    wheel->ticking = true;
+    OAILOG_DEBUG(LOG_GTPV2C, "Started timer wheel tick 0x%" PRIxPTR "\n",
+                 wheel->hTickTmr);
   }
 
   *phTimer = (nw_gtpv2c_timer_handle_t)timeoutInfo;
@@ -2295,69 +2140,27 @@ nw_rc_t nwGtpv2cStartTimer(nw_gtpv2c_stack_t* thiz, uint32_t timeoutSec,
 }
 
 /**
-   Stop Timer with ULP Timer Manager
+   Stop Timer on the stack timer wheel
 */
 nw_rc_t nwGtpv2cStopTimer(nw_gtpv2c_stack_t* thiz,
                           nw_gtpv2c_timer_handle_t hTimer) {
-  nw_rc_t rc = NW_OK;
-  struct timeval tv;
   nw_gtpv2c_timeout_info_t* timeoutInfo;
 
   NW_ASSERT(thiz != NULL);
   OAILOG_FUNC_IN(LOG_GTPV2C);
   timeoutInfo = (nw_gtpv2c_timeout_info_t*)hTimer;
-  OAI_GCC_DIAG_OFF("-Wint-to-pointer-cast");
-  rc = nwGtpv2cTmrMinHeapRemove((NwGtpv2cTmrMinHeapT*)thiz->hTmrMinHeap,
-                                timeoutInfo->timerMinHeapIndex);
-  OAI_GCC_DIAG_ON("-Wint-to-pointer-cast");
-  timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-  gpGtpv2cTimeoutInfoPool = timeoutInfo;
-  //    OAILOG_DEBUG (LOG_GTPV2C, "Stopping active timer 0x%" PRIxPTR " for info
-  //    0x%p!\n", timeoutInfo->hTimer, timeoutInfo);
-
-  if (thiz->activeTimerInfo == timeoutInfo) {
-    OAILOG_DEBUG(LOG_GTPV2C,
-                 "Stopping active timer 0x%" PRIxPTR " for info 0x%p!\n",
-                 timeoutInfo->hTimer, timeoutInfo);
-    rc = thiz->tmrMgr.tmrStopCallback(thiz->tmrMgr.tmrMgrHandle,
-                                      timeoutInfo->hTimer);
-    thiz->activeTimerInfo = NULL;
-    if (NW_OK != rc) {
-      OAILOG_ERROR(LOG_GTPV2C,
-                   "Stopping active timer 0x%" PRIxPTR
-                   " for info 0x%p failed!\n",
-                   timeoutInfo->hTimer, timeoutInfo);
-    } else
-      OAILOG_INFO(LOG_GTPV2C,
-                  "Stopped active timer 0x%" PRIxPTR " for info 0x%p!\n",
-                  timeoutInfo->hTimer, timeoutInfo);
-    OAI_GCC_DIAG_OFF("-Wint-to-pointer-cast");
-    timeoutInfo =
-        nwGtpv2cTmrMinHeapPeek((NwGtpv2cTmrMinHeapT*)thiz->hTmrMinHeap);
-    OAI_GCC_DIAG_ON("-Wint-to-pointer-cast");
-
-    if (timeoutInfo) {
-      NW_ASSERT(gettimeofday(&tv, NULL) == 0);
-
-      if (NW_GTPV2C_TIMER_CMP_P(&timeoutInfo->tvTimeout, &tv, <)) {
-        thiz->activeTimerInfo = timeoutInfo;
-        rc = nwGtpv2cProcessTimeout(timeoutInfo);
-        NW_ASSERT(NW_OK == rc);
-      } else {
-        NW_GTPV2C_TIMER_SUB(&timeoutInfo->tvTimeout, &tv, &tv);
-        rc = thiz->tmrMgr.tmrStartCallback(
-            thiz->tmrMgr.tmrMgrHandle, tv.tv_sec * 1000 + tv.tv_usec / 1000,
-            timeoutInfo->tmrType, (void*)timeoutInfo, &timeoutInfo->hTimer);
-        NW_ASSERT(NW_OK == rc);
-        OAILOG_DEBUG(LOG_GTPV2C,
-                     "Started timer 0x%" PRIxPTR " for info 0x%p!\n",
-                     timeoutInfo->hTimer, timeoutInfo);
-        thiz->activeTimerInfo = timeoutInfo;
-      }
-    }
+
+  if (!timeoutInfo || !timeoutInfo->armed) {
+    OAILOG_WARNING(LOG_GTPV2C, "Stopping inactive timer 0x%p!\n", timeoutInfo);
+    OAILOG_FUNC_RETURN(LOG_GTPV2C, NW_FAILURE);
   }
 
-  OAILOG_FUNC_RETURN(LOG_GTPV2C, rc);
+  // The tick timer is stopped lazily, on the next tick with no timer armed
+  LIST_REMOVE(timeoutInfo, wheelSlotEntry);
+  timeoutInfo->armed = false;
+  thiz->tmrWheel.activeTimers--;
+  nwGtpv2cPoolFree(&thiz->timeoutInfoPool, timeoutInfo);
+  OAILOG_FUNC_RETURN(LOG_GTPV2C, NW_OK);
 }
 
 #ifdef __cplusplus
@@ -54,12 +54,6 @@
 extern "C" {
 #endif
 
-/*----------------------------------------------------------------------------*
-                       P R I V A T E     F U N C T I O N S
-  ----------------------------------------------------------------------------*/
-
-static nw_gtpv2c_msg_t* gpGtpv2cMsgPool = NULL;
-
 /*----------------------------------------------------------------------------*
                          P U B L I C   F U N C T I O N S
   ----------------------------------------------------------------------------*/
@@ -72,14 +66,7 @@ nw_rc_t nwGtpv2cMsgNew(NW_IN nw_gtpv2c_stack_handle_t hGtpcStackHandle,
   nw_gtpv2c_msg_t* pMsg;
   NW_ASSERT(pStack);
 
-  if (gpGtpv2cMsgPool) {
-    pMsg = gpGtpv2cMsgPool;
-    gpGtpv2cMsgPool = gpGtpv2cMsgPool->next;
-    memset(pMsg, 0, sizeof(nw_gtpv2c_msg_t));
-  } else {
-    NW_GTPV2C_MALLOC(pStack, sizeof(nw_gtpv2c_msg_t), pMsg, nw_gtpv2c_msg_t*);
-    OAILOG_DEBUG(LOG_GTPV2C, "ALLOCATED NEW MESSAGE %p!\n", pMsg);
-  }
+  pMsg = (nw_gtpv2c_msg_t*)nwGtpv2cPoolAlloc(&pStack->msgPool);
 
   if (pMsg) {
     pMsg->version = NW_GTP_VERSION;
@@ -106,13 +93,7 @@ nw_rc_t nwGtpv2cMsgFromBufferNew(
 
   NW_ASSERT(pStack);
 
-  if (gpGtpv2cMsgPool) {
-    pMsg = gpGtpv2cMsgPool;
-    gpGtpv2cMsgPool = gpGtpv2cMsgPool->next;
-    memset(pMsg, 0, sizeof(nw_gtpv2c_msg_t));
-  } else {
-    NW_GTPV2C_MALLOC(pStack, sizeof(nw_gtpv2c_msg_t), pMsg, nw_gtpv2c_msg_t*);
-  }
+  pMsg = (nw_gtpv2c_msg_t*)nwGtpv2cPoolAlloc(&pStack->msgPool);
 
   if (pMsg) {
     *phMsg = (nw_gtpv2c_msg_handle_t)pMsg;
@@ -141,11 +122,15 @@ nw_rc_t nwGtpv2cMsgFromBufferNew(
 
 nw_rc_t nwGtpv2cMsgDelete(NW_IN nw_gtpv2c_stack_handle_t hGtpcStackHandle,
                           NW_IN nw_gtpv2c_msg_handle_t hMsg) {
+  nw_gtpv2c_msg_t* pMsg = (nw_gtpv2c_msg_t*)hMsg;
+  // The message goes back to the pool of the stack that created it
+  nw_gtpv2c_stack_t* pStack = (nw_gtpv2c_stack_t*)pMsg->hStack;
+
+  NW_ASSERT(pStack);
   OAILOG_DEBUG(LOG_GTPV2C, "Purging message 0x%" PRIxPTR "!\n", hMsg);
-  ((nw_gtpv2c_msg_t*)hMsg)->next = gpGtpv2cMsgPool;
-  gpGtpv2cMsgPool = (nw_gtpv2c_msg_t*)hMsg;
-  OAILOG_DEBUG(LOG_GTPV2C, "Message pool %p! Next element %p !\n",
-               gpGtpv2cMsgPool, gpGtpv2cMsgPool->next);
+  nwGtpv2cPoolFree(&pStack->msgPool, pMsg);
+  OAILOG_DEBUG(LOG_GTPV2C, "Message pool in use %u/%u\n",
+               pStack->msgPool.inUse, pStack->msgPool.capacity);
 
   return NW_OK;
 }
@@ -0,0 +1,102 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lte/gateway/c/core/oai/lib/gtpv2-c/nwgtpv2c-0.11/include/NwGtpv2cPool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NW_GTPV2C_POOL_ALIGN (16)
+#define NW_GTPV2C_POOL_ROUND_UP(_size) \
+  (((_size) + NW_GTPV2C_POOL_ALIGN - 1) & ~(NW_GTPV2C_POOL_ALIGN - 1))
+
+/* Slab header, keeps the slabs chained for nwGtpv2cPoolFinalize */
+typedef struct nw_gtpv2c_pool_slab_s {
+  struct nw_gtpv2c_pool_slab_s* next;
+} nw_gtpv2c_pool_slab_t;
+
+#define NW_GTPV2C_POOL_SLAB_HDR_SIZE \
+  NW_GTPV2C_POOL_ROUND_UP(sizeof(nw_gtpv2c_pool_slab_t))
+
+//------------------------------------------------------------------------------
+void nwGtpv2cPoolInit(nw_gtpv2c_pool_t* thiz, uint32_t objSize,
+                      uint32_t objsPerSlab) {
+  memset(thiz, 0, sizeof(nw_gtpv2c_pool_t));
+  thiz->objSize = NW_GTPV2C_POOL_ROUND_UP(objSize);
+  thiz->objsPerSlab = objsPerSlab ? objsPerSlab : 1;
+}
+
+//------------------------------------------------------------------------------
+static int nwGtpv2cPoolGrow(nw_gtpv2c_pool_t* thiz) {
+  nw_gtpv2c_pool_slab_t* slab = (nw_gtpv2c_pool_slab_t*)malloc(
+      NW_GTPV2C_POOL_SLAB_HDR_SIZE + (size_t)thiz->objSize * thiz->objsPerSlab);
+  uint8_t* obj;
+
+  if (!slab) return -1;
+
+  slab->next = (nw_gtpv2c_pool_slab_t*)thiz->slabList;
+  thiz->slabList = slab;
+  // Hand out the slab front to back
+  obj = (uint8_t*)slab + NW_GTPV2C_POOL_SLAB_HDR_SIZE +
+        (size_t)thiz->objSize * (thiz->objsPerSlab - 1);
+  for (uint32_t i = 0; i < thiz->objsPerSlab; i++, obj -= thiz->objSize) {
+    *(void**)obj = thiz->freeList;
+    thiz->freeList = obj;
+  }
+  thiz->capacity += thiz->objsPerSlab;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void* nwGtpv2cPoolAlloc(nw_gtpv2c_pool_t* thiz) {
+  void* obj;
+
+  if (!thiz->freeList && nwGtpv2cPoolGrow(thiz) != 0) return NULL;
+
+  obj = thiz->freeList;
+  thiz->freeList = *(void**)obj;
+  thiz->inUse++;
+  memset(obj, 0, thiz->objSize);
+  return obj;
+}
+
+//------------------------------------------------------------------------------
+void nwGtpv2cPoolFree(nw_gtpv2c_pool_t* thiz, void* obj) {
+  if (!obj) return;
+  *(void**)obj = thiz->freeList;
+  thiz->freeList = obj;
+  thiz->inUse--;
+}
+
+//------------------------------------------------------------------------------
+void nwGtpv2cPoolFinalize(nw_gtpv2c_pool_t* thiz) {
+  nw_gtpv2c_pool_slab_t* slab = (nw_gtpv2c_pool_slab_t*)thiz->slabList;
+
+  while (slab) {
+    nw_gtpv2c_pool_slab_t* next = slab->next;
+    free(slab);
+    slab = next;
+  }
+  thiz->slabList = NULL;
+  thiz->freeList = NULL;
+  thiz->capacity = 0;
+  thiz->inUse = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -54,8 +54,6 @@
 extern "C" {
 #endif
 
-static nw_gtpv2c_trxn_t* gpGtpv2cTrxnPool = NULL;
-
 /*--------------------------------------------------------------------------*
                      P R I V A T E      F U N C T I O N S
   --------------------------------------------------------------------------*/
@@ -93,8 +91,8 @@ static nw_rc_t nwGtpv2cTrxnPeerRspWaitTimeout(void* arg) {
         "Transaction transaction %p (seqNo=0x%x) was acknowledged. Removing "
         "for timeout. \n",
         thiz, thiz->seqNum);
-    RB_REMOVE(NwGtpv2cOutstandingTxSeqNumTrxnMap,
-              &(pStack->outstandingTxSeqNumMap), thiz);
+    HASH_REMOVE(NwGtpv2cOutstandingTxSeqNumTrxnMap,
+                &(pStack->outstandingTxSeqNumMap), thiz);
     rc = nwGtpv2cTrxnDelete(&thiz);
     return rc;
   }
@@ -105,7 +103,8 @@ static nw_rc_t nwGtpv2cTrxnPeerRspWaitTimeout(void* arg) {
     keyTunnel.teid = thiz->teidLocal;
     memcpy((void*)&keyTunnel.ipAddrRemote, (void*)&thiz->peer_ip,
            sizeof(thiz->peer_ip));
-    pLocalTunnel = RB_FIND(NwGtpv2cTunnelMap, &(pStack->tunnelMap), &keyTunnel);
+    pLocalTunnel =
+        HASH_FIND(NwGtpv2cTunnelMap, &(pStack->tunnelMap), &keyTunnel);
     if (pLocalTunnel) {
       rc = nwGtpv2cTrxnSendMsgRetransmission(thiz);
       NW_ASSERT(NW_OK == rc);
@@ -118,8 +117,8 @@ static nw_rc_t nwGtpv2cTrxnPeerRspWaitTimeout(void* arg) {
           "Tunnel for local-TEID 0x%x is removed for request transaction %p "
           "(seqNo=0x%x)! Removing the trx and ignoring timeout. \n",
           thiz->teidLocal, thiz, thiz->seqNum);
-      RB_REMOVE(NwGtpv2cOutstandingTxSeqNumTrxnMap,
-                &(pStack->outstandingTxSeqNumMap), thiz);
+      HASH_REMOVE(NwGtpv2cOutstandingTxSeqNumTrxnMap,
+                  &(pStack->outstandingTxSeqNumMap), thiz);
       rc = nwGtpv2cTrxnDelete(&thiz);
     }
   } else {
@@ -140,8 +139,8 @@ static nw_rc_t nwGtpv2cTrxnPeerRspWaitTimeout(void* arg) {
     /** Set the flags. */
     ulpApi.u_api_info.rspFailureInfo.trx_flags = thiz->trx_flags;
     OAILOG_ERROR(LOG_GTPV2C, "N3 retries expired for transaction %p\n", thiz);
-    RB_REMOVE(NwGtpv2cOutstandingTxSeqNumTrxnMap,
-              &(pStack->outstandingTxSeqNumMap), thiz);
+    HASH_REMOVE(NwGtpv2cOutstandingTxSeqNumTrxnMap,
+                &(pStack->outstandingTxSeqNumMap), thiz);
     rc = nwGtpv2cTrxnDelete(&thiz);
     rc = pStack->ulp.ulpReqCallback(pStack->ulp.hUlp, &ulpApi);
   }
@@ -164,8 +163,8 @@ static nw_rc_t nwGtpv2cTrxnDuplicateRequestWaitTimeout(void* arg) {
       "%d\n",
       thiz, thiz->seqNum);
   thiz->hRspTmr = 0;
-  RB_REMOVE(NwGtpv2cOutstandingRxSeqNumTrxnMap,
-            &(pStack->outstandingRxSeqNumMap), thiz);
+  HASH_REMOVE(NwGtpv2cOutstandingRxSeqNumTrxnMap,
+              &(pStack->outstandingRxSeqNumMap), thiz);
   rc = nwGtpv2cTrxnDelete(&thiz);
   NW_ASSERT(NW_OK == rc);
   return rc;
@@ -235,19 +234,13 @@ static nw_rc_t nwGtpv2cTrxnStopPeerRspTimer(nw_gtpv2c_trxn_t* thiz) {
 nw_gtpv2c_trxn_t* nwGtpv2cTrxnNew(NW_IN nw_gtpv2c_stack_t* thiz) {
   nw_gtpv2c_trxn_t* pTrxn;
 
-  if (gpGtpv2cTrxnPool) {
-    pTrxn = gpGtpv2cTrxnPool;
-    gpGtpv2cTrxnPool = gpGtpv2cTrxnPool->next;
-  } else {
-    NW_GTPV2C_MALLOC(thiz, sizeof(nw_gtpv2c_trxn_t), pTrxn, nw_gtpv2c_trxn_t*);
-  }
+  pTrxn = (nw_gtpv2c_trxn_t*)nwGtpv2cPoolAlloc(&thiz->trxnPool);
 
   if (pTrxn) {
-    OAILOG_DEBUG(
-        LOG_GTPV2C,
-        "Created not trx without seqNum as transaction %p. Head %p, Next %p\n",
-        pTrxn, gpGtpv2cTrxnPool,
-        (gpGtpv2cTrxnPool) ? gpGtpv2cTrxnPool->next : NULL);
+    OAILOG_DEBUG(LOG_GTPV2C,
+                 "Created not trx without seqNum as transaction %p, "
+                 "%u in use\n",
+                 pTrxn, thiz->trxnPool.inUse);
 
     pTrxn->pStack = thiz;
     pTrxn->pMsg = NULL;
@@ -276,19 +269,13 @@ nw_gtpv2c_trxn_t* nwGtpv2cTrxnWithSeqNumNew(NW_IN nw_gtpv2c_stack_t* thiz,
                                             NW_IN uint32_t seqNum) {
   nw_gtpv2c_trxn_t* pTrxn;
 
-  if (gpGtpv2cTrxnPool) {
-    pTrxn = gpGtpv2cTrxnPool;
-    gpGtpv2cTrxnPool = gpGtpv2cTrxnPool->next;
-  } else {
-    NW_GTPV2C_MALLOC(thiz, sizeof(nw_gtpv2c_trxn_t), pTrxn, nw_gtpv2c_trxn_t*);
-  }
+  pTrxn = (nw_gtpv2c_trxn_t*)nwGtpv2cPoolAlloc(&thiz->trxnPool);
 
   if (pTrxn) {
-    OAILOG_DEBUG(
-        LOG_GTPV2C,
-        "Created new trx with seqNum %p as transaction %u. Head %p, Next %p\n",
-        pTrxn, seqNum, gpGtpv2cTrxnPool,
-        (gpGtpv2cTrxnPool) ? gpGtpv2cTrxnPool->next : NULL);
+    OAILOG_DEBUG(LOG_GTPV2C,
+                 "Created new trx with seqNum %p as transaction %u, "
+                 "%u in use\n",
+                 pTrxn, seqNum, thiz->trxnPool.inUse);
 
     pTrxn->pStack = thiz;
     pTrxn->pMsg = NULL;
@@ -324,17 +311,11 @@ nw_gtpv2c_trxn_t* nwGtpv2cTrxnOutstandingRxNew(NW_IN nw_gtpv2c_stack_t* thiz,
 
   // todo: ipv6 for retransmission1
 
-  if (gpGtpv2cTrxnPool) {
-    pTrxn = gpGtpv2cTrxnPool;
-    gpGtpv2cTrxnPool = gpGtpv2cTrxnPool->next;
-  } else {
-    NW_GTPV2C_MALLOC(thiz, sizeof(nw_gtpv2c_trxn_t), pTrxn, nw_gtpv2c_trxn_t*);
-  }
+  pTrxn = (nw_gtpv2c_trxn_t*)nwGtpv2cPoolAlloc(&thiz->trxnPool);
 
   if (pTrxn) {
-    OAILOG_DEBUG(
-        LOG_GTPV2C, "Received new Rx transaction %p, Head %p, Next %p\n", pTrxn,
-        gpGtpv2cTrxnPool, (gpGtpv2cTrxnPool) ? gpGtpv2cTrxnPool->next : NULL);
+    OAILOG_DEBUG(LOG_GTPV2C, "Received new Rx transaction %p, %u in use\n",
+                 pTrxn, thiz->trxnPool.inUse);
 
     pTrxn->pStack = thiz;
     pTrxn->maxRetries = 2;
@@ -347,8 +328,8 @@ nw_gtpv2c_trxn_t* nwGtpv2cTrxnOutstandingRxNew(NW_IN nw_gtpv2c_stack_t* thiz,
     pTrxn->pMsg = NULL;
     pTrxn->hRspTmr = 0;
     pTrxn->pt_trx = false;
-    pCollision = RB_INSERT(NwGtpv2cOutstandingRxSeqNumTrxnMap,
-                           &(thiz->outstandingRxSeqNumMap), pTrxn);
+    pCollision = HASH_INSERT(NwGtpv2cOutstandingRxSeqNumTrxnMap,
+                             &(thiz->outstandingRxSeqNumMap), pTrxn);
 
     if (pCollision) {
       OAILOG_WARNING(
@@ -414,18 +395,13 @@ nw_rc_t nwGtpv2cTrxnDelete(NW_INOUT nw_gtpv2c_trxn_t** pthiz) {
     NW_ASSERT(NW_OK == rc);
   }
 
-  OAILOG_DEBUG(
-      LOG_GTPV2C,
-      "Purging  transaction %p with seqNum %d. (before) Head %p, Next %p. \n",
-      thiz, thiz->seqNum, gpGtpv2cTrxnPool,
-      (gpGtpv2cTrxnPool) ? gpGtpv2cTrxnPool->next : 0);
-  thiz->next = gpGtpv2cTrxnPool;
-  gpGtpv2cTrxnPool = thiz;
+  OAILOG_DEBUG(LOG_GTPV2C, "Purging  transaction %p with seqNum %d.\n", thiz,
+               thiz->seqNum);
+  nwGtpv2cPoolFree(&pStack->trxnPool, thiz);
   *pthiz = NULL;
 
-  OAILOG_DEBUG(LOG_GTPV2C, "After purging  transaction %p, Head %p, Next %p\n",
-               thiz, gpGtpv2cTrxnPool,
-               (gpGtpv2cTrxnPool) ? gpGtpv2cTrxnPool->next : NULL);
+  OAILOG_DEBUG(LOG_GTPV2C, "After purging  transaction %p, %u in use\n", thiz,
+               pStack->trxnPool.inUse);
 
   return rc;
 }
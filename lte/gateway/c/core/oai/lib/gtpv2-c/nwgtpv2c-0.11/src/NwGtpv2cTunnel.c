@@ -46,24 +46,15 @@
 extern "C" {
 #endif
 
-static nw_gtpv2c_tunnel_t* gpGtpv2cTunnelPool = NULL;
-
 //------------------------------------------------------------------------------
 nw_gtpv2c_tunnel_t* nwGtpv2cTunnelNew(
     struct nw_gtpv2c_stack_s* pStack, uint32_t teid,
     struct sockaddr* ipAddrRemote, nw_gtpv2c_ulp_tunnel_handle_t hUlpTunnel) {
   nw_gtpv2c_tunnel_t* thiz;
 
-  if (gpGtpv2cTunnelPool) {
-    thiz = gpGtpv2cTunnelPool;
-    gpGtpv2cTunnelPool = gpGtpv2cTunnelPool->next;
-  } else {
-    NW_GTPV2C_MALLOC(pStack, sizeof(nw_gtpv2c_tunnel_t), thiz,
-                     nw_gtpv2c_tunnel_t*);
-  }
+  thiz = (nw_gtpv2c_tunnel_t*)nwGtpv2cPoolAlloc(&pStack->tunnelPool);
 
   if (thiz) {
-    memset(thiz, 0, sizeof(nw_gtpv2c_tunnel_t));
     thiz->teid = teid;
     memcpy((void*)&thiz->ipAddrRemote, ipAddrRemote,
            ipAddrRemote->sa_family == AF_INET ? sizeof(struct sockaddr_in)
@@ -74,11 +65,9 @@ nw_gtpv2c_tunnel_t* nwGtpv2cTunnelNew(
 }
 
 //------------------------------------------------------------------------------
-nw_rc_t nwGtpv2cTunnelDelete(
-    __attribute__((unused)) struct nw_gtpv2c_stack_s* pStack,
-    nw_gtpv2c_tunnel_t* thiz) {
-  thiz->next = gpGtpv2cTunnelPool;
-  gpGtpv2cTunnelPool = thiz;
+nw_rc_t nwGtpv2cTunnelDelete(struct nw_gtpv2c_stack_s* pStack,
+                             nw_gtpv2c_tunnel_t* thiz) {
+  nwGtpv2cPoolFree(&pStack->tunnelPool, thiz);
   return NW_OK;
 }
 
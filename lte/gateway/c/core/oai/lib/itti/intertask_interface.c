@@ -41,6 +41,7 @@
 
 #include "lte/gateway/c/core/oai/common/assertions.h"
 #include "lte/gateway/c/core/oai/lib/itti/intertask_interface.h"
+#include "lte/gateway/c/core/oai/lib/itti/itti_stats.h"
 #include "lte/gateway/c/core/oai/common/common_defs.h"
 
 /* Includes "intertask_interface_init.h" to check prototype coherence, but
@@ -127,6 +128,9 @@ status_code_e send_msg_to_task(task_zmq_ctx_t* task_zmq_ctx_p,
         message, sizeof(MessageHeader) + message->ittiMsgHeader.ittiMsgSize);
     assert(frame);
 
+    // Counted before the send, for the receiver not to dequeue it first
+    itti_stats_enqueue(destination_task_id);
+
     // Protect against multiple threads using this context
     pthread_mutex_lock(&task_zmq_ctx_p->send_mutex);
     int rc =
@@ -154,6 +158,7 @@ MessageDef* receive_msg(zsock_t* reader) {
   memcpy(msg, zframe_data(msg_frame), zframe_size(msg_frame));
 
   zframe_destroy(&msg_frame);
+  itti_stats_dequeue(msg);
   return msg;
 }
 
@@ -164,6 +169,7 @@ void send_broadcast_msg(task_zmq_ctx_t* task_zmq_ctx_p, MessageDef* message) {
 
   for (int i = 0; i < TASK_MAX; i++) {
     if (task_zmq_ctx_p->push_socks[i]) {
+      itti_stats_enqueue(i);
       // Reuse the same frame
       int rc = zframe_send(&frame, task_zmq_ctx_p->push_socks[i], ZFRAME_REUSE);
       assert(rc == 0);
@@ -215,8 +221,12 @@ void init_task_context(task_id_t task_id, const task_id_t* remote_task_ids,
     AssertFatal(task_zmq_ctx_p->pull_sock, "task id: %d uri: %s", task_id,
                 itti_desc.tasks_info[task_id].uri);
 
+    // The handler runs under a wrapper accounting its messages to the task
+    void* handler_arg = NULL;
+    zloop_reader_fn* reader =
+        itti_stats_wrap_handler(task_id, msg_handler, &handler_arg);
     int rc = zloop_reader(task_zmq_ctx_p->event_loop, task_zmq_ctx_p->pull_sock,
-                          msg_handler, NULL);
+                          reader, handler_arg);
     assert(rc == 0);
   }
 
@@ -0,0 +1,295 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lte/gateway/c/core/oai/common/assertions.h"
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface.h"
+#include "lte/gateway/c/core/oai/lib/itti/itti_stats.h"
+
+// Slowest handler records pack the execution time above the message id
+#define SLOWEST_MESSAGE_ID_BITS 16
+#define SLOWEST_MAX_US ((UINT64_C(1) << (64 - SLOWEST_MESSAGE_ID_BITS)) - 1)
+
+_Static_assert(MESSAGES_ID_MAX <= (1 << SLOWEST_MESSAGE_ID_BITS),
+               "Message ids do not fit in the slowest handler records");
+
+const uint64_t itti_stats_bucket_bounds_us[ITTI_STATS_BUCKETS - 1] = {
+    10,    25,    50,     100,    250,    500,    1000,   2500,
+    5000,  10000, 25000,  50000,  100000, 250000, 500000, 1000000};
+
+typedef struct itti_slowest_s {
+  // Index of the window of ITTI_STATS_SLOWEST_WINDOW_SEC of the record
+  uint64_t window;
+  // Execution time in microseconds << SLOWEST_MESSAGE_ID_BITS | message id
+  uint64_t packed;
+} itti_slowest_t;
+
+typedef struct itti_task_stats_s {
+  // Added to by every sender, on its own cache line
+  uint64_t enqueued __attribute__((aligned(64)));
+  // Everything below is written by the task thread only
+  uint64_t dequeued __attribute__((aligned(64)));
+  zloop_reader_fn* msg_handler;
+  // Current and previous windows, by window parity
+  itti_slowest_t slowest[2];
+  // Allocated on the first reception of each message id
+  itti_msg_stats_t* messages[MESSAGES_ID_MAX];
+} itti_task_stats_t;
+
+static itti_task_stats_t itti_task_stats[TASK_MAX];
+
+// Message being handled by the calling task thread
+static __thread itti_task_stats_t* current_task_stats;
+static __thread bool current_dequeued;
+static __thread MessagesIds current_message_id;
+static __thread struct timespec current_dequeue_time;
+
+static uint64_t elapsed_us(const struct timespec* from,
+                           const struct timespec* to) {
+  int64_t usec = 1000000 * (int64_t)(to->tv_sec - from->tv_sec) +
+                 (to->tv_nsec - from->tv_nsec) / 1000;
+  return usec > 0 ? (uint64_t)usec : 0;
+}
+
+// Increment of a value with a single writer, readable by other threads
+static inline void stat_add(uint64_t* stat, uint64_t value) {
+  __atomic_store_n(stat, __atomic_load_n(stat, __ATOMIC_RELAXED) + value,
+                   __ATOMIC_RELAXED);
+}
+
+static inline uint64_t stat_read(const uint64_t* stat) {
+  return __atomic_load_n(stat, __ATOMIC_RELAXED);
+}
+
+static void histogram_record(itti_histogram_t* histogram, uint64_t usec) {
+  int bucket = 0;
+  while (bucket < ITTI_STATS_BUCKETS - 1 &&
+         usec > itti_stats_bucket_bounds_us[bucket]) {
+    bucket++;
+  }
+  stat_add(&histogram->buckets[bucket], 1);
+  stat_add(&histogram->count, 1);
+  stat_add(&histogram->sum_us, usec);
+  if (usec > histogram->max_us) {
+    __atomic_store_n(&histogram->max_us, usec, __ATOMIC_RELAXED);
+  }
+}
+
+static void histogram_read(const itti_histogram_t* histogram,
+                           itti_histogram_t* copy) {
+  for (int bucket = 0; bucket < ITTI_STATS_BUCKETS; bucket++) {
+    copy->buckets[bucket] = stat_read(&histogram->buckets[bucket]);
+  }
+  copy->count = stat_read(&histogram->count);
+  copy->sum_us = stat_read(&histogram->sum_us);
+  copy->max_us = stat_read(&histogram->max_us);
+}
+
+static void slowest_record(itti_task_stats_t* task_stats, time_t now_sec,
+                           uint64_t usec, MessagesIds message_id) {
+  uint64_t window = (uint64_t)now_sec / ITTI_STATS_SLOWEST_WINDOW_SEC;
+  itti_slowest_t* slowest = &task_stats->slowest[window % 2];
+  uint64_t packed =
+      ((usec < SLOWEST_MAX_US ? usec : SLOWEST_MAX_US)
+       << SLOWEST_MESSAGE_ID_BITS) |
+      message_id;
+  if (slowest->window != window) {
+    __atomic_store_n(&slowest->packed, packed, __ATOMIC_RELAXED);
+    __atomic_store_n(&slowest->window, window, __ATOMIC_RELAXED);
+  } else if (packed > slowest->packed) {
+    __atomic_store_n(&slowest->packed, packed, __ATOMIC_RELAXED);
+  }
+}
+
+static int itti_stats_reader(zloop_t* loop, zsock_t* reader, void* arg) {
+  itti_task_stats_t* task_stats = (itti_task_stats_t*)arg;
+
+  current_task_stats = task_stats;
+  current_dequeued = false;
+  int rc = task_stats->msg_handler(loop, reader, NULL);
+  if (current_dequeued) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+    uint64_t usec = elapsed_us(&current_dequeue_time, &now);
+    histogram_record(&task_stats->messages[current_message_id]->handler, usec);
+    slowest_record(task_stats, now.tv_sec, usec, current_message_id);
+  }
+  current_task_stats = NULL;
+  return rc;
+}
+
+zloop_reader_fn* itti_stats_wrap_handler(task_id_t task_id,
+                                         zloop_reader_fn* msg_handler,
+                                         void** arg) {
+  AssertFatal(task_id < TASK_MAX, "Task id (%d) is out of range (%d)!\n",
+              task_id, TASK_MAX);
+  __atomic_store_n(&itti_task_stats[task_id].msg_handler, msg_handler,
+                   __ATOMIC_RELEASE);
+  *arg = &itti_task_stats[task_id];
+  return itti_stats_reader;
+}
+
+void itti_stats_enqueue(task_id_t destination_task_id) {
+  if (destination_task_id < TASK_MAX) {
+    __atomic_fetch_add(&itti_task_stats[destination_task_id].enqueued, 1,
+                       __ATOMIC_RELAXED);
+  }
+}
+
+void itti_stats_dequeue(const MessageDef* message) {
+  itti_task_stats_t* task_stats = current_task_stats;
+  MessagesIds message_id = message->ittiMsgHeader.messageId;
+  if (task_stats == NULL || message_id >= MESSAGES_ID_MAX) {
+    return;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC_RAW, &current_dequeue_time);
+  itti_msg_stats_t* msg_stats = task_stats->messages[message_id];
+  if (msg_stats == NULL) {
+    msg_stats = (itti_msg_stats_t*)calloc(1, sizeof(itti_msg_stats_t));
+    AssertFatal(msg_stats != NULL, "Message stats allocation failed!\n");
+    __atomic_store_n(&task_stats->messages[message_id], msg_stats,
+                     __ATOMIC_RELEASE);
+  }
+  histogram_record(
+      &msg_stats->queue_wait,
+      elapsed_us(&message->ittiMsgHeader.timestamp, &current_dequeue_time));
+  stat_add(&task_stats->dequeued, 1);
+  current_message_id = message_id;
+  current_dequeued = true;
+}
+
+bool itti_stats_read_task(task_id_t task_id, itti_task_stats_read_t* stats) {
+  if (task_id >= TASK_MAX) {
+    return false;
+  }
+  itti_task_stats_t* task_stats = &itti_task_stats[task_id];
+  if (__atomic_load_n(&task_stats->msg_handler, __ATOMIC_ACQUIRE) == NULL) {
+    return false;
+  }
+
+  // Dequeued first, so that the depth is never negative
+  stats->dequeued = stat_read(&task_stats->dequeued);
+  stats->enqueued = stat_read(&task_stats->enqueued);
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+  uint64_t window = (uint64_t)now.tv_sec / ITTI_STATS_SLOWEST_WINDOW_SEC;
+  uint64_t slowest = 0;
+  for (int i = 0; i < 2; i++) {
+    uint64_t slot_window = stat_read(&task_stats->slowest[i].window);
+    uint64_t packed = stat_read(&task_stats->slowest[i].packed);
+    if (slot_window + 1 >= window && packed > slowest) {
+      slowest = packed;
+    }
+  }
+  stats->slowest_handler_us = slowest >> SLOWEST_MESSAGE_ID_BITS;
+  stats->slowest_message_id = (MessagesIds)(
+      slowest & ((UINT64_C(1) << SLOWEST_MESSAGE_ID_BITS) - 1));
+  return true;
+}
+
+bool itti_stats_read_message(task_id_t task_id, MessagesIds message_id,
+                             itti_msg_stats_t* stats) {
+  if (task_id >= TASK_MAX || message_id >= MESSAGES_ID_MAX) {
+    return false;
+  }
+  const itti_msg_stats_t* msg_stats = __atomic_load_n(
+      &itti_task_stats[task_id].messages[message_id], __ATOMIC_ACQUIRE);
+  if (msg_stats == NULL) {
+    return false;
+  }
+  histogram_read(&msg_stats->queue_wait, &stats->queue_wait);
+  histogram_read(&msg_stats->handler, &stats->handler);
+  return true;
+}
+
+uint64_t itti_histogram_percentile(const itti_histogram_t* histogram,
+                                   double q) {
+  if (histogram->count == 0) {
+    return 0;
+  }
+  // Rank of the percentile, rounded up
+  double position = q * histogram->count;
+  uint64_t rank = (uint64_t)position;
+  if (rank < position || rank == 0) {
+    rank++;
+  }
+  uint64_t cumulative = 0;
+  for (int bucket = 0; bucket < ITTI_STATS_BUCKETS - 1; bucket++) {
+    cumulative += histogram->buckets[bucket];
+    if (cumulative >= rank) {
+      uint64_t bound = itti_stats_bucket_bounds_us[bucket];
+      return bound < histogram->max_us ? bound : histogram->max_us;
+    }
+  }
+  return histogram->max_us;
+}
+
+static void dump_histogram(FILE* out, const char* name,
+                           const itti_histogram_t* histogram) {
+  fprintf(out,
+          "    %-10s count %" PRIu64 " mean %" PRIu64 " us p50 %" PRIu64
+          " us p99 %" PRIu64 " us max %" PRIu64 " us\n",
+          name, histogram->count, histogram->sum_us / histogram->count,
+          itti_histogram_percentile(histogram, 0.5),
+          itti_histogram_percentile(histogram, 0.99), histogram->max_us);
+}
+
+void itti_stats_dump(FILE* out) {
+  for (task_id_t task_id = TASK_FIRST; task_id < TASK_MAX; task_id++) {
+    itti_task_stats_read_t task_stats;
+    if (!itti_stats_read_task(task_id, &task_stats)) {
+      continue;
+    }
+    fprintf(out, "%s: enqueued %" PRIu64 " dequeued %" PRIu64 " depth %" PRIu64,
+            itti_get_task_name(task_id), task_stats.enqueued,
+            task_stats.dequeued, task_stats.enqueued - task_stats.dequeued);
+    if (task_stats.slowest_handler_us > 0) {
+      fprintf(out, " slowest handler %" PRIu64 " us (%s)",
+              task_stats.slowest_handler_us,
+              itti_get_message_name(task_stats.slowest_message_id));
+    }
+    fprintf(out, "\n");
+
+    for (int message_id = 0; message_id < MESSAGES_ID_MAX; message_id++) {
+      itti_msg_stats_t msg_stats;
+      if (!itti_stats_read_message(task_id, (MessagesIds)message_id,
+                                   &msg_stats) ||
+          msg_stats.queue_wait.count == 0) {
+        continue;
+      }
+      fprintf(out, "  %s\n", itti_get_message_name((MessagesIds)message_id));
+      dump_histogram(out, "queue wait", &msg_stats.queue_wait);
+      if (msg_stats.handler.count > 0) {
+        dump_histogram(out, "handler", &msg_stats.handler);
+      }
+    }
+  }
+}
+
+int itti_stats_dump_file(const char* path) {
+  FILE* out = fopen(path, "w");
+  if (out == NULL) {
+    return -1;
+  }
+  itti_stats_dump(out);
+  return fclose(out) == 0 ? 0 : -1;
+}
@@ -0,0 +1,117 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @defgroup _itti_stats_ ITTI queue and handler statistics
+ * @ingroup _intertask_interface_impl_
+ * @{
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <czmq.h>
+
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface_types.h"
+
+/*
+ * Every task whose context has a message handler keeps:
+ *  - the number of messages sent to it and received by it, their difference
+ *    being its queue depth;
+ *  - per message id, histograms of the queue wait, from the allocation of the
+ *    message to its reception, and of the handler execution time, from the
+ *    reception to the return of the handler;
+ *  - the slowest handler execution of the last one to two windows of
+ *    ITTI_STATS_SLOWEST_WINDOW_SEC.
+ *
+ * The receiving task thread is the only writer of its histograms, and senders
+ * only add to a counter, so the statistics cost a few clock reads and
+ * increments per message. They are read without locking and may be
+ * momentarily inconsistent with each other.
+ */
+
+#define ITTI_STATS_SLOWEST_WINDOW_SEC 60
+
+// 16 bounded buckets of itti_stats_bucket_bounds_us and an unbounded one
+#define ITTI_STATS_BUCKETS 17
+
+typedef struct itti_histogram_s {
+  uint64_t buckets[ITTI_STATS_BUCKETS];
+  uint64_t count;
+  uint64_t sum_us;
+  uint64_t max_us;
+} itti_histogram_t;
+
+typedef struct itti_msg_stats_s {
+  itti_histogram_t queue_wait;
+  itti_histogram_t handler;
+} itti_msg_stats_t;
+
+typedef struct itti_task_stats_read_s {
+  uint64_t enqueued;
+  uint64_t dequeued;
+  // Slowest handler execution of the rolling window, 0 if none
+  uint64_t slowest_handler_us;
+  MessagesIds slowest_message_id;
+} itti_task_stats_read_t;
+
+// Upper bounds of the buckets in microseconds, 10 us to 1 s in 1-2.5-5 steps
+extern const uint64_t itti_stats_bucket_bounds_us[ITTI_STATS_BUCKETS - 1];
+
+/** \brief Wrap the message handler of a task context so that its executions
+ *   are accounted to the task
+ * \param task_id Task receiving the messages
+ * \param msg_handler Message handler of the task context
+ * \param arg Set to the argument to register with the returned reader
+ * @returns Reader to register on the pull socket of the task
+ **/
+zloop_reader_fn* itti_stats_wrap_handler(task_id_t task_id,
+                                         zloop_reader_fn* msg_handler,
+                                         void** arg);
+
+/** \brief Account a message sent to a task
+ **/
+void itti_stats_enqueue(task_id_t destination_task_id);
+
+/** \brief Account a message received by the task of the calling thread
+ **/
+void itti_stats_dequeue(const MessageDef* message);
+
+/** \brief Read the counters and slowest handler of a task
+ * @returns false if the task has no message handler
+ **/
+bool itti_stats_read_task(task_id_t task_id, itti_task_stats_read_t* stats);
+
+/** \brief Read the histograms of a message id received by a task
+ * @returns false if the task has not received this message id
+ **/
+bool itti_stats_read_message(task_id_t task_id, MessagesIds message_id,
+                             itti_msg_stats_t* stats);
+
+/** \brief Upper bound of the bucket holding the fraction q of the
+ *   observations, max_us for the unbounded bucket, 0 if no observation
+ **/
+uint64_t itti_histogram_percentile(const itti_histogram_t* histogram,
+                                   double q);
+
+/** \brief Write all the statistics as text
+ **/
+void itti_stats_dump(FILE* out);
+
+/** \brief Write all the statistics to a file, replacing it
+ * @returns 0 on success, -1 if the file cannot be written
+ **/
+int itti_stats_dump_file(const char* path);
+
+/* @} */
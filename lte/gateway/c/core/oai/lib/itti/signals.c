@@ -44,6 +44,10 @@
 #include "lte/gateway/c/core/oai/common/assertions.h"
 #include "lte/gateway/c/core/oai/lib/itti/signals.h"
 #include "lte/gateway/c/core/oai/lib/itti/intertask_interface_types.h"
+#include "lte/gateway/c/core/oai/lib/itti/itti_stats.h"
+
+// Written on SIGUSR1, with the pid of the process
+#define ITTI_STATS_DUMP_FILE "/tmp/itti_stats_%d.txt"
 
 #ifndef SIG_DEBUG
 #define SIG_DEBUG(x, args...)              \
@@ -118,6 +122,7 @@ int signal_mask(void) {
   sigaddset(&set, SIGABRT);
   sigaddset(&set, SIGINT);
   sigaddset(&set, SIGTERM);
+  sigaddset(&set, SIGUSR1);
 
   if (sigprocmask(SIG_BLOCK, &set, NULL) < 0) {
     perror("sigprocmask");
@@ -135,6 +140,7 @@ int signal_handle(int* end, task_zmq_ctx_t* task_ctx) {
   sigaddset(&set, SIGABRT);
   sigaddset(&set, SIGINT);
   sigaddset(&set, SIGTERM);
+  sigaddset(&set, SIGUSR1);
 
   if (sigprocmask(SIG_BLOCK, &set, NULL) < 0) {
     perror("sigprocmask");
@@ -160,6 +166,16 @@ int signal_handle(int* end, task_zmq_ctx_t* task_ctx) {
       backtrace_handle_signal(&info);
       break;
 
+    case SIGUSR1: {
+      char path[64];
+      snprintf(path, sizeof(path), ITTI_STATS_DUMP_FILE, getpid());
+      if (itti_stats_dump_file(path) == 0) {
+        SIG_DEBUG("ITTI statistics written to %s\n", path);
+      } else {
+        SIG_ERROR("Cannot write ITTI statistics to %s\n", path);
+      }
+    } break;
+
     case SIGINT:
     case SIGTERM:
       printf("Received SIGINT or SIGTERM\n");
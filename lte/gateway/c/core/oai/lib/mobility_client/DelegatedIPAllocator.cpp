@@ -0,0 +1,394 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lte/gateway/c/core/oai/lib/mobility_client/DelegatedIPAllocator.h"
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/log.h"
+}
+
+using grpc::Status;
+using magma::orc8r::Void;
+
+namespace magma {
+namespace lte {
+
+static uint32_t ipv4_from_bytes(const std::string& bytes) {
+  struct in_addr addr = {0};
+  if (bytes.size() == sizeof(in_addr)) {
+    memcpy(&addr, bytes.data(), sizeof(in_addr));
+  }
+  return ntohl(addr.s_addr);
+}
+
+static std::string ipv4_to_bytes(uint32_t addr) {
+  uint32_t net_addr = htonl(addr);
+  return std::string(reinterpret_cast<const char*>(&net_addr),
+                     sizeof(net_addr));
+}
+
+DelegatedIPAllocator::DelegatedIPAllocator(
+    IPBlockLeaseClient& client, const DelegatedIPAllocatorConfig& config)
+    : client_(client),
+      config_(config),
+      sync_in_flight_(false),
+      recovering_(false) {}
+
+void DelegatedIPAllocator::recover() {
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    recovering_ = true;
+  }
+  IPBlockLeaseHolder holder;
+  holder.set_holder(config_.holder);
+  client_.ListIPBlockLeasesAsync(
+      holder, [this](const Status& status, const IPBlockLeaseList& list) {
+        std::lock_guard<std::mutex> guard(lock_);
+        recovering_ = false;
+        if (!status.ok()) {
+          OAILOG_WARNING(LOG_UTIL,
+                         "Failed to recover IP block leases, code %d: %s\n",
+                         status.error_code(), status.error_message().c_str());
+          pending_reservations_.clear();
+          return;
+        }
+        for (const auto& lease : list.leases()) {
+          install_lease(lease);
+        }
+        // Whatever is left was allocated through mobilityd directly
+        pending_reservations_.clear();
+        OAILOG_INFO(LOG_UTIL, "Recovered %d IP block leases\n",
+                    list.leases_size());
+      });
+}
+
+bool DelegatedIPAllocator::allocate_ipv4(const std::string& imsi,
+                                         const std::string& apn,
+                                         struct in_addr* addr, int* vlan) {
+  bool allocated = false;
+  bool running_low = false;
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    auto now = std::chrono::steady_clock::now();
+    uint32_t total_free = 0;
+    for (auto& lease : leases_[apn]) {
+      if (is_revoked(*lease, now)) continue;
+      if (!allocated && lease->allocator.allocate(&addr->s_addr)) {
+        record(lease->lease_id, imsi, apn, addr->s_addr, false);
+        allocated_[apn][imsi] = addr->s_addr;
+        addr->s_addr = htonl(addr->s_addr);
+        *vlan = atoi(lease->vlan.c_str());
+        allocated = true;
+      }
+      total_free += lease->allocator.free_count();
+    }
+    // Top up ahead of time, while no other lease call is on its way
+    running_low = total_free < config_.low_watermark && !recovering_ &&
+                  may_request_lease(apn) &&
+                  pending_leases_.insert(apn).second;
+  }
+  if (running_low) {
+    request_lease(apn);
+  }
+  return allocated;
+}
+
+bool DelegatedIPAllocator::release_ipv4(const std::string& imsi,
+                                        const std::string& apn,
+                                        const struct in_addr& addr) {
+  std::lock_guard<std::mutex> guard(lock_);
+  uint32_t host_addr = ntohl(addr.s_addr);
+  auto lease = find_lease(apn, host_addr);
+  if (lease == nullptr || !lease->allocator.release(host_addr)) {
+    return false;
+  }
+  record(lease->lease_id, imsi, apn, host_addr, true);
+  auto apn_it = allocated_.find(apn);
+  if (apn_it != allocated_.end()) {
+    auto imsi_it = apn_it->second.find(imsi);
+    if (imsi_it != apn_it->second.end() && imsi_it->second == host_addr) {
+      apn_it->second.erase(imsi_it);
+    }
+  }
+  return true;
+}
+
+void DelegatedIPAllocator::reserve_ipv4(const std::string& imsi,
+                                        const std::string& apn,
+                                        const struct in_addr& addr) {
+  std::lock_guard<std::mutex> guard(lock_);
+  uint32_t host_addr = ntohl(addr.s_addr);
+  auto lease = find_lease(apn, host_addr);
+  if (lease != nullptr) {
+    lease->allocator.reserve(host_addr);
+    allocated_[apn][imsi] = host_addr;
+    return;
+  }
+  if (recovering_) {
+    IPAllocationRecord reservation;
+    reservation.mutable_entry()->mutable_sid()->set_id(imsi);
+    reservation.mutable_entry()->mutable_ip()->set_address(
+        ipv4_to_bytes(host_addr));
+    reservation.mutable_entry()->set_apn(apn);
+    pending_reservations_.push_back(std::move(reservation));
+  }
+}
+
+bool DelegatedIPAllocator::get_ipv4(const std::string& imsi,
+                                    const std::string& apn,
+                                    struct in_addr* addr) {
+  std::lock_guard<std::mutex> guard(lock_);
+  auto apn_it = allocated_.find(apn);
+  if (apn_it == allocated_.end()) return false;
+  auto imsi_it = apn_it->second.find(imsi);
+  if (imsi_it == apn_it->second.end()) return false;
+  addr->s_addr = htonl(imsi_it->second);
+  return true;
+}
+
+void DelegatedIPAllocator::tick() {
+  flush_sync();
+  renew_leases();
+}
+
+uint32_t DelegatedIPAllocator::free_count(const std::string& apn) {
+  std::lock_guard<std::mutex> guard(lock_);
+  auto now = std::chrono::steady_clock::now();
+  uint32_t total_free = 0;
+  for (auto& lease : leases_[apn]) {
+    if (!is_revoked(*lease, now)) total_free += lease->allocator.free_count();
+  }
+  return total_free;
+}
+
+size_t DelegatedIPAllocator::pending_sync_count() {
+  std::lock_guard<std::mutex> guard(lock_);
+  return pending_sync_.size();
+}
+
+bool DelegatedIPAllocator::is_revoked(
+    Lease& lease, std::chrono::steady_clock::time_point now) {
+  if (!lease.revoked && lease.expiry <= now) {
+    OAILOG_WARNING(LOG_UTIL, "IP block lease %lu expired before renewal\n",
+                   lease.lease_id);
+    lease.revoked = true;
+  }
+  return lease.revoked;
+}
+
+void DelegatedIPAllocator::install_lease(const IPBlockLease& lease) {
+  if (lease.block().version() != IPBlock::IPV4) {
+    OAILOG_ERROR(LOG_UTIL, "Ignoring non IPv4 lease %lu for apn %s\n",
+                 lease.lease_id(), lease.apn().c_str());
+    return;
+  }
+  auto net_addr = ipv4_from_bytes(lease.block().net_address());
+  auto prefix_len = lease.block().prefix_len();
+  if (prefix_len < 16 || prefix_len > 32) {
+    OAILOG_ERROR(LOG_UTIL, "Ignoring lease %lu with invalid prefix len %u\n",
+                 lease.lease_id(), prefix_len);
+    return;
+  }
+  auto installed =
+      std::make_unique<Lease>(lease.lease_id(), net_addr, prefix_len);
+  installed->vlan = lease.vlan();
+  installed->expiry = std::chrono::steady_clock::now() +
+                      std::chrono::seconds(lease.expires_in_secs());
+  auto& allocated = allocated_[lease.apn()];
+  for (const auto& entry : lease.allocated()) {
+    auto addr = ipv4_from_bytes(entry.ip().address());
+    installed->allocator.reserve(addr);
+    allocated[entry.sid().id()] = addr;
+  }
+  for (const auto& reservation : pending_reservations_) {
+    if (reservation.entry().apn() != lease.apn()) continue;
+    auto addr = ipv4_from_bytes(reservation.entry().ip().address());
+    if (!installed->allocator.contains(addr)) continue;
+    installed->allocator.reserve(addr);
+    allocated[reservation.entry().sid().id()] = addr;
+  }
+  OAILOG_INFO(LOG_UTIL,
+              "Installed IP block lease %lu for apn %s, %u of %u free\n",
+              lease.lease_id(), lease.apn().c_str(),
+              installed->allocator.free_count(),
+              installed->allocator.capacity());
+  leases_[lease.apn()].push_back(std::move(installed));
+}
+
+void DelegatedIPAllocator::request_lease(const std::string& apn) {
+  IPBlockLeaseRequest request;
+  request.set_holder(config_.holder);
+  request.set_apn(apn);
+  request.set_prefix_len(config_.lease_prefix_len);
+  client_.LeaseIPBlockAsync(
+      request, [this, apn](const Status& status, const IPBlockLease& lease) {
+        std::lock_guard<std::mutex> guard(lock_);
+        pending_leases_.erase(apn);
+        if (!status.ok()) {
+          // Back off before the next allocation may retry
+          auto it = lease_backoffs_.find(apn);
+          auto delay = std::chrono::milliseconds(config_.lease_retry_min_ms);
+          if (it != lease_backoffs_.end()) {
+            delay = std::min(
+                it->second.delay * 2,
+                std::chrono::milliseconds(config_.lease_retry_max_ms));
+          }
+          lease_backoffs_[apn] = {delay,
+                                  std::chrono::steady_clock::now() + delay};
+          OAILOG_WARNING(LOG_UTIL,
+                         "Failed to lease IP block for apn %s, code %d: %s, "
+                         "retrying in %ld ms\n",
+                         apn.c_str(), status.error_code(),
+                         status.error_message().c_str(),
+                         static_cast<long>(delay.count()));
+          return;
+        }
+        lease_backoffs_.erase(apn);
+        install_lease(lease);
+      });
+}
+
+bool DelegatedIPAllocator::may_request_lease(const std::string& apn) {
+  auto it = lease_backoffs_.find(apn);
+  return it == lease_backoffs_.end() ||
+         std::chrono::steady_clock::now() >= it->second.retry_at;
+}
+
+DelegatedIPAllocator::Lease* DelegatedIPAllocator::find_lease(
+    const std::string& apn, uint32_t addr) {
+  auto it = leases_.find(apn);
+  if (it == leases_.end()) return nullptr;
+  for (auto& lease : it->second) {
+    if (lease->allocator.contains(addr)) return lease.get();
+  }
+  return nullptr;
+}
+
+void DelegatedIPAllocator::record(uint64_t lease_id, const std::string& imsi,
+                                  const std::string& apn, uint32_t addr,
+                                  bool released) {
+  IPAllocationRecord record;
+  record.set_lease_id(lease_id);
+  record.set_released(released);
+  auto entry = record.mutable_entry();
+  entry->mutable_sid()->set_id(imsi);
+  entry->mutable_sid()->set_type(SubscriberID::IMSI);
+  entry->mutable_ip()->set_version(IPAddress::IPV4);
+  entry->mutable_ip()->set_address(ipv4_to_bytes(addr));
+  entry->set_apn(apn);
+  pending_sync_.push_back(std::move(record));
+}
+
+void DelegatedIPAllocator::flush_sync() {
+  SyncIPAllocationsRequest request;
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    // One batch in flight at a time keeps the records ordered on mobilityd
+    if (sync_in_flight_ || pending_sync_.empty()) return;
+    size_t batch = std::min<size_t>(pending_sync_.size(),
+                                    config_.max_sync_batch);
+    request.set_holder(config_.holder);
+    for (size_t i = 0; i < batch; i++) {
+      *request.add_records() = std::move(pending_sync_[i]);
+    }
+    pending_sync_.erase(pending_sync_.begin(), pending_sync_.begin() + batch);
+    sync_in_flight_ = true;
+  }
+  client_.SyncIPAllocationsAsync(
+      request, [this, request](const Status& status, const Void&) {
+        bool more;
+        {
+          std::lock_guard<std::mutex> guard(lock_);
+          sync_in_flight_ = false;
+          if (!status.ok()) {
+            OAILOG_WARNING(LOG_UTIL,
+                           "Failed to sync %d IP allocations, code %d: %s\n",
+                           request.records_size(), status.error_code(),
+                           status.error_message().c_str());
+            // Put the batch back in front, it is retried on the next tick
+            pending_sync_.insert(pending_sync_.begin(),
+                                 request.records().begin(),
+                                 request.records().end());
+            return;
+          }
+          more = !pending_sync_.empty();
+        }
+        if (more) flush_sync();
+      });
+}
+
+void DelegatedIPAllocator::renew_leases() {
+  std::vector<std::pair<std::string, uint64_t>> to_renew;
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    auto now = std::chrono::steady_clock::now();
+    auto renew_deadline =
+        now + std::chrono::seconds(config_.renew_before_secs);
+    for (auto& kv : leases_) {
+      auto& leases = kv.second;
+      for (auto it = leases.begin(); it != leases.end();) {
+        auto& lease = *it;
+        // A revoked lease is dropped once its last address has been released
+        if (lease->revoked &&
+            lease->allocator.free_count() == lease->allocator.capacity()) {
+          it = leases.erase(it);
+          continue;
+        }
+        if (!is_revoked(*lease, now) && !lease->renewing &&
+            lease->expiry < renew_deadline) {
+          lease->renewing = true;
+          to_renew.emplace_back(kv.first, lease->lease_id);
+        }
+        ++it;
+      }
+    }
+  }
+  for (const auto& apn_lease : to_renew) {
+    renew_lease(apn_lease.first, apn_lease.second);
+  }
+}
+
+void DelegatedIPAllocator::renew_lease(const std::string& apn,
+                                       uint64_t lease_id) {
+  IPBlockLease request;
+  request.set_lease_id(lease_id);
+  request.set_holder(config_.holder);
+  request.set_apn(apn);
+  client_.RenewIPBlockLeaseAsync(
+      request, [this, apn, lease_id](const Status& status,
+                                     const IPBlockLease& renewed) {
+        std::lock_guard<std::mutex> guard(lock_);
+        for (auto& lease : leases_[apn]) {
+          if (lease->lease_id != lease_id) continue;
+          lease->renewing = false;
+          if (status.ok()) {
+            lease->expiry = std::chrono::steady_clock::now() +
+                            std::chrono::seconds(renewed.expires_in_secs());
+          } else if (status.error_code() == grpc::NOT_FOUND) {
+            OAILOG_WARNING(LOG_UTIL, "IP block lease %lu for apn %s expired\n",
+                           lease_id, apn.c_str());
+            lease->revoked = true;
+          }
+        }
+      });
+}
+
+}  // namespace lte
+}  // namespace magma
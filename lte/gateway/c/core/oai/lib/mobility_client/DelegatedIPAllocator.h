@@ -0,0 +1,213 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <netinet/in.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <grpcpp/impl/codegen/status.h>
+
+#include "lte/gateway/c/core/oai/lib/mobility_client/IPv4BlockAllocator.h"
+#include "lte/protos/mobilityd.pb.h"
+#include "orc8r/protos/common.pb.h"
+
+namespace magma {
+namespace lte {
+
+/**
+ * Lease operations of mobilityd needed for delegated IP allocation
+ */
+class IPBlockLeaseClient {
+ public:
+  virtual ~IPBlockLeaseClient() = default;
+
+  virtual void LeaseIPBlockAsync(
+      const IPBlockLeaseRequest& request,
+      const std::function<void(grpc::Status, IPBlockLease)>& callback) = 0;
+
+  virtual void RenewIPBlockLeaseAsync(
+      const IPBlockLease& lease,
+      const std::function<void(grpc::Status, IPBlockLease)>& callback) = 0;
+
+  virtual void ListIPBlockLeasesAsync(
+      const IPBlockLeaseHolder& holder,
+      const std::function<void(grpc::Status, IPBlockLeaseList)>& callback) = 0;
+
+  virtual void SyncIPAllocationsAsync(
+      const SyncIPAllocationsRequest& request,
+      const std::function<void(grpc::Status, magma::orc8r::Void)>&
+          callback) = 0;
+};
+
+struct DelegatedIPAllocatorConfig {
+  // Lease holder identity, stable across restarts
+  std::string holder;
+  // Prefix length of the sub-blocks leased per APN
+  uint32_t lease_prefix_len;
+  // Lease another sub-block for an APN once its free addresses drop below
+  uint32_t low_watermark;
+  // Renew a lease once it expires within this many seconds
+  uint32_t renew_before_secs;
+  // Upper bound of records sent in a single SyncIPAllocations call
+  uint32_t max_sync_batch;
+  // Delay before retrying a failed LeaseIPBlock call for an APN, doubled on
+  // each consecutive failure up to lease_retry_max_ms
+  uint32_t lease_retry_min_ms = 1000;
+  uint32_t lease_retry_max_ms = 60000;
+};
+
+/**
+ * Allocates UE IPv4 addresses locally out of sub-blocks leased per APN from
+ * mobilityd, and reports assignments back to mobilityd asynchronously in
+ * batches. Allocations for which no leased capacity is available fail, and
+ * the caller falls back to per-UE mobilityd RPCs.
+ *
+ * allocate_ipv4/release_ipv4 are called from the SPGW task, lease responses
+ * arrive on the gRPC response thread, hence all state is guarded by a mutex.
+ */
+class DelegatedIPAllocator {
+ public:
+  DelegatedIPAllocator(IPBlockLeaseClient& client,
+                       const DelegatedIPAllocatorConfig& config);
+
+  /**
+   * Recover the leases held before a restart, marking their recorded
+   * assignments and any address passed to reserve_ipv4 as allocated
+   */
+  void recover();
+
+  /**
+   * Allocate an IPv4 address for (imsi, apn) out of a leased sub-block
+   * @param addr (out): allocated address in network byte order
+   * @param vlan (out): vlan of the APN's pool
+   * @return false if no leased capacity is available for apn
+   */
+  bool allocate_ipv4(const std::string& imsi, const std::string& apn,
+                     struct in_addr* addr, int* vlan);
+
+  /**
+   * Release an IPv4 address allocated by allocate_ipv4
+   * @param addr: address to release in network byte order
+   * @return false if addr does not belong to a leased sub-block
+   */
+  bool release_ipv4(const std::string& imsi, const std::string& apn,
+                    const struct in_addr& addr);
+
+  /**
+   * Mark an address restored from local UE state as allocated, applied once
+   * the lease covering it has been recovered
+   */
+  void reserve_ipv4(const std::string& imsi, const std::string& apn,
+                    const struct in_addr& addr);
+
+  /**
+   * Look up the address allocated to (imsi, apn) out of a leased sub-block
+   * @param addr (out): allocated address in network byte order
+   * @return false if no leased address is allocated to (imsi, apn)
+   */
+  bool get_ipv4(const std::string& imsi, const std::string& apn,
+                struct in_addr* addr);
+
+  /**
+   * Periodic maintenance: flush pending assignments to mobilityd and renew
+   * expiring leases. More sub-blocks are leased by allocate_ipv4.
+   */
+  void tick();
+
+  /**
+   * Number of free leased addresses for apn
+   */
+  uint32_t free_count(const std::string& apn);
+
+  /**
+   * Number of assignments not yet reported to mobilityd
+   */
+  size_t pending_sync_count();
+
+ private:
+  struct Lease {
+    uint64_t lease_id;
+    std::string vlan;
+    std::chrono::steady_clock::time_point expiry;
+    // Set while a RenewIPBlockLease call is in flight
+    bool renewing;
+    // Set once mobilityd no longer knows the lease or it is past its expiry,
+    // no new allocations are made from it and it is dropped once empty
+    bool revoked;
+    IPv4BlockAllocator allocator;
+
+    Lease(uint64_t id, uint32_t net_addr, uint32_t prefix_len)
+        : lease_id(id),
+          renewing(false),
+          revoked(false),
+          allocator(net_addr, prefix_len) {}
+  };
+  using LeaseList = std::vector<std::unique_ptr<Lease>>;
+
+  // Retry state of an APN whose last LeaseIPBlock call failed
+  struct LeaseBackoff {
+    std::chrono::milliseconds delay;
+    std::chrono::steady_clock::time_point retry_at;
+  };
+
+  // Whether no new allocations may be made from lease, revoking it once it
+  // is past its expiry: mobilityd has then returned its sub-block to the
+  // pool, even if the renewals never reached it. lock_ must be held
+  bool is_revoked(Lease& lease, std::chrono::steady_clock::time_point now);
+  // Install a lease granted by mobilityd, lock_ must be held
+  void install_lease(const IPBlockLease& lease);
+  // Lease one more sub-block for apn, lock_ must NOT be held
+  void request_lease(const std::string& apn);
+  // Find the lease of apn covering addr (host byte order), lock_ must be held
+  Lease* find_lease(const std::string& apn, uint32_t addr);
+  // Whether a lease may be requested for apn now, lock_ must be held
+  bool may_request_lease(const std::string& apn);
+  // Queue an assignment change for the next sync, lock_ must be held
+  void record(uint64_t lease_id, const std::string& imsi,
+              const std::string& apn, uint32_t addr, bool released);
+  void flush_sync();
+  void renew_leases();
+  void renew_lease(const std::string& apn, uint64_t lease_id);
+
+  IPBlockLeaseClient& client_;
+  DelegatedIPAllocatorConfig config_;
+  std::mutex lock_;
+  // Leases per APN
+  std::unordered_map<std::string, LeaseList> leases_;
+  // APNs with a LeaseIPBlock call in flight
+  std::unordered_set<std::string> pending_leases_;
+  // APNs whose last LeaseIPBlock call failed
+  std::unordered_map<std::string, LeaseBackoff> lease_backoffs_;
+  // Leased address (host byte order) per APN and IMSI
+  std::unordered_map<std::string, std::unordered_map<std::string, uint32_t>>
+      allocated_;
+  // Assignment changes not yet sent to mobilityd, in order
+  std::vector<IPAllocationRecord> pending_sync_;
+  // Set while a SyncIPAllocations call is in flight
+  bool sync_in_flight_;
+  // Locally restored assignments waiting for their lease to be recovered
+  std::vector<IPAllocationRecord> pending_reservations_;
+  bool recovering_;
+};
+
+}  // namespace lte
+}  // namespace magma
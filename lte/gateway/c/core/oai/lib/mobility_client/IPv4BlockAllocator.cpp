@@ -0,0 +1,80 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lte/gateway/c/core/oai/lib/mobility_client/IPv4BlockAllocator.h"
+
+#include <cassert>
+
+namespace magma {
+namespace lte {
+
+static const uint32_t BITS_PER_WORD = 64;
+static const uint64_t FULL_WORD = ~0ULL;
+
+IPv4BlockAllocator::IPv4BlockAllocator(uint32_t net_addr, uint32_t prefix_len)
+    : prefix_len_(prefix_len), cursor_(0) {
+  assert(prefix_len >= 16 && prefix_len <= 32);
+  size_ = 1U << (32 - prefix_len);
+  net_addr_ = net_addr & ~(size_ - 1);
+  free_ = size_;
+  bitmap_.assign((size_ + BITS_PER_WORD - 1) / BITS_PER_WORD, 0);
+  // Mark the bits past the end of a block smaller than a word as used
+  if (size_ % BITS_PER_WORD) {
+    bitmap_.back() = FULL_WORD << (size_ % BITS_PER_WORD);
+  }
+}
+
+bool IPv4BlockAllocator::allocate(uint32_t* addr) {
+  if (free_ == 0) return false;
+  auto num_words = static_cast<uint32_t>(bitmap_.size());
+  for (uint32_t i = 0; i < num_words; i++) {
+    uint32_t word = (cursor_ + i) % num_words;
+    if (bitmap_[word] == FULL_WORD) continue;
+    uint32_t bit = __builtin_ctzll(~bitmap_[word]);
+    bitmap_[word] |= 1ULL << bit;
+    free_--;
+    cursor_ = word;
+    *addr = net_addr_ + word * BITS_PER_WORD + bit;
+    return true;
+  }
+  return false;
+}
+
+bool IPv4BlockAllocator::reserve(uint32_t addr) {
+  if (!contains(addr) || is_allocated(addr)) return false;
+  uint32_t offset = addr - net_addr_;
+  bitmap_[offset / BITS_PER_WORD] |= 1ULL << (offset % BITS_PER_WORD);
+  free_--;
+  return true;
+}
+
+bool IPv4BlockAllocator::release(uint32_t addr) {
+  if (!contains(addr) || !is_allocated(addr)) return false;
+  uint32_t offset = addr - net_addr_;
+  bitmap_[offset / BITS_PER_WORD] &= ~(1ULL << (offset % BITS_PER_WORD));
+  free_++;
+  return true;
+}
+
+bool IPv4BlockAllocator::contains(uint32_t addr) const {
+  return addr - net_addr_ < size_;
+}
+
+bool IPv4BlockAllocator::is_allocated(uint32_t addr) const {
+  if (!contains(addr)) return false;
+  uint32_t offset = addr - net_addr_;
+  return bitmap_[offset / BITS_PER_WORD] & (1ULL << (offset % BITS_PER_WORD));
+}
+
+}  // namespace lte
+}  // namespace magma
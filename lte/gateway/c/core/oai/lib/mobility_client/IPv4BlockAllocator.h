@@ -0,0 +1,74 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace magma {
+namespace lte {
+
+/**
+ * Bitmap allocator over a contiguous IPv4 block. Every address of the block
+ * is allocatable, the block is expected to be a sub-block leased out of a
+ * larger pool whose network and broadcast addresses are never leased.
+ * All addresses are in host byte order. Not thread safe.
+ */
+class IPv4BlockAllocator {
+ public:
+  /**
+   * @param net_addr network address of the block
+   * @param prefix_len prefix length of the block, between 16 and 32
+   */
+  IPv4BlockAllocator(uint32_t net_addr, uint32_t prefix_len);
+
+  /**
+   * Allocate the next free address of the block
+   * @param addr (out): allocated address
+   * @return false if the block is exhausted
+   */
+  bool allocate(uint32_t* addr);
+
+  /**
+   * Mark a specific address as allocated, used when reconciling state
+   * @return false if addr is outside the block or already allocated
+   */
+  bool reserve(uint32_t addr);
+
+  /**
+   * Return an allocated address to the block
+   * @return false if addr is outside the block or not allocated
+   */
+  bool release(uint32_t addr);
+
+  bool contains(uint32_t addr) const;
+  bool is_allocated(uint32_t addr) const;
+
+  uint32_t net_addr() const { return net_addr_; }
+  uint32_t prefix_len() const { return prefix_len_; }
+  uint32_t capacity() const { return size_; }
+  uint32_t free_count() const { return free_; }
+
+ private:
+  uint32_t net_addr_;
+  uint32_t prefix_len_;
+  uint32_t size_;
+  uint32_t free_;
+  // Word the next allocation starts searching from, allocations are next-fit
+  // so that a released address is not immediately handed out again
+  uint32_t cursor_;
+  std::vector<uint64_t> bitmap_;
+};
+
+}  // namespace lte
+}  // namespace magma
@@ -21,6 +21,7 @@
 
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <string>
 
 #include "lte/gateway/c/core/oai/common/common_defs.h"
@@ -28,6 +29,7 @@
 #include "lte/gateway/c/core/oai/common/conversions.h"
 #include "lte/gateway/c/core/oai/lib/itti/intertask_interface.h"
 #include "lte/gateway/c/core/oai/common/log.h"
+#include "lte/gateway/c/core/oai/lib/mobility_client/DelegatedIPAllocator.h"
 #include "lte/gateway/c/core/oai/lib/mobility_client/MobilityServiceClient.h"
 #include "orc8r/gateway/c/common/service303/includes/MetricsHelpers.h"
 #include "lte/gateway/c/core/oai/include/spgw_types.h"
@@ -38,11 +40,16 @@ using grpc::CreateChannel;
 using grpc::InsecureChannelCredentials;
 using grpc::Status;
 using magma::lte::AllocateIPAddressResponse;
+using magma::lte::DelegatedIPAllocator;
+using magma::lte::DelegatedIPAllocatorConfig;
 using magma::lte::IPAddress;
 using magma::lte::MobilityServiceClient;
 
 extern task_zmq_ctx_t grpc_service_task_zmq_ctx;
 
+// Set when delegated IPv4 allocation is enabled
+static std::unique_ptr<DelegatedIPAllocator> delegated_ip_allocator;
+
 static void handle_allocate_ipv4_address_status(
     const grpc::Status& status, struct in_addr inaddr, int vlan,
     const char* imsi, const char* apn, const char* pdn_type,
@@ -74,6 +81,16 @@ int pgw_handle_allocate_ipv4_address(const char* subscriber_id, const char* apn,
   auto subscriber_id_str = std::string(subscriber_id);
   auto apn_str = std::string(apn);
   auto pdn_type_str = std::string(pdn_type);
+  struct in_addr addr;
+  int vlan = 0;
+  if (delegated_ip_allocator &&
+      delegated_ip_allocator->allocate_ipv4(subscriber_id_str, apn_str, &addr,
+                                            &vlan)) {
+    handle_allocate_ipv4_address_status(Status::OK, addr, vlan, subscriber_id,
+                                        apn, pdn_type, context_teid,
+                                        eps_bearer_id);
+    return RETURNok;
+  }
   MobilityServiceClient::getInstance().AllocateIPv4AddressAsync(
       subscriber_id_str, apn_str,
       [subscriber_id_str, apn_str, pdn_type_str, context_teid, eps_bearer_id](
@@ -153,13 +170,52 @@ static void handle_allocate_ipv4_address_status(
 void release_ipv4_address(const char* subscriber_id, const char* apn,
                           const struct in_addr* addr) {
 #if !MME_UNIT_TEST
+  if (delegated_ip_allocator &&
+      delegated_ip_allocator->release_ipv4(subscriber_id, apn, *addr)) {
+    return;
+  }
   MobilityServiceClient::getInstance().ReleaseIPv4Address(subscriber_id, apn,
                                                           *addr);
 #endif
 }
 
+void delegated_ip_alloc_init(const char* holder, uint32_t lease_prefix_len,
+                             uint32_t low_watermark, uint32_t renew_before_secs,
+                             uint32_t max_sync_batch) {
+#if !MME_UNIT_TEST
+  DelegatedIPAllocatorConfig config;
+  config.holder = holder;
+  config.lease_prefix_len = lease_prefix_len;
+  config.low_watermark = low_watermark;
+  config.renew_before_secs = renew_before_secs;
+  config.max_sync_batch = max_sync_batch;
+  delegated_ip_allocator = std::make_unique<DelegatedIPAllocator>(
+      MobilityServiceClient::getInstance(), config);
+  delegated_ip_allocator->recover();
+#endif
+}
+
+void delegated_ip_alloc_tick(void) {
+  if (delegated_ip_allocator) {
+    delegated_ip_allocator->tick();
+  }
+}
+
+void delegated_ip_alloc_reserve_ipv4(const char* subscriber_id,
+                                     const char* apn,
+                                     const struct in_addr* addr) {
+  if (delegated_ip_allocator) {
+    delegated_ip_allocator->reserve_ipv4(subscriber_id, apn, *addr);
+  }
+}
+
 int get_ipv4_address_for_subscriber(const char* subscriber_id, const char* apn,
                                     struct in_addr* addr) {
+  // Delegated allocations may not have been synced to mobilityd yet
+  if (delegated_ip_allocator &&
+      delegated_ip_allocator->get_ipv4(subscriber_id, apn, addr)) {
+    return 0;
+  }
   int status = MobilityServiceClient::getInstance().GetIPv4AddressForSubscriber(
       subscriber_id, apn, addr);
   return status;
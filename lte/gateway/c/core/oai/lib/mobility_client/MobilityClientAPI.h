@@ -169,6 +169,40 @@ int pgw_handle_allocate_ipv4v6_address(const char* subscriber_id,
                                        teid_t context_teid,
                                        ebi_t eps_bearer_id);
 
+/*
+ * Enable delegated IPv4 allocation: addresses are allocated locally out of
+ * sub-blocks leased per APN from mobilityd, and reported back to mobilityd in
+ * batches. Leases held before a restart are recovered asynchronously.
+ *
+ * @param holder: lease holder identity, stable across restarts
+ * @param lease_prefix_len: prefix length of each leased sub-block
+ * @param low_watermark: lease another sub-block for an APN once its free
+ * leased addresses drop below this
+ * @param renew_before_secs: renew leases expiring within this many seconds
+ * @param max_sync_batch: max allocations reported per sync call
+ */
+void delegated_ip_alloc_init(const char* holder, uint32_t lease_prefix_len,
+                             uint32_t low_watermark, uint32_t renew_before_secs,
+                             uint32_t max_sync_batch);
+
+/*
+ * Periodic maintenance of delegated allocation: flush pending allocations to
+ * mobilityd, renew expiring leases. No-op if delegated allocation is disabled.
+ */
+void delegated_ip_alloc_tick(void);
+
+/*
+ * Mark an IPv4 address restored from local UE state as allocated so that it
+ * is not handed out again after a restart
+ *
+ * @param subscriber_id: IMSI string
+ * @param apn: access point name string
+ * @param addr: IPv4 address in "network byte order"
+ */
+void delegated_ip_alloc_reserve_ipv4(const char* subscriber_id,
+                                     const char* apn,
+                                     const struct in_addr* addr);
+
 #ifdef __cplusplus
 }
 #endif
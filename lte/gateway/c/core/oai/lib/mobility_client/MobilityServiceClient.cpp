@@ -259,6 +259,41 @@ void MobilityServiceClient::ReleaseIPAddressRPC(
       localResp->get_context(), request, &queue_)));
 }
 
+void MobilityServiceClient::LeaseIPBlockAsync(
+    const IPBlockLeaseRequest& request,
+    const std::function<void(Status, IPBlockLease)>& callback) {
+  auto localResp =
+      new AsyncLocalResponse<IPBlockLease>(callback, RESPONSE_TIMEOUT);
+  localResp->set_response_reader(std::move(
+      stub_->AsyncLeaseIPBlock(localResp->get_context(), request, &queue_)));
+}
+
+void MobilityServiceClient::RenewIPBlockLeaseAsync(
+    const IPBlockLease& lease,
+    const std::function<void(Status, IPBlockLease)>& callback) {
+  auto localResp =
+      new AsyncLocalResponse<IPBlockLease>(callback, RESPONSE_TIMEOUT);
+  localResp->set_response_reader(std::move(stub_->AsyncRenewIPBlockLease(
+      localResp->get_context(), lease, &queue_)));
+}
+
+void MobilityServiceClient::ListIPBlockLeasesAsync(
+    const IPBlockLeaseHolder& holder,
+    const std::function<void(Status, IPBlockLeaseList)>& callback) {
+  auto localResp =
+      new AsyncLocalResponse<IPBlockLeaseList>(callback, RESPONSE_TIMEOUT);
+  localResp->set_response_reader(std::move(stub_->AsyncListIPBlockLeases(
+      localResp->get_context(), holder, &queue_)));
+}
+
+void MobilityServiceClient::SyncIPAllocationsAsync(
+    const SyncIPAllocationsRequest& request,
+    const std::function<void(Status, Void)>& callback) {
+  auto localResp = new AsyncLocalResponse<Void>(callback, RESPONSE_TIMEOUT);
+  localResp->set_response_reader(std::move(stub_->AsyncSyncIPAllocations(
+      localResp->get_context(), request, &queue_)));
+}
+
 MobilityServiceClient::MobilityServiceClient() {
   auto channel = ServiceRegistrySingleton::Instance()->GetGrpcChannel(
       "mobilityd", ServiceRegistrySingleton::LOCAL);
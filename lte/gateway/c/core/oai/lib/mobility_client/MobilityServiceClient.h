@@ -25,6 +25,7 @@
 #include <string>
 
 #include "orc8r/gateway/c/common/async_grpc/includes/GRPCReceiver.h"
+#include "lte/gateway/c/core/oai/lib/mobility_client/DelegatedIPAllocator.h"
 #include "lte/protos/mobilityd.grpc.pb.h"
 
 namespace grpc {
@@ -38,7 +39,7 @@ namespace lte {
 /*
  * gRPC client for MobilityService
  */
-class MobilityServiceClient : public GRPCReceiver {
+class MobilityServiceClient : public GRPCReceiver, public IPBlockLeaseClient {
  public:
   virtual ~MobilityServiceClient() = default;
   /*
@@ -151,6 +152,38 @@ class MobilityServiceClient : public GRPCReceiver {
    */
   int GetSubscriberIDFromIPv4(const struct in_addr& addr, std::string* imsi);
 
+  /**
+   * Lease a sub-block of an APN's IP pool for delegated allocation
+   * (non-blocking)
+   */
+  void LeaseIPBlockAsync(
+      const IPBlockLeaseRequest& request,
+      const std::function<void(grpc::Status, IPBlockLease)>& callback) override;
+
+  /**
+   * Extend a lease granted by LeaseIPBlockAsync (non-blocking)
+   */
+  void RenewIPBlockLeaseAsync(
+      const IPBlockLease& lease,
+      const std::function<void(grpc::Status, IPBlockLease)>& callback) override;
+
+  /**
+   * List the live leases of a holder with their recorded assignments
+   * (non-blocking)
+   */
+  void ListIPBlockLeasesAsync(
+      const IPBlockLeaseHolder& holder,
+      const std::function<void(grpc::Status, IPBlockLeaseList)>& callback)
+      override;
+
+  /**
+   * Report a batch of delegated allocations and releases (non-blocking)
+   */
+  void SyncIPAllocationsAsync(
+      const SyncIPAllocationsRequest& request,
+      const std::function<void(grpc::Status, magma::orc8r::Void)>& callback)
+      override;
+
  public:
   static MobilityServiceClient& getInstance();
 
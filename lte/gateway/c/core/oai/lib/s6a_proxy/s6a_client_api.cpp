@@ -63,8 +63,8 @@ bool s6a_purge_ue(const char* imsi) {
 }
 
 static void s6a_handle_authentication_info_ans(
-    const std::string& imsi, uint8_t imsi_length, const grpc::Status& status,
-    feg::AuthenticationInformationAnswer response) {
+    const std::string& imsi, uint8_t imsi_length, uint64_t prefetch_seq,
+    const grpc::Status& status, feg::AuthenticationInformationAnswer response) {
   MessageDef* message_p = NULL;
   s6a_auth_info_ans_t* itti_msg = NULL;
 
@@ -72,6 +72,7 @@ static void s6a_handle_authentication_info_ans(
   itti_msg = &message_p->ittiMsg.s6a_auth_info_ans;
   strncpy(itti_msg->imsi, imsi.c_str(), imsi_length);
   itti_msg->imsi_length = imsi_length;
+  itti_msg->prefetch_seq = prefetch_seq;
 
   if (status.ok()) {
     if (response.error_code() < feg::ErrorCode::COMMAND_UNSUPORTED) {
@@ -113,9 +114,11 @@ bool s6a_authentication_info_req(const s6a_auth_info_req_t* const air_p) {
 
   magma::S6aClient::authentication_info_req(
       air_p,
-      [imsiStr = std::string(air_p->imsi), imsi_len](
+      [imsiStr = std::string(air_p->imsi), imsi_len,
+       prefetch_seq = air_p->prefetch_seq](
           grpc::Status status, feg::AuthenticationInformationAnswer response) {
-        s6a_handle_authentication_info_ans(imsiStr, imsi_len, status, response);
+        s6a_handle_authentication_info_ans(imsiStr, imsi_len, prefetch_seq,
+                                           status, response);
       });
   return true;
 }
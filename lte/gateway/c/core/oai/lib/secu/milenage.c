@@ -0,0 +1,206 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <nettle/aes.h>
+#include <openssl/crypto.h>
+
+#include "lte/gateway/c/core/oai/common/security_types.h"
+#include "lte/gateway/c/core/oai/lib/secu/secu_defs.h"
+
+#define MILENAGE_BLOCK_LENGTH 16
+
+/* Rotations r1..r5 of TS 35.206 section 4.1, in bytes */
+#define MILENAGE_R1 8
+#define MILENAGE_R2 0
+#define MILENAGE_R3 4
+#define MILENAGE_R4 8
+#define MILENAGE_R5 12
+
+/* Last octet of the constants c1..c5, the other octets are zero */
+#define MILENAGE_C1 0x00
+#define MILENAGE_C2 0x01
+#define MILENAGE_C3 0x02
+#define MILENAGE_C4 0x04
+#define MILENAGE_C5 0x08
+
+/* OUTn = E[rot(TEMP XOR OPc, rn) XOR cn]K XOR OPc, for n in 2..5 */
+static void milenage_out(const struct aes128_ctx* ctx, const uint8_t* opc,
+                         const uint8_t* temp, int r, uint8_t c, uint8_t* out) {
+  uint8_t in[MILENAGE_BLOCK_LENGTH];
+
+  for (int i = 0; i < MILENAGE_BLOCK_LENGTH; i++) {
+    in[(i + MILENAGE_BLOCK_LENGTH - r) % MILENAGE_BLOCK_LENGTH] =
+        temp[i] ^ opc[i];
+  }
+  in[MILENAGE_BLOCK_LENGTH - 1] ^= c;
+  aes128_encrypt(ctx, MILENAGE_BLOCK_LENGTH, out, in);
+  for (int i = 0; i < MILENAGE_BLOCK_LENGTH; i++) {
+    out[i] ^= opc[i];
+  }
+}
+
+/* TEMP = E[RAND XOR OPc]K */
+static void milenage_temp(const struct aes128_ctx* ctx, const uint8_t* opc,
+                          const uint8_t* rand, uint8_t* temp) {
+  uint8_t in[MILENAGE_BLOCK_LENGTH];
+
+  for (int i = 0; i < MILENAGE_BLOCK_LENGTH; i++) {
+    in[i] = rand[i] ^ opc[i];
+  }
+  aes128_encrypt(ctx, MILENAGE_BLOCK_LENGTH, temp, in);
+}
+
+/* OUT1, MAC-A in its first 8 octets and MAC-S in the last 8 */
+static void milenage_out1(const struct aes128_ctx* ctx, const uint8_t* opc,
+                          const uint8_t* temp, const uint8_t* sqn,
+                          const uint8_t* amf, uint8_t* out1) {
+  uint8_t in1[MILENAGE_BLOCK_LENGTH];
+  uint8_t in[MILENAGE_BLOCK_LENGTH];
+
+  memcpy(in1, sqn, SQN_LENGTH_OCTETS);
+  memcpy(in1 + SQN_LENGTH_OCTETS, amf, AMF_LENGTH_OCTETS);
+  memcpy(in1 + 8, in1, 8);
+  for (int i = 0; i < MILENAGE_BLOCK_LENGTH; i++) {
+    in[(i + MILENAGE_BLOCK_LENGTH - MILENAGE_R1) % MILENAGE_BLOCK_LENGTH] =
+        in1[i] ^ opc[i];
+  }
+  in[MILENAGE_BLOCK_LENGTH - 1] ^= MILENAGE_C1;
+  for (int i = 0; i < MILENAGE_BLOCK_LENGTH; i++) {
+    in[i] ^= temp[i];
+  }
+  aes128_encrypt(ctx, MILENAGE_BLOCK_LENGTH, out1, in);
+  for (int i = 0; i < MILENAGE_BLOCK_LENGTH; i++) {
+    out1[i] ^= opc[i];
+  }
+}
+
+void milenage_opc(const uint8_t* k, const uint8_t* op, uint8_t* opc) {
+  struct aes128_ctx ctx;
+
+  aes128_set_encrypt_key(&ctx, k);
+  aes128_encrypt(&ctx, MILENAGE_BLOCK_LENGTH, opc, op);
+  for (int i = 0; i < MILENAGE_BLOCK_LENGTH; i++) {
+    opc[i] ^= op[i];
+  }
+}
+
+void milenage_f1(const uint8_t* k, const uint8_t* opc, const uint8_t* rand,
+                 const uint8_t* sqn, const uint8_t* amf, uint8_t* mac_a,
+                 uint8_t* mac_s) {
+  struct aes128_ctx ctx;
+  uint8_t temp[MILENAGE_BLOCK_LENGTH];
+  uint8_t out1[MILENAGE_BLOCK_LENGTH];
+
+  aes128_set_encrypt_key(&ctx, k);
+  milenage_temp(&ctx, opc, rand, temp);
+  milenage_out1(&ctx, opc, temp, sqn, amf, out1);
+  if (mac_a) memcpy(mac_a, out1, MAC_LENGTH_OCTETS);
+  if (mac_s) memcpy(mac_s, out1 + MAC_LENGTH_OCTETS, MAC_LENGTH_OCTETS);
+}
+
+void milenage_f2345(const uint8_t* k, const uint8_t* opc, const uint8_t* rand,
+                    uint8_t* res, uint8_t* ck, uint8_t* ik, uint8_t* ak,
+                    uint8_t* ak_star) {
+  struct aes128_ctx ctx;
+  uint8_t temp[MILENAGE_BLOCK_LENGTH];
+  uint8_t out[MILENAGE_BLOCK_LENGTH];
+
+  aes128_set_encrypt_key(&ctx, k);
+  milenage_temp(&ctx, opc, rand, temp);
+  milenage_out(&ctx, opc, temp, MILENAGE_R2, MILENAGE_C2, out);
+  if (res) memcpy(res, out + 8, MILENAGE_RES_LENGTH_OCTETS);
+  if (ak) memcpy(ak, out, AK_LENGTH_OCTETS);
+  if (ck) milenage_out(&ctx, opc, temp, MILENAGE_R3, MILENAGE_C3, ck);
+  if (ik) milenage_out(&ctx, opc, temp, MILENAGE_R4, MILENAGE_C4, ik);
+  if (ak_star) {
+    milenage_out(&ctx, opc, temp, MILENAGE_R5, MILENAGE_C5, out);
+    memcpy(ak_star, out, AK_LENGTH_OCTETS);
+  }
+}
+
+int derive_kasme(const uint8_t* ck, const uint8_t* ik, const uint8_t* plmn,
+                 const uint8_t* sqn_ak, uint8_t* kasme) {
+  uint8_t key[32];
+  uint8_t s[14];
+
+  memcpy(key, ck, 16);
+  memcpy(key + 16, ik, 16);
+  // FC
+  s[0] = FC_KASME;
+  // P0 = SN id, L0
+  memcpy(s + 1, plmn, 3);
+  s[4] = 0x00;
+  s[5] = 0x03;
+  // P1 = SQN XOR AK, L1
+  memcpy(s + 6, sqn_ak, SQN_LENGTH_OCTETS);
+  s[12] = 0x00;
+  s[13] = 0x06;
+  kdf(key, 32, s, 14, kasme, KASME_LENGTH_OCTETS);
+  return 0;
+}
+
+int milenage_generate_eutran_vector(const uint8_t* k, const uint8_t* opc,
+                                    const uint8_t* amf, const uint8_t* sqn,
+                                    const uint8_t* plmn, const uint8_t* rand,
+                                    eutran_vector_t* vector) {
+  struct aes128_ctx ctx;
+  uint8_t temp[MILENAGE_BLOCK_LENGTH];
+  uint8_t out1[MILENAGE_BLOCK_LENGTH];
+  uint8_t out2[MILENAGE_BLOCK_LENGTH];
+  uint8_t ck[MILENAGE_BLOCK_LENGTH];
+  uint8_t ik[MILENAGE_BLOCK_LENGTH];
+  uint8_t sqn_ak[SQN_LENGTH_OCTETS];
+
+  // The key schedule is shared by the 5 block encryptions of the vector
+  aes128_set_encrypt_key(&ctx, k);
+  milenage_temp(&ctx, opc, rand, temp);
+  milenage_out1(&ctx, opc, temp, sqn, amf, out1);
+  milenage_out(&ctx, opc, temp, MILENAGE_R2, MILENAGE_C2, out2);
+  milenage_out(&ctx, opc, temp, MILENAGE_R3, MILENAGE_C3, ck);
+  milenage_out(&ctx, opc, temp, MILENAGE_R4, MILENAGE_C4, ik);
+
+  for (int i = 0; i < SQN_LENGTH_OCTETS; i++) {
+    sqn_ak[i] = sqn[i] ^ out2[i];
+  }
+  memcpy(vector->rand, rand, RAND_LENGTH_OCTETS);
+  memcpy(vector->xres.data, out2 + 8, MILENAGE_RES_LENGTH_OCTETS);
+  vector->xres.size = MILENAGE_RES_LENGTH_OCTETS;
+  // AUTN = SQN XOR AK || AMF || MAC-A
+  memcpy(vector->autn, sqn_ak, SQN_LENGTH_OCTETS);
+  memcpy(vector->autn + SQN_LENGTH_OCTETS, amf, AMF_LENGTH_OCTETS);
+  memcpy(vector->autn + SQN_LENGTH_OCTETS + AMF_LENGTH_OCTETS, out1,
+         MAC_LENGTH_OCTETS);
+  return derive_kasme(ck, ik, plmn, sqn_ak, vector->kasme);
+}
+
+int milenage_resync_sqn(const uint8_t* k, const uint8_t* opc,
+                        const uint8_t* rand, const uint8_t* auts,
+                        uint8_t* sqn_ms) {
+  // TS 33.102 6.3.3, f1* is computed with a dummy AMF
+  const uint8_t amf_star[AMF_LENGTH_OCTETS] = {0x00, 0x00};
+  uint8_t ak_star[AK_LENGTH_OCTETS];
+  uint8_t mac_s[MAC_LENGTH_OCTETS];
+
+  milenage_f2345(k, opc, rand, NULL, NULL, NULL, NULL, ak_star);
+  for (int i = 0; i < SQN_LENGTH_OCTETS; i++) {
+    sqn_ms[i] = auts[i] ^ ak_star[i];
+  }
+  milenage_f1(k, opc, rand, sqn_ms, amf_star, NULL, mac_s);
+  // Constant time, the AUTS is attacker controlled
+  if (CRYPTO_memcmp(mac_s, auts + SQN_LENGTH_OCTETS, MAC_LENGTH_OCTETS) != 0) {
+    return -1;
+  }
+  return 0;
+}
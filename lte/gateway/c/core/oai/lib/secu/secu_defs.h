@@ -89,4 +89,37 @@ int nas_stream_encrypt_eia2(nas_stream_cipher_t* const stream_cipher,
 
 int derive_5gkey_gnb(const uint8_t* kamf, uint32_t ul_count, uint8_t* kgnb);
 
+/*
+ * Milenage algorithm set of 3GPP TS 35.206, keys, OP/OPc and RAND are
+ * 16 octets, SQN and AK 6 octets, AMF 2 octets and MACs and RES 8 octets
+ */
+void milenage_opc(const uint8_t* k, const uint8_t* op, uint8_t* opc);
+
+/* MAC-A (f1) and MAC-S (f1*), either of them may be NULL */
+void milenage_f1(const uint8_t* k, const uint8_t* opc, const uint8_t* rand,
+                 const uint8_t* sqn, const uint8_t* amf, uint8_t* mac_a,
+                 uint8_t* mac_s);
+
+/* RES (f2), CK (f3), IK (f4), AK (f5) and AK (f5*), any of them may be NULL */
+void milenage_f2345(const uint8_t* k, const uint8_t* opc, const uint8_t* rand,
+                    uint8_t* res, uint8_t* ck, uint8_t* ik, uint8_t* ak,
+                    uint8_t* ak_star);
+
+/* KASME of TS 33.401 A.2, plmn is the 3 octet encoded serving network id */
+int derive_kasme(const uint8_t* ck, const uint8_t* ik, const uint8_t* plmn,
+                 const uint8_t* sqn_ak, uint8_t* kasme);
+
+int milenage_generate_eutran_vector(const uint8_t* k, const uint8_t* opc,
+                                    const uint8_t* amf, const uint8_t* sqn,
+                                    const uint8_t* plmn, const uint8_t* rand,
+                                    eutran_vector_t* vector);
+
+/*
+ * Recover SQN_MS from the AUTS of a synchronisation failure
+ * @return -1 if the MAC-S of the AUTS is not valid
+ */
+int milenage_resync_sqn(const uint8_t* k, const uint8_t* opc,
+                        const uint8_t* rand, const uint8_t* auts,
+                        uint8_t* sqn_ms);
+
 #endif /* FILE_SECU_DEFS_SEEN */
@@ -11,6 +11,8 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 #ifdef __cplusplus
 extern "C" {
@@ -32,6 +34,7 @@ extern "C" {
 #include "lte/gateway/c/core/oai/tasks/amf/amf_recv.h"
 #include "lte/gateway/c/core/oai/tasks/amf/amf_app_state_manager.h"
 #include "lte/gateway/c/core/oai/tasks/amf/amf_app_timer_management.h"
+#include "lte/gateway/c/core/oai/tasks/amf/amf_suci_deconcealer.h"
 #include "orc8r/gateway/c/common/service303/includes/MetricsHelpers.h"
 #include "include/amf_client_servicer.h"
 
@@ -1157,8 +1160,9 @@ int amf_proc_registration_abort(amf_context_t* amf_ctx,
 **                                                                        **
 ** Name:    get_decrypt_imsi_suci_extension()                             **
 **                                                                        **
-** Description: Invokes .get_decrypt_imsi_info                            **
-**              to fetch decrypted imsi                                   **
+** Description: Deconceals the SUCI with the cached home network key,     **
+**              or invokes .get_decrypt_imsi_info to fetch decrypted      **
+**              imsi if the key is not cached                             **
 **                                                                        **
 **                                                                        **
 ***************************************************************************/
@@ -1174,6 +1178,32 @@ int get_decrypt_imsi_suci_extension(amf_context_t* amf_context,
       PARENT_STRUCT(amf_context, ue_m5gmm_context_s, amf_context)
           ->amf_ue_ngap_id;
 
+  SuciDeconcealer& deconcealer = SuciDeconcealer::getInstance();
+  if (deconcealer.has_home_network_key(ue_pubkey_identifier)) {
+    std::string msin;
+    if (!deconcealer.deconceal(ue_pubkey_identifier, ue_pubkey, ciphertext,
+                               mac_tag, &msin)) {
+      OAILOG_ERROR(LOG_AMF_APP,
+                   "Deconcealing IMSI failed for ue: [" AMF_UE_NGAP_ID_FMT
+                   "], sending Registration Reject\n",
+                   ue_id);
+      increment_counter("suci_deconceal", 1, 1, "result", "failure");
+      amf_proc_registration_reject(ue_id, AMF_UE_ILLEGAL);
+      OAILOG_FUNC_RETURN(LOG_NAS_AMF, rc);
+    }
+    increment_counter("suci_deconceal", 1, 1, "result", "success");
+
+    // Same answer as subscriberdb's, handled without the ITTI round trip
+    itti_amf_decrypted_imsi_info_ans_t decrypted_imsi = {};
+    decrypted_imsi.imsi_length =
+        std::min(msin.size(), static_cast<size_t>(IMSI_BCD_DIGITS_MAX));
+    memcpy(decrypted_imsi.imsi, msin.data(), decrypted_imsi.imsi_length);
+    decrypted_imsi.ue_id = ue_id;
+    rc = amf_decrypt_imsi_info_answer(&decrypted_imsi);
+    OAILOG_FUNC_RETURN(LOG_NAS_AMF, rc);
+  }
+  increment_counter("suci_deconceal", 1, 1, "result", "subscriberdb");
+
   OAILOG_INFO(
       LOG_AMF_APP,
       "Sending msg(grpc) to :[subscriberdb] for ue: [" AMF_UE_NGAP_ID_FMT
@@ -155,8 +155,14 @@ void amf_ue_context_update_coll_keys(amf_ue_context_t* const amf_ue_context_p,
                      "amf_ue_ngap_id " AMF_UE_NGAP_ID_FMT PRIX32 " \n",
                      amf_ue_ngap_id);
       }
+      // The old 5G-TMSI no longer identifies this UE
+      if (guti_p->m_tmsi != ue_context_p->amf_context.m5_guti.m_tmsi) {
+        amf_ue_context_remove_tmsi(amf_ue_context_p, ue_context_p);
+      }
       ue_context_p->amf_context.m5_guti = *guti_p;
     }
+    amf_ue_context_upsert_tmsi(amf_ue_context_p, guti_p->m_tmsi,
+                               amf_ue_ngap_id);
   }
 }
 
@@ -390,7 +396,8 @@ imsi64_t amf_app_handle_initial_ue_message(
   /* Five_G_TMSI not configured */
   if (ue_context_p == NULL) {
     /* Check if Context can be found by GNB UE ID */
-    ue_context_p = ue_context_lookup_by_gnb_ue_id(initial_pP->gnb_ue_ngap_id);
+    ue_context_p = ue_context_lookup_by_gnb_ue_id(initial_pP->gnb_id,
+                                                  initial_pP->gnb_ue_ngap_id);
 
     /* Make sure its with same connection */
     if (ue_context_p &&
@@ -1236,6 +1243,9 @@ void amf_app_handle_cm_idle_on_ue_context_release(
 
       ue_context_release_command(ue_id, ue_context->gnb_ue_ngap_id,
                                  NGAP_USER_INACTIVITY);
+      get_amf_nas_state(false)
+          ->amf_ue_contexts.gnb_ue_ngap_id_ue_context_htbl.remove(
+              ue_context->gnb_ngap_id_key);
       ue_context->gnb_ngap_id_key = INVALID_GNB_UE_NGAP_ID_KEY;
 
     } else {
@@ -35,6 +35,7 @@ extern "C" {
 #include "lte/gateway/c/core/oai/include/ngap_messages_types.h"
 #include "lte/gateway/c/core/oai/tasks/amf/amf_app_state_manager.h"
 #include "lte/gateway/c/core/oai/tasks/amf/amf_smfDefs.h"
+#include "lte/gateway/c/core/oai/tasks/amf/amf_suci_deconcealer.h"
 #include "lte/gateway/c/core/oai/common/common_defs.h"
 
 namespace magma5g {
@@ -213,6 +214,8 @@ extern "C" int amf_app_init(const amf_config_t* amf_config_p) {
   }
   /*Initialize UE state matrix */
   create_state_matrix();
+  // SUCIs of the keys not cached are deconcealed by subscriberdb
+  amf_load_suci_home_network_keys(amf_config_p);
   if (itti_create_task(TASK_AMF_APP, &amf_app_thread, NULL) < 0) {
     OAILOG_CRITICAL(LOG_AMF_APP, "Amf app create task failed\n");
     OAILOG_FUNC_RETURN(LOG_AMF_APP, RETURNerror);
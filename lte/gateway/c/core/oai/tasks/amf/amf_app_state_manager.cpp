@@ -132,6 +132,8 @@ void AmfNasStateManager::create_state() {
       AMF_GNB_UE_ID_AMF_UE_ID_TABLE_NAME);
   state_cache_p->amf_ue_contexts.guti_ue_context_htbl.set_name(
       AMF_GUTI_UE_ID_TABLE_NAME);
+  state_cache_p->amf_ue_contexts.tmsi_ue_context_htbl.set_name(
+      AMF_TMSI_UE_ID_TABLE_NAME);
   state_ue_map.set_name(AMF_UE_ID_UE_CTXT_TABLE_NAME);
 
   // Initialize the local timers, which are non-persistent
@@ -36,6 +36,7 @@ constexpr char AMF_UE_ID_UE_CTXT_TABLE_NAME[] =
 constexpr char AMF_IMSI_UE_ID_TABLE_NAME[] = "amf_app_imsi_ue_id_htbl";
 constexpr char AMF_TUN_UE_ID_TABLE_NAME[] = "amf_app_tun11_ue_id_htbl";
 constexpr char AMF_GUTI_UE_ID_TABLE_NAME[] = "amf_app_guti_ue_id_htbl";
+constexpr char AMF_TMSI_UE_ID_TABLE_NAME[] = "amf_app_tmsi_ue_id_htbl";
 constexpr char AMF_GNB_UE_ID_AMF_UE_ID_TABLE_NAME[] =
     "amf_app_gnb_ue_ngap_id_ue_id_htbl";
 constexpr char AMF_TASK_NAME[] = "AMF";
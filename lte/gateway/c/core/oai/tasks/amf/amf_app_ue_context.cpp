@@ -114,6 +114,10 @@ int amf_insert_ue_context(amf_ue_ngap_id_t ue_id,
     }
   }
 
+  // A context re-inserted under a new ue_id keeps its 5G-TMSI
+  amf_ue_context_upsert_tmsi(&get_amf_nas_state(false)->amf_ue_contexts,
+                             ue_context_p->amf_context.m5_guti.m_tmsi, ue_id);
+
   OAILOG_FUNC_RETURN(LOG_AMF_APP, RETURNok);
 }
 
@@ -292,6 +296,46 @@ void amf_app_state_free_ue_context(void** ue_context_node) {
   OAILOG_FUNC_OUT(LOG_AMF_APP);
 }
 
+/****************************************************************************
+ **                                                                        **
+ ** Name:    amf_ue_context_upsert_tmsi()                                  **
+ **                                                                        **
+ ** Description: Indexes the UE context of ue_id by its 5G-TMSI            **
+ **                                                                        **
+ **                                                                        **
+ ***************************************************************************/
+void amf_ue_context_upsert_tmsi(amf_ue_context_t* amf_ue_context_p,
+                                tmsi_t tmsi, amf_ue_ngap_id_t ue_id) {
+  // 0 is the TMSI of a context that has not been assigned a GUTI yet
+  if ((tmsi == 0) || (tmsi == INVALID_M_TMSI) ||
+      (ue_id == INVALID_AMF_UE_NGAP_ID)) {
+    return;
+  }
+  amf_ue_context_p->tmsi_ue_context_htbl.remove(tmsi);
+  amf_ue_context_p->tmsi_ue_context_htbl.insert(tmsi, ue_id);
+}
+
+/****************************************************************************
+ **                                                                        **
+ ** Name:    amf_ue_context_remove_tmsi()                                  **
+ **                                                                        **
+ ** Description: Drops the 5G-TMSI index entry of the UE context           **
+ **                                                                        **
+ **                                                                        **
+ ***************************************************************************/
+void amf_ue_context_remove_tmsi(amf_ue_context_t* amf_ue_context_p,
+                                const ue_m5gmm_context_s* ue_context_p) {
+  uint64_t ue_id = INVALID_AMF_UE_NGAP_ID;
+  tmsi_t tmsi = ue_context_p->amf_context.m5_guti.m_tmsi;
+
+  // The TMSI may have been handed over to another context meanwhile
+  if ((amf_ue_context_p->tmsi_ue_context_htbl.get(tmsi, &ue_id) ==
+       magma::MAP_OK) &&
+      (ue_id == ue_context_p->amf_ue_ngap_id)) {
+    amf_ue_context_p->tmsi_ue_context_htbl.remove(tmsi);
+  }
+}
+
 /****************************************************************************
  **                                                                        **
  ** Name:    ue_context_loopkup_by_guti()                                  **
@@ -301,23 +345,24 @@ void amf_app_state_free_ue_context(void** ue_context_node) {
  **                                                                        **
  ***************************************************************************/
 ue_m5gmm_context_s* ue_context_loopkup_by_guti(tmsi_t tmsi_rcv) {
-  tmsi_t tmsi_stored;
-  ue_m5gmm_context_s* ue_context;
-
-  for (auto i = ue_context_map.begin(); i != ue_context_map.end(); i++) {
-    ue_context = i->second;
-    if (ue_context == NULL) {
-      continue;
-    }
+  amf_app_desc_t* amf_app_desc_p = get_amf_nas_state(false);
+  uint64_t ue_id = INVALID_AMF_UE_NGAP_ID;
+  ue_m5gmm_context_s* ue_context = NULL;
 
-    tmsi_stored = ue_context->amf_context.m5_guti.m_tmsi;
+  if (amf_app_desc_p->amf_ue_contexts.tmsi_ue_context_htbl.get(
+          tmsi_rcv, &ue_id) != magma::MAP_OK) {
+    return NULL;
+  }
 
-    if (tmsi_rcv == tmsi_stored) {
-      return ue_context;
-    }
+  ue_context = amf_ue_context_exists_amf_ue_ngap_id((amf_ue_ngap_id_t)ue_id);
+  if ((ue_context == NULL) ||
+      (ue_context->amf_context.m5_guti.m_tmsi != tmsi_rcv)) {
+    // Released or re-assigned without going through the index
+    amf_app_desc_p->amf_ue_contexts.tmsi_ue_context_htbl.remove(tmsi_rcv);
+    return NULL;
   }
 
-  return NULL;
+  return ue_context;
 }
 
 /****************************************************************************
@@ -341,6 +386,8 @@ void ue_context_update_ue_id(ue_m5gmm_context_s* ue_context,
   ue_context_map.insert(
       std::pair<amf_ue_ngap_id_t, ue_m5gmm_context_s*>(ue_id, ue_context));
 
+  amf_ue_context_upsert_tmsi(&get_amf_nas_state(false)->amf_ue_contexts,
+                             ue_context->amf_context.m5_guti.m_tmsi, ue_id);
   return;
 }
 
@@ -348,24 +395,30 @@ void ue_context_update_ue_id(ue_m5gmm_context_s* ue_context,
  **                                                                        **
  ** Name:    ue_context_lookup_by_gnb_ue_id()                              **
  **                                                                        **
- ** Description:  Fetch the ue_context by gnb ue id                        **
+ ** Description:  Fetch the ue_context by gnb id and gnb ue id             **
  **                                                                        **
  **                                                                        **
  ***************************************************************************/
 ue_m5gmm_context_s* ue_context_lookup_by_gnb_ue_id(
-    gnb_ue_ngap_id_t gnb_ue_ngap_id) {
-  ue_m5gmm_context_s* ue_context;
-  for (auto i = ue_context_map.begin(); i != ue_context_map.end(); i++) {
-    ue_context = i->second;
-    if (ue_context == NULL) {
-      continue;
-    }
+    uint32_t gnb_id, gnb_ue_ngap_id_t gnb_ue_ngap_id) {
+  amf_app_desc_t* amf_app_desc_p = get_amf_nas_state(false);
+  gnb_ngap_id_key_t gnb_ngap_id_key = INVALID_GNB_UE_NGAP_ID_KEY;
+  uint64_t ue_id = INVALID_AMF_UE_NGAP_ID;
+  ue_m5gmm_context_s* ue_context = NULL;
+
+  // RAN UE NGAP IDs are only unique within a gNB
+  AMF_APP_GNB_NGAP_ID_KEY(gnb_ngap_id_key, gnb_id, gnb_ue_ngap_id);
+  if (amf_app_desc_p->amf_ue_contexts.gnb_ue_ngap_id_ue_context_htbl.get(
+          gnb_ngap_id_key, &ue_id) != magma::MAP_OK) {
+    return NULL;
+  }
 
-    if (ue_context->gnb_ue_ngap_id == gnb_ue_ngap_id) {
-      return ue_context;
-    }
+  ue_context = amf_ue_context_exists_amf_ue_ngap_id((amf_ue_ngap_id_t)ue_id);
+  if ((ue_context == NULL) ||
+      (ue_context->gnb_ngap_id_key != gnb_ngap_id_key)) {
+    return NULL;
   }
-  return NULL;
+  return ue_context;
 }
 
 /****************************************************************************
@@ -472,7 +525,14 @@ void amf_sync_app_maps_from_db() {
     return;
   }
   ue_context_map = amf_state_ue_id_ht->umap;
+  // The TMSI index is not part of the stored state, rebuild it
+  amf_ue_context_t* amf_ue_context_p =
+      &get_amf_nas_state(false)->amf_ue_contexts;
+  amf_ue_context_p->tmsi_ue_context_htbl.umap.clear();
   for (auto& it : amf_state_ue_id_ht->umap) {
+    amf_ue_context_upsert_tmsi(amf_ue_context_p,
+                               it.second->amf_context.m5_guti.m_tmsi,
+                               it.second->amf_ue_ngap_id);
     guti_and_amf_id_t guti_and_amf_id = {0};
     guti_and_amf_id.amf_guti.m_tmsi = it.second->amf_context.m5_guti.m_tmsi;
     guti_and_amf_id.amf_guti.guamfi = it.second->amf_context.m5_guti.guamfi;
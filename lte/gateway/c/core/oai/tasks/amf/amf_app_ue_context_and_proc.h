@@ -362,6 +362,8 @@ typedef struct amf_ue_context_s {
   magma::map_uint64_uint64_t
       gnb_ue_ngap_id_ue_context_htbl;  // data is amf_ue_ngap_id_t
   map_guti_m5_uint64_t guti_ue_context_htbl;
+  // Rebuilt from the UE contexts on restart, not stored
+  magma::map_uint64_uint64_t tmsi_ue_context_htbl;  // data is amf_ue_ngap_id_t
 } amf_ue_context_t;
 
 enum m5gcm_state_t {
@@ -867,8 +869,19 @@ void amf_delete_child_procedures(amf_context_t* amf_txt,
 void amf_delete_common_procedure(amf_context_t* amf_ctx,
                                  nas_amf_common_proc_t** proc);
 void format_plmn(amf_plmn_t* plmn);
+void amf_ue_context_update_coll_keys(amf_ue_context_t* const amf_ue_context_p,
+                                     ue_m5gmm_context_s* ue_context_p,
+                                     const gnb_ngap_id_key_t gnb_ngap_id_key,
+                                     const amf_ue_ngap_id_t amf_ue_ngap_id,
+                                     const imsi64_t imsi,
+                                     const teid_t amf_teid_n11,
+                                     const guti_m5_t* const guti_p);
 void amf_ue_context_on_new_guti(ue_m5gmm_context_t* ue_context_p,
                                 const guti_m5_t* const guti_p);
+void amf_ue_context_upsert_tmsi(amf_ue_context_t* amf_ue_context_p,
+                                tmsi_t tmsi, amf_ue_ngap_id_t ue_id);
+void amf_ue_context_remove_tmsi(amf_ue_context_t* amf_ue_context_p,
+                                const ue_m5gmm_context_s* ue_context_p);
 ue_m5gmm_context_s* amf_ue_context_exists_guti(
     amf_ue_context_t* const amf_ue_context_p, const guti_m5_t* const guti_p);
 void ambr_calculation_pdu_session(uint16_t* dl_session_ambr,
@@ -882,7 +895,7 @@ ue_m5gmm_context_s* ue_context_loopkup_by_guti(tmsi_t tmsi_rcv);
 void ue_context_update_ue_id(ue_m5gmm_context_s* ue_context,
                              amf_ue_ngap_id_t ue_id);
 ue_m5gmm_context_s* ue_context_lookup_by_gnb_ue_id(
-    gnb_ue_ngap_id_t gnb_ue_ngap_id);
+    uint32_t gnb_id, gnb_ue_ngap_id_t gnb_ue_ngap_id);
 int t3592_abort_handler(ue_m5gmm_context_t* ue_context,
                         std::shared_ptr<smf_context_t> smf_ctx,
                         uint8_t pdu_session_id);
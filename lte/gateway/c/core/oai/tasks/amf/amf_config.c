@@ -385,6 +385,59 @@ int amf_config_parse_file(amf_config_t* config_pP,
         }
       }
     }
+
+    // SUCI profiles, SUCIs of other home network keys are deconcealed by
+    // subscriberdb
+    setting =
+        config_setting_get_member(setting_amf, AMF_CONFIG_STRING_SUCI_PROFILES);
+    config_pP->suci_profile_list.nb = 0;
+    if (setting != NULL) {
+      num = config_setting_length(setting);
+      AssertFatal(num <= MAX_SUCI_PROFILES,
+                  "Number of SUCI profiles configured:%d exceeds number of "
+                  "SUCI profiles supported :%d \n",
+                  num, MAX_SUCI_PROFILES);
+
+      for (i = 0; i < num; i++) {
+        int hn_pubkey_identifier = 0;
+        const char* protection_scheme = NULL;
+        const char* private_key = NULL;
+        sub2setting = config_setting_get_elem(setting, i);
+        if ((sub2setting == NULL) ||
+            !config_setting_lookup_int(
+                sub2setting,
+                AMF_CONFIG_STRING_HOME_NETWORK_PUBLIC_KEY_IDENTIFIER,
+                &hn_pubkey_identifier) ||
+            !config_setting_lookup_string(sub2setting,
+                                          AMF_CONFIG_STRING_PROTECTION_SCHEME,
+                                          &protection_scheme) ||
+            !config_setting_lookup_string(
+                sub2setting, AMF_CONFIG_STRING_HOME_NETWORK_PRIVATE_KEY,
+                &private_key)) {
+          OAILOG_ERROR(LOG_AMF_APP, "Skipping incomplete SUCI profile %d\n",
+                       i);
+          continue;
+        }
+        AssertFatal((hn_pubkey_identifier >= 0) &&
+                        (hn_pubkey_identifier <= UINT8_MAX),
+                    "Bad home network public key identifier %d",
+                    hn_pubkey_identifier);
+        AssertFatal(!strcmp(protection_scheme, "A") ||
+                        !strcmp(protection_scheme, "B"),
+                    "Bad SUCI protection scheme %s, it must be A or B",
+                    protection_scheme);
+
+        suci_profile_t* profile =
+            &config_pP->suci_profile_list
+                 .profiles[config_pP->suci_profile_list.nb];
+        profile->home_network_public_key_identifier =
+            (uint8_t)hn_pubkey_identifier;
+        // Profile identifiers of TS 24.501 Table 9.11.3.4.1
+        profile->protection_scheme = (protection_scheme[0] == 'A') ? 1 : 2;
+        profile->home_network_private_key = bfromcstr(private_key);
+        config_pP->suci_profile_list.nb += 1;
+      }
+    }
   }  // NGP Setting is not NULL
   config_destroy(&cfg);
   return 0;
@@ -431,6 +484,11 @@ void clear_amf_config(amf_config_t* amf_config) {
   bdestroy_wrapper(&amf_config->ip_capability);
   bdestroy_wrapper(&amf_config->amf_name);
   bdestroy_wrapper(&amf_config->default_dnn);
+  for (int i = 0; i < amf_config->suci_profile_list.nb; i++) {
+    bdestroy_wrapper(
+        &amf_config->suci_profile_list.profiles[i].home_network_private_key);
+  }
+  amf_config->suci_profile_list.nb = 0;
   clear_served_tai_config(&amf_config->served_tai);
   free_partial_lists(amf_config->partial_list, amf_config->num_par_lists);
   amf_config->num_par_lists = 0;
@@ -558,6 +616,16 @@ void amf_config_display(amf_config_t* config_pP) {
   OAILOG_INFO(LOG_CONFIG, "- Use Stateless ........................: %s\n\n",
               config_pP->use_stateless ? "true" : "false");
 
+  OAILOG_INFO(LOG_CONFIG, "- SUCI profiles ........................: %d\n",
+              config_pP->suci_profile_list.nb);
+  for (uint8_t itr = 0; itr < config_pP->suci_profile_list.nb; itr++) {
+    const suci_profile_t* profile = &config_pP->suci_profile_list.profiles[itr];
+    OAILOG_INFO(LOG_CONFIG,
+                "    Home network public key identifier %u, profile %c\n",
+                profile->home_network_public_key_identifier,
+                (profile->protection_scheme == 1) ? 'A' : 'B');
+  }
+
   OAILOG_DEBUG(LOG_CONFIG, "- PARTIAL TAIs\n");
   OAILOG_DEBUG(LOG_CONFIG, "- Num of partial lists=%d\n",
                config_pP->num_par_lists);
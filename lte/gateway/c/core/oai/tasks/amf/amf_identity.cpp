@@ -30,6 +30,7 @@ extern "C" {
 #include "lte/gateway/c/core/oai/tasks/amf/amf_sap.h"
 #include "lte/gateway/c/core/oai/tasks/amf/amf_recv.h"
 #include "lte/gateway/c/core/oai/tasks/amf/amf_app_timer_management.h"
+#include "lte/gateway/c/core/oai/tasks/amf/amf_app_state_manager.h"
 
 extern amf_config_t amf_config;
 namespace magma5g {
@@ -155,7 +156,14 @@ int amf_proc_identification_complete(const amf_ue_ngap_id_t ue_id,
       amf_context_upsert_imsi(amf_ctx);
       amf_ctx->imsi64 = imsi64;
       amf_ctx->imsi.length = 8;
+      if (amf_ctx_guti->m_tmsi != amf_ctx->m5_guti.m_tmsi) {
+        amf_ue_context_remove_tmsi(&get_amf_nas_state(false)->amf_ue_contexts,
+                                   ue_mm_context);
+      }
       amf_ctx->m5_guti = *amf_ctx_guti;
+      amf_ue_context_upsert_tmsi(&get_amf_nas_state(false)->amf_ue_contexts,
+                                 amf_ctx->m5_guti.m_tmsi,
+                                 ue_mm_context->amf_ue_ngap_id);
     } else {
       OAILOG_ERROR(LOG_AMF_APP,
                    "should not happen because this type of identity is not "
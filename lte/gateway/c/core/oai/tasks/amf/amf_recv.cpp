@@ -435,12 +435,18 @@ int amf_handle_registration_request(
 
         ue_context->amf_context.reg_id_type = M5GSMobileIdentityMsg_SUCI_IMSI;
 
-        std::string empheral_public_key = reinterpret_cast<char*>(
-            msg->m5gs_mobile_identity.mobile_identity.imsi.empheral_public_key);
-        std::string ciphertext = reinterpret_cast<char*>(
-            msg->m5gs_mobile_identity.mobile_identity.imsi.ciphertext);
-        std::string mac_tag = reinterpret_cast<char*>(
-            msg->m5gs_mobile_identity.mobile_identity.imsi.mac_tag);
+        // The scheme output is binary, it may hold NUL bytes
+        const ImsiM5GSMobileIdentity& suci =
+            msg->m5gs_mobile_identity.mobile_identity.imsi;
+        std::string empheral_public_key(
+            reinterpret_cast<const char*>(suci.empheral_public_key),
+            (suci.protect_schm_id == PROFILE_A)
+                ? EPHEMERAL_PUBLIC_KEY_LENGTH
+                : EPHEMERAL_PUBLIC_KEY_LENGTH + PROFILE_B_LEN);
+        std::string ciphertext(reinterpret_cast<const char*>(suci.ciphertext),
+                               CIPHERTEXT_LENGTH);
+        std::string mac_tag(reinterpret_cast<const char*>(suci.mac_tag),
+                            MAC_TAG_LENGTH);
 
         get_decrypt_imsi_suci_extension(
             &ue_context->amf_context,
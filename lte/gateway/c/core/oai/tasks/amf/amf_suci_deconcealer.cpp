@@ -0,0 +1,326 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lte/gateway/c/core/oai/tasks/amf/amf_suci_deconcealer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <openssl/bn.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/obj_mac.h>
+
+#include "lte/gateway/c/core/oai/common/common_defs.h"
+#include "lte/gateway/c/core/oai/common/log.h"
+
+// 16 bytes AES key, 16 bytes initial counter block, 32 bytes HMAC key
+#define SUCI_AES_KEY_LENGTH 16
+#define SUCI_ICB_LENGTH 16
+#define SUCI_MAC_KEY_LENGTH 32
+#define SUCI_KDF_OUTPUT_LENGTH \
+  (SUCI_AES_KEY_LENGTH + SUCI_ICB_LENGTH + SUCI_MAC_KEY_LENGTH)
+#define SUCI_SHARED_SECRET_LENGTH 32
+
+namespace magma5g {
+
+namespace {
+
+struct EvpPkeyDeleter {
+  void operator()(EVP_PKEY* pkey) const { EVP_PKEY_free(pkey); }
+};
+struct EvpPkeyCtxDeleter {
+  void operator()(EVP_PKEY_CTX* ctx) const { EVP_PKEY_CTX_free(ctx); }
+};
+struct EvpCipherCtxDeleter {
+  void operator()(EVP_CIPHER_CTX* ctx) const { EVP_CIPHER_CTX_free(ctx); }
+};
+struct BnDeleter {
+  void operator()(BIGNUM* bn) const { BN_clear_free(bn); }
+};
+struct BnCtxDeleter {
+  void operator()(BN_CTX* ctx) const { BN_CTX_free(ctx); }
+};
+struct EcPointDeleter {
+  void operator()(EC_POINT* point) const { EC_POINT_clear_free(point); }
+};
+
+typedef std::unique_ptr<EVP_PKEY, EvpPkeyDeleter> EvpPkeyPtr;
+typedef std::unique_ptr<EVP_PKEY_CTX, EvpPkeyCtxDeleter> EvpPkeyCtxPtr;
+typedef std::unique_ptr<EVP_CIPHER_CTX, EvpCipherCtxDeleter> EvpCipherCtxPtr;
+typedef std::unique_ptr<BIGNUM, BnDeleter> BnPtr;
+typedef std::unique_ptr<BN_CTX, BnCtxDeleter> BnCtxPtr;
+typedef std::unique_ptr<EC_POINT, EcPointDeleter> EcPointPtr;
+
+const uint8_t* as_bytes(const std::string& s) {
+  return reinterpret_cast<const uint8_t*>(s.data());
+}
+
+/*
+ * ANSI X9.63 KDF with SHA-256, the ephemeral public key of the UE is the
+ * shared info
+ */
+bool x963_kdf_sha256(const uint8_t* shared_secret, const std::string& info,
+                     uint8_t* output) {
+  uint8_t digest[EVP_MAX_MD_SIZE];
+  unsigned int digest_len = 0;
+  EVP_MD_CTX* md_ctx = EVP_MD_CTX_new();
+  if (md_ctx == nullptr) {
+    return false;
+  }
+  size_t written = 0;
+  bool ok = true;
+  for (uint32_t counter = 1; ok && written < SUCI_KDF_OUTPUT_LENGTH;
+       counter++) {
+    const uint8_t counter_be[4] = {static_cast<uint8_t>(counter >> 24),
+                                   static_cast<uint8_t>(counter >> 16),
+                                   static_cast<uint8_t>(counter >> 8),
+                                   static_cast<uint8_t>(counter)};
+    ok = EVP_DigestInit_ex(md_ctx, EVP_sha256(), nullptr) == 1 &&
+         EVP_DigestUpdate(md_ctx, shared_secret, SUCI_SHARED_SECRET_LENGTH) ==
+             1 &&
+         EVP_DigestUpdate(md_ctx, counter_be, sizeof(counter_be)) == 1 &&
+         EVP_DigestUpdate(md_ctx, info.data(), info.size()) == 1 &&
+         EVP_DigestFinal_ex(md_ctx, digest, &digest_len) == 1;
+    if (ok) {
+      size_t n = std::min(static_cast<size_t>(digest_len),
+                          SUCI_KDF_OUTPUT_LENGTH - written);
+      memcpy(output + written, digest, n);
+      written += n;
+    }
+  }
+  EVP_MD_CTX_free(md_ctx);
+  OPENSSL_cleanse(digest, sizeof(digest));
+  return ok;
+}
+
+}  // namespace
+
+struct SuciDeconcealer::HomeNetworkKey {
+  uint8_t protection_scheme;
+  // Profile A
+  EvpPkeyPtr x25519_key;
+  // Profile B
+  BnPtr p256_key;
+};
+
+SuciDeconcealer::SuciDeconcealer()
+    : p256_group_(EC_GROUP_new_by_curve_name(NID_X9_62_prime256v1)) {}
+
+SuciDeconcealer::~SuciDeconcealer() { EC_GROUP_free(p256_group_); }
+
+SuciDeconcealer& SuciDeconcealer::getInstance() {
+  static SuciDeconcealer instance;
+  return instance;
+}
+
+bool SuciDeconcealer::add_home_network_key(uint8_t hn_pubkey_identifier,
+                                           uint8_t protection_scheme,
+                                           const std::string& private_key) {
+  if (private_key.size() != SUCI_PRIVATE_KEY_LENGTH) {
+    return false;
+  }
+  std::unique_ptr<HomeNetworkKey> key(new HomeNetworkKey());
+  key->protection_scheme = protection_scheme;
+  switch (protection_scheme) {
+    case SUCI_PROTECTION_SCHEME_PROFILE_A:
+      key->x25519_key.reset(EVP_PKEY_new_raw_private_key(
+          EVP_PKEY_X25519, nullptr, as_bytes(private_key), private_key.size()));
+      if (!key->x25519_key) {
+        return false;
+      }
+      break;
+    case SUCI_PROTECTION_SCHEME_PROFILE_B: {
+      if (p256_group_ == nullptr) {
+        return false;
+      }
+      key->p256_key.reset(
+          BN_bin2bn(as_bytes(private_key), private_key.size(), nullptr));
+      // The private key must be in [1, n - 1]
+      if (!key->p256_key || BN_is_zero(key->p256_key.get()) ||
+          BN_cmp(key->p256_key.get(), EC_GROUP_get0_order(p256_group_)) >= 0) {
+        return false;
+      }
+      BN_set_flags(key->p256_key.get(), BN_FLG_CONSTTIME);
+      break;
+    }
+    default:
+      return false;
+  }
+  keys_[hn_pubkey_identifier] = std::move(key);
+  return true;
+}
+
+bool SuciDeconcealer::has_home_network_key(
+    uint8_t hn_pubkey_identifier) const {
+  return keys_.find(hn_pubkey_identifier) != keys_.end();
+}
+
+void SuciDeconcealer::clear() { keys_.clear(); }
+
+bool SuciDeconcealer::derive_profile_a(const HomeNetworkKey& key,
+                                       const std::string& ue_pubkey,
+                                       uint8_t* shared_secret) const {
+  if (ue_pubkey.size() != SUCI_PROFILE_A_PUBLIC_KEY_LENGTH) {
+    return false;
+  }
+  EvpPkeyPtr peer(EVP_PKEY_new_raw_public_key(
+      EVP_PKEY_X25519, nullptr, as_bytes(ue_pubkey), ue_pubkey.size()));
+  EvpPkeyCtxPtr ctx(EVP_PKEY_CTX_new(key.x25519_key.get(), nullptr));
+  size_t len = SUCI_SHARED_SECRET_LENGTH;
+  // Fails on the all zero shared secret of small order public keys
+  return peer && ctx && EVP_PKEY_derive_init(ctx.get()) == 1 &&
+         EVP_PKEY_derive_set_peer(ctx.get(), peer.get()) == 1 &&
+         EVP_PKEY_derive(ctx.get(), shared_secret, &len) == 1 &&
+         len == SUCI_SHARED_SECRET_LENGTH;
+}
+
+bool SuciDeconcealer::derive_profile_b(const HomeNetworkKey& key,
+                                       const std::string& ue_pubkey,
+                                       uint8_t* shared_secret) const {
+  if (ue_pubkey.size() != SUCI_PROFILE_B_PUBLIC_KEY_LENGTH) {
+    return false;
+  }
+  BnCtxPtr bn_ctx(BN_CTX_new());
+  EcPointPtr peer(EC_POINT_new(p256_group_));
+  EcPointPtr shared(EC_POINT_new(p256_group_));
+  BnPtr x(BN_new());
+  // Decoding the point checks that it is on the curve
+  return bn_ctx && peer && shared && x &&
+         EC_POINT_oct2point(p256_group_, peer.get(), as_bytes(ue_pubkey),
+                            ue_pubkey.size(), bn_ctx.get()) == 1 &&
+         EC_POINT_mul(p256_group_, shared.get(), nullptr, peer.get(),
+                      key.p256_key.get(), bn_ctx.get()) == 1 &&
+         !EC_POINT_is_at_infinity(p256_group_, shared.get()) &&
+         EC_POINT_get_affine_coordinates(p256_group_, shared.get(), x.get(),
+                                         nullptr, bn_ctx.get()) == 1 &&
+         BN_bn2binpad(x.get(), shared_secret, SUCI_SHARED_SECRET_LENGTH) ==
+             SUCI_SHARED_SECRET_LENGTH;
+}
+
+bool SuciDeconcealer::deconceal(uint8_t hn_pubkey_identifier,
+                                const std::string& ue_pubkey,
+                                const std::string& ciphertext,
+                                const std::string& mac_tag,
+                                std::string* plaintext) const {
+  auto it = keys_.find(hn_pubkey_identifier);
+  if (it == keys_.end() || mac_tag.size() != SUCI_MAC_TAG_LENGTH ||
+      ciphertext.empty()) {
+    return false;
+  }
+  const HomeNetworkKey& key = *it->second;
+
+  uint8_t shared_secret[SUCI_SHARED_SECRET_LENGTH];
+  bool derived =
+      (key.protection_scheme == SUCI_PROTECTION_SCHEME_PROFILE_A)
+          ? derive_profile_a(key, ue_pubkey, shared_secret)
+          : derive_profile_b(key, ue_pubkey, shared_secret);
+  uint8_t keys[SUCI_KDF_OUTPUT_LENGTH];
+  derived = derived && x963_kdf_sha256(shared_secret, ue_pubkey, keys);
+  OPENSSL_cleanse(shared_secret, sizeof(shared_secret));
+  if (!derived) {
+    OPENSSL_cleanse(keys, sizeof(keys));
+    return false;
+  }
+  const uint8_t* aes_key = keys;
+  const uint8_t* icb = keys + SUCI_AES_KEY_LENGTH;
+  const uint8_t* mac_key = keys + SUCI_AES_KEY_LENGTH + SUCI_ICB_LENGTH;
+
+  // The MAC tag is checked before decrypting
+  uint8_t mac[EVP_MAX_MD_SIZE];
+  unsigned int mac_len = 0;
+  bool ok = HMAC(EVP_sha256(), mac_key, SUCI_MAC_KEY_LENGTH,
+                 as_bytes(ciphertext), ciphertext.size(), mac,
+                 &mac_len) != nullptr &&
+            mac_len >= SUCI_MAC_TAG_LENGTH &&
+            CRYPTO_memcmp(mac, mac_tag.data(), SUCI_MAC_TAG_LENGTH) == 0;
+
+  if (ok) {
+    EvpCipherCtxPtr cipher_ctx(EVP_CIPHER_CTX_new());
+    plaintext->resize(ciphertext.size());
+    int out_len = 0;
+    int final_len = 0;
+    uint8_t* out = reinterpret_cast<uint8_t*>(&(*plaintext)[0]);
+    ok = cipher_ctx &&
+         EVP_DecryptInit_ex(cipher_ctx.get(), EVP_aes_128_ctr(), nullptr,
+                            aes_key, icb) == 1 &&
+         EVP_DecryptUpdate(cipher_ctx.get(), out, &out_len,
+                           as_bytes(ciphertext), ciphertext.size()) == 1 &&
+         EVP_DecryptFinal_ex(cipher_ctx.get(), out + out_len, &final_len) ==
+             1 &&
+         static_cast<size_t>(out_len + final_len) == ciphertext.size();
+    if (!ok) {
+      plaintext->clear();
+    }
+  }
+  OPENSSL_cleanse(keys, sizeof(keys));
+  return ok;
+}
+
+bool suci_hex_to_bytes(const char* hex, std::string* bytes) {
+  size_t len = strlen(hex);
+  if (len % 2 != 0) {
+    return false;
+  }
+  bytes->clear();
+  bytes->reserve(len / 2);
+  for (size_t i = 0; i < len; i += 2) {
+    int value = 0;
+    for (size_t j = i; j < i + 2; j++) {
+      char c = hex[j];
+      value <<= 4;
+      if (c >= '0' && c <= '9') {
+        value |= c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        value |= c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+        value |= c - 'A' + 10;
+      } else {
+        return false;
+      }
+    }
+    bytes->push_back(static_cast<char>(value));
+  }
+  return true;
+}
+
+int amf_load_suci_home_network_keys(const amf_config_t* amf_config_p) {
+  int rc = RETURNok;
+  uint8_t cached = 0;
+  const suci_profile_list_t& profiles = amf_config_p->suci_profile_list;
+  for (uint8_t i = 0; i < profiles.nb; i++) {
+    const suci_profile_t& profile = profiles.profiles[i];
+    std::string private_key;
+    if (!profile.home_network_private_key ||
+        !suci_hex_to_bytes(bdata(profile.home_network_private_key),
+                           &private_key) ||
+        !SuciDeconcealer::getInstance().add_home_network_key(
+            profile.home_network_public_key_identifier,
+            profile.protection_scheme, private_key)) {
+      OAILOG_ERROR(LOG_AMF_APP,
+                   "Invalid private key of home network public key "
+                   "identifier %u, its SUCIs are deconcealed by "
+                   "subscriberdb\n",
+                   profile.home_network_public_key_identifier);
+      rc = RETURNerror;
+    } else {
+      cached++;
+    }
+    OPENSSL_cleanse(&private_key[0], private_key.size());
+  }
+  OAILOG_INFO(LOG_AMF_APP, "Cached %u SUCI home network keys\n", cached);
+  return rc;
+}
+
+}  // namespace magma5g
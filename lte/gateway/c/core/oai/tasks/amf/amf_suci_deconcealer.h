@@ -0,0 +1,107 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+#include <openssl/ec.h>
+
+#include "lte/gateway/c/core/oai/include/amf_config.h"
+
+namespace magma5g {
+
+// Protection scheme identifiers of TS 24.501 Table 9.11.3.4.1
+#define SUCI_PROTECTION_SCHEME_PROFILE_A 1
+#define SUCI_PROTECTION_SCHEME_PROFILE_B 2
+
+#define SUCI_PRIVATE_KEY_LENGTH 32
+#define SUCI_PROFILE_A_PUBLIC_KEY_LENGTH 32
+#define SUCI_PROFILE_B_PUBLIC_KEY_LENGTH 33
+#define SUCI_MAC_TAG_LENGTH 8
+
+/**
+ * Deconceals SUCIs in the AMF with the ECIES profiles of TS 33.501 Annex C.3
+ * and the home network private keys cached in it, instead of a round trip to
+ * subscriberdb:
+ *  - profile A: X25519
+ *  - profile B: secp256r1, compressed ephemeral public keys
+ * with the ANSI X9.63 KDF over SHA-256, AES-128 in CTR mode and HMAC-SHA-256
+ * tags truncated to 8 bytes.
+ *
+ * Keys are added when the AMF task starts and only read after that, so the
+ * deconcealer is not locked.
+ */
+class SuciDeconcealer {
+ public:
+  SuciDeconcealer();
+  ~SuciDeconcealer();
+
+  SuciDeconcealer(const SuciDeconcealer&) = delete;
+  SuciDeconcealer& operator=(const SuciDeconcealer&) = delete;
+
+  static SuciDeconcealer& getInstance();
+
+  /**
+   * Cache the private key of a home network public key identifier, replacing
+   * the key cached for it if any
+   * @param private_key raw 32 byte private key of the profile
+   * @return false if the profile or the key is invalid
+   */
+  bool add_home_network_key(uint8_t hn_pubkey_identifier,
+                            uint8_t protection_scheme,
+                            const std::string& private_key);
+
+  bool has_home_network_key(uint8_t hn_pubkey_identifier) const;
+
+  void clear();
+
+  /**
+   * Deconceal the scheme output of a SUCI
+   * @param plaintext set to the deconcealed MSIN, as packed by the UE
+   * @return false if the identifier has no cached key, the ephemeral public
+   * key is invalid or the MAC tag does not match
+   */
+  bool deconceal(uint8_t hn_pubkey_identifier, const std::string& ue_pubkey,
+                 const std::string& ciphertext, const std::string& mac_tag,
+                 std::string* plaintext) const;
+
+ private:
+  struct HomeNetworkKey;
+
+  bool derive_profile_a(const HomeNetworkKey& key, const std::string& ue_pubkey,
+                        uint8_t* shared_secret) const;
+  bool derive_profile_b(const HomeNetworkKey& key, const std::string& ue_pubkey,
+                        uint8_t* shared_secret) const;
+
+  std::map<uint8_t, std::unique_ptr<HomeNetworkKey>> keys_;
+  // secp256r1, shared by the profile B keys
+  EC_GROUP* p256_group_;
+};
+
+/**
+ * Convert a hex string to bytes
+ * @return false if it is not an even number of hex digits
+ */
+bool suci_hex_to_bytes(const char* hex, std::string* bytes);
+
+/**
+ * Cache the home network keys of the SUCI profiles of the AMF configuration
+ * @return RETURNerror if a profile is invalid, the valid ones are cached
+ */
+int amf_load_suci_home_network_keys(const amf_config_t* amf_config_p);
+
+}  // namespace magma5g
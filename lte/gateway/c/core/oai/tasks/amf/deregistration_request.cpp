@@ -263,6 +263,8 @@ void amf_remove_ue_context(ue_m5gmm_context_s* ue_context_p) {
   std::unordered_map<amf_ue_ngap_id_t, ue_m5gmm_context_s*>::iterator
       found_ue_id = ue_context_map.find(ue_context_p->amf_ue_ngap_id);
   delete_amf_ue_state(ue_context_p->amf_context.imsi64);
+  amf_ue_context_remove_tmsi(&get_amf_nas_state(false)->amf_ue_contexts,
+                             ue_context_p);
 
   if (found_ue_id != ue_context_map.end()) {
     OAILOG_DEBUG(LOG_AMF_APP,
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <unistd.h>
+#include <sys/stat.h>
 #include <linux/bpf.h>
 
 #ifndef __NR_bpf
@@ -70,6 +71,17 @@ int bpf_map_update_elem(int fd, void* key, void* value, uint64_t flags) {
   return sys_bpf(BPF_MAP_UPDATE_ELEM, &attr, sizeof(attr));
 }
 
+int bpf_map_lookup_elem(int fd, void* key, void* value) {
+  union bpf_attr attr;
+
+  bzero(&attr, sizeof(attr));
+  attr.map_fd = fd;
+  attr.key = ptr_to_u64(key);
+  attr.value = ptr_to_u64(value);
+
+  return sys_bpf(BPF_MAP_LOOKUP_ELEM, &attr, sizeof(attr));
+}
+
 int bpf_map_delete_elem(int fd, void* key) {
   union bpf_attr attr;
   int ret;
@@ -80,3 +92,39 @@ int bpf_map_delete_elem(int fd, void* key) {
 
   return sys_bpf(BPF_MAP_DELETE_ELEM, &attr, sizeof(attr));
 }
+
+/*
+ * A pinned map, opened once. pipelined pins new maps when it restarts, so
+ * the pin is checked on every use and the map opened again only when its
+ * inode changed.
+ */
+struct bpf_pinned_map {
+  const char* path;
+  int fd;
+  ino_t ino;
+};
+
+#define BPF_PINNED_MAP_INIT(map_path) \
+  { .path = (map_path), .fd = -1, .ino = 0 }
+
+int bpf_pinned_map_fd(struct bpf_pinned_map* map) {
+  struct stat st;
+
+  if (stat(map->path, &st) < 0) {
+    // Not pinned (anymore)
+    if (map->fd >= 0) {
+      close(map->fd);
+      map->fd = -1;
+    }
+    return -1;
+  }
+  if (map->fd >= 0 && st.st_ino == map->ino) {
+    return map->fd;
+  }
+  if (map->fd >= 0) {
+    close(map->fd);
+  }
+  map->fd = bpf_obj_get(map->path);
+  map->ino = st.st_ino;
+  return map->fd;
+}
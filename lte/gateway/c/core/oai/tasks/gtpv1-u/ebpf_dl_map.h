@@ -19,11 +19,11 @@
 #include "lte/gateway/c/core/oai/tasks/gtpv1-u/ebpf.h"
 
 #define DL_MAP_PATH "/sys/fs/bpf/dl_map"
+#define DL_STATS_MAP_PATH "/sys/fs/bpf/dl_stats_map"
 
 struct bpf_map_val {
   uint32_t ip;
   uint32_t tei;
-  uint64_t bytes;
   uint8_t user_data[64];
 };
 
@@ -31,13 +31,30 @@ int get_map_fd() { return bpf_obj_get(DL_MAP_PATH); }
 
 void add_ebpf_dl_map_entry(int hash_fd, struct in_addr ue, struct in_addr enb,
                            uint32_t o_tei, Imsi_t imsi) {
-  struct bpf_map_val val = {htonl(enb.s_addr), o_tei, 0, {}};
+  struct bpf_map_val val = {htonl(enb.s_addr), o_tei, {}};
   memcpy(val.user_data, imsi.digit, sizeof(imsi.digit));
   uint32_t nkey = htonl(ue.s_addr);
   bpf_map_update_elem(hash_fd, &nkey, &val, 0);
 }
 
+int lookup_ebpf_dl_map_entry(int hash_fd, struct in_addr ue,
+                             struct bpf_map_val* val) {
+  uint32_t nkey = htonl(ue.s_addr);
+  return bpf_map_lookup_elem(hash_fd, &nkey, val);
+}
+
+void restore_ebpf_dl_map_entry(int hash_fd, struct in_addr ue,
+                               struct bpf_map_val* val) {
+  uint32_t nkey = htonl(ue.s_addr);
+  bpf_map_update_elem(hash_fd, &nkey, val, BPF_ANY);
+}
+
 void delete_ebpf_dl_map_entry(int hash_fd, struct in_addr ue) {
   uint32_t nkey = htonl(ue.s_addr);
   bpf_map_delete_elem(hash_fd, &nkey);
 }
+
+void delete_ebpf_dl_stats_entry(int hash_fd, struct in_addr ue) {
+  uint32_t nkey = htonl(ue.s_addr);
+  bpf_map_delete_elem(hash_fd, &nkey);
+}
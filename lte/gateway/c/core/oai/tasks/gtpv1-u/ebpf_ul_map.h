@@ -0,0 +1,54 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* File : ebpf_ul_map.h
+ */
+
+#pragma once
+
+#include "lte/gateway/c/core/oai/tasks/gtpv1-u/ebpf.h"
+
+#define UL_TUNNEL_MAP_PATH "/sys/fs/bpf/ul_tunnel_map"
+#define UL_STATS_MAP_PATH "/sys/fs/bpf/ul_stats_map"
+
+/*
+ * Must match struct ul_tunnel_info of pipelined's ebpf_ul_handler.c. The
+ * SGW only writes ul_tunnel_map, the QoS mark of a UE is set by pipelined
+ * in ul_map. The datapath only forwards once a UE has both entries.
+ */
+struct bpf_ul_tunnel_val {
+  uint32_t tei;
+};
+
+void add_ebpf_ul_tunnel_entry(int hash_fd, struct in_addr ue,
+                              uint32_t i_tei) {
+  struct bpf_ul_tunnel_val val = {i_tei};
+  uint32_t nkey = htonl(ue.s_addr);
+  bpf_map_update_elem(hash_fd, &nkey, &val, BPF_ANY);
+}
+
+int lookup_ebpf_ul_tunnel_entry(int hash_fd, struct in_addr ue,
+                                struct bpf_ul_tunnel_val* val) {
+  uint32_t nkey = htonl(ue.s_addr);
+  return bpf_map_lookup_elem(hash_fd, &nkey, val);
+}
+
+void delete_ebpf_ul_tunnel_entry(int hash_fd, struct in_addr ue) {
+  uint32_t nkey = htonl(ue.s_addr);
+  bpf_map_delete_elem(hash_fd, &nkey);
+}
+
+void delete_ebpf_ul_stats_entry(int hash_fd, struct in_addr ue) {
+  uint32_t nkey = htonl(ue.s_addr);
+  bpf_map_delete_elem(hash_fd, &nkey);
+}
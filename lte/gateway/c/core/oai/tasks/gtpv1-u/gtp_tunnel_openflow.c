@@ -24,8 +24,11 @@
 #include "lte/gateway/c/core/oai/common/assertions.h"
 #include "lte/gateway/c/core/oai/lib/bstr/bstrlib.h"
 #include "lte/gateway/c/core/oai/common/log.h"
+#include "lte/gateway/c/core/oai/common/dynamic_memory_check.h"
+#include "lte/gateway/c/core/oai/lib/hashtable/hashtable.h"
 #include "lte/gateway/c/core/oai/tasks/gtpv1-u/gtpv1u.h"
 #include "lte/gateway/c/core/oai/tasks/gtpv1-u/ebpf_dl_map.h"
+#include "lte/gateway/c/core/oai/tasks/gtpv1-u/ebpf_ul_map.h"
 #include "lte/gateway/c/core/oai/lib/openflow/controller/ControllerMain.h"
 #include "lte/gateway/c/core/oai/lib/3gpp/3gpp_23.003.h"
 #include "lte/gateway/c/core/oai/include/spgw_config.h"
@@ -35,8 +38,6 @@ extern struct gtp_tunnel_ops gtp_tunnel_ops;
 // Tunnel port related functionality
 static const char* ovs_gtp_type;
 
-static int ebpf_fd;
-
 #define MAX_GTP_PORT_NAME_LENGTH 39
 
 #define INIT_GTP_TABLE_SIZE 64
@@ -285,10 +286,149 @@ int openflow_init(struct in_addr* ue_net, uint32_t mask, int mtu, int* fd0,
                   int* fd1u, bool persist_state) {
   AssertFatal(start_of_controller(persist_state) >= 0,
               "Could not start openflow controller\n");
-  ebpf_fd = get_map_fd();
   return 0;
 }
 
+/*
+ * The eBPF maps are pinned by pipelined. They are opened on first use and
+ * only opened again when pipelined pins new maps on restart. Only default
+ * bearers are programmed: dedicated bearers need the TFT match of OVS.
+ */
+static struct bpf_pinned_map ebpf_dl_map = BPF_PINNED_MAP_INIT(DL_MAP_PATH);
+static struct bpf_pinned_map ebpf_ul_tunnel_map =
+    BPF_PINNED_MAP_INIT(UL_TUNNEL_MAP_PATH);
+static struct bpf_pinned_map ebpf_dl_stats_map =
+    BPF_PINNED_MAP_INIT(DL_STATS_MAP_PATH);
+static struct bpf_pinned_map ebpf_ul_stats_map =
+    BPF_PINNED_MAP_INIT(UL_STATS_MAP_PATH);
+
+/*
+ * Map entries of suspended UEs, keyed by UE IPv4 address. Resuming only
+ * knows the UE and its S1-U TEID, so the entries are kept here to program
+ * them again.
+ */
+struct ebpf_suspended_tunnel {
+  struct bpf_map_val dl;
+  struct bpf_ul_tunnel_val ul;
+};
+#define EBPF_SUSPENDED_TUNNELS_HT_SIZE 64
+static hash_table_ts_t* ebpf_suspended_tunnels = NULL;
+
+static hash_table_ts_t* get_ebpf_suspended_tunnels(void) {
+  if (ebpf_suspended_tunnels == NULL) {
+    bstring ht_name = bfromcstr("ebpf_suspended_tunnels");
+    ebpf_suspended_tunnels = hashtable_ts_create(
+        EBPF_SUSPENDED_TUNNELS_HT_SIZE, NULL, free_wrapper, ht_name);
+    bdestroy(ht_name);
+  }
+  return ebpf_suspended_tunnels;
+}
+
+static void ebpf_forget_suspended_tunnel(struct in_addr ue) {
+  if (ebpf_suspended_tunnels != NULL) {
+    hashtable_ts_free(ebpf_suspended_tunnels, (hash_key_t)ue.s_addr);
+  }
+}
+
+static void ebpf_add_tunnel(struct in_addr ue, struct in_addr enb,
+                            uint32_t i_tei, uint32_t o_tei, Imsi_t imsi) {
+  if (ue.s_addr == INADDR_ANY || enb.s_addr == INADDR_ANY) {
+    // TODO add IPv6 support
+    return;
+  }
+  OAILOG_DEBUG(LOG_GTPV1U, "Adding eBPF entries for UE %x i_tei %u o_tei %u\n",
+               ue.s_addr, i_tei, o_tei);
+  ebpf_forget_suspended_tunnel(ue);
+  int dl_fd = bpf_pinned_map_fd(&ebpf_dl_map);
+  if (dl_fd >= 0) {
+    add_ebpf_dl_map_entry(dl_fd, ue, enb, o_tei, imsi);
+  }
+  int ul_fd = bpf_pinned_map_fd(&ebpf_ul_tunnel_map);
+  if (ul_fd >= 0) {
+    add_ebpf_ul_tunnel_entry(ul_fd, ue, i_tei);
+  }
+  if (dl_fd < 0 || ul_fd < 0) {
+    OAILOG_WARNING(LOG_GTPV1U, "eBPF maps not pinned, UE %x stays on OVS\n",
+                   ue.s_addr);
+  }
+}
+
+/*
+ * The per UE counters are removed along with the tunnel, but kept while the
+ * UE is only suspended.
+ */
+static void ebpf_del_tunnel(struct in_addr ue, bool del_stats) {
+  if (ue.s_addr == INADDR_ANY) {
+    return;
+  }
+  int fd = bpf_pinned_map_fd(&ebpf_dl_map);
+  if (fd >= 0) {
+    delete_ebpf_dl_map_entry(fd, ue);
+  }
+  fd = bpf_pinned_map_fd(&ebpf_ul_tunnel_map);
+  if (fd >= 0) {
+    delete_ebpf_ul_tunnel_entry(fd, ue);
+  }
+  if (!del_stats) {
+    return;
+  }
+  ebpf_forget_suspended_tunnel(ue);
+  fd = bpf_pinned_map_fd(&ebpf_dl_stats_map);
+  if (fd >= 0) {
+    delete_ebpf_dl_stats_entry(fd, ue);
+  }
+  fd = bpf_pinned_map_fd(&ebpf_ul_stats_map);
+  if (fd >= 0) {
+    delete_ebpf_ul_stats_entry(fd, ue);
+  }
+}
+
+static void ebpf_suspend_tunnel(struct in_addr ue) {
+  if (ue.s_addr == INADDR_ANY) {
+    return;
+  }
+  hash_table_ts_t* suspended_tunnels = get_ebpf_suspended_tunnels();
+  struct ebpf_suspended_tunnel* suspended =
+      calloc(1, sizeof(struct ebpf_suspended_tunnel));
+  int dl_fd = bpf_pinned_map_fd(&ebpf_dl_map);
+  int ul_fd = bpf_pinned_map_fd(&ebpf_ul_tunnel_map);
+  if (suspended_tunnels == NULL || suspended == NULL || dl_fd < 0 ||
+      ul_fd < 0 || lookup_ebpf_dl_map_entry(dl_fd, ue, &suspended->dl) < 0 ||
+      lookup_ebpf_ul_tunnel_entry(ul_fd, ue, &suspended->ul) < 0) {
+    // Not on eBPF, nothing to restore on resume
+    free(suspended);
+  } else {
+    hashtable_rc_t rc = hashtable_ts_insert(
+        suspended_tunnels, (hash_key_t)ue.s_addr, (void*)suspended);
+    if (rc != HASH_TABLE_OK && rc != HASH_TABLE_INSERT_OVERWRITTEN_DATA) {
+      OAILOG_WARNING(LOG_GTPV1U,
+                     "Failed to keep eBPF entries of suspended UE %x\n",
+                     ue.s_addr);
+      free(suspended);
+    }
+  }
+  ebpf_del_tunnel(ue, false);
+}
+
+static void ebpf_resume_tunnel(struct in_addr ue) {
+  struct ebpf_suspended_tunnel* suspended = NULL;
+  if (ue.s_addr == INADDR_ANY || ebpf_suspended_tunnels == NULL ||
+      hashtable_ts_remove(ebpf_suspended_tunnels, (hash_key_t)ue.s_addr,
+                          (void**)&suspended) != HASH_TABLE_OK) {
+    return;
+  }
+  OAILOG_DEBUG(LOG_GTPV1U, "Restoring eBPF entries for UE %x\n", ue.s_addr);
+  int fd = bpf_pinned_map_fd(&ebpf_dl_map);
+  if (fd >= 0) {
+    restore_ebpf_dl_map_entry(fd, ue, &suspended->dl);
+  }
+  fd = bpf_pinned_map_fd(&ebpf_ul_tunnel_map);
+  if (fd >= 0) {
+    add_ebpf_ul_tunnel_entry(fd, ue, suspended->ul.tei);
+  }
+  free(suspended);
+}
+
 int openflow_reset(void) {
   int rv = 0;
   return rv;
@@ -301,13 +441,8 @@ int openflow_add_tunnel(struct in_addr ue, struct in6_addr* ue_ipv6, int vlan,
                         char* apn) {
   uint32_t gtp_portno = find_gtp_port_no(enb, enb_ipv6, false);
 
-  if (spgw_config.sgw_config.ebpf_enabled) {
-    OAILOG_INFO(LOG_GTPV1U, "Adding UE EBPF ENTRY %d, %d htonl %d \n",
-                ue.s_addr, o_tei, htonl(o_tei));
-    if (ue.s_addr != INADDR_ANY && enb.s_addr != INADDR_ANY) {
-      add_ebpf_dl_map_entry(ebpf_fd, ue, enb, o_tei, imsi);
-    }
-    // TODO add IPv6 support
+  if (spgw_config.sgw_config.ebpf_enabled && flow_dl == NULL) {
+    ebpf_add_tunnel(ue, enb, i_tei, o_tei, imsi);
   }
 
   return openflow_controller_add_gtp_tunnel(
@@ -321,11 +456,8 @@ int openflow_del_tunnel(struct in_addr enb, struct in6_addr* enb_ipv6,
                         struct ip_flow_dl* flow_dl) {
   uint32_t gtp_portno = find_gtp_port_no(enb, enb_ipv6, false);
 
-  if (spgw_config.sgw_config.ebpf_enabled) {
-    if (ue.s_addr != INADDR_ANY && enb.s_addr != INADDR_ANY) {
-      delete_ebpf_dl_map_entry(ebpf_fd, ue);
-    }
-    // TODO add IPv6 support
+  if (spgw_config.sgw_config.ebpf_enabled && flow_dl == NULL) {
+    ebpf_del_tunnel(ue, true);
   }
 
   return openflow_controller_del_gtp_tunnel(ue, ue_ipv6, i_tei, flow_dl,
@@ -361,6 +493,10 @@ int openflow_del_s8_tunnel(struct in_addr enb, struct in6_addr* enb_ipv6,
 int openflow_discard_data_on_tunnel(struct in_addr ue, struct in6_addr* ue_ipv6,
                                     uint32_t i_tei,
                                     struct ip_flow_dl* flow_dl) {
+  if (spgw_config.sgw_config.ebpf_enabled && flow_dl == NULL) {
+    // Suspended UEs are handled by OVS until forwarding is resumed
+    ebpf_suspend_tunnel(ue);
+  }
   return openflow_controller_discard_data_on_tunnel(ue, ue_ipv6, i_tei,
                                                     flow_dl);
 }
@@ -368,6 +504,9 @@ int openflow_discard_data_on_tunnel(struct in_addr ue, struct in6_addr* ue_ipv6,
 int openflow_forward_data_on_tunnel(struct in_addr ue, struct in6_addr* ue_ipv6,
                                     uint32_t i_tei, struct ip_flow_dl* flow_dl,
                                     uint32_t flow_precedence_dl) {
+  if (spgw_config.sgw_config.ebpf_enabled && flow_dl == NULL) {
+    ebpf_resume_tunnel(ue);
+  }
   return openflow_controller_forward_data_on_tunnel(ue, ue_ipv6, i_tei, flow_dl,
                                                     flow_precedence_dl);
 }
@@ -22,17 +22,10 @@ extern "C" {
 #include "lte/gateway/c/core/oai/lib/itti/intertask_interface_types.h"
 #include "lte/gateway/c/core/oai/lib/itti/itti_types.h"
 #include "lte/gateway/c/core/oai/common/log.h"
-#include "lte/gateway/c/core/oai/include/s1ap_state.h"
-#include "S1ap_CauseRadioNetwork.h"
+#include "lte/gateway/c/core/oai/common/conversions.h"
 }
 
 #include "lte/gateway/c/core/oai/tasks/ha/HaClient.h"
-#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_state_manager.h"
-#include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_state_manager.h"
-
-static bool trigger_agw_offload_for_ue(const hash_key_t keyP,
-                                       void* const elementP, void* parameterP,
-                                       void** resultP);
 
 bool sync_up_with_orc8r(void) {
   magma::HaClient::get_eNB_offload_state(
@@ -70,106 +63,18 @@ bool sync_up_with_orc8r(void) {
   return true;
 }
 
-typedef struct callback_data_s {
-  s1ap_state_t* s1ap_state;
-  ha_agw_offload_req_t* request;
-} callback_data_t;
-
+// UE contexts belong to MME_APP, which looks the UEs up in its eNB index and
+// paces their releases and pages
 void handle_agw_offload_req(ha_agw_offload_req_t* offload_req) {
-  hash_table_ts_t* state_imsi_ht =
-      magma::lte::MmeNasStateManager::getInstance().get_ue_state_ht();
-  callback_data_t callback_data;
-  callback_data.s1ap_state =
-      magma::lte::S1apStateManager::getInstance().get_state(false);
-  callback_data.request = offload_req;
-  hashtable_ts_apply_callback_on_elements(
-      state_imsi_ht, trigger_agw_offload_for_ue, (void*)&callback_data, NULL);
-}
-
-bool trigger_agw_offload_for_ue(const hash_key_t keyP, void* const elementP,
-                                void* parameterP, void** resultP) {
-  imsi64_t imsi64 = INVALID_IMSI64;
-  callback_data_t* callback_data = (callback_data_t*)parameterP;
-  ha_agw_offload_req_t* offload_request =
-      (ha_agw_offload_req_t*)callback_data->request;
-  s1ap_state_t* s1ap_state = (s1ap_state_t*)callback_data->s1ap_state;
-  struct ue_mm_context_s* ue_context_p = (struct ue_mm_context_s*)elementP;
-  bool any_flag = false;  // true if we tried offloading any UE
-
-  IMSI_STRING_TO_IMSI64(offload_request->imsi, &imsi64);
-
-  enb_description_t* enb_ref_p =
-      s1ap_state_get_enb(s1ap_state, ue_context_p->sctp_assoc_id_key);
-
-  // Return if this UE does not satisfy any of the filtering criteria
-  if ((imsi64 != ue_context_p->emm_context._imsi64) &&
-      (offload_request->eNB_id != enb_ref_p->enb_id)) {
-    return false;
+  MessageDef* message_p = itti_alloc_new_message(TASK_HA, AGW_OFFLOAD_REQ);
+  if (message_p == NULL) {
+    OAILOG_ERROR(LOG_UTIL, "Failed to allocate AGW_OFFLOAD_REQ for eNB ID %d",
+                 offload_req->eNB_id);
+    return;
   }
-
-  offload_type_t enb_offtype = offload_request->enb_offload_type;
-  // When a UE is in ECM_CONNECTED state, we can direcly start offloading.
-  // For a UE in ECM_IDLE mode however, we need to first page the user and
-  // then we can offload it.
-  if ((ue_context_p->ecm_state == ECM_CONNECTED) &&
-      ((enb_offtype == ALL) || (enb_offtype == ANY) ||
-       (enb_offtype == ANY_CONNECTED))) {
-    MessageDef* message_p =
-        itti_alloc_new_message(TASK_HA, S1AP_UE_CONTEXT_RELEASE_REQ);
-    S1AP_UE_CONTEXT_RELEASE_REQ(message_p).mme_ue_s1ap_id =
-        ue_context_p->mme_ue_s1ap_id;
-    S1AP_UE_CONTEXT_RELEASE_REQ(message_p).enb_ue_s1ap_id =
-        ue_context_p->enb_ue_s1ap_id;
-    S1AP_UE_CONTEXT_RELEASE_REQ(message_p).enb_id = enb_ref_p->enb_id;
-    S1AP_UE_CONTEXT_RELEASE_REQ(message_p).relCause = S1AP_NAS_MME_OFFLOADING;
-
-    OAILOG_INFO(
-        LOG_UTIL,
-        "Processing IMSI64: " IMSI_64_FMT
-        " Requested IMSI: %s, MME UE ID: " MME_UE_S1AP_ID_FMT
-        ", ENB UE ID: " ENB_UE_S1AP_ID_FMT
-        " , UE Context ENB ID: %d, UE Context cell id: %d, S1AP State ENB ID: "
-        "%d",
-        ue_context_p->emm_context._imsi64, offload_request->imsi,
-        ue_context_p->mme_ue_s1ap_id, ue_context_p->enb_ue_s1ap_id,
-        ue_context_p->e_utran_cgi.cell_identity.enb_id,
-        ue_context_p->e_utran_cgi.cell_identity.cell_id, enb_ref_p->enb_id);
-    OAILOG_INFO(LOG_UTIL, "UE Context Release procedure initiated for IMSI%s",
-                offload_request->imsi);
-    IMSI_STRING_TO_IMSI64(offload_request->imsi,
-                          &message_p->ittiMsgHeader.imsi);
-    send_msg_to_task(&ha_task_zmq_ctx, TASK_MME_APP, message_p);
-    any_flag = true;
-  } else if ((ue_context_p->ecm_state == ECM_IDLE) &&
-             (ue_context_p->mm_state == UE_REGISTERED) &&
-             ((enb_offtype == ALL) || (enb_offtype == ANY) ||
-              (enb_offtype == ANY_IDLE))) {
-    // Upon connection re-establishment, this release cause value will
-    // be checked and cleared by MME APP to send offload request.
-    ue_context_p->ue_context_rel_cause = S1AP_NAS_MME_PENDING_OFFLOADING;
-
-    char imsi[IMSI_BCD_DIGITS_MAX + 1] = {0};
-    IMSI64_TO_STRING(ue_context_p->emm_context._imsi64, imsi,
-                     ue_context_p->emm_context._imsi.length);
-
-    OAILOG_INFO(LOG_UTIL, "Paging procedure initiated for IMSI%s", imsi);
-    MessageDef* message_p = NULL;
-    itti_s11_paging_request_t* paging_request_p = NULL;
-
-    message_p = itti_alloc_new_message(TASK_HA, S11_PAGING_REQUEST);
-    paging_request_p = &message_p->ittiMsg.s11_paging_request;
-    memset((void*)paging_request_p, 0, sizeof(itti_s11_paging_request_t));
-    paging_request_p->imsi = strdup(imsi);
-    message_p->ittiMsgHeader.imsi = ue_context_p->emm_context._imsi64;
-    send_msg_to_task(&ha_task_zmq_ctx, TASK_MME_APP, message_p);
-    any_flag = true;
-  }
-
-  // Check if iterations should be stopped as single match was
-  // sufficient.
-  if (any_flag && ((enb_offtype == ANY) || (enb_offtype == ANY_CONNECTED) ||
-                   (enb_offtype == ANY_IDLE))) {
-    return true;
+  AGW_OFFLOAD_REQ(message_p) = *offload_req;
+  if (offload_req->imsi_length > 0) {
+    IMSI_STRING_TO_IMSI64(offload_req->imsi, &message_p->ittiMsgHeader.imsi);
   }
-  return false;
+  send_msg_to_task(&ha_task_zmq_ctx, TASK_MME_APP, message_p);
 }
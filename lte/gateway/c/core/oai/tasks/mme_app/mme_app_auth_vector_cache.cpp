@@ -0,0 +1,303 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_auth_vector_cache.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <unordered_map>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/log.h"
+#include "lte/gateway/c/core/oai/lib/3gpp/3gpp_33.401.h"
+}
+#include "orc8r/gateway/c/common/service303/includes/MetricsHelpers.h"
+
+namespace {
+
+struct CachedVector {
+  eutran_vector_t vector;
+  uint64_t expiry_sec;
+};
+
+struct Entry {
+  std::deque<CachedVector> stock;  // In the order the HSS generated them
+  uint8_t imsi_length;
+  plmn_t visited_plmn;
+  // Sequence number of the prefetch AIR in flight, 0 if none
+  uint64_t prefetch_seq;
+  // The AIR in flight was sent before the stock was last flushed, its
+  // vectors may be older than the ones the UE got since
+  bool drop_prefetch;
+  // Queued for a prefetch that max_prefetch_in_flight holds back
+  bool waiting;
+  std::list<imsi64_t>::iterator lru_it;
+};
+
+struct InFlight {
+  imsi64_t imsi64;
+  uint64_t seq;
+  uint64_t deadline_sec;
+};
+
+mme_app_auth_vector_cache_config_t config = {0};
+std::unordered_map<imsi64_t, Entry> entries;
+std::list<imsi64_t> lru;  // Most recently used first
+// IMSIs waiting for a prefetch; an IMSI evicted or served meanwhile is
+// skipped when its turn comes
+std::deque<imsi64_t> waiting;
+// Prefetch AIRs in the order they were sent, hence of their deadlines
+std::deque<InFlight> in_flight;
+uint32_t num_in_flight = 0;
+uint32_t num_vectors = 0;
+uint64_t last_seq = 0;
+
+bool is_enabled(void) { return config.max_imsis && config.max_vectors; }
+
+void report_vectors(void) {
+  set_gauge("mme_auth_vector_cache_vectors", num_vectors, NO_LABELS);
+}
+
+void count_prefetch(const char* result) {
+  increment_counter("mme_auth_vector_prefetch", 1, 1, "result", result);
+}
+
+void drop_stock(Entry& entry) {
+  num_vectors -= entry.stock.size();
+  entry.stock.clear();
+  if (entry.prefetch_seq) entry.drop_prefetch = true;
+}
+
+void expire_stock(Entry& entry, uint64_t now_sec) {
+  while (!entry.stock.empty() && entry.stock.front().expiry_sec <= now_sec) {
+    entry.stock.pop_front();
+    num_vectors--;
+  }
+}
+
+void evict(std::unordered_map<imsi64_t, Entry>::iterator it) {
+  Entry& entry = it->second;
+  num_vectors -= entry.stock.size();
+  // Its answer, if it ever comes, is not expected anymore
+  if (entry.prefetch_seq) num_in_flight--;
+  lru.erase(entry.lru_it);
+  entries.erase(it);
+}
+
+Entry& get_or_create_entry(imsi64_t imsi64) {
+  auto it = entries.find(imsi64);
+  if (it != entries.end()) {
+    lru.splice(lru.begin(), lru, it->second.lru_it);
+    return it->second;
+  }
+  if (entries.size() >= config.max_imsis) {
+    evict(entries.find(lru.back()));
+  }
+  Entry& entry = entries[imsi64];
+  entry.prefetch_seq = 0;
+  entry.drop_prefetch = false;
+  entry.waiting = false;
+  lru.push_front(imsi64);
+  entry.lru_it = lru.begin();
+  return entry;
+}
+
+void request_refill(imsi64_t imsi64, Entry& entry) {
+  if (entry.prefetch_seq || entry.waiting) return;
+  entry.waiting = true;
+  waiting.push_back(imsi64);
+}
+
+void send_prefetch(imsi64_t imsi64, Entry& entry, uint64_t now_sec) {
+  if (entry.stock.size() >= config.max_vectors) return;
+  mme_app_auth_vector_request_t request = {0};
+  request.imsi64 = imsi64;
+  request.imsi_length = entry.imsi_length;
+  request.visited_plmn = entry.visited_plmn;
+  // An AIA carries at most MAX_EPS_AUTH_VECTORS vectors
+  request.nb_of_vectors = std::min<uint32_t>(
+      config.max_vectors - entry.stock.size(), MAX_EPS_AUTH_VECTORS);
+  request.seq = ++last_seq;
+  if (!config.request_cb(&request)) {
+    count_prefetch("send_failure");
+    return;
+  }
+  entry.prefetch_seq = request.seq;
+  entry.drop_prefetch = false;
+  num_in_flight++;
+  in_flight.push_back(
+      {imsi64, entry.prefetch_seq, now_sec + config.prefetch_timeout_sec});
+  count_prefetch("sent");
+}
+
+void dispatch_waiting(uint64_t now_sec) {
+  while (num_in_flight < config.max_prefetch_in_flight && !waiting.empty()) {
+    imsi64_t imsi64 = waiting.front();
+    waiting.pop_front();
+    auto it = entries.find(imsi64);
+    if (it == entries.end() || !it->second.waiting) continue;
+    it->second.waiting = false;
+    send_prefetch(imsi64, it->second, now_sec);
+  }
+}
+
+}  // namespace
+
+void mme_app_auth_vector_cache_init(
+    const mme_app_auth_vector_cache_config_t* cfg) {
+  mme_app_auth_vector_cache_exit();
+  config = *cfg;
+  if (config.low_watermark > config.max_vectors) {
+    config.low_watermark = config.max_vectors;
+  }
+  report_vectors();
+}
+
+void mme_app_auth_vector_cache_exit(void) {
+  entries.clear();
+  lru.clear();
+  waiting.clear();
+  in_flight.clear();
+  num_in_flight = 0;
+  num_vectors = 0;
+}
+
+bool mme_app_auth_vector_cache_take(imsi64_t imsi64, uint64_t now_sec,
+                                    eutran_vector_t* vector) {
+  if (!is_enabled()) return false;
+  auto it = entries.find(imsi64);
+  if (it != entries.end()) {
+    Entry& entry = it->second;
+    lru.splice(lru.begin(), lru, entry.lru_it);
+    expire_stock(entry, now_sec);
+    if (!entry.stock.empty()) {
+      *vector = entry.stock.front().vector;
+      entry.stock.pop_front();
+      num_vectors--;
+      if (entry.stock.size() < config.low_watermark) {
+        request_refill(imsi64, entry);
+        dispatch_waiting(now_sec);
+      }
+      increment_counter("mme_auth_vector_cache", 1, 1, "result", "hit");
+      report_vectors();
+      return true;
+    }
+  }
+  increment_counter("mme_auth_vector_cache", 1, 1, "result", "miss");
+  report_vectors();
+  return false;
+}
+
+void mme_app_auth_vector_cache_fresh_vectors(imsi64_t imsi64,
+                                             uint8_t imsi_length,
+                                             const plmn_t* visited_plmn,
+                                             uint64_t now_sec) {
+  if (!is_enabled()) return;
+  Entry& entry = get_or_create_entry(imsi64);
+  entry.imsi_length = imsi_length;
+  entry.visited_plmn = *visited_plmn;
+  drop_stock(entry);
+  request_refill(imsi64, entry);
+  dispatch_waiting(now_sec);
+  report_vectors();
+}
+
+void mme_app_auth_vector_cache_flush(imsi64_t imsi64) {
+  auto it = entries.find(imsi64);
+  if (it == entries.end()) return;
+  drop_stock(it->second);
+  report_vectors();
+}
+
+void mme_app_auth_vector_cache_prefetch_answer(imsi64_t imsi64, uint64_t seq,
+                                               uint8_t nb_of_vectors,
+                                               const eutran_vector_t* vectors,
+                                               uint64_t now_sec) {
+  auto it = entries.find(imsi64);
+  if (it == entries.end() || it->second.prefetch_seq != seq) {
+    // Evicted or timed out meanwhile, possibly with a newer AIR in flight
+    count_prefetch("unexpected");
+    return;
+  }
+  Entry& entry = it->second;
+  entry.prefetch_seq = 0;
+  num_in_flight--;
+
+  if (entry.drop_prefetch) {
+    entry.drop_prefetch = false;
+    count_prefetch("dropped");
+    request_refill(imsi64, entry);
+  } else if (!nb_of_vectors) {
+    // Not retried before the next fresh vectors, a failing HSS is not
+    // hammered with prefetches
+    OAILOG_WARNING(LOG_MME_APP,
+                   "Authentication vector prefetch failed for IMSI " IMSI_64_FMT
+                   "\n",
+                   imsi64);
+    count_prefetch("failure");
+  } else {
+    expire_stock(entry, now_sec);
+    for (uint8_t i = 0;
+         i < nb_of_vectors && entry.stock.size() < config.max_vectors; i++) {
+      entry.stock.push_back({vectors[i], now_sec + config.ttl_sec});
+      num_vectors++;
+    }
+    count_prefetch("success");
+    if (entry.stock.size() < config.max_vectors) {
+      request_refill(imsi64, entry);
+    }
+  }
+  dispatch_waiting(now_sec);
+  report_vectors();
+}
+
+void mme_app_auth_vector_cache_tick(uint64_t now_sec) {
+  while (!in_flight.empty() && in_flight.front().deadline_sec <= now_sec) {
+    InFlight lost = in_flight.front();
+    in_flight.pop_front();
+    auto it = entries.find(lost.imsi64);
+    if (it == entries.end() || it->second.prefetch_seq != lost.seq) continue;
+    it->second.prefetch_seq = 0;
+    it->second.drop_prefetch = false;
+    num_in_flight--;
+    count_prefetch("timeout");
+  }
+  dispatch_waiting(now_sec);
+}
+
+uint32_t mme_app_auth_vector_cache_stock(imsi64_t imsi64, uint64_t now_sec) {
+  auto it = entries.find(imsi64);
+  if (it == entries.end()) return 0;
+  expire_stock(it->second, now_sec);
+  return it->second.stock.size();
+}
+
+void mme_app_auth_vector_cache_get_stats(
+    mme_app_auth_vector_cache_stats_t* stats) {
+  stats->imsis = entries.size();
+  stats->vectors = num_vectors;
+  stats->prefetch_in_flight = num_in_flight;
+  stats->prefetch_waiting = 0;
+  for (const auto& entry : entries) {
+    if (entry.second.waiting) stats->prefetch_waiting++;
+  }
+}
+
+uint64_t mme_app_auth_vector_cache_now_sec(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec;
+}
@@ -0,0 +1,132 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*! \file mme_app_auth_vector_cache.h
+  \brief MME wide cache of EPS authentication vectors, keyed by IMSI.
+
+  The vectors fetched for a UE live in its EMM context and are lost with
+  it, so every re-attach waits for an S6a AIR round trip. This cache keeps
+  a small stock of vectors per IMSI outside of the UE contexts. Once an
+  IMSI got vectors from the HSS for its own authentication, the cache tops
+  up its stock with prefetch AIRs in the background, and the next
+  authentication of that IMSI takes a vector from the stock instead of
+  sending an AIR.
+
+  A vector is handed out at most once, in the order the HSS generated it:
+  prefetch AIRs of an IMSI are sent one at a time and the stock is taken
+  FIFO. Whenever the HSS generates vectors outside of the cache (a cache
+  miss, an SQN re-synchronisation) the stock of the IMSI is flushed, and an
+  answer to a prefetch sent before that is dropped, so that the cache never
+  hands out a vector older than one the UE has already seen. Vectors expire
+  after a TTL and the number of IMSIs is bounded, least recently used ones
+  are evicted first.
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lte/gateway/c/core/oai/common/common_types.h"
+#include "lte/gateway/c/core/oai/common/security_types.h"
+
+typedef struct mme_app_auth_vector_request_s {
+  imsi64_t imsi64;
+  uint8_t imsi_length;  // Number of digits, imsi64 loses leading zeros
+  plmn_t visited_plmn;
+  uint8_t nb_of_vectors;
+  uint64_t seq;  // Tag the answer must carry back, never 0
+} mme_app_auth_vector_request_t;
+
+/*
+ * Sends a prefetch AIR, whose answer must be passed to
+ * mme_app_auth_vector_cache_prefetch_answer. Returns false if it could not
+ * be sent.
+ */
+typedef bool (*mme_app_auth_vector_request_cb_t)(
+    const mme_app_auth_vector_request_t* request);
+
+typedef struct mme_app_auth_vector_cache_config_s {
+  uint32_t max_imsis;
+  uint32_t max_vectors;    // Stock a refill tops an IMSI up to
+  uint32_t low_watermark;  // A refill starts when the stock falls below
+  uint32_t ttl_sec;
+  uint32_t max_prefetch_in_flight;  // Over all IMSIs
+  uint32_t prefetch_timeout_sec;
+  mme_app_auth_vector_request_cb_t request_cb;
+} mme_app_auth_vector_cache_config_t;
+
+typedef struct mme_app_auth_vector_cache_stats_s {
+  uint32_t imsis;
+  uint32_t vectors;
+  uint32_t prefetch_in_flight;
+  uint32_t prefetch_waiting;
+} mme_app_auth_vector_cache_stats_t;
+
+/* A max_imsis or max_vectors of 0 disables the cache */
+void mme_app_auth_vector_cache_init(
+    const mme_app_auth_vector_cache_config_t* config);
+void mme_app_auth_vector_cache_exit(void);
+
+/*
+ * Takes the oldest unexpired vector of imsi64 out of the cache. Returns
+ * false on a miss, in which case the caller fetches vectors from the HSS
+ * and reports them with mme_app_auth_vector_cache_fresh_vectors.
+ */
+bool mme_app_auth_vector_cache_take(imsi64_t imsi64, uint64_t now_sec,
+                                    eutran_vector_t* vector);
+
+/*
+ * The HSS answered an AIR sent for a UE of imsi64: the stock is flushed and
+ * a refill is started.
+ */
+void mme_app_auth_vector_cache_fresh_vectors(imsi64_t imsi64,
+                                             uint8_t imsi_length,
+                                             const plmn_t* visited_plmn,
+                                             uint64_t now_sec);
+
+/* Drops the stock of imsi64, e.g. when its USIM reports an SQN failure */
+void mme_app_auth_vector_cache_flush(imsi64_t imsi64);
+
+/*
+ * Answer to the prefetch AIR tagged seq, nb_of_vectors is 0 if the AIR
+ * failed. An answer to an AIR that timed out or was sent before imsi64 got
+ * evicted is dropped.
+ */
+void mme_app_auth_vector_cache_prefetch_answer(imsi64_t imsi64, uint64_t seq,
+                                               uint8_t nb_of_vectors,
+                                               const eutran_vector_t* vectors,
+                                               uint64_t now_sec);
+
+/*
+ * Called periodically: expires lost prefetch AIRs and sends the waiting
+ * ones that max_prefetch_in_flight held back.
+ */
+void mme_app_auth_vector_cache_tick(uint64_t now_sec);
+
+/* Number of unexpired vectors of imsi64 */
+uint32_t mme_app_auth_vector_cache_stock(imsi64_t imsi64, uint64_t now_sec);
+
+void mme_app_auth_vector_cache_get_stats(
+    mme_app_auth_vector_cache_stats_t* stats);
+
+/* Monotonic clock the MME passes as now_sec */
+uint64_t mme_app_auth_vector_cache_now_sec(void);
+
+#ifdef __cplusplus
+}
+#endif
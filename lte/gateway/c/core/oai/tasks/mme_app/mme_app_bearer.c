@@ -73,6 +73,7 @@
 #include "lte/gateway/c/core/oai/tasks/nas/esm/esm_proc.h"
 #include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_timer.h"
 #include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_pdn_context.h"
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_enb_ue_index.h"
 #include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_ip_imsi.h"
 
 #if EMBEDDED_SGW
@@ -711,6 +712,8 @@ imsi64_t mme_app_handle_initial_ue_message(
     }
   }
   ue_context_p->sctp_assoc_id_key = initial_pP->sctp_assoc_id;
+  mme_app_enb_ue_index_update(ue_context_p->mme_ue_s1ap_id,
+                              initial_pP->enb_id);
   ue_context_p->e_utran_cgi = initial_pP->ecgi;
   // Notify S1AP about the mapping between mme_ue_s1ap_id and
   // sctp assoc id + enb_ue_s1ap_id
@@ -3588,6 +3591,8 @@ void mme_app_handle_handover_notify(
 
   // Update sctp assoc id and ecgi
   ue_context_p->sctp_assoc_id_key = handover_notify_p->target_sctp_assoc_id;
+  mme_app_enb_ue_index_update(ue_context_p->mme_ue_s1ap_id,
+                              handover_notify_p->target_enb_id);
   ue_context_p->e_utran_cgi = handover_notify_p->ecgi;
 
   // generate the Modify Bearer Request
@@ -3738,6 +3743,8 @@ void mme_app_handle_path_switch_request(
         ue_context_p->mme_teid_s11, &ue_context_p->emm_context._guti);
   }
   ue_context_p->sctp_assoc_id_key = path_switch_req_p->sctp_assoc_id;
+  mme_app_enb_ue_index_update(ue_context_p->mme_ue_s1ap_id,
+                              path_switch_req_p->enb_id);
   ue_context_p->e_utran_cgi = path_switch_req_p->ecgi;
 
   /* Security capabilities IE within s1ap message, Path Switch Request is of
@@ -0,0 +1,166 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_bulk_release.h"
+
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/log.h"
+#include "lte/gateway/c/core/oai/include/service303.h"
+}
+#include "orc8r/gateway/c/common/service303/includes/MetricsHelpers.h"
+
+namespace {
+
+mme_app_bulk_release_config_t config = {0};
+std::deque<mme_app_bulk_item_t> queue;
+std::unordered_set<mme_ue_s1ap_id_t> queued_ues;
+// Progress of the current batch of each eNB with pending items
+std::unordered_map<uint32_t, mme_app_bulk_progress_t> progress_by_enb;
+// Operations per second are rarely a multiple of the ticks per second, the
+// remainder is carried over in thousandths of an operation
+uint64_t credit_milli_ops = 0;
+
+void report_pending(void) {
+  set_gauge("mme_bulk_release_pending", queue.size(), NO_LABELS);
+}
+
+void log_progress(uint32_t enb_id, const mme_app_bulk_progress_t& progress,
+                  bool done) {
+  if (done) {
+    OAILOG_INFO(LOG_MME_APP,
+                "Bulk release for eNB %u done: %u queued, %u dispatched, %u "
+                "skipped, %u cancelled\n",
+                enb_id, progress.queued, progress.dispatched, progress.skipped,
+                progress.cancelled);
+  } else {
+    OAILOG_INFO(LOG_MME_APP, "Bulk release for eNB %u: %u of %u dispatched\n",
+                enb_id, progress.dispatched + progress.skipped,
+                progress.queued);
+  }
+}
+
+void account(const mme_app_bulk_item_t& item, bool dispatched) {
+  auto it = progress_by_enb.find(item.enb_id);
+  if (it == progress_by_enb.end()) return;
+  mme_app_bulk_progress_t& progress = it->second;
+  if (dispatched) {
+    progress.dispatched++;
+  } else {
+    progress.skipped++;
+  }
+  uint32_t done = progress.dispatched + progress.skipped + progress.cancelled;
+  if (done == progress.queued) {
+    log_progress(item.enb_id, progress, true);
+    progress_by_enb.erase(it);
+  } else if (done % 1000 == 0) {
+    log_progress(item.enb_id, progress, false);
+  }
+}
+
+}  // namespace
+
+void mme_app_bulk_release_init(const mme_app_bulk_release_config_t* cfg) {
+  mme_app_bulk_release_exit();
+  config = *cfg;
+  report_pending();
+}
+
+void mme_app_bulk_release_exit(void) {
+  queue.clear();
+  queued_ues.clear();
+  progress_by_enb.clear();
+  credit_milli_ops = 0;
+}
+
+bool mme_app_bulk_release_enqueue(const mme_app_bulk_item_t* item) {
+  if (!queued_ues.insert(item->mme_ue_s1ap_id).second) {
+    return false;
+  }
+  queue.push_back(*item);
+  progress_by_enb[item->enb_id].queued++;
+  report_pending();
+  return true;
+}
+
+uint32_t mme_app_bulk_release_cancel(uint32_t enb_id) {
+  auto progress_it = progress_by_enb.find(enb_id);
+  if (progress_it == progress_by_enb.end()) return 0;
+
+  uint32_t num_cancelled = 0;
+  for (auto it = queue.begin(); it != queue.end();) {
+    if (it->enb_id == enb_id) {
+      queued_ues.erase(it->mme_ue_s1ap_id);
+      it = queue.erase(it);
+      num_cancelled++;
+    } else {
+      ++it;
+    }
+  }
+  progress_it->second.cancelled += num_cancelled;
+  log_progress(enb_id, progress_it->second, true);
+  progress_by_enb.erase(progress_it);
+  increment_counter("mme_bulk_release_cancelled", num_cancelled, NO_LABELS);
+  report_pending();
+  return num_cancelled;
+}
+
+uint32_t mme_app_bulk_release_tick(void) {
+  if (queue.empty()) {
+    // Credit does not accumulate while idle, a new batch starts at the
+    // configured rate rather than with a burst
+    credit_milli_ops = 0;
+    return 0;
+  }
+  credit_milli_ops += (uint64_t)config.ops_per_sec * config.tick_ms;
+  uint32_t num_done = 0;
+  while (credit_milli_ops >= 1000 && !queue.empty()) {
+    credit_milli_ops -= 1000;
+    mme_app_bulk_item_t item = queue.front();
+    queue.pop_front();
+    queued_ues.erase(item.mme_ue_s1ap_id);
+    bool dispatched = config.dispatch_cb(&item);
+    increment_counter("mme_bulk_release", 1, 2, "op",
+                      mme_app_bulk_op_str(item.op), "result",
+                      dispatched ? "dispatched" : "skipped");
+    account(item, dispatched);
+    num_done++;
+  }
+  if (queue.empty()) credit_milli_ops = 0;
+  report_pending();
+  return num_done;
+}
+
+uint32_t mme_app_bulk_release_pending(void) { return queue.size(); }
+
+bool mme_app_bulk_release_get_progress(uint32_t enb_id,
+                                       mme_app_bulk_progress_t* progress) {
+  auto it = progress_by_enb.find(enb_id);
+  if (it == progress_by_enb.end()) return false;
+  *progress = it->second;
+  return true;
+}
+
+const char* mme_app_bulk_op_str(mme_app_bulk_op_t op) {
+  switch (op) {
+    case MME_APP_BULK_OP_RELEASE:
+      return "release";
+    case MME_APP_BULK_OP_PAGE:
+      return "page";
+    default:
+      return "unknown";
+  }
+}
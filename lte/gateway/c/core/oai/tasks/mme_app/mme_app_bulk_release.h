@@ -0,0 +1,102 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*! \file mme_app_bulk_release.h
+  \brief Paced UE context releases and pages for whole-eNB operations.
+
+  HA offload of an eNB and S1 Reset of all UE associations of an eNB act on
+  every UE of that eNB. Instead of releasing or paging them all in the
+  handler, they are queued here and dispatched from a periodic MME_APP
+  timer at a configured number of operations per second, so that the MME
+  task keeps serving other messages and neither the eNB nor the SGW gets
+  thousands of messages at once. Items are dispatched in FIFO order, a UE
+  is queued at most once, and the pending items of an eNB can be
+  cancelled. Progress is tracked per eNB.
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lte/gateway/c/core/oai/common/common_types.h"
+#include "lte/gateway/c/core/oai/include/s1ap_messages_types.h"
+#include "lte/gateway/c/core/oai/lib/3gpp/3gpp_36.401.h"
+
+typedef enum {
+  MME_APP_BULK_OP_RELEASE = 0,
+  MME_APP_BULK_OP_PAGE,
+  MME_APP_BULK_OP_MAX
+} mme_app_bulk_op_t;
+
+typedef struct mme_app_bulk_item_s {
+  uint32_t enb_id;
+  mme_ue_s1ap_id_t mme_ue_s1ap_id;
+  enb_ue_s1ap_id_t enb_ue_s1ap_id;
+  mme_app_bulk_op_t op;
+  enum s1cause cause;
+} mme_app_bulk_item_t;
+
+/*
+ * Performs one queued operation. Returns false if the operation no longer
+ * applies to the UE (e.g. the UE context is gone or moved), which is
+ * accounted as skipped.
+ */
+typedef bool (*mme_app_bulk_dispatch_cb_t)(const mme_app_bulk_item_t* item);
+
+typedef struct mme_app_bulk_release_config_s {
+  uint32_t ops_per_sec;
+  uint32_t tick_ms;  // Period at which mme_app_bulk_release_tick is called
+  mme_app_bulk_dispatch_cb_t dispatch_cb;
+} mme_app_bulk_release_config_t;
+
+typedef struct mme_app_bulk_progress_s {
+  uint32_t queued;
+  uint32_t dispatched;
+  uint32_t skipped;
+  uint32_t cancelled;
+} mme_app_bulk_progress_t;
+
+void mme_app_bulk_release_init(const mme_app_bulk_release_config_t* config);
+void mme_app_bulk_release_exit(void);
+
+/* Returns false if the UE of item is already queued */
+bool mme_app_bulk_release_enqueue(const mme_app_bulk_item_t* item);
+
+/* Drops the pending items of enb_id and returns how many were dropped */
+uint32_t mme_app_bulk_release_cancel(uint32_t enb_id);
+
+/*
+ * Dispatches the items whose turn came in the last tick_ms and returns the
+ * number of items dispatched or skipped.
+ */
+uint32_t mme_app_bulk_release_tick(void);
+
+uint32_t mme_app_bulk_release_pending(void);
+
+/*
+ * Fills progress for the current batch of enb_id, i.e. the items queued
+ * since the eNB last had no pending item. Returns false if there is none.
+ */
+bool mme_app_bulk_release_get_progress(uint32_t enb_id,
+                                       mme_app_bulk_progress_t* progress);
+
+const char* mme_app_bulk_op_str(mme_app_bulk_op_t op);
+
+#ifdef __cplusplus
+}
+#endif
@@ -48,6 +48,7 @@
 #include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_bearer_context.h"
 #include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_pdn_context.h"
 #include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_defs.h"
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_enb_ue_index.h"
 #include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_itti_messaging.h"
 #include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_procedures.h"
 #include "lte/gateway/c/core/oai/tasks/nas/nas_proc.h"
@@ -445,6 +446,8 @@ void mme_ue_context_update_coll_keys(
                         ue_context_p->mme_ue_s1ap_id,
                         hashtable_rc_code2string(h_rc));
       }
+      mme_app_enb_ue_index_rename(ue_context_p->mme_ue_s1ap_id,
+                                  mme_ue_s1ap_id);
       ue_context_p->mme_ue_s1ap_id = mme_ue_s1ap_id;
     }
   } else {
@@ -799,6 +802,7 @@ void mme_remove_ue_context(mme_ue_context_t* const mme_ue_context_p,
   }
   // filled NAS UE ID/ MME UE S1AP ID
   if (INVALID_MME_UE_S1AP_ID != ue_context_p->mme_ue_s1ap_id) {
+    mme_app_enb_ue_index_remove(ue_context_p->mme_ue_s1ap_id);
     hash_rc = hashtable_ts_remove(
         mme_state_ue_id_ht, (const hash_key_t)ue_context_p->mme_ue_s1ap_id,
         (void**)&ue_context_p);
@@ -1035,6 +1039,8 @@ void mme_app_handle_s1ap_ue_context_modification_resp(
 //------------------------------------------------------------------------------
 void mme_app_handle_enb_deregister_ind(
     const itti_s1ap_eNB_deregistered_ind_t* const eNB_deregistered_ind) {
+  // Releases and pages still queued for the eNB are moot once it is gone
+  mme_app_bulk_release_cancel(eNB_deregistered_ind->enb_id);
   for (int i = 0; i < eNB_deregistered_ind->nb_ue_to_deregister; i++) {
     mme_app_handle_s1ap_ue_context_release(
         eNB_deregistered_ind->mme_ue_s1ap_id[i],
@@ -1058,11 +1064,36 @@ void mme_app_handle_enb_reset_req(
     OAILOG_FUNC_OUT(LOG_MME_APP);
   }
 
-  for (int i = 0; i < enb_reset_req->num_ue; i++) {
-    mme_app_handle_s1ap_ue_context_release(
-        enb_reset_req->ue_to_reset_list[i].mme_ue_s1ap_id,
-        enb_reset_req->ue_to_reset_list[i].enb_ue_s1ap_id,
-        enb_reset_req->enb_id, S1AP_SCTP_SHUTDOWN_OR_RESET);
+  if (enb_reset_req->s1ap_reset_type == RESET_ALL) {
+    /* The eNB already dropped its side of every UE association, so the Reset
+     * Acknowledge does not wait for the MME side releases, which are paced
+     * towards the SGW. A full reset supersedes whatever was queued for the
+     * eNB.
+     */
+    mme_app_bulk_release_cancel(enb_reset_req->enb_id);
+    for (int i = 0; i < enb_reset_req->num_ue; i++) {
+      mme_app_bulk_item_t item = {0};
+      item.enb_id = enb_reset_req->enb_id;
+      item.mme_ue_s1ap_id = enb_reset_req->ue_to_reset_list[i].mme_ue_s1ap_id;
+      item.enb_ue_s1ap_id = enb_reset_req->ue_to_reset_list[i].enb_ue_s1ap_id;
+      item.op = MME_APP_BULK_OP_RELEASE;
+      item.cause = S1AP_SCTP_SHUTDOWN_OR_RESET;
+      // UEs without mme_ue_s1ap_id can only be found by their eNB key, which
+      // the eNB may reuse any time after the Reset Acknowledge
+      if (item.mme_ue_s1ap_id == INVALID_MME_UE_S1AP_ID) {
+        mme_app_handle_s1ap_ue_context_release(
+            item.mme_ue_s1ap_id, item.enb_ue_s1ap_id, item.enb_id, item.cause);
+      } else {
+        mme_app_bulk_release_enqueue(&item);
+      }
+    }
+  } else {
+    for (int i = 0; i < enb_reset_req->num_ue; i++) {
+      mme_app_handle_s1ap_ue_context_release(
+          enb_reset_req->ue_to_reset_list[i].mme_ue_s1ap_id,
+          enb_reset_req->ue_to_reset_list[i].enb_ue_s1ap_id,
+          enb_reset_req->enb_id, S1AP_SCTP_SHUTDOWN_OR_RESET);
+    }
   }
 
   // Send Reset Ack to S1AP module
@@ -1086,6 +1117,171 @@ void mme_app_handle_enb_reset_req(
   OAILOG_FUNC_OUT(LOG_MME_APP);
 }
 
+//------------------------------------------------------------------------------
+bool mme_app_handle_bulk_release_item(const mme_app_bulk_item_t* item) {
+  OAILOG_FUNC_IN(LOG_MME_APP);
+  ue_mm_context_t* ue_context_p =
+      mme_ue_context_exists_mme_ue_s1ap_id(item->mme_ue_s1ap_id);
+  if (!ue_context_p) {
+    OAILOG_DEBUG(LOG_MME_APP,
+                 "Skipping queued %s, UE context " MME_UE_S1AP_ID_FMT
+                 " no longer exists\n",
+                 mme_app_bulk_op_str(item->op), item->mme_ue_s1ap_id);
+    OAILOG_FUNC_RETURN(LOG_MME_APP, false);
+  }
+
+  switch (item->op) {
+    case MME_APP_BULK_OP_RELEASE:
+      // The UE may have come back on a new S1 connection since it was queued
+      if ((ue_context_p->enb_ue_s1ap_id != item->enb_ue_s1ap_id) ||
+          ((item->cause == S1AP_NAS_MME_OFFLOADING) &&
+           (ue_context_p->ecm_state != ECM_CONNECTED))) {
+        OAILOG_FUNC_RETURN(LOG_MME_APP, false);
+      }
+      imsi64_t imsi64 = ue_context_p->emm_context._imsi64;
+      mme_app_handle_s1ap_ue_context_release(
+          item->mme_ue_s1ap_id, item->enb_ue_s1ap_id, item->enb_id,
+          item->cause);
+      // Dispatched from a timer, outside of the per message state write. The
+      // UE context is looked up again by IMSI as the release may free it.
+      put_mme_ue_state(get_mme_nas_state(false), imsi64, false);
+      OAILOG_FUNC_RETURN(LOG_MME_APP, true);
+    case MME_APP_BULK_OP_PAGE:
+      if ((ue_context_p->ecm_state != ECM_IDLE) ||
+          (ue_context_p->mm_state != UE_REGISTERED)) {
+        OAILOG_FUNC_RETURN(LOG_MME_APP, false);
+      }
+      // Upon connection re-establishment, this release cause value will
+      // be checked and cleared by MME APP to send offload request.
+      ue_context_p->ue_context_rel_cause = item->cause;
+      if ((!ue_context_p->paging_retx_count) &&
+          (mme_app_paging_request_helper(ue_context_p, true, true /* s-tmsi */,
+                                         CN_DOMAIN_PS) != RETURNok)) {
+        OAILOG_ERROR_UE(LOG_MME_APP, ue_context_p->emm_context._imsi64,
+                        "Failed to send paging request to S1AP \n");
+      }
+      // Dispatched from a timer, outside of the per message state write
+      put_mme_ue_state(get_mme_nas_state(false),
+                       ue_context_p->emm_context._imsi64, false);
+      OAILOG_FUNC_RETURN(LOG_MME_APP, true);
+    default:
+      OAILOG_FUNC_RETURN(LOG_MME_APP, false);
+  }
+}
+
+//------------------------------------------------------------------------------
+/* Fills item with the offload action that applies to ue_context_p, if any.
+ * When a UE is in ECM_CONNECTED state, we can directly start offloading.
+ * For a UE in ECM_IDLE mode however, we need to first page the user and
+ * then we can offload it.
+ */
+static bool mme_app_get_offload_item(const ue_mm_context_t* ue_context_p,
+                                     offload_type_t offload_type,
+                                     uint32_t enb_id,
+                                     mme_app_bulk_item_t* item) {
+  memset(item, 0, sizeof(*item));
+  item->enb_id = enb_id;
+  item->mme_ue_s1ap_id = ue_context_p->mme_ue_s1ap_id;
+  item->enb_ue_s1ap_id = ue_context_p->enb_ue_s1ap_id;
+  if ((ue_context_p->ecm_state == ECM_CONNECTED) &&
+      ((offload_type == ALL) || (offload_type == ANY) ||
+       (offload_type == ANY_CONNECTED))) {
+    item->op = MME_APP_BULK_OP_RELEASE;
+    item->cause = S1AP_NAS_MME_OFFLOADING;
+    return true;
+  }
+  if ((ue_context_p->ecm_state == ECM_IDLE) &&
+      (ue_context_p->mm_state == UE_REGISTERED) &&
+      ((offload_type == ALL) || (offload_type == ANY) ||
+       (offload_type == ANY_IDLE))) {
+    item->op = MME_APP_BULK_OP_PAGE;
+    item->cause = S1AP_NAS_MME_PENDING_OFFLOADING;
+    return true;
+  }
+  return false;
+}
+
+typedef struct mme_app_enb_offload_s {
+  const ha_agw_offload_req_t* request;
+  mme_ue_s1ap_id_t offloaded_ue_id;  // UE already offloaded by IMSI
+  uint32_t num_queued;
+} mme_app_enb_offload_t;
+
+static bool mme_app_offload_enb_ue(mme_ue_s1ap_id_t mme_ue_s1ap_id,
+                                   void* arg) {
+  mme_app_enb_offload_t* offload = (mme_app_enb_offload_t*)arg;
+  offload_type_t offload_type = offload->request->enb_offload_type;
+  mme_app_bulk_item_t item;
+
+  if (mme_ue_s1ap_id == offload->offloaded_ue_id) {
+    return false;
+  }
+  ue_mm_context_t* ue_context_p =
+      mme_ue_context_exists_mme_ue_s1ap_id(mme_ue_s1ap_id);
+  if (!ue_context_p ||
+      !mme_app_get_offload_item(ue_context_p, offload_type,
+                                offload->request->eNB_id, &item)) {
+    return false;
+  }
+  if (offload_type == ALL) {
+    if (mme_app_bulk_release_enqueue(&item)) {
+      offload->num_queued++;
+    }
+    return false;
+  }
+  // A single UE is enough for the other offload types, no need to pace it
+  mme_app_handle_bulk_release_item(&item);
+  offload->offloaded_ue_id = mme_ue_s1ap_id;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void mme_app_handle_agw_offload_req(const ha_agw_offload_req_t* offload_req) {
+  OAILOG_FUNC_IN(LOG_MME_APP);
+  mme_app_desc_t* mme_app_desc_p = get_mme_nas_state(false);
+  mme_app_enb_offload_t offload = {.request = offload_req,
+                                   .offloaded_ue_id = INVALID_MME_UE_S1AP_ID,
+                                   .num_queued = 0};
+  mme_app_bulk_item_t item;
+
+  // The IMSI and eNB id are both filters, a UE matching either is offloaded
+  if (offload_req->imsi_length > 0) {
+    imsi64_t imsi64 = INVALID_IMSI64;
+    IMSI_STRING_TO_IMSI64(offload_req->imsi, &imsi64);
+    ue_mm_context_t* ue_context_p =
+        mme_ue_context_exists_imsi(&mme_app_desc_p->mme_ue_contexts, imsi64);
+    uint32_t enb_id = 0;
+    if (ue_context_p &&
+        (ue_context_p->enb_s1ap_id_key != INVALID_ENB_UE_S1AP_ID_KEY)) {
+      enb_id = (uint32_t)(ue_context_p->enb_s1ap_id_key >> 24);
+    }
+    if (ue_context_p &&
+        mme_app_get_offload_item(ue_context_p, offload_req->enb_offload_type,
+                                 enb_id, &item)) {
+      OAILOG_INFO_UE(LOG_MME_APP, imsi64, "Offloading UE with a %s\n",
+                     mme_app_bulk_op_str(item.op));
+      mme_app_handle_bulk_release_item(&item);
+      offload.offloaded_ue_id = item.mme_ue_s1ap_id;
+      if (offload_req->enb_offload_type != ALL) {
+        OAILOG_FUNC_OUT(LOG_MME_APP);
+      }
+    }
+  }
+
+  if (offload_req->enb_offload_type == ALL) {
+    // The new request replaces the one still being paced for the eNB
+    mme_app_bulk_release_cancel(offload_req->eNB_id);
+  }
+  mme_app_enb_ue_index_foreach(offload_req->eNB_id, mme_app_offload_enb_ue,
+                               &offload);
+  OAILOG_INFO(LOG_MME_APP,
+              "Offload of eNB %u: %u of %u UEs queued, %u pending in total\n",
+              offload_req->eNB_id, offload.num_queued,
+              mme_app_enb_ue_index_num_ues(offload_req->eNB_id),
+              mme_app_bulk_release_pending());
+  OAILOG_FUNC_OUT(LOG_MME_APP);
+}
+
 //------------------------------------------------------------------------------
 /*
    From GPP TS 23.401 version 11.11.0 Release 11, section 5.3.5 S1 release
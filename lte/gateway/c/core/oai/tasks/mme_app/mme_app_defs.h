@@ -32,8 +32,11 @@
 
 #include "lte/gateway/c/core/oai/lib/itti/intertask_interface.h"
 
+#include "lte/gateway/c/core/oai/include/ha_messages_types.h"
 #include "lte/gateway/c/core/oai/include/mme_app_desc.h"
 #include "lte/gateway/c/core/oai/include/mme_app_ue_context.h"
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_auth_vector_cache.h"
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_bulk_release.h"
 #include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_sgs_fsm.h"
 #include "lte/gateway/c/core/oai/tasks/nas/emm/emm_proc.h"
 #include <czmq.h>
@@ -44,12 +47,25 @@
 
 #define MME_APP_ZMQ_LATENCY_CONGEST_TH \
   (mme_congestion_params.mme_app_zmq_congest_th)  // microseconds
-#define MME_APP_ZMQ_LATENCY_AUTH_TH \
-  (mme_congestion_params.mme_app_zmq_auth_th)  // microseconds
-#define MME_APP_ZMQ_LATENCY_IDENT_TH \
-  (mme_congestion_params.mme_app_zmq_ident_th)  // microseconds
-#define MME_APP_ZMQ_LATENCY_SMC_TH \
-  (mme_congestion_params.mme_app_zmq_smc_th)  // microseconds
+
+// Adaptive overload control, see mme_app_overload.h
+#define MME_APP_OVERLOAD_EVAL_PERIOD_MS 100
+#define MME_APP_OVERLOAD_TARGET_DEPTH 1000  // queued ITTI messages
+#define MME_APP_OVERLOAD_MAX_REDUCTION_PERCENT 99
+
+// Pacing of whole-eNB releases and pages, see mme_app_bulk_release.h
+#define MME_APP_BULK_RELEASE_OPS_PER_SEC 500
+#define MME_APP_BULK_RELEASE_TICK_MS 100
+
+// Authentication vectors kept across UE contexts, see
+// mme_app_auth_vector_cache.h
+#define MME_APP_AUTH_VECTOR_CACHE_MAX_IMSIS 100000
+#define MME_APP_AUTH_VECTOR_CACHE_MAX_VECTORS 2
+#define MME_APP_AUTH_VECTOR_CACHE_LOW_WATERMARK 1
+#define MME_APP_AUTH_VECTOR_CACHE_TTL_SEC 86400
+#define MME_APP_AUTH_VECTOR_PREFETCH_MAX_IN_FLIGHT 20
+#define MME_APP_AUTH_VECTOR_PREFETCH_TIMEOUT_SEC 10
+#define MME_APP_AUTH_VECTOR_CACHE_TICK_MS 1000
 
 extern task_zmq_ctx_t mme_app_task_zmq_ctx;
 
@@ -171,6 +187,10 @@ int mme_app_handle_ue_context_modification_timer_expiry(zloop_t* loop,
 void mme_app_handle_enb_reset_req(
     const itti_s1ap_enb_initiated_reset_req_t* enb_reset_req);
 
+bool mme_app_handle_bulk_release_item(const mme_app_bulk_item_t* item);
+
+void mme_app_handle_agw_offload_req(const ha_agw_offload_req_t* offload_req);
+
 imsi64_t mme_app_handle_initial_paging_request(
     mme_app_desc_t* mme_app_desc_p,
     const itti_s11_paging_request_t* paging_req);
@@ -0,0 +1,110 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_enb_ue_index.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/log.h"
+}
+
+namespace {
+
+std::unordered_map<uint32_t, std::unordered_set<mme_ue_s1ap_id_t>> enb_to_ues;
+std::unordered_map<mme_ue_s1ap_id_t, uint32_t> ue_to_enb;
+
+void unlink_ue(mme_ue_s1ap_id_t ue_id, uint32_t enb_id) {
+  auto it = enb_to_ues.find(enb_id);
+  if (it == enb_to_ues.end()) return;
+  it->second.erase(ue_id);
+  if (it->second.empty()) enb_to_ues.erase(it);
+}
+
+bool index_ue(__attribute__((unused)) const hash_key_t key,
+              void* const element, __attribute__((unused)) void* param,
+              __attribute__((unused)) void** result) {
+  const ue_mm_context_t* ue_context = (const ue_mm_context_t*)element;
+  uint32_t enb_id = ue_context->e_utran_cgi.cell_identity.enb_id;
+  if (ue_context->enb_s1ap_id_key != INVALID_ENB_UE_S1AP_ID_KEY) {
+    enb_id = (uint32_t)(ue_context->enb_s1ap_id_key >> 24);
+  }
+  mme_app_enb_ue_index_update(ue_context->mme_ue_s1ap_id, enb_id);
+  return false;
+}
+
+}  // namespace
+
+void mme_app_enb_ue_index_update(mme_ue_s1ap_id_t ue_id, uint32_t enb_id) {
+  if (ue_id == INVALID_MME_UE_S1AP_ID) return;
+  auto it = ue_to_enb.find(ue_id);
+  if (it != ue_to_enb.end()) {
+    if (it->second == enb_id) return;
+    unlink_ue(ue_id, it->second);
+    it->second = enb_id;
+  } else {
+    ue_to_enb.emplace(ue_id, enb_id);
+  }
+  enb_to_ues[enb_id].insert(ue_id);
+}
+
+void mme_app_enb_ue_index_remove(mme_ue_s1ap_id_t ue_id) {
+  auto it = ue_to_enb.find(ue_id);
+  if (it == ue_to_enb.end()) return;
+  unlink_ue(ue_id, it->second);
+  ue_to_enb.erase(it);
+}
+
+void mme_app_enb_ue_index_rename(mme_ue_s1ap_id_t old_ue_id,
+                                 mme_ue_s1ap_id_t new_ue_id) {
+  auto it = ue_to_enb.find(old_ue_id);
+  if (it == ue_to_enb.end()) return;
+  uint32_t enb_id = it->second;
+  mme_app_enb_ue_index_remove(old_ue_id);
+  mme_app_enb_ue_index_update(new_ue_id, enb_id);
+}
+
+uint32_t mme_app_enb_ue_index_foreach(uint32_t enb_id,
+                                      mme_app_enb_ue_index_cb_t cb,
+                                      void* arg) {
+  auto it = enb_to_ues.find(enb_id);
+  if (it == enb_to_ues.end()) return 0;
+  std::vector<mme_ue_s1ap_id_t> ue_ids(it->second.begin(), it->second.end());
+  uint32_t num_calls = 0;
+  for (mme_ue_s1ap_id_t ue_id : ue_ids) {
+    num_calls++;
+    if (cb(ue_id, arg)) break;
+  }
+  return num_calls;
+}
+
+uint32_t mme_app_enb_ue_index_num_ues(uint32_t enb_id) {
+  auto it = enb_to_ues.find(enb_id);
+  return it == enb_to_ues.end() ? 0 : it->second.size();
+}
+
+void mme_app_enb_ue_index_rebuild(hash_table_ts_t* ue_state_ht) {
+  mme_app_enb_ue_index_clear();
+  if (ue_state_ht == nullptr) return;
+  hashtable_ts_apply_callback_on_elements(ue_state_ht, index_ue, nullptr,
+                                          nullptr);
+  OAILOG_INFO(LOG_MME_APP, "eNB UE index rebuilt with %zu UEs on %zu eNBs\n",
+              ue_to_enb.size(), enb_to_ues.size());
+}
+
+void mme_app_enb_ue_index_clear(void) {
+  enb_to_ues.clear();
+  ue_to_enb.clear();
+}
@@ -0,0 +1,71 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*! \file mme_app_enb_ue_index.h
+  \brief Secondary index of the MME UE contexts by serving eNB.
+
+  Maps the S1AP global eNB id of the last eNB a UE was attached through to
+  the mme_ue_s1ap_ids of its UEs, so that operations on all UEs of one eNB
+  (HA offload, S1 Reset) do not have to walk every UE context. UEs stay
+  indexed under their last eNB while in ECM_IDLE, as sctp_assoc_id_key
+  does. The index only lives in the MME_APP task.
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lte/gateway/c/core/oai/common/common_types.h"
+#include "lte/gateway/c/core/oai/include/mme_app_ue_context.h"
+#include "lte/gateway/c/core/oai/lib/3gpp/3gpp_36.401.h"
+#include "lte/gateway/c/core/oai/lib/hashtable/hashtable.h"
+
+/* Returns true to stop the iteration */
+typedef bool (*mme_app_enb_ue_index_cb_t)(mme_ue_s1ap_id_t mme_ue_s1ap_id,
+                                          void* arg);
+
+/* Index ue_id under enb_id, moving it from the eNB it was indexed under */
+void mme_app_enb_ue_index_update(mme_ue_s1ap_id_t ue_id, uint32_t enb_id);
+
+void mme_app_enb_ue_index_remove(mme_ue_s1ap_id_t ue_id);
+
+/* Carry the eNB of old_ue_id over to new_ue_id */
+void mme_app_enb_ue_index_rename(mme_ue_s1ap_id_t old_ue_id,
+                                 mme_ue_s1ap_id_t new_ue_id);
+
+/*
+ * Calls cb for the UEs indexed under enb_id and returns the number of calls.
+ * The UEs are copied out first, so cb may update the index.
+ */
+uint32_t mme_app_enb_ue_index_foreach(uint32_t enb_id,
+                                      mme_app_enb_ue_index_cb_t cb, void* arg);
+
+uint32_t mme_app_enb_ue_index_num_ues(uint32_t enb_id);
+
+/*
+ * Drop the index and index every UE context of ue_state_ht. The eNB id is
+ * taken from enb_s1ap_id_key for ECM_CONNECTED UEs and from the ECGI of
+ * ECM_IDLE UEs, whose key is no longer valid.
+ */
+void mme_app_enb_ue_index_rebuild(hash_table_ts_t* ue_state_ht);
+
+void mme_app_enb_ue_index_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
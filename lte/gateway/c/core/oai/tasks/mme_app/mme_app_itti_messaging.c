@@ -692,3 +692,73 @@ void mme_app_itti_sgsap_ue_activity_ind(const char* imsi,
   }
   OAILOG_FUNC_OUT(LOG_MME_APP);
 }
+
+/****************************************************************************
+ **                                                                        **
+ ** name:    mme_app_itti_s1ap_overload_ind                                **
+ **                                                                        **
+ ** description: Send itti message, MME overload indication to S1AP task,   **
+ **             which sends Overload Start/Stop towards all eNBs           **
+ ** inputs:  overload_start : true for Overload Start                      **
+ **          traffic_reduction_percent : signalling traffic to cut         **
+ **                                                                        **
+ ***************************************************************************/
+void mme_app_itti_s1ap_overload_ind(bool overload_start,
+                                    uint8_t traffic_reduction_percent) {
+  OAILOG_FUNC_IN(LOG_MME_APP);
+  MessageDef* message_p = NULL;
+
+  message_p = itti_alloc_new_message(TASK_MME_APP, S1AP_MME_OVERLOAD_IND);
+  if (message_p == NULL) {
+    OAILOG_ERROR(LOG_MME_APP,
+                 "Failed to allocate memory for S1AP_MME_OVERLOAD_IND\n");
+    OAILOG_FUNC_OUT(LOG_MME_APP);
+  }
+  S1AP_MME_OVERLOAD_IND(message_p).overload_start = overload_start;
+  S1AP_MME_OVERLOAD_IND(message_p).traffic_reduction_percent =
+      traffic_reduction_percent;
+  if (send_msg_to_task(&mme_app_task_zmq_ctx, TASK_S1AP, message_p) !=
+      RETURNok) {
+    OAILOG_ERROR(LOG_MME_APP,
+                 "Failed to send S1AP_MME_OVERLOAD_IND to S1AP task\n");
+  }
+  OAILOG_FUNC_OUT(LOG_MME_APP);
+}
+
+/****************************************************************************
+ **                                                                        **
+ ** name:    mme_app_itti_s6a_auth_vector_prefetch_req                     **
+ **                                                                        **
+ ** description: Send itti message, AIR to S6A task on behalf of the       **
+ **             authentication vector cache, not of a UE                   **
+ ** inputs:  request : IMSI, visited PLMN and number of vectors            **
+ **                                                                        **
+ ***************************************************************************/
+bool mme_app_itti_s6a_auth_vector_prefetch_req(
+    const mme_app_auth_vector_request_t* request) {
+  OAILOG_FUNC_IN(LOG_MME_APP);
+  MessageDef* message_p = NULL;
+  s6a_auth_info_req_t* air_p = NULL;
+
+  message_p = itti_alloc_new_message(TASK_MME_APP, S6A_AUTH_INFO_REQ);
+  if (message_p == NULL) {
+    OAILOG_ERROR(LOG_MME_APP,
+                 "Failed to allocate memory for S6A_AUTH_INFO_REQ\n");
+    OAILOG_FUNC_RETURN(LOG_MME_APP, false);
+  }
+  air_p = &S6A_AUTH_INFO_REQ(message_p);
+  memset(air_p, 0, sizeof(s6a_auth_info_req_t));
+  IMSI64_TO_STRING(request->imsi64, air_p->imsi, request->imsi_length);
+  air_p->imsi_length = request->imsi_length;
+  air_p->visited_plmn = request->visited_plmn;
+  air_p->nb_of_vectors = request->nb_of_vectors;
+  air_p->prefetch_seq = request->seq;
+  message_p->ittiMsgHeader.imsi = request->imsi64;
+  if (send_msg_to_task(&mme_app_task_zmq_ctx, TASK_S6A, message_p) !=
+      RETURNok) {
+    OAILOG_ERROR_UE(LOG_MME_APP, request->imsi64,
+                    "Failed to send S6A_AUTH_INFO_REQ to S6A task\n");
+    OAILOG_FUNC_RETURN(LOG_MME_APP, false);
+  }
+  OAILOG_FUNC_RETURN(LOG_MME_APP, true);
+}
@@ -127,4 +127,10 @@ void mme_app_itti_sgsap_tmsi_reallocation_comp(const char* imsi,
 
 void mme_app_itti_sgsap_ue_activity_ind(const char* imsi,
                                         const unsigned int imsi_len);
+
+void mme_app_itti_s1ap_overload_ind(bool overload_start,
+                                    uint8_t traffic_reduction_percent);
+
+bool mme_app_itti_s6a_auth_vector_prefetch_req(
+    const mme_app_auth_vector_request_t* request);
 #endif /* FILE_MME_APP_ITTI_MESSAGING_SEEN */
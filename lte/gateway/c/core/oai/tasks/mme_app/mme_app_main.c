@@ -39,6 +39,8 @@
 #include "lte/gateway/c/core/oai/include/mme_app_ue_context.h"
 #include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_defs.h"
 #include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_ha.h"
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_itti_messaging.h"
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_overload.h"
 #include "lte/gateway/c/core/oai/include/mme_app_statistics.h"
 #include "lte/gateway/c/core/oai/lib/message_utils/service303_message_utils.h"
 #include "lte/gateway/c/core/oai/common/common_defs.h"
@@ -55,6 +57,8 @@ static void check_mme_healthy_and_notify_service(void);
 static bool is_mme_app_healthy(void);
 static void mme_app_exit(void);
 static void start_stats_timer(void);
+static void start_bulk_release_timer(void);
+static void start_auth_vector_cache_timer(void);
 
 bool mme_hss_associated = false;
 bool mme_sctp_bounded = false;
@@ -63,6 +67,8 @@ bool mme_congestion_control_enabled = true;
 long mme_app_last_msg_latency;
 long pre_mme_task_msg_latency;
 static long epc_stats_timer_id;
+static long bulk_release_timer_id;
+static long auth_vector_cache_timer_id;
 static size_t epc_stats_timer_sec = 60;
 
 mme_congestion_params_t mme_congestion_params;
@@ -81,6 +87,11 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
 
   OAILOG_DEBUG(LOG_MME_APP, "MME APP ZMQ latency: %ld.",
                mme_app_last_msg_latency);
+  long overload_latency = mme_app_last_msg_latency + pre_mme_task_msg_latency;
+  mme_app_overload_observe(
+      ITTI_MSG_ORIGIN_ID(received_message_p),
+      overload_latency > 0 ? (uint64_t)overload_latency : 0,
+      mme_app_overload_now_us());
 
   switch (ITTI_MSG_ID(received_message_p)) {
     case MESSAGE_TEST: {
@@ -240,6 +251,12 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
       is_task_state_same = true;
     } break;
 
+    case AGW_OFFLOAD_REQ: {
+      // Forwarded by the HA task, the UE contexts are only touched here
+      mme_app_handle_agw_offload_req(&AGW_OFFLOAD_REQ(received_message_p));
+      is_task_state_same = true;
+    } break;
+
     case S11_PAGING_REQUEST: {
       OAILOG_DEBUG(LOG_MME_APP, "MME handling paging request \n");
       imsi64 = mme_app_handle_initial_paging_request(
@@ -407,6 +424,13 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
     } break;
 
     case S6A_AUTH_INFO_ANS: {
+      if (S6A_AUTH_INFO_ANS(received_message_p).prefetch_seq) {
+        // Stock for the authentication vector cache, no UE waits for it
+        nas_proc_auth_vector_prefetch_answer(
+            &S6A_AUTH_INFO_ANS(received_message_p));
+        is_task_state_same = true;
+        break;
+      }
       /*
        * We received the authentication vectors from HSS,
        * Normally should trigger an authentication procedure towards UE.
@@ -500,6 +524,8 @@ static void* mme_app_thread(__attribute__((unused)) void* args) {
   // Service started, but not healthy yet
   send_app_health_to_service303(&mme_app_task_zmq_ctx, TASK_MME_APP, false);
   start_stats_timer();
+  start_bulk_release_timer();
+  start_auth_vector_cache_timer();
 
   zloop_start(mme_app_task_zmq_ctx.event_loop);
   AssertFatal(0,
@@ -518,6 +544,18 @@ static void mme_app_init_congestion_params(const mme_config_t* mme_config_p) {
       (long)mme_config_p->mme_app_zmq_smc_th;
 }
 
+static status_code_e mme_app_init_overload_control(void) {
+  mme_overload_config_t overload_config = {0};
+  overload_config.enabled = mme_congestion_control_enabled;
+  overload_config.target_latency_us = MME_APP_ZMQ_LATENCY_CONGEST_TH;
+  overload_config.target_depth = MME_APP_OVERLOAD_TARGET_DEPTH;
+  overload_config.eval_period_ms = MME_APP_OVERLOAD_EVAL_PERIOD_MS;
+  overload_config.max_reduction_percent =
+      MME_APP_OVERLOAD_MAX_REDUCTION_PERCENT;
+  overload_config.notify_cb = mme_app_itti_s1ap_overload_ind;
+  return mme_app_overload_init(&overload_config, mme_app_overload_now_us());
+}
+
 //------------------------------------------------------------------------------
 status_code_e mme_app_init(const mme_config_t* mme_config_p) {
   OAILOG_FUNC_IN(LOG_MME_APP);
@@ -534,6 +572,28 @@ status_code_e mme_app_init(const mme_config_t* mme_config_p) {
   // Initialize task global congestion parameters
   mme_congestion_control_enabled = mme_config_p->enable_congestion_control;
   mme_app_init_congestion_params(mme_config_p);
+  if (mme_app_init_overload_control() != RETURNok) {
+    OAILOG_FUNC_RETURN(LOG_MME_APP, RETURNerror);
+  }
+  mme_app_bulk_release_config_t bulk_release_config = {
+      .ops_per_sec = MME_APP_BULK_RELEASE_OPS_PER_SEC,
+      .tick_ms = MME_APP_BULK_RELEASE_TICK_MS,
+      .dispatch_cb = mme_app_handle_bulk_release_item};
+  mme_app_bulk_release_init(&bulk_release_config);
+  mme_app_auth_vector_cache_config_t auth_vector_cache_config = {
+#if S6A_OVER_GRPC
+      .max_imsis = MME_APP_AUTH_VECTOR_CACHE_MAX_IMSIS,
+#else
+      // freeDiameter AIAs cannot be told apart from the UE ones
+      .max_imsis = 0,
+#endif
+      .max_vectors = MME_APP_AUTH_VECTOR_CACHE_MAX_VECTORS,
+      .low_watermark = MME_APP_AUTH_VECTOR_CACHE_LOW_WATERMARK,
+      .ttl_sec = MME_APP_AUTH_VECTOR_CACHE_TTL_SEC,
+      .max_prefetch_in_flight = MME_APP_AUTH_VECTOR_PREFETCH_MAX_IN_FLIGHT,
+      .prefetch_timeout_sec = MME_APP_AUTH_VECTOR_PREFETCH_TIMEOUT_SEC,
+      .request_cb = mme_app_itti_s6a_auth_vector_prefetch_req};
+  mme_app_auth_vector_cache_init(&auth_vector_cache_config);
 
   // Initialize global stats timer
   epc_stats_timer_sec = (size_t)mme_config_p->stats_timer_sec;
@@ -569,6 +629,28 @@ static void start_stats_timer(void) {
                   TIMER_REPEAT_FOREVER, handle_stats_timer, NULL);
 }
 
+static int handle_bulk_release_timer(zloop_t* loop, int id, void* arg) {
+  mme_app_bulk_release_tick();
+  return 0;
+}
+
+static void start_bulk_release_timer(void) {
+  bulk_release_timer_id =
+      start_timer(&mme_app_task_zmq_ctx, MME_APP_BULK_RELEASE_TICK_MS,
+                  TIMER_REPEAT_FOREVER, handle_bulk_release_timer, NULL);
+}
+
+static int handle_auth_vector_cache_timer(zloop_t* loop, int id, void* arg) {
+  mme_app_auth_vector_cache_tick(mme_app_auth_vector_cache_now_sec());
+  return 0;
+}
+
+static void start_auth_vector_cache_timer(void) {
+  auth_vector_cache_timer_id =
+      start_timer(&mme_app_task_zmq_ctx, MME_APP_AUTH_VECTOR_CACHE_TICK_MS,
+                  TIMER_REPEAT_FOREVER, handle_auth_vector_cache_timer, NULL);
+}
+
 static void check_mme_healthy_and_notify_service(void) {
   if (is_mme_app_healthy()) {
     send_app_health_to_service303(&mme_app_task_zmq_ctx, TASK_MME_APP, true);
@@ -582,7 +664,12 @@ static bool is_mme_app_healthy(void) {
 //------------------------------------------------------------------------------
 static void mme_app_exit(void) {
   stop_timer(&mme_app_task_zmq_ctx, epc_stats_timer_id);
+  stop_timer(&mme_app_task_zmq_ctx, bulk_release_timer_id);
+  stop_timer(&mme_app_task_zmq_ctx, auth_vector_cache_timer_id);
   mme_app_edns_exit();
+  mme_app_overload_exit();
+  mme_app_bulk_release_exit();
+  mme_app_auth_vector_cache_exit();
   clear_mme_nas_state();
   // Clean-up NAS module
   nas_network_cleanup();
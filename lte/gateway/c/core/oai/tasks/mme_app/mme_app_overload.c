@@ -0,0 +1,378 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_overload.h"
+#include "lte/gateway/c/core/oai/common/common_defs.h"
+#include "lte/gateway/c/core/oai/common/dynamic_memory_check.h"
+#include "lte/gateway/c/core/oai/common/log.h"
+#include "lte/gateway/c/core/oai/include/service303.h"
+#include "lte/gateway/c/core/oai/lib/bstr/bstrlib.h"
+#include "lte/gateway/c/core/oai/lib/hashtable/hashtable.h"
+#include "orc8r/gateway/c/common/service303/includes/MetricsHelpers.h"
+
+// Per message latency EWMA weight is 1/2^MME_OVERLOAD_LATENCY_EWMA_SHIFT
+#define MME_OVERLOAD_LATENCY_EWMA_SHIFT 3
+// Per evaluation period weight of the arrival rate EWMAs
+#define MME_OVERLOAD_RATE_EWMA_ALPHA 0.5
+// AIMD on the admitted share of the offered load
+#define MME_OVERLOAD_DECREASE_FACTOR 0.75
+#define MME_OVERLOAD_INCREASE_STEP_PERCENT 5
+// Token bucket depth, in evaluation periods worth of admitted procedures
+#define MME_OVERLOAD_BUCKET_PERIODS 2
+// Buckets of eNBs silent for that many evaluation periods are dropped
+#define MME_OVERLOAD_ENB_IDLE_PERIODS 600
+#define MME_OVERLOAD_ENB_HT_SIZE 64
+
+typedef struct overload_origin_s {
+  uint64_t latency_ewma_us;
+  uint32_t arrivals;  // During the current evaluation period
+} overload_origin_t;
+
+typedef struct overload_enb_s {
+  uint64_t epoch;  // Evaluation period the arrivals were counted in
+  uint64_t last_refill_us;
+  uint32_t arrivals[MME_OVERLOAD_PROC_MAX];
+  double rate[MME_OVERLOAD_PROC_MAX];  // Offered procedures per second
+  double tokens[MME_OVERLOAD_PROC_MAX];
+} overload_enb_t;
+
+typedef struct overload_state_s {
+  mme_overload_config_t config;
+  bool initialized;
+  uint64_t last_eval_us;
+  uint64_t epoch;
+  uint8_t reduction_percent;
+  uint8_t notified_percent;  // 0 while no Overload Start is outstanding
+  uint64_t latency_ewma_us;
+  uint32_t depth_estimate;
+  overload_origin_t origins[MME_OVERLOAD_MAX_ORIGIN_TASKS];
+  uint32_t arrivals[MME_OVERLOAD_PROC_MAX];
+  double rate[MME_OVERLOAD_PROC_MAX];
+  double shed[MME_OVERLOAD_PROC_MAX];  // Share of each class to reject
+  uint64_t admitted[MME_OVERLOAD_PROC_MAX];
+  uint64_t rejected[MME_OVERLOAD_PROC_MAX];
+  hash_table_ts_t* enbs;
+} overload_state_t;
+
+static overload_state_t overload = {0};
+
+static const char* const overload_proc_str[MME_OVERLOAD_PROC_MAX] = {
+    "attach", "service_request", "tau", "detach"};
+
+const char* mme_app_overload_proc_str(mme_overload_proc_t proc) {
+  return (proc < MME_OVERLOAD_PROC_MAX) ? overload_proc_str[proc] : "unknown";
+}
+
+uint64_t mme_app_overload_now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static double overload_period_s(void) {
+  return (double)overload.config.eval_period_ms / 1000;
+}
+
+//------------------------------------------------------------------------------
+status_code_e mme_app_overload_init(const mme_overload_config_t* config,
+                                    uint64_t now_us) {
+  OAILOG_FUNC_IN(LOG_MME_APP);
+  mme_app_overload_exit();
+  overload.config = *config;
+  if (overload.config.eval_period_ms == 0) {
+    OAILOG_ERROR(LOG_MME_APP, "Overload evaluation period must not be 0\n");
+    OAILOG_FUNC_RETURN(LOG_MME_APP, RETURNerror);
+  }
+  bstring ht_name = bfromcstr("mme_app_overload_enbs");
+  overload.enbs = hashtable_ts_create(MME_OVERLOAD_ENB_HT_SIZE, NULL,
+                                      free_wrapper, ht_name);
+  bdestroy(ht_name);
+  if (overload.enbs == NULL) {
+    OAILOG_ERROR(LOG_MME_APP, "Failed to create overload eNB table\n");
+    OAILOG_FUNC_RETURN(LOG_MME_APP, RETURNerror);
+  }
+  overload.last_eval_us = now_us;
+  overload.initialized = true;
+  OAILOG_FUNC_RETURN(LOG_MME_APP, RETURNok);
+}
+
+//------------------------------------------------------------------------------
+void mme_app_overload_exit(void) {
+  if (overload.enbs) {
+    hashtable_ts_destroy(overload.enbs);
+  }
+  memset(&overload, 0, sizeof(overload));
+}
+
+//------------------------------------------------------------------------------
+// Fills the reduction into the classes in shedding order, so that attaches
+// are rejected entirely before the first service request is.
+static void overload_split_reduction(void) {
+  double total = 0;
+  for (int proc = 0; proc < MME_OVERLOAD_PROC_MAX; proc++) {
+    total += overload.rate[proc];
+  }
+  double need = total * overload.reduction_percent / 100;
+  for (int proc = 0; proc < MME_OVERLOAD_PROC_DETACH; proc++) {
+    if (need <= 0) {
+      overload.shed[proc] = 0;
+    } else if (overload.rate[proc] <= need) {
+      overload.shed[proc] = 1;
+      need -= overload.rate[proc];
+    } else {
+      overload.shed[proc] = need / overload.rate[proc];
+      need = 0;
+    }
+  }
+  overload.shed[MME_OVERLOAD_PROC_DETACH] = 0;
+}
+
+//------------------------------------------------------------------------------
+static void overload_notify(void) {
+  uint8_t reduction = overload.reduction_percent;
+  uint8_t notified = overload.notified_percent;
+  int change = abs((int)reduction - (int)notified);
+  if (reduction > 0 &&
+      (notified == 0 || change >= MME_OVERLOAD_NOTIFY_STEP_PERCENT)) {
+    OAILOG_WARNING(LOG_MME_APP,
+                   "MME overloaded, latency %lu us, depth %u, reducing "
+                   "signalling traffic by %u%%\n",
+                   overload.latency_ewma_us, overload.depth_estimate,
+                   reduction);
+    overload.notified_percent = reduction;
+    if (overload.config.notify_cb) {
+      overload.config.notify_cb(true, reduction);
+    }
+  } else if (reduction == 0 && notified > 0) {
+    OAILOG_WARNING(LOG_MME_APP, "MME overload ended\n");
+    overload.notified_percent = 0;
+    if (overload.config.notify_cb) {
+      overload.config.notify_cb(false, 0);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void overload_remove_idle_enbs(void) {
+  hashtable_key_array_t* keys = hashtable_ts_get_keys(overload.enbs);
+  if (keys == NULL) {
+    return;
+  }
+  for (int i = 0; i < keys->num_keys; i++) {
+    overload_enb_t* enb = NULL;
+    if (hashtable_ts_get(overload.enbs, keys->keys[i], (void**)&enb) ==
+            HASH_TABLE_OK &&
+        enb->epoch + MME_OVERLOAD_ENB_IDLE_PERIODS < overload.epoch) {
+      hashtable_ts_free(overload.enbs, keys->keys[i]);
+    }
+  }
+  free_wrapper((void**)&keys->keys);
+  free_wrapper((void**)&keys);
+}
+
+//------------------------------------------------------------------------------
+static void overload_evaluate(uint64_t now_us) {
+  double elapsed_s = (double)(now_us - overload.last_eval_us) / 1000000;
+  uint64_t latency_us = 0;
+  double depth = 0;
+
+  for (int task = 0; task < MME_OVERLOAD_MAX_ORIGIN_TASKS; task++) {
+    overload_origin_t* origin = &overload.origins[task];
+    if (origin->arrivals == 0) {
+      continue;
+    }
+    if (origin->latency_ewma_us > latency_us) {
+      latency_us = origin->latency_ewma_us;
+    }
+    // Little's law: messages in flight = arrival rate x time in queue
+    depth += origin->arrivals / elapsed_s * origin->latency_ewma_us / 1000000;
+    origin->arrivals = 0;
+  }
+  overload.latency_ewma_us = latency_us;
+  overload.depth_estimate = (uint32_t)depth;
+
+  for (int proc = 0; proc < MME_OVERLOAD_PROC_MAX; proc++) {
+    overload.rate[proc] +=
+        MME_OVERLOAD_RATE_EWMA_ALPHA *
+        (overload.arrivals[proc] / elapsed_s - overload.rate[proc]);
+    overload.arrivals[proc] = 0;
+  }
+
+  const mme_overload_config_t* config = &overload.config;
+  int admit_percent = 100 - overload.reduction_percent;
+  if (latency_us > config->target_latency_us ||
+      overload.depth_estimate > config->target_depth) {
+    int decreased = (int)(admit_percent * MME_OVERLOAD_DECREASE_FACTOR);
+    admit_percent = (decreased < admit_percent) ? decreased : admit_percent - 1;
+  } else if (latency_us < config->target_latency_us / 2 &&
+             overload.depth_estimate < config->target_depth / 2) {
+    admit_percent += MME_OVERLOAD_INCREASE_STEP_PERCENT;
+  }
+  if (admit_percent > 100) {
+    admit_percent = 100;
+  } else if (admit_percent < 100 - config->max_reduction_percent) {
+    admit_percent = 100 - config->max_reduction_percent;
+  }
+  overload.reduction_percent = (uint8_t)(100 - admit_percent);
+
+  overload_split_reduction();
+  overload_notify();
+
+  set_gauge("mme_overload_traffic_reduction_percent",
+            overload.reduction_percent, NO_LABELS);
+  set_gauge("mme_overload_latency_us", overload.latency_ewma_us, NO_LABELS);
+  set_gauge("mme_overload_queue_depth", overload.depth_estimate, NO_LABELS);
+
+  overload.last_eval_us = now_us;
+  overload.epoch++;
+  if (overload.epoch % MME_OVERLOAD_ENB_IDLE_PERIODS == 0) {
+    overload_remove_idle_enbs();
+  }
+}
+
+static void overload_maybe_evaluate(uint64_t now_us) {
+  if (now_us - overload.last_eval_us >=
+      (uint64_t)overload.config.eval_period_ms * 1000) {
+    overload_evaluate(now_us);
+  }
+}
+
+//------------------------------------------------------------------------------
+void mme_app_overload_observe(uint32_t origin_task, uint64_t latency_us,
+                              uint64_t now_us) {
+  if (!overload.initialized || !overload.config.enabled ||
+      origin_task >= MME_OVERLOAD_MAX_ORIGIN_TASKS) {
+    return;
+  }
+  overload_origin_t* origin = &overload.origins[origin_task];
+  int64_t delta = (int64_t)latency_us - (int64_t)origin->latency_ewma_us;
+  origin->latency_ewma_us += delta / (1 << MME_OVERLOAD_LATENCY_EWMA_SHIFT);
+  origin->arrivals++;
+  overload_maybe_evaluate(now_us);
+}
+
+//------------------------------------------------------------------------------
+static overload_enb_t* overload_get_enb(sctp_assoc_id_t assoc_id,
+                                        uint64_t now_us) {
+  overload_enb_t* enb = NULL;
+  if (hashtable_ts_get(overload.enbs, (hash_key_t)assoc_id, (void**)&enb) ==
+      HASH_TABLE_OK) {
+    return enb;
+  }
+  enb = calloc(1, sizeof(*enb));
+  if (enb == NULL) {
+    return NULL;
+  }
+  enb->epoch = overload.epoch;
+  enb->last_refill_us = now_us;
+  for (int proc = 0; proc < MME_OVERLOAD_PROC_MAX; proc++) {
+    enb->tokens[proc] = 1;
+  }
+  if (hashtable_ts_insert(overload.enbs, (hash_key_t)assoc_id, enb) !=
+      HASH_TABLE_OK) {
+    free_wrapper((void**)&enb);
+  }
+  return enb;
+}
+
+// Folds the arrivals counted in earlier evaluation periods into the rates
+static void overload_enb_roll(overload_enb_t* enb) {
+  uint64_t periods = overload.epoch - enb->epoch;
+  if (periods == 0) {
+    return;
+  }
+  for (int proc = 0; proc < MME_OVERLOAD_PROC_MAX; proc++) {
+    enb->rate[proc] +=
+        MME_OVERLOAD_RATE_EWMA_ALPHA *
+        (enb->arrivals[proc] / overload_period_s() - enb->rate[proc]);
+    enb->arrivals[proc] = 0;
+    for (uint64_t idle = 1; idle < periods && enb->rate[proc] > 0; idle++) {
+      enb->rate[proc] *= 1 - MME_OVERLOAD_RATE_EWMA_ALPHA;
+      if (idle > 16) {
+        enb->rate[proc] = 0;
+      }
+    }
+  }
+  enb->epoch = overload.epoch;
+}
+
+static void overload_enb_refill(overload_enb_t* enb, uint64_t now_us) {
+  double elapsed_s = (double)(now_us - enb->last_refill_us) / 1000000;
+  for (int proc = 0; proc < MME_OVERLOAD_PROC_MAX; proc++) {
+    double fill_rate = enb->rate[proc] * (1 - overload.shed[proc]);
+    double burst =
+        fill_rate * overload_period_s() * MME_OVERLOAD_BUCKET_PERIODS;
+    if (burst < 1) {
+      burst = 1;
+    }
+    if (overload.shed[proc] == 0) {
+      enb->tokens[proc] = burst;
+      continue;
+    }
+    enb->tokens[proc] += fill_rate * elapsed_s;
+    if (enb->tokens[proc] > burst) {
+      enb->tokens[proc] = burst;
+    }
+  }
+  enb->last_refill_us = now_us;
+}
+
+//------------------------------------------------------------------------------
+bool mme_app_overload_admit(sctp_assoc_id_t assoc_id, mme_overload_proc_t proc,
+                            uint64_t now_us) {
+  if (!overload.initialized || !overload.config.enabled ||
+      proc >= MME_OVERLOAD_PROC_MAX) {
+    return true;
+  }
+  overload_maybe_evaluate(now_us);
+  overload.arrivals[proc]++;
+
+  bool admit = true;
+  overload_enb_t* enb = overload_get_enb(assoc_id, now_us);
+  if (enb) {
+    overload_enb_roll(enb);
+    overload_enb_refill(enb, now_us);
+    enb->arrivals[proc]++;
+    if (overload.shed[proc] >= 1 || enb->tokens[proc] < 1) {
+      admit = false;
+    } else {
+      enb->tokens[proc] -= 1;
+    }
+  } else if (overload.shed[proc] > 0) {
+    admit = false;
+  }
+
+  if (admit) {
+    overload.admitted[proc]++;
+  } else {
+    overload.rejected[proc]++;
+    increment_counter("mme_overload_rejected", 1, 1, "procedure",
+                      overload_proc_str[proc]);
+  }
+  return admit;
+}
+
+//------------------------------------------------------------------------------
+void mme_app_overload_get_stats(mme_overload_stats_t* stats) {
+  memset(stats, 0, sizeof(*stats));
+  stats->traffic_reduction_percent = overload.reduction_percent;
+  stats->latency_ewma_us = overload.latency_ewma_us;
+  stats->depth_estimate = overload.depth_estimate;
+  stats->nb_enbs = overload.enbs ? overload.enbs->num_elements : 0;
+  memcpy(stats->admitted, overload.admitted, sizeof(stats->admitted));
+  memcpy(stats->rejected, overload.rejected, sizeof(stats->rejected));
+}
@@ -0,0 +1,99 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*! \file mme_app_overload.h
+  \brief Adaptive overload control for the MME_APP task.
+
+  The controller keeps an EWMA of the ITTI latency observed per origin task
+  and derives a queue depth estimate from it (Little's law: arrival rate x
+  latency), since ZMQ does not expose the socket backlog. Every evaluation
+  period an AIMD loop turns those signals into a traffic reduction
+  percentage, which is split across procedure classes in shedding order
+  (attach, then service request, then TAU; detach is never shed) and
+  enforced with a token bucket per eNB and per class.
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lte/gateway/c/core/oai/common/common_types.h"
+
+// Procedure classes, in the order in which they are shed
+typedef enum {
+  MME_OVERLOAD_PROC_ATTACH = 0,
+  MME_OVERLOAD_PROC_SERVICE_REQUEST,
+  MME_OVERLOAD_PROC_TAU,
+  MME_OVERLOAD_PROC_DETACH,
+  MME_OVERLOAD_PROC_MAX
+} mme_overload_proc_t;
+
+// Origin task ids above this bound are not tracked
+#define MME_OVERLOAD_MAX_ORIGIN_TASKS 64
+
+/*
+ * Called when the controller enters overload, when the reduction changes by
+ * at least MME_OVERLOAD_NOTIFY_STEP_PERCENT, and when overload ends.
+ */
+#define MME_OVERLOAD_NOTIFY_STEP_PERCENT 10
+typedef void (*mme_overload_notify_cb_t)(bool overload_start,
+                                         uint8_t traffic_reduction_percent);
+
+typedef struct mme_overload_config_s {
+  bool enabled;
+  uint64_t target_latency_us;  // EWMA ITTI latency above which load is cut
+  uint32_t target_depth;       // Estimated queued messages, same purpose
+  uint32_t eval_period_ms;
+  uint8_t max_reduction_percent;
+  mme_overload_notify_cb_t notify_cb;
+} mme_overload_config_t;
+
+typedef struct mme_overload_stats_s {
+  uint8_t traffic_reduction_percent;
+  uint64_t latency_ewma_us;
+  uint32_t depth_estimate;
+  uint32_t nb_enbs;
+  uint64_t admitted[MME_OVERLOAD_PROC_MAX];
+  uint64_t rejected[MME_OVERLOAD_PROC_MAX];
+} mme_overload_stats_t;
+
+status_code_e mme_app_overload_init(const mme_overload_config_t* config,
+                                    uint64_t now_us);
+void mme_app_overload_exit(void);
+
+/*
+ * Feeds one ITTI message received by MME_APP into the controller. latency_us
+ * is the end to end queueing latency of the message.
+ */
+void mme_app_overload_observe(uint32_t origin_task, uint64_t latency_us,
+                              uint64_t now_us);
+
+/*
+ * Returns false if a procedure of class proc coming from the eNB on
+ * assoc_id has to be rejected with EMM cause congestion.
+ */
+bool mme_app_overload_admit(sctp_assoc_id_t assoc_id, mme_overload_proc_t proc,
+                            uint64_t now_us);
+
+void mme_app_overload_get_stats(mme_overload_stats_t* stats);
+const char* mme_app_overload_proc_str(mme_overload_proc_t proc);
+uint64_t mme_app_overload_now_us(void);
+
+#ifdef __cplusplus
+}
+#endif
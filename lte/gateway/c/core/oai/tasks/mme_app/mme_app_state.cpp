@@ -17,6 +17,7 @@
 
 #include "lte/gateway/c/core/oai/include/mme_app_state.h"
 #include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_state_manager.h"
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_enb_ue_index.h"
 #include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_ip_imsi.h"
 
 using magma::lte::MmeNasStateManager;
@@ -27,7 +28,10 @@ using magma::lte::MmeNasStateManager;
  * This is only done by the mme_app task.
  */
 int mme_nas_state_init(const mme_config_t* mme_config_p) {
-  return MmeNasStateManager::getInstance().initialize_state(mme_config_p);
+  int rc = MmeNasStateManager::getInstance().initialize_state(mme_config_p);
+  mme_app_enb_ue_index_rebuild(
+      MmeNasStateManager::getInstance().get_ue_state_ht());
+  return rc;
 }
 
 /**
@@ -52,7 +56,10 @@ void put_mme_nas_state() {
  * Release the memory allocated for the MME NAS state, this does not clean the
  * state persisted in data store
  */
-void clear_mme_nas_state() { MmeNasStateManager::getInstance().free_state(); }
+void clear_mme_nas_state() {
+  mme_app_enb_ue_index_clear();
+  MmeNasStateManager::getInstance().free_state();
+}
 
 hash_table_ts_t* get_mme_ue_state() {
   return MmeNasStateManager::getInstance().get_ue_state_ht();
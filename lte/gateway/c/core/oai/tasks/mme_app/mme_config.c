@@ -164,6 +164,13 @@ void s6a_config_init(s6a_config_t* s6a_conf) {
   s6a_conf->hss_host_name = NULL;
   s6a_conf->hss_realm = NULL;
   s6a_conf->conf_file = bfromcstr(S6A_CONF_FILE);
+  s6a_conf->local_hss_enabled = false;
+  s6a_conf->local_hss_store_file = bfromcstr(S6A_LOCAL_HSS_STORE_FILE);
+  s6a_conf->local_hss_sync_interval_sec = S6A_LOCAL_HSS_SYNC_INTERVAL_SEC;
+  s6a_conf->local_hss_op = NULL;
+  s6a_conf->local_hss_amf = bfromcstr(S6A_LOCAL_HSS_AMF);
+  s6a_conf->local_hss_max_ul_bit_rate = 0;
+  s6a_conf->local_hss_max_dl_bit_rate = 0;
 }
 
 void itti_config_init(itti_config_t* itti_conf) {
@@ -305,6 +312,9 @@ void free_mme_config(mme_config_t* mme_config) {
   bdestroy_wrapper(&mme_config->ip.if_name_s1_mme);
   bdestroy_wrapper(&mme_config->ip.if_name_s11);
   bdestroy_wrapper(&mme_config->s6a_config.conf_file);
+  bdestroy_wrapper(&mme_config->s6a_config.local_hss_store_file);
+  bdestroy_wrapper(&mme_config->s6a_config.local_hss_op);
+  bdestroy_wrapper(&mme_config->s6a_config.local_hss_amf);
   bdestroy_wrapper(&mme_config->itti_config.log_file);
 
   free_wrapper((void**)&mme_config->served_tai.plmn_mcc);
@@ -877,6 +887,60 @@ int mme_config_parse_string(const char* config_string,
                 MME_CONFIG_STRING_S6A_HSS_REALM);
       }
     }
+#else
+    // S6A SETTING, local HSS
+    setting =
+        config_setting_get_member(setting_mme, MME_CONFIG_STRING_S6A_CONFIG);
+
+    if (setting != NULL) {
+      if ((config_setting_lookup_string(setting,
+                                        MME_CONFIG_STRING_S6A_LOCAL_HSS,
+                                        (const char**)&astring))) {
+        config_pP->s6a_config.local_hss_enabled = parse_bool(astring);
+      }
+      if ((config_setting_lookup_string(
+              setting, MME_CONFIG_STRING_S6A_LOCAL_HSS_STORE_FILE,
+              (const char**)&astring))) {
+        if (astring != NULL) {
+          bassigncstr(config_pP->s6a_config.local_hss_store_file, astring);
+        }
+      }
+      if ((config_setting_lookup_int(
+              setting, MME_CONFIG_STRING_S6A_LOCAL_HSS_SYNC_INTERVAL,
+              &aint))) {
+        AssertFatal(aint > 0, "Bad local HSS sync interval %d\n", aint);
+        config_pP->s6a_config.local_hss_sync_interval_sec = (uint32_t)aint;
+      }
+      if ((config_setting_lookup_string(setting,
+                                        MME_CONFIG_STRING_S6A_LOCAL_HSS_OP,
+                                        (const char**)&astring))) {
+        if (astring != NULL) {
+          if (config_pP->s6a_config.local_hss_op) {
+            bassigncstr(config_pP->s6a_config.local_hss_op, astring);
+          } else {
+            config_pP->s6a_config.local_hss_op = bfromcstr(astring);
+          }
+        }
+      }
+      if ((config_setting_lookup_string(setting,
+                                        MME_CONFIG_STRING_S6A_LOCAL_HSS_AMF,
+                                        (const char**)&astring))) {
+        if (astring != NULL) {
+          bassigncstr(config_pP->s6a_config.local_hss_amf, astring);
+        }
+      }
+      long long bit_rate = 0;
+      if ((config_setting_lookup_int64(
+              setting, MME_CONFIG_STRING_S6A_LOCAL_HSS_MAX_UL_BIT_RATE,
+              &bit_rate))) {
+        config_pP->s6a_config.local_hss_max_ul_bit_rate = (uint64_t)bit_rate;
+      }
+      if ((config_setting_lookup_int64(
+              setting, MME_CONFIG_STRING_S6A_LOCAL_HSS_MAX_DL_BIT_RATE,
+              &bit_rate))) {
+        config_pP->s6a_config.local_hss_max_dl_bit_rate = (uint64_t)bit_rate;
+      }
+    }
 #endif /* !S6A_OVER_GRPC */
     // SCTP SETTING
     parse_sctp_settings(setting_mme, config_pP);
@@ -2101,6 +2165,14 @@ void mme_config_display(mme_config_t* config_pP) {
   OAILOG_INFO(LOG_CONFIG, "- S6A:\n");
 #if S6A_OVER_GRPC
   OAILOG_INFO(LOG_CONFIG, "    protocol .........: gRPC\n");
+  OAILOG_INFO(LOG_CONFIG, "    local HSS ........: %s\n",
+              config_pP->s6a_config.local_hss_enabled ? "true" : "false");
+  if (config_pP->s6a_config.local_hss_enabled) {
+    OAILOG_INFO(LOG_CONFIG, "    store file .......: %s\n",
+                bdata(config_pP->s6a_config.local_hss_store_file));
+    OAILOG_INFO(LOG_CONFIG, "    sync interval ....: %u (sec)\n",
+                config_pP->s6a_config.local_hss_sync_interval_sec);
+  }
 #else
   OAILOG_INFO(LOG_CONFIG, "    protocol .........: diameter\n");
   OAILOG_INFO(LOG_CONFIG, "    conf file ........: %s\n",
@@ -514,6 +514,22 @@ status_code_e nas_message_decode(const unsigned char* const buffer,
   OAILOG_FUNC_RETURN(LOG_NAS, bytes);
 }
 
+//------------------------------------------------------------------------------
+status_code_e nas_message_decode_borrowed(const unsigned char* const buffer,
+                                          nas_message_t* msg, size_t length,
+                                          void* security,
+                                          nas_message_decode_status_t* status,
+                                          nas_decode_arena_t* arena) {
+  OAILOG_FUNC_IN(LOG_NAS);
+  unsigned char* const pdu = nas_decode_arena_alloc(arena, length);
+  memcpy(pdu, buffer, length);
+
+  nas_decode_arena_enter(arena);
+  status_code_e rc = nas_message_decode(pdu, msg, length, security, status);
+  nas_decode_arena_leave(arena);
+  OAILOG_FUNC_RETURN(LOG_NAS, rc);
+}
+
 /****************************************************************************
  **                                                                        **
  ** Name:  nas_message_encode()                                      **
@@ -814,7 +830,16 @@ static int nas_message_protected_decode(
     nas_message_decode_status_t* const status) {
   OAILOG_FUNC_IN(LOG_NAS);
   int bytes = TLV_BUFFER_TOO_SHORT;
-  unsigned char* const plain_msg = (unsigned char*)calloc(1, length);
+  // When decoding into an arena the IEs may point into the decrypted message,
+  // which must then live as long as the arena
+  nas_decode_arena_t* arena = nas_decode_arena_current();
+  unsigned char* const plain_msg =
+      arena ? (unsigned char*)nas_decode_arena_alloc(arena, length)
+            : (unsigned char*)calloc(1, length);
+
+  if (arena) {
+    memset(plain_msg, 0, length);
+  }
 
   if (plain_msg) {
     /*
@@ -828,7 +853,9 @@ static int nas_message_protected_decode(
      * Decode the decrypted message as plain NAS message
      */
     bytes = nas_message_plain_decode(plain_msg, header, msg, length);
-    free_wrapper((void**)&plain_msg);
+    if (!arena) {
+      free_wrapper((void**)&plain_msg);
+    }
   }
 
   OAILOG_FUNC_RETURN(LOG_NAS, bytes);
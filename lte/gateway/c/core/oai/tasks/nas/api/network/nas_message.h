@@ -41,6 +41,7 @@ Description Defines the layer 3 messages supported by the NAS sublayer
 #include <stddef.h>
 #include <stdint.h>
 
+#include "lte/gateway/c/core/oai/common/nas_decode_arena.h"
 #include "lte/gateway/c/core/oai/include/nas/commonDef.h"
 #include "lte/gateway/c/core/oai/tasks/nas/emm/msg/emm_msg.h"
 #include "lte/gateway/c/core/oai/tasks/nas/emm/emm_data.h"
@@ -128,6 +129,17 @@ status_code_e nas_message_decode(const unsigned char* const buffer,
                                  void* security,
                                  nas_message_decode_status_t* status);
 
+/*
+ * Same as nas_message_decode(), but the variable length IEs of msg are
+ * borrowed from the arena, which holds a copy of the PDU: they stay valid
+ * until the arena is released, whatever happens to buffer.
+ */
+status_code_e nas_message_decode_borrowed(const unsigned char* const buffer,
+                                          nas_message_t* msg, size_t length,
+                                          void* security,
+                                          nas_message_decode_status_t* status,
+                                          nas_decode_arena_t* arena);
+
 status_code_e nas_message_encode(unsigned char* buffer,
                                  const nas_message_t* const msg, size_t length,
                                  void* security);
@@ -58,10 +58,6 @@
 /****************************************************************************/
 /****************  E X T E R N A L    D E F I N I T I O N S  ****************/
 /****************************************************************************/
-extern long mme_app_last_msg_latency;
-extern long pre_mme_task_msg_latency;
-extern bool mme_congestion_control_enabled;
-extern mme_congestion_params_t mme_congestion_params;
 
 /****************************************************************************/
 /*******************  L O C A L    D E F I N I T I O N S  *******************/
@@ -90,6 +86,8 @@ static int start_authentication_information_procedure(
     struct emm_context_s* emm_context, nas_emm_auth_proc_t* const auth_proc,
     const_bstring auts);
 static int auth_info_proc_success_cb(struct emm_context_s* emm_ctx);
+static bool take_cached_auth_vector(struct emm_context_s* emm_ctx,
+                                    ksi_t* eksi);
 static int auth_info_proc_failure_cb(struct emm_context_s* emm_ctx);
 
 static int authentication_check_imsi_5_4_2_5__1(
@@ -285,9 +283,18 @@ status_code_e emm_proc_authentication(
 
     bool run_auth_info_proc = false;
     if (!IS_EMM_CTXT_VALID_AUTH_VECTORS(emm_context)) {
-      // Ask upper layer to fetch new security context
       nas_auth_info_proc_t* auth_info_proc =
           get_nas_cn_procedure_auth_info(emm_context);
+      ksi_t eksi = 0;
+      if (!auth_info_proc && take_cached_auth_vector(emm_context, &eksi)) {
+        rc = emm_proc_authentication_ksi(
+            emm_context, emm_specific_proc, eksi,
+            emm_context->_vector[eksi % MAX_EPS_AUTH_VECTORS].rand,
+            emm_context->_vector[eksi % MAX_EPS_AUTH_VECTORS].autn, success,
+            failure);
+        OAILOG_FUNC_RETURN(LOG_NAS_EMM, rc);
+      }
+      // Ask upper layer to fetch new security context
       if (!auth_info_proc) {
         auth_info_proc = nas_new_cn_auth_info_procedure(emm_context);
       }
@@ -329,6 +336,40 @@ status_code_e emm_proc_authentication(
   OAILOG_FUNC_RETURN(LOG_NAS_EMM, rc);
 }
 
+//------------------------------------------------------------------------------
+/*
+ * Takes a vector prefetched for the IMSI of emm_ctx out of the MME
+ * authentication vector cache, which spares the AIR round trip. On success
+ * the vector is set in the context for the next eksi, returned in eksi.
+ */
+static bool take_cached_auth_vector(struct emm_context_s* emm_ctx,
+                                    ksi_t* eksi) {
+  OAILOG_FUNC_IN(LOG_NAS_EMM);
+  eutran_vector_t vector;
+  if (!mme_app_auth_vector_cache_take(emm_ctx->_imsi64,
+                                      mme_app_auth_vector_cache_now_sec(),
+                                      &vector)) {
+    OAILOG_FUNC_RETURN(LOG_NAS_EMM, false);
+  }
+
+  *eksi = 0;
+  if (emm_ctx->_security.eksi < KSI_NO_KEY_AVAILABLE) {
+    REQUIREMENT_3GPP_24_301(R10_5_4_2_4__2);
+    *eksi = (emm_ctx->_security.eksi + 1) % (EKSI_MAX_VALUE + 1);
+  }
+  int index = *eksi % MAX_EPS_AUTH_VECTORS;
+  memcpy(emm_ctx->_vector[index].kasme, vector.kasme, AUTH_KASME_SIZE);
+  memcpy(emm_ctx->_vector[index].autn, vector.autn, AUTH_AUTN_SIZE);
+  memcpy(emm_ctx->_vector[index].rand, vector.rand, AUTH_RAND_SIZE);
+  memcpy(emm_ctx->_vector[index].xres, vector.xres.data, vector.xres.size);
+  emm_ctx->_vector[index].xres_size = vector.xres.size;
+  emm_ctx_set_attribute_valid(emm_ctx, EMM_CTXT_MEMBER_AUTH_VECTOR0 + index);
+  emm_ctx_set_attribute_present(emm_ctx, EMM_CTXT_MEMBER_AUTH_VECTORS);
+  OAILOG_INFO_UE(LOG_NAS_EMM, emm_ctx->_imsi64,
+                 "EMM-PROC  - Using cached authentication vector\n");
+  OAILOG_FUNC_RETURN(LOG_NAS_EMM, true);
+}
+
 //------------------------------------------------------------------------------
 static int start_authentication_information_procedure(
     struct emm_context_s* emm_context, nas_emm_auth_proc_t* const auth_proc,
@@ -633,6 +674,8 @@ status_code_e emm_proc_authentication_failure(mme_ue_s1ap_id_t ue_id,
               "vector(s)\n");
 
           REQUIREMENT_3GPP_24_301(R10_5_4_2_7_e__3);
+          // Cached vectors of the IMSI carry SQNs the USIM may reject too
+          mme_app_auth_vector_cache_flush(emm_ctx->_imsi64);
           // Pass back the current rand.
           REQUIREMENT_3GPP_24_301(R10_5_4_2_7_e__2);
           struct tagbstring resync_param;
@@ -882,21 +925,6 @@ status_code_e emm_proc_authentication_complete(mme_ue_s1ap_id_t ue_id,
       OAILOG_FUNC_RETURN(LOG_NAS_EMM, RETURNok);
     }
 
-    /* If spent too much in ZMQ, then discard the packet.
-     * MME is congested and this would create some relief in processing.
-     */
-    if (mme_congestion_control_enabled &&
-        (mme_app_last_msg_latency + pre_mme_task_msg_latency >
-         MME_APP_ZMQ_LATENCY_AUTH_TH)) {
-      OAILOG_WARNING_UE(
-          LOG_NAS_EMM, emm_ctx->_imsi64,
-          "Discarding authentication complete as cumulative ZMQ latency "
-          "( %ld + %ld ) for ueid " MME_UE_S1AP_ID_FMT
-          " is higher than the threshold.",
-          mme_app_last_msg_latency, pre_mme_task_msg_latency, ue_id);
-      OAILOG_FUNC_RETURN(LOG_NAS_EMM, RETURNok);
-    }
-
     // Stop timer T3460
     REQUIREMENT_3GPP_24_301(R10_5_4_2_4__1);
     nas_stop_T3460(ue_id, &auth_proc->T3460);
@@ -82,10 +82,13 @@ static const char* emm_as_primitive_str[] = {
 static int emm_as_recv(mme_ue_s1ap_id_t ue_id, tai_t const* originating_tai,
                        ecgi_t const* originating_ecgi, bstring msg, size_t len,
                        int* emm_cause,
-                       nas_message_decode_status_t* decode_status);
+                       nas_message_decode_status_t* decode_status,
+                       nas_decode_arena_t* arena);
 
-static int emm_as_establish_req(emm_as_establish_t* msg, int* emm_cause);
-static int emm_as_data_ind(emm_as_data_t* msg, int* emm_cause);
+static int emm_as_establish_req(emm_as_establish_t* msg, int* emm_cause,
+                                nas_decode_arena_t* arena);
+static int emm_as_data_ind(emm_as_data_t* msg, int* emm_cause,
+                           nas_decode_arena_t* arena);
 static int emm_as_release_ind(const emm_as_release_t* const release,
                               int* emm_cause);
 
@@ -173,15 +176,25 @@ status_code_e emm_as_send(emm_as_t* msg) {
               emm_as_primitive_str[primitive - _EMMAS_START - 1], primitive);
 
   switch (primitive) {
-    case _EMMAS_DATA_IND:
-      rc = emm_as_data_ind(&msg->u.data, &emm_cause);
+    /*
+     * The variable length IEs of the received message are borrowed from an
+     * arena released once the message has been processed
+     */
+    case _EMMAS_DATA_IND: {
+      nas_decode_arena_t arena;
+      nas_decode_arena_init(&arena);
+      rc = emm_as_data_ind(&msg->u.data, &emm_cause, &arena);
+      nas_decode_arena_release(&arena);
       ue_id = msg->u.data.ue_id;
-      break;
+    } break;
 
-    case _EMMAS_ESTABLISH_REQ:
-      rc = emm_as_establish_req(&msg->u.establish, &emm_cause);
+    case _EMMAS_ESTABLISH_REQ: {
+      nas_decode_arena_t arena;
+      nas_decode_arena_init(&arena);
+      rc = emm_as_establish_req(&msg->u.establish, &emm_cause, &arena);
+      nas_decode_arena_release(&arena);
       ue_id = msg->u.establish.ue_id;
-      break;
+    } break;
 
     case _EMMAS_RELEASE_IND:
       rc = emm_as_release_ind(&msg->u.release, &emm_cause);
@@ -275,6 +288,7 @@ status_code_e emm_as_send(emm_as_t* msg) {
  ** Inputs:  ue_id:      UE lower layer identifier                  **
  **      msg:       The EMM message to process                 **
  **      len:       The length of the EMM message              **
+ **      arena:     Arena the decoded IEs are borrowed from    **
  **      Others:    None                                       **
  **                                                                        **
  ** Outputs:     emm_cause: EMM cause code                             **
@@ -285,7 +299,8 @@ status_code_e emm_as_send(emm_as_t* msg) {
 static int emm_as_recv(mme_ue_s1ap_id_t ue_id, tai_t const* originating_tai,
                        ecgi_t const* originating_ecgi, bstring msg, size_t len,
                        int* emm_cause,
-                       nas_message_decode_status_t* decode_status) {
+                       nas_message_decode_status_t* decode_status,
+                       nas_decode_arena_t* arena) {
   OAILOG_FUNC_IN(LOG_NAS_EMM);
   nas_message_decode_status_t local_decode_status = {0};
   int decoder_rc = RETURNok;
@@ -337,8 +352,8 @@ static int emm_as_recv(mme_ue_s1ap_id_t ue_id, tai_t const* originating_tai,
   /*
    * Decode the received message
    */
-  decoder_rc = nas_message_decode(msg->data, &nas_msg, len,
-                                  emm_security_context, decode_status);
+  decoder_rc = nas_message_decode_borrowed(
+      msg->data, &nas_msg, len, emm_security_context, decode_status, arena);
 
   if (decoder_rc < 0) {
     OAILOG_ERROR(LOG_NAS_EMM,
@@ -609,6 +624,7 @@ static int emm_as_recv(mme_ue_s1ap_id_t ue_id, tai_t const* originating_tai,
  ** EMMAS-SAP - AS->EMM: DATA_IND - Data transfer procedure                **
  **                                                                        **
  ** Inputs:  msg:       The EMMAS-SAP primitive to process         **
+ **      arena:     Arena the decoded IEs are borrowed from    **
  **      Others:    None                                       **
  **                                                                        **
  ** Outputs:     emm_cause: EMM cause code                             **
@@ -616,7 +632,8 @@ static int emm_as_recv(mme_ue_s1ap_id_t ue_id, tai_t const* originating_tai,
  **      Others:    None                                       **
  **                                                                        **
  ***************************************************************************/
-static int emm_as_data_ind(emm_as_data_t* msg, int* emm_cause) {
+static int emm_as_data_ind(emm_as_data_t* msg, int* emm_cause,
+                           nas_decode_arena_t* arena) {
   OAILOG_FUNC_IN(LOG_NAS_EMM);
   int rc = RETURNerror;
 
@@ -631,7 +648,8 @@ static int emm_as_data_ind(emm_as_data_t* msg, int* emm_cause) {
       /*
        * Process the received NAS message
        */
-      bstring plain_msg = bstrcpy(msg->nas_msg);
+      bstring plain_msg = nas_decode_arena_copy(arena, msg->nas_msg->data,
+                                                blength(msg->nas_msg));
 
       if (plain_msg) {
         nas_message_security_header_t header = {0};
@@ -686,14 +704,12 @@ static int emm_as_data_ind(emm_as_data_t* msg, int* emm_cause) {
           memcpy(&originating_tai, msg->tai, sizeof(originating_tai));
 
           rc = emm_as_recv(msg->ue_id, &originating_tai, &msg->ecgi, plain_msg,
-                           bytes, emm_cause, &decode_status);
+                           bytes, emm_cause, &decode_status, arena);
         } else if (header.protocol_discriminator ==
                    EPS_SESSION_MANAGEMENT_MESSAGE) {
           /*
            * Foward ESM data to EPS session management
            */
-          // shrink plain_msg
-          btrunc(plain_msg, bytes);
           rc = lowerlayer_data_ind(msg->ue_id, plain_msg);
         }
 
@@ -730,6 +746,7 @@ static int emm_as_data_ind(emm_as_data_t* msg, int* emm_cause) {
  **     message from the UE.                                       **
  **                                                                        **
  ** Inputs:  msg:       The EMMAS-SAP primitive to process         **
+ **      arena:     Arena the decoded IEs are borrowed from    **
  **      Others:    None                                       **
  **                                                                        **
  ** Outputs:     emm_cause: EMM cause code                             **
@@ -737,7 +754,8 @@ static int emm_as_data_ind(emm_as_data_t* msg, int* emm_cause) {
  **      Others:    None                                       **
  **                                                                        **
  ***************************************************************************/
-static int emm_as_establish_req(emm_as_establish_t* msg, int* emm_cause) {
+static int emm_as_establish_req(emm_as_establish_t* msg, int* emm_cause,
+                                nas_decode_arena_t* arena) {
   OAILOG_FUNC_IN(LOG_NAS_EMM);
   struct emm_context_s* emm_ctx = NULL;
   emm_security_context_t* emm_security_context = NULL;
@@ -777,9 +795,9 @@ static int emm_as_establish_req(emm_as_establish_t* msg, int* emm_cause) {
                "EMMAS-SAP - Decoding Initial NAS message for ue_id "
                "= " MME_UE_S1AP_ID_FMT,
                msg->ue_id);
-  decoder_rc =
-      nas_message_decode(msg->nas_msg->data, &nas_msg, blength(msg->nas_msg),
-                         emm_security_context, &decode_status);
+  decoder_rc = nas_message_decode_borrowed(
+      msg->nas_msg->data, &nas_msg, blength(msg->nas_msg), emm_security_context,
+      &decode_status, arena);
   bdestroy_wrapper(&msg->nas_msg);
 
   // TODO conditional IE error
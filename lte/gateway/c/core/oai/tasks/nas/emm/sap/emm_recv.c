@@ -25,6 +25,7 @@
 #include "lte/gateway/c/core/oai/tasks/nas/emm/sap/emm_recv.h"
 #include "lte/gateway/c/core/oai/common/common_defs.h"
 #include "lte/gateway/c/core/oai/common/dynamic_memory_check.h"
+#include "lte/gateway/c/core/oai/common/nas_decode_arena.h"
 #include "lte/gateway/c/core/oai/common/log.h"
 #include "lte/gateway/c/core/oai/tasks/nas/emm/msg/AttachRequest.h"
 #include "lte/gateway/c/core/oai/tasks/nas/emm/msg/emm_cause.h"
@@ -33,6 +34,7 @@
 #include "lte/gateway/c/core/oai/tasks/nas/emm/sap/emm_sap.h"
 #include "orc8r/gateway/c/common/service303/includes/MetricsHelpers.h"
 #include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_itti_messaging.h"
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_overload.h"
 #include "lte/gateway/c/core/oai/common/conversions.h"
 #include "lte/gateway/c/core/oai/lib/3gpp/3gpp_24.301.h"
 #include "lte/gateway/c/core/oai/tasks/nas/ies/AdditionalUpdateType.h"
@@ -58,8 +60,6 @@
 /****************************************************************************/
 extern long mme_app_last_msg_latency;
 extern long pre_mme_task_msg_latency;
-extern bool mme_congestion_control_enabled;
-extern mme_congestion_params_t mme_congestion_params;
 
 /****************************************************************************/
 /*******************  L O C A L    D E F I N I T I O N S  *******************/
@@ -73,6 +73,8 @@ extern mme_congestion_params_t mme_congestion_params;
 /*********************  L O C A L    F U N C T I O N S  *********************/
 /****************************************************************************/
 static int emm_initiate_default_bearer_re_establishment(emm_context_t* emm_ctx);
+static bool emm_recv_overload_admit(mme_ue_s1ap_id_t ue_id,
+                                    mme_overload_proc_t proc);
 /*
    --------------------------------------------------------------------------
    Functions executed by both the UE and the MME upon receiving EMM messages
@@ -217,11 +219,7 @@ status_code_e emm_recv_attach_request(
   /*
    * Handle MME congestion if it's enabled
    */
-  // Currently a simple logic, when a more complex logic added
-  // refactor this part via helper functions is_mme_congested.
-  if (mme_congestion_control_enabled &&
-      (mme_app_last_msg_latency + pre_mme_task_msg_latency >
-       MME_APP_ZMQ_LATENCY_CONGEST_TH)) {
+  if (!emm_recv_overload_admit(ue_id, MME_OVERLOAD_PROC_ATTACH)) {
     OAILOG_WARNING(
         LOG_NAS_EMM,
         "EMMAS-SAP - Sending Attach Reject for ue_id = (%08x), emm_cause = "
@@ -412,8 +410,8 @@ status_code_e emm_recv_attach_request(
     bdestroy_wrapper(&msg->supportedcodecs);
   }
 
-  params->esm_msg = msg->esmmessagecontainer;
-  msg->esmmessagecontainer = NULL;
+  // Outlives the message in the attach procedure
+  params->esm_msg = nas_decode_bstring_own(&msg->esmmessagecontainer);
 
   params->decode_status = *decode_status;
 
@@ -564,6 +562,8 @@ status_code_e emm_recv_detach_request(
   params.is_native_sc =
       (msg->naskeysetidentifier.tsc != NAS_KEY_SET_IDENTIFIER_MAPPED);
   params.ksi = msg->naskeysetidentifier.naskeysetidentifier;
+  // Detach is never shed, it is only accounted for in the offered load
+  emm_recv_overload_admit(ue_id, MME_OVERLOAD_PROC_DETACH);
   /*
    * Execute the UE initiated detach procedure completion by the network
    */
@@ -614,6 +614,16 @@ status_code_e emm_recv_tracking_area_update_request(
    * TODO - Add support for re-auth during TAU , Implicit GUTI Re-allocation &
    * TAU Complete, TAU due to change in TAs, optional IEs
    */
+  if (!emm_recv_overload_admit(ue_id, MME_OVERLOAD_PROC_TAU)) {
+    OAILOG_WARNING(LOG_NAS_EMM,
+                   "EMMAS-SAP - Sending TAU Reject for ue_id "
+                   "= " MME_UE_S1AP_ID_FMT ", emm_cause = "
+                   "(EMM_CAUSE_CONGESTION)\n",
+                   ue_id);
+    rc = emm_proc_tracking_area_update_reject(ue_id, EMM_CAUSE_CONGESTION);
+    *emm_cause = EMM_CAUSE_SUCCESS;
+    OAILOG_FUNC_RETURN(LOG_NAS_EMM, rc);
+  }
 
   emm_tau_request_ies_t* ies = calloc(1, sizeof(emm_tau_request_ies_t));
   ies->is_initial = is_initial;
@@ -700,8 +710,7 @@ status_code_e emm_recv_tracking_area_update_request(
   if (msg->presencemask &
       TRACKING_AREA_UPDATE_REQUEST_SUPPORTED_CODECS_PRESENT) {
     ies->supported_codecs = calloc(1, sizeof(*ies->supported_codecs));
-    memcpy(ies->supported_codecs, &msg->supportedcodecs,
-           sizeof(*ies->supported_codecs));
+    *ies->supported_codecs = nas_decode_bstring_own(&msg->supportedcodecs);
   }
   if (msg->presencemask &
       TRACKING_AREA_UPDATE_REQUEST_ADDITIONAL_UPDATE_TYPE_PRESENT) {
@@ -759,6 +768,19 @@ status_code_e emm_recv_service_request(
       (decode_status->mac_matched) ? "yes" : "no",
       (decode_status->ciphered_message) ? "yes" : "no");
 
+  if (!emm_recv_overload_admit(ue_id, MME_OVERLOAD_PROC_SERVICE_REQUEST)) {
+    OAILOG_WARNING(LOG_NAS_EMM,
+                   "EMMAS-SAP - Sending Service Reject for ue_id "
+                   "= " MME_UE_S1AP_ID_FMT ", emm_cause = "
+                   "(EMM_CAUSE_CONGESTION)\n",
+                   ue_id);
+    rc = emm_proc_service_reject(ue_id, EMM_CAUSE_CONGESTION);
+    increment_counter("service_request", 1, 2, "result", "failure", "cause",
+                      "congestion");
+    *emm_cause = EMM_CAUSE_SUCCESS;
+    OAILOG_FUNC_RETURN(LOG_NAS_EMM, rc);
+  }
+
   // Get emm_ctx
   emm_ctx = emm_context_get(&_emm_data, ue_id);
 
@@ -1331,6 +1353,18 @@ status_code_e emm_recv_uplink_nas_transport(
   /*
    * Execute the uplink nas transport procedure completion
    */
-  rc = emm_proc_uplink_nas_transport(ue_id, msg->nasmessagecontainer);
+  // The container is handed over to the SGs task
+  rc = emm_proc_uplink_nas_transport(
+      ue_id, nas_decode_bstring_own(&msg->nasmessagecontainer));
   OAILOG_FUNC_RETURN(LOG_NAS_EMM, rc);
 }
+
+//-------------------------------------------------------------------------------------
+static bool emm_recv_overload_admit(mme_ue_s1ap_id_t ue_id,
+                                    mme_overload_proc_t proc) {
+  // Admission is per eNB, keyed by the association the UE is served on
+  ue_mm_context_t* ue_mm_context = mme_ue_context_exists_mme_ue_s1ap_id(ue_id);
+  sctp_assoc_id_t assoc_id =
+      ue_mm_context ? ue_mm_context->sctp_assoc_id_key : 0;
+  return mme_app_overload_admit(assoc_id, proc, mme_app_overload_now_us());
+}
@@ -20,6 +20,7 @@
 
 #include "lte/gateway/c/core/oai/common/log.h"
 #include "lte/gateway/c/core/oai/common/dynamic_memory_check.h"
+#include "lte/gateway/c/core/oai/common/nas_decode_arena.h"
 #include "lte/gateway/c/core/oai/common/common_types.h"
 #include "lte/gateway/c/core/oai/lib/3gpp/3gpp_24.007.h"
 #include "lte/gateway/c/core/oai/lib/3gpp/3gpp_24.008.h"
@@ -251,6 +252,8 @@ esm_cause_t esm_recv_pdn_connectivity_request(
    */
   if (msg->presencemask & PDN_CONNECTIVITY_REQUEST_ACCESS_POINT_NAME_PRESENT) {
     if (esm_data->apn) bdestroy_wrapper(&esm_data->apn);
+    // Kept in the ESM procedure data beyond the message
+    msg->accesspointname = nas_decode_bstring_own(&msg->accesspointname);
     if (mme_config.nas_config.enable_apn_correction) {
       esm_data->apn = mme_app_process_apn_correction(&(emm_context->_imsi),
                                                      msg->accesspointname);
@@ -41,6 +41,7 @@
 #include "lte/gateway/c/core/oai/tasks/nas/emm/emm_data.h"
 #include "lte/gateway/c/core/oai/include/mme_config.h"
 #include "lte/gateway/c/core/oai/common/dynamic_memory_check.h"
+#include "lte/gateway/c/core/oai/common/nas_decode_arena.h"
 
 /****************************************************************************/
 /****************  E X T E R N A L    D E F I N I T I O N S  ****************/
@@ -330,14 +331,19 @@ static int esm_sap_recv(int msg_type, unsigned int ue_id, bool is_standalone,
   int rc = RETURNerror;
   int decoder_rc;
   ESM_msg esm_msg;
+  nas_decode_arena_t arena;
 
   memset(&esm_msg, 0, sizeof(ESM_msg));
   /*
-   * Decode the received ESM message
+   * Decode the received ESM message, its variable length IEs are borrowed
+   * from req and the arena until the message has been processed
    */
 
   OAILOG_DEBUG(LOG_NAS_ESM, "ESM-SAP   - Decoding ESM Message \n");
+  nas_decode_arena_init(&arena);
+  nas_decode_arena_enter(&arena);
   decoder_rc = esm_msg_decode(&esm_msg, (uint8_t*)bdata(req), blength(req));
+  nas_decode_arena_leave(&arena);
 
   /*
    * Process decoding errors
@@ -357,6 +363,7 @@ static int esm_sap_recv(int msg_type, unsigned int ue_id, bool is_standalone,
        * Return indication that received message has been discarded
        */
       *err = ESM_SAP_DISCARDED;
+      nas_decode_arena_release(&arena);
       OAILOG_FUNC_RETURN(LOG_NAS_ESM, RETURNok);
     }
     /*
@@ -505,6 +512,7 @@ static int esm_sap_recv(int msg_type, unsigned int ue_id, bool is_standalone,
               attach_proc->esm_msg_out = blk2bstr(emm_cn_sap_buffer, size);
               attach_proc->emm_cause = EMM_CAUSE_ESM_FAILURE;
             }
+            nas_decode_arena_release(&arena);
             OAILOG_FUNC_RETURN(LOG_NAS_ESM, RETURNerror);
           }
         }
@@ -673,6 +681,7 @@ static int esm_sap_recv(int msg_type, unsigned int ue_id, bool is_standalone,
            * receiving delete session response from SGW
            */
           emm_context->esm_ctx.is_pdn_disconnect = true;
+          nas_decode_arena_release(&arena);
           OAILOG_FUNC_RETURN(LOG_NAS_ESM, RETURNok);
         }
 
@@ -791,6 +800,7 @@ static int esm_sap_recv(int msg_type, unsigned int ue_id, bool is_standalone,
     *err = ESM_SAP_DISCARDED;
     rc = RETURNok;
   }
+  nas_decode_arena_release(&arena);
   bdestroy_wrapper(&rsp);
   OAILOG_FUNC_RETURN(LOG_NAS_ESM, rc);
 }
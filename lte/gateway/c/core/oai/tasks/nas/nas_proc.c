@@ -59,6 +59,7 @@
 #include "lte/gateway/c/core/oai/tasks/nas/nas_procedures.h"
 #include "orc8r/gateway/c/common/service303/includes/MetricsHelpers.h"
 #include "lte/gateway/c/core/oai/include/sgs_messages_types.h"
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_auth_vector_cache.h"
 
 /****************************************************************************/
 /****************  E X T E R N A L    D E F I N I T I O N S  ****************/
@@ -383,6 +384,10 @@ status_code_e nas_proc_authentication_info_answer(
     OAILOG_DEBUG_UE(LOG_NAS_EMM, imsi64,
                     "INFORMING NAS ABOUT AUTH RESP SUCCESS got %u vector(s)\n",
                     aia->auth_info.nb_of_vectors);
+    // Older cached vectors of the IMSI are stale now, stock fresher ones
+    mme_app_auth_vector_cache_fresh_vectors(
+        imsi64, aia->imsi_length, &emm_ctxt_p->originating_tai.plmn,
+        mme_app_auth_vector_cache_now_sec());
     rc = nas_proc_auth_param_res(mme_ue_s1ap_id, aia->auth_info.nb_of_vectors,
                                  aia->auth_info.eutran_vector);
   } else {
@@ -414,6 +419,26 @@ status_code_e nas_proc_authentication_info_answer(
   OAILOG_FUNC_RETURN(LOG_NAS_EMM, rc);
 }
 
+//-----------------------------------------------------------------------------
+void nas_proc_auth_vector_prefetch_answer(const s6a_auth_info_ans_t* aia) {
+  imsi64_t imsi64 = INVALID_IMSI64;
+  uint8_t nb_of_vectors = 0;
+  OAILOG_FUNC_IN(LOG_NAS_EMM);
+
+  IMSI_STRING_TO_IMSI64((char*)aia->imsi, &imsi64);
+  if ((aia->result.present == S6A_RESULT_BASE) &&
+      (aia->result.choice.base == DIAMETER_SUCCESS)) {
+    nb_of_vectors = aia->auth_info.nb_of_vectors;
+  }
+  OAILOG_DEBUG_UE(LOG_NAS_EMM, imsi64,
+                  "Received %u prefetched authentication vector(s)\n",
+                  nb_of_vectors);
+  mme_app_auth_vector_cache_prefetch_answer(
+      imsi64, aia->prefetch_seq, nb_of_vectors, aia->auth_info.eutran_vector,
+      mme_app_auth_vector_cache_now_sec());
+  OAILOG_FUNC_OUT(LOG_NAS_EMM);
+}
+
 //------------------------------------------------------------------------------
 status_code_e nas_proc_auth_param_res(mme_ue_s1ap_id_t ue_id,
                                       uint8_t nb_vectors,
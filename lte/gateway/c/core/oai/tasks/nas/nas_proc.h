@@ -107,6 +107,7 @@ status_code_e nas_proc_ul_transfer_ind(const mme_ue_s1ap_id_t ueid,
  */
 status_code_e nas_proc_authentication_info_answer(
     mme_app_desc_t* mme_app_desc_p, s6a_auth_info_ans_t* ans);
+void nas_proc_auth_vector_prefetch_answer(const s6a_auth_info_ans_t* ans);
 status_code_e nas_proc_auth_param_res(mme_ue_s1ap_id_t ue_id,
                                       uint8_t nb_vectors,
                                       eutran_vector_t* vectors);
@@ -36,6 +36,7 @@
 #include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_mme_handlers.h"
 #include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_mme_nas_procedures.h"
 #include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_mme_itti_messaging.h"
+#include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_paging_index.h"
 #include "orc8r/gateway/c/common/service303/includes/MetricsHelpers.h"
 #include "lte/gateway/c/core/oai/lib/message_utils/service303_message_utils.h"
 #include "lte/gateway/c/core/oai/common/dynamic_memory_check.h"
@@ -246,6 +247,13 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
       }
     } break;
 
+    case S1AP_MME_OVERLOAD_IND: {
+      is_task_state_same = true;  // the following handler does not modify state
+      is_ue_state_same = true;
+      s1ap_handle_mme_overload_ind(state,
+                                   &S1AP_MME_OVERLOAD_IND(received_message_p));
+    } break;
+
     case S1AP_UE_CONTEXT_MODIFICATION_REQUEST: {
       is_task_state_same = true;  // the following handler does not modify state
       is_ue_state_same = true;
@@ -553,6 +561,7 @@ void s1ap_remove_enb(s1ap_state_t* state, enb_description_t* enb_ref) {
     return;
   }
   enb_ref->s1_state = S1AP_INIT;
+  s1ap_paging_index_remove_enb(enb_ref->sctp_assoc_id);
   hashtable_uint64_ts_destroy(&enb_ref->ue_id_coll);
   hashtable_ts_free(&state->enbs, enb_ref->sctp_assoc_id);
   state->num_enbs--;
@@ -97,6 +97,8 @@ static inline int s1ap_mme_encode_initiating(S1ap_S1AP_PDU_t* pdu,
     case S1ap_ProcedureCode_id_MMEConfigurationTransfer:
     case S1ap_ProcedureCode_id_HandoverPreparation:
     case S1ap_ProcedureCode_id_UEContextModification:
+    case S1ap_ProcedureCode_id_OverloadStart:
+    case S1ap_ProcedureCode_id_OverloadStop:
       break;
 
     default:
@@ -133,6 +135,7 @@ static inline int s1ap_mme_encode_successfull_outcome(S1ap_S1AP_PDU_t* pdu,
     case S1ap_ProcedureCode_id_HandoverCancel:
     case S1ap_ProcedureCode_id_Reset:
     case S1ap_ProcedureCode_id_E_RABModificationIndication:
+    case S1ap_ProcedureCode_id_ENBConfigurationUpdate:
       break;
 
     default:
@@ -166,6 +169,7 @@ static inline int s1ap_mme_encode_unsuccessfull_outcome(S1ap_S1AP_PDU_t* pdu,
     case S1ap_ProcedureCode_id_S1Setup:
     case S1ap_ProcedureCode_id_PathSwitchRequest:
     case S1ap_ProcedureCode_id_HandoverPreparation:
+    case S1ap_ProcedureCode_id_ENBConfigurationUpdate:
       break;
 
     default:
@@ -45,6 +45,7 @@
 #include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_mme.h"
 #include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_mme_ta.h"
 #include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_mme_handlers.h"
+#include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_paging_index.h"
 #include "lte/gateway/c/core/oai/include/mme_events.h"
 #include "lte/gateway/c/core/oai/lib/3gpp/3gpp_23.003.h"
 #include "lte/gateway/c/core/oai/lib/3gpp/3gpp_36.401.h"
@@ -106,6 +107,16 @@ status_code_e s1ap_generate_s1_setup_response(
 
 bool is_all_erabId_same(S1ap_PathSwitchRequest_t* container);
 
+static status_code_e s1ap_send_mme_overload(
+    s1ap_state_t* state, const itti_s1ap_mme_overload_ind_t* overload_ind,
+    sctp_assoc_id_t assoc_id);
+
+static void s1ap_mme_store_supported_tas(const S1ap_SupportedTAs_t* ta_list,
+                                         supported_ta_list_t* supp_ta_list);
+
+// Last overload indication from MME_APP, replayed to eNBs that set up later
+static itti_s1ap_mme_overload_ind_t s1ap_mme_overload = {0};
+
 /* Handlers matrix. Only mme related procedures present here.
  */
 s1ap_message_handler_t message_handlers[][3] = {
@@ -145,7 +156,8 @@ s1ap_message_handler_t message_handlers[][3] = {
     {0, 0, 0},                                        /* DeactivateTrace */
     {0, 0, 0},                                        /* TraceStart */
     {0, 0, 0}, /* TraceFailureIndication */
-    {0, 0, 0}, /* ENBConfigurationUpdate */
+    {s1ap_mme_handle_enb_configuration_update, 0,
+     0},       /* ENBConfigurationUpdate */
     {0, 0, 0}, /* MMEConfigurationUpdate */
     {0, 0, 0}, /* LocationReportingControl */
     {0, 0, 0}, /* LocationReportingFailureIndication */
@@ -396,15 +408,32 @@ void clean_stale_enb_state(s1ap_state_t* state,
   hashtable_key_array_t* keys =
       hashtable_uint64_ts_get_keys(&stale_enb_association->ue_id_coll);
   if (keys != NULL) {
-    ue_description_t* ue_ref = NULL;
+    /* ue_id_coll maps each mme_ue_s1ap_id of the eNB to the key of its UE in
+     * the S1AP UE state, so the UEs are looked up directly rather than with a
+     * scan of all UEs per UE. The keys are resolved before any removal since
+     * removing the last UE also frees the eNB and its collection.
+     */
+    hash_table_ts_t* s1ap_ue_state = get_s1ap_ue_state();
+    uint64_t* comp_s1ap_ids = calloc(keys->num_keys, sizeof(uint64_t));
+    int num_ues = 0;
     for (int i = 0; i < keys->num_keys; i++) {
-      ue_ref = s1ap_state_get_ue_mmeid((mme_ue_s1ap_id_t)keys->keys[i]);
+      if (hashtable_uint64_ts_get(&stale_enb_association->ue_id_coll,
+                                  keys->keys[i],
+                                  &comp_s1ap_ids[num_ues]) == HASH_TABLE_OK) {
+        num_ues++;
+      }
+    }
+    FREE_HASHTABLE_KEY_ARRAY(keys);
+    for (int i = 0; i < num_ues; i++) {
+      ue_description_t* ue_ref = NULL;
+      hashtable_ts_get(s1ap_ue_state, (const hash_key_t)comp_s1ap_ids[i],
+                       (void**)&ue_ref);
       /* The function s1ap_remove_ue will take care of removing the enb also,
        * when the last UE is removed
        */
       s1ap_remove_ue(state, ue_ref);
     }
-    FREE_HASHTABLE_KEY_ARRAY(keys);
+    free_wrapper((void**)&comp_s1ap_ids);
   } else {
     // Remove the old eNB association
     OAILOG_INFO(LOG_S1AP, "Deleting eNB: %s (Sctp_assoc_id = %u)",
@@ -432,7 +461,6 @@ status_code_e s1ap_mme_handle_s1_setup_request(s1ap_state_t* state,
   uint32_t enb_id = 0;
   char* enb_name = NULL;
   int ta_ret = 0;
-  uint8_t bplmn_list_count = 0;  // Broadcast PLMN list count
 
   OAILOG_FUNC_IN(LOG_S1AP);
   increment_counter("s1_setup", 1, NO_LABELS);
@@ -603,31 +631,9 @@ status_code_e s1ap_mme_handle_s1_setup_request(s1ap_state_t* state,
     OAILOG_FUNC_RETURN(LOG_S1AP, rc);
   }
 
-  S1ap_SupportedTAs_t* ta_list = &ie_supported_tas->value.choice.SupportedTAs;
-  supported_ta_list_t* supp_ta_list = &enb_association->supported_ta_list;
-  supp_ta_list->list_count = ta_list->list.count;
-
   /* Storing supported TAI lists received in S1 SETUP REQUEST message */
-  for (int tai_idx = 0; tai_idx < supp_ta_list->list_count; tai_idx++) {
-    S1ap_SupportedTAs_Item_t* tai = NULL;
-    tai = ta_list->list.array[tai_idx];
-    OCTET_STRING_TO_TAC(&tai->tAC,
-                        supp_ta_list->supported_tai_items[tai_idx].tac);
-
-    bplmn_list_count = tai->broadcastPLMNs.list.count;
-    if (bplmn_list_count > S1AP_MAX_BROADCAST_PLMNS) {
-      OAILOG_ERROR(LOG_S1AP,
-                   "Maximum Broadcast PLMN list count exceeded, count = %d\n",
-                   bplmn_list_count);
-    }
-    supp_ta_list->supported_tai_items[tai_idx].bplmnlist_count =
-        bplmn_list_count;
-    for (int plmn_idx = 0; plmn_idx < bplmn_list_count; plmn_idx++) {
-      TBCD_TO_PLMN_T(
-          tai->broadcastPLMNs.list.array[plmn_idx],
-          &supp_ta_list->supported_tai_items[tai_idx].bplmns[plmn_idx]);
-    }
-  }
+  s1ap_mme_store_supported_tas(&ie_supported_tas->value.choice.SupportedTAs,
+                               &enb_association->supported_ta_list);
   OAILOG_DEBUG(LOG_S1AP,
                "Adding eNB with enb_id :%d to the list of served eNBs \n",
                enb_id);
@@ -657,10 +663,50 @@ status_code_e s1ap_mme_handle_s1_setup_request(s1ap_state_t* state,
     set_gauge("s1_connection", 1, 1, "enb_name", enb_association->enb_name);
     increment_counter("s1_setup", 1, 1, "result", "success");
     s1_setup_success_event(enb_name, enb_id);
+    s1ap_paging_index_update_enb(enb_association);
+    if (s1ap_mme_overload.overload_start) {
+      s1ap_send_mme_overload(state, &s1ap_mme_overload,
+                             enb_association->sctp_assoc_id);
+    }
   }
   OAILOG_FUNC_RETURN(LOG_S1AP, rc);
 }
 
+//------------------------------------------------------------------------------
+// Stores the Supported TAs of an S1 Setup Request or eNB Configuration Update
+static void s1ap_mme_store_supported_tas(const S1ap_SupportedTAs_t* ta_list,
+                                         supported_ta_list_t* supp_ta_list) {
+  int list_count = ta_list->list.count;
+  if (list_count > S1AP_MAX_TAI_ITEMS) {
+    OAILOG_ERROR(LOG_S1AP, "Maximum TAI list count exceeded, count = %d\n",
+                 list_count);
+    list_count = S1AP_MAX_TAI_ITEMS;
+  }
+  supp_ta_list->list_count = list_count;
+
+  for (int tai_idx = 0; tai_idx < list_count; tai_idx++) {
+    S1ap_SupportedTAs_Item_t* tai = NULL;
+    tai = ta_list->list.array[tai_idx];
+    OCTET_STRING_TO_TAC(&tai->tAC,
+                        supp_ta_list->supported_tai_items[tai_idx].tac);
+
+    int bplmn_list_count = tai->broadcastPLMNs.list.count;
+    if (bplmn_list_count > S1AP_MAX_BROADCAST_PLMNS) {
+      OAILOG_ERROR(LOG_S1AP,
+                   "Maximum Broadcast PLMN list count exceeded, count = %d\n",
+                   bplmn_list_count);
+      bplmn_list_count = S1AP_MAX_BROADCAST_PLMNS;
+    }
+    supp_ta_list->supported_tai_items[tai_idx].bplmnlist_count =
+        bplmn_list_count;
+    for (int plmn_idx = 0; plmn_idx < bplmn_list_count; plmn_idx++) {
+      TBCD_TO_PLMN_T(
+          tai->broadcastPLMNs.list.array[plmn_idx],
+          &supp_ta_list->supported_tai_items[tai_idx].bplmns[plmn_idx]);
+    }
+  }
+}
+
 //------------------------------------------------------------------------------
 status_code_e s1ap_generate_s1_setup_response(
     s1ap_state_t* state, enb_description_t* enb_association) {
@@ -776,6 +822,158 @@ status_code_e s1ap_generate_s1_setup_response(
   OAILOG_FUNC_RETURN(LOG_S1AP, rc);
 }
 
+//------------------------------------------------------------------------------
+static status_code_e s1ap_mme_generate_enb_configuration_update_ack(
+    const sctp_assoc_id_t assoc_id) {
+  uint8_t* buffer_p = NULL;
+  uint32_t length = 0;
+  S1ap_S1AP_PDU_t pdu;
+
+  OAILOG_FUNC_IN(LOG_S1AP);
+
+  memset(&pdu, 0, sizeof(pdu));
+  pdu.present = S1ap_S1AP_PDU_PR_successfulOutcome;
+  pdu.choice.successfulOutcome.procedureCode =
+      S1ap_ProcedureCode_id_ENBConfigurationUpdate;
+  pdu.choice.successfulOutcome.criticality = S1ap_Criticality_reject;
+  pdu.choice.successfulOutcome.value.present =
+      S1ap_SuccessfulOutcome__value_PR_ENBConfigurationUpdateAcknowledge;
+
+  if (s1ap_mme_encode_pdu(&pdu, &buffer_p, &length) < 0) {
+    OAILOG_ERROR(LOG_S1AP,
+                 "Failed to encode eNB configuration update acknowledge\n");
+    OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
+  }
+
+  bstring b = blk2bstr(buffer_p, (int)length);
+  free(buffer_p);
+  OAILOG_FUNC_RETURN(
+      LOG_S1AP, s1ap_mme_itti_send_sctp_request(&b, assoc_id, 0,
+                                                INVALID_MME_UE_S1AP_ID));
+}
+
+//------------------------------------------------------------------------------
+static status_code_e s1ap_mme_generate_enb_configuration_update_failure(
+    const sctp_assoc_id_t assoc_id, const S1ap_Cause_PR cause_type,
+    const long cause_value, const long time_to_wait) {
+  uint8_t* buffer_p = NULL;
+  uint32_t length = 0;
+  S1ap_S1AP_PDU_t pdu;
+  S1ap_ENBConfigurationUpdateFailure_t* out;
+  S1ap_ENBConfigurationUpdateFailureIEs_t* ie = NULL;
+
+  OAILOG_FUNC_IN(LOG_S1AP);
+
+  memset(&pdu, 0, sizeof(pdu));
+  pdu.present = S1ap_S1AP_PDU_PR_unsuccessfulOutcome;
+  pdu.choice.unsuccessfulOutcome.procedureCode =
+      S1ap_ProcedureCode_id_ENBConfigurationUpdate;
+  pdu.choice.unsuccessfulOutcome.criticality = S1ap_Criticality_reject;
+  pdu.choice.unsuccessfulOutcome.value.present =
+      S1ap_UnsuccessfulOutcome__value_PR_ENBConfigurationUpdateFailure;
+  out = &pdu.choice.unsuccessfulOutcome.value.choice
+             .ENBConfigurationUpdateFailure;
+
+  ie = (S1ap_ENBConfigurationUpdateFailureIEs_t*)calloc(
+      1, sizeof(S1ap_ENBConfigurationUpdateFailureIEs_t));
+  ie->id = S1ap_ProtocolIE_ID_id_Cause;
+  ie->criticality = S1ap_Criticality_ignore;
+  ie->value.present = S1ap_ENBConfigurationUpdateFailureIEs__value_PR_Cause;
+  s1ap_mme_set_cause(&ie->value.choice.Cause, cause_type, cause_value);
+  ASN_SEQUENCE_ADD(&out->protocolIEs.list, ie);
+
+  if (time_to_wait > -1) {
+    ie = (S1ap_ENBConfigurationUpdateFailureIEs_t*)calloc(
+        1, sizeof(S1ap_ENBConfigurationUpdateFailureIEs_t));
+    ie->id = S1ap_ProtocolIE_ID_id_TimeToWait;
+    ie->criticality = S1ap_Criticality_ignore;
+    ie->value.present =
+        S1ap_ENBConfigurationUpdateFailureIEs__value_PR_TimeToWait;
+    ie->value.choice.TimeToWait = time_to_wait;
+    ASN_SEQUENCE_ADD(&out->protocolIEs.list, ie);
+  }
+
+  if (s1ap_mme_encode_pdu(&pdu, &buffer_p, &length) < 0) {
+    OAILOG_ERROR(LOG_S1AP,
+                 "Failed to encode eNB configuration update failure\n");
+    OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
+  }
+
+  bstring b = blk2bstr(buffer_p, (int)length);
+  free(buffer_p);
+  OAILOG_FUNC_RETURN(
+      LOG_S1AP, s1ap_mme_itti_send_sctp_request(&b, assoc_id, 0,
+                                                INVALID_MME_UE_S1AP_ID));
+}
+
+//------------------------------------------------------------------------------
+status_code_e s1ap_mme_handle_enb_configuration_update(
+    s1ap_state_t* state, const sctp_assoc_id_t assoc_id,
+    const sctp_stream_id_t stream, S1ap_S1AP_PDU_t* pdu) {
+  S1ap_ENBConfigurationUpdate_t* container = NULL;
+  S1ap_ENBConfigurationUpdateIEs_t* ie = NULL;
+  enb_description_t* enb_association = NULL;
+
+  OAILOG_FUNC_IN(LOG_S1AP);
+  container =
+      &pdu->choice.initiatingMessage.value.choice.ENBConfigurationUpdate;
+
+  enb_association = s1ap_state_get_enb(state, assoc_id);
+  if (enb_association == NULL || enb_association->s1_state != S1AP_READY) {
+    OAILOG_ERROR(LOG_S1AP,
+                 "Ignoring eNB configuration update from assoc %u without "
+                 "S1 setup\n",
+                 assoc_id);
+    OAILOG_FUNC_RETURN(LOG_S1AP, RETURNok);
+  }
+
+  S1AP_FIND_PROTOCOLIE_BY_ID(S1ap_ENBConfigurationUpdateIEs_t, ie, container,
+                             S1ap_ProtocolIE_ID_id_SupportedTAs, false);
+  if (ie) {
+    /* Same abnormal condition as for S1 Setup: reject if none of the PLMNs
+     * provided by the eNB is served by the MME, and keep the current TAs.
+     */
+    if (s1ap_mme_compare_ta_lists(&ie->value.choice.SupportedTAs) !=
+        TA_LIST_RET_OK) {
+      OAILOG_ERROR(LOG_S1AP,
+                   "No Common PLMN with eNB on assoc %u, rejecting eNB "
+                   "configuration update\n",
+                   assoc_id);
+      increment_counter("enb_configuration_update", 1, 2, "result", "failure",
+                        "cause", "plmnid_or_tac_mismatch");
+      OAILOG_FUNC_RETURN(
+          LOG_S1AP, s1ap_mme_generate_enb_configuration_update_failure(
+                        assoc_id, S1ap_Cause_PR_misc,
+                        S1ap_CauseMisc_unknown_PLMN, S1ap_TimeToWait_v20s));
+    }
+    s1ap_mme_store_supported_tas(&ie->value.choice.SupportedTAs,
+                                 &enb_association->supported_ta_list);
+    s1ap_paging_index_update_enb(enb_association);
+  }
+
+  S1AP_FIND_PROTOCOLIE_BY_ID(S1ap_ENBConfigurationUpdateIEs_t, ie, container,
+                             S1ap_ProtocolIE_ID_id_eNBname, false);
+  if (ie) {
+    size_t name_size = ie->value.choice.ENBname.size;
+    if (name_size >= sizeof(enb_association->enb_name)) {
+      name_size = sizeof(enb_association->enb_name) - 1;
+    }
+    memcpy(enb_association->enb_name, ie->value.choice.ENBname.buf,
+           name_size);
+    enb_association->enb_name[name_size] = '\0';
+  }
+
+  S1AP_FIND_PROTOCOLIE_BY_ID(S1ap_ENBConfigurationUpdateIEs_t, ie, container,
+                             S1ap_ProtocolIE_ID_id_DefaultPagingDRX, false);
+  if (ie) {
+    enb_association->default_paging_drx = ie->value.choice.PagingDRX;
+  }
+
+  increment_counter("enb_configuration_update", 1, 1, "result", "success");
+  OAILOG_FUNC_RETURN(LOG_S1AP,
+                     s1ap_mme_generate_enb_configuration_update_ack(assoc_id));
+}
+
 //------------------------------------------------------------------------------
 status_code_e s1ap_mme_handle_ue_cap_indication(s1ap_state_t* state,
                                                 __attribute__((unused))
@@ -4354,6 +4552,31 @@ status_code_e s1ap_handle_enb_initiated_reset_ack(
 }
 
 //-------------------------------------------------------------------------------
+typedef struct s1ap_paging_fanout_s {
+  s1ap_state_t* state;
+  shared_buffer_t* payload;
+  uint32_t num_sent;
+  uint32_t num_failed;
+} s1ap_paging_fanout_t;
+
+// Paging index callback, sends the encoded Paging to one eNB
+static void s1ap_send_paging_to_enb(sctp_assoc_id_t assoc_id, void* arg) {
+  s1ap_paging_fanout_t* fanout = (s1ap_paging_fanout_t*)arg;
+  enb_description_t* enb_ref_p = s1ap_state_get_enb(fanout->state, assoc_id);
+  if (enb_ref_p == NULL || enb_ref_p->s1_state != S1AP_READY) {
+    return;
+  }
+  if (s1ap_mme_itti_send_sctp_request_shared(
+          fanout->payload, assoc_id,
+          0,   // Stream id 0 for non UE related S1AP message
+          0)   // mme_ue_s1ap_id 0 because UE in idle
+      == RETURNok) {
+    fanout->num_sent++;
+  } else {
+    fanout->num_failed++;
+  }
+}
+
 status_code_e s1ap_handle_paging_request(
     s1ap_state_t* state, const itti_s1ap_paging_request_t* paging_request,
     imsi64_t imsi64) {
@@ -4367,8 +4590,6 @@ status_code_e s1ap_handle_paging_request(
   uint8_t num_of_tac = 0;
   uint16_t tai_list_count = paging_request->tai_list_count;
 
-  bool is_tai_found = false;
-  uint32_t idx = 0;
   uint8_t* buffer_p = NULL;
   uint32_t length = 0;
   S1ap_S1AP_PDU_t pdu = {0};
@@ -4474,41 +4695,28 @@ status_code_e s1ap_handle_paging_request(
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
 
-  /*Fetching eNB list to send paging request message*/
-  hashtable_element_array_t* enb_array = NULL;
-  enb_description_t* enb_ref_p = NULL;
   if (state == NULL) {
     OAILOG_ERROR(LOG_S1AP, "eNB Information is NULL!\n");
+    free(buffer_p);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
-  enb_array = hashtable_ts_get_elements(&state->enbs);
-  if (enb_array == NULL) {
-    OAILOG_ERROR(LOG_S1AP, "Could not find eNB hashlist!\n");
-    OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
-  }
-  const paging_tai_list_t* p_tai_list = paging_request->paging_tai_list;
-  for (idx = 0; idx < enb_array->num_elements; idx++) {
-    enb_ref_p = (enb_description_t*)enb_array->elements[idx];
-    if (enb_ref_p->s1_state == S1AP_READY) {
-      supported_ta_list_t* enb_ta_list = &enb_ref_p->supported_ta_list;
-
-      if ((is_tai_found = s1ap_paging_compare_ta_lists(
-               enb_ta_list, p_tai_list, paging_request->tai_list_count))) {
-        bstring paging_msg_buffer = blk2bstr(buffer_p, length);
-        rc = s1ap_mme_itti_send_sctp_request(
-            &paging_msg_buffer, enb_ref_p->sctp_assoc_id,
-            0,   // Stream id 0 for non UE related
-                 // S1AP message
-            0);  // mme_ue_s1ap_id 0 because UE in idle
-      }
-    }
-  }
-  free_wrapper((void**)&enb_array->elements);
-  free_wrapper((void**)&enb_array);
-  free(buffer_p);
+  /* The encoded PDU is shared by the SCTP_DATA_REQ of every target eNB and
+   * freed with the last of them.
+   */
+  s1ap_paging_fanout_t fanout = {0};
+  fanout.state = state;
+  fanout.payload = shared_buffer_wrap(buffer_p, length);
+  s1ap_paging_index_lookup(paging_request->paging_tai_list,
+                           paging_request->tai_list_count,
+                           s1ap_send_paging_to_enb, &fanout);
+  shared_buffer_unref(fanout.payload);
+  rc = (fanout.num_failed > 0) ? RETURNerror : RETURNok;
+  increment_counter("s1ap_paging_enbs", fanout.num_sent, NO_LABELS);
   if (rc != RETURNok) {
     OAILOG_ERROR(LOG_S1AP,
-                 "Failed to send paging message over sctp for IMSI %s\n",
+                 "Failed to send paging message over sctp to %u of %u eNBs "
+                 "for IMSI %s\n",
+                 fanout.num_failed, fanout.num_sent + fanout.num_failed,
                  paging_request->imsi);
   } else {
     OAILOG_INFO(LOG_S1AP, "Sent paging message over sctp for IMSI %s\n",
@@ -4518,6 +4726,108 @@ status_code_e s1ap_handle_paging_request(
   OAILOG_FUNC_RETURN(LOG_S1AP, rc);
 }
 
+//------------------------------------------------------------------------------
+// Encodes Overload Start (36.413 8.7.6) or Overload Stop (8.7.7) and sends it
+// to one eNB, or to every eNB in S1AP_READY state when assoc_id is 0
+static status_code_e s1ap_send_mme_overload(
+    s1ap_state_t* state, const itti_s1ap_mme_overload_ind_t* overload_ind,
+    sctp_assoc_id_t assoc_id) {
+  OAILOG_FUNC_IN(LOG_S1AP);
+  S1ap_S1AP_PDU_t pdu = {0};
+  uint8_t* buffer_p = NULL;
+  uint32_t length = 0;
+  int rc = RETURNok;
+
+  pdu.present = S1ap_S1AP_PDU_PR_initiatingMessage;
+  pdu.choice.initiatingMessage.criticality = S1ap_Criticality_ignore;
+  if (overload_ind->overload_start) {
+    pdu.choice.initiatingMessage.procedureCode =
+        S1ap_ProcedureCode_id_OverloadStart;
+    pdu.choice.initiatingMessage.value.present =
+        S1ap_InitiatingMessage__value_PR_OverloadStart;
+    S1ap_OverloadStart_t* out =
+        &pdu.choice.initiatingMessage.value.choice.OverloadStart;
+
+    S1ap_OverloadStartIEs_t* ie = calloc(1, sizeof(S1ap_OverloadStartIEs_t));
+    ie->id = S1ap_ProtocolIE_ID_id_OverloadResponse;
+    ie->criticality = S1ap_Criticality_reject;
+    ie->value.present = S1ap_OverloadStartIEs__value_PR_OverloadResponse;
+    ie->value.choice.OverloadResponse.present =
+        S1ap_OverloadResponse_PR_overloadAction;
+    ie->value.choice.OverloadResponse.choice.overloadAction =
+        S1ap_OverloadAction_reject_rrc_cr_signalling;
+    ASN_SEQUENCE_ADD(&out->protocolIEs.list, ie);
+
+    // Traffic Load Reduction Indication is INTEGER (1..99)
+    uint8_t reduction = overload_ind->traffic_reduction_percent;
+    if (reduction > 0) {
+      ie = calloc(1, sizeof(S1ap_OverloadStartIEs_t));
+      ie->id = S1ap_ProtocolIE_ID_id_TrafficLoadReductionIndication;
+      ie->criticality = S1ap_Criticality_ignore;
+      ie->value.present =
+          S1ap_OverloadStartIEs__value_PR_TrafficLoadReductionIndication;
+      ie->value.choice.TrafficLoadReductionIndication =
+          (reduction > 99) ? 99 : reduction;
+      ASN_SEQUENCE_ADD(&out->protocolIEs.list, ie);
+    }
+  } else {
+    pdu.choice.initiatingMessage.procedureCode =
+        S1ap_ProcedureCode_id_OverloadStop;
+    pdu.choice.initiatingMessage.value.present =
+        S1ap_InitiatingMessage__value_PR_OverloadStop;
+  }
+
+  if (s1ap_mme_encode_pdu(&pdu, &buffer_p, &length) < 0 || length <= 0) {
+    OAILOG_ERROR(LOG_S1AP, "Failed to encode overload %s\n",
+                 overload_ind->overload_start ? "start" : "stop");
+    OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
+  }
+
+  if (assoc_id != 0) {
+    bstring b = blk2bstr(buffer_p, length);
+    rc = s1ap_mme_itti_send_sctp_request(&b, assoc_id, 0, 0);
+    free(buffer_p);
+    OAILOG_FUNC_RETURN(LOG_S1AP, rc);
+  }
+
+  hashtable_element_array_t* enb_array =
+      hashtable_ts_get_elements(&state->enbs);
+  if (enb_array == NULL) {
+    free(buffer_p);
+    OAILOG_FUNC_RETURN(LOG_S1AP, RETURNok);
+  }
+  for (int idx = 0; idx < enb_array->num_elements; idx++) {
+    enb_description_t* enb_ref_p = (enb_description_t*)enb_array->elements[idx];
+    if (enb_ref_p->s1_state != S1AP_READY) {
+      continue;
+    }
+    bstring b = blk2bstr(buffer_p, length);
+    // Stream id 0 for non UE related S1AP message
+    if (s1ap_mme_itti_send_sctp_request(&b, enb_ref_p->sctp_assoc_id, 0, 0) !=
+        RETURNok) {
+      rc = RETURNerror;
+    }
+  }
+  free_wrapper((void**)&enb_array->elements);
+  free_wrapper((void**)&enb_array);
+  free(buffer_p);
+  OAILOG_FUNC_RETURN(LOG_S1AP, rc);
+}
+
+//------------------------------------------------------------------------------
+status_code_e s1ap_handle_mme_overload_ind(
+    s1ap_state_t* state, const itti_s1ap_mme_overload_ind_t* overload_ind) {
+  OAILOG_FUNC_IN(LOG_S1AP);
+  s1ap_mme_overload = *overload_ind;
+  OAILOG_INFO(LOG_S1AP, "Sending overload %s to eNBs, reduction %u%%\n",
+              overload_ind->overload_start ? "start" : "stop",
+              overload_ind->traffic_reduction_percent);
+  increment_counter("s1ap_overload", 1, 1, "action",
+                    overload_ind->overload_start ? "start" : "stop");
+  OAILOG_FUNC_RETURN(LOG_S1AP,
+                     s1ap_send_mme_overload(state, overload_ind, 0));
+}
+
 //------------------------------------------------------------------------------
 status_code_e s1ap_mme_handle_erab_modification_indication(
     s1ap_state_t* state, const sctp_assoc_id_t assoc_id,
@@ -175,6 +175,9 @@ status_code_e s1ap_handle_paging_request(
     s1ap_state_t* state, const itti_s1ap_paging_request_t* paging_request,
     imsi64_t imsi64);
 
+status_code_e s1ap_handle_mme_overload_ind(
+    s1ap_state_t* state, const itti_s1ap_mme_overload_ind_t* overload_ind);
+
 status_code_e s1ap_mme_handle_ue_context_modification_response(
     s1ap_state_t* state, const sctp_assoc_id_t assoc_id,
     const sctp_stream_id_t stream, S1ap_S1AP_PDU_t* message_p);
@@ -192,6 +195,10 @@ status_code_e s1ap_mme_handle_enb_configuration_transfer(
     s1ap_state_t* state, const sctp_assoc_id_t assoc_id,
     const sctp_stream_id_t stream, S1ap_S1AP_PDU_t* message_p);
 
+status_code_e s1ap_mme_handle_enb_configuration_update(
+    s1ap_state_t* state, const sctp_assoc_id_t assoc_id,
+    const sctp_stream_id_t stream, S1ap_S1AP_PDU_t* message_p);
+
 status_code_e s1ap_handle_path_switch_req_ack(
     s1ap_state_t* state,
     const itti_s1ap_path_switch_request_ack_t* path_switch_req_ack_p,
@@ -58,6 +58,27 @@ status_code_e s1ap_mme_itti_send_sctp_request(STOLEN_REF bstring* payload,
   return send_msg_to_task(&s1ap_task_zmq_ctx, TASK_SCTP, message_p);
 }
 
+//------------------------------------------------------------------------------
+status_code_e s1ap_mme_itti_send_sctp_request_shared(
+    shared_buffer_t* payload, const sctp_assoc_id_t assoc_id,
+    const sctp_stream_id_t stream, const mme_ue_s1ap_id_t ue_id) {
+  MessageDef* message_p = NULL;
+
+  message_p = itti_alloc_new_message(TASK_S1AP, SCTP_DATA_REQ);
+  if (message_p == NULL) {
+    OAILOG_ERROR(LOG_S1AP,
+                 "itti_alloc_new_message Failed for"
+                 " SCTP_DATA_REQ \n");
+    OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
+  }
+  SCTP_DATA_REQ(message_p).shared_payload = shared_buffer_ref(payload);
+  SCTP_DATA_REQ(message_p).assoc_id = assoc_id;
+  SCTP_DATA_REQ(message_p).stream = stream;
+  SCTP_DATA_REQ(message_p).agw_ue_xap_id = ue_id;
+  SCTP_DATA_REQ(message_p).ppid = S1AP_SCTP_PPID;
+  return send_msg_to_task(&s1ap_task_zmq_ctx, TASK_SCTP, message_p);
+}
+
 //------------------------------------------------------------------------------
 status_code_e s1ap_mme_itti_nas_uplink_ind(const mme_ue_s1ap_id_t ue_id,
                                            STOLEN_REF bstring* payload,
@@ -37,6 +37,7 @@
 #include "lte/gateway/c/core/oai/include/TrackingAreaIdentity.h"
 #include "lte/gateway/c/core/oai/lib/bstr/bstrlib.h"
 #include "lte/gateway/c/core/oai/common/common_types.h"
+#include "lte/gateway/c/core/oai/common/shared_buffer.h"
 #include "lte/gateway/c/core/oai/lib/itti/intertask_interface.h"
 
 #include "lte/gateway/c/core/oai/include/s1ap_state.h"
@@ -49,6 +50,12 @@ status_code_e s1ap_mme_itti_send_sctp_request(STOLEN_REF bstring* payload,
                                               const sctp_stream_id_t stream,
                                               const mme_ue_s1ap_id_t ue_id);
 
+// Same as above for a PDU sent to several eNBs, the message takes its own
+// reference on payload
+status_code_e s1ap_mme_itti_send_sctp_request_shared(
+    shared_buffer_t* payload, const sctp_assoc_id_t assoc_id,
+    const sctp_stream_id_t stream, const mme_ue_s1ap_id_t ue_id);
+
 status_code_e s1ap_mme_itti_nas_uplink_ind(const mme_ue_s1ap_id_t ue_id,
                                            STOLEN_REF bstring* payload,
                                            const tai_t* const tai,
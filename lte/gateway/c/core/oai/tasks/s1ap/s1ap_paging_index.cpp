@@ -0,0 +1,149 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_paging_index.h"
+
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/log.h"
+}
+
+namespace {
+
+struct PagingIndexEnb {
+  sctp_assoc_id_t assoc_id;
+  std::vector<uint64_t> tais;
+  // Lookup sequence number that last reported this eNB, to report an eNB
+  // serving several of the paged TAIs only once
+  uint64_t last_lookup;
+};
+
+// Entries are referenced by address from tai_to_enbs, which unordered_map
+// keeps stable across rehashes
+std::unordered_map<sctp_assoc_id_t, PagingIndexEnb> enbs;
+std::unordered_map<uint64_t, std::vector<PagingIndexEnb*>> tai_to_enbs;
+uint64_t lookup_sequence = 0;
+
+uint64_t tai_key(const plmn_t& plmn, tac_t tac) {
+  uint64_t digits = (uint64_t)plmn.mcc_digit1 << 20 |
+                    (uint64_t)plmn.mcc_digit2 << 16 |
+                    (uint64_t)plmn.mcc_digit3 << 12 |
+                    (uint64_t)plmn.mnc_digit1 << 8 |
+                    (uint64_t)plmn.mnc_digit2 << 4 | plmn.mnc_digit3;
+  return digits << 16 | tac;
+}
+
+void unlink_enb(PagingIndexEnb* entry) {
+  for (uint64_t key : entry->tais) {
+    auto it = tai_to_enbs.find(key);
+    if (it == tai_to_enbs.end()) continue;
+    std::vector<PagingIndexEnb*>& targets = it->second;
+    for (size_t i = 0; i < targets.size(); i++) {
+      if (targets[i] == entry) {
+        targets[i] = targets.back();
+        targets.pop_back();
+        break;
+      }
+    }
+    if (targets.empty()) tai_to_enbs.erase(it);
+  }
+  entry->tais.clear();
+}
+
+bool index_ready_enb(__attribute__((unused)) const hash_key_t key,
+                     void* const element, __attribute__((unused)) void* param,
+                     __attribute__((unused)) void** result) {
+  const enb_description_t* enb = (const enb_description_t*)element;
+  if (enb->s1_state == S1AP_READY) {
+    s1ap_paging_index_update_enb(enb);
+  }
+  return false;
+}
+
+}  // namespace
+
+void s1ap_paging_index_update_enb(const enb_description_t* enb) {
+  PagingIndexEnb& entry = enbs[enb->sctp_assoc_id];
+  entry.assoc_id = enb->sctp_assoc_id;
+  unlink_enb(&entry);
+
+  const supported_ta_list_t* ta_list = &enb->supported_ta_list;
+  for (int ta_idx = 0;
+       ta_idx < ta_list->list_count && ta_idx < S1AP_MAX_TAI_ITEMS; ta_idx++) {
+    const supported_tai_items_t* item = &ta_list->supported_tai_items[ta_idx];
+    for (int plmn_idx = 0; plmn_idx < item->bplmnlist_count &&
+                           plmn_idx < S1AP_MAX_BROADCAST_PLMNS;
+         plmn_idx++) {
+      uint64_t key = tai_key(item->bplmns[plmn_idx], item->tac);
+      bool duplicate = false;
+      for (uint64_t indexed : entry.tais) {
+        duplicate |= indexed == key;
+      }
+      if (duplicate) continue;
+      entry.tais.push_back(key);
+      tai_to_enbs[key].push_back(&entry);
+    }
+  }
+  OAILOG_DEBUG(LOG_S1AP, "Indexed %zu TAIs for paging on assoc id %u\n",
+               entry.tais.size(), enb->sctp_assoc_id);
+}
+
+void s1ap_paging_index_remove_enb(sctp_assoc_id_t assoc_id) {
+  auto it = enbs.find(assoc_id);
+  if (it == enbs.end()) return;
+  unlink_enb(&it->second);
+  enbs.erase(it);
+}
+
+void s1ap_paging_index_rebuild(s1ap_state_t* state) {
+  s1ap_paging_index_clear();
+  if (state == nullptr) return;
+  hashtable_ts_apply_callback_on_elements(&state->enbs, index_ready_enb,
+                                          nullptr, nullptr);
+  OAILOG_INFO(LOG_S1AP, "Paging index rebuilt with %zu eNBs and %zu TAIs\n",
+              enbs.size(), tai_to_enbs.size());
+}
+
+void s1ap_paging_index_clear(void) {
+  tai_to_enbs.clear();
+  enbs.clear();
+}
+
+uint32_t s1ap_paging_index_lookup(const paging_tai_list_t* tai_lists,
+                                  uint8_t tai_list_count,
+                                  s1ap_paging_index_cb_t cb, void* arg) {
+  uint32_t num_targets = 0;
+  uint64_t sequence = ++lookup_sequence;
+
+  for (int list_idx = 0; list_idx < tai_list_count; list_idx++) {
+    const paging_tai_list_t* tai_list = &tai_lists[list_idx];
+    for (int tai_idx = 0; tai_idx < tai_list->numoftac + 1 &&
+                          tai_idx < TRACKING_AREA_IDENTITY_MAX_NUM_OF_TAIS;
+         tai_idx++) {
+      const tai_t* tai = &tai_list->tai_list[tai_idx];
+      auto it = tai_to_enbs.find(tai_key(tai->plmn, tai->tac));
+      if (it == tai_to_enbs.end()) continue;
+      for (PagingIndexEnb* entry : it->second) {
+        if (entry->last_lookup == sequence) continue;
+        entry->last_lookup = sequence;
+        num_targets++;
+        cb(entry->assoc_id, arg);
+      }
+    }
+  }
+  return num_targets;
+}
+
+uint32_t s1ap_paging_index_num_tais(void) { return tai_to_enbs.size(); }
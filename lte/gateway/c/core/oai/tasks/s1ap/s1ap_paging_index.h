@@ -0,0 +1,61 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*! \file s1ap_paging_index.h
+  \brief TAI to eNB inverted index used to select paging targets.
+
+  Every (broadcast PLMN, TAC) pair of the Supported TAs announced by an eNB
+  in S1 Setup or eNB Configuration Update maps to the association of that
+  eNB, so that selecting the eNBs to page costs one lookup per TAI of the
+  paging TAI list instead of a scan of all eNBs. The index only lives in
+  the S1AP task and is rebuilt from the eNB state when S1AP starts.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lte/gateway/c/core/oai/common/common_types.h"
+#include "lte/gateway/c/core/oai/include/TrackingAreaIdentity.h"
+#include "lte/gateway/c/core/oai/include/s1ap_types.h"
+
+typedef void (*s1ap_paging_index_cb_t)(sctp_assoc_id_t assoc_id, void* arg);
+
+/* Replace the TAIs indexed for enb with its current Supported TAs */
+void s1ap_paging_index_update_enb(const enb_description_t* enb);
+
+void s1ap_paging_index_remove_enb(sctp_assoc_id_t assoc_id);
+
+/* Drop the index and index every eNB of state */
+void s1ap_paging_index_rebuild(s1ap_state_t* state);
+
+void s1ap_paging_index_clear(void);
+
+/*
+ * Calls cb once for every eNB serving at least one TAI of the paging TAI
+ * lists (each list holding numoftac + 1 TAIs) and returns the number of
+ * such eNBs.
+ */
+uint32_t s1ap_paging_index_lookup(const paging_tai_list_t* tai_lists,
+                                  uint8_t tai_list_count,
+                                  s1ap_paging_index_cb_t cb, void* arg);
+
+uint32_t s1ap_paging_index_num_tais(void);
+
+#ifdef __cplusplus
+}
+#endif
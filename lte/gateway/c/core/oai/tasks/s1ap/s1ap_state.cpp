@@ -30,6 +30,7 @@ extern "C" {
 #include "lte/gateway/c/core/oai/common/dynamic_memory_check.h"
 }
 
+#include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_paging_index.h"
 #include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_state_manager.h"
 
 using magma::lte::S1apStateManager;
@@ -38,6 +39,8 @@ int s1ap_state_init(uint32_t max_ues, uint32_t max_enbs, bool use_stateless) {
   S1apStateManager::getInstance().init(max_ues, max_enbs, use_stateless);
   // remove UEs with unknown IMSI from eNB state
   remove_ues_without_imsi_from_ue_id_coll();
+  // the paging index is not persisted, index the restored eNBs
+  s1ap_paging_index_rebuild(get_s1ap_state(false));
   return RETURNok;
 }
 
@@ -45,7 +48,10 @@ s1ap_state_t* get_s1ap_state(bool read_from_db) {
   return S1apStateManager::getInstance().get_state(read_from_db);
 }
 
-void s1ap_state_exit() { S1apStateManager::getInstance().free_state(); }
+void s1ap_state_exit() {
+  s1ap_paging_index_clear();
+  S1apStateManager::getInstance().free_state();
+}
 
 void put_s1ap_state() { S1apStateManager::getInstance().write_state_to_db(); }
 
@@ -106,6 +106,12 @@ char* experimental_retcode_2_string(uint32_t ret_code) {
     case DIAMETER_AUTHENTICATION_DATA_UNAVAILABLE:
       return "DIAMETER_AUTHENTICATION_DATA_UNAVAILABLE";
 
+    case DIAMETER_AUTHENTICATION_REJECTED:
+      return "DIAMETER_AUTHENTICATION_REJECTED";
+
+    case DIAMETER_ERROR_UNAUTHORIZED_SERVICE:
+      return "DIAMETER_ERROR_UNAUTHORIZED_SERVICE";
+
     default:
       break;
   }
@@ -211,6 +211,9 @@ bool S6aFdIface::update_location_req(s6a_update_location_req_t* ulr_p) {
 }
 //------------------------------------------------------------------------------
 bool S6aFdIface::authentication_info_req(s6a_auth_info_req_t* air_p) {
+  // The AIA is matched back to the IMSI only, which cannot tell a prefetch
+  // from an AIR sent for the UE
+  if (air_p->prefetch_seq) return false;
   if (s6a_generate_authentication_info_req(air_p))
     return false;
   else
@@ -28,6 +28,7 @@ extern "C" {
 
 #if S6A_OVER_GRPC
 #include "lte/gateway/c/core/oai/tasks/s6a/s6a_grpc_iface.h"
+#include "lte/gateway/c/core/oai/tasks/s6a/s6a_local_iface.h"
 #else
 #include "lte/gateway/c/core/oai/tasks/s6a/s6a_fd_iface.h"
 #endif
@@ -41,7 +42,16 @@ S6aViface* s6a_interface = nullptr;
 bool s6a_viface_open(const s6a_config_t* config) {
   if (!s6a_interface) {
 #if S6A_OVER_GRPC
-    s6a_interface = new S6aGrpcIface();
+    if (config->local_hss_enabled) {
+      S6aLocalIface* local_interface = new S6aLocalIface(config);
+      if (!local_interface->open()) {
+        delete local_interface;
+        return false;
+      }
+      s6a_interface = local_interface;
+    } else {
+      s6a_interface = new S6aGrpcIface();
+    }
 #else
     s6a_interface = new S6aFdIface(config);
 #endif
@@ -0,0 +1,315 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lte/gateway/c/core/oai/tasks/s6a/s6a_local_hss.h"
+
+#include <openssl/rand.h>
+
+#include <cinttypes>
+#include <cstring>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/log.h"
+#include "lte/gateway/c/core/oai/common/security_types.h"
+#include "lte/gateway/c/core/oai/lib/message_utils/ie_to_bytes.h"
+#include "lte/gateway/c/core/oai/lib/secu/secu_defs.h"
+}
+
+#include "feg/protos/s6a_proxy.pb.h"
+#include "lte/gateway/c/core/oai/lib/s6a_proxy/proto_msg_to_itti_msg.h"
+
+namespace {
+
+// SQN = SEQ || IND with a 5 bit IND, TS 33.102 C.3.2
+#define LOCAL_HSS_IND_BITS 5
+#define LOCAL_HSS_SQN_MASK 0xFFFFFFFFFFFFull
+// Largest SEQ delta of a resync the network accepts from the USIM
+#define LOCAL_HSS_RESYNC_SEQ_DELTA_MAX (1ull << 28)
+
+void seq_to_sqn(uint64_t seq, uint8_t* sqn) {
+  uint64_t value = (seq << LOCAL_HSS_IND_BITS) & LOCAL_HSS_SQN_MASK;
+  for (int i = SQN_LENGTH_OCTETS - 1; i >= 0; i--) {
+    sqn[i] = value & 0xff;
+    value >>= 8;
+  }
+}
+
+uint64_t sqn_to_seq(const uint8_t* sqn) {
+  uint64_t value = 0;
+  for (int i = 0; i < SQN_LENGTH_OCTETS; i++) {
+    value = (value << 8) | sqn[i];
+  }
+  return value >> LOCAL_HSS_IND_BITS;
+}
+
+// Mimics the ULA encoding of the MSISDN, TS 29.329: swapped BCD digits with
+// an odd length padded with an F
+bool encode_msisdn(const std::string& msisdn, uint8_t* encoded,
+                   uint8_t* encoded_length) {
+  if (msisdn.length() > MSISDN_LENGTH) {
+    return false;
+  }
+  for (char c : msisdn) {
+    if (c < '0' || c > '9') {
+      return false;
+    }
+  }
+  uint8_t length = 0;
+  for (size_t i = 0; i < msisdn.length(); i += 2) {
+    uint8_t second = i + 1 < msisdn.length() ? msisdn[i + 1] - '0' : 0x0F;
+    encoded[length++] = (second << 4) | (msisdn[i] - '0');
+  }
+  *encoded_length = length;
+  return true;
+}
+
+void set_experimental_result(s6a_result_t* result,
+                             s6a_experimental_result_t code) {
+  result->present = S6A_RESULT_EXPERIMENTAL;
+  result->choice.experimental = code;
+}
+
+}  // namespace
+
+namespace magma {
+namespace lte {
+
+S6aLocalHss::S6aLocalHss(const std::string& op, const std::string& amf,
+                         uint64_t max_ul_bit_rate, uint64_t max_dl_bit_rate)
+    : op_(op),
+      max_ul_bit_rate_(max_ul_bit_rate),
+      max_dl_bit_rate_(max_dl_bit_rate) {
+  memset(amf_, 0, sizeof(amf_));
+  if (amf.length() == sizeof(amf_)) {
+    memcpy(amf_, amf.data(), sizeof(amf_));
+  }
+}
+
+bool S6aLocalHss::open(const std::string& store_path, uint32_t capacity) {
+  return store_.open(store_path, capacity);
+}
+
+void S6aLocalHss::close() { store_.close(); }
+
+bool S6aLocalHss::to_local_subscriber(const SubscriberData& data,
+                                      LocalSubscriber* subscriber) const {
+  const std::string& imsi = data.sid().id();
+  if (data.sid().type() != SubscriberID::IMSI || imsi.empty() ||
+      imsi.length() > IMSI_BCD_DIGITS_MAX) {
+    return false;
+  }
+  memset(subscriber, 0, sizeof(*subscriber));
+  memcpy(subscriber->imsi, imsi.data(), imsi.length());
+
+  if (data.lte().state() == LTESubscription::ACTIVE) {
+    subscriber->flags |= LOCAL_SUBSCRIBER_LTE_ACTIVE;
+  }
+  for (int type : data.sub_network().forbidden_network_types()) {
+    if (type == CoreNetworkType::NT_EPC) {
+      subscriber->flags |= LOCAL_SUBSCRIBER_EPC_FORBIDDEN;
+    }
+  }
+  // subscriberdb falls back to the default profile for an empty one
+  if (!data.sub_profile().empty() && data.sub_profile() != "default") {
+    subscriber->flags |= LOCAL_SUBSCRIBER_CUSTOM_PROFILE;
+  }
+  const std::string& key = data.lte().auth_key();
+  const std::string& opc = data.lte().auth_opc();
+  if (data.lte().auth_algo() == LTESubscription::MILENAGE &&
+      key.length() == sizeof(subscriber->key)) {
+    memcpy(subscriber->key, key.data(), sizeof(subscriber->key));
+    if (opc.length() == sizeof(subscriber->opc)) {
+      memcpy(subscriber->opc, opc.data(), sizeof(subscriber->opc));
+      subscriber->flags |= LOCAL_SUBSCRIBER_AUTH_VALID;
+    } else if (opc.empty() && op_.length() == sizeof(subscriber->opc)) {
+      milenage_opc(subscriber->key,
+                   reinterpret_cast<const uint8_t*>(op_.data()),
+                   subscriber->opc);
+      subscriber->flags |= LOCAL_SUBSCRIBER_AUTH_VALID;
+    }
+  }
+  subscriber->next_seq = data.state().lte_auth_next_seq();
+  subscriber->max_ul_bit_rate = max_ul_bit_rate_;
+  subscriber->max_dl_bit_rate = max_dl_bit_rate_;
+
+  if (!encode_msisdn(data.non_3gpp().msisdn(), subscriber->msisdn,
+                     &subscriber->msisdn_length)) {
+    OAILOG_WARNING(LOG_S6A, "Ignoring invalid MSISDN of subscriber %s\n",
+                   subscriber->imsi);
+  }
+
+  for (const auto& apn : data.non_3gpp().apn_config()) {
+    if (subscriber->nb_apns == MAX_APN_PER_UE) {
+      OAILOG_WARNING(LOG_S6A,
+                     "Subscriber %s has more than %d APNs, truncating\n",
+                     subscriber->imsi, MAX_APN_PER_UE);
+      break;
+    }
+    LocalApnConfig* apn_config = &subscriber->apns[subscriber->nb_apns++];
+    strncpy(apn_config->service_selection, apn.service_selection().c_str(),
+            APN_MAX_LENGTH);
+    apn_config->pdn_type = apn.pdn();
+    apn_config->qci = apn.qos_profile().class_id();
+    apn_config->priority_level = apn.qos_profile().priority_level();
+    apn_config->preemption_capability =
+        apn.qos_profile().preemption_capability();
+    apn_config->preemption_vulnerability =
+        apn.qos_profile().preemption_vulnerability();
+    apn_config->max_bandwidth_ul = apn.ambr().max_bandwidth_ul();
+    apn_config->max_bandwidth_dl = apn.ambr().max_bandwidth_dl();
+  }
+  return true;
+}
+
+bool S6aLocalHss::add_subscriber(const SubscriberData& data) {
+  LocalSubscriber subscriber;
+  if (!to_local_subscriber(data, &subscriber)) {
+    return false;
+  }
+  return store_.upsert(subscriber);
+}
+
+bool S6aLocalHss::resync_seq(const char* imsi,
+                             const LocalSubscriber& subscriber,
+                             const uint8_t* resync_param) {
+  uint8_t sqn_ms[SQN_LENGTH_OCTETS];
+  if (milenage_resync_sqn(subscriber.key, subscriber.opc, resync_param,
+                          resync_param + RAND_LENGTH_OCTETS, sqn_ms) != 0) {
+    OAILOG_ERROR(LOG_S6A, "Invalid resync authentication code for %s\n",
+                 imsi);
+    return false;
+  }
+  uint64_t seq_ms = sqn_to_seq(sqn_ms);
+  // SEQ the network sent in the rejected vector
+  uint64_t current_seq = subscriber.next_seq - 1;
+  if (seq_ms < current_seq &&
+      current_seq - seq_ms <= LOCAL_HSS_RESYNC_SEQ_DELTA_MAX) {
+    OAILOG_ERROR(
+        LOG_S6A,
+        "Resync delta in range but UE rejected auth for %s: %" PRIu64 "\n",
+        imsi, current_seq - seq_ms);
+    return false;
+  }
+  return store_.set_next_seq(imsi, seq_ms + 1);
+}
+
+bool S6aLocalHss::authentication_info(const s6a_auth_info_req_t* air_p,
+                                      s6a_auth_info_ans_t* aia_p) {
+  LocalSubscriber subscriber;
+  if (!store_.lookup(air_p->imsi, &subscriber)) {
+    OAILOG_DEBUG(LOG_S6A, "Subscriber not in local store for AIR: %s\n",
+                 air_p->imsi);
+    return false;
+  }
+  if (!(subscriber.flags & LOCAL_SUBSCRIBER_LTE_ACTIVE) ||
+      (subscriber.flags & LOCAL_SUBSCRIBER_EPC_FORBIDDEN)) {
+    OAILOG_ERROR(LOG_S6A, "LTE service not active for %s\n", air_p->imsi);
+    set_experimental_result(&aia_p->result,
+                            DIAMETER_ERROR_UNAUTHORIZED_SERVICE);
+    return true;
+  }
+  if (!(subscriber.flags & LOCAL_SUBSCRIBER_AUTH_VALID)) {
+    OAILOG_ERROR(LOG_S6A, "Subscriber key or OPc not valid for %s\n",
+                 air_p->imsi);
+    set_experimental_result(&aia_p->result, DIAMETER_AUTHENTICATION_REJECTED);
+    return true;
+  }
+  if (air_p->re_synchronization &&
+      !resync_seq(air_p->imsi, subscriber, air_p->resync_param)) {
+    set_experimental_result(&aia_p->result, DIAMETER_AUTHENTICATION_REJECTED);
+    return true;
+  }
+
+  uint8_t nb_of_vectors = air_p->nb_of_vectors;
+  if (nb_of_vectors == 0) {
+    nb_of_vectors = 1;
+  } else if (nb_of_vectors > MAX_EPS_AUTH_VECTORS) {
+    nb_of_vectors = MAX_EPS_AUTH_VECTORS;
+  }
+  // Reserve the SEQs of the vectors, after a resync moved next_seq
+  if (!store_.lookup(air_p->imsi, &subscriber, nb_of_vectors)) {
+    return false;
+  }
+
+  uint8_t plmn[3];
+  plmn_to_bytes(&air_p->visited_plmn, reinterpret_cast<char*>(plmn));
+  for (uint8_t i = 0; i < nb_of_vectors; i++) {
+    eutran_vector_t* vector = &aia_p->auth_info.eutran_vector[i];
+    uint8_t rand[RAND_LENGTH_OCTETS];
+    uint8_t sqn[SQN_LENGTH_OCTETS];
+    if (RAND_bytes(rand, sizeof(rand)) != 1) {
+      OAILOG_ERROR(LOG_S6A, "Failed to generate RAND for %s\n", air_p->imsi);
+      aia_p->result.present = S6A_RESULT_BASE;
+      aia_p->result.choice.base = DIAMETER_UNABLE_TO_COMPLY;
+      return true;
+    }
+    seq_to_sqn(subscriber.next_seq + i, sqn);
+    milenage_generate_eutran_vector(subscriber.key, subscriber.opc, amf_, sqn,
+                                    plmn, rand, vector);
+  }
+  aia_p->auth_info.nb_of_vectors = nb_of_vectors;
+  aia_p->result.present = S6A_RESULT_BASE;
+  aia_p->result.choice.base = DIAMETER_SUCCESS;
+  OAILOG_DEBUG(LOG_S6A, "Generated %u vectors for %s\n", nb_of_vectors,
+               air_p->imsi);
+  return true;
+}
+
+bool S6aLocalHss::update_location(const s6a_update_location_req_t* ulr_p,
+                                  s6a_update_location_ans_t* ula_p) {
+  LocalSubscriber subscriber;
+  if (!store_.lookup(ulr_p->imsi, &subscriber)) {
+    OAILOG_DEBUG(LOG_S6A, "Subscriber not in local store for ULR: %s\n",
+                 ulr_p->imsi);
+    return false;
+  }
+  if (subscriber.flags & LOCAL_SUBSCRIBER_CUSTOM_PROFILE) {
+    OAILOG_DEBUG(LOG_S6A, "Subscription profile of %s left to subscriberdb\n",
+                 ulr_p->imsi);
+    return false;
+  }
+
+  feg::UpdateLocationAnswer ula;
+  ula.set_default_context_id(0);
+  ula.mutable_total_ambr()->set_max_bandwidth_ul(subscriber.max_ul_bit_rate);
+  ula.mutable_total_ambr()->set_max_bandwidth_dl(subscriber.max_dl_bit_rate);
+  ula.set_all_apns_included(false);
+  ula.set_msisdn(reinterpret_cast<const char*>(subscriber.msisdn),
+                 subscriber.msisdn_length);
+  for (uint8_t i = 0; i < subscriber.nb_apns; i++) {
+    const LocalApnConfig& apn_config = subscriber.apns[i];
+    auto apn = ula.add_apn();
+    apn->set_context_id(i);
+    apn->set_service_selection(apn_config.service_selection);
+    apn->mutable_qos_profile()->set_class_id(apn_config.qci);
+    apn->mutable_qos_profile()->set_priority_level(apn_config.priority_level);
+    apn->mutable_qos_profile()->set_preemption_capability(
+        apn_config.preemption_capability);
+    apn->mutable_qos_profile()->set_preemption_vulnerability(
+        apn_config.preemption_vulnerability);
+    apn->mutable_ambr()->set_max_bandwidth_ul(apn_config.max_bandwidth_ul);
+    apn->mutable_ambr()->set_max_bandwidth_dl(apn_config.max_bandwidth_dl);
+    apn->mutable_ambr()->set_unit(
+        feg::UpdateLocationAnswer_AggregatedMaximumBitrate::BPS);
+    apn->set_pdn(
+        static_cast<feg::UpdateLocationAnswer_APNConfiguration_PDNType>(
+            apn_config.pdn_type));
+  }
+  ula_p->result.present = S6A_RESULT_BASE;
+  ula_p->result.choice.base = DIAMETER_SUCCESS;
+  convert_proto_msg_to_itti_s6a_update_location_ans(ula, ula_p);
+  return true;
+}
+
+}  // namespace lte
+}  // namespace magma
@@ -0,0 +1,86 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/include/s6a_messages_types.h"
+}
+
+#include "lte/gateway/c/core/oai/tasks/s6a/s6a_subscriber_store.h"
+#include "lte/protos/subscriberdb.pb.h"
+
+namespace magma {
+namespace lte {
+
+// Subscriber AMBR of the default subscriberdb subscription profile
+#define LOCAL_HSS_DEFAULT_MAX_UL_BIT_RATE 2000000000
+#define LOCAL_HSS_DEFAULT_MAX_DL_BIT_RATE 4000000000
+
+/**
+ * HSS answering AIRs and ULRs from the local subscriber store, with the
+ * semantics of the subscriberdb S6a servicer:
+ *  - E-UTRAN vectors are generated with Milenage, each consuming a SEQ
+ *  - SEQs are resynchronised from the AUTS of a synchronisation failure
+ *  - ULAs carry the subscriber APN configurations and MSISDN
+ */
+class S6aLocalHss {
+ public:
+  /**
+   * @param op operator variant of the subscribers without an OPc, 16 octets
+   * or empty
+   * @param amf authentication management field of the vectors, 2 octets
+   */
+  S6aLocalHss(const std::string& op, const std::string& amf,
+              uint64_t max_ul_bit_rate, uint64_t max_dl_bit_rate);
+
+  bool open(const std::string& store_path, uint32_t capacity);
+  void close();
+
+  /**
+   * Convert a subscriberdb subscriber to a store record
+   * @return false if it is not identified by a valid IMSI
+   */
+  bool to_local_subscriber(const SubscriberData& data,
+                           LocalSubscriber* subscriber) const;
+
+  bool add_subscriber(const SubscriberData& data);
+
+  /**
+   * Answer an AIR or ULR from the store
+   * @return false if the subscriber is not in the store, or for a ULR if its
+   * subscription profile is not the default one. The answer is then left as
+   * is, for subscriberdb to answer.
+   */
+  bool authentication_info(const s6a_auth_info_req_t* air_p,
+                           s6a_auth_info_ans_t* aia_p);
+  bool update_location(const s6a_update_location_req_t* ulr_p,
+                       s6a_update_location_ans_t* ula_p);
+
+  S6aSubscriberStore& store() { return store_; }
+
+ private:
+  bool resync_seq(const char* imsi, const LocalSubscriber& subscriber,
+                  const uint8_t* resync_param);
+
+  S6aSubscriberStore store_;
+  std::string op_;
+  uint8_t amf_[2];
+  uint64_t max_ul_bit_rate_;
+  uint64_t max_dl_bit_rate_;
+};
+
+}  // namespace lte
+}  // namespace magma
@@ -0,0 +1,327 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lte/gateway/c/core/oai/tasks/s6a/s6a_local_iface.h"
+
+#include <grpcpp/impl/codegen/client_context.h>
+#include <grpcpp/impl/codegen/status.h>
+
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/conversions.h"
+#include "lte/gateway/c/core/oai/common/log.h"
+#include "lte/gateway/c/core/oai/lib/bstr/bstrlib.h"
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface.h"
+#include "lte/gateway/c/core/oai/tasks/s6a/s6a_defs.h"
+}
+
+#include "lte/gateway/c/core/oai/lib/s6a_proxy/s6a_client_api.h"
+
+#include "orc8r/gateway/c/common/service303/includes/MetricsHelpers.h"
+#include "orc8r/gateway/c/common/service_registry/includes/ServiceRegistrySingleton.h"
+
+using grpc::ClientContext;
+using grpc::Status;
+using magma::ServiceRegistrySingleton;
+using magma::lte::SubscriberData;
+using magma::lte::SubscriberDB;
+using magma::lte::SubscriberID;
+using magma::orc8r::LeafDigests;
+using magma::orc8r::Void;
+
+extern task_zmq_ctx_t s6a_task_zmq_ctx;
+
+namespace {
+
+#define S6A_LOCAL_HSS_STORE_CAPACITY 1024
+#define S6A_LOCAL_HSS_RPC_TIMEOUT_SEC 5
+#define S6A_LOCAL_HSS_MAX_PENDING_FETCHES 1024
+#define IMSI_SID_PREFIX "IMSI"
+
+// Empty if the hex string does not hold exactly length octets
+std::string hex_to_bytes(bstring hex, size_t length) {
+  if (!hex || static_cast<size_t>(blength(hex)) != 2 * length) {
+    return "";
+  }
+  std::string bytes(length, '\0');
+  if (!ascii_to_hex(reinterpret_cast<uint8_t*>(&bytes[0]), bdata(hex))) {
+    return "";
+  }
+  return bytes;
+}
+
+// Subscriber digests are keyed by the SID string of subscriberdb
+bool sid_to_imsi(const std::string& sid, std::string* imsi) {
+  if (sid.compare(0, strlen(IMSI_SID_PREFIX), IMSI_SID_PREFIX) != 0) {
+    return false;
+  }
+  *imsi = sid.substr(strlen(IMSI_SID_PREFIX));
+  return true;
+}
+
+void set_rpc_deadline(ClientContext* context) {
+  context->set_deadline(
+      std::chrono::system_clock::now() +
+      std::chrono::seconds(S6A_LOCAL_HSS_RPC_TIMEOUT_SEC));
+}
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+S6aLocalIface::S6aLocalIface(const s6a_config_t* config)
+    : hss_(hex_to_bytes(config->local_hss_op, 16),
+           hex_to_bytes(config->local_hss_amf, 2),
+           config->local_hss_max_ul_bit_rate
+               ? config->local_hss_max_ul_bit_rate
+               : LOCAL_HSS_DEFAULT_MAX_UL_BIT_RATE,
+           config->local_hss_max_dl_bit_rate
+               ? config->local_hss_max_dl_bit_rate
+               : LOCAL_HSS_DEFAULT_MAX_DL_BIT_RATE),
+      store_file_(bdata(config->local_hss_store_file)),
+      sync_interval_(config->local_hss_sync_interval_sec),
+      synced_(false),
+      stopping_(false) {
+  if (hex_to_bytes(config->local_hss_amf, 2).empty()) {
+    OAILOG_WARNING(LOG_S6A, "Invalid local HSS AMF, using 0000\n");
+  }
+}
+
+//------------------------------------------------------------------------------
+bool S6aLocalIface::open() {
+  if (!hss_.open(store_file_, S6A_LOCAL_HSS_STORE_CAPACITY)) {
+    OAILOG_ERROR(LOG_S6A, "Failed to open local subscriber store %s\n",
+                 store_file_.c_str());
+    return false;
+  }
+  auto channel = ServiceRegistrySingleton::Instance()->GetGrpcChannel(
+      "subscriberdb", ServiceRegistrySingleton::LOCAL);
+  stub_ = SubscriberDB::NewStub(channel);
+  sync_thread_ = std::thread([this]() { sync_loop(); });
+  send_activate_messages();
+  OAILOG_DEBUG(LOG_S6A, "Initializing S6a interface with local HSS: DONE\n");
+  return true;
+}
+
+//------------------------------------------------------------------------------
+S6aLocalIface::~S6aLocalIface() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  sync_cv_.notify_all();
+  if (sync_thread_.joinable()) {
+    sync_thread_.join();
+  }
+  hss_.close();
+}
+
+//------------------------------------------------------------------------------
+void S6aLocalIface::sync_loop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto next_sync = std::chrono::steady_clock::now();
+  while (!stopping_) {
+    if (std::chrono::steady_clock::now() >= next_sync) {
+      // Fetched by the sync
+      fetch_imsis_.clear();
+      lock.unlock();
+      if (sync()) {
+        increment_counter("s6a_local_hss_sync", 1, 1, "result", "success");
+      } else {
+        increment_counter("s6a_local_hss_sync", 1, 1, "result", "failure");
+      }
+      lock.lock();
+      next_sync = std::chrono::steady_clock::now() + sync_interval_;
+    } else if (!fetch_imsis_.empty()) {
+      std::unordered_set<std::string> imsis;
+      imsis.swap(fetch_imsis_);
+      lock.unlock();
+      for (const auto& imsi : imsis) {
+        Status status = fetch_subscriber(imsi);
+        if (status.ok()) {
+          // Not digested yet, the next sync checks it is still listed
+          digests_[IMSI_SID_PREFIX + imsi] = "";
+        } else if (status.error_code() != grpc::StatusCode::NOT_FOUND) {
+          OAILOG_ERROR(LOG_S6A, "Failed to get subscriber %s: %s\n",
+                       imsi.c_str(), status.error_message().c_str());
+        }
+      }
+      lock.lock();
+    }
+    sync_cv_.wait_until(lock, next_sync, [this]() {
+      return stopping_ || !fetch_imsis_.empty();
+    });
+  }
+}
+
+//------------------------------------------------------------------------------
+bool S6aLocalIface::sync() {
+  LeafDigests leaves;
+  ClientContext list_context;
+  set_rpc_deadline(&list_context);
+  Status status = stub_->ListSubscriberDigests(&list_context, Void(), &leaves);
+  if (!status.ok()) {
+    OAILOG_ERROR(LOG_S6A, "Failed to list subscriber digests: %s\n",
+                 status.error_message().c_str());
+    return false;
+  }
+
+  // Until a sync completes, every subscriber is fetched and the ones left in
+  // the store file by an earlier run are swept
+  bool full_sync = !synced_;
+  if (full_sync) {
+    digests_.clear();
+    hss_.store().begin_sync();
+  }
+  std::unordered_set<std::string> listed;
+  size_t fetched = 0;
+  for (const auto& leaf : leaves.digests()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        return false;
+      }
+    }
+    listed.insert(leaf.id());
+    const std::string& digest = leaf.digest().md5_base64_digest();
+    auto it = digests_.find(leaf.id());
+    if (it != digests_.end() && it->second == digest) {
+      continue;
+    }
+    std::string imsi;
+    if (!sid_to_imsi(leaf.id(), &imsi)) {
+      OAILOG_WARNING(LOG_S6A, "Skipping subscriber %s\n", leaf.id().c_str());
+      digests_[leaf.id()] = digest;
+      continue;
+    }
+    status = fetch_subscriber(imsi);
+    if (status.error_code() == grpc::StatusCode::NOT_FOUND) {
+      // Deleted since listed
+      continue;
+    }
+    if (!status.ok()) {
+      OAILOG_ERROR(LOG_S6A, "Failed to get subscriber %s: %s\n",
+                   leaf.id().c_str(), status.error_message().c_str());
+      return false;
+    }
+    digests_[leaf.id()] = digest;
+    fetched++;
+  }
+
+  size_t removed = 0;
+  if (full_sync) {
+    removed = hss_.store().end_sync();
+    synced_ = true;
+  } else {
+    for (auto it = digests_.begin(); it != digests_.end();) {
+      if (listed.count(it->first) != 0) {
+        ++it;
+        continue;
+      }
+      std::string imsi;
+      if (sid_to_imsi(it->first, &imsi) && hss_.store().remove(imsi.c_str())) {
+        removed++;
+      }
+      it = digests_.erase(it);
+    }
+  }
+  OAILOG_INFO(LOG_S6A, "Synced %zu subscribers, fetched %zu, removed %zu\n",
+              hss_.store().size(), fetched, removed);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+Status S6aLocalIface::fetch_subscriber(const std::string& imsi) {
+  SubscriberID sid;
+  sid.set_id(imsi);
+  sid.set_type(SubscriberID::IMSI);
+  SubscriberData data;
+  ClientContext context;
+  set_rpc_deadline(&context);
+  Status status = stub_->GetSubscriberData(&context, sid, &data);
+  if (status.ok() && !hss_.add_subscriber(data)) {
+    OAILOG_WARNING(LOG_S6A, "Skipping subscriber %s\n", imsi.c_str());
+  }
+  return status;
+}
+
+//------------------------------------------------------------------------------
+void S6aLocalIface::request_fetch(const char* imsi) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fetch_imsis_.size() >= S6A_LOCAL_HSS_MAX_PENDING_FETCHES) {
+      return;
+    }
+    fetch_imsis_.insert(imsi);
+  }
+  sync_cv_.notify_all();
+}
+
+//------------------------------------------------------------------------------
+bool S6aLocalIface::update_location_req(s6a_update_location_req_t* ulr_p) {
+  MessageDef* message_p =
+      itti_alloc_new_message(TASK_S6A, S6A_UPDATE_LOCATION_ANS);
+  s6a_update_location_ans_t* ula_p =
+      &message_p->ittiMsg.s6a_update_location_ans;
+  strncpy(ula_p->imsi, ulr_p->imsi, ulr_p->imsi_length);
+  ula_p->imsi_length = ulr_p->imsi_length;
+
+  if (!hss_.update_location(ulr_p, ula_p)) {
+    free(message_p);
+    // Answered by subscriberdb until the subscriber is fetched, and always
+    // for a subscription profile the store has no AMBR of
+    if (!hss_.store().contains(ulr_p->imsi)) {
+      request_fetch(ulr_p->imsi);
+    }
+    return s6a_update_location_req(ulr_p);
+  }
+
+  IMSI_STRING_TO_IMSI64(ulr_p->imsi, &message_p->ittiMsgHeader.imsi);
+  if (ulr_p->rat_type == RAT_NG_RAN) {
+    send_msg_to_task(&s6a_task_zmq_ctx, TASK_AMF_APP, message_p);
+  } else {
+    send_msg_to_task(&s6a_task_zmq_ctx, TASK_MME_APP, message_p);
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool S6aLocalIface::authentication_info_req(s6a_auth_info_req_t* air_p) {
+  MessageDef* message_p = itti_alloc_new_message(TASK_S6A, S6A_AUTH_INFO_ANS);
+  s6a_auth_info_ans_t* aia_p = &message_p->ittiMsg.s6a_auth_info_ans;
+  strncpy(aia_p->imsi, air_p->imsi, air_p->imsi_length);
+  aia_p->imsi_length = air_p->imsi_length;
+  aia_p->prefetch_seq = air_p->prefetch_seq;
+
+  if (!hss_.authentication_info(air_p, aia_p)) {
+    free(message_p);
+    request_fetch(air_p->imsi);
+    // Answered by subscriberdb until the subscriber is fetched
+    return s6a_authentication_info_req(air_p);
+  }
+
+  IMSI_STRING_TO_IMSI64(air_p->imsi, &message_p->ittiMsgHeader.imsi);
+  send_msg_to_task(&s6a_task_zmq_ctx, TASK_MME_APP, message_p);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool S6aLocalIface::send_cancel_location_ans(
+    s6a_cancel_location_ans_t* cla_pP) {
+  return false;
+}
+
+//------------------------------------------------------------------------------
+// Nothing is kept per UE by the local HSS
+bool S6aLocalIface::purge_ue(const char* imsi) { return true; }
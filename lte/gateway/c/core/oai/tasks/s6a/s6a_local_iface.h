@@ -0,0 +1,81 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef S6A_LOCAL_IFACE_H_SEEN
+#define S6A_LOCAL_IFACE_H_SEEN
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/include/mme_config.h"
+}
+
+#include "lte/gateway/c/core/oai/tasks/s6a/s6a_local_hss.h"
+#include "lte/gateway/c/core/oai/tasks/s6a/s6a_viface.h"
+#include "lte/protos/subscriberdb.grpc.pb.h"
+
+/**
+ * S6a interface answering AIRs and ULRs in the S6a task from a local
+ * subscriber store, rather than with a subscriberdb gRPC call per request.
+ * The store is synced from subscriberdb every sync interval, on its own
+ * thread, fetching only the subscribers whose digest changed. Requests for
+ * a subscriber missing from the store are forwarded to subscriberdb, as by
+ * the S6aGrpcIface, and the subscriber is fetched into the store.
+ */
+class S6aLocalIface : public S6aViface {
+ public:
+  S6aLocalIface(const s6a_config_t* config);
+  // Opens the store and starts the sync
+  bool open();
+  bool update_location_req(s6a_update_location_req_t* ulr_p);
+  bool authentication_info_req(s6a_auth_info_req_t* air_p);
+  bool send_cancel_location_ans(s6a_cancel_location_ans_t* cla_pP);
+  bool purge_ue(const char* imsi);
+
+  ~S6aLocalIface();
+
+ private:
+  void sync_loop();
+  // @return false if the subscribers could not all be fetched, the ones left
+  // are fetched by the next sync
+  bool sync();
+  grpc::Status fetch_subscriber(const std::string& imsi);
+  // Queue a subscriber missing from the store to be fetched by the sync
+  // thread
+  void request_fetch(const char* imsi);
+
+  magma::lte::S6aLocalHss hss_;
+  std::string store_file_;
+  std::chrono::seconds sync_interval_;
+  std::unique_ptr<magma::lte::SubscriberDB::Stub> stub_;
+  // SID => digest of the subscription last synced, only used by the sync
+  // thread
+  std::unordered_map<std::string, std::string> digests_;
+  // Set once a sync swept the subscribers left in the store file by an
+  // earlier run
+  bool synced_;
+  std::mutex mutex_;
+  std::condition_variable sync_cv_;
+  bool stopping_;
+  std::unordered_set<std::string> fetch_imsis_;
+  std::thread sync_thread_;
+};
+
+#endif /* S6A_LOCAL_IFACE_H_SEEN */
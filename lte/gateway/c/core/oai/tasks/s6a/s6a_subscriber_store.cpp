@@ -0,0 +1,369 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lte/gateway/c/core/oai/tasks/s6a/s6a_subscriber_store.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/log.h"
+}
+
+namespace {
+
+#define LOCAL_SUBSCRIBER_STORE_MAGIC 0x53364c53  // "S6LS"
+#define LOCAL_SUBSCRIBER_STORE_VERSION 1
+
+uint32_t hash_imsi(const char* imsi) {
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  for (; *imsi; imsi++) {
+    hash ^= static_cast<uint8_t>(*imsi);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+bool is_valid_imsi(const char* imsi) {
+  size_t length = strnlen(imsi, IMSI_BCD_DIGITS_MAX + 1);
+  if (length == 0 || length > IMSI_BCD_DIGITS_MAX) {
+    return false;
+  }
+  for (size_t i = 0; i < length; i++) {
+    if (imsi[i] < '0' || imsi[i] > '9') {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Slot of the subscriber, or the empty slot it would be inserted in
+magma::lte::LocalSubscriber* probe(magma::lte::LocalSubscriber* records,
+                                   uint32_t capacity, const char* imsi) {
+  uint32_t mask = capacity - 1;
+  for (uint32_t i = hash_imsi(imsi) & mask;; i = (i + 1) & mask) {
+    if (records[i].imsi[0] == '\0' || strcmp(records[i].imsi, imsi) == 0) {
+      return &records[i];
+    }
+  }
+}
+
+}  // namespace
+
+namespace magma {
+namespace lte {
+
+struct S6aSubscriberStore::Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t record_size;
+  uint32_t capacity;
+  uint32_t count;
+  uint32_t sync_generation;
+  // Keeps the records 64 bit aligned
+  uint8_t reserved[40];
+};
+
+size_t S6aSubscriberStore::file_size(uint32_t capacity) {
+  return sizeof(Header) +
+         static_cast<size_t>(capacity) * sizeof(LocalSubscriber);
+}
+
+S6aSubscriberStore::S6aSubscriberStore()
+    : header_(nullptr), records_(nullptr) {}
+
+S6aSubscriberStore::~S6aSubscriberStore() { close(); }
+
+bool S6aSubscriberStore::open(const std::string& path, uint32_t capacity) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (header_) {
+    return false;
+  }
+  uint32_t slots = 16;
+  while (slots < capacity && slots < (1u << 31)) {
+    slots <<= 1;
+  }
+  path_ = path;
+  if (map_file(path, 0, false, &header_, &records_)) {
+    OAILOG_INFO(LOG_S6A,
+                "Mapped local subscriber store %s with %u subscribers\n",
+                path.c_str(), header_->count);
+    return true;
+  }
+  if (!map_file(path, slots, true, &header_, &records_)) {
+    return false;
+  }
+  OAILOG_INFO(LOG_S6A, "Created local subscriber store %s with %u slots\n",
+              path.c_str(), slots);
+  return true;
+}
+
+void S6aSubscriberStore::close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  unmap(header_);
+  header_ = nullptr;
+  records_ = nullptr;
+}
+
+bool S6aSubscriberStore::map_file(const std::string& path, uint32_t capacity,
+                                  bool create, Header** header,
+                                  LocalSubscriber** records) {
+  int fd = ::open(path.c_str(), create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR,
+                  0600);
+  if (fd < 0) {
+    if (create) {
+      OAILOG_ERROR(LOG_S6A, "Failed to create local subscriber store %s: %s\n",
+                   path.c_str(), strerror(errno));
+    }
+    return false;
+  }
+  if (create) {
+    if (ftruncate(fd, file_size(capacity)) < 0) {
+      OAILOG_ERROR(LOG_S6A, "Failed to size local subscriber store %s: %s\n",
+                   path.c_str(), strerror(errno));
+      ::close(fd);
+      return false;
+    }
+  } else {
+    Header on_disk = {};
+    struct stat st;
+    if (pread(fd, &on_disk, sizeof(on_disk), 0) != sizeof(on_disk) ||
+        fstat(fd, &st) < 0 || on_disk.magic != LOCAL_SUBSCRIBER_STORE_MAGIC ||
+        on_disk.version != LOCAL_SUBSCRIBER_STORE_VERSION ||
+        on_disk.record_size != sizeof(LocalSubscriber) ||
+        on_disk.capacity == 0 ||
+        (on_disk.capacity & (on_disk.capacity - 1)) != 0 ||
+        static_cast<size_t>(st.st_size) != file_size(on_disk.capacity)) {
+      OAILOG_WARNING(LOG_S6A,
+                     "Local subscriber store %s has another layout, it is "
+                     "recreated\n",
+                     path.c_str());
+      ::close(fd);
+      return false;
+    }
+    capacity = on_disk.capacity;
+  }
+  void* addr = mmap(nullptr, file_size(capacity), PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    OAILOG_ERROR(LOG_S6A, "Failed to map local subscriber store %s: %s\n",
+                 path.c_str(), strerror(errno));
+    return false;
+  }
+  *header = static_cast<Header*>(addr);
+  *records = reinterpret_cast<LocalSubscriber*>(*header + 1);
+  if (create) {
+    // The file is zeroed by ftruncate, so are the slots
+    (*header)->magic = LOCAL_SUBSCRIBER_STORE_MAGIC;
+    (*header)->version = LOCAL_SUBSCRIBER_STORE_VERSION;
+    (*header)->record_size = sizeof(LocalSubscriber);
+    (*header)->capacity = capacity;
+  }
+  return true;
+}
+
+void S6aSubscriberStore::unmap(Header* header) {
+  if (header) {
+    size_t length = file_size(header->capacity);
+    msync(header, length, MS_SYNC);
+    munmap(header, length);
+  }
+}
+
+bool S6aSubscriberStore::grow() {
+  if (header_->capacity >= (1u << 31)) {
+    return false;
+  }
+  std::string tmp_path = path_ + ".tmp";
+  Header* header = nullptr;
+  LocalSubscriber* records = nullptr;
+  if (!map_file(tmp_path, header_->capacity * 2, true, &header, &records)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < header_->capacity; i++) {
+    if (records_[i].imsi[0] != '\0') {
+      *probe(records, header->capacity, records_[i].imsi) = records_[i];
+    }
+  }
+  header->count = header_->count;
+  header->sync_generation = header_->sync_generation;
+  msync(header, file_size(header->capacity), MS_SYNC);
+  if (rename(tmp_path.c_str(), path_.c_str()) < 0) {
+    OAILOG_ERROR(LOG_S6A, "Failed to replace local subscriber store %s: %s\n",
+                 path_.c_str(), strerror(errno));
+    unmap(header);
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  OAILOG_INFO(LOG_S6A, "Grew local subscriber store %s to %u slots\n",
+              path_.c_str(), header->capacity);
+  unmap(header_);
+  header_ = header;
+  records_ = records;
+  return true;
+}
+
+LocalSubscriber* S6aSubscriberStore::find(const char* imsi) {
+  LocalSubscriber* record = probe(records_, header_->capacity, imsi);
+  return record->imsi[0] == '\0' ? nullptr : record;
+}
+
+LocalSubscriber* S6aSubscriberStore::insert_slot(const char* imsi) {
+  LocalSubscriber* record = probe(records_, header_->capacity, imsi);
+  if (record->imsi[0] != '\0') {
+    return record;
+  }
+  if ((header_->count + 1) * 4ull > header_->capacity * 3ull) {
+    if (!grow()) {
+      return nullptr;
+    }
+    record = probe(records_, header_->capacity, imsi);
+  }
+  memset(record, 0, sizeof(*record));
+  strncpy(record->imsi, imsi, IMSI_BCD_DIGITS_MAX);
+  header_->count++;
+  return record;
+}
+
+void S6aSubscriberStore::erase(LocalSubscriber* record) {
+  // Backward shift deletion, no tombstones are left in the probe sequences
+  uint32_t mask = header_->capacity - 1;
+  uint32_t i = record - records_;
+  memset(&records_[i], 0, sizeof(LocalSubscriber));
+  for (uint32_t j = (i + 1) & mask; records_[j].imsi[0] != '\0';
+       j = (j + 1) & mask) {
+    uint32_t home = hash_imsi(records_[j].imsi) & mask;
+    // Distance from the home slot, the record may move back to i if i is
+    // not before its home slot
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      records_[i] = records_[j];
+      memset(&records_[j], 0, sizeof(LocalSubscriber));
+      i = j;
+    }
+  }
+  header_->count--;
+}
+
+bool S6aSubscriberStore::upsert(const LocalSubscriber& subscriber) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!header_ || !is_valid_imsi(subscriber.imsi)) {
+    return false;
+  }
+  LocalSubscriber* record = insert_slot(subscriber.imsi);
+  if (!record) {
+    return false;
+  }
+  uint64_t next_seq = record->next_seq;
+  *record = subscriber;
+  if (next_seq > record->next_seq) {
+    record->next_seq = next_seq;
+  }
+  record->sync_generation = header_->sync_generation;
+  return true;
+}
+
+bool S6aSubscriberStore::remove(const char* imsi) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!header_ || !is_valid_imsi(imsi)) {
+    return false;
+  }
+  LocalSubscriber* record = find(imsi);
+  if (!record) {
+    return false;
+  }
+  erase(record);
+  return true;
+}
+
+bool S6aSubscriberStore::lookup(const char* imsi, LocalSubscriber* subscriber,
+                                uint32_t seqs_to_reserve) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!header_ || !is_valid_imsi(imsi)) {
+    return false;
+  }
+  LocalSubscriber* record = find(imsi);
+  if (!record) {
+    return false;
+  }
+  *subscriber = *record;
+  record->next_seq += seqs_to_reserve;
+  return true;
+}
+
+bool S6aSubscriberStore::contains(const char* imsi) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!header_ || !is_valid_imsi(imsi)) {
+    return false;
+  }
+  return find(imsi) != nullptr;
+}
+
+bool S6aSubscriberStore::set_next_seq(const char* imsi, uint64_t next_seq) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!header_ || !is_valid_imsi(imsi)) {
+    return false;
+  }
+  LocalSubscriber* record = find(imsi);
+  if (!record) {
+    return false;
+  }
+  record->next_seq = next_seq;
+  return true;
+}
+
+void S6aSubscriberStore::begin_sync() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (header_) {
+    header_->sync_generation++;
+  }
+}
+
+size_t S6aSubscriberStore::end_sync() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!header_) {
+    return 0;
+  }
+  std::vector<std::string> stale;
+  for (uint32_t i = 0; i < header_->capacity; i++) {
+    if (records_[i].imsi[0] != '\0' &&
+        records_[i].sync_generation != header_->sync_generation) {
+      stale.emplace_back(records_[i].imsi);
+    }
+  }
+  for (const auto& imsi : stale) {
+    erase(find(imsi.c_str()));
+  }
+  msync(header_, file_size(header_->capacity), MS_ASYNC);
+  return stale.size();
+}
+
+size_t S6aSubscriberStore::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return header_ ? header_->count : 0;
+}
+
+uint32_t S6aSubscriberStore::capacity() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return header_ ? header_->capacity : 0;
+}
+
+}  // namespace lte
+}  // namespace magma
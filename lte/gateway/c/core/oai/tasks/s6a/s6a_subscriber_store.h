@@ -0,0 +1,146 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/common_types.h"
+}
+
+namespace magma {
+namespace lte {
+
+#define LOCAL_SUBSCRIBER_LTE_ACTIVE (1 << 0)
+#define LOCAL_SUBSCRIBER_EPC_FORBIDDEN (1 << 1)
+// Milenage with a 16 octet key and OPc
+#define LOCAL_SUBSCRIBER_AUTH_VALID (1 << 2)
+// Subscription profile other than the default one, only subscriberdb knows
+// its AMBR
+#define LOCAL_SUBSCRIBER_CUSTOM_PROFILE (1 << 3)
+
+struct LocalApnConfig {
+  char service_selection[APN_MAX_LENGTH + 1];
+  // PDN type of the S6a APN configuration, 0 for IPv4
+  uint8_t pdn_type;
+  int32_t qci;
+  uint8_t priority_level;
+  uint8_t preemption_capability;
+  uint8_t preemption_vulnerability;
+  uint32_t max_bandwidth_ul;
+  uint32_t max_bandwidth_dl;
+};
+
+/**
+ * Subscriber record of the local store, stored as is in the mapped file. The
+ * SEQ of the SQN is only ever moved forward by the store.
+ */
+struct LocalSubscriber {
+  char imsi[IMSI_BCD_DIGITS_MAX + 1];
+  uint8_t flags;
+  uint8_t key[16];
+  uint8_t opc[16];
+  // SEQ of the next authentication vector, SQN = SEQ || IND of TS 33.102 C.3
+  uint64_t next_seq;
+  uint64_t max_ul_bit_rate;
+  uint64_t max_dl_bit_rate;
+  // BCD encoded as in the ULA, TS 29.329
+  uint8_t msisdn[MSISDN_LENGTH + 1];
+  uint8_t msisdn_length;
+  uint8_t nb_apns;
+  LocalApnConfig apns[MAX_APN_PER_UE];
+  // Last sync the subscriber was seen in
+  uint32_t sync_generation;
+};
+
+/**
+ * Subscribers of the local S6a backend, in an open addressing hash table
+ * memory mapped from a file:
+ *  - lookups do not leave the MME, and do not allocate
+ *  - SEQ updates are plain stores in the shared mapping, they outlive an
+ *    MME restart without a write per authentication. SEQs lost to a host
+ *    crash are recovered by the UE resynchronisation.
+ *
+ * The table is rebuilt twice as large in a new file when it is 3/4 full.
+ * Methods are thread safe, the store is synced on its own thread.
+ */
+class S6aSubscriberStore {
+ public:
+  S6aSubscriberStore();
+  ~S6aSubscriberStore();
+
+  S6aSubscriberStore(const S6aSubscriberStore&) = delete;
+  S6aSubscriberStore& operator=(const S6aSubscriberStore&) = delete;
+
+  /**
+   * Map the store file, creating it if it is missing or was written with
+   * another record layout
+   * @param capacity initial number of slots of a new file, rounded up to a
+   * power of 2
+   */
+  bool open(const std::string& path, uint32_t capacity);
+  void close();
+
+  /**
+   * Add or replace a subscriber, keeping the larger of both SEQs
+   * @return false if the IMSI is invalid or the store could not grow
+   */
+  bool upsert(const LocalSubscriber& subscriber);
+
+  bool remove(const char* imsi);
+
+  /**
+   * Copy a subscriber out of the store
+   * @param seqs_to_reserve SEQs reserved for the caller, from the next_seq
+   * copied out
+   */
+  bool lookup(const char* imsi, LocalSubscriber* subscriber,
+              uint32_t seqs_to_reserve = 0);
+
+  bool contains(const char* imsi);
+
+  bool set_next_seq(const char* imsi, uint64_t next_seq);
+
+  /**
+   * Subscribers not upserted between begin_sync and end_sync are removed by
+   * end_sync, which returns their number
+   */
+  void begin_sync();
+  size_t end_sync();
+
+  size_t size();
+  uint32_t capacity();
+
+ private:
+  struct Header;
+
+  static size_t file_size(uint32_t capacity);
+  bool map_file(const std::string& path, uint32_t capacity, bool create,
+                Header** header, LocalSubscriber** records);
+  void unmap(Header* header);
+  bool grow();
+  LocalSubscriber* find(const char* imsi);
+  LocalSubscriber* insert_slot(const char* imsi);
+  void erase(LocalSubscriber* record);
+
+  std::mutex mutex_;
+  std::string path_;
+  Header* header_;
+  LocalSubscriber* records_;
+};
+
+}  // namespace lte
+}  // namespace magma
@@ -99,6 +99,16 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
       uint32_t assoc_id = SCTP_DATA_REQ(received_message_p).assoc_id;
       uint16_t stream = SCTP_DATA_REQ(received_message_p).stream;
       bstring payload = SCTP_DATA_REQ(received_message_p).payload;
+      shared_buffer_t* shared_payload =
+          SCTP_DATA_REQ(received_message_p).shared_payload;
+      struct tagbstring shared_view;
+      if (shared_payload) {
+        // Read only view, the buffer is released with the message
+        shared_view.mlen = -1;
+        shared_view.slen = shared_buffer_length(shared_payload);
+        shared_view.data = (unsigned char*)shared_buffer_data(shared_payload);
+        payload = &shared_view;
+      }
 
       if (sctpd_send_dl(ppid, assoc_id, stream, payload) < 0) {
         sctp_itti_send_lower_layer_conf(
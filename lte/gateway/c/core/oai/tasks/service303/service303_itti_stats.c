@@ -0,0 +1,126 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "lte/gateway/c/core/oai/include/service303.h"
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface.h"
+#include "lte/gateway/c/core/oai/lib/itti/itti_stats.h"
+#include "orc8r/gateway/c/common/service303/includes/MetricsHelpers.h"
+
+/*
+ * Histograms are exported as cumulative bucket gauges with an "le" label,
+ * for histogram_quantile to work on them, keeping only the decade bounds of
+ * the ITTI buckets to bound the number of series.
+ */
+#define DECADE_BUCKETS 6
+static const int decade_buckets[DECADE_BUCKETS] = {0, 3, 6, 9, 12, 15};
+
+static uint64_t last_enqueued[TASK_MAX];
+static uint64_t last_dequeued[TASK_MAX];
+static bool slowest_exported[TASK_MAX];
+static MessagesIds slowest_exported_message_id[TASK_MAX];
+static struct timespec last_read_time;
+
+static void export_histogram(const char* name, const char* task_name,
+                             const char* message_name,
+                             const itti_histogram_t* histogram) {
+  char metric[64];
+  char le[24];
+  uint64_t cumulative = 0;
+  int bucket = 0;
+
+  snprintf(metric, sizeof(metric), "%s_bucket", name);
+  for (int i = 0; i < DECADE_BUCKETS; i++) {
+    for (; bucket <= decade_buckets[i]; bucket++) {
+      cumulative += histogram->buckets[bucket];
+    }
+    snprintf(le, sizeof(le), "%" PRIu64,
+             itti_stats_bucket_bounds_us[decade_buckets[i]]);
+    set_gauge(metric, cumulative, 3, "task", task_name, "message",
+              message_name, "le", le);
+  }
+  set_gauge(metric, histogram->count, 3, "task", task_name, "message",
+            message_name, "le", "+Inf");
+  snprintf(metric, sizeof(metric), "%s_count", name);
+  set_gauge(metric, histogram->count, 2, "task", task_name, "message",
+            message_name);
+  snprintf(metric, sizeof(metric), "%s_sum", name);
+  set_gauge(metric, histogram->sum_us, 2, "task", task_name, "message",
+            message_name);
+}
+
+void service303_itti_statistics_read(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double elapsed_sec = (now.tv_sec - last_read_time.tv_sec) +
+                       (now.tv_nsec - last_read_time.tv_nsec) / 1e9;
+  bool first_read = last_read_time.tv_sec == 0 && last_read_time.tv_nsec == 0;
+  last_read_time = now;
+
+  for (task_id_t task_id = TASK_FIRST; task_id < TASK_MAX; task_id++) {
+    itti_task_stats_read_t task_stats;
+    if (!itti_stats_read_task(task_id, &task_stats)) {
+      continue;
+    }
+    const char* task_name = itti_get_task_name(task_id);
+
+    set_gauge("itti_queue_depth", task_stats.enqueued - task_stats.dequeued,
+              1, "task", task_name);
+    if (!first_read && elapsed_sec > 0) {
+      set_gauge("itti_enqueue_rate",
+                (task_stats.enqueued - last_enqueued[task_id]) / elapsed_sec,
+                1, "task", task_name);
+      set_gauge("itti_dequeue_rate",
+                (task_stats.dequeued - last_dequeued[task_id]) / elapsed_sec,
+                1, "task", task_name);
+    }
+    last_enqueued[task_id] = task_stats.enqueued;
+    last_dequeued[task_id] = task_stats.dequeued;
+
+    // A single series per task, labelled with the message of the slowest
+    // handler of the window
+    if (slowest_exported[task_id] &&
+        (task_stats.slowest_handler_us == 0 ||
+         slowest_exported_message_id[task_id] !=
+             task_stats.slowest_message_id)) {
+      remove_gauge("itti_slowest_handler_us", 2, "task", task_name, "message",
+                   itti_get_message_name(slowest_exported_message_id[task_id]));
+      slowest_exported[task_id] = false;
+    }
+    if (task_stats.slowest_handler_us > 0) {
+      set_gauge("itti_slowest_handler_us", task_stats.slowest_handler_us, 2,
+                "task", task_name, "message",
+                itti_get_message_name(task_stats.slowest_message_id));
+      slowest_exported[task_id] = true;
+      slowest_exported_message_id[task_id] = task_stats.slowest_message_id;
+    }
+
+    for (int message_id = 0; message_id < MESSAGES_ID_MAX; message_id++) {
+      itti_msg_stats_t msg_stats;
+      if (!itti_stats_read_message(task_id, (MessagesIds)message_id,
+                                   &msg_stats)) {
+        continue;
+      }
+      const char* message_name =
+          itti_get_message_name((MessagesIds)message_id);
+      export_histogram("itti_queue_wait_us", task_name, message_name,
+                       &msg_stats.queue_wait);
+      export_histogram("itti_handler_us", task_name, message_name,
+                       &msg_stats.handler);
+    }
+  }
+}
@@ -159,6 +159,7 @@ static void service303_message_exit(void) {
 }
 
 static int handle_display_timer(zloop_t* loop, int id, void* arg) {
+  service303_itti_statistics_read();
   service303_statistics_display();
   return 0;
 }
@@ -24,6 +24,10 @@
 
 struct in_addr;
 
+static bool reserve_restored_ue_ipv4_address(const hash_key_t keyP,
+                                             void* const elementP,
+                                             void* parameterP, void** resultP);
+
 void release_ue_ipv4_address(const char* imsi, const char* apn,
                              struct in_addr* addr) {
   increment_counter("ue_pdn_connection", 1, 2, "pdn_type", "ipv4", "result",
@@ -51,3 +55,43 @@ int get_ip_block(struct in_addr* netaddr, uint32_t* netmask) {
   }
   return rv;
 }
+
+void delegated_ue_ip_alloc_init(const pgw_config_t* pgw_config_p,
+                                hash_table_ts_t* state_teid_ht) {
+  if (!pgw_config_p->delegated_ip_alloc.enabled) {
+    return;
+  }
+  OAILOG_INFO(LOG_SPGW_APP, "Delegated UE IPv4 allocation enabled\n");
+  delegated_ip_alloc_init(SPGW_IP_LEASE_HOLDER,
+                          pgw_config_p->delegated_ip_alloc.lease_prefix_len,
+                          pgw_config_p->delegated_ip_alloc.low_watermark,
+                          pgw_config_p->delegated_ip_alloc.renew_before_secs,
+                          pgw_config_p->delegated_ip_alloc.max_sync_batch);
+  // Addresses allocated but not yet synced to mobilityd before a restart are
+  // only known from the restored UE contexts
+  hashtable_ts_apply_callback_on_elements(
+      state_teid_ht, reserve_restored_ue_ipv4_address, NULL, NULL);
+}
+
+static bool reserve_restored_ue_ipv4_address(const hash_key_t keyP,
+                                             void* const elementP,
+                                             void* parameterP, void** resultP) {
+  s_plus_p_gw_eps_bearer_context_information_t* ctxt_p =
+      (s_plus_p_gw_eps_bearer_context_information_t*)elementP;
+  sgw_eps_bearer_context_information_t* sgw_ctxt_p =
+      &ctxt_p->sgw_eps_bearer_context_information;
+  if (!sgw_ctxt_p->pdn_connection.apn_in_use) {
+    return false;
+  }
+  for (int i = 0; i < BEARERS_PER_UE; i++) {
+    sgw_eps_bearer_ctxt_t* bearer_p =
+        sgw_ctxt_p->pdn_connection.sgw_eps_bearers_array[i];
+    if (bearer_p && bearer_p->paa.pdn_type == IPv4) {
+      delegated_ip_alloc_reserve_ipv4((const char*)sgw_ctxt_p->imsi.digit,
+                                      sgw_ctxt_p->pdn_connection.apn_in_use,
+                                      &bearer_p->paa.ipv4_address);
+    }
+  }
+  // Keep iterating over every UE context
+  return false;
+}
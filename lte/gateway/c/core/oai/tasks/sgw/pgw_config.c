@@ -446,6 +446,52 @@ status_code_e pgw_config_parse_file(pgw_config_t* config_pP) {
     }
     OAILOG_DEBUG(LOG_SPGW_APP, "UE MTU : %u\n", config_pP->ue_mtu);
 
+    config_pP->delegated_ip_alloc.enabled = false;
+    config_pP->delegated_ip_alloc.lease_prefix_len = 26;
+    config_pP->delegated_ip_alloc.low_watermark = 16;
+    config_pP->delegated_ip_alloc.renew_before_secs = 60;
+    config_pP->delegated_ip_alloc.sync_interval_msec = 1000;
+    config_pP->delegated_ip_alloc.max_sync_batch = 1000;
+    subsetting = config_setting_get_member(
+        setting_pgw, PGW_CONFIG_STRING_DELEGATED_IP_ALLOCATION);
+    if (subsetting) {
+      libconfig_int value = 0;
+      if (config_setting_lookup_string(
+              subsetting, PGW_CONFIG_STRING_DELEGATED_IP_ALLOCATION_ENABLED,
+              (const char**)&astring) &&
+          strcasecmp(astring, "yes") == 0) {
+        config_pP->delegated_ip_alloc.enabled = true;
+      }
+      if (config_setting_lookup_int(
+              subsetting, PGW_CONFIG_STRING_LEASE_PREFIX_LEN, &value)) {
+        AssertFatal((value >= 16) && (value <= 30),
+                    "Bad delegated IP allocation lease prefix len %d", value);
+        config_pP->delegated_ip_alloc.lease_prefix_len = value;
+      }
+      if (config_setting_lookup_int(
+              subsetting, PGW_CONFIG_STRING_LEASE_LOW_WATERMARK, &value)) {
+        config_pP->delegated_ip_alloc.low_watermark = value;
+      }
+      if (config_setting_lookup_int(
+              subsetting, PGW_CONFIG_STRING_LEASE_RENEW_BEFORE_SECS, &value)) {
+        config_pP->delegated_ip_alloc.renew_before_secs = value;
+      }
+      if (config_setting_lookup_int(
+              subsetting, PGW_CONFIG_STRING_SYNC_INTERVAL_MSEC, &value)) {
+        AssertFatal(value > 0, "Bad delegated IP allocation sync interval %d",
+                    value);
+        config_pP->delegated_ip_alloc.sync_interval_msec = value;
+      }
+      if (config_setting_lookup_int(
+              subsetting, PGW_CONFIG_STRING_MAX_SYNC_BATCH, &value)) {
+        AssertFatal(value > 0, "Bad delegated IP allocation sync batch %d",
+                    value);
+        config_pP->delegated_ip_alloc.max_sync_batch = value;
+      }
+    }
+    OAILOG_DEBUG(LOG_SPGW_APP, "Delegated IP allocation : %s\n",
+                 config_pP->delegated_ip_alloc.enabled ? "yes" : "no");
+
     subsetting = config_setting_get_member(setting_pgw, PGW_CONFIG_STRING_PCEF);
     if (subsetting) {
       if ((config_setting_lookup_string(subsetting,
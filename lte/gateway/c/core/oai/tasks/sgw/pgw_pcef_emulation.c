@@ -34,7 +34,6 @@
 #include <string.h>
 
 #include "lte/gateway/c/core/oai/common/assertions.h"
-#include "lte/gateway/c/core/oai/common/async_system.h"
 #include "lte/gateway/c/core/oai/lib/bstr/bstrlib.h"
 #include "lte/gateway/c/core/oai/common/common_defs.h"
 #include "lte/gateway/c/core/oai/common/common_types.h"
@@ -45,6 +44,15 @@
 #include "lte/gateway/c/core/oai/include/pgw_config.h"
 #include "lte/gateway/c/core/oai/include/pgw_types.h"
 #include "lte/gateway/c/core/oai/include/spgw_config.h"
+#include "lte/gateway/c/core/oai/tasks/sgw/pgw_pcef_nft.h"
+
+#define PGW_PCEF_NFT_RULES_PER_PCC_RULE \
+  (SERVICE_DATA_FLOW_TEMPLATE_NB_PACKET_FILTERS_MAX * PCEF_NFT_CHAIN_MAX)
+
+static pcc_rule_t* pgw_pcef_emulation_inactive_rule(spgw_state_t* state_p,
+                                                    sdf_id_t sdf_id);
+static pcc_rule_t* pgw_pcef_emulation_activate_rule(spgw_state_t* state_p,
+                                                    sdf_id_t sdf_id);
 
 /*
  * Function that adds predefined PCC rules to PGW struct,
@@ -341,182 +349,124 @@ status_code_e pgw_pcef_emulation_init(spgw_state_t* state_p,
 
   for (int i = 0; i < (SDF_ID_MAX - 1); i++) {
     if (pgw_config_p->pcef.preload_static_sdf_identifiers[i]) {
-      pgw_pcef_emulation_apply_rule(
-          state_p, pgw_config_p->pcef.preload_static_sdf_identifiers[i],
-          pgw_config_p);
+      pgw_pcef_emulation_activate_rule(
+          state_p, pgw_config_p->pcef.preload_static_sdf_identifiers[i]);
     } else
       break;
   }
 
   if (pgw_config_p->pcef.automatic_push_dedicated_bearer_sdf_identifier) {
-    pgw_pcef_emulation_apply_rule(
+    pgw_pcef_emulation_activate_rule(
         state_p,
-        pgw_config_p->pcef.automatic_push_dedicated_bearer_sdf_identifier,
-        pgw_config_p);
+        pgw_config_p->pcef.automatic_push_dedicated_bearer_sdf_identifier);
   }
+  // Marking failures are not fatal, as with the former iptables rules
+  pgw_pcef_emulation_resync(state_p, pgw_config_p);
   return rc;
 }
 
 //------------------------------------------------------------------------------
-// may change sdf_id to PCC_rule name ?
-void pgw_pcef_emulation_apply_rule(spgw_state_t* state_p, const sdf_id_t sdf_id,
-                                   const pgw_config_t* const pgw_config_p) {
+// Returns a predefined PCC rule if it is not active yet
+static pcc_rule_t* pgw_pcef_emulation_inactive_rule(spgw_state_t* state_p,
+                                                    const sdf_id_t sdf_id) {
   pcc_rule_t* pcc_rule = NULL;
   hashtable_rc_t hrc = hashtable_ts_get(
       state_p->deactivated_predefined_pcc_rules, sdf_id, (void**)&pcc_rule);
 
-  if (HASH_TABLE_OK == hrc) {
-    if (!pcc_rule->is_activated) {
-      OAILOG_INFO(LOG_SPGW_APP, "Loading PCC rule %s\n", bdata(pcc_rule->name));
-      pcc_rule->is_activated = true;
-      for (int sdff_i = 0;
-           sdff_i < pcc_rule->sdf_template.number_of_packet_filters; sdff_i++) {
-        pgw_pcef_emulation_apply_sdf_filter(
-            &pcc_rule->sdf_template.sdf_filter[sdff_i], pcc_rule->sdf_id,
-            pgw_config_p);
-      }
-    }
+  if ((HASH_TABLE_OK == hrc) && !pcc_rule->is_activated) {
+    return pcc_rule;
   }
+  return NULL;
 }
 
 //------------------------------------------------------------------------------
-void pgw_pcef_emulation_apply_sdf_filter(
-    sdf_filter_t* const sdf_f, const sdf_id_t sdf_id,
-    const pgw_config_t* const pgw_config_p) {
-  if ((TRAFFIC_FLOW_TEMPLATE_BIDIRECTIONAL == sdf_f->direction) ||
-      (TRAFFIC_FLOW_TEMPLATE_DOWNLINK_ONLY == sdf_f->direction)) {
-    bstring filter = pgw_pcef_emulation_packet_filter_2_iptable_string(
-        &sdf_f->packetfiltercontents, sdf_f->direction);
-
-    bstring marking_command = NULL;
-    if ((TRAFFIC_FLOW_TEMPLATE_IPV4_REMOTE_ADDR_FLAG |
-         TRAFFIC_FLOW_TEMPLATE_IPV6_REMOTE_ADDR_FLAG) &
-        sdf_f->packetfiltercontents.flags) {
-      marking_command =
-          bformat("iptables -I POSTROUTING -t mangle  %s -j MARK --set-mark %d",
-                  bdata(filter), sdf_id);
-    } else {
-      // marking_command = bformat("iptables -I PREROUTING -t mangle
-      // --in-interface %s --dest %"PRIu8".%"PRIu8".%"PRIu8".%"PRIu8"/%"PRIu8"
-      // %s -j MARK --set-mark %d",
-      marking_command =
-          bformat("iptables -I POSTROUTING -t mangle  --dest %" PRIu8 ".%" PRIu8
-                  ".%" PRIu8 ".%" PRIu8 "/%" PRIu8 " %s -j MARK --set-mark %d",
-                  NIPADDR(pgw_config_p->ue_pool_addr[0].s_addr),
-                  pgw_config_p->ue_pool_mask[0], bdata(filter), sdf_id);
-    }
-    bdestroy_wrapper(&filter);
-    async_system_command(TASK_ASYNC_SYSTEM, false, bdata(marking_command));
-    bdestroy_wrapper(&marking_command);
-
-    // for UE <-> PGW traffic
-    filter = pgw_pcef_emulation_packet_filter_2_iptable_string(
-        &sdf_f->packetfiltercontents, sdf_f->direction);
-
-    marking_command = NULL;
-    if ((TRAFFIC_FLOW_TEMPLATE_IPV4_REMOTE_ADDR_FLAG |
-         TRAFFIC_FLOW_TEMPLATE_IPV6_REMOTE_ADDR_FLAG) &
-        sdf_f->packetfiltercontents.flags) {
-      marking_command =
-          bformat("iptables -I OUTPUT -t mangle  %s -j MARK --set-mark %d",
-                  bdata(filter), sdf_id);
-    } else {
-      marking_command =
-          bformat("iptables -I OUTPUT -t mangle  --dest %" PRIu8 ".%" PRIu8
-                  ".%" PRIu8 ".%" PRIu8 "/%" PRIu8 " %s -j MARK --set-mark %d",
-                  NIPADDR(pgw_config_p->ue_pool_addr[0].s_addr),
-                  pgw_config_p->ue_pool_mask[0], bdata(filter), sdf_id);
-    }
-    bdestroy_wrapper(&filter);
-    async_system_command(TASK_ASYNC_SYSTEM, false, bdata(marking_command));
-    bdestroy_wrapper(&marking_command);
+// Activates a predefined PCC rule, returns it if it was not active yet
+static pcc_rule_t* pgw_pcef_emulation_activate_rule(spgw_state_t* state_p,
+                                                    const sdf_id_t sdf_id) {
+  pcc_rule_t* pcc_rule = pgw_pcef_emulation_inactive_rule(state_p, sdf_id);
+  if (pcc_rule) {
+    OAILOG_INFO(LOG_SPGW_APP, "Loading PCC rule %s\n", bdata(pcc_rule->name));
+    pcc_rule->is_activated = true;
   }
+  return pcc_rule;
 }
 
 //------------------------------------------------------------------------------
-bstring pgw_pcef_emulation_packet_filter_2_iptable_string(
-    packet_filter_contents_t* const packetfiltercontents, uint8_t direction) {
-  bstring bstr = bfromcstralloc(64, " ");
-
-  if ((TRAFFIC_FLOW_TEMPLATE_DOWNLINK_ONLY == direction) ||
-      (TRAFFIC_FLOW_TEMPLATE_BIDIRECTIONAL == direction)) {
-    if (TRAFFIC_FLOW_TEMPLATE_IPV4_REMOTE_ADDR_FLAG &
-        packetfiltercontents->flags) {
-      bformata(bstr, "  --destination %d.%d.%d.%d/%d.%d.%d.%d",
-               packetfiltercontents->ipv4remoteaddr[0].addr,
-               packetfiltercontents->ipv4remoteaddr[1].addr,
-               packetfiltercontents->ipv4remoteaddr[2].addr,
-               packetfiltercontents->ipv4remoteaddr[3].addr,
-               packetfiltercontents->ipv4remoteaddr[0].mask,
-               packetfiltercontents->ipv4remoteaddr[1].mask,
-               packetfiltercontents->ipv4remoteaddr[2].mask,
-               packetfiltercontents->ipv4remoteaddr[3].mask);
-    } else {
-      bformata(bstr, " --source %d.%d.%d.%d/%d.%d.%d.%d",
-               packetfiltercontents->ipv4remoteaddr[0].addr,
-               packetfiltercontents->ipv4remoteaddr[1].addr,
-               packetfiltercontents->ipv4remoteaddr[2].addr,
-               packetfiltercontents->ipv4remoteaddr[3].addr,
-               packetfiltercontents->ipv4remoteaddr[0].mask,
-               packetfiltercontents->ipv4remoteaddr[1].mask,
-               packetfiltercontents->ipv4remoteaddr[2].mask,
-               packetfiltercontents->ipv4remoteaddr[3].mask);
+// Appends the marking rules of the SDF filters of pcc_rule to rules, which
+// has room for PGW_PCEF_NFT_RULES_PER_PCC_RULE more
+static int pgw_pcef_emulation_pcc_rule_2_nft(
+    const pcc_rule_t* const pcc_rule, const pgw_config_t* const pgw_config_p,
+    pcef_nft_rule_t* rules) {
+  int num_rules = 0;
+  for (int sdff_i = 0;
+       sdff_i < pcc_rule->sdf_template.number_of_packet_filters; sdff_i++) {
+    int n = pcef_nft_rules_from_sdf_filter(
+        &pcc_rule->sdf_template.sdf_filter[sdff_i], pcc_rule->sdf_id,
+        pgw_config_p->ue_pool_addr[0], pgw_config_p->ue_pool_mask[0],
+        &rules[num_rules]);
+    if (n && rules[num_rules].error) {
+      OAILOG_ERROR(LOG_SPGW_APP,
+                   "Packet filter %d of PCC rule %s cannot be programmed: %s\n",
+                   sdff_i, bdata(pcc_rule->name),
+                   strerror(-rules[num_rules].error));
     }
+    num_rules += n;
   }
-  if (TRAFFIC_FLOW_TEMPLATE_IPV6_REMOTE_ADDR_FLAG &
-      packetfiltercontents->flags) {
-    Fatal("TODO Implement pgw_pcef_emulation_packet_filter_2_iptable_string");
-  }
-  if (TRAFFIC_FLOW_TEMPLATE_PROTOCOL_NEXT_HEADER_FLAG &
-      packetfiltercontents->flags) {
-    bformata(bstr, " --protocol %u",
-             packetfiltercontents->protocolidentifier_nextheader);
-  }
-  if (TRAFFIC_FLOW_TEMPLATE_SINGLE_LOCAL_PORT_FLAG &
-      packetfiltercontents->flags) {
-    if ((TRAFFIC_FLOW_TEMPLATE_DOWNLINK_ONLY == direction) ||
-        (TRAFFIC_FLOW_TEMPLATE_BIDIRECTIONAL == direction)) {
-      bformata(bstr, " --destination-port %" PRIu16 " ",
-               packetfiltercontents->singlelocalport);
-    } else if (TRAFFIC_FLOW_TEMPLATE_UPLINK_ONLY == direction) {
-      bformata(bstr, " --source-port %" PRIu16 " ",
-               packetfiltercontents->singlelocalport);
-    }
-  }
-  if (TRAFFIC_FLOW_TEMPLATE_LOCAL_PORT_RANGE_FLAG &
-      packetfiltercontents->flags) {
-    Fatal("TODO LOCAL_PORT_RANGE");
+  return num_rules;
+}
+
+//------------------------------------------------------------------------------
+// Replaces the marking rules in the kernel with those of all activated
+// predefined PCC rules, in one transaction
+status_code_e pgw_pcef_emulation_resync(spgw_state_t* state_p,
+                                        const pgw_config_t* const pgw_config_p) {
+  pcef_nft_rule_t* rules =
+      calloc(SDF_ID_MAX * PGW_PCEF_NFT_RULES_PER_PCC_RULE, sizeof(*rules));
+  if (!rules) {
+    return RETURNerror;
   }
-  if (TRAFFIC_FLOW_TEMPLATE_SINGLE_REMOTE_PORT_FLAG &
-      packetfiltercontents->flags) {
-    if ((TRAFFIC_FLOW_TEMPLATE_DOWNLINK_ONLY == direction) ||
-        (TRAFFIC_FLOW_TEMPLATE_BIDIRECTIONAL == direction)) {
-      bformata(bstr, " --source-port %" PRIu16 " ",
-               packetfiltercontents->singleremoteport);
-    } else if (TRAFFIC_FLOW_TEMPLATE_UPLINK_ONLY == direction) {
-      bformata(bstr, " --destination-port %" PRIu16 " ",
-               packetfiltercontents->singleremoteport);
+  int num_rules = 0;
+  for (int sdf_id = 0; sdf_id < SDF_ID_MAX; sdf_id++) {
+    pcc_rule_t* pcc_rule = NULL;
+    hashtable_rc_t hrc = hashtable_ts_get(
+        state_p->deactivated_predefined_pcc_rules, sdf_id, (void**)&pcc_rule);
+    if ((HASH_TABLE_OK == hrc) && pcc_rule->is_activated) {
+      num_rules += pgw_pcef_emulation_pcc_rule_2_nft(pcc_rule, pgw_config_p,
+                                                      &rules[num_rules]);
     }
   }
-  if (TRAFFIC_FLOW_TEMPLATE_REMOTE_PORT_RANGE_FLAG &
-      packetfiltercontents->flags) {
-    Fatal("TODO REMOTE_PORT_RANGE");
-  }
-  if (TRAFFIC_FLOW_TEMPLATE_SECURITY_PARAMETER_INDEX_FLAG &
-      packetfiltercontents->flags) {
-    bformata(bstr, " -m esp --espspi %" PRIu32 " ",
-             packetfiltercontents->securityparameterindex);
+  status_code_e rc = pcef_nft_commit(rules, num_rules, true);
+  if (RETURNok != rc) {
+    OAILOG_ERROR(LOG_SPGW_APP, "Failed to resync %d SDF marking rules\n",
+                 num_rules);
   }
-  if (TRAFFIC_FLOW_TEMPLATE_TYPE_OF_SERVICE_TRAFFIC_CLASS_FLAG &
-      packetfiltercontents->flags) {
-    // TODO mask
-    bformata(bstr, " -m tos --tos 0x%02X",
-             packetfiltercontents->typdeofservice_trafficclass.value);
+  free(rules);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+// may change sdf_id to PCC_rule name ?
+status_code_e pgw_pcef_emulation_apply_rule(
+    spgw_state_t* state_p, const sdf_id_t sdf_id,
+    const pgw_config_t* const pgw_config_p) {
+  pcc_rule_t* pcc_rule = pgw_pcef_emulation_inactive_rule(state_p, sdf_id);
+  if (!pcc_rule) {
+    return RETURNok;
   }
-  if (TRAFFIC_FLOW_TEMPLATE_FLOW_LABEL_FLAG & packetfiltercontents->flags) {
-    Fatal("TODO Implement pgw_pcef_emulation_packet_filter_2_iptable_string");
+  pcef_nft_rule_t rules[PGW_PCEF_NFT_RULES_PER_PCC_RULE];
+  int num_rules =
+      pgw_pcef_emulation_pcc_rule_2_nft(pcc_rule, pgw_config_p, rules);
+  // All filters of the rule are marked, or none. The rule is only activated
+  // once marked, so that applying it again retries a failed commit.
+  status_code_e rc = pcef_nft_commit(rules, num_rules, false);
+  if (RETURNok != rc) {
+    OAILOG_ERROR(LOG_SPGW_APP, "Failed to program PCC rule %s\n",
+                 bdata(pcc_rule->name));
+    return rc;
   }
-  return bstr;
+  OAILOG_INFO(LOG_SPGW_APP, "Loading PCC rule %s\n", bdata(pcc_rule->name));
+  pcc_rule->is_activated = true;
+  return rc;
 }
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,513 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*! \file pgw_pcef_nft.c
+  \brief Netlink programming of the PCEF emulation SDF marking rules.
+*/
+
+#include "lte/gateway/c/core/oai/tasks/sgw/pgw_pcef_nft.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <libmnl/libmnl.h>
+#include <linux/netfilter.h>
+#include <linux/netfilter/nf_tables.h>
+#include <linux/netfilter/nfnetlink.h>
+#include <linux/netfilter_ipv4.h>
+#include <netinet/ip.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "lte/gateway/c/core/oai/common/log.h"
+#include "lte/gateway/c/core/oai/lib/3gpp/3gpp_24.008.h"
+
+#ifndef NETLINK_CAP_ACK
+#define NETLINK_CAP_ACK 10
+#endif
+
+#define PCEF_NFT_ACK_TIMEOUT_SEC 5
+
+#define PCEF_NFT_ANY_PORT_FLAGS                                                \
+  (TRAFFIC_FLOW_TEMPLATE_SINGLE_LOCAL_PORT_FLAG |                              \
+   TRAFFIC_FLOW_TEMPLATE_LOCAL_PORT_RANGE_FLAG |                               \
+   TRAFFIC_FLOW_TEMPLATE_SINGLE_REMOTE_PORT_FLAG |                             \
+   TRAFFIC_FLOW_TEMPLATE_REMOTE_PORT_RANGE_FLAG)
+
+static const char* const chain_names[PCEF_NFT_CHAIN_MAX] = {
+    PCEF_NFT_CHAIN_POSTROUTING_NAME, PCEF_NFT_CHAIN_OUTPUT_NAME};
+
+//------------------------------------------------------------------------------
+static uint32_t prefix_to_mask(uint8_t prefix) {
+  if (prefix == 0) return 0;
+  if (prefix >= 32) return htonl(0xffffffff);
+  return htonl(0xffffffff << (32 - prefix));
+}
+
+//------------------------------------------------------------------------------
+int pcef_nft_rules_from_sdf_filter(const sdf_filter_t* sdf_f,
+                                   const sdf_id_t sdf_id,
+                                   const struct in_addr ue_pool_addr,
+                                   const uint8_t ue_pool_prefix,
+                                   pcef_nft_rule_t rules[PCEF_NFT_CHAIN_MAX]) {
+  if ((TRAFFIC_FLOW_TEMPLATE_BIDIRECTIONAL != sdf_f->direction) &&
+      (TRAFFIC_FLOW_TEMPLATE_DOWNLINK_ONLY != sdf_f->direction)) {
+    return 0;
+  }
+  const packet_filter_contents_t* pf = &sdf_f->packetfiltercontents;
+  pcef_nft_rule_t rule;
+  memset(&rule, 0, sizeof(rule));
+  rule.mark = sdf_id;
+
+  if (TRAFFIC_FLOW_TEMPLATE_IPV4_REMOTE_ADDR_FLAG & pf->flags) {
+    uint8_t* addr = (uint8_t*)&rule.daddr.s_addr;
+    uint8_t* mask = (uint8_t*)&rule.dmask.s_addr;
+    for (int i = 0; i < TRAFFIC_FLOW_TEMPLATE_IPV4_ADDR_SIZE; i++) {
+      mask[i] = pf->ipv4remoteaddr[i].mask;
+      addr[i] = pf->ipv4remoteaddr[i].addr & mask[i];
+    }
+  } else {
+    // Traffic of any remote host towards the UE pool
+    rule.dmask.s_addr = prefix_to_mask(ue_pool_prefix);
+    rule.daddr.s_addr = ue_pool_addr.s_addr & rule.dmask.s_addr;
+  }
+  if (rule.dmask.s_addr) {
+    rule.match |= PCEF_NFT_MATCH_DADDR;
+  }
+  if ((TRAFFIC_FLOW_TEMPLATE_IPV6_REMOTE_ADDR_FLAG |
+       TRAFFIC_FLOW_TEMPLATE_FLOW_LABEL_FLAG) &
+      pf->flags) {
+    rule.error = -EOPNOTSUPP;
+  }
+  if (TRAFFIC_FLOW_TEMPLATE_PROTOCOL_NEXT_HEADER_FLAG & pf->flags) {
+    rule.match |= PCEF_NFT_MATCH_PROTOCOL;
+    rule.protocol = pf->protocolidentifier_nextheader;
+  }
+  // Downlink: the local port is the destination port of the UE, the remote
+  // port the source port of the peer
+  if (TRAFFIC_FLOW_TEMPLATE_SINGLE_LOCAL_PORT_FLAG & pf->flags) {
+    rule.match |= PCEF_NFT_MATCH_DPORT;
+    rule.dport_low = rule.dport_high = pf->singlelocalport;
+  } else if (TRAFFIC_FLOW_TEMPLATE_LOCAL_PORT_RANGE_FLAG & pf->flags) {
+    rule.match |= PCEF_NFT_MATCH_DPORT;
+    rule.dport_low = pf->localportrange.lowlimit;
+    rule.dport_high = pf->localportrange.highlimit;
+  }
+  if (TRAFFIC_FLOW_TEMPLATE_SINGLE_REMOTE_PORT_FLAG & pf->flags) {
+    rule.match |= PCEF_NFT_MATCH_SPORT;
+    rule.sport_low = rule.sport_high = pf->singleremoteport;
+  } else if (TRAFFIC_FLOW_TEMPLATE_REMOTE_PORT_RANGE_FLAG & pf->flags) {
+    rule.match |= PCEF_NFT_MATCH_SPORT;
+    rule.sport_low = pf->remoteportrange.lowlimit;
+    rule.sport_high = pf->remoteportrange.highlimit;
+  }
+  if ((rule.sport_low > rule.sport_high) ||
+      (rule.dport_low > rule.dport_high)) {
+    rule.error = -EINVAL;
+  }
+  // Ports are only defined for a transport protocol given in the filter
+  if ((PCEF_NFT_ANY_PORT_FLAGS & pf->flags) &&
+      (!(rule.match & PCEF_NFT_MATCH_PROTOCOL) ||
+       ((IPPROTO_TCP != rule.protocol) && (IPPROTO_UDP != rule.protocol) &&
+        (IPPROTO_SCTP != rule.protocol)))) {
+    rule.error = -EINVAL;
+  }
+  if (TRAFFIC_FLOW_TEMPLATE_SECURITY_PARAMETER_INDEX_FLAG & pf->flags) {
+    if ((rule.match & PCEF_NFT_MATCH_PROTOCOL) &&
+        (IPPROTO_ESP != rule.protocol)) {
+      rule.error = -EINVAL;
+    }
+    rule.match |= PCEF_NFT_MATCH_PROTOCOL | PCEF_NFT_MATCH_SPI;
+    rule.protocol = IPPROTO_ESP;
+    rule.spi = pf->securityparameterindex;
+  }
+  if (TRAFFIC_FLOW_TEMPLATE_TYPE_OF_SERVICE_TRAFFIC_CLASS_FLAG & pf->flags) {
+    rule.match |= PCEF_NFT_MATCH_TOS;
+    rule.tos_mask = pf->typdeofservice_trafficclass.mask
+                        ? pf->typdeofservice_trafficclass.mask
+                        : 0xff;
+    rule.tos = pf->typdeofservice_trafficclass.value & rule.tos_mask;
+  }
+
+  for (int chain = 0; chain < PCEF_NFT_CHAIN_MAX; chain++) {
+    rules[chain] = rule;
+    rules[chain].chain = chain;
+  }
+  return PCEF_NFT_CHAIN_MAX;
+}
+
+//------------------------------------------------------------------------------
+static status_code_e batch_reserve(pcef_nft_batch_t* batch, size_t room) {
+  if (batch->size - batch->len >= room) return RETURNok;
+  size_t size = batch->size ? batch->size : 8 * PCEF_NFT_RULE_MSG_MAX;
+  while (size - batch->len < room) size *= 2;
+  char* buf = realloc(batch->buf, size);
+  if (!buf) return RETURNerror;
+  batch->buf = buf;
+  batch->size = size;
+  return RETURNok;
+}
+
+static struct nlmsghdr* batch_put_msg(pcef_nft_batch_t* batch, uint16_t type,
+                                      uint8_t family, uint16_t flags,
+                                      uint32_t seq, uint16_t res_id) {
+  struct nlmsghdr* nlh = mnl_nlmsg_put_header(batch->buf + batch->len);
+  nlh->nlmsg_type = type;
+  nlh->nlmsg_flags = NLM_F_REQUEST | flags;
+  nlh->nlmsg_seq = seq;
+  struct nfgenmsg* nfg = mnl_nlmsg_put_extra_header(nlh, sizeof(*nfg));
+  nfg->nfgen_family = family;
+  nfg->version = NFNETLINK_V0;
+  nfg->res_id = htons(res_id);
+  return nlh;
+}
+
+static struct nlmsghdr* batch_put_nft_msg(pcef_nft_batch_t* batch,
+                                          uint16_t nft_type, uint16_t flags,
+                                          uint32_t seq) {
+  return batch_put_msg(batch, (NFNL_SUBSYS_NFTABLES << 8) | nft_type,
+                       NFPROTO_IPV4, flags, seq, 0);
+}
+
+static void batch_end_msg(pcef_nft_batch_t* batch, struct nlmsghdr* nlh) {
+  batch->len += nlh->nlmsg_len;
+}
+
+//------------------------------------------------------------------------------
+static void put_data(struct nlmsghdr* nlh, uint16_t type, const void* data,
+                     size_t len) {
+  struct nlattr* nest = mnl_attr_nest_start(nlh, type);
+  mnl_attr_put(nlh, NFTA_DATA_VALUE, len, data);
+  mnl_attr_nest_end(nlh, nest);
+}
+
+static struct nlattr* expr_start(struct nlmsghdr* nlh, const char* name,
+                                 struct nlattr** data) {
+  struct nlattr* elem = mnl_attr_nest_start(nlh, NFTA_LIST_ELEM);
+  mnl_attr_put_strz(nlh, NFTA_EXPR_NAME, name);
+  *data = mnl_attr_nest_start(nlh, NFTA_EXPR_DATA);
+  return elem;
+}
+
+static void expr_end(struct nlmsghdr* nlh, struct nlattr* elem,
+                     struct nlattr* data) {
+  mnl_attr_nest_end(nlh, data);
+  mnl_attr_nest_end(nlh, elem);
+}
+
+static void expr_payload(struct nlmsghdr* nlh, uint32_t base, uint32_t offset,
+                         uint32_t len) {
+  struct nlattr* data;
+  struct nlattr* elem = expr_start(nlh, "payload", &data);
+  mnl_attr_put_u32(nlh, NFTA_PAYLOAD_DREG, htonl(NFT_REG_1));
+  mnl_attr_put_u32(nlh, NFTA_PAYLOAD_BASE, htonl(base));
+  mnl_attr_put_u32(nlh, NFTA_PAYLOAD_OFFSET, htonl(offset));
+  mnl_attr_put_u32(nlh, NFTA_PAYLOAD_LEN, htonl(len));
+  expr_end(nlh, elem, data);
+}
+
+static void expr_bitwise(struct nlmsghdr* nlh, const void* mask,
+                         uint32_t len) {
+  static const uint8_t zero[4] = {0};
+  struct nlattr* data;
+  struct nlattr* elem = expr_start(nlh, "bitwise", &data);
+  mnl_attr_put_u32(nlh, NFTA_BITWISE_SREG, htonl(NFT_REG_1));
+  mnl_attr_put_u32(nlh, NFTA_BITWISE_DREG, htonl(NFT_REG_1));
+  mnl_attr_put_u32(nlh, NFTA_BITWISE_LEN, htonl(len));
+  put_data(nlh, NFTA_BITWISE_MASK, mask, len);
+  put_data(nlh, NFTA_BITWISE_XOR, zero, len);
+  expr_end(nlh, elem, data);
+}
+
+static void expr_cmp(struct nlmsghdr* nlh, enum nft_cmp_ops op,
+                     const void* value, uint32_t len) {
+  struct nlattr* data;
+  struct nlattr* elem = expr_start(nlh, "cmp", &data);
+  mnl_attr_put_u32(nlh, NFTA_CMP_SREG, htonl(NFT_REG_1));
+  mnl_attr_put_u32(nlh, NFTA_CMP_OP, htonl(op));
+  put_data(nlh, NFTA_CMP_DATA, value, len);
+  expr_end(nlh, elem, data);
+}
+
+static void expr_set_mark(struct nlmsghdr* nlh, uint32_t mark) {
+  struct nlattr* data;
+  struct nlattr* elem = expr_start(nlh, "immediate", &data);
+  mnl_attr_put_u32(nlh, NFTA_IMMEDIATE_DREG, htonl(NFT_REG_1));
+  // The mark is in host byte order, like the meta key it is written to
+  put_data(nlh, NFTA_IMMEDIATE_DATA, &mark, sizeof(mark));
+  expr_end(nlh, elem, data);
+
+  elem = expr_start(nlh, "meta", &data);
+  mnl_attr_put_u32(nlh, NFTA_META_KEY, htonl(NFT_META_MARK));
+  mnl_attr_put_u32(nlh, NFTA_META_SREG, htonl(NFT_REG_1));
+  expr_end(nlh, elem, data);
+}
+
+// Matches len bytes of the header at offset against value, under mask if
+// it is not all ones
+static void match_field(struct nlmsghdr* nlh, uint32_t base, uint32_t offset,
+                        const void* value, const void* mask, uint32_t len) {
+  static const uint8_t all_ones[4] = {0xff, 0xff, 0xff, 0xff};
+  expr_payload(nlh, base, offset, len);
+  if (mask && memcmp(mask, all_ones, len)) {
+    expr_bitwise(nlh, mask, len);
+  }
+  expr_cmp(nlh, NFT_CMP_EQ, value, len);
+}
+
+// Big endian values compare like the numbers in the register
+static void match_port(struct nlmsghdr* nlh, uint32_t offset, uint16_t low,
+                       uint16_t high) {
+  uint16_t low_be = htons(low);
+  uint16_t high_be = htons(high);
+  expr_payload(nlh, NFT_PAYLOAD_TRANSPORT_HEADER, offset, sizeof(uint16_t));
+  if (low == high) {
+    expr_cmp(nlh, NFT_CMP_EQ, &low_be, sizeof(low_be));
+  } else {
+    expr_cmp(nlh, NFT_CMP_GTE, &low_be, sizeof(low_be));
+    expr_cmp(nlh, NFT_CMP_LTE, &high_be, sizeof(high_be));
+  }
+}
+
+//------------------------------------------------------------------------------
+static void batch_put_table(pcef_nft_batch_t* batch, uint16_t nft_type,
+                            uint16_t flags, uint32_t seq) {
+  struct nlmsghdr* nlh = batch_put_nft_msg(batch, nft_type, flags, seq);
+  mnl_attr_put_strz(nlh, NFTA_TABLE_NAME, PCEF_NFT_TABLE);
+  batch_end_msg(batch, nlh);
+}
+
+static void batch_put_chain(pcef_nft_batch_t* batch, pcef_nft_chain_t chain,
+                            uint32_t seq) {
+  struct nlmsghdr* nlh =
+      batch_put_nft_msg(batch, NFT_MSG_NEWCHAIN, NLM_F_CREATE, seq);
+  mnl_attr_put_strz(nlh, NFTA_CHAIN_TABLE, PCEF_NFT_TABLE);
+  mnl_attr_put_strz(nlh, NFTA_CHAIN_NAME, chain_names[chain]);
+  struct nlattr* hook = mnl_attr_nest_start(nlh, NFTA_CHAIN_HOOK);
+  mnl_attr_put_u32(nlh, NFTA_HOOK_HOOKNUM,
+                   htonl(PCEF_NFT_CHAIN_POSTROUTING == chain
+                             ? NF_INET_POST_ROUTING
+                             : NF_INET_LOCAL_OUT));
+  mnl_attr_put_u32(nlh, NFTA_HOOK_PRIORITY, htonl(NF_IP_PRI_MANGLE));
+  mnl_attr_nest_end(nlh, hook);
+  // Like the mangle OUTPUT chain, a route chain reroutes a packet whose
+  // mark changed
+  mnl_attr_put_strz(nlh, NFTA_CHAIN_TYPE,
+                    PCEF_NFT_CHAIN_POSTROUTING == chain ? "filter" : "route");
+  batch_end_msg(batch, nlh);
+}
+
+static void batch_put_rule(pcef_nft_batch_t* batch,
+                           const pcef_nft_rule_t* rule, uint32_t seq) {
+  // Without NLM_F_APPEND the rule goes to the head of the chain
+  struct nlmsghdr* nlh =
+      batch_put_nft_msg(batch, NFT_MSG_NEWRULE, NLM_F_CREATE, seq);
+  mnl_attr_put_strz(nlh, NFTA_RULE_TABLE, PCEF_NFT_TABLE);
+  mnl_attr_put_strz(nlh, NFTA_RULE_CHAIN, chain_names[rule->chain]);
+  struct nlattr* exprs = mnl_attr_nest_start(nlh, NFTA_RULE_EXPRESSIONS);
+  if (rule->match & PCEF_NFT_MATCH_PROTOCOL) {
+    match_field(nlh, NFT_PAYLOAD_NETWORK_HEADER,
+                offsetof(struct iphdr, protocol), &rule->protocol, NULL,
+                sizeof(rule->protocol));
+  }
+  if (rule->match & PCEF_NFT_MATCH_DADDR) {
+    match_field(nlh, NFT_PAYLOAD_NETWORK_HEADER,
+                offsetof(struct iphdr, daddr), &rule->daddr,
+                &rule->dmask, sizeof(rule->daddr));
+  }
+  if (rule->match & PCEF_NFT_MATCH_SADDR) {
+    match_field(nlh, NFT_PAYLOAD_NETWORK_HEADER,
+                offsetof(struct iphdr, saddr), &rule->saddr,
+                &rule->smask, sizeof(rule->saddr));
+  }
+  if (rule->match & PCEF_NFT_MATCH_TOS) {
+    match_field(nlh, NFT_PAYLOAD_NETWORK_HEADER,
+                offsetof(struct iphdr, tos), &rule->tos, &rule->tos_mask,
+                sizeof(rule->tos));
+  }
+  // Source and destination ports are at the same place in TCP, UDP and SCTP
+  if (rule->match & PCEF_NFT_MATCH_SPORT) {
+    match_port(nlh, 0, rule->sport_low, rule->sport_high);
+  }
+  if (rule->match & PCEF_NFT_MATCH_DPORT) {
+    match_port(nlh, 2, rule->dport_low, rule->dport_high);
+  }
+  if (rule->match & PCEF_NFT_MATCH_SPI) {
+    uint32_t spi_be = htonl(rule->spi);
+    match_field(nlh, NFT_PAYLOAD_TRANSPORT_HEADER, 0, &spi_be, NULL,
+                sizeof(spi_be));
+  }
+  expr_set_mark(nlh, rule->mark);
+  mnl_attr_nest_end(nlh, exprs);
+  batch_end_msg(batch, nlh);
+}
+
+//------------------------------------------------------------------------------
+status_code_e pcef_nft_batch_build(pcef_nft_batch_t* batch, uint32_t seq,
+                                   bool resync, const pcef_nft_rule_t* rules,
+                                   int num_rules) {
+  memset(batch, 0, sizeof(*batch));
+  if (num_rules > 0) {
+    batch->rule_of_seq = calloc(num_rules, sizeof(int));
+    if (!batch->rule_of_seq) return RETURNerror;
+  }
+  if (RETURNok != batch_reserve(batch, 8 * PCEF_NFT_RULE_MSG_MAX)) {
+    pcef_nft_batch_free(batch);
+    return RETURNerror;
+  }
+
+  batch->seq_begin = seq;
+  struct nlmsghdr* nlh =
+      batch_put_msg(batch, NFNL_MSG_BATCH_BEGIN, AF_UNSPEC, 0, seq++,
+                    NFNL_SUBSYS_NFTABLES);
+  batch_end_msg(batch, nlh);
+
+  // Creating the table first lets the delete succeed when there is none
+  batch_put_table(batch, NFT_MSG_NEWTABLE, NLM_F_CREATE, seq++);
+  if (resync) {
+    batch_put_table(batch, NFT_MSG_DELTABLE, 0, seq++);
+    batch_put_table(batch, NFT_MSG_NEWTABLE, NLM_F_CREATE, seq++);
+  }
+  batch_put_chain(batch, PCEF_NFT_CHAIN_POSTROUTING, seq++);
+  size_t last_msg = batch->len;
+  batch_put_chain(batch, PCEF_NFT_CHAIN_OUTPUT, seq++);
+
+  batch->seq_rule = seq;
+  for (int i = 0; i < num_rules; i++) {
+    if (rules[i].error) continue;
+    if (RETURNok != batch_reserve(batch, 2 * PCEF_NFT_RULE_MSG_MAX)) {
+      pcef_nft_batch_free(batch);
+      return RETURNerror;
+    }
+    last_msg = batch->len;
+    batch_put_rule(batch, &rules[i], seq++);
+    batch->rule_of_seq[batch->num_rule_msgs++] = i;
+  }
+  // Only the last message is acknowledged, the kernel reports every
+  // message that failed anyway
+  ((struct nlmsghdr*)(batch->buf + last_msg))->nlmsg_flags |= NLM_F_ACK;
+
+  batch->seq_end = seq;
+  nlh = batch_put_msg(batch, NFNL_MSG_BATCH_END, AF_UNSPEC, 0, seq,
+                      NFNL_SUBSYS_NFTABLES);
+  batch_end_msg(batch, nlh);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+void pcef_nft_batch_free(pcef_nft_batch_t* batch) {
+  free(batch->buf);
+  free(batch->rule_of_seq);
+  memset(batch, 0, sizeof(*batch));
+}
+
+//------------------------------------------------------------------------------
+static void record_error(const pcef_nft_batch_t* batch, pcef_nft_rule_t* rules,
+                         uint32_t seq, int error) {
+  if ((seq >= batch->seq_rule) &&
+      (seq - batch->seq_rule < (uint32_t)batch->num_rule_msgs)) {
+    pcef_nft_rule_t* rule = &rules[batch->rule_of_seq[seq - batch->seq_rule]];
+    rule->error = error;
+    OAILOG_ERROR(LOG_SPGW_APP, "nftables rejected %s rule for SDF %u: %s\n",
+                 chain_names[rule->chain], rule->mark, strerror(-error));
+  } else {
+    OAILOG_ERROR(LOG_SPGW_APP, "nftables rejected setup of table %s: %s\n",
+                 PCEF_NFT_TABLE, strerror(-error));
+  }
+}
+
+// Reads the answers up to the acknowledgement of the last message
+static status_code_e receive_acks(struct mnl_socket* nl,
+                                  const pcef_nft_batch_t* batch,
+                                  pcef_nft_rule_t* rules) {
+  char buf[MNL_SOCKET_BUFFER_SIZE];
+  const uint32_t seq_last = batch->seq_end - 1;
+  status_code_e rc = RETURNok;
+
+  for (;;) {
+    ssize_t n = mnl_socket_recvfrom(nl, buf, sizeof(buf));
+    if (n < 0) {
+      OAILOG_ERROR(LOG_SPGW_APP, "No answer from nftables: %s\n",
+                   strerror(errno));
+      return RETURNerror;
+    }
+    int len = (int)n;
+    const struct nlmsghdr* nlh = (const struct nlmsghdr*)buf;
+    for (; mnl_nlmsg_ok(nlh, len); nlh = mnl_nlmsg_next(nlh, &len)) {
+      if (NLMSG_ERROR != nlh->nlmsg_type) continue;
+      const struct nlmsgerr* err = mnl_nlmsg_get_payload(nlh);
+      if (err->error) {
+        rc = RETURNerror;
+        record_error(batch, rules, nlh->nlmsg_seq, err->error);
+        // The batch as a whole was refused, e.g. without CAP_NET_ADMIN
+        if (nlh->nlmsg_seq == batch->seq_begin) return rc;
+      }
+      if (nlh->nlmsg_seq == seq_last) return rc;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+status_code_e pcef_nft_commit(pcef_nft_rule_t* rules, int num_rules,
+                              bool resync) {
+  pcef_nft_batch_t batch;
+  if (RETURNok != pcef_nft_batch_build(&batch, (uint32_t)time(NULL), resync,
+                                       rules, num_rules)) {
+    OAILOG_ERROR(LOG_SPGW_APP, "Cannot allocate nftables batch of %d rules\n",
+                 num_rules);
+    return RETURNerror;
+  }
+
+  status_code_e rc = RETURNerror;
+  struct mnl_socket* nl = mnl_socket_open(NETLINK_NETFILTER);
+  if (!nl) {
+    OAILOG_ERROR(LOG_SPGW_APP, "Cannot open netfilter netlink socket: %s\n",
+                 strerror(errno));
+    goto done;
+  }
+  if (mnl_socket_bind(nl, 0, MNL_SOCKET_AUTOPID) < 0) {
+    OAILOG_ERROR(LOG_SPGW_APP, "Cannot bind netfilter netlink socket: %s\n",
+                 strerror(errno));
+    goto done;
+  }
+  // Errors without a copy of the rejected message
+  int one = 1;
+  mnl_socket_setsockopt(nl, NETLINK_CAP_ACK, &one, sizeof(one));
+  // The whole batch has to fit in one send for the transaction
+  int fd = mnl_socket_get_fd(nl);
+  int sndbuf = (int)batch.len;
+  if (setsockopt(fd, SOL_SOCKET, SO_SNDBUFFORCE, &sndbuf, sizeof(sndbuf))) {
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+  }
+  struct timeval timeout = {.tv_sec = PCEF_NFT_ACK_TIMEOUT_SEC, .tv_usec = 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  if (mnl_socket_sendto(nl, batch.buf, batch.len) < 0) {
+    OAILOG_ERROR(LOG_SPGW_APP, "Cannot send nftables batch of %zu bytes: %s\n",
+                 batch.len, strerror(errno));
+    goto done;
+  }
+  rc = receive_acks(nl, &batch, rules);
+  if (RETURNok == rc) {
+    OAILOG_DEBUG(LOG_SPGW_APP, "Committed %d nftables rules to table %s\n",
+                 batch.num_rule_msgs, PCEF_NFT_TABLE);
+  }
+
+done:
+  if (nl) mnl_socket_close(nl);
+  pcef_nft_batch_free(&batch);
+  return rc;
+}
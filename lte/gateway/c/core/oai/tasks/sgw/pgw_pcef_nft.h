@@ -0,0 +1,136 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*! \file pgw_pcef_nft.h
+  \brief Netlink programming of the PCEF emulation SDF marking rules.
+
+  The SDF filters of the predefined PCC rules mark downlink packets with
+  their SDF identifier. The marking rules live in their own nftables table,
+  PCEF_NFT_TABLE, with one chain on the postrouting hook and one on the
+  output hook, both at mangle priority, so that they behave like the
+  iptables mangle rules they replace.
+
+  Rules are sent to the kernel over a netlink socket as one nfnetlink batch,
+  which nftables applies as a single transaction: either all rules of a
+  commit are in place afterwards or none is. A full resync replaces the
+  table, whatever the kernel had before. Errors are reported per rule.
+*/
+
+#pragma once
+
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lte/gateway/c/core/oai/common/common_defs.h"
+#include "lte/gateway/c/core/oai/include/pgw_types.h"
+
+#define PCEF_NFT_TABLE "magma_pcef"
+#define PCEF_NFT_CHAIN_POSTROUTING_NAME "postrouting"
+#define PCEF_NFT_CHAIN_OUTPUT_NAME "output"
+
+/* Upper bound of the netlink message of one rule */
+#define PCEF_NFT_RULE_MSG_MAX 4096
+
+typedef enum {
+  PCEF_NFT_CHAIN_POSTROUTING = 0,
+  PCEF_NFT_CHAIN_OUTPUT,
+  PCEF_NFT_CHAIN_MAX
+} pcef_nft_chain_t;
+
+#define PCEF_NFT_MATCH_DADDR 0x01
+#define PCEF_NFT_MATCH_SADDR 0x02
+#define PCEF_NFT_MATCH_PROTOCOL 0x04
+#define PCEF_NFT_MATCH_SPORT 0x08
+#define PCEF_NFT_MATCH_DPORT 0x10
+#define PCEF_NFT_MATCH_SPI 0x20
+#define PCEF_NFT_MATCH_TOS 0x40
+
+/*
+ * One marking rule. Addresses are in network byte order, ports and SPI in
+ * host byte order.
+ */
+typedef struct pcef_nft_rule_s {
+  pcef_nft_chain_t chain;
+  uint32_t mark;
+  uint32_t match;  // PCEF_NFT_MATCH_* flags
+  struct in_addr daddr;
+  struct in_addr dmask;
+  struct in_addr saddr;
+  struct in_addr smask;
+  uint8_t protocol;
+  uint16_t sport_low;
+  uint16_t sport_high;
+  uint16_t dport_low;
+  uint16_t dport_high;
+  uint32_t spi;
+  uint8_t tos;
+  uint8_t tos_mask;
+  // 0 or a negative errno, set when the filter cannot be expressed or when
+  // the kernel rejected the rule. Rules with an error are not sent.
+  int error;
+} pcef_nft_rule_t;
+
+/*
+ * Converts a downlink or bidirectional SDF filter into its marking rules,
+ * one per chain, with the matches the iptables emulation used: the remote
+ * address if the filter has one, the UE pool otherwise. Returns the number
+ * of rules written to rules, 0 for an uplink only filter. A filter that
+ * cannot be expressed gives rules with error set.
+ */
+int pcef_nft_rules_from_sdf_filter(const sdf_filter_t* sdf_f, sdf_id_t sdf_id,
+                                   struct in_addr ue_pool_addr,
+                                   uint8_t ue_pool_prefix,
+                                   pcef_nft_rule_t rules[PCEF_NFT_CHAIN_MAX]);
+
+typedef struct pcef_nft_batch_s {
+  char* buf;
+  size_t len;
+  size_t size;
+  uint32_t seq_begin;  // Sequence number of the batch begin message
+  uint32_t seq_end;    // Sequence number of the batch end message
+  uint32_t seq_rule;   // Sequence number of the first rule message
+  int* rule_of_seq;    // Index in rules of each rule message
+  int num_rule_msgs;
+} pcef_nft_batch_t;
+
+/*
+ * Builds the nfnetlink batch for the rules without error into batch, with
+ * sequence numbers starting at seq. The table and chains are created if
+ * they do not exist. If resync is set, the table is deleted and recreated
+ * first, so that the rules replace everything in it. Rules are inserted at
+ * the head of their chain, like iptables -I. Returns RETURNerror if memory
+ * could not be allocated.
+ */
+status_code_e pcef_nft_batch_build(pcef_nft_batch_t* batch, uint32_t seq,
+                                   bool resync, const pcef_nft_rule_t* rules,
+                                   int num_rules);
+
+void pcef_nft_batch_free(pcef_nft_batch_t* batch);
+
+/*
+ * Commits the rules without error as one transaction. Returns RETURNok if
+ * the kernel applied them. Otherwise nothing is applied, the rules the
+ * kernel rejected have their error set, and RETURNerror is returned.
+ */
+status_code_e pcef_nft_commit(pcef_nft_rule_t* rules, int num_rules,
+                              bool resync);
+
+#ifdef __cplusplus
+}
+#endif
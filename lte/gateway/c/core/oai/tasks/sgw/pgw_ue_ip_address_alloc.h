@@ -30,6 +30,7 @@
 
 #include "lte/gateway/c/core/oai/include/spgw_state.h"
 #include "lte/gateway/c/core/oai/include/ip_forward_messages_types.h"
+#include "lte/gateway/c/core/oai/include/pgw_config.h"
 
 void release_ue_ipv4_address(const char* imsi, const char* apn,
                              struct in_addr* addr);
@@ -39,4 +40,11 @@ int get_ip_block(struct in_addr* netaddr, uint32_t* netmask);
 void release_ue_ipv6_address(const char* imsi, const char* apn,
                              struct in6_addr* addr);
 
+/*
+ * Enable delegated UE IPv4 allocation if configured, and reserve the IPv4
+ * addresses of the UE contexts restored from the SPGW state
+ */
+void delegated_ue_ip_alloc_init(const pgw_config_t* pgw_config_p,
+                                hash_table_ts_t* state_teid_ht);
+
 #endif /*PGW_UE_IP_ADDRESS_ALLOC_SEEN */
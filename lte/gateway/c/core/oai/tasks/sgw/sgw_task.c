@@ -47,8 +47,10 @@
 #include "lte/gateway/c/core/oai/tasks/sgw/pgw_ue_ip_address_alloc.h"
 #include "lte/gateway/c/core/oai/tasks/sgw/pgw_pcef_emulation.h"
 #include "lte/gateway/c/core/oai/include/spgw_config.h"
+#include "lte/gateway/c/core/oai/lib/mobility_client/MobilityClientAPI.h"
 
 static void spgw_app_exit(void);
+static int handle_delegated_ip_alloc_timer(zloop_t* loop, int id, void* arg);
 
 spgw_config_t spgw_config;
 task_zmq_ctx_t spgw_app_task_zmq_ctx;
@@ -224,12 +226,25 @@ static void* spgw_app_thread(__attribute__((unused)) void* args) {
   init_task_context(TASK_SPGW_APP, (task_id_t[]){TASK_MME_APP}, 1,
                     handle_message, &spgw_app_task_zmq_ctx);
 
+  if (spgw_config.pgw_config.delegated_ip_alloc.enabled) {
+    delegated_ue_ip_alloc_init(&spgw_config.pgw_config, get_spgw_teid_state());
+    start_timer(&spgw_app_task_zmq_ctx,
+                spgw_config.pgw_config.delegated_ip_alloc.sync_interval_msec,
+                TIMER_REPEAT_FOREVER, handle_delegated_ip_alloc_timer, NULL);
+  }
+
   zloop_start(spgw_app_task_zmq_ctx.event_loop);
   AssertFatal(0,
               "Asserting as spgw_app_thread should not be exiting on its own!");
   return NULL;
 }
 
+//------------------------------------------------------------------------------
+static int handle_delegated_ip_alloc_timer(zloop_t* loop, int id, void* arg) {
+  delegated_ip_alloc_tick();
+  return 0;
+}
+
 //------------------------------------------------------------------------------
 status_code_e spgw_app_init(spgw_config_t* spgw_config_pP, bool persist_state) {
   OAILOG_DEBUG(LOG_SPGW_APP, "Initializing SPGW-APP  task interface\n");
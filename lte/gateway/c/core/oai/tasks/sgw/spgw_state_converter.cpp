@@ -200,6 +200,8 @@ void SpgwStateConverter::sgw_pdn_connection_to_proto(
   BSTRING_TO_STRING(ip_addr_bstr, proto_pdn->mutable_pgw_address_in_use_up());
   bdestroy_wrapper(&ip_addr_bstr);
 
+  proto_pdn->set_pgw_teid_s5_s8_cp(state_pdn->p_gw_teid_S5_S8_cp);
+  proto_pdn->set_sgw_teid_s5_s8_cp(state_pdn->s_gw_teid_S5_S8_cp);
   proto_pdn->set_default_bearer(state_pdn->default_bearer);
   proto_pdn->set_ue_suspended_for_ps_handover(
       state_pdn->ue_suspended_for_ps_handover);
@@ -219,12 +221,16 @@ void SpgwStateConverter::proto_to_sgw_pdn_connection(
   state_pdn->default_bearer = proto.default_bearer();
   state_pdn->ue_suspended_for_ps_handover =
       proto.ue_suspended_for_ps_handover();
+  state_pdn->p_gw_teid_S5_S8_cp = proto.pgw_teid_s5_s8_cp();
+  state_pdn->s_gw_teid_S5_S8_cp = proto.sgw_teid_s5_s8_cp();
 
-  bstring ip_addr_bstr = bfromcstr(proto.pgw_address_in_use_cp().c_str());
+  bstring ip_addr_bstr = blk2bstr(proto.pgw_address_in_use_cp().c_str(),
+                                  proto.pgw_address_in_use_cp().length());
   bstring_to_ip_address(ip_addr_bstr, &state_pdn->p_gw_address_in_use_cp);
   bdestroy_wrapper(&ip_addr_bstr);
 
-  ip_addr_bstr = bfromcstr(proto.pgw_address_in_use_up().c_str());
+  ip_addr_bstr = blk2bstr(proto.pgw_address_in_use_up().c_str(),
+                          proto.pgw_address_in_use_up().length());
   bstring_to_ip_address(ip_addr_bstr, &state_pdn->p_gw_address_in_use_up);
   bdestroy_wrapper(&ip_addr_bstr);
 
@@ -494,25 +500,30 @@ void SpgwStateConverter::proto_to_sgw_eps_bearer(
   eps_bearer->eps_bearer_id = eps_bearer_proto.eps_bearer_id();
 
   bstring ip_addr_bstr =
-      bfromcstr(eps_bearer_proto.pgw_address_in_use_up().c_str());
+      blk2bstr(eps_bearer_proto.pgw_address_in_use_up().c_str(),
+               eps_bearer_proto.pgw_address_in_use_up().length());
   bstring_to_ip_address(ip_addr_bstr, &eps_bearer->p_gw_address_in_use_up);
   bdestroy_wrapper(&ip_addr_bstr);
   eps_bearer->p_gw_teid_S5_S8_up = eps_bearer_proto.pgw_teid_s5_s8_up();
 
-  ip_addr_bstr = bfromcstr(eps_bearer_proto.sgw_ip_address_s5_s8_up().c_str());
+  ip_addr_bstr =
+      blk2bstr(eps_bearer_proto.sgw_ip_address_s5_s8_up().c_str(),
+               eps_bearer_proto.sgw_ip_address_s5_s8_up().length());
   bstring_to_ip_address(ip_addr_bstr, &eps_bearer->s_gw_ip_address_S5_S8_up);
   bdestroy_wrapper(&ip_addr_bstr);
   eps_bearer->s_gw_teid_S5_S8_up = eps_bearer_proto.sgw_teid_s5_s8_up();
 
   ip_addr_bstr =
-      bfromcstr(eps_bearer_proto.sgw_ip_address_s1u_s12_s4_up().c_str()),
+      blk2bstr(eps_bearer_proto.sgw_ip_address_s1u_s12_s4_up().c_str(),
+               eps_bearer_proto.sgw_ip_address_s1u_s12_s4_up().length()),
   bstring_to_ip_address(ip_addr_bstr,
                         &eps_bearer->s_gw_ip_address_S1u_S12_S4_up);
   bdestroy_wrapper(&ip_addr_bstr);
 
   // if ipv6 addr is present it will overwrite, if not it will skip
   ip_addr_bstr =
-      bfromcstr(eps_bearer_proto.sgw_ipv6_address_s1u_s12_s4_up().c_str()),
+      blk2bstr(eps_bearer_proto.sgw_ipv6_address_s1u_s12_s4_up().c_str(),
+               eps_bearer_proto.sgw_ipv6_address_s1u_s12_s4_up().length()),
   bstring_to_ip_address(ip_addr_bstr,
                         &eps_bearer->s_gw_ip_address_S1u_S12_S4_up);
 
@@ -520,12 +531,14 @@ void SpgwStateConverter::proto_to_sgw_eps_bearer(
   eps_bearer->s_gw_teid_S1u_S12_S4_up =
       eps_bearer_proto.sgw_teid_s1u_s12_s4_up();
 
-  ip_addr_bstr = bfromcstr(eps_bearer_proto.enb_ip_address_s1u().c_str());
+  ip_addr_bstr = blk2bstr(eps_bearer_proto.enb_ip_address_s1u().c_str(),
+                          eps_bearer_proto.enb_ip_address_s1u().length());
   bstring_to_ip_address(ip_addr_bstr, &eps_bearer->enb_ip_address_S1u);
   bdestroy_wrapper(&ip_addr_bstr);
   eps_bearer->enb_teid_S1u = eps_bearer_proto.enb_teid_s1u();
 
-  ip_addr_bstr = bfromcstr(eps_bearer_proto.paa().c_str());
+  ip_addr_bstr = blk2bstr(eps_bearer_proto.paa().c_str(),
+                          eps_bearer_proto.paa().length());
   bstring_to_paa(ip_addr_bstr, &eps_bearer->paa);
   bdestroy_wrapper(&ip_addr_bstr);
 
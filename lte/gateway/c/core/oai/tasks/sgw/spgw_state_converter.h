@@ -88,6 +88,22 @@ class SpgwStateConverter : StateConverter {
       const oai::TrafficFlowTemplate& tft_proto,
       traffic_flow_template_t* tft_state);
 
+  /**
+   * Converts sgw pdn connection struct to proto, memory is owned by the caller
+   * @param state_pdn
+   * @param proto_pdn
+   */
+  static void sgw_pdn_connection_to_proto(const sgw_pdn_connection_t* state_pdn,
+                                          oai::SgwPdnConnection* proto_pdn);
+
+  /**
+   * Converts proto to sgw pdn connection struct
+   * @param proto
+   * @param state_pdn
+   */
+  static void proto_to_sgw_pdn_connection(const oai::SgwPdnConnection& proto,
+                                          sgw_pdn_connection_t* state_pdn);
+
  private:
   SpgwStateConverter();
   ~SpgwStateConverter();
@@ -128,22 +144,6 @@ class SpgwStateConverter : StateConverter {
       const oai::SgwEpsBearerContext& eps_bearer_proto,
       sgw_eps_bearer_ctxt_t* eps_bearer);
 
-  /**
-   * Converts sgw pdn connection struct to proto, memory is owned by the caller
-   * @param state_pdn
-   * @param proto_pdn
-   */
-  static void sgw_pdn_connection_to_proto(const sgw_pdn_connection_t* state_pdn,
-                                          oai::SgwPdnConnection* proto_pdn);
-
-  /**
-   * Converts proto to sgw pdn connection struct
-   * @param proto
-   * @param state_pdn
-   */
-  static void proto_to_sgw_pdn_connection(const oai::SgwPdnConnection& proto,
-                                          sgw_pdn_connection_t* state_pdn);
-
   /**
    * Converts itti_s11_create_session_request struct to proto, memory is
    * owned by the caller
@@ -19,4 +19,4 @@ limitations under the License.
 
 extern task_zmq_ctx_t sgw_s8_task_zmq_ctx;
 
-status_code_e sgw_s8_init(sgw_config_t* sgw_config_p);
+status_code_e sgw_s8_init(sgw_config_t* sgw_config_p, bool persist_state);
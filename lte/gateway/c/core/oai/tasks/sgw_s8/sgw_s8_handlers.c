@@ -1853,3 +1853,38 @@ sgw_eps_bearer_context_information_t* update_sgw_context_to_s11_teid_map(
       session_rsp_p->context_teid);
   OAILOG_FUNC_RETURN(LOG_SGW_S8, sgw_context_p);
 }
+
+// Re-programs the GTP-U tunnels of the bearers of a pdn session
+static bool sgw_s8_restore_pdn_session_tunnels(
+    __attribute__((unused)) const hash_key_t keyP, void* const sgw_context_pP,
+    void* num_bearers_pP, __attribute__((unused)) void** resultP) {
+  sgw_eps_bearer_context_information_t* sgw_context_p =
+      (sgw_eps_bearer_context_information_t*)sgw_context_pP;
+  for (uint8_t idx = 0; idx < BEARERS_PER_UE; idx++) {
+    sgw_eps_bearer_ctxt_t* eps_bearer_ctxt_p =
+        sgw_context_p->pdn_connection.sgw_eps_bearers_array[idx];
+    // Bearers without eNB, such as the ones of idle UEs, get their tunnels
+    // on the next modify bearer request
+    if (!eps_bearer_ctxt_p || !eps_bearer_ctxt_p->enb_teid_S1u) {
+      continue;
+    }
+#if !MME_UNIT_TEST
+    if (sgw_s8_add_gtp_up_tunnel(eps_bearer_ctxt_p, sgw_context_p) < 0) {
+      continue;
+    }
+#endif
+    (*(uint32_t*)num_bearers_pP)++;
+  }
+  return false;
+}
+
+uint32_t sgw_s8_restore_gtp_up_tunnels(void) {
+  OAILOG_FUNC_IN(LOG_SGW_S8);
+  uint32_t num_bearers = 0;
+  hashtable_ts_apply_callback_on_elements(get_sgw_ue_state(),
+                                          sgw_s8_restore_pdn_session_tunnels,
+                                          &num_bearers, NULL);
+  OAILOG_INFO(LOG_SGW_S8, "Restored GTP-U tunnels of %u bearers\n",
+              num_bearers);
+  OAILOG_FUNC_RETURN(LOG_SGW_S8, num_bearers);
+}
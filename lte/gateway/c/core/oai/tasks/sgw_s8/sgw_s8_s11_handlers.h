@@ -94,6 +94,13 @@ int sgw_update_bearer_context_information_on_csreq(
 
 uint32_t sgw_get_new_s1u_teid(sgw_state_t* state);
 
+/**
+ * Re-programs the GTP-U tunnels of the bearers connected to an eNB, for the
+ * pdn sessions recovered from db at start
+ * @return number of bearers whose tunnels are restored
+ */
+uint32_t sgw_s8_restore_gtp_up_tunnels(void);
+
 int update_pgw_info_to_temp_dedicated_bearer_context(
     sgw_eps_bearer_context_information_t* sgw_context_p, teid_t s1_u_sgw_fteid,
     s8_bearer_context_t* bc_cbreq, sgw_state_t* sgw_state, char* pgw_cp_ip_port,
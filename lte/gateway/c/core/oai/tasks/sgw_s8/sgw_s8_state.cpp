@@ -55,9 +55,23 @@ void put_sgw_state() {
   return;
 }
 
-void put_sgw_ue_state(sgw_state_t* sgw_state, imsi64_t imsi64) { return; }
+void put_sgw_ue_state(sgw_state_t* sgw_state, imsi64_t imsi64) {
+  if (SgwStateManager::getInstance().is_persist_state_enabled()) {
+    spgw_ue_context_t* ue_context_p = nullptr;
+    hashtable_ts_get(sgw_state->imsi_ue_context_htbl, (const hash_key_t)imsi64,
+                     (void**)&ue_context_p);
+    if (ue_context_p) {
+      auto imsi_str = SgwStateManager::getInstance().get_imsi_str(imsi64);
+      SgwStateManager::getInstance().write_ue_state_to_db(ue_context_p,
+                                                          imsi_str);
+    }
+  }
+}
 
-void delete_sgw_ue_state(imsi64_t imsi64) { return; }
+void delete_sgw_ue_state(imsi64_t imsi64) {
+  auto imsi_str = SgwStateManager::getInstance().get_imsi_str(imsi64);
+  SgwStateManager::getInstance().clear_ue_state_db(imsi_str);
+}
 
 void sgw_free_s11_bearer_context_information(
     sgw_eps_bearer_context_information_t** sgw_eps_context) {
@@ -12,12 +12,16 @@ limitations under the License.
 */
 
 extern "C" {
+#include "lte/gateway/c/core/oai/common/conversions.h"
 #include "lte/gateway/c/core/oai/common/dynamic_memory_check.h"
 #include "lte/gateway/c/core/oai/include/sgw_context_manager.h"
+#include "lte/gateway/c/core/oai/include/sgw_s8_state.h"
 }
 
+#include "lte/gateway/c/core/oai/tasks/sgw/spgw_state_converter.h"
 #include "lte/gateway/c/core/oai/tasks/sgw_s8/sgw_s8_state_converter.h"
 
+using magma::lte::oai::SgwS8EpsBearerContextInfo;
 using magma::lte::oai::SgwState;
 using magma::lte::oai::SgwUeContext;
 
@@ -31,24 +35,133 @@ void SgwStateConverter::state_to_proto(const sgw_state_t* sgw_state,
                                        SgwState* proto) {
   OAILOG_FUNC_IN(LOG_SGW_S8);
   proto->Clear();
+  // Userplane teids keep on being allocated from the last ones after restart
+  proto->set_gtpv1u_teid(sgw_state->s1u_teid);
+  proto->set_last_tunnel_id(sgw_state->s5s8u_teid);
   OAILOG_FUNC_OUT(LOG_SGW_S8);
 }
 
 void SgwStateConverter::proto_to_state(const SgwState& proto,
                                        sgw_state_t* sgw_state) {
   OAILOG_FUNC_IN(LOG_SGW_S8);
+  if (proto.gtpv1u_teid()) {
+    sgw_state->s1u_teid = proto.gtpv1u_teid();
+  }
+  sgw_state->s5s8u_teid = proto.last_tunnel_id();
   OAILOG_FUNC_OUT(LOG_SGW_S8);
 }
 
+void SgwStateConverter::sgw_s8_bearer_context_to_proto(
+    const sgw_eps_bearer_context_information_t* sgw_context_p,
+    SgwS8EpsBearerContextInfo* proto) {
+  proto->Clear();
+
+  proto->set_imsi((char*)sgw_context_p->imsi.digit,
+                  strnlen((char*)sgw_context_p->imsi.digit,
+                          IMSI_BCD_DIGITS_MAX));
+  proto->set_imsi64(sgw_context_p->imsi64);
+  proto->set_imsi_unauth_indicator(
+      sgw_context_p->imsi_unauthenticated_indicator);
+  proto->set_msisdn(sgw_context_p->msisdn,
+                    strnlen(sgw_context_p->msisdn, MSISDN_LENGTH));
+  ecgi_to_proto(sgw_context_p->last_known_cell_Id,
+                proto->mutable_last_known_cell_id());
+
+  // trxn and pending procedures belong to in-flight transactions, which do
+  // not survive a restart, so they are not stored
+  proto->set_mme_teid_s11(sgw_context_p->mme_teid_S11);
+  bstring ip_addr_bstr =
+      ip_address_to_bstring(&sgw_context_p->mme_ip_address_S11);
+  BSTRING_TO_STRING(ip_addr_bstr, proto->mutable_mme_ip_address_s11());
+  bdestroy_wrapper(&ip_addr_bstr);
+
+  proto->set_sgw_teid_s11_s4(sgw_context_p->s_gw_teid_S11_S4);
+  ip_addr_bstr = ip_address_to_bstring(&sgw_context_p->s_gw_ip_address_S11_S4);
+  BSTRING_TO_STRING(ip_addr_bstr, proto->mutable_sgw_ip_address_s11_s4());
+  bdestroy_wrapper(&ip_addr_bstr);
+
+  SpgwStateConverter::sgw_pdn_connection_to_proto(
+      &sgw_context_p->pdn_connection, proto->mutable_pdn_connection());
+}
+
+void SgwStateConverter::proto_to_sgw_s8_bearer_context(
+    const SgwS8EpsBearerContextInfo& proto,
+    sgw_eps_bearer_context_information_t* sgw_context_p) {
+  sgw_context_p->imsi.length =
+      std::min<size_t>(proto.imsi().length(), IMSI_BCD_DIGITS_MAX);
+  memcpy(sgw_context_p->imsi.digit, proto.imsi().c_str(),
+         sgw_context_p->imsi.length);
+  sgw_context_p->imsi64 = proto.imsi64();
+  sgw_context_p->imsi_unauthenticated_indicator =
+      proto.imsi_unauth_indicator();
+  memcpy(sgw_context_p->msisdn, proto.msisdn().c_str(),
+         std::min<size_t>(proto.msisdn().length(), MSISDN_LENGTH));
+  proto_to_ecgi(proto.last_known_cell_id(),
+                &sgw_context_p->last_known_cell_Id);
+
+  sgw_context_p->mme_teid_S11 = proto.mme_teid_s11();
+  bstring ip_addr_bstr = blk2bstr(proto.mme_ip_address_s11().c_str(),
+                                  proto.mme_ip_address_s11().length());
+  bstring_to_ip_address(ip_addr_bstr, &sgw_context_p->mme_ip_address_S11);
+  bdestroy_wrapper(&ip_addr_bstr);
+
+  sgw_context_p->s_gw_teid_S11_S4 = proto.sgw_teid_s11_s4();
+  ip_addr_bstr = blk2bstr(proto.sgw_ip_address_s11_s4().c_str(),
+                          proto.sgw_ip_address_s11_s4().length());
+  bstring_to_ip_address(ip_addr_bstr, &sgw_context_p->s_gw_ip_address_S11_S4);
+  bdestroy_wrapper(&ip_addr_bstr);
+
+  SpgwStateConverter::proto_to_sgw_pdn_connection(
+      proto.pdn_connection(), &sgw_context_p->pdn_connection);
+}
+
 void SgwStateConverter::ue_to_proto(const spgw_ue_context_t* ue_state,
                                     oai::SgwUeContext* ue_proto) {
   OAILOG_FUNC_IN(LOG_SGW_S8);
+  ue_proto->Clear();
+  if (!ue_state) {
+    OAILOG_FUNC_OUT(LOG_SGW_S8);
+  }
+  hash_table_ts_t* state_ue_ht = get_sgw_ue_state();
+  sgw_s11_teid_t* s11_teid_p = nullptr;
+  LIST_FOREACH(s11_teid_p, &ue_state->sgw_s11_teid_list, entries) {
+    sgw_eps_bearer_context_information_t* sgw_context_p = nullptr;
+    hashtable_ts_get(state_ue_ht, (const hash_key_t)s11_teid_p->sgw_s11_teid,
+                     (void**)&sgw_context_p);
+    if (sgw_context_p) {
+      sgw_s8_bearer_context_to_proto(sgw_context_p,
+                                     ue_proto->add_sgw_bearer_context());
+    }
+  }
   OAILOG_FUNC_OUT(LOG_SGW_S8);
 }
 
 void SgwStateConverter::proto_to_ue(const oai::SgwUeContext& ue_proto,
                                     spgw_ue_context_t* ue_context_p) {
   OAILOG_FUNC_IN(LOG_SGW_S8);
+  hash_table_ts_t* state_ue_ht = get_sgw_ue_state();
+  LIST_INIT(&ue_context_p->sgw_s11_teid_list);
+  // sgw_s11_teids are inserted at the head of the list, so the sessions are
+  // walked backwards to restore the list in its stored order
+  for (int idx = ue_proto.sgw_bearer_context_size() - 1; idx >= 0; idx--) {
+    auto* sgw_context_p = (sgw_eps_bearer_context_information_t*)calloc(
+        1, sizeof(sgw_eps_bearer_context_information_t));
+    proto_to_sgw_s8_bearer_context(ue_proto.sgw_bearer_context(idx),
+                                   sgw_context_p);
+    teid_t teid = sgw_context_p->s_gw_teid_S11_S4;
+    if (hashtable_ts_insert(state_ue_ht, (const hash_key_t)teid,
+                            (void*)sgw_context_p) != HASH_TABLE_OK) {
+      OAILOG_ERROR_UE(LOG_SGW_S8, sgw_context_p->imsi64,
+                      "Failed to insert sgw_s11_teid " TEID_FMT
+                      " into state_ue_ht\n",
+                      teid);
+      sgw_free_s11_bearer_context_information(&sgw_context_p);
+      continue;
+    }
+    auto* s11_teid_p = (sgw_s11_teid_t*)calloc(1, sizeof(sgw_s11_teid_t));
+    s11_teid_p->sgw_s11_teid = teid;
+    LIST_INSERT_HEAD(&ue_context_p->sgw_s11_teid_list, s11_teid_p, entries);
+  }
   OAILOG_FUNC_OUT(LOG_SGW_S8);
 }
 
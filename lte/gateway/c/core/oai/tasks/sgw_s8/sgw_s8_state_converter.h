@@ -53,15 +53,47 @@ class SgwStateConverter : StateConverter {
   static void proto_to_state(const oai::SgwState& proto,
                              sgw_state_t* sgw_state);
 
+  /**
+   * Converts the pdn sessions of a UE to proto, the sessions are looked up
+   * in the SGW_S8 UE state hashtable by their sgw_s11_teid
+   * @param ue_state UE context holding the list of sgw_s11_teids
+   * @param ue_proto SgwUeContext proto object to be written to
+   */
   static void ue_to_proto(const spgw_ue_context_t* ue_state,
                           oai::SgwUeContext* ue_proto);
 
+  /**
+   * Converts proto to the pdn sessions of a UE, each session is inserted in
+   * the SGW_S8 UE state hashtable with its sgw_s11_teid as key and the teid
+   * is added to the list of sgw_s11_teids of the UE context
+   * @param ue_proto SgwUeContext proto object
+   * @param ue_context_p UE context, allocated by the caller
+   */
   static void proto_to_ue(const oai::SgwUeContext& ue_proto,
                           spgw_ue_context_t* ue_context_p);
 
  private:
   SgwStateConverter();
   ~SgwStateConverter();
+
+  /**
+   * Converts sgw_s8 bearer context struct to proto, memory is owned by the
+   * caller
+   * @param sgw_context_p
+   * @param proto
+   */
+  static void sgw_s8_bearer_context_to_proto(
+      const sgw_eps_bearer_context_information_t* sgw_context_p,
+      oai::SgwS8EpsBearerContextInfo* proto);
+
+  /**
+   * Converts proto to sgw_s8 bearer context struct
+   * @param proto
+   * @param sgw_context_p
+   */
+  static void proto_to_sgw_s8_bearer_context(
+      const oai::SgwS8EpsBearerContextInfo& proto,
+      sgw_eps_bearer_context_information_t* sgw_context_p);
 };
 }  // namespace lte
 }  // namespace magma
@@ -38,6 +38,7 @@ void SgwStateManager::init(bool persist_state, const sgw_config_t* config) {
   table_key = SGW_STATE_TABLE_NAME;
   persist_state_enabled = persist_state;
   config_ = config;
+  redis_client = std::make_unique<RedisClient>(persist_state);
   create_state();
   if (read_state_from_db() != RETURNok) {
     OAILOG_ERROR(LOG_SGW_S8, "Failed to read state from redis");
@@ -123,7 +124,67 @@ void SgwStateManager::free_state() {
 }
 
 status_code_e SgwStateManager::read_ue_state_from_db() {
-  /* TODO handle stateless for SGW_S8 task */
+  if (!persist_state_enabled) {
+    return RETURNok;
+  }
+  std::map<std::string, orc8r::RedisState> ue_states;
+  if (redis_client->read_redis_states(
+          redis_client->get_keys(IMSI_PREFIX + std::string("*:") + task_name),
+          ue_states) != RETURNok) {
+    OAILOG_ERROR(LOG_SGW_S8, "Failed to read UE states from db\n");
+    return RETURNerror;
+  }
+
+  int num_recovered_ues = 0;
+  for (const auto& ue_state : ue_states) {
+    oai::SgwUeContext ue_proto = oai::SgwUeContext();
+    if (!ue_proto.ParseFromString(ue_state.second.serialized_msg())) {
+      OAILOG_ERROR(LOG_SGW_S8, "Failed to parse UE state for key %s\n",
+                   ue_state.first.c_str());
+      continue;
+    }
+    imsi64_t imsi64 = get_imsi_from_key(ue_state.first);
+    if (recover_ue_state(imsi64, ue_proto) != RETURNok) {
+      continue;
+    }
+    // Next write of the UE carries a newer version than the stored one
+    ue_state_version[get_imsi_str(imsi64)] = ue_state.second.version() + 1;
+    num_recovered_ues++;
+  }
+  OAILOG_INFO(LOG_SGW_S8, "Recovered state of %d UEs from db\n",
+              num_recovered_ues);
+  return RETURNok;
+}
+
+status_code_e SgwStateManager::recover_ue_state(
+    imsi64_t imsi64, const oai::SgwUeContext& ue_proto) {
+  if (!ue_proto.sgw_bearer_context_size()) {
+    OAILOG_ERROR_UE(LOG_SGW_S8, imsi64, "No pdn session stored for UE\n");
+    return RETURNerror;
+  }
+  auto* ue_context_p = (spgw_ue_context_t*)calloc(1, sizeof(spgw_ue_context_t));
+  SgwStateConverter::proto_to_ue(ue_proto, ue_context_p);
+  if (LIST_EMPTY(&ue_context_p->sgw_s11_teid_list) ||
+      hashtable_ts_insert(state_cache_p->imsi_ue_context_htbl,
+                          (const hash_key_t)imsi64,
+                          (void*)ue_context_p) != HASH_TABLE_OK) {
+    OAILOG_ERROR_UE(LOG_SGW_S8, imsi64, "Failed to recover UE context\n");
+    sgw_s11_teid_t* s11_teid_p = nullptr;
+    LIST_FOREACH(s11_teid_p, &ue_context_p->sgw_s11_teid_list, entries) {
+      hashtable_ts_free(state_ue_ht,
+                        (const hash_key_t)s11_teid_p->sgw_s11_teid);
+    }
+    sgw_free_ue_context(&ue_context_p);
+    return RETURNerror;
+  }
+
+  // Seed the hash of the recovered UE, so that it is only written back to db
+  // once it changes
+  oai::SgwUeContext recovered_proto = oai::SgwUeContext();
+  SgwStateConverter::ue_to_proto(ue_context_p, &recovered_proto);
+  std::string proto_str;
+  redis_client->serialize(recovered_proto, proto_str);
+  ue_state_hash[get_imsi_str(imsi64)] = std::hash<std::string>{}(proto_str);
   return RETURNok;
 }
 
@@ -67,8 +67,23 @@ class SgwStateManager
    */
   void free_state() override;
 
+  /**
+   * Recovers the pdn sessions of all UEs stored in db at once, rebuilding the
+   * sgw_s11_teid and imsi hashtables
+   * @return response code of operation
+   */
   status_code_e read_ue_state_from_db() override;
 
+  /**
+   * Inserts the pdn sessions of a UE read from db into the sgw_s11_teid and
+   * imsi hashtables, the UE is not written back to db until it changes
+   * @param imsi64
+   * @param ue_proto
+   * @return response code of operation
+   */
+  status_code_e recover_ue_state(imsi64_t imsi64,
+                                 const oai::SgwUeContext& ue_proto);
+
  private:
   SgwStateManager();
   ~SgwStateManager();
@@ -38,13 +38,20 @@ static void* sgw_s8_thread(void* args) {
   return NULL;
 }
 
-status_code_e sgw_s8_init(sgw_config_t* sgw_config_p) {
+status_code_e sgw_s8_init(sgw_config_t* sgw_config_p, bool persist_state) {
   OAILOG_DEBUG(LOG_SGW_S8, "Initializing SGW-S8 interface\n");
-  if (sgw_state_init(false, sgw_config_p) < 0) {
+  if (sgw_state_init(persist_state, sgw_config_p) < 0) {
     OAILOG_CRITICAL(LOG_SGW_S8, "Error while initializing SGW_S8 state\n");
     return RETURNerror;
   }
 
+  // Recover the pdn sessions stored before a restart along with their GTP-U
+  // tunnels, so that attached UEs do not have to re-attach
+  if (read_sgw_ue_state_db() != RETURNok) {
+    OAILOG_ERROR(LOG_SGW_S8, "Failed to recover SGW_S8 UE state from db\n");
+  }
+  sgw_s8_restore_gtp_up_tunnels();
+
   if (itti_create_task(TASK_SGW_S8, &sgw_s8_thread, NULL) < 0) {
     OAILOG_ERROR(LOG_SGW_S8, "Failed to create sgw_s8 task\n");
     return RETURNerror;
@@ -103,7 +110,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
       gtpv2c_cause_value_t cause_value = REQUEST_REJECTED;
       s8_create_bearer_request_t* cb_req =
           &received_message_p->ittiMsg.s8_create_bearer_req;
-      imsi64_t imsi64 =
+      imsi64 =
           sgw_s8_handle_create_bearer_request(sgw_state, cb_req, &cause_value);
       Imsi_t imsi = {0};
       if (imsi64 == INVALID_IMSI64) {
@@ -134,6 +141,10 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
     } break;
   }
 
+  // Both are only written to db when they have changed
+  put_sgw_state();
+  put_sgw_ue_state(sgw_state, imsi64);
+
   itti_free_msg_content(received_message_p);
   free(received_message_p);
   return 0;
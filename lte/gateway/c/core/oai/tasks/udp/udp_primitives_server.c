@@ -22,6 +22,7 @@
   \email: lionel.gauthier@eurecom.fr
 */
 
+#define _GNU_SOURCE
 #include <arpa/inet.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -38,6 +39,7 @@
 #include "lte/gateway/c/core/oai/lib/bstr/bstrlib.h"
 
 #include "lte/gateway/c/core/oai/common/assertions.h"
+#include "lte/gateway/c/core/oai/common/buffer_pool.h"
 #include "lte/gateway/c/core/oai/common/conversions.h"
 #include "lte/gateway/c/core/oai/common/dynamic_memory_check.h"
 #include "lte/gateway/c/core/oai/lib/itti/intertask_interface.h"
@@ -48,8 +50,43 @@
 
 task_zmq_ctx_t udp_task_zmq_ctx;
 
+/* Receive buffers handed to the GTPv2-C tasks by reference in UDP_DATA_IND.
+ * Sized for the S11 transactions that can be in flight in a signaling storm,
+ * the pool falls back to the heap beyond that. */
+#define UDP_RX_POOL_SIZE 2048
+/* Datagrams read with a single recvmmsg */
+#define UDP_RECV_BATCH_SIZE 32
+/* Bound the work done per socket wakeup to keep the ITTI queue serviced */
+#define UDP_MAX_RECV_BATCHES_PER_WAKEUP 8
+/* UDP_DATA_REQ coalesced into a single flush of sendmmsg calls */
+#define UDP_SEND_BATCH_SIZE 64
+
+static buffer_pool_t* udp_rx_pool = NULL;
+static buffer_pool_t* udp_tx_pool = NULL;
+
+typedef union {
+  struct sockaddr sa;
+  struct sockaddr_in addrv4;
+  struct sockaddr_in6 addrv6;
+} udp_sockaddr_t;
+
+/* Datagram staged for the next sendmmsg flush. The payload is copied out of
+ * the GTPv2-C stack message, which is released as soon as the send callback
+ * returns in the S11 task. */
+typedef struct udp_tx_entry_s {
+  int sd;
+  uint8_t* buffer;
+  uint32_t length;
+  udp_sockaddr_t peer;
+  socklen_t peer_len;
+} udp_tx_entry_t;
+
+static struct {
+  udp_tx_entry_t entries[UDP_SEND_BATCH_SIZE];
+  uint32_t count;
+} udp_tx_batch;
+
 struct udp_socket_desc_s {
-  uint8_t buffer[4096];
   int sd; /* Socket descriptor to use */
 
   pthread_t listener_thread; /* Thread affected to recv */
@@ -64,9 +101,6 @@ struct udp_socket_desc_s {
 static STAILQ_HEAD(udp_socket_list_s, udp_socket_desc_s) udp_socket_list;
 static pthread_mutex_t udp_socket_list_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-static void udp_server_receive_and_process(
-    struct udp_socket_desc_s* udp_sock_pP);
-
 /* @brief Retrieve the descriptor associated with the task_id
  */
 static struct udp_socket_desc_s* udp_server_get_socket_desc(task_id_t task_id,
@@ -115,61 +149,86 @@ static struct udp_socket_desc_s* udp_server_get_socket_desc_by_sd(int sdP) {
   return udp_sock_p;
 }
 
+static void udp_server_forward_datagram(struct udp_socket_desc_s* udp_sock_pP,
+                                        uint8_t* buffer, uint32_t length,
+                                        const udp_sockaddr_t* addr) {
+  MessageDef* message_p = NULL;
+  udp_data_ind_t* udp_data_ind_p;
+  bool ipv6 = udp_sock_pP->local_addr.sa_family == AF_INET6;
+
+  message_p = DEPRECATEDitti_alloc_new_message_fatal(TASK_UDP, UDP_DATA_IND);
+  udp_data_ind_p = &message_p->ittiMsg.udp_data_ind;
+  // The buffer now belongs to the message
+  udp_data_ind_p->msgBuf = buffer;
+  udp_data_ind_p->buffer_length = length;
+  udp_data_ind_p->local_port = udp_sock_pP->local_port;
+  udp_data_ind_p->peer_port =
+      ipv6 ? htons(addr->addrv6.sin6_port) : htons(addr->addrv4.sin_port);
+  memcpy((void*)&udp_data_ind_p->sock_addr, (void*)addr,
+         (ipv6) ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
+
+  OAILOG_DEBUG(LOG_UDP, "Msg of length %u received from %s:%u\n", length,
+               (!ipv6) ? inet_ntoa(addr->addrv4.sin_addr) : "TODO_IPV6",
+               ntohs(addr->addrv4.sin_port));
+
+  if (send_msg_to_task(&udp_task_zmq_ctx, udp_sock_pP->task_id, message_p) <
+      0) {
+    OAILOG_DEBUG(LOG_UDP, "Failed to send message %d to task %d\n",
+                 UDP_DATA_IND, udp_sock_pP->task_id);
+  }
+}
+
+/* Drain the socket with recvmmsg straight into pooled buffers, the buffers
+ * are then forwarded by reference to the task owning the endpoint. */
 static void udp_server_receive_and_process(
     struct udp_socket_desc_s* udp_sock_pP) {
-  OAILOG_DEBUG(LOG_UDP, "Inserting new descriptor for task %d, sd %d\n",
-               udp_sock_pP->task_id, udp_sock_pP->sd);
-  {
-    int bytes_received = 0;
-    socklen_t from_len;
-    struct sockaddr_in addr;
-    struct sockaddr_in6 addr6;
-
-    bool ipv6 = udp_sock_pP->local_addr.sa_family == AF_INET6;
-
-    if (ipv6) {
-      from_len = (socklen_t)sizeof(struct sockaddr_in6);
-      memset(&addr6, 0, sizeof(struct sockaddr_in6));
-    } else {
-      from_len = (socklen_t)sizeof(struct sockaddr_in);
-      memset(&addr, 0, sizeof(struct sockaddr_in));
+  uint8_t* buffers[UDP_RECV_BATCH_SIZE];
+  udp_sockaddr_t addrs[UDP_RECV_BATCH_SIZE];
+  struct iovec iovs[UDP_RECV_BATCH_SIZE];
+  struct mmsghdr msgs[UDP_RECV_BATCH_SIZE];
+  bool ipv6 = udp_sock_pP->local_addr.sa_family == AF_INET6;
+  socklen_t from_len = ipv6 ? (socklen_t)sizeof(struct sockaddr_in6)
+                            : (socklen_t)sizeof(struct sockaddr_in);
+
+  for (int batch = 0; batch < UDP_MAX_RECV_BATCHES_PER_WAKEUP; batch++) {
+    buffer_pool_get_bulk(udp_rx_pool, buffers, UDP_RECV_BATCH_SIZE);
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < UDP_RECV_BATCH_SIZE; i++) {
+      iovs[i].iov_base = buffers[i];
+      iovs[i].iov_len = UDP_DATA_MAX_MSG_LEN;
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+      msgs[i].msg_hdr.msg_name = &addrs[i];
+      msgs[i].msg_hdr.msg_namelen = from_len;
+    }
+
+    int received = recvmmsg(udp_sock_pP->sd, msgs, UDP_RECV_BATCH_SIZE,
+                            MSG_DONTWAIT, NULL);
+    if (received <= 0) {
+      if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK &&
+          errno != EINTR) {
+        OAILOG_ERROR(LOG_UDP, "recvmmsg failed %s\n", strerror(errno));
+      }
+      buffer_pool_put_bulk(buffers, UDP_RECV_BATCH_SIZE);
+      return;
     }
 
-    if ((bytes_received = recvfrom(
-             udp_sock_pP->sd, udp_sock_pP->buffer, sizeof(udp_sock_pP->buffer),
-             0, ipv6 ? (struct sockaddr*)&addr6 : (struct sockaddr*)&addr,
-             &from_len)) <= 0) {
-      OAILOG_ERROR(LOG_UDP, "Recvfrom failed %s\n", strerror(errno));
-      // break;
-    } else {
-      MessageDef* message_p = NULL;
-      udp_data_ind_t* udp_data_ind_p;
-      AssertFatal(sizeof(udp_sock_pP->buffer) >= bytes_received,
-                  "UDP BUFFER OVERFLOW");
-      message_p =
-          DEPRECATEDitti_alloc_new_message_fatal(TASK_UDP, UDP_DATA_IND);
-      udp_data_ind_p = &message_p->ittiMsg.udp_data_ind;
-      memcpy(udp_data_ind_p->msgBuf, udp_sock_pP->buffer, bytes_received);
-
-      udp_data_ind_p->buffer_length = bytes_received;
-      udp_data_ind_p->local_port = udp_sock_pP->local_port;
-      udp_data_ind_p->peer_port =
-          ipv6 ? htons(addr6.sin6_port) : htons(addr.sin_port);
-      memcpy((void*)&udp_data_ind_p->sock_addr,
-             (ipv6) ? (void*)&addr6 : (void*)&addr,
-             (ipv6) ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
-
-      OAILOG_DEBUG(LOG_UDP, "Msg of length %d received from %s:%u\n",
-                   bytes_received,
-                   (!ipv6) ? inet_ntoa(addr.sin_addr) : "TODO_IPV6",
-                   ntohs(addr.sin_port));
-
-      if (send_msg_to_task(&udp_task_zmq_ctx, udp_sock_pP->task_id, message_p) <
-          0) {
-        OAILOG_DEBUG(LOG_UDP, "Failed to send message %d to task %d\n",
-                     UDP_DATA_IND, udp_sock_pP->task_id);
-        // break;
+    for (int i = 0; i < received; i++) {
+      if ((msgs[i].msg_hdr.msg_flags & MSG_TRUNC) || (msgs[i].msg_len == 0)) {
+        OAILOG_ERROR(LOG_UDP,
+                     "Dropping datagram of invalid length on sd %d (max %d)\n",
+                     udp_sock_pP->sd, UDP_DATA_MAX_MSG_LEN);
+        continue;
       }
+      udp_server_forward_datagram(udp_sock_pP, buffers[i], msgs[i].msg_len,
+                                  &addrs[i]);
+      buffers[i] = NULL;
+    }
+    // Give back the slots that were not filled or were dropped
+    buffer_pool_put_bulk(buffers, UDP_RECV_BATCH_SIZE);
+
+    if (received < UDP_RECV_BATCH_SIZE) {
+      return;
     }
   }
 }
@@ -353,15 +412,139 @@ static int udp_server_create_socket_v6(uint16_t port, struct in6_addr* address,
   return sd;
 }
 
-static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
-  MessageDef* received_message_p = receive_msg(reader);
+//------------------------------------------------------------------------------
+/* Send the staged datagrams, one sendmmsg per run of entries sharing a
+ * socket, and give their buffers back to the pool. */
+static void udp_tx_batch_flush(void) {
+  struct mmsghdr msgs[UDP_SEND_BATCH_SIZE];
+  struct iovec iovs[UDP_SEND_BATCH_SIZE];
+  uint8_t* buffers[UDP_SEND_BATCH_SIZE];
+  uint32_t first = 0;
+
+  if (!udp_tx_batch.count) return;
+
+  memset(msgs, 0, sizeof(msgs));
+  for (uint32_t i = 0; i < udp_tx_batch.count; i++) {
+    udp_tx_entry_t* entry = &udp_tx_batch.entries[i];
+    iovs[i].iov_base = entry->buffer;
+    iovs[i].iov_len = entry->length;
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_name = &entry->peer;
+    msgs[i].msg_hdr.msg_namelen = entry->peer_len;
+    buffers[i] = entry->buffer;
+  }
+
+  while (first < udp_tx_batch.count) {
+    int sd = udp_tx_batch.entries[first].sd;
+    uint32_t last = first + 1;
+    while (last < udp_tx_batch.count && udp_tx_batch.entries[last].sd == sd) {
+      last++;
+    }
+
+    uint32_t sent = first;
+    while (sent < last) {
+      int rc = sendmmsg(sd, &msgs[sent], last - sent, 0);
+      if (rc < 0) {
+        if (errno == EINTR) continue;
+        OAILOG_ERROR(LOG_UDP,
+                     "There was an error while writing %u datagrams to socket "
+                     "%d (%d:%s)\n",
+                     last - sent, sd, errno, strerror(errno));
+        break;
+      }
+      for (int i = 0; i < rc; i++) {
+        if (msgs[sent + i].msg_len != iovs[sent + i].iov_len) {
+          OAILOG_ERROR(LOG_UDP,
+                       "Short write to socket %d (%u of %zu bytes)\n", sd,
+                       msgs[sent + i].msg_len, iovs[sent + i].iov_len);
+        }
+      }
+      sent += rc;
+    }
+    first = last;
+  }
+
+  buffer_pool_put_bulk(buffers, udp_tx_batch.count);
+  udp_tx_batch.count = 0;
+}
+
+//------------------------------------------------------------------------------
+static void udp_server_queue_data_req(task_id_t origin_task_id,
+                                      udp_data_req_t* udp_data_req_p) {
+  struct udp_socket_desc_s* udp_sock_p = NULL;
+  udp_tx_entry_t* entry = NULL;
+  int sa_family = udp_data_req_p->peer_address->sa_family;
+
+  if (sa_family != AF_INET && sa_family != AF_INET6) {
+    OAILOG_DEBUG(LOG_UDP, "Unknown address type");
+    return;
+  }
+  if (udp_data_req_p->buffer_length > UDP_DATA_MAX_MSG_LEN) {
+    OAILOG_ERROR(LOG_UDP, "Dropping UDP_DATA_REQ of %u bytes (max %d)\n",
+                 udp_data_req_p->buffer_length, UDP_DATA_MAX_MSG_LEN);
+    return;
+  }
+
+  if (udp_tx_batch.count == UDP_SEND_BATCH_SIZE) {
+    udp_tx_batch_flush();
+  }
+
+  pthread_mutex_lock(&udp_socket_list_mutex);
+  udp_sock_p = udp_server_get_socket_desc(
+      origin_task_id, udp_data_req_p->local_port, udp_data_req_p->peer_port,
+      sa_family);
+  if (udp_sock_p == NULL) {
+    OAILOG_ERROR(LOG_UDP,
+                 "Failed to retrieve the udp socket descriptor for %s "
+                 "associated with task %d\n",
+                 (sa_family == AF_INET) ? "IPv4" : "IPv6", origin_task_id);
+    pthread_mutex_unlock(&udp_socket_list_mutex);
+    return;
+  }
+
+  entry = &udp_tx_batch.entries[udp_tx_batch.count];
+  entry->sd = udp_sock_p->sd;
+  pthread_mutex_unlock(&udp_socket_list_mutex);
+
+  memset(&entry->peer, 0, sizeof(entry->peer));
+  if (sa_family == AF_INET) {
+    entry->peer.addrv4.sin_family = AF_INET;
+    entry->peer.addrv4.sin_port = htons(udp_data_req_p->peer_port);
+    entry->peer.addrv4.sin_addr =
+        ((struct sockaddr_in*)udp_data_req_p->peer_address)->sin_addr;
+    entry->peer_len = sizeof(struct sockaddr_in);
+    OAILOG_DEBUG(
+        LOG_UDP,
+        "[%d] Sending message of size %u to " IN_ADDR_FMT " and port %u\n",
+        entry->sd, udp_data_req_p->buffer_length,
+        PRI_IN_ADDR(entry->peer.addrv4.sin_addr), udp_data_req_p->peer_port);
+  } else {
+    entry->peer.addrv6.sin6_family = AF_INET6;
+    entry->peer.addrv6.sin6_port = htons(udp_data_req_p->peer_port);
+    entry->peer.addrv6.sin6_addr =
+        ((struct sockaddr_in6*)udp_data_req_p->peer_address)->sin6_addr;
+    entry->peer_len = sizeof(struct sockaddr_in6);
+  }
+
+  // no free udp_data_req_p->buffer, statically allocated
+  entry->buffer = buffer_pool_get(udp_tx_pool);
+  entry->length = udp_data_req_p->buffer_length;
+  memcpy(entry->buffer,
+         &udp_data_req_p->buffer[udp_data_req_p->buffer_offset],
+         udp_data_req_p->buffer_length);
+  udp_tx_batch.count++;
+}
 
+//------------------------------------------------------------------------------
+static void udp_process_message(MessageDef* received_message_p) {
   switch (ITTI_MSG_ID(received_message_p)) {
     case MESSAGE_TEST: {
       OAI_FPRINTF_INFO("TASK_UDP received MESSAGE_TEST\n");
     } break;
 
     case TERMINATE_MESSAGE: {
+      udp_tx_batch_flush();
       itti_free_msg_content(received_message_p);
       free(received_message_p);
       udp_exit();
@@ -378,102 +561,8 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
     } break;
 
     case UDP_DATA_REQ: {
-      int udp_sd = -1;
-      ssize_t bytes_written;
-      struct udp_socket_desc_s* udp_sock_p = NULL;
-      udp_data_req_t* udp_data_req_p;
-      struct sockaddr_in peer_addr;
-      struct sockaddr_in6 peer_addr6;
-
-      udp_data_req_p = &received_message_p->ittiMsg.udp_data_req;
-      // UDP_DEBUG("-- UDP_DATA_REQ
-      // -----------------------------------------------------\n%s :\n",
-      //        __FUNCTION__);
-      // udp_print_hex_octets(&udp_data_req_p->buffer[udp_data_req_p->buffer_offset],
-      //        udp_data_req_p->buffer_length);
-      if (udp_data_req_p->peer_address->sa_family == AF_INET) {
-        memset(&peer_addr, 0, sizeof(struct sockaddr_in));
-        peer_addr.sin_family = AF_INET;
-        peer_addr.sin_port = htons(udp_data_req_p->peer_port);
-        peer_addr.sin_addr =
-            ((struct sockaddr_in*)udp_data_req_p->peer_address)->sin_addr;
-        pthread_mutex_lock(&udp_socket_list_mutex);
-        udp_sock_p = udp_server_get_socket_desc(
-            ITTI_MSG_ORIGIN_ID(received_message_p), udp_data_req_p->local_port,
-            udp_data_req_p->peer_port, AF_INET);
-
-        if (udp_sock_p == NULL) {
-          OAILOG_ERROR(LOG_UDP,
-                       "Failed to retrieve the udp socket descriptor for IPv4 "
-                       "associated with task %d\n",
-                       ITTI_MSG_ORIGIN_ID(received_message_p));
-          pthread_mutex_unlock(&udp_socket_list_mutex);
-          // no free udp_data_req_p->buffer, statically allocated
-          break;
-        }
-
-        udp_sd = udp_sock_p->sd;
-        pthread_mutex_unlock(&udp_socket_list_mutex);
-        OAILOG_DEBUG(
-            LOG_UDP,
-            "[%d] Sending message of size %u to " IN_ADDR_FMT " and port %u\n",
-            udp_sd, udp_data_req_p->buffer_length,
-            PRI_IN_ADDR(
-                ((struct sockaddr_in*)udp_data_req_p->peer_address)->sin_addr),
-            udp_data_req_p->peer_port);
-        bytes_written = sendto(
-            udp_sd, &udp_data_req_p->buffer[udp_data_req_p->buffer_offset],
-            udp_data_req_p->buffer_length, 0, (struct sockaddr*)&peer_addr,
-            sizeof(struct sockaddr_in));
-        // no free udp_data_req_p->buffer, statically allocated
-
-        if (bytes_written != udp_data_req_p->buffer_length) {
-          OAILOG_ERROR(LOG_UDP,
-                       "There was an error while writing to socket "
-                       "(%d:%s)\n",
-                       errno, strerror(errno));
-        }
-      } else if (udp_data_req_p->peer_address->sa_family == AF_INET6) {
-        memset(&peer_addr6, 0, sizeof(struct sockaddr_in6));
-        peer_addr6.sin6_family = AF_INET6;
-        peer_addr6.sin6_port = htons(udp_data_req_p->peer_port);
-        peer_addr6.sin6_addr =
-            ((struct sockaddr_in6*)udp_data_req_p->peer_address)->sin6_addr;
-        pthread_mutex_lock(&udp_socket_list_mutex);
-        udp_sock_p = udp_server_get_socket_desc(
-            ITTI_MSG_ORIGIN_ID(received_message_p), udp_data_req_p->local_port,
-            udp_data_req_p->peer_port, AF_INET6);
-
-        if (udp_sock_p == NULL) {
-          OAILOG_ERROR(LOG_UDP,
-                       "Failed to retrieve the udp socket descriptor for IPv6 "
-                       "associated with task %d\n",
-                       ITTI_MSG_ORIGIN_ID(received_message_p));
-          pthread_mutex_unlock(&udp_socket_list_mutex);
-          // no free udp_data_req_p->buffer, statically allocated
-          break;
-        }
-
-        udp_sd = udp_sock_p->sd;
-        pthread_mutex_unlock(&udp_socket_list_mutex);
-        bytes_written = sendto(
-            udp_sd, &udp_data_req_p->buffer[udp_data_req_p->buffer_offset],
-            udp_data_req_p->buffer_length, 0, (struct sockaddr*)&peer_addr6,
-            sizeof(struct sockaddr_in6));
-        // no free udp_data_req_p->buffer, statically allocated
-
-        if (bytes_written != udp_data_req_p->buffer_length) {
-          OAILOG_ERROR(LOG_UDP,
-                       "There was an error while writing to socket "
-                       "(%d:%s)\n",
-                       errno, strerror(errno));
-        }
-      }
-
-      else {
-        OAILOG_DEBUG(LOG_UDP, "Unknown address type");
-      }
-
+      udp_server_queue_data_req(ITTI_MSG_ORIGIN_ID(received_message_p),
+                                &received_message_p->ittiMsg.udp_data_req);
     } break;
 
     default: {
@@ -485,6 +574,20 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
 
   itti_free_msg_content(received_message_p);
   free(received_message_p);
+}
+
+//------------------------------------------------------------------------------
+/* Drain the messages already queued for the task, up to a send batch, so
+ * that back to back UDP_DATA_REQ go out with a single sendmmsg flush. */
+static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
+  int processed = 0;
+
+  do {
+    udp_process_message(receive_msg(reader));
+  } while (++processed < UDP_SEND_BATCH_SIZE &&
+           (zsock_events(reader) & ZMQ_POLLIN));
+
+  udp_tx_batch_flush();
   return 0;
 }
 
@@ -503,6 +606,8 @@ static void* udp_thread(void* args) {
 int udp_init(void) {
   OAILOG_DEBUG(LOG_UDP, "Initializing UDP task interface\n");
   STAILQ_INIT(&udp_socket_list);
+  udp_rx_pool = buffer_pool_create(UDP_DATA_MAX_MSG_LEN, UDP_RX_POOL_SIZE);
+  udp_tx_pool = buffer_pool_create(UDP_DATA_MAX_MSG_LEN, UDP_SEND_BATCH_SIZE);
 
   if (itti_create_task(TASK_UDP, &udp_thread, NULL) < 0) {
     OAILOG_ERROR(LOG_UDP, "udp pthread_create (%s)\n", strerror(errno));
@@ -522,6 +627,11 @@ void udp_exit(void) {
     STAILQ_REMOVE_HEAD(&udp_socket_list, entries);
     free_wrapper((void**)&socket_desc_p);
   }
+  // Receive buffers still referenced by queued UDP_DATA_IND outlive the pool
+  buffer_pool_destroy(udp_rx_pool);
+  buffer_pool_destroy(udp_tx_pool);
+  udp_rx_pool = NULL;
+  udp_tx_pool = NULL;
 
   destroy_task_context(&udp_task_zmq_ctx);
   OAI_FPRINTF_INFO("TASK_UDP terminated\n");
@@ -13,6 +13,7 @@
 #include <chrono>
 #include <gtest/gtest.h>
 #include <thread>
+#include <vector>
 
 #include "../mock_tasks/mock_tasks.h"
 
@@ -1292,4 +1293,118 @@ TEST_F(AMFAppProcedureTest, ServiceRequestMTWithPDU) {
 
   EXPECT_TRUE(expected_Ids == AMFClientServicer::getInstance().msgtype_stack);
 }
+
+/* Registers a UE context the way an Initial UE message without S-TMSI does */
+static ue_m5gmm_context_s* register_ue_context(amf_app_desc_t* amf_app_desc_p,
+                                               uint32_t gnb_id,
+                                               gnb_ue_ngap_id_t gnb_ue_ngap_id,
+                                               imsi64_t imsi64, tmsi_t tmsi) {
+  gnb_ngap_id_key_t gnb_ngap_id_key = INVALID_GNB_UE_NGAP_ID_KEY;
+  guti_m5_t guti = {};
+  guti.guamfi.amf_regionid = 1;
+  guti.guamfi.amf_set_id = 1;
+  guti.m_tmsi = tmsi;
+
+  if (ue_context_lookup_by_gnb_ue_id(gnb_id, gnb_ue_ngap_id)) {
+    return nullptr;
+  }
+  ue_m5gmm_context_s* ue_context_p = amf_create_new_ue_context();
+  ue_context_p->gnb_ue_ngap_id = gnb_ue_ngap_id;
+  AMF_APP_GNB_NGAP_ID_KEY(gnb_ngap_id_key, gnb_id, gnb_ue_ngap_id);
+  amf_ue_context_update_coll_keys(
+      &amf_app_desc_p->amf_ue_contexts, ue_context_p, gnb_ngap_id_key,
+      amf_app_ctx_get_new_ue_id(&amf_app_desc_p->amf_app_ue_ngap_id_generator),
+      imsi64, ue_context_p->amf_teid_n11, &guti);
+  amf_insert_ue_context(ue_context_p->amf_ue_ngap_id, ue_context_p);
+  ue_context_p->amf_context.imsi64 = imsi64;
+  return ue_context_p;
+}
+
+TEST_F(AMFAppProcedureTest, TestUeContextLookupsFollowReKeyAndRelease) {
+  amf_ue_context_t* amf_ue_contexts = &amf_app_desc_p->amf_ue_contexts;
+  amf_ue_ngap_id_t ue_id = INVALID_AMF_UE_NGAP_ID;
+
+  // Two gNBs picked the same RAN UE NGAP ID
+  ue_m5gmm_context_s* ue1 =
+      register_ue_context(amf_app_desc_p, 1, 7, 222456000000001, 0x1001);
+  ue_m5gmm_context_s* ue2 =
+      register_ue_context(amf_app_desc_p, 2, 7, 222456000000002, 0x1002);
+  ASSERT_NE(ue1, nullptr);
+  ASSERT_NE(ue2, nullptr);
+  EXPECT_EQ(ue_context_lookup_by_gnb_ue_id(1, 7), ue1);
+  EXPECT_EQ(ue_context_lookup_by_gnb_ue_id(2, 7), ue2);
+  EXPECT_EQ(ue_context_lookup_by_gnb_ue_id(3, 7), nullptr);
+  EXPECT_EQ(ue_context_loopkup_by_guti(0x1001), ue1);
+  EXPECT_EQ(ue_context_loopkup_by_guti(0x1002), ue2);
+  EXPECT_EQ(ue_context_loopkup_by_guti(0x1003), nullptr);
+  EXPECT_TRUE(get_amf_ue_id_from_imsi(amf_ue_contexts, 222456000000002,
+                                      &ue_id));
+  EXPECT_EQ(ue_id, ue2->amf_ue_ngap_id);
+
+  // UE 1 comes back from idle through another gNB and gets a new ue_id
+  amf_ue_ngap_id_t old_ue_id = ue1->amf_ue_ngap_id;
+  gnb_ngap_id_key_t gnb_ngap_id_key = INVALID_GNB_UE_NGAP_ID_KEY;
+  amf_ue_contexts->gnb_ue_ngap_id_ue_context_htbl.remove(ue1->gnb_ngap_id_key);
+  ue1->gnb_ngap_id_key = INVALID_GNB_UE_NGAP_ID_KEY;
+  amf_remove_ue_context(ue1);
+  AMF_APP_GNB_NGAP_ID_KEY(gnb_ngap_id_key, 3, 9);
+  amf_ue_context_update_coll_keys(
+      amf_ue_contexts, ue1, gnb_ngap_id_key,
+      amf_app_ctx_get_new_ue_id(&amf_app_desc_p->amf_app_ue_ngap_id_generator),
+      ue1->amf_context.imsi64, ue1->amf_teid_n11, &ue1->amf_context.m5_guti);
+  amf_insert_ue_context(ue1->amf_ue_ngap_id, ue1);
+  EXPECT_NE(ue1->amf_ue_ngap_id, old_ue_id);
+  EXPECT_EQ(amf_ue_context_exists_amf_ue_ngap_id(old_ue_id), nullptr);
+  EXPECT_EQ(ue_context_loopkup_by_guti(0x1001), ue1);
+  EXPECT_EQ(ue_context_lookup_by_gnb_ue_id(1, 7), nullptr);
+  EXPECT_EQ(ue_context_lookup_by_gnb_ue_id(3, 9), ue1);
+
+  // UE 2 is assigned a new GUTI, its old TMSI no longer finds it
+  guti_m5_t guti = ue2->amf_context.m5_guti;
+  guti.m_tmsi = 0x2002;
+  amf_ue_context_on_new_guti(ue2, &guti);
+  uint64_t tmsi_ue_id = INVALID_AMF_UE_NGAP_ID;
+  EXPECT_EQ(amf_ue_contexts->tmsi_ue_context_htbl.get(0x1002, &tmsi_ue_id),
+            magma::MAP_KEY_NOT_EXISTS);
+  EXPECT_EQ(ue_context_loopkup_by_guti(0x2002), ue2);
+
+  amf_free_ue_context(ue1);
+  amf_free_ue_context(ue2);
+  EXPECT_EQ(ue_context_loopkup_by_guti(0x1001), nullptr);
+  EXPECT_EQ(ue_context_lookup_by_gnb_ue_id(2, 7), nullptr);
+  EXPECT_TRUE(amf_ue_contexts->tmsi_ue_context_htbl.isEmpty());
+  EXPECT_TRUE(amf_ue_contexts->gnb_ue_ngap_id_ue_context_htbl.isEmpty());
+}
+
+/*
+ * Every Initial UE message looks the UE up by its RAN UE NGAP ID, and a new
+ * UE misses. Registrations index every UE by its RAN UE NGAP ID and 5G-TMSI
+ * rather than scanning the contexts the AMF already serves.
+ */
+TEST_F(AMFAppProcedureTest, TestRegistrationStormLookups) {
+  const uint32_t num_ues = 100000;
+  std::vector<ue_m5gmm_context_s*> ue_contexts;
+
+  ue_contexts.reserve(num_ues);
+  for (uint32_t i = 0; i < num_ues; i++) {
+    // 100 gNBs with 1000 UEs each
+    EXPECT_EQ(ue_context_lookup_by_gnb_ue_id(1 + i % 100, i / 100), nullptr);
+    ue_contexts.push_back(register_ue_context(
+        amf_app_desc_p, 1 + i % 100, i / 100, 222456000000000 + i, 1 + i));
+  }
+
+  EXPECT_EQ(amf_app_desc_p->amf_ue_contexts.tmsi_ue_context_htbl.size(),
+            num_ues);
+  EXPECT_EQ(
+      amf_app_desc_p->amf_ue_contexts.gnb_ue_ngap_id_ue_context_htbl.size(),
+      num_ues);
+  EXPECT_EQ(ue_context_lookup_by_gnb_ue_id(1 + 4242 % 100, 4242 / 100),
+            ue_contexts[4242]);
+  EXPECT_EQ(ue_context_loopkup_by_guti(1 + 4242), ue_contexts[4242]);
+
+  for (auto ue_context_p : ue_contexts) {
+    amf_free_ue_context(ue_context_p);
+  }
+  EXPECT_TRUE(amf_app_desc_p->amf_ue_contexts.tmsi_ue_context_htbl.isEmpty());
+}
 }  // namespace magma5g
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2022 The Magma Authors.
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string>
+
+#include "lte/gateway/c/core/oai/tasks/amf/amf_suci_deconcealer.h"
+
+using ::testing::Test;
+
+namespace magma5g {
+
+// Test data of TS 33.501 Annex C.4.3 and C.4.4
+const char* PROFILE_A_HN_PRIVATE_KEY =
+    "c53c22208b61860b06c62e5406a7b330c2b577aa5558981510d128247d38bd1d";
+const char* PROFILE_A_UE_PUBLIC_KEY =
+    "b2e92f836055a255837debf850b528997ce0201cb82adfe4be1f587d07d8457d";
+const char* PROFILE_A_CIPHERTEXT = "cb02352410";
+const char* PROFILE_A_MAC_TAG = "cddd9e730ef3fa87";
+
+const char* PROFILE_B_HN_PRIVATE_KEY =
+    "f1ab1074477ebcc7f554ea1c5fc368b1616730155e0041ac447d6301975fecda";
+const char* PROFILE_B_UE_PUBLIC_KEY =
+    "039aab8376597021e855679a9778ea0b67396e68c66df32c0f41e9acca2da9b9d1";
+const char* PROFILE_B_CIPHERTEXT = "46a33fc271";
+const char* PROFILE_B_MAC_TAG = "6ac7dae96aa30a4d";
+
+const char* PLAINTEXT = "00012080f6";
+
+const char* ZERO_KEY =
+    "0000000000000000000000000000000000000000000000000000000000000000";
+// Order of secp256r1
+const char* P256_ORDER =
+    "ffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc632551";
+
+class SuciDeconcealerTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    ASSERT_TRUE(deconcealer.add_home_network_key(
+        1, SUCI_PROTECTION_SCHEME_PROFILE_A, bytes(PROFILE_A_HN_PRIVATE_KEY)));
+    ASSERT_TRUE(deconcealer.add_home_network_key(
+        2, SUCI_PROTECTION_SCHEME_PROFILE_B, bytes(PROFILE_B_HN_PRIVATE_KEY)));
+  }
+
+  static std::string bytes(const char* hex) {
+    std::string result;
+    EXPECT_TRUE(suci_hex_to_bytes(hex, &result));
+    return result;
+  }
+
+  bool deconceal(uint8_t hn_pubkey_identifier, const char* ue_pubkey,
+                 const char* ciphertext, const char* mac_tag,
+                 std::string* plaintext) {
+    return deconcealer.deconceal(hn_pubkey_identifier, bytes(ue_pubkey),
+                                 bytes(ciphertext), bytes(mac_tag), plaintext);
+  }
+
+  SuciDeconcealer deconcealer;
+};
+
+TEST_F(SuciDeconcealerTest, test_deconceal_profile_a) {
+  std::string plaintext;
+  EXPECT_TRUE(deconceal(1, PROFILE_A_UE_PUBLIC_KEY, PROFILE_A_CIPHERTEXT,
+                        PROFILE_A_MAC_TAG, &plaintext));
+  EXPECT_EQ(plaintext, bytes(PLAINTEXT));
+}
+
+TEST_F(SuciDeconcealerTest, test_deconceal_profile_b) {
+  std::string plaintext;
+  EXPECT_TRUE(deconceal(2, PROFILE_B_UE_PUBLIC_KEY, PROFILE_B_CIPHERTEXT,
+                        PROFILE_B_MAC_TAG, &plaintext));
+  EXPECT_EQ(plaintext, bytes(PLAINTEXT));
+}
+
+TEST_F(SuciDeconcealerTest, test_deconceal_failures) {
+  std::string plaintext;
+  // No cached key
+  EXPECT_FALSE(deconcealer.has_home_network_key(3));
+  EXPECT_FALSE(deconceal(3, PROFILE_A_UE_PUBLIC_KEY, PROFILE_A_CIPHERTEXT,
+                         PROFILE_A_MAC_TAG, &plaintext));
+  // Key of the other identifier
+  EXPECT_FALSE(deconceal(2, PROFILE_A_UE_PUBLIC_KEY, PROFILE_A_CIPHERTEXT,
+                         PROFILE_A_MAC_TAG, &plaintext));
+  // MAC tag mismatch
+  EXPECT_FALSE(deconceal(1, PROFILE_A_UE_PUBLIC_KEY, PROFILE_A_CIPHERTEXT,
+                         "cddd9e730ef3fa88", &plaintext));
+  EXPECT_FALSE(deconceal(2, PROFILE_B_UE_PUBLIC_KEY, "46a33fc272",
+                         PROFILE_B_MAC_TAG, &plaintext));
+  // Truncated MAC tag
+  EXPECT_FALSE(deconceal(1, PROFILE_A_UE_PUBLIC_KEY, PROFILE_A_CIPHERTEXT,
+                         "cddd9e730ef3fa", &plaintext));
+  // Small order X25519 public key
+  EXPECT_FALSE(deconceal(1, ZERO_KEY, PROFILE_A_CIPHERTEXT, PROFILE_A_MAC_TAG,
+                         &plaintext));
+  // Not on the curve
+  EXPECT_FALSE(deconceal(
+      2, "030000000000000000000000000000000000000000000000000000000000000001",
+      PROFILE_B_CIPHERTEXT, PROFILE_B_MAC_TAG, &plaintext));
+
+  // The cached keys are cleared
+  deconcealer.clear();
+  EXPECT_FALSE(deconcealer.has_home_network_key(1));
+  EXPECT_FALSE(deconceal(1, PROFILE_A_UE_PUBLIC_KEY, PROFILE_A_CIPHERTEXT,
+                         PROFILE_A_MAC_TAG, &plaintext));
+}
+
+TEST_F(SuciDeconcealerTest, test_invalid_home_network_keys) {
+  // Not 32 bytes
+  EXPECT_FALSE(deconcealer.add_home_network_key(
+      3, SUCI_PROTECTION_SCHEME_PROFILE_A, bytes("c53c2220")));
+  // Null scheme
+  EXPECT_FALSE(deconcealer.add_home_network_key(
+      3, 0, bytes(PROFILE_A_HN_PRIVATE_KEY)));
+  // Out of [1, n - 1]
+  EXPECT_FALSE(deconcealer.add_home_network_key(
+      3, SUCI_PROTECTION_SCHEME_PROFILE_B, bytes(ZERO_KEY)));
+  EXPECT_FALSE(deconcealer.add_home_network_key(
+      3, SUCI_PROTECTION_SCHEME_PROFILE_B, bytes(P256_ORDER)));
+  EXPECT_FALSE(deconcealer.has_home_network_key(3));
+
+  std::string result;
+  EXPECT_FALSE(suci_hex_to_bytes("c53", &result));
+  EXPECT_FALSE(suci_hex_to_bytes("c53g", &result));
+}
+
+// Prints the deconcealments per second of one core, the AMF task deconceals
+// on a single thread
+TEST_F(SuciDeconcealerTest, test_deconceal_throughput) {
+  const int iterations = 2000;
+  const struct {
+    const char* profile;
+    uint8_t hn_pubkey_identifier;
+    const char* ue_pubkey;
+    const char* ciphertext;
+    const char* mac_tag;
+  } profiles[] = {
+      {"A", 1, PROFILE_A_UE_PUBLIC_KEY, PROFILE_A_CIPHERTEXT,
+       PROFILE_A_MAC_TAG},
+      {"B", 2, PROFILE_B_UE_PUBLIC_KEY, PROFILE_B_CIPHERTEXT,
+       PROFILE_B_MAC_TAG},
+  };
+  for (const auto& profile : profiles) {
+    std::string ue_pubkey = bytes(profile.ue_pubkey);
+    std::string ciphertext = bytes(profile.ciphertext);
+    std::string mac_tag = bytes(profile.mac_tag);
+    std::string plaintext;
+    int deconcealed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+      deconcealed +=
+          deconcealer.deconceal(profile.hn_pubkey_identifier, ue_pubkey,
+                                ciphertext, mac_tag, &plaintext);
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    double rate = iterations / elapsed.count();
+    std::cout << "Profile " << profile.profile << ": " << rate
+              << " deconcealments/s per core" << std::endl;
+    EXPECT_EQ(deconcealed, iterations);
+    // A floor well below the rate of a single core
+    EXPECT_GT(rate, 1000);
+  }
+}
+
+}  // namespace magma5g
@@ -0,0 +1,147 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "lte/gateway/c/core/oai/lib/directoryd/DirectorydRecordBuffer.h"
+
+namespace magma {
+
+const char* IMSI1 = "IMSI001010000000001";
+const char* IMSI2 = "IMSI001010000000002";
+
+TEST(DirectorydRecordBufferTest, test_merge_updates) {
+  DirectorydRecordBuffer buffer;
+  // Writes of an attach
+  EXPECT_TRUE(buffer.update_record(IMSI1, "GW_ID"));
+  EXPECT_TRUE(buffer.update_record_field(IMSI1, "sgw_c_teid", "1"));
+  EXPECT_TRUE(buffer.update_record(IMSI2, "GW_ID"));
+  EXPECT_TRUE(buffer.update_record_field(IMSI1, "sgw_u_teid", "10"));
+  EXPECT_TRUE(buffer.update_record_field(IMSI1, "sgw_c_teid", "1,2"));
+  EXPECT_EQ(buffer.get_pending(), 2);
+
+  auto writes = buffer.take_pending();
+  ASSERT_EQ(writes.size(), 2);
+  EXPECT_EQ(writes[0].id, IMSI1);
+  EXPECT_FALSE(writes[0].delete_record);
+  EXPECT_TRUE(writes[0].update_record);
+  EXPECT_EQ(writes[0].location, "GW_ID");
+  // The last value of a field wins
+  std::map<std::string, std::string> fields{{"sgw_c_teid", "1,2"},
+                                            {"sgw_u_teid", "10"}};
+  EXPECT_EQ(writes[0].fields, fields);
+  EXPECT_EQ(writes[1].id, IMSI2);
+  EXPECT_TRUE(writes[1].fields.empty());
+  EXPECT_EQ(buffer.get_pending(), 0);
+  EXPECT_TRUE(buffer.take_pending().empty());
+}
+
+TEST(DirectorydRecordBufferTest, test_elide_add_delete) {
+  DirectorydRecordBuffer buffer;
+  buffer.update_record(IMSI1, "GW_ID");
+  buffer.update_record_field(IMSI1, "sgw_c_teid", "1");
+  buffer.update_record(IMSI2, "GW_ID");
+  // The record may have been written before a restart, it is deleted
+  EXPECT_TRUE(buffer.delete_record(IMSI1));
+  EXPECT_EQ(buffer.get_elided(), 0);
+
+  auto writes = buffer.take_pending();
+  ASSERT_EQ(writes.size(), 2);
+  EXPECT_EQ(writes[0].id, IMSI1);
+  EXPECT_TRUE(writes[0].delete_record);
+  EXPECT_FALSE(writes[0].update_record);
+  EXPECT_TRUE(writes[0].fields.empty());
+  EXPECT_EQ(writes[1].id, IMSI2);
+
+  // Deleted by the last flush, created and deleted again
+  buffer.update_record(IMSI1, "GW_ID");
+  buffer.update_record_field(IMSI1, "sgw_c_teid", "2");
+  EXPECT_TRUE(buffer.delete_record(IMSI1));
+  EXPECT_TRUE(buffer.take_pending().empty());
+  EXPECT_EQ(buffer.get_elided(), 1);
+
+  // Once written, the record is deleted and its updates are dropped
+  buffer.update_record(IMSI1, "GW_ID");
+  buffer.take_pending();
+  buffer.update_record_field(IMSI1, "sgw_c_teid", "3");
+  EXPECT_TRUE(buffer.delete_record(IMSI1));
+  writes = buffer.take_pending();
+  ASSERT_EQ(writes.size(), 1);
+  EXPECT_TRUE(writes[0].delete_record);
+  EXPECT_FALSE(writes[0].update_record);
+  EXPECT_EQ(buffer.get_elided(), 1);
+}
+
+TEST(DirectorydRecordBufferTest, test_deleted_records_bounded) {
+  DirectorydRecordBuffer buffer(DirectorydRecordBuffer::DEFAULT_MAX_PENDING,
+                                1);
+  buffer.delete_record(IMSI1);
+  buffer.delete_record(IMSI2);
+  EXPECT_EQ(buffer.take_pending().size(), 2);
+
+  // IMSI1 is forgotten, its delete is sent
+  buffer.update_record(IMSI1, "GW_ID");
+  buffer.delete_record(IMSI1);
+  buffer.update_record(IMSI2, "GW_ID");
+  buffer.delete_record(IMSI2);
+  auto writes = buffer.take_pending();
+  ASSERT_EQ(writes.size(), 1);
+  EXPECT_EQ(writes[0].id, IMSI1);
+  EXPECT_TRUE(writes[0].delete_record);
+  EXPECT_EQ(buffer.get_elided(), 1);
+}
+
+TEST(DirectorydRecordBufferTest, test_delete_then_update) {
+  DirectorydRecordBuffer buffer;
+  buffer.update_record(IMSI1, "GW_ID");
+  buffer.update_record_field(IMSI1, "sgw_c_teid", "1");
+  buffer.take_pending();
+
+  // Detach and attach again
+  buffer.delete_record(IMSI1);
+  buffer.update_record(IMSI1, "GW_ID");
+  buffer.update_record_field(IMSI1, "sgw_c_teid", "2");
+  auto writes = buffer.take_pending();
+  ASSERT_EQ(writes.size(), 1);
+  EXPECT_TRUE(writes[0].delete_record);
+  EXPECT_TRUE(writes[0].update_record);
+  EXPECT_EQ(writes[0].fields.at("sgw_c_teid"), "2");
+
+  // The delete is still needed when the record goes away again
+  buffer.delete_record(IMSI1);
+  buffer.update_record(IMSI1, "GW_ID");
+  buffer.delete_record(IMSI1);
+  writes = buffer.take_pending();
+  ASSERT_EQ(writes.size(), 1);
+  EXPECT_TRUE(writes[0].delete_record);
+  EXPECT_FALSE(writes[0].update_record);
+}
+
+TEST(DirectorydRecordBufferTest, test_drop_when_full) {
+  DirectorydRecordBuffer buffer(1);
+  EXPECT_TRUE(buffer.update_record(IMSI1, "GW_ID"));
+  EXPECT_FALSE(buffer.update_record(IMSI2, "GW_ID"));
+  EXPECT_FALSE(buffer.delete_record(IMSI2));
+  // Records already buffered are still written
+  EXPECT_TRUE(buffer.update_record_field(IMSI1, "sgw_c_teid", "1"));
+  EXPECT_EQ(buffer.get_dropped(), 2);
+
+  EXPECT_EQ(buffer.take_pending().size(), 1);
+  EXPECT_TRUE(buffer.update_record(IMSI2, "GW_ID"));
+}
+
+}  // namespace magma
@@ -0,0 +1,400 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <arpa/inet.h>
+#include <chrono>
+#include <deque>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/lib/gtpv2-c/nwgtpv2c-0.11/include/NwGtpv2c.h"
+#include "lte/gateway/c/core/oai/lib/gtpv2-c/nwgtpv2c-0.11/shared/NwGtpv2cMsg.h"
+#include "lte/gateway/c/core/oai/lib/gtpv2-c/nwgtpv2c-0.11/include/NwGtpv2cPrivate.h"
+#include "lte/gateway/c/core/oai/lib/gtpv2-c/nwgtpv2c-0.11/include/NwGtpv2cHash.h"
+}
+
+namespace magma {
+namespace lte {
+
+#define GTPV2C_TEST_STD_PORT 2123
+#define GTPV2C_TEST_MME_HIGH_PORT 40000
+
+struct Datagram {
+  std::vector<uint8_t> data;
+  uint16_t src_port;
+  uint16_t dst_port;
+};
+
+// One end of a back to back S11 link, datagrams are queued in memory and
+// delivered by Gtpv2cStackTest::pump(), no socket nor ITTI involved.
+struct Endpoint {
+  nw_gtpv2c_stack_handle_t stack;
+  struct sockaddr_in addr;
+  uint16_t high_port;
+  std::deque<Datagram> outbox;
+  uint64_t tmr_starts;
+  uint64_t tmr_stops;
+  uint64_t responses;
+  uint64_t requests;
+  uint64_t echo_responses;
+  uint32_t next_teid;
+};
+
+static nw_rc_t udp_data_req(nw_gtpv2c_udp_handle_t udp_handle,
+                            uint8_t* data_buf, uint32_t data_size,
+                            uint16_t local_port, struct sockaddr* peer_ip,
+                            uint16_t peer_port) {
+  Endpoint* endpoint = reinterpret_cast<Endpoint*>(udp_handle);
+  Datagram datagram;
+  datagram.data.assign(data_buf, data_buf + data_size);
+  // Port 0 is the high port the initial requests are sent from
+  datagram.src_port = local_port ? local_port : endpoint->high_port;
+  datagram.dst_port = peer_port;
+  if (data_buf[1] == NW_GTP_ECHO_RSP) endpoint->echo_responses++;
+  endpoint->outbox.push_back(datagram);
+  return NW_OK;
+}
+
+static nw_rc_t tmr_start(nw_gtpv2c_timer_mgr_handle_t tmr_mgr_handle,
+                         uint32_t timeout_ms, uint32_t tmr_type, void* arg,
+                         nw_gtpv2c_timer_handle_t* tmr_handle) {
+  Endpoint* endpoint = reinterpret_cast<Endpoint*>(tmr_mgr_handle);
+  EXPECT_EQ(tmr_type, NW_GTPV2C_TMR_TYPE_REPETITIVE);
+  EXPECT_EQ(timeout_ms, NW_GTPV2C_TMR_WHEEL_TICK_MS);
+  *tmr_handle = ++endpoint->tmr_starts;
+  return NW_OK;
+}
+
+static nw_rc_t tmr_stop(nw_gtpv2c_timer_mgr_handle_t tmr_mgr_handle,
+                        nw_gtpv2c_timer_handle_t tmr_handle) {
+  Endpoint* endpoint = reinterpret_cast<Endpoint*>(tmr_mgr_handle);
+  endpoint->tmr_stops++;
+  return NW_OK;
+}
+
+// MME side ULP: consumes the responses
+static nw_rc_t mme_ulp_req(nw_gtpv2c_ulp_handle_t ulp_handle,
+                           nw_gtpv2c_ulp_api_t* ulp_api) {
+  Endpoint* endpoint = reinterpret_cast<Endpoint*>(ulp_handle);
+  switch (ulp_api->apiType) {
+    case NW_GTPV2C_ULP_API_TRIGGERED_RSP_IND:
+      endpoint->responses++;
+      return nwGtpv2cMsgDelete(endpoint->stack, ulp_api->hMsg);
+    default:
+      ADD_FAILURE() << "Unexpected API " << ulp_api->apiType;
+      return NW_FAILURE;
+  }
+}
+
+// SGW side ULP: answers every Create Session Request
+static nw_rc_t sgw_ulp_req(nw_gtpv2c_ulp_handle_t ulp_handle,
+                           nw_gtpv2c_ulp_api_t* ulp_api) {
+  Endpoint* endpoint = reinterpret_cast<Endpoint*>(ulp_handle);
+  switch (ulp_api->apiType) {
+    case NW_GTPV2C_ULP_API_INITIAL_REQ_IND: {
+      endpoint->requests++;
+      nw_gtpv2c_trxn_handle_t trxn =
+          ulp_api->u_api_info.initialReqIndInfo.hTrxn;
+      EXPECT_EQ(nwGtpv2cMsgDelete(endpoint->stack, ulp_api->hMsg), NW_OK);
+
+      nw_gtpv2c_ulp_api_t rsp;
+      memset(&rsp, 0, sizeof(rsp));
+      rsp.apiType = NW_GTPV2C_ULP_API_TRIGGERED_RSP;
+      rsp.u_api_info.triggeredRspInfo.hTrxn = trxn;
+      EXPECT_EQ(nwGtpv2cMsgNew(endpoint->stack, true,
+                               NW_GTP_CREATE_SESSION_RSP,
+                               endpoint->next_teid++, 0, &rsp.hMsg),
+                NW_OK);
+      EXPECT_EQ(
+          nwGtpv2cMsgAddIeCause(rsp.hMsg, 0, NW_GTPV2C_CAUSE_REQUEST_ACCEPTED,
+                                0, 0, 0),
+          NW_OK);
+      return nwGtpv2cProcessUlpReq(endpoint->stack, &rsp);
+    }
+    default:
+      ADD_FAILURE() << "Unexpected API " << ulp_api->apiType;
+      return NW_FAILURE;
+  }
+}
+
+static double cpu_seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+class Gtpv2cStackTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    setup_endpoint(&mme_, "10.0.0.1", GTPV2C_TEST_MME_HIGH_PORT, mme_ulp_req);
+    setup_endpoint(&sgw_, "10.0.0.2", GTPV2C_TEST_STD_PORT, sgw_ulp_req);
+  }
+
+  virtual void TearDown() {
+    EXPECT_EQ(nwGtpv2cFinalize(mme_.stack), NW_OK);
+    EXPECT_EQ(nwGtpv2cFinalize(sgw_.stack), NW_OK);
+  }
+
+  void setup_endpoint(Endpoint* endpoint, const char* ip, uint16_t high_port,
+                      nw_rc_t (*ulp_req)(nw_gtpv2c_ulp_handle_t,
+                                         nw_gtpv2c_ulp_api_t*)) {
+    endpoint->outbox.clear();
+    endpoint->tmr_starts = endpoint->tmr_stops = 0;
+    endpoint->responses = endpoint->requests = endpoint->echo_responses = 0;
+    endpoint->next_teid = 1;
+    endpoint->high_port = high_port;
+    memset(&endpoint->addr, 0, sizeof(endpoint->addr));
+    endpoint->addr.sin_family = AF_INET;
+    inet_pton(AF_INET, ip, &endpoint->addr.sin_addr);
+
+    ASSERT_EQ(nwGtpv2cInitialize(&endpoint->stack), NW_OK);
+    nw_gtpv2c_ulp_entity_t ulp = {0};
+    ulp.hUlp = reinterpret_cast<nw_gtpv2c_ulp_handle_t>(endpoint);
+    ulp.ulpReqCallback = ulp_req;
+    ASSERT_EQ(nwGtpv2cSetUlpEntity(endpoint->stack, &ulp), NW_OK);
+    nw_gtpv2c_udp_entity_t udp = {0};
+    udp.hUdp = reinterpret_cast<nw_gtpv2c_udp_handle_t>(endpoint);
+    udp.gtpv2cStandardPort = GTPV2C_TEST_STD_PORT;
+    udp.udpDataReqCallback = udp_data_req;
+    ASSERT_EQ(nwGtpv2cSetUdpEntity(endpoint->stack, &udp), NW_OK);
+    nw_gtpv2c_timer_mgr_entity_t tmr = {0};
+    tmr.tmrMgrHandle = reinterpret_cast<nw_gtpv2c_timer_mgr_handle_t>(endpoint);
+    tmr.tmrStartCallback = tmr_start;
+    tmr.tmrStopCallback = tmr_stop;
+    ASSERT_EQ(nwGtpv2cSetTimerMgrEntity(endpoint->stack, &tmr), NW_OK);
+  }
+
+  // Delivers queued datagrams until both links are idle
+  void pump() {
+    while (!mme_.outbox.empty() || !sgw_.outbox.empty()) {
+      deliver(&mme_, &sgw_);
+      deliver(&sgw_, &mme_);
+    }
+  }
+
+  void deliver(Endpoint* from, Endpoint* to) {
+    while (!from->outbox.empty()) {
+      Datagram datagram = from->outbox.front();
+      from->outbox.pop_front();
+      EXPECT_EQ(nwGtpv2cProcessUdpReq(to->stack, datagram.data.data(),
+                                      datagram.data.size(), datagram.dst_port,
+                                      datagram.src_port,
+                                      (struct sockaddr*)&from->addr),
+                NW_OK);
+    }
+  }
+
+  void send_create_session_request(uint32_t teid_local) {
+    nw_gtpv2c_ulp_api_t req;
+    memset(&req, 0, sizeof(req));
+    req.apiType = NW_GTPV2C_ULP_API_INITIAL_REQ;
+    ASSERT_EQ(nwGtpv2cMsgNew(mme_.stack, true, NW_GTP_CREATE_SESSION_REQ, 0, 0,
+                             &req.hMsg),
+              NW_OK);
+    req.u_api_info.initialReqInfo.edns_peer_ip = (struct sockaddr*)&sgw_.addr;
+    req.u_api_info.initialReqInfo.teidLocal = teid_local;
+    req.u_api_info.initialReqInfo.hUlpTunnel = teid_local;
+    ASSERT_EQ(nwGtpv2cProcessUlpReq(mme_.stack, &req), NW_OK);
+  }
+
+  nw_gtpv2c_stack_t* stack(Endpoint* endpoint) {
+    return reinterpret_cast<nw_gtpv2c_stack_t*>(endpoint->stack);
+  }
+
+  Endpoint mme_;
+  Endpoint sgw_;
+};
+
+// Load generator: Create Session Request/Response round trips between an
+// MME and an SGW stack, every request keeps its own S11 tunnel.
+TEST_F(Gtpv2cStackTest, TestCreateSessionTps) {
+  const uint32_t kSessions = 50000;
+  const uint32_t kWindow = 256;
+
+  auto start = std::chrono::steady_clock::now();
+  double cpu_start = cpu_seconds();
+  for (uint32_t teid = 1; teid <= kSessions; teid++) {
+    send_create_session_request(teid);
+    if (teid % kWindow == 0) pump();
+  }
+  pump();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  double cpu = cpu_seconds() - cpu_start;
+
+  EXPECT_EQ(sgw_.requests, kSessions);
+  EXPECT_EQ(mme_.responses, kSessions);
+  EXPECT_EQ(HASH_COUNT(&stack(&mme_)->tunnelMap), kSessions);
+  // Answered requests leave the TX map, their guard timers are stopped
+  EXPECT_TRUE(HASH_EMPTY(&stack(&mme_)->outstandingTxSeqNumMap));
+  EXPECT_EQ(stack(&mme_)->tmrWheel.activeTimers, 0);
+  // The SGW keeps answered requests for duplicate detection
+  EXPECT_EQ(HASH_COUNT(&stack(&sgw_)->outstandingRxSeqNumMap), kSessions);
+  EXPECT_EQ(stack(&sgw_)->tmrWheel.activeTimers, kSessions);
+  // One wheel tick timer per stack, never one ULP timer per transaction
+  EXPECT_EQ(mme_.tmr_starts, 1);
+  EXPECT_EQ(sgw_.tmr_starts, 1);
+  // Messages and transactions are recycled, only the tunnels pile up
+  EXPECT_LE(stack(&mme_)->msgPool.capacity, 2 * kWindow);
+  EXPECT_LE(stack(&mme_)->trxnPool.capacity, 2 * kWindow);
+
+  double tps = kSessions / elapsed.count();
+  std::cout << "GTPv2-C CSR/CSResp: " << kSessions << " sessions in "
+            << elapsed.count() << " s, " << static_cast<uint64_t>(tps)
+            << " sessions/s, " << cpu * 1e6 / kSessions << " us CPU/session"
+            << std::endl;
+  RecordProperty("create_sessions_per_sec", static_cast<int>(tps));
+}
+
+TEST_F(Gtpv2cStackTest, TestEchoTps) {
+  const uint32_t kEchos = 100000;
+  uint8_t echo_req[] = {0x40, NW_GTP_ECHO_REQ, 0x00, 0x09, 0x00, 0x00,
+                        0x00, 0x00, NW_GTPV2C_IE_RECOVERY, 0x00, 0x01,
+                        0x00, 0x05};
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t seq = 0; seq < kEchos; seq++) {
+    echo_req[4] = (seq >> 16) & 0xff;
+    echo_req[5] = (seq >> 8) & 0xff;
+    echo_req[6] = seq & 0xff;
+    ASSERT_EQ(nwGtpv2cProcessUdpReq(sgw_.stack, echo_req, sizeof(echo_req),
+                                    GTPV2C_TEST_STD_PORT,
+                                    GTPV2C_TEST_MME_HIGH_PORT,
+                                    (struct sockaddr*)&mme_.addr),
+              NW_OK);
+    sgw_.outbox.clear();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(sgw_.echo_responses, kEchos);
+  EXPECT_EQ(stack(&sgw_)->msgPool.inUse, 0);
+  std::cout << "GTPv2-C echo: "
+            << static_cast<uint64_t>(kEchos / elapsed.count()) << " echo/s"
+            << std::endl;
+}
+
+static int timer_fired[4];
+
+static nw_rc_t on_timer(void* arg) {
+  timer_fired[reinterpret_cast<uintptr_t>(arg)]++;
+  return NW_OK;
+}
+
+TEST_F(Gtpv2cStackTest, TestTimerWheel) {
+  nw_gtpv2c_stack_t* thiz = stack(&mme_);
+  nw_gtpv2c_timer_handle_t timers[4];
+  memset(timer_fired, 0, sizeof(timer_fired));
+
+  ASSERT_EQ(nwGtpv2cStartTimer(thiz, 0, 100000, NW_GTPV2C_TMR_TYPE_ONE_SHOT,
+                               on_timer, (void*)0, &timers[0]),
+            NW_OK);
+  ASSERT_EQ(nwGtpv2cStartTimer(thiz, 0, 200000, NW_GTPV2C_TMR_TYPE_ONE_SHOT,
+                               on_timer, (void*)1, &timers[1]),
+            NW_OK);
+  ASSERT_EQ(nwGtpv2cStartTimer(thiz, 0, 200000, NW_GTPV2C_TMR_TYPE_ONE_SHOT,
+                               on_timer, (void*)2, &timers[2]),
+            NW_OK);
+  // Longer than a wheel revolution
+  ASSERT_EQ(nwGtpv2cStartTimer(thiz, 60, 0, NW_GTPV2C_TMR_TYPE_ONE_SHOT,
+                               on_timer, (void*)3, &timers[3]),
+            NW_OK);
+  EXPECT_EQ(mme_.tmr_starts, 1);
+  EXPECT_EQ(thiz->tmrWheel.activeTimers, 4);
+  EXPECT_EQ(nwGtpv2cStopTimer(thiz, timers[2]), NW_OK);
+
+  // Never fires early, even when started late in a tick
+  EXPECT_EQ(nwGtpv2cProcessTimeout(&thiz->tmrWheel.tickInfo), NW_OK);
+  EXPECT_EQ(timer_fired[0] + timer_fired[1], 0);
+  std::this_thread::sleep_for(
+      std::chrono::milliseconds(NW_GTPV2C_TMR_WHEEL_TICK_MS - 10));
+  EXPECT_EQ(nwGtpv2cProcessTimeout(&thiz->tmrWheel.tickInfo), NW_OK);
+  EXPECT_EQ(timer_fired[0] + timer_fired[1], 0);
+
+  std::this_thread::sleep_for(
+      std::chrono::milliseconds(3 * NW_GTPV2C_TMR_WHEEL_TICK_MS + 50));
+  EXPECT_EQ(nwGtpv2cProcessTimeout(&thiz->tmrWheel.tickInfo), NW_OK);
+  EXPECT_EQ(timer_fired[0], 1);
+  EXPECT_EQ(timer_fired[1], 1);
+  EXPECT_EQ(timer_fired[2], 0);
+  EXPECT_EQ(timer_fired[3], 0);
+  EXPECT_EQ(thiz->tmrWheel.activeTimers, 1);
+  EXPECT_EQ(mme_.tmr_stops, 0);
+
+  // Expired and stopped timers can not be stopped twice
+  EXPECT_EQ(nwGtpv2cStopTimer(thiz, timers[3]), NW_OK);
+  EXPECT_EQ(nwGtpv2cStopTimer(thiz, timers[3]), NW_FAILURE);
+
+  // The tick timer goes away once the wheel is empty
+  EXPECT_EQ(nwGtpv2cProcessTimeout(&thiz->tmrWheel.tickInfo), NW_OK);
+  EXPECT_EQ(mme_.tmr_stops, 1);
+  EXPECT_FALSE(thiz->tmrWheel.ticking);
+  EXPECT_EQ(thiz->timeoutInfoPool.inUse, 0);
+}
+
+struct hash_test_node_s {
+  uint32_t key;
+  HASH_ENTRY(hash_test_node_s) node;
+};
+
+static uint32_t hash_test_hash(struct hash_test_node_s* a) {
+  // Poor hash on purpose, every chain is 4 deep
+  return a->key >> 2;
+}
+
+static int hash_test_cmp(struct hash_test_node_s* a,
+                         struct hash_test_node_s* b) {
+  return a->key != b->key;
+}
+
+HASH_HEAD(HashTestMap, hash_test_node_s);
+HASH_PROTOTYPE(HashTestMap, hash_test_node_s, node, hash_test_hash,
+               hash_test_cmp)
+HASH_GENERATE(HashTestMap, hash_test_node_s, node, hash_test_hash,
+              hash_test_cmp)
+
+TEST(Gtpv2cHashTest, TestGrowFindRemove) {
+  const uint32_t kNodes = 10000;
+  struct HashTestMap map;
+  std::vector<hash_test_node_s> nodes(kNodes);
+
+  ASSERT_EQ(HASH_INIT(HashTestMap, &map, 4), 0);
+  for (uint32_t i = 0; i < kNodes; i++) {
+    nodes[i].key = i;
+    EXPECT_EQ(HASH_INSERT(HashTestMap, &map, &nodes[i]), nullptr);
+  }
+  EXPECT_EQ(HASH_COUNT(&map), kNodes);
+  EXPECT_GE(map.hth_mask + 1, kNodes);
+
+  hash_test_node_s duplicate = {5};
+  EXPECT_EQ(HASH_INSERT(HashTestMap, &map, &duplicate), &nodes[5]);
+  // Never inserted, nothing to remove
+  EXPECT_EQ(HASH_REMOVE(HashTestMap, &map, &duplicate), nullptr);
+
+  for (uint32_t i = 0; i < kNodes; i += 2) {
+    EXPECT_EQ(HASH_REMOVE(HashTestMap, &map, &nodes[i]), &nodes[i]);
+  }
+  for (uint32_t i = 0; i < kNodes; i++) {
+    hash_test_node_s key = {i};
+    EXPECT_EQ(HASH_FIND(HashTestMap, &map, &key),
+              (i % 2) ? &nodes[i] : nullptr);
+  }
+  EXPECT_EQ(HASH_COUNT(&map), kNodes / 2);
+  HASH_FINALIZE(HashTestMap, &map);
+}
+
+}  // namespace lte
+}  // namespace magma
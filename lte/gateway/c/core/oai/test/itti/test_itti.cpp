@@ -22,6 +22,7 @@ extern "C" {
 #undef CHECK_PROTOTYPE_ONLY
 #include "lte/gateway/c/core/oai/lib/itti/intertask_interface.h"
 #include "lte/gateway/c/core/oai/lib/itti/intertask_interface_types.h"
+#include "lte/gateway/c/core/oai/lib/itti/itti_stats.h"
 #include "lte/gateway/c/core/oai/common/itti_free_defined_msg.h"
 }
 
@@ -139,6 +140,37 @@ TEST_F(ITTIMessagePassingTest, TestMessageLatency) {
   ASSERT_GE(msg_latency, 1000000);
 }
 
+TEST_F(ITTIMessagePassingTest, TestMessageStats) {
+  // The statistics of a task are kept across its contexts
+  itti_task_stats_read_t task_before = {};
+  ASSERT_TRUE(itti_stats_read_task(TASK_TEST_2, &task_before));
+  itti_msg_stats_t msg_before = {};
+  itti_stats_read_message(TASK_TEST_2, TEST_MESSAGE, &msg_before);
+
+  // The second message waits for the 1.5 s handler of the first one
+  for (int i = 0; i < 2; i++) {
+    MessageDef* test_message_p = DEPRECATEDitti_alloc_new_message_fatal(
+        task_zmq_ctx_test1.task_id, TEST_MESSAGE);
+    send_msg_to_task(&task_zmq_ctx_test1, TASK_TEST_2, test_message_p);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(3500));
+
+  itti_task_stats_read_t task_after = {};
+  ASSERT_TRUE(itti_stats_read_task(TASK_TEST_2, &task_after));
+  EXPECT_EQ(task_after.enqueued - task_before.enqueued, 2);
+  EXPECT_EQ(task_after.dequeued - task_before.dequeued, 2);
+  EXPECT_EQ(task_after.enqueued, task_after.dequeued);
+  EXPECT_GE(task_after.slowest_handler_us, 1500000);
+
+  itti_msg_stats_t msg_after = {};
+  ASSERT_TRUE(itti_stats_read_message(TASK_TEST_2, TEST_MESSAGE, &msg_after));
+  EXPECT_EQ(msg_after.queue_wait.count - msg_before.queue_wait.count, 2);
+  EXPECT_EQ(msg_after.handler.count - msg_before.handler.count, 2);
+  EXPECT_GE(msg_after.queue_wait.max_us, 1000000);
+  EXPECT_GE(msg_after.handler.max_us, 1500000);
+  EXPECT_FALSE(itti_stats_read_message(TASK_TEST_1, TEST_MESSAGE, &msg_after));
+}
+
 class ITTIApiTest : public ::testing::Test {
   virtual void SetUp() {
     itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
@@ -234,6 +266,23 @@ TEST_F(ITTIApiTest, TestHandoverRequest) {
   free(message_p);
 }
 
+TEST_F(ITTIApiTest, TestHistogramPercentile) {
+  itti_histogram_t histogram = {};
+  EXPECT_EQ(itti_histogram_percentile(&histogram, 0.5), 0);
+
+  // 90 observations under 10 us, 9 under 1 ms and one of 3 s
+  histogram.buckets[0] = 90;
+  histogram.buckets[6] = 9;
+  histogram.buckets[ITTI_STATS_BUCKETS - 1] = 1;
+  histogram.count = 100;
+  histogram.max_us = 3000000;
+  EXPECT_EQ(itti_histogram_percentile(&histogram, 0.5), 10);
+  EXPECT_EQ(itti_histogram_percentile(&histogram, 0.9), 10);
+  EXPECT_EQ(itti_histogram_percentile(&histogram, 0.91), 1000);
+  EXPECT_EQ(itti_histogram_percentile(&histogram, 0.95), 1000);
+  EXPECT_EQ(itti_histogram_percentile(&histogram, 0.999), 3000000);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,216 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/security_types.h"
+#include "lte/gateway/c/core/oai/lib/secu/secu_defs.h"
+}
+
+namespace {
+
+std::string bytes(const char* hex) {
+  std::string result;
+  for (size_t i = 0; hex[i] && hex[i + 1]; i += 2) {
+    result.push_back(
+        static_cast<char>(std::stoi(std::string(hex + i, 2), nullptr, 16)));
+  }
+  return result;
+}
+
+const uint8_t* data(const std::string& s) {
+  return reinterpret_cast<const uint8_t*>(s.data());
+}
+
+std::string str(const uint8_t* buf, size_t len) {
+  return std::string(reinterpret_cast<const char*>(buf), len);
+}
+
+struct TestSet {
+  const char* k;
+  const char* rand;
+  const char* sqn;
+  const char* amf;
+  const char* op;
+  const char* opc;
+  const char* f1;
+  const char* f1_star;
+  const char* f2;
+  const char* f5;
+  const char* f3;
+  const char* f4;
+  const char* f5_star;
+};
+
+// Test sets 1 to 6 of TS 35.208 section 4.3
+const TestSet TEST_SETS[] = {
+    {"465b5ce8b199b49faa5f0a2ee238a6bc", "23553cbe9637a89d218ae64dae47bf35",
+     "ff9bb4d0b607", "b9b9", "cdc202d5123e20f62b6d676ac72cb318",
+     "cd63cb71954a9f4e48a5994e37a02baf", "4a9ffac354dfafb3",
+     "01cfaf9ec4e871e9", "a54211d5e3ba50bf", "aa689c648370",
+     "b40ba9a3c58b2a05bbf0d987b21bf8cb", "f769bcd751044604127672711c6d3441",
+     "451e8beca43b"},
+    {"0396eb317b6d1c36f19c1c84cd6ffd16", "c00d603103dcee52c4478119494202e8",
+     "fd8eef40df7d", "af17", "ff53bade17df5d4e793073ce9d7579fa",
+     "53c15671c60a4b731c55b4a441c0bde2", "5df5b31807e258b0",
+     "a8c016e51ef4a343", "d3a628ed988620f0", "c47783995f72",
+     "58c433ff7a7082acd424220f2b67c556", "21a8c1f929702adb3e738488b9f5c5da",
+     "30f1197061c1"},
+    {"fec86ba6eb707ed08905757b1bb44b8f", "9f7c8d021accf4db213ccff0c7f71a6a",
+     "9d0277595ffc", "725c", "dbc59adcb6f9a0ef735477b7fadf8374",
+     "1006020f0a478bf6b699f15c062e42b3", "9cabc3e99baf7281",
+     "95814ba2b3044324", "8011c48c0c214ed2", "33484dc2136b",
+     "5dbdbb2954e8f3cde665b046179a5098", "59a92d3b476a0443487055cf88b2307b",
+     "deacdd848cc6"},
+    {"9e5944aea94b81165c82fbf9f32db751", "ce83dbc54ac0274a157c17f80d017bd6",
+     "0b604a81eca8", "9e09", "223014c5806694c007ca1eeef57f004f",
+     "a64a507ae1a2a98bb88eb4210135dc87", "74a58220cba84c49",
+     "ac2cc74a96871837", "f365cd683cd92e96", "f0b9c08ad02e",
+     "e203edb3971574f5a94b0d61b816345d", "0c4524adeac041c4dd830d20854fc46b",
+     "6085a86c6f63"},
+    {"4ab1deb05ca6ceb051fc98e77d026a84", "74b0cd6031a1c8339b2b6ce2b8c4a186",
+     "e880a1b580b6", "9f07", "2d16c5cd1fdf6b22383584e3bef2a8d8",
+     "dcf07cbd51855290b92a07a9891e523e", "49e785dd12626ef2",
+     "9e85790336bb3fa2", "5860fc1bce351e7e", "31e11a609118",
+     "7657766b373d1c2138f307e3de9242f9", "1c42e960d89b8fa99f2744e0708ccb53",
+     "fe2555e54aa9"},
+    {"6c38a116ac280c454f59332ee35c8c4f", "ee6466bc96202c5a557abbeff8babf63",
+     "414b98222181", "4464", "1ba00a1a7c6700ac8c3ff3e96ad08725",
+     "3803ef5363b947c6aaa225e58fae3934", "078adfb488241a57",
+     "80246b8d0186bcf1", "16c8233f05a0ac28", "45b0f69ab06c",
+     "3f8c7587fe8e4b233af676aede30ba3b", "a7466cc1e6b2a1337d49d3b66e95d7b4",
+     "1f53cd2b1113"},
+};
+
+}  // namespace
+
+TEST(MilenageTest, test_3gpp_test_sets) {
+  for (const auto& set : TEST_SETS) {
+    SCOPED_TRACE(set.k);
+    std::string k = bytes(set.k);
+    std::string rand = bytes(set.rand);
+    std::string sqn = bytes(set.sqn);
+    std::string amf = bytes(set.amf);
+    uint8_t opc[16];
+    uint8_t mac_a[MAC_LENGTH_OCTETS];
+    uint8_t mac_s[MAC_LENGTH_OCTETS];
+    uint8_t res[MILENAGE_RES_LENGTH_OCTETS];
+    uint8_t ck[16];
+    uint8_t ik[16];
+    uint8_t ak[AK_LENGTH_OCTETS];
+    uint8_t ak_star[AK_LENGTH_OCTETS];
+
+    milenage_opc(data(k), data(bytes(set.op)), opc);
+    EXPECT_EQ(str(opc, sizeof(opc)), bytes(set.opc));
+    milenage_f1(data(k), opc, data(rand), data(sqn), data(amf), mac_a, mac_s);
+    EXPECT_EQ(str(mac_a, sizeof(mac_a)), bytes(set.f1));
+    EXPECT_EQ(str(mac_s, sizeof(mac_s)), bytes(set.f1_star));
+    milenage_f2345(data(k), opc, data(rand), res, ck, ik, ak, ak_star);
+    EXPECT_EQ(str(res, sizeof(res)), bytes(set.f2));
+    EXPECT_EQ(str(ck, sizeof(ck)), bytes(set.f3));
+    EXPECT_EQ(str(ik, sizeof(ik)), bytes(set.f4));
+    EXPECT_EQ(str(ak, sizeof(ak)), bytes(set.f5));
+    EXPECT_EQ(str(ak_star, sizeof(ak_star)), bytes(set.f5_star));
+  }
+}
+
+// Vector generated by OAI, also checked by the subscriberdb Milenage tests
+TEST(MilenageTest, test_eutran_vector) {
+  std::string k = bytes("8baf473f2f8fd09487cccbd7097c6862");
+  std::string op = bytes("11111111111111111111111111111111");
+  std::string rand = bytes("000102030405060708090a0b0c0d0e0f");
+  std::string amf = bytes("8000");
+  // SEQ 7351
+  std::string sqn = bytes("000000001cb7");
+  std::string plmn = bytes("02f859");
+  uint8_t opc[16];
+  eutran_vector_t vector = {};
+
+  milenage_opc(data(k), data(op), opc);
+  EXPECT_EQ(str(opc, sizeof(opc)), bytes("8e27b6af0e692e750f32667a3b14605d"));
+  EXPECT_EQ(milenage_generate_eutran_vector(data(k), opc, data(amf), data(sqn),
+                                            data(plmn), data(rand), &vector),
+            0);
+  EXPECT_EQ(str(vector.rand, RAND_LENGTH_OCTETS), rand);
+  EXPECT_EQ(str(vector.xres.data, vector.xres.size),
+            bytes("2daf873d73f310c6"));
+  EXPECT_EQ(str(vector.autn, AUTN_LENGTH_OCTETS),
+            bytes("6fbfa3801f5780007bde59886e96e4fe"));
+  EXPECT_EQ(str(vector.kasme, KASME_LENGTH_OCTETS),
+            bytes("8748c1c0a2826fa405b1e27ea104434ae556c765e8f061ebdb8ae286c44"
+                  "616c2"));
+}
+
+TEST(MilenageTest, test_resync) {
+  std::string k = bytes("8baf473f2f8fd09487cccbd7097c6862");
+  std::string opc = bytes("8e27b6af0e692e750f32667a3b14605d");
+  std::string rand = bytes("cd14a753977fbc718e62bddb535d88f8");
+  std::string sqn_ms = bytes("0000000a4be0");
+  const uint8_t amf_star[AMF_LENGTH_OCTETS] = {0x00, 0x00};
+  uint8_t ak_star[AK_LENGTH_OCTETS];
+  uint8_t auts[AUTS_LENGTH_OCTETS];
+  uint8_t sqn[SQN_LENGTH_OCTETS];
+
+  // AUTS = SQN_MS XOR AK* || MAC-S, as the USIM computes it
+  milenage_f2345(data(k), data(opc), data(rand), NULL, NULL, NULL, NULL,
+                 ak_star);
+  for (int i = 0; i < SQN_LENGTH_OCTETS; i++) {
+    auts[i] = sqn_ms[i] ^ ak_star[i];
+  }
+  milenage_f1(data(k), data(opc), data(rand), data(sqn_ms), amf_star, NULL,
+              auts + SQN_LENGTH_OCTETS);
+  EXPECT_EQ(milenage_resync_sqn(data(k), data(opc), data(rand), auts, sqn), 0);
+  EXPECT_EQ(str(sqn, sizeof(sqn)), sqn_ms);
+
+  // Subscriberdb Milenage test, SQN_MS 0
+  milenage_f1(data(k), data(opc), data(rand), data(bytes("000000000000")),
+              amf_star, NULL, auts + SQN_LENGTH_OCTETS);
+  EXPECT_EQ(str(auts + SQN_LENGTH_OCTETS, MAC_LENGTH_OCTETS),
+            bytes("db5f6360591f34ea"));
+
+  // MAC-S mismatch
+  auts[AUTS_LENGTH_OCTETS - 1] ^= 0x01;
+  EXPECT_EQ(milenage_resync_sqn(data(k), data(opc), data(rand), auts, sqn),
+            -1);
+}
+
+// Prints the vectors generated per second on one core, the S6a task
+// generates them on a single thread
+TEST(MilenageTest, test_eutran_vector_throughput) {
+  const int iterations = 100000;
+  std::string k = bytes("465b5ce8b199b49faa5f0a2ee238a6bc");
+  std::string opc = bytes("cd63cb71954a9f4e48a5994e37a02baf");
+  std::string rand = bytes("23553cbe9637a89d218ae64dae47bf35");
+  std::string amf = bytes("8000");
+  std::string plmn = bytes("02f859");
+  uint8_t sqn[SQN_LENGTH_OCTETS] = {0};
+  eutran_vector_t vector = {};
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    sqn[SQN_LENGTH_OCTETS - 1] = i & 0xff;
+    milenage_generate_eutran_vector(data(k), data(opc), data(amf), sqn,
+                                    data(plmn), data(rand), &vector);
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  double rate = iterations / elapsed.count();
+  std::cout << "E-UTRAN vectors: " << rate << " vectors/s per core"
+            << std::endl;
+  // A floor well below the rate of a single core
+  EXPECT_GT(rate, 10000);
+}
@@ -0,0 +1,338 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <unordered_map>
+
+#include "lte/gateway/c/core/oai/lib/3gpp/3gpp_33.401.h"
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_auth_vector_cache.h"
+
+namespace magma {
+namespace lte {
+
+namespace {
+
+constexpr uint32_t kMaxImsis = 100;
+constexpr uint32_t kMaxVectors = 3;
+constexpr uint32_t kLowWatermark = 2;
+constexpr uint32_t kTtlSec = 3600;
+constexpr uint32_t kMaxInFlight = 10;
+constexpr uint32_t kTimeoutSec = 5;
+constexpr imsi64_t kImsi = 1010000000001;
+
+/*
+ * Stands in for the HSS: it keeps an SQN per IMSI, stamps it in the RAND of
+ * the vectors it generates, and answers the prefetch AIRs when told to.
+ */
+class FakeHss {
+ public:
+  std::deque<mme_app_auth_vector_request_t> pending;
+  bool reachable = true;
+
+  eutran_vector_t generate(imsi64_t imsi64) {
+    eutran_vector_t vector;
+    memset(&vector, 0, sizeof(vector));
+    uint32_t sqn = ++sqn_[imsi64];
+    memcpy(vector.rand, &sqn, sizeof(sqn));
+    vector.xres.size = 8;
+    return vector;
+  }
+
+  // Answers the oldest pending prefetch AIR
+  void answer(uint64_t now_sec, bool success = true) {
+    ASSERT_FALSE(pending.empty());
+    mme_app_auth_vector_request_t request = pending.front();
+    pending.pop_front();
+    eutran_vector_t vectors[MAX_EPS_AUTH_VECTORS];
+    uint8_t nb_of_vectors = 0;
+    if (success) {
+      for (; nb_of_vectors < request.nb_of_vectors; nb_of_vectors++) {
+        vectors[nb_of_vectors] = generate(request.imsi64);
+      }
+    }
+    mme_app_auth_vector_cache_prefetch_answer(request.imsi64, request.seq,
+                                              nb_of_vectors, vectors, now_sec);
+  }
+
+  void answer_all(uint64_t now_sec) {
+    while (!pending.empty()) answer(now_sec);
+  }
+
+  uint32_t sqn(imsi64_t imsi64) { return sqn_[imsi64]; }
+
+ private:
+  std::unordered_map<imsi64_t, uint32_t> sqn_;
+};
+
+FakeHss* hss = nullptr;
+
+bool send_to_hss(const mme_app_auth_vector_request_t* request) {
+  if (!hss->reachable) return false;
+  hss->pending.push_back(*request);
+  return true;
+}
+
+uint32_t sqn_of(const eutran_vector_t& vector) {
+  uint32_t sqn;
+  memcpy(&sqn, vector.rand, sizeof(sqn));
+  return sqn;
+}
+
+}  // namespace
+
+class MmeAppAuthVectorCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    hss = &hss_;
+    init(kMaxImsis, kMaxInFlight);
+  }
+  void TearDown() override {
+    mme_app_auth_vector_cache_exit();
+    hss = nullptr;
+  }
+
+  void init(uint32_t max_imsis, uint32_t max_in_flight) {
+    mme_app_auth_vector_cache_config_t config = {0};
+    config.max_imsis = max_imsis;
+    config.max_vectors = kMaxVectors;
+    config.low_watermark = kLowWatermark;
+    config.ttl_sec = kTtlSec;
+    config.max_prefetch_in_flight = max_in_flight;
+    config.prefetch_timeout_sec = kTimeoutSec;
+    config.request_cb = send_to_hss;
+    mme_app_auth_vector_cache_init(&config);
+  }
+
+  // A UE of imsi64 authenticated with a vector the HSS sent for it
+  uint32_t authenticate_over_s6a(imsi64_t imsi64) {
+    eutran_vector_t vector = hss_.generate(imsi64);
+    plmn_t plmn = {0};
+    mme_app_auth_vector_cache_fresh_vectors(imsi64, 15, &plmn, now_);
+    return sqn_of(vector);
+  }
+
+  // Reports the SQN of the vector taken from the cache, 0 on a miss
+  uint32_t take(imsi64_t imsi64) {
+    eutran_vector_t vector;
+    if (!mme_app_auth_vector_cache_take(imsi64, now_, &vector)) return 0;
+    return sqn_of(vector);
+  }
+
+  FakeHss hss_;
+  uint64_t now_ = 1000;
+};
+
+TEST_F(MmeAppAuthVectorCacheTest, TestReattachIsServedFromPrefetchedStock) {
+  EXPECT_EQ(take(kImsi), 0u);
+  uint32_t used_sqn = authenticate_over_s6a(kImsi);
+
+  // One prefetch AIR at a time, each answer triggers the next one
+  for (uint32_t i = 0; i < kMaxVectors; i++) {
+    ASSERT_EQ(hss_.pending.size(), 1u);
+    EXPECT_EQ(hss_.pending.front().imsi64, kImsi);
+    EXPECT_EQ(hss_.pending.front().imsi_length, 15);
+    hss_.answer(now_);
+  }
+  EXPECT_TRUE(hss_.pending.empty());
+  EXPECT_EQ(mme_app_auth_vector_cache_stock(kImsi, now_), kMaxVectors);
+
+  // Vectors are handed out once each, oldest SQN first, and all of them
+  // are newer than the one the UE already used
+  uint32_t first = take(kImsi);
+  EXPECT_EQ(first, used_sqn + 1);
+  EXPECT_EQ(take(kImsi), used_sqn + 2);
+  // Below the low watermark a refill is under way
+  EXPECT_EQ(hss_.pending.size(), 1u);
+  EXPECT_EQ(take(kImsi), used_sqn + 3);
+  EXPECT_EQ(take(kImsi), 0u);
+  hss_.answer(now_);
+  EXPECT_EQ(take(kImsi), used_sqn + 4);
+}
+
+TEST_F(MmeAppAuthVectorCacheTest, TestResyncDropsStockAndAnswerInFlight) {
+  authenticate_over_s6a(kImsi);
+  hss_.answer(now_);
+  ASSERT_EQ(hss_.pending.size(), 1u);
+  // The USIM reports an SQN failure while the second prefetch is in flight
+  mme_app_auth_vector_cache_flush(kImsi);
+  EXPECT_EQ(mme_app_auth_vector_cache_stock(kImsi, now_), 0u);
+  hss_.answer(now_);
+  EXPECT_EQ(mme_app_auth_vector_cache_stock(kImsi, now_), 0u);
+
+  // The refill starts over after the dropped answer
+  ASSERT_EQ(hss_.pending.size(), 1u);
+  uint32_t sqn_before = hss_.sqn(kImsi);
+  hss_.answer(now_);
+  EXPECT_EQ(take(kImsi), sqn_before + 1);
+}
+
+TEST_F(MmeAppAuthVectorCacheTest, TestFreshVectorsMakeStockStale) {
+  authenticate_over_s6a(kImsi);
+  hss_.answer_all(now_);
+  ASSERT_EQ(mme_app_auth_vector_cache_stock(kImsi, now_), kMaxVectors);
+
+  // Another MME path fetched a vector for the UE, the stock is older
+  uint32_t used_sqn = authenticate_over_s6a(kImsi);
+  EXPECT_EQ(mme_app_auth_vector_cache_stock(kImsi, now_), 0u);
+  hss_.answer(now_);
+  EXPECT_GT(take(kImsi), used_sqn);
+}
+
+TEST_F(MmeAppAuthVectorCacheTest, TestVectorsExpire) {
+  authenticate_over_s6a(kImsi);
+  hss_.answer(now_);
+  now_ += kTtlSec / 2;
+  hss_.answer(now_);
+  hss_.answer(now_);
+  now_ += kTtlSec / 2;
+  EXPECT_EQ(mme_app_auth_vector_cache_stock(kImsi, now_), 2u);
+  now_ += kTtlSec / 2;
+  EXPECT_EQ(take(kImsi), 0u);
+}
+
+TEST_F(MmeAppAuthVectorCacheTest, TestLeastRecentlyUsedImsiIsEvicted) {
+  init(2, kMaxInFlight);
+  authenticate_over_s6a(1);
+  authenticate_over_s6a(2);
+  hss_.answer_all(now_);
+  // IMSI 1 was used last, IMSI 2 makes room for IMSI 3
+  EXPECT_NE(take(1), 0u);
+  authenticate_over_s6a(3);
+  hss_.answer_all(now_);
+  EXPECT_EQ(mme_app_auth_vector_cache_stock(2, now_), 0u);
+  EXPECT_GT(mme_app_auth_vector_cache_stock(1, now_), 0u);
+  EXPECT_GT(mme_app_auth_vector_cache_stock(3, now_), 0u);
+
+  mme_app_auth_vector_cache_stats_t stats;
+  mme_app_auth_vector_cache_get_stats(&stats);
+  EXPECT_EQ(stats.imsis, 2u);
+}
+
+TEST_F(MmeAppAuthVectorCacheTest, TestPrefetchesAreBoundedAndTimeOut) {
+  init(kMaxImsis, 2);
+  for (imsi64_t imsi64 = 1; imsi64 <= 5; imsi64++) {
+    authenticate_over_s6a(imsi64);
+  }
+  EXPECT_EQ(hss_.pending.size(), 2u);
+  mme_app_auth_vector_cache_stats_t stats;
+  mme_app_auth_vector_cache_get_stats(&stats);
+  EXPECT_EQ(stats.prefetch_in_flight, 2u);
+  EXPECT_EQ(stats.prefetch_waiting, 3u);
+
+  // The HSS loses both AIRs, they time out and the next IMSIs go
+  hss_.pending.clear();
+  now_ += kTimeoutSec - 1;
+  mme_app_auth_vector_cache_tick(now_);
+  EXPECT_TRUE(hss_.pending.empty());
+  now_ += 1;
+  mme_app_auth_vector_cache_tick(now_);
+  ASSERT_EQ(hss_.pending.size(), 2u);
+  EXPECT_EQ(hss_.pending[0].imsi64, 3u);
+  EXPECT_EQ(hss_.pending[1].imsi64, 4u);
+
+  // A lost AIR answered late is not mistaken for a newer one
+  mme_app_auth_vector_cache_prefetch_answer(1, 1, 0, nullptr, now_);
+  mme_app_auth_vector_cache_get_stats(&stats);
+  EXPECT_EQ(stats.prefetch_in_flight, 2u);
+}
+
+TEST_F(MmeAppAuthVectorCacheTest, TestLateAnswerAfterTimeoutIsDropped) {
+  authenticate_over_s6a(kImsi);
+  ASSERT_EQ(hss_.pending.size(), 1u);
+  mme_app_auth_vector_request_t lost = hss_.pending.front();
+  hss_.pending.clear();
+  now_ += kTimeoutSec;
+  mme_app_auth_vector_cache_tick(now_);
+
+  // The UE authenticates again and a new prefetch goes out before the HSS
+  // answers the lost one, with vectors older than the UE has seen
+  eutran_vector_t stale = hss_.generate(kImsi);
+  uint32_t used_sqn = authenticate_over_s6a(kImsi);
+  ASSERT_EQ(hss_.pending.size(), 1u);
+  mme_app_auth_vector_cache_prefetch_answer(kImsi, lost.seq, 1, &stale, now_);
+  EXPECT_EQ(mme_app_auth_vector_cache_stock(kImsi, now_), 0u);
+  mme_app_auth_vector_cache_stats_t stats;
+  mme_app_auth_vector_cache_get_stats(&stats);
+  EXPECT_EQ(stats.prefetch_in_flight, 1u);
+
+  hss_.answer(now_);
+  EXPECT_GT(take(kImsi), used_sqn);
+}
+
+TEST_F(MmeAppAuthVectorCacheTest, TestLateAnswerAfterEvictionIsDropped) {
+  init(1, kMaxInFlight);
+  authenticate_over_s6a(1);
+  // IMSI 1 is evicted and comes back with a new prefetch while the first
+  // one is still in flight
+  authenticate_over_s6a(2);
+  uint32_t used_sqn = authenticate_over_s6a(1);
+  ASSERT_EQ(hss_.pending.size(), 3u);
+  hss_.answer(now_);
+  hss_.answer(now_);
+  EXPECT_EQ(mme_app_auth_vector_cache_stock(1, now_), 0u);
+  mme_app_auth_vector_cache_stats_t stats;
+  mme_app_auth_vector_cache_get_stats(&stats);
+  EXPECT_EQ(stats.prefetch_in_flight, 1u);
+
+  hss_.answer(now_);
+  EXPECT_EQ(mme_app_auth_vector_cache_stock(1, now_), 1u);
+  EXPECT_GT(take(1), used_sqn);
+}
+
+TEST_F(MmeAppAuthVectorCacheTest, TestFailuresAreNotRetried) {
+  authenticate_over_s6a(kImsi);
+  hss_.answer(now_, false);
+  EXPECT_TRUE(hss_.pending.empty());
+  EXPECT_EQ(take(kImsi), 0u);
+
+  hss_.reachable = false;
+  authenticate_over_s6a(kImsi);
+  mme_app_auth_vector_cache_stats_t stats;
+  mme_app_auth_vector_cache_get_stats(&stats);
+  EXPECT_EQ(stats.prefetch_in_flight, 0u);
+}
+
+TEST_F(MmeAppAuthVectorCacheTest, TestAttachStormAfterPowerCycle) {
+  constexpr imsi64_t kNumUes = kMaxImsis;
+  init(kMaxImsis, kMaxInFlight);
+  for (imsi64_t imsi64 = 1; imsi64 <= kNumUes; imsi64++) {
+    authenticate_over_s6a(imsi64);
+  }
+  // Background refill at kMaxInFlight AIRs at a time
+  while (!hss_.pending.empty()) {
+    EXPECT_LE(hss_.pending.size(), kMaxInFlight);
+    hss_.answer(now_);
+  }
+
+  // The site comes back and every UE attaches again
+  now_ += 60;
+  uint32_t hits = 0;
+  for (imsi64_t imsi64 = 1; imsi64 <= kNumUes; imsi64++) {
+    if (take(imsi64)) hits++;
+  }
+  EXPECT_EQ(hits, kNumUes);
+}
+
+TEST_F(MmeAppAuthVectorCacheTest, TestDisabledCacheStaysOutOfTheWay) {
+  init(0, kMaxInFlight);
+  authenticate_over_s6a(kImsi);
+  EXPECT_TRUE(hss_.pending.empty());
+  EXPECT_EQ(take(kImsi), 0u);
+}
+
+}  // namespace lte
+}  // namespace magma
@@ -0,0 +1,234 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_bulk_release.h"
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_enb_ue_index.h"
+
+namespace magma {
+namespace lte {
+
+namespace {
+
+constexpr uint32_t kOpsPerSec = 500;
+constexpr uint32_t kTickMs = 100;
+
+std::vector<mme_app_bulk_item_t> dispatched;
+// UEs whose context is gone by the time their turn comes
+std::unordered_set<mme_ue_s1ap_id_t> stale_ues;
+
+bool record_dispatch(const mme_app_bulk_item_t* item) {
+  if (stale_ues.count(item->mme_ue_s1ap_id)) return false;
+  dispatched.push_back(*item);
+  return true;
+}
+
+bool collect_ue(mme_ue_s1ap_id_t ue_id, void* arg) {
+  static_cast<std::vector<mme_ue_s1ap_id_t>*>(arg)->push_back(ue_id);
+  return false;
+}
+
+bool remove_ue(mme_ue_s1ap_id_t ue_id, void* arg) {
+  mme_app_enb_ue_index_remove(ue_id);
+  return false;
+}
+
+bool stop_at_first(mme_ue_s1ap_id_t ue_id, void* arg) { return true; }
+
+std::vector<mme_ue_s1ap_id_t> enb_ues(uint32_t enb_id) {
+  std::vector<mme_ue_s1ap_id_t> ue_ids;
+  EXPECT_EQ(mme_app_enb_ue_index_foreach(enb_id, collect_ue, &ue_ids),
+            mme_app_enb_ue_index_num_ues(enb_id));
+  std::sort(ue_ids.begin(), ue_ids.end());
+  return ue_ids;
+}
+
+mme_app_bulk_item_t make_item(uint32_t enb_id, mme_ue_s1ap_id_t ue_id) {
+  mme_app_bulk_item_t item = {0};
+  item.enb_id = enb_id;
+  item.mme_ue_s1ap_id = ue_id;
+  item.enb_ue_s1ap_id = ue_id;
+  item.op = ue_id % 2 ? MME_APP_BULK_OP_RELEASE : MME_APP_BULK_OP_PAGE;
+  item.cause = ue_id % 2 ? S1AP_NAS_MME_OFFLOADING
+                         : S1AP_NAS_MME_PENDING_OFFLOADING;
+  return item;
+}
+
+bool enqueue(uint32_t enb_id, mme_ue_s1ap_id_t ue_id) {
+  mme_app_bulk_item_t item = make_item(enb_id, ue_id);
+  return mme_app_bulk_release_enqueue(&item);
+}
+
+}  // namespace
+
+class MmeAppEnbUeIndexTest : public ::testing::Test {
+ protected:
+  void SetUp() override { mme_app_enb_ue_index_clear(); }
+  void TearDown() override { mme_app_enb_ue_index_clear(); }
+};
+
+TEST_F(MmeAppEnbUeIndexTest, TestUesFollowTheirEnb) {
+  mme_app_enb_ue_index_update(1, 10);
+  mme_app_enb_ue_index_update(2, 10);
+  mme_app_enb_ue_index_update(3, 20);
+  EXPECT_EQ(enb_ues(10), std::vector<mme_ue_s1ap_id_t>({1, 2}));
+  EXPECT_EQ(enb_ues(20), std::vector<mme_ue_s1ap_id_t>({3}));
+
+  // Handover of UE 2 to eNB 20
+  mme_app_enb_ue_index_update(2, 20);
+  EXPECT_EQ(enb_ues(10), std::vector<mme_ue_s1ap_id_t>({1}));
+  EXPECT_EQ(enb_ues(20), std::vector<mme_ue_s1ap_id_t>({2, 3}));
+
+  mme_app_enb_ue_index_rename(3, 30);
+  EXPECT_EQ(enb_ues(20), std::vector<mme_ue_s1ap_id_t>({2, 30}));
+
+  mme_app_enb_ue_index_remove(1);
+  EXPECT_TRUE(enb_ues(10).empty());
+  EXPECT_EQ(mme_app_enb_ue_index_num_ues(10), 0u);
+  mme_app_enb_ue_index_update(INVALID_MME_UE_S1AP_ID, 10);
+  EXPECT_EQ(mme_app_enb_ue_index_num_ues(10), 0u);
+}
+
+TEST_F(MmeAppEnbUeIndexTest, TestForeachToleratesRemovalAndStops) {
+  for (mme_ue_s1ap_id_t ue_id = 1; ue_id <= 100; ue_id++) {
+    mme_app_enb_ue_index_update(ue_id, 1);
+  }
+  EXPECT_EQ(mme_app_enb_ue_index_foreach(1, stop_at_first, nullptr), 1u);
+  // Releasing the UEs of the eNB removes them from the index on the way
+  EXPECT_EQ(mme_app_enb_ue_index_foreach(1, remove_ue, nullptr), 100u);
+  EXPECT_EQ(mme_app_enb_ue_index_num_ues(1), 0u);
+}
+
+class MmeAppBulkReleaseTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dispatched.clear();
+    stale_ues.clear();
+    init(kOpsPerSec);
+  }
+  void TearDown() override { mme_app_bulk_release_exit(); }
+
+  void init(uint32_t ops_per_sec) {
+    mme_app_bulk_release_config_t config = {0};
+    config.ops_per_sec = ops_per_sec;
+    config.tick_ms = kTickMs;
+    config.dispatch_cb = record_dispatch;
+    mme_app_bulk_release_init(&config);
+  }
+};
+
+TEST_F(MmeAppBulkReleaseTest, TestTenThousandUeEnbIsPaced) {
+  constexpr uint32_t kNumUes = 10000;
+  constexpr uint32_t kPerTick = kOpsPerSec * kTickMs / 1000;
+  for (mme_ue_s1ap_id_t ue_id = 1; ue_id <= kNumUes; ue_id++) {
+    mme_app_enb_ue_index_update(ue_id, 1);
+    mme_app_enb_ue_index_update(kNumUes + ue_id, 2);
+  }
+  std::vector<mme_ue_s1ap_id_t> ue_ids = enb_ues(1);
+  for (mme_ue_s1ap_id_t ue_id : ue_ids) {
+    EXPECT_TRUE(enqueue(1, ue_id));
+  }
+  // Nothing goes out from the handler itself
+  EXPECT_TRUE(dispatched.empty());
+  EXPECT_EQ(mme_app_bulk_release_pending(), kNumUes);
+
+  uint32_t num_ticks = 0;
+  while (mme_app_bulk_release_pending() > 0) {
+    EXPECT_EQ(mme_app_bulk_release_tick(), kPerTick);
+    num_ticks++;
+    if (num_ticks == 10) {
+      mme_app_bulk_progress_t progress;
+      ASSERT_TRUE(mme_app_bulk_release_get_progress(1, &progress));
+      EXPECT_EQ(progress.queued, kNumUes);
+      EXPECT_EQ(progress.dispatched, 10 * kPerTick);
+    }
+  }
+  EXPECT_EQ(num_ticks, kNumUes / kPerTick);
+  EXPECT_EQ(dispatched.size(), kNumUes);
+  // The UEs of the other eNB are untouched and progress is gone once done
+  for (const mme_app_bulk_item_t& item : dispatched) {
+    EXPECT_EQ(item.enb_id, 1u);
+  }
+  mme_app_bulk_progress_t progress;
+  EXPECT_FALSE(mme_app_bulk_release_get_progress(1, &progress));
+  mme_app_enb_ue_index_clear();
+}
+
+TEST_F(MmeAppBulkReleaseTest, TestFractionalRateIsCarriedOver) {
+  // 15 per second is 1.5 per 100 ms tick
+  init(15);
+  for (mme_ue_s1ap_id_t ue_id = 1; ue_id <= 30; ue_id++) {
+    enqueue(1, ue_id);
+  }
+  std::vector<uint32_t> per_tick;
+  for (int tick = 0; tick < 10; tick++) {
+    per_tick.push_back(mme_app_bulk_release_tick());
+  }
+  EXPECT_EQ(per_tick,
+            std::vector<uint32_t>({1, 2, 1, 2, 1, 2, 1, 2, 1, 2}));
+  EXPECT_EQ(mme_app_bulk_release_pending(), 15u);
+}
+
+TEST_F(MmeAppBulkReleaseTest, TestIdleEngineDoesNotBurst) {
+  for (int tick = 0; tick < 100; tick++) {
+    EXPECT_EQ(mme_app_bulk_release_tick(), 0u);
+  }
+  for (mme_ue_s1ap_id_t ue_id = 1; ue_id <= 1000; ue_id++) {
+    enqueue(1, ue_id);
+  }
+  EXPECT_EQ(mme_app_bulk_release_tick(), kOpsPerSec * kTickMs / 1000);
+}
+
+TEST_F(MmeAppBulkReleaseTest, TestDuplicatesCancelAndStaleUes) {
+  for (mme_ue_s1ap_id_t ue_id = 1; ue_id <= 100; ue_id++) {
+    EXPECT_TRUE(enqueue(1, ue_id));
+    EXPECT_TRUE(enqueue(2, 100 + ue_id));
+  }
+  // A UE is queued once, whichever request comes second
+  EXPECT_FALSE(enqueue(2, 1));
+  EXPECT_EQ(mme_app_bulk_release_pending(), 200u);
+
+  // Items are dispatched in FIFO order, half of them for each eNB
+  EXPECT_EQ(mme_app_bulk_release_tick(), 50u);
+  EXPECT_EQ(mme_app_bulk_release_cancel(1), 75u);
+  EXPECT_EQ(mme_app_bulk_release_cancel(1), 0u);
+  EXPECT_EQ(mme_app_bulk_release_pending(), 75u);
+  // Cancelled UEs can be queued again
+  EXPECT_TRUE(enqueue(3, 100));
+
+  for (mme_ue_s1ap_id_t ue_id = 150; ue_id <= 200; ue_id++) {
+    stale_ues.insert(ue_id);
+  }
+  dispatched.clear();
+  EXPECT_EQ(mme_app_bulk_release_tick(), 50u);
+  mme_app_bulk_progress_t progress;
+  ASSERT_TRUE(mme_app_bulk_release_get_progress(2, &progress));
+  EXPECT_EQ(progress.queued, 100u);
+  EXPECT_EQ(progress.dispatched + progress.skipped, 75u);
+  EXPECT_EQ(progress.skipped, 26u);
+  EXPECT_EQ(dispatched.size(), 24u);
+
+  EXPECT_EQ(mme_app_bulk_release_tick(), 26u);
+  EXPECT_EQ(mme_app_bulk_release_pending(), 0u);
+  EXPECT_EQ(dispatched.back().enb_id, 3u);
+  EXPECT_FALSE(mme_app_bulk_release_get_progress(2, &progress));
+}
+
+}  // namespace lte
+}  // namespace magma
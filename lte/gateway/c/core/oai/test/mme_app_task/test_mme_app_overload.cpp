@@ -0,0 +1,220 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_overload.h"
+
+namespace magma {
+namespace lte {
+
+namespace {
+
+constexpr uint32_t kOriginTask = 5;
+constexpr uint64_t kTargetLatencyUs = 20000;
+// MME_APP cost of an admitted procedure and of a congestion reject
+constexpr uint64_t kAdmitCostUs = 1000;
+constexpr uint64_t kRejectCostUs = 50;
+constexpr int kNumEnbs = 20;
+
+std::vector<std::pair<bool, uint8_t>> notifications;
+
+void record_notification(bool start, uint8_t reduction) {
+  notifications.emplace_back(start, reduction);
+}
+
+struct SimResult {
+  uint64_t admitted[MME_OVERLOAD_PROC_MAX] = {0};
+  uint64_t rejected[MME_OVERLOAD_PROC_MAX] = {0};
+  std::vector<uint64_t> admitted_latency_us;
+  double duration_s = 0;
+
+  uint64_t p99_us() {
+    if (admitted_latency_us.empty()) return 0;
+    std::sort(admitted_latency_us.begin(), admitted_latency_us.end());
+    return admitted_latency_us[admitted_latency_us.size() * 99 / 100];
+  }
+  uint64_t total_admitted() const {
+    uint64_t total = 0;
+    for (auto count : admitted) total += count;
+    return total;
+  }
+};
+
+/*
+ * Single server FIFO model of the MME_APP task. Each procedure is one
+ * message; admission is decided when MME_APP dequeues it, and a reject
+ * costs a fraction of what an admitted procedure does.
+ */
+class OverloadSimulator {
+ public:
+  explicit OverloadSimulator(bool controlled) : controlled_(controlled) {}
+
+  // Offers rate_per_s procedures for duration_s; records the admitted
+  // latencies observed after warmup_s.
+  SimResult run(double rate_per_s, double duration_s, double warmup_s) {
+    SimResult result;
+    uint64_t interval_us = static_cast<uint64_t>(1000000 / rate_per_s);
+    uint64_t end_us = clock_us_ + static_cast<uint64_t>(duration_s * 1000000);
+    uint64_t warmup_end_us =
+        clock_us_ + static_cast<uint64_t>(warmup_s * 1000000);
+    for (; clock_us_ < end_us; clock_us_ += interval_us) {
+      // Deterministic jitter of up to +/-25% around the mean interval
+      seed_ = seed_ * 6364136223846793005ULL + 1442695040888963407ULL;
+      uint64_t jitter = (seed_ >> 33) % (interval_us / 2 + 1);
+      uint64_t arrival_us = clock_us_ + jitter - interval_us / 4;
+
+      uint64_t start_us = std::max(arrival_us, server_free_us_);
+      uint64_t latency_us = start_us - arrival_us;
+      mme_overload_proc_t proc = next_proc();
+      sctp_assoc_id_t assoc_id = 1 + (sequence_++ % kNumEnbs);
+
+      bool admit = true;
+      if (controlled_) {
+        mme_app_overload_observe(kOriginTask, latency_us, start_us);
+        admit = mme_app_overload_admit(assoc_id, proc, start_us);
+      }
+      uint64_t cost_us = admit ? kAdmitCostUs : kRejectCostUs;
+      server_free_us_ = start_us + cost_us;
+      if (admit) {
+        result.admitted[proc]++;
+        if (arrival_us >= warmup_end_us) {
+          result.admitted_latency_us.push_back(latency_us + cost_us);
+        }
+      } else {
+        result.rejected[proc]++;
+      }
+    }
+    result.duration_s = duration_s;
+    return result;
+  }
+
+ private:
+  // 40% attach, 40% service request, 15% TAU and 5% detach
+  mme_overload_proc_t next_proc() {
+    int slot = sequence_ % 20;
+    if (slot < 8) return MME_OVERLOAD_PROC_ATTACH;
+    if (slot < 16) return MME_OVERLOAD_PROC_SERVICE_REQUEST;
+    if (slot < 19) return MME_OVERLOAD_PROC_TAU;
+    return MME_OVERLOAD_PROC_DETACH;
+  }
+
+  bool controlled_;
+  uint64_t clock_us_ = 1000000;
+  uint64_t server_free_us_ = 0;
+  uint64_t sequence_ = 0;
+  uint64_t seed_ = 42;
+};
+
+}  // namespace
+
+class MmeAppOverloadTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    notifications.clear();
+    mme_overload_config_t config = {};
+    config.enabled = true;
+    config.target_latency_us = kTargetLatencyUs;
+    config.target_depth = 1000;
+    config.eval_period_ms = 100;
+    config.max_reduction_percent = 99;
+    config.notify_cb = record_notification;
+    ASSERT_EQ(mme_app_overload_init(&config, 0), RETURNok);
+  }
+
+  void TearDown() override { mme_app_overload_exit(); }
+};
+
+TEST_F(MmeAppOverloadTest, TestNoSheddingUnderCapacity) {
+  OverloadSimulator sim(true);
+  // Half of the MME_APP capacity
+  SimResult result = sim.run(500, 10, 1);
+
+  for (int proc = 0; proc < MME_OVERLOAD_PROC_MAX; proc++) {
+    EXPECT_EQ(result.rejected[proc], 0u);
+  }
+  EXPECT_TRUE(notifications.empty());
+  mme_overload_stats_t stats;
+  mme_app_overload_get_stats(&stats);
+  EXPECT_EQ(stats.traffic_reduction_percent, 0);
+  EXPECT_EQ(stats.nb_enbs, static_cast<uint32_t>(kNumEnbs));
+}
+
+TEST_F(MmeAppOverloadTest, TestUncontrolledOverloadLatencyDiverges) {
+  OverloadSimulator sim(false);
+  SimResult result = sim.run(3000, 10, 2);
+
+  // Without admission control the queue grows for the whole run
+  EXPECT_GT(result.p99_us(), 100 * kTargetLatencyUs);
+}
+
+TEST_F(MmeAppOverloadTest, TestThreeTimesOverloadHoldsP99Latency) {
+  OverloadSimulator sim(true);
+  // Three times what MME_APP can serve
+  SimResult result = sim.run(3000, 20, 5);
+
+  EXPECT_LT(result.p99_us(), 5 * kTargetLatencyUs);
+  // Goodput stays close to capacity once rejects are paid for
+  EXPECT_GT(result.total_admitted() / result.duration_s, 700);
+
+  // Attach is shed before service request and TAU; detach never is
+  EXPECT_GT(result.rejected[MME_OVERLOAD_PROC_ATTACH],
+            result.rejected[MME_OVERLOAD_PROC_SERVICE_REQUEST]);
+  EXPECT_GT(result.rejected[MME_OVERLOAD_PROC_SERVICE_REQUEST],
+            result.rejected[MME_OVERLOAD_PROC_TAU]);
+  EXPECT_EQ(result.rejected[MME_OVERLOAD_PROC_DETACH], 0u);
+
+  ASSERT_FALSE(notifications.empty());
+  EXPECT_TRUE(notifications.front().first);
+  EXPECT_GT(notifications.front().second, 0);
+  mme_overload_stats_t stats;
+  mme_app_overload_get_stats(&stats);
+  EXPECT_GE(stats.traffic_reduction_percent, 50);
+}
+
+TEST_F(MmeAppOverloadTest, TestOverloadStopAfterLoadDrops) {
+  OverloadSimulator sim(true);
+  sim.run(3000, 5, 5);
+  ASSERT_FALSE(notifications.empty());
+  EXPECT_TRUE(notifications.back().first);
+
+  SimResult result = sim.run(300, 20, 10);
+  ASSERT_FALSE(notifications.back().first);
+  EXPECT_EQ(notifications.back().second, 0);
+  mme_overload_stats_t stats;
+  mme_app_overload_get_stats(&stats);
+  EXPECT_EQ(stats.traffic_reduction_percent, 0);
+  EXPECT_LT(result.p99_us(), kTargetLatencyUs);
+}
+
+TEST_F(MmeAppOverloadTest, TestDisabledAdmitsEverything) {
+  mme_app_overload_exit();
+  mme_overload_config_t config = {};
+  config.enabled = false;
+  config.eval_period_ms = 100;
+  ASSERT_EQ(mme_app_overload_init(&config, 0), RETURNok);
+
+  OverloadSimulator sim(true);
+  SimResult result = sim.run(3000, 2, 0);
+  for (int proc = 0; proc < MME_OVERLOAD_PROC_MAX; proc++) {
+    EXPECT_EQ(result.rejected[proc], 0u);
+  }
+  EXPECT_TRUE(notifications.empty());
+}
+
+}  // namespace lte
+}  // namespace magma
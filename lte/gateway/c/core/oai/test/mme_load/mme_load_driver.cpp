@@ -0,0 +1,832 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "lte/gateway/c/core/oai/test/mme_load/mme_load_driver.h"
+
+#include <gmock/gmock.h>
+#include <arpa/inet.h>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+#include "lte/gateway/c/core/oai/test/mock_tasks/mock_tasks.h"
+#include "lte/gateway/c/core/oai/test/mme_app_task/mme_app_test_util.h"
+
+extern "C" {
+#include "lte/gateway/c/core/oai/lib/bstr/bstrlib.h"
+#include "lte/gateway/c/core/oai/include/mme_config.h"
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_extern.h"
+#include "lte/gateway/c/core/oai/tasks/nas/api/network/nas_message.h"
+}
+
+extern bool mme_hss_associated;
+extern bool mme_sctp_bounded;
+
+// Events that complete a procedure
+#define LOAD_EVENT_EMM_INFORMATION 0x01
+#define LOAD_EVENT_MODIFY_BEARER 0x02
+#define LOAD_EVENT_RELEASE_COMMAND 0x04
+#define LOAD_EVENT_TAU_ACCEPT 0x08
+#define LOAD_EVENT_PAGED 0x10
+
+#define LOAD_TICK_MS 1
+#define LOAD_TIMEOUT_CHECK_MS 100
+#define LOAD_PICK_TRIES 64
+#define LOAD_DEFAULT_LBI 5
+#define LOAD_TAC 1
+#define LOAD_IMSI_PREFIX "00101"
+#define LOAD_UE_IPV4_BASE 0x0a800000  // 10.128.0.0
+#define LOAD_SGW_IPV4 0x0a000001      // 10.0.0.1
+
+namespace magma {
+namespace lte {
+
+// Context the driver sends every message to MME_APP on, also used by the
+// mme_app_test_util senders
+task_zmq_ctx_t task_zmq_ctx_main;
+
+// PLMN and TAC of the default MME configuration
+static const plmn_t load_plmn = {.mcc_digit2 = 0,
+                                 .mcc_digit1 = 0,
+                                 .mnc_digit3 = 0x0f,
+                                 .mcc_digit3 = 1,
+                                 .mnc_digit2 = 1,
+                                 .mnc_digit1 = 0};
+
+static MmeLoadDriver* driver_;
+static task_zmq_ctx_t task_zmq_ctx_s1ap_stub;
+static task_zmq_ctx_t task_zmq_ctx_s6a_stub;
+static task_zmq_ctx_t task_zmq_ctx_spgw_stub;
+
+static const char* const procedure_names[LOAD_PROC_MAX] = {
+    "attach", "detach", "service", "paging", "tau", "release"};
+
+const char* load_procedure_name(int proc) {
+  if (proc < 0 || proc >= LOAD_PROC_MAX) {
+    return "unknown";
+  }
+  return procedure_names[proc];
+}
+
+bool parse_procedure_mix(const std::string& mix,
+                         std::array<double, LOAD_PROC_MAX>* weights) {
+  weights->fill(0);
+  double total = 0;
+  std::stringstream ss(mix);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    size_t eq = item.find('=');
+    if (eq == std::string::npos) {
+      return false;
+    }
+    std::string name = item.substr(0, eq);
+    char* end = nullptr;
+    double weight = strtod(item.c_str() + eq + 1, &end);
+    if (end == item.c_str() + eq + 1 || *end != '\0' || weight < 0) {
+      return false;
+    }
+    int proc = 0;
+    while (proc < LOAD_PROC_MAX && name != procedure_names[proc]) {
+      proc++;
+    }
+    if (proc == LOAD_PROC_MAX) {
+      return false;
+    }
+    (*weights)[proc] = weight;
+    total += weight;
+  }
+  return total > 0;
+}
+
+static int handle_main_message(zloop_t* loop, zsock_t* reader, void* arg) {
+  MessageDef* received_message_p = receive_msg(reader);
+  itti_free_msg_content(received_message_p);
+  free(received_message_p);
+  return 0;
+}
+
+static int handle_stub_message(task_zmq_ctx_t* ctx, zsock_t* reader,
+                               void (MmeLoadDriver::*on_message)(MessageDef*)) {
+  MessageDef* received_message_p = receive_msg(reader);
+  if (ITTI_MSG_ID(received_message_p) == TERMINATE_MESSAGE) {
+    itti_free_msg_content(received_message_p);
+    free(received_message_p);
+    destroy_task_context(ctx);
+    pthread_exit(NULL);
+  }
+  (driver_->*on_message)(received_message_p);
+  itti_free_msg_content(received_message_p);
+  free(received_message_p);
+  return 0;
+}
+
+static int handle_s1ap_message(zloop_t* loop, zsock_t* reader, void* arg) {
+  return handle_stub_message(&task_zmq_ctx_s1ap_stub, reader,
+                             &MmeLoadDriver::on_s1ap_message);
+}
+
+static int handle_s6a_message(zloop_t* loop, zsock_t* reader, void* arg) {
+  return handle_stub_message(&task_zmq_ctx_s6a_stub, reader,
+                             &MmeLoadDriver::on_s6a_message);
+}
+
+static int handle_spgw_message(zloop_t* loop, zsock_t* reader, void* arg) {
+  return handle_stub_message(&task_zmq_ctx_spgw_stub, reader,
+                             &MmeLoadDriver::on_spgw_message);
+}
+
+static void start_stub_task(task_id_t task_id, task_zmq_ctx_t* ctx,
+                            zloop_reader_fn* handler) {
+  init_task_context(task_id, nullptr, 0, handler, ctx);
+  zloop_start(ctx->event_loop);
+}
+
+MmeLoadDriver::MmeLoadDriver(const MmeLoadConfig& config)
+    : config_(config),
+      ues_(config.num_ues),
+      next_enb_ue_s1ap_id_(1),
+      in_flight_(0),
+      rng_(std::random_device()()) {
+  if (config_.num_enbs == 0) {
+    config_.num_enbs = 1;
+  }
+  char imsi[IMSI_BCD_DIGITS_MAX + 1];
+  for (uint32_t i = 0; i < ues_.size(); i++) {
+    snprintf(imsi, sizeof(imsi), LOAD_IMSI_PREFIX "%010u", i + 1);
+    ues_[i].imsi = imsi;
+    ues_[i].enb = i % config_.num_enbs;
+    ues_[i].ipv4 = htonl(LOAD_UE_IPV4_BASE + i + 1);
+  }
+}
+
+void MmeLoadDriver::start_tasks() {
+  driver_ = this;
+  mme_hss_associated = false;
+  mme_sctp_bounded = false;
+  itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
+            NULL, NULL);
+
+  mme_config_init(&mme_config);
+  create_partial_lists(&mme_config);
+  mme_config.use_stateless = true;
+  mme_config.max_enbs = config_.num_enbs;
+  mme_config.max_ues = config_.num_ues;
+  mme_config.nas_config.prefered_integrity_algorithm[0] = EIA2_128_ALG_ID;
+  mme_config.nas_config.prefered_ciphering_algorithm[0] = EEA0_ALG_ID;
+
+  task_id_t task_id_list[10] = {
+      TASK_MME_APP,    TASK_HA,  TASK_S1AP,   TASK_S6A,      TASK_S11,
+      TASK_SERVICE303, TASK_SGS, TASK_SGW_S8, TASK_SPGW_APP, TASK_SMS_ORC8R};
+  init_task_context(TASK_MAIN, task_id_list, 10, handle_main_message,
+                    &task_zmq_ctx_main);
+
+  auto service303_handler =
+      std::make_shared<::testing::NiceMock<MockService303Handler>>();
+  auto s8_handler = std::make_shared<::testing::NiceMock<MockS8Handler>>();
+  std::vector<std::thread> tasks;
+  tasks.emplace_back(start_mock_ha_task);
+  tasks.emplace_back(start_mock_s11_task);
+  tasks.emplace_back(start_mock_service303_task, service303_handler);
+  tasks.emplace_back(start_mock_sgs_task);
+  tasks.emplace_back(start_mock_sgw_s8_task, s8_handler);
+  tasks.emplace_back(start_mock_sms_orc8r_task);
+  tasks.emplace_back(start_stub_task, TASK_S1AP, &task_zmq_ctx_s1ap_stub,
+                     handle_s1ap_message);
+  tasks.emplace_back(start_stub_task, TASK_S6A, &task_zmq_ctx_s6a_stub,
+                     handle_s6a_message);
+  tasks.emplace_back(start_stub_task, TASK_SPGW_APP, &task_zmq_ctx_spgw_stub,
+                     handle_spgw_message);
+  for (auto& task : tasks) {
+    task.detach();
+  }
+
+  mme_app_init(&mme_config);
+  send_sctp_mme_server_initialized();
+  std::this_thread::sleep_for(
+      std::chrono::milliseconds(SLEEP_AT_INITIALIZATION_TIME_MS));
+}
+
+void MmeLoadDriver::stop_tasks() {
+  send_terminate_message_fatal(&task_zmq_ctx_main);
+  // Sleep to ensure that messages are received and contexts are released
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  destroy_task_context(&task_zmq_ctx_main);
+  itti_free_desc_threads();
+  driver_ = nullptr;
+}
+
+MmeLoadReport MmeLoadDriver::run() {
+  MmeLoadReport report;
+  start_tasks();
+  report.rss_start_kb = load_rss_kb();
+  run_phase(&report.ramp, true);
+  report.rss_ramp_kb = load_rss_kb();
+  run_phase(&report.mix, false);
+  report.rss_end_kb = load_rss_kb();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& ue : ues_) {
+      report.ues_lost += ue.lost;
+    }
+  }
+  stop_tasks();
+  return report;
+}
+
+void MmeLoadDriver::run_phase(MmeLoadPhaseReport* phase, bool ramp) {
+  auto start = std::chrono::steady_clock::now();
+  auto end = start + std::chrono::seconds(config_.duration_sec);
+  auto next_timeout_check = start;
+  uint64_t started = 0;
+  std::discrete_distribution<int> mix(config_.mix.begin(), config_.mix.end());
+
+  while (true) {
+    auto now = std::chrono::steady_clock::now();
+    if (ramp ? started >= ues_.size() : now >= end) {
+      break;
+    }
+    double elapsed = std::chrono::duration<double>(now - start).count();
+    uint64_t due = static_cast<uint64_t>(config_.rate * elapsed);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (; started < due; started++) {
+        if (ramp) {
+          if (started >= ues_.size()) {
+            break;
+          }
+          LoadUe* ue = &ues_[started];
+          begin(ue, phase, LOAD_PROC_ATTACH,
+                LOAD_EVENT_EMM_INFORMATION | LOAD_EVENT_MODIFY_BEARER);
+          ue->nas = LoadUeNas();
+          new_connection(ue);
+          send_initial_ue_message(ue, load_nas_attach_request(ue->imsi),
+                                  false);
+        } else {
+          start_procedure(phase, mix(rng_));
+        }
+      }
+      if (now >= next_timeout_check) {
+        check_timeouts(now);
+        next_timeout_check =
+            now + std::chrono::milliseconds(LOAD_TIMEOUT_CHECK_MS);
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(LOAD_TICK_MS));
+  }
+  drain(phase);
+  phase->seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+}
+
+void MmeLoadDriver::drain(MmeLoadPhaseReport* phase) {
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      check_timeouts(std::chrono::steady_clock::now());
+      if (in_flight_ == 0) {
+        return;
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(LOAD_TICK_MS));
+  }
+}
+
+LoadUe* MmeLoadDriver::pick_ue(LoadUeState state) {
+  std::uniform_int_distribution<uint32_t> any_ue(0, ues_.size() - 1);
+  for (int i = 0; i < LOAD_PICK_TRIES; i++) {
+    LoadUe* ue = &ues_[any_ue(rng_)];
+    if (ue->state == state && ue->proc == LOAD_PROC_MAX &&
+        !ue->awaiting_release && !ue->lost) {
+      return ue;
+    }
+  }
+  return nullptr;
+}
+
+void MmeLoadDriver::start_procedure(MmeLoadPhaseReport* phase, int proc) {
+  LoadUeState needed = LoadUeState::CONNECTED;
+  if (proc == LOAD_PROC_ATTACH) {
+    needed = LoadUeState::DEREGISTERED;
+  } else if (proc == LOAD_PROC_SERVICE_REQUEST || proc == LOAD_PROC_PAGING) {
+    needed = LoadUeState::IDLE;
+  }
+  LoadUe* ue = pick_ue(needed);
+  if (!ue) {
+    phase->skipped++;
+    return;
+  }
+
+  switch (proc) {
+    case LOAD_PROC_ATTACH: {
+      begin(ue, phase, proc,
+            LOAD_EVENT_EMM_INFORMATION | LOAD_EVENT_MODIFY_BEARER);
+      ue->nas = LoadUeNas();
+      new_connection(ue);
+      send_initial_ue_message(ue, load_nas_attach_request(ue->imsi), false);
+    } break;
+
+    case LOAD_PROC_DETACH: {
+      begin(ue, phase, proc, LOAD_EVENT_RELEASE_COMMAND);
+      send_uplink_nas(ue, ue->nas.protect(LOAD_NAS_SH_INTEGRITY_CIPHERED,
+                                          load_nas_detach_request(ue->guti)));
+    } break;
+
+    case LOAD_PROC_SERVICE_REQUEST: {
+      begin(ue, phase, proc, LOAD_EVENT_MODIFY_BEARER);
+      new_connection(ue);
+      send_initial_ue_message(ue, ue->nas.service_request(), true);
+    } break;
+
+    case LOAD_PROC_PAGING: {
+      begin(ue, phase, proc, LOAD_EVENT_PAGED | LOAD_EVENT_MODIFY_BEARER);
+      send_paging(ue);
+    } break;
+
+    case LOAD_PROC_TAU: {
+      begin(ue, phase, proc, LOAD_EVENT_TAU_ACCEPT);
+      send_uplink_nas(ue, ue->nas.protect(LOAD_NAS_SH_INTEGRITY,
+                                          load_nas_tau_request(ue->guti)));
+    } break;
+
+    case LOAD_PROC_RELEASE: {
+      begin(ue, phase, proc, LOAD_EVENT_RELEASE_COMMAND);
+      send_context_release_request(ue);
+    } break;
+
+    default:
+      break;
+  }
+}
+
+void MmeLoadDriver::check_timeouts(std::chrono::steady_clock::time_point now) {
+  auto timeout = std::chrono::milliseconds(config_.timeout_ms);
+  for (auto& ue : ues_) {
+    if ((ue.proc == LOAD_PROC_MAX && !ue.awaiting_release) || ue.lost ||
+        now - ue.started < timeout) {
+      continue;
+    }
+    if (ue.proc != LOAD_PROC_MAX) {
+      ue.phase->procedures[ue.proc].timed_out++;
+      ue.proc = LOAD_PROC_MAX;
+      in_flight_--;
+    }
+    ue.awaiting_release = false;
+    ue.lost = true;
+  }
+}
+
+void MmeLoadDriver::begin(LoadUe* ue, MmeLoadPhaseReport* phase, int proc,
+                          uint32_t pending) {
+  ue->proc = proc;
+  ue->pending = pending;
+  ue->phase = phase;
+  ue->started = std::chrono::steady_clock::now();
+  phase->procedures[proc].started++;
+  in_flight_++;
+}
+
+void MmeLoadDriver::on_event(LoadUe* ue, uint32_t event) {
+  if (ue->proc == LOAD_PROC_MAX || !(ue->pending & event)) {
+    return;
+  }
+  ue->pending &= ~event;
+  if (event == LOAD_EVENT_PAGED) {
+    new_connection(ue);
+    send_initial_ue_message(ue, ue->nas.service_request(), true);
+  }
+  if (!ue->pending) {
+    complete(ue);
+  }
+}
+
+void MmeLoadDriver::complete(LoadUe* ue) {
+  auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - ue->started);
+  ue->phase->procedures[ue->proc].latency.record(latency.count());
+  switch (ue->proc) {
+    case LOAD_PROC_DETACH:
+      ue->state = LoadUeState::DEREGISTERED;
+      break;
+    case LOAD_PROC_RELEASE:
+      ue->state = LoadUeState::IDLE;
+      break;
+    default:
+      ue->state = LoadUeState::CONNECTED;
+      break;
+  }
+  ue->proc = LOAD_PROC_MAX;
+  in_flight_--;
+}
+
+void MmeLoadDriver::fail(LoadUe* ue) {
+  if (ue->proc == LOAD_PROC_MAX) {
+    return;
+  }
+  ue->phase->procedures[ue->proc].failed++;
+  ue->proc = LOAD_PROC_MAX;
+  in_flight_--;
+}
+
+void MmeLoadDriver::reject(LoadUe* ue) {
+  // The MME releases the connection of a rejected UE, which is implicitly
+  // detached
+  fail(ue);
+  ue->state = LoadUeState::DEREGISTERED;
+  ue->awaiting_release = true;
+  ue->started = std::chrono::steady_clock::now();
+}
+
+void MmeLoadDriver::new_connection(LoadUe* ue) {
+  if (ue->enb_ue_s1ap_id) {
+    ue_of_enb_id_.erase(ue->enb_ue_s1ap_id);
+  }
+  ue->enb_ue_s1ap_id = next_enb_ue_s1ap_id_;
+  ue_of_enb_id_[ue->enb_ue_s1ap_id] = ue - ues_.data();
+  // eNB UE S1AP IDs are 24 bits
+  next_enb_ue_s1ap_id_ = (next_enb_ue_s1ap_id_ % 0xffffff) + 1;
+}
+
+void MmeLoadDriver::send_initial_ue_message(LoadUe* ue,
+                                            const std::vector<uint8_t>& nas,
+                                            bool with_s_tmsi) {
+  MessageDef* message_p =
+      itti_alloc_new_message(TASK_S1AP, S1AP_INITIAL_UE_MESSAGE);
+  ITTI_MSG_LASTHOP_LATENCY(message_p) = 0;
+  S1AP_INITIAL_UE_MESSAGE(message_p).sctp_assoc_id = ue->enb + 1;
+  S1AP_INITIAL_UE_MESSAGE(message_p).enb_ue_s1ap_id = ue->enb_ue_s1ap_id;
+  S1AP_INITIAL_UE_MESSAGE(message_p).enb_id = ue->enb + 1;
+  S1AP_INITIAL_UE_MESSAGE(message_p).nas = blk2bstr(nas.data(), nas.size());
+  S1AP_INITIAL_UE_MESSAGE(message_p).tai.plmn = load_plmn;
+  S1AP_INITIAL_UE_MESSAGE(message_p).tai.tac = LOAD_TAC;
+  S1AP_INITIAL_UE_MESSAGE(message_p).ecgi.plmn =
+      load_plmn;
+  S1AP_INITIAL_UE_MESSAGE(message_p).ecgi.cell_identity.enb_id = ue->enb + 1;
+  if (with_s_tmsi) {
+    S1AP_INITIAL_UE_MESSAGE(message_p).is_s_tmsi_valid = true;
+    S1AP_INITIAL_UE_MESSAGE(message_p).opt_s_tmsi.m_tmsi = ue->guti.m_tmsi;
+    S1AP_INITIAL_UE_MESSAGE(message_p).opt_s_tmsi.mme_code = ue->guti.mme_code;
+  }
+  send_msg_to_task(&task_zmq_ctx_main, TASK_MME_APP, message_p);
+}
+
+void MmeLoadDriver::send_uplink_nas(LoadUe* ue,
+                                    const std::vector<uint8_t>& nas) {
+  MessageDef* message_p =
+      itti_alloc_new_message(TASK_S1AP, MME_APP_UPLINK_DATA_IND);
+  ITTI_MSG_LASTHOP_LATENCY(message_p) = 0;
+  MME_APP_UL_DATA_IND(message_p).ue_id = ue->mme_ue_s1ap_id;
+  MME_APP_UL_DATA_IND(message_p).nas_msg = blk2bstr(nas.data(), nas.size());
+  MME_APP_UL_DATA_IND(message_p).tai.plmn = load_plmn;
+  MME_APP_UL_DATA_IND(message_p).tai.tac = LOAD_TAC;
+  MME_APP_UL_DATA_IND(message_p).cgi.plmn = load_plmn;
+  MME_APP_UL_DATA_IND(message_p).cgi.cell_identity.enb_id = ue->enb + 1;
+  send_msg_to_task(&task_zmq_ctx_main, TASK_MME_APP, message_p);
+}
+
+void MmeLoadDriver::send_context_release_request(LoadUe* ue) {
+  MessageDef* message_p =
+      itti_alloc_new_message(TASK_S1AP, S1AP_UE_CONTEXT_RELEASE_REQ);
+  S1AP_UE_CONTEXT_RELEASE_REQ(message_p).mme_ue_s1ap_id = ue->mme_ue_s1ap_id;
+  S1AP_UE_CONTEXT_RELEASE_REQ(message_p).enb_ue_s1ap_id = ue->enb_ue_s1ap_id;
+  S1AP_UE_CONTEXT_RELEASE_REQ(message_p).enb_id = ue->enb + 1;
+  S1AP_UE_CONTEXT_RELEASE_REQ(message_p).relCause =
+      S1AP_RADIO_EUTRAN_GENERATED_REASON;
+  send_msg_to_task(&task_zmq_ctx_main, TASK_MME_APP, message_p);
+}
+
+void MmeLoadDriver::send_paging(LoadUe* ue) {
+  // Downlink data notification of the SPGW for the UE IP
+  MessageDef* message_p =
+      itti_alloc_new_message(TASK_SPGW_APP, S11_PAGING_REQUEST);
+  itti_s11_paging_request_t* paging_request_p =
+      &message_p->ittiMsg.s11_paging_request;
+  paging_request_p->address.ipv4_addr.sin_addr.s_addr = ue->ipv4;
+  paging_request_p->ip_addr_type = IPV4_ADDR_TYPE;
+  send_msg_to_task(&task_zmq_ctx_main, TASK_MME_APP, message_p);
+}
+
+LoadUe* MmeLoadDriver::ue_of_mme_id(mme_ue_s1ap_id_t mme_ue_s1ap_id) {
+  auto it = ue_of_mme_id_.find(mme_ue_s1ap_id);
+  return it == ue_of_mme_id_.end() ? nullptr : &ues_[it->second];
+}
+
+LoadUe* MmeLoadDriver::ue_of_imsi(const char* imsi, size_t len) {
+  // IMSIs are the prefix followed by the UE index plus one
+  size_t prefix = strlen(LOAD_IMSI_PREFIX);
+  if (len <= prefix || strncmp(imsi, LOAD_IMSI_PREFIX, prefix)) {
+    return nullptr;
+  }
+  uint64_t index = strtoull(std::string(imsi + prefix, len - prefix).c_str(),
+                            nullptr, 10);
+  if (index == 0 || index > ues_.size()) {
+    return nullptr;
+  }
+  return &ues_[index - 1];
+}
+
+LoadUe* MmeLoadDriver::ue_of_teid(teid_t teid) {
+  auto it = ue_of_teid_.find(teid);
+  return it == ue_of_teid_.end() ? nullptr : &ues_[it->second];
+}
+
+void MmeLoadDriver::on_s1ap_message(MessageDef* msg) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  switch (ITTI_MSG_ID(msg)) {
+    case MME_APP_S1AP_MME_UE_ID_NOTIFICATION: {
+      auto& notification = msg->ittiMsg.mme_app_s1ap_mme_ue_id_notification;
+      auto it = ue_of_enb_id_.find(notification.enb_ue_s1ap_id);
+      if (it == ue_of_enb_id_.end()) {
+        break;
+      }
+      ues_[it->second].mme_ue_s1ap_id = notification.mme_ue_s1ap_id;
+      ue_of_mme_id_[notification.mme_ue_s1ap_id] = it->second;
+    } break;
+
+    case S1AP_NAS_DL_DATA_REQ: {
+      LoadUe* ue = ue_of_mme_id(S1AP_NAS_DL_DATA_REQ(msg).mme_ue_s1ap_id);
+      bstring nas = S1AP_NAS_DL_DATA_REQ(msg).nas_msg;
+      if (!ue || !nas) {
+        break;
+      }
+      switch (load_nas_dl_message_type(nas->data, nas->slen)) {
+        case LOAD_NAS_AUTH_REQUEST:
+          send_uplink_nas(ue, load_nas_auth_response());
+          break;
+        case LOAD_NAS_SMC:
+          ue->nas.reset_security(load_nas_kasme);
+          send_uplink_nas(
+              ue, ue->nas.protect(LOAD_NAS_SH_INTEGRITY_CIPHERED_NEW_CTX,
+                                  load_nas_smc_complete()));
+          break;
+        case LOAD_NAS_EMM_INFORMATION:
+          on_event(ue, LOAD_EVENT_EMM_INFORMATION);
+          break;
+        case LOAD_NAS_TAU_ACCEPT:
+          on_event(ue, LOAD_EVENT_TAU_ACCEPT);
+          break;
+        case LOAD_NAS_ATTACH_REJECT:
+        case LOAD_NAS_AUTH_REJECT:
+        case LOAD_NAS_SERVICE_REJECT:
+        case LOAD_NAS_TAU_REJECT:
+          reject(ue);
+          break;
+        default:
+          break;
+      }
+    } break;
+
+    case MME_APP_CONNECTION_ESTABLISHMENT_CNF: {
+      auto& cnf = MME_APP_CONNECTION_ESTABLISHMENT_CNF(msg);
+      LoadUe* ue = ue_of_mme_id(cnf.ue_id);
+      if (!ue) {
+        break;
+      }
+      MessageDef* message_p =
+          itti_alloc_new_message(TASK_S1AP, MME_APP_INITIAL_CONTEXT_SETUP_RSP);
+      auto& rsp = MME_APP_INITIAL_CONTEXT_SETUP_RSP(message_p);
+      uint8_t transport_address_buff[4] = {192, 168, 60, 141};
+      rsp.ue_id = cnf.ue_id;
+      rsp.e_rab_setup_list.no_of_items = cnf.no_of_e_rabs;
+      for (int i = 0; i < cnf.no_of_e_rabs; i++) {
+        rsp.e_rab_setup_list.item[i].e_rab_id = cnf.e_rab_id[i];
+        rsp.e_rab_setup_list.item[i].gtp_teid = ue - ues_.data() + 1;
+        rsp.e_rab_setup_list.item[i].transport_layer_address =
+            blk2bstr(transport_address_buff, 4);
+      }
+      send_msg_to_task(&task_zmq_ctx_main, TASK_MME_APP, message_p);
+
+      // Attach Accept, the UE completes the attach with the GUTI it got
+      if (cnf.nas_pdu[0] && ue->proc == LOAD_PROC_ATTACH) {
+        nas_message_t decoded = {0};
+        emm_security_context_t emm_security_context = {0};
+        nas_message_decode_status_t decode_status = {0};
+        if (nas_message_decode(cnf.nas_pdu[0]->data, &decoded,
+                               cnf.nas_pdu[0]->slen, &emm_security_context,
+                               &decode_status) > 0) {
+          ue->guti = decoded.plain.emm.attach_accept.guti.guti;
+          bdestroy_wrapper(&decoded.plain.emm.attach_accept.esmmessagecontainer);
+        }
+        message_p = itti_alloc_new_message(TASK_S1AP, S1AP_UE_CAPABILITIES_IND);
+        itti_s1ap_ue_cap_ind_t* ue_cap_ind_p =
+            &message_p->ittiMsg.s1ap_ue_cap_ind;
+        ue_cap_ind_p->enb_ue_s1ap_id = ue->enb_ue_s1ap_id;
+        ue_cap_ind_p->mme_ue_s1ap_id = ue->mme_ue_s1ap_id;
+        ue_cap_ind_p->radio_capabilities_length = 200;
+        ue_cap_ind_p->radio_capabilities = reinterpret_cast<uint8_t*>(
+            calloc(1, ue_cap_ind_p->radio_capabilities_length));
+        send_msg_to_task(&task_zmq_ctx_main, TASK_MME_APP, message_p);
+        send_uplink_nas(ue, ue->nas.protect(LOAD_NAS_SH_INTEGRITY_CIPHERED,
+                                            load_nas_attach_complete()));
+      }
+    } break;
+
+    case S1AP_UE_CONTEXT_RELEASE_COMMAND: {
+      auto& cmd = S1AP_UE_CONTEXT_RELEASE_COMMAND(msg);
+      MessageDef* message_p =
+          itti_alloc_new_message(TASK_S1AP, S1AP_UE_CONTEXT_RELEASE_COMPLETE);
+      S1AP_UE_CONTEXT_RELEASE_COMPLETE(message_p).mme_ue_s1ap_id =
+          cmd.mme_ue_s1ap_id;
+      S1AP_UE_CONTEXT_RELEASE_COMPLETE(message_p).enb_ue_s1ap_id =
+          cmd.enb_ue_s1ap_id;
+      send_msg_to_task(&task_zmq_ctx_main, TASK_MME_APP, message_p);
+
+      LoadUe* ue = ue_of_mme_id(cmd.mme_ue_s1ap_id);
+      if (!ue) {
+        break;
+      }
+      ue_of_enb_id_.erase(ue->enb_ue_s1ap_id);
+      ue->enb_ue_s1ap_id = 0;
+      if (ue->awaiting_release) {
+        ue->awaiting_release = false;
+      } else if (ue->proc == LOAD_PROC_DETACH ||
+                 ue->proc == LOAD_PROC_RELEASE) {
+        on_event(ue, LOAD_EVENT_RELEASE_COMMAND);
+      } else if (ue->proc != LOAD_PROC_MAX) {
+        // Released in the middle of a procedure
+        int proc = ue->proc;
+        fail(ue);
+        ue->state = proc == LOAD_PROC_ATTACH ? LoadUeState::DEREGISTERED
+                                             : LoadUeState::IDLE;
+      } else if (ue->state == LoadUeState::CONNECTED) {
+        ue->state = LoadUeState::IDLE;
+      }
+    } break;
+
+    case S1AP_PAGING_REQUEST: {
+      LoadUe* ue = ue_of_imsi(S1AP_PAGING_REQUEST(msg).imsi,
+                              S1AP_PAGING_REQUEST(msg).imsi_length);
+      if (ue) {
+        on_event(ue, LOAD_EVENT_PAGED);
+      }
+    } break;
+
+    default:
+      break;
+  }
+}
+
+void MmeLoadDriver::on_s6a_message(MessageDef* msg) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  switch (ITTI_MSG_ID(msg)) {
+    case S6A_AUTH_INFO_REQ: {
+      s6a_auth_info_req_t* air = &msg->ittiMsg.s6a_auth_info_req;
+      send_authentication_info_resp(std::string(air->imsi, air->imsi_length),
+                                    true);
+    } break;
+
+    case S6A_UPDATE_LOCATION_REQ: {
+      s6a_update_location_req_t* ulr = &msg->ittiMsg.s6a_update_location_req;
+      send_s6a_ula(std::string(ulr->imsi, ulr->imsi_length), true);
+    } break;
+
+    default:
+      break;
+  }
+}
+
+void MmeLoadDriver::on_spgw_message(MessageDef* msg) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  switch (ITTI_MSG_ID(msg)) {
+    case S11_CREATE_SESSION_REQUEST: {
+      auto& csr = msg->ittiMsg.s11_create_session_request;
+      LoadUe* ue = ue_of_imsi(reinterpret_cast<const char*>(csr.imsi.digit),
+                              csr.imsi.length);
+      if (!ue) {
+        break;
+      }
+      uint32_t index = ue - ues_.data();
+      ue->mme_teid_s11 = csr.sender_fteid_for_cp.teid;
+      ue_of_teid_[ue->mme_teid_s11] = index;
+
+      MessageDef* message_p =
+          itti_alloc_new_message(TASK_SPGW_APP, S11_CREATE_SESSION_RESPONSE);
+      itti_s11_create_session_response_t* rsp =
+          &message_p->ittiMsg.s11_create_session_response;
+      rsp->teid = ue->mme_teid_s11;
+      rsp->cause.cause_value = REQUEST_ACCEPTED;
+      rsp->s11_sgw_fteid.teid = index + 1;
+      rsp->s11_sgw_fteid.interface_type = S11_SGW_GTP_C;
+      rsp->s11_sgw_fteid.ipv4 = 1;
+      rsp->s11_sgw_fteid.ipv4_address.s_addr = htonl(LOAD_SGW_IPV4);
+      rsp->paa.pdn_type = IPv4;
+      rsp->paa.ipv4_address.s_addr = ue->ipv4;
+      auto& bearer = rsp->bearer_contexts_created.bearer_contexts[0];
+      bearer.cause.cause_value = REQUEST_ACCEPTED;
+      bearer.eps_bearer_id =
+          csr.bearer_contexts_to_be_created.bearer_contexts[0].eps_bearer_id;
+      bearer.s1u_sgw_fteid.teid = index + 1;
+      bearer.s1u_sgw_fteid.interface_type = S1_U_SGW_GTP_U;
+      bearer.s1u_sgw_fteid.ipv4 = 1;
+      bearer.s1u_sgw_fteid.ipv4_address.s_addr = htonl(LOAD_SGW_IPV4);
+      rsp->bearer_contexts_created.num_bearer_context = 1;
+      send_msg_to_task(&task_zmq_ctx_main, TASK_MME_APP, message_p);
+    } break;
+
+    case S11_MODIFY_BEARER_REQUEST: {
+      auto& mbr = msg->ittiMsg.s11_modify_bearer_request;
+      MessageDef* message_p =
+          itti_alloc_new_message(TASK_SPGW_APP, S11_MODIFY_BEARER_RESPONSE);
+      itti_s11_modify_bearer_response_t* rsp =
+          &message_p->ittiMsg.s11_modify_bearer_response;
+      rsp->teid = mbr.local_teid;
+      rsp->cause.cause_value = REQUEST_ACCEPTED;
+      for (int i = 0; i < mbr.bearer_contexts_to_be_modified.num_bearer_context;
+           i++) {
+        rsp->bearer_contexts_modified.bearer_contexts[i].eps_bearer_id =
+            mbr.bearer_contexts_to_be_modified.bearer_contexts[i].eps_bearer_id;
+        rsp->bearer_contexts_modified.bearer_contexts[i].cause.cause_value =
+            REQUEST_ACCEPTED;
+      }
+      rsp->bearer_contexts_modified.num_bearer_context =
+          mbr.bearer_contexts_to_be_modified.num_bearer_context;
+      send_msg_to_task(&task_zmq_ctx_main, TASK_MME_APP, message_p);
+
+      LoadUe* ue = ue_of_teid(mbr.local_teid);
+      if (ue) {
+        on_event(ue, LOAD_EVENT_MODIFY_BEARER);
+      }
+    } break;
+
+    case S11_RELEASE_ACCESS_BEARERS_REQUEST: {
+      auto& rab = msg->ittiMsg.s11_release_access_bearers_request;
+      MessageDef* message_p = itti_alloc_new_message(
+          TASK_SPGW_APP, S11_RELEASE_ACCESS_BEARERS_RESPONSE);
+      message_p->ittiMsg.s11_release_access_bearers_response.teid =
+          rab.local_teid;
+      message_p->ittiMsg.s11_release_access_bearers_response.cause
+          .cause_value = REQUEST_ACCEPTED;
+      send_msg_to_task(&task_zmq_ctx_main, TASK_MME_APP, message_p);
+    } break;
+
+    case S11_DELETE_SESSION_REQUEST: {
+      auto& dsr = msg->ittiMsg.s11_delete_session_request;
+      MessageDef* message_p =
+          itti_alloc_new_message(TASK_SPGW_APP, S11_DELETE_SESSION_RESPONSE);
+      itti_s11_delete_session_response_t* rsp =
+          &message_p->ittiMsg.s11_delete_session_response;
+      rsp->teid = dsr.local_teid;
+      rsp->cause.cause_value = REQUEST_ACCEPTED;
+      rsp->peer_ip.s_addr = htonl(LOAD_SGW_IPV4);
+      rsp->lbi = dsr.lbi ? dsr.lbi : LOAD_DEFAULT_LBI;
+      send_msg_to_task(&task_zmq_ctx_main, TASK_MME_APP, message_p);
+      ue_of_teid_.erase(dsr.local_teid);
+    } break;
+
+    default:
+      break;
+  }
+}
+
+static void print_phase(FILE* out, const char* name,
+                        const MmeLoadPhaseReport& phase) {
+  fprintf(out, "%s: %.2f s\n", name, phase.seconds);
+  fprintf(out, "  %-10s %9s %9s %7s %7s %9s %9s %9s %9s %9s\n", "procedure",
+          "started", "completed", "failed", "timeout", "per sec", "p50 ms",
+          "p99 ms", "p999 ms", "max ms");
+  for (int proc = 0; proc < LOAD_PROC_MAX; proc++) {
+    const MmeLoadProcedureStats& stats = phase.procedures[proc];
+    if (!stats.started) {
+      continue;
+    }
+    const LatencyHistogram& latency = stats.latency;
+    fprintf(out,
+            "  %-10s %9lu %9lu %7lu %7lu %9.1f %9.3f %9.3f %9.3f %9.3f\n",
+            load_procedure_name(proc), stats.started, latency.count(),
+            stats.failed, stats.timed_out,
+            phase.seconds > 0 ? latency.count() / phase.seconds : 0,
+            latency.percentile(0.5) / 1000.0, latency.percentile(0.99) / 1000.0,
+            latency.percentile(0.999) / 1000.0, latency.max() / 1000.0);
+  }
+  if (phase.skipped) {
+    fprintf(out, "  %lu procedures skipped, no free UE in the needed state\n",
+            phase.skipped);
+  }
+}
+
+void MmeLoadReport::print(FILE* out) const {
+  print_phase(out, "ramp", ramp);
+  print_phase(out, "mix", mix);
+  fprintf(out, "RSS: %ld kB at start, %ld kB after ramp, %ld kB at end",
+          rss_start_kb, rss_ramp_kb, rss_end_kb);
+  if (rss_start_kb >= 0 && rss_end_kb >= 0) {
+    fprintf(out, ", %+ld kB growth", rss_end_kb - rss_start_kb);
+  }
+  fprintf(out, "\n");
+  if (ues_lost) {
+    fprintf(out, "%u UEs lost to timeouts\n", ues_lost);
+  }
+}
+
+}  // namespace lte
+}  // namespace magma
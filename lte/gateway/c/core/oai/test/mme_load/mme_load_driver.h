@@ -0,0 +1,186 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lte/gateway/c/core/oai/test/mme_load/mme_load_nas.h"
+#include "lte/gateway/c/core/oai/test/mme_load/mme_load_stats.h"
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/common_types.h"
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface.h"
+}
+
+namespace magma {
+namespace lte {
+
+enum LoadProcedure {
+  LOAD_PROC_ATTACH = 0,
+  LOAD_PROC_DETACH,
+  LOAD_PROC_SERVICE_REQUEST,
+  LOAD_PROC_PAGING,
+  LOAD_PROC_TAU,
+  LOAD_PROC_RELEASE,
+  LOAD_PROC_MAX
+};
+
+const char* load_procedure_name(int proc);
+
+/*
+ * Parses a procedure mix such as "attach=1,service=4,release=4", with the
+ * names of load_procedure_name. Procedures left out get weight 0. Returns
+ * false if the mix is malformed or has no positive weight.
+ */
+bool parse_procedure_mix(const std::string& mix,
+                         std::array<double, LOAD_PROC_MAX>* weights);
+
+struct MmeLoadConfig {
+  uint32_t num_enbs = 1;
+  uint32_t num_ues = 100;
+  // Procedures started per second, in the ramp and in the mix
+  double rate = 100;
+  uint32_t duration_sec = 10;
+  // A procedure not completed by then is counted as timed out and its UE is
+  // left out of the rest of the run
+  uint32_t timeout_ms = 5000;
+  std::array<double, LOAD_PROC_MAX> mix = {{1, 1, 4, 2, 2, 4}};
+};
+
+struct MmeLoadProcedureStats {
+  uint64_t started = 0;
+  uint64_t failed = 0;
+  uint64_t timed_out = 0;
+  // Completed procedures
+  LatencyHistogram latency;
+};
+
+struct MmeLoadPhaseReport {
+  double seconds = 0;
+  std::array<MmeLoadProcedureStats, LOAD_PROC_MAX> procedures;
+  // Procedures drawn from the mix but not started, no UE being free in the
+  // state they need
+  uint64_t skipped = 0;
+};
+
+struct MmeLoadReport {
+  // Attach of all UEs, then the procedure mix
+  MmeLoadPhaseReport ramp;
+  MmeLoadPhaseReport mix;
+  long rss_start_kb = -1;
+  long rss_ramp_kb = -1;
+  long rss_end_kb = -1;
+  uint32_t ues_lost = 0;
+
+  void print(FILE* out) const;
+};
+
+enum class LoadUeState { DEREGISTERED, CONNECTED, IDLE };
+
+struct LoadUe {
+  std::string imsi;
+  uint32_t enb = 0;
+  enb_ue_s1ap_id_t enb_ue_s1ap_id = 0;
+  mme_ue_s1ap_id_t mme_ue_s1ap_id = INVALID_MME_UE_S1AP_ID;
+  teid_t mme_teid_s11 = 0;
+  uint32_t ipv4 = 0;
+  guti_eps_mobile_identity_t guti = {0};
+  LoadUeNas nas;
+  LoadUeState state = LoadUeState::DEREGISTERED;
+  // Procedure in progress, LOAD_PROC_MAX if none
+  int proc = LOAD_PROC_MAX;
+  // Events still needed to complete it
+  uint32_t pending = 0;
+  // Rejected, waiting for the MME to release the connection
+  bool awaiting_release = false;
+  // Timed out, the UE state is unknown
+  bool lost = false;
+  std::chrono::steady_clock::time_point started;
+  MmeLoadPhaseReport* phase = nullptr;
+};
+
+/*
+ * Headless load generator for the MME: runs the MME_APP and NAS tasks and
+ * plays N eNBs and M UEs against them, at the ITTI boundary. S1AP, S6a and
+ * SPGW are stub tasks answering the MME on behalf of the UEs, the other
+ * peer tasks are the usual mock tasks. All the messages to MME_APP are sent
+ * over one ITTI context, so that it sees them in the order they are sent.
+ *
+ * All UEs first attach at the configured rate, then procedures are drawn
+ * from the mix at that rate for the configured duration. A procedure is
+ * timed from its first message to the MME to the last message of the MME
+ * it needs: Modify Bearer Request and EMM Information for attach, Modify
+ * Bearer Request for service request and paging, TAU Accept for TAU and
+ * UE Context Release Command for detach and S1 release.
+ *
+ * Only one driver may run at a time in a process.
+ */
+class MmeLoadDriver {
+ public:
+  explicit MmeLoadDriver(const MmeLoadConfig& config);
+
+  MmeLoadReport run();
+
+  // Messages from MME_APP to the stub tasks
+  void on_s1ap_message(MessageDef* msg);
+  void on_s6a_message(MessageDef* msg);
+  void on_spgw_message(MessageDef* msg);
+
+ private:
+  void start_tasks();
+  void stop_tasks();
+  void run_phase(MmeLoadPhaseReport* phase, bool ramp);
+  void drain(MmeLoadPhaseReport* phase);
+  void start_procedure(MmeLoadPhaseReport* phase, int proc);
+  LoadUe* pick_ue(LoadUeState state);
+  void check_timeouts(std::chrono::steady_clock::time_point now);
+
+  void begin(LoadUe* ue, MmeLoadPhaseReport* phase, int proc,
+             uint32_t pending);
+  void on_event(LoadUe* ue, uint32_t event);
+  void complete(LoadUe* ue);
+  void fail(LoadUe* ue);
+  void reject(LoadUe* ue);
+
+  void new_connection(LoadUe* ue);
+  void send_initial_ue_message(LoadUe* ue, const std::vector<uint8_t>& nas,
+                               bool with_s_tmsi);
+  void send_uplink_nas(LoadUe* ue, const std::vector<uint8_t>& nas);
+  void send_context_release_request(LoadUe* ue);
+  void send_paging(LoadUe* ue);
+
+  LoadUe* ue_of_mme_id(mme_ue_s1ap_id_t mme_ue_s1ap_id);
+  LoadUe* ue_of_imsi(const char* imsi, size_t len);
+  LoadUe* ue_of_teid(teid_t teid);
+
+  MmeLoadConfig config_;
+  std::mutex mutex_;
+  std::vector<LoadUe> ues_;
+  std::unordered_map<enb_ue_s1ap_id_t, uint32_t> ue_of_enb_id_;
+  std::unordered_map<mme_ue_s1ap_id_t, uint32_t> ue_of_mme_id_;
+  std::unordered_map<teid_t, uint32_t> ue_of_teid_;
+  enb_ue_s1ap_id_t next_enb_ue_s1ap_id_;
+  uint32_t in_flight_;
+  std::mt19937 rng_;
+};
+
+}  // namespace lte
+}  // namespace magma
@@ -0,0 +1,88 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <getopt.h>
+#include <cstdio>
+#include <cstdlib>
+
+#include "lte/gateway/c/core/oai/test/mme_load/mme_load_driver.h"
+
+using magma::lte::MmeLoadConfig;
+using magma::lte::MmeLoadDriver;
+using magma::lte::MmeLoadReport;
+
+static void usage(const char* name) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --enbs N        number of eNBs (default 1)\n"
+          "  --ues N         number of UEs, all attached first (default 100)\n"
+          "  --rate R        procedures started per second (default 100)\n"
+          "  --duration S    seconds of procedure mix after the attach of all\n"
+          "                  UEs (default 10)\n"
+          "  --timeout MS    procedure timeout in ms (default 5000)\n"
+          "  --mix MIX       weights of the procedures of the mix, e.g.\n"
+          "                  attach=1,detach=1,service=4,paging=2,tau=2,"
+          "release=4\n",
+          name);
+}
+
+int main(int argc, char** argv) {
+  static const struct option options[] = {
+      {"enbs", required_argument, NULL, 'e'},
+      {"ues", required_argument, NULL, 'u'},
+      {"rate", required_argument, NULL, 'r'},
+      {"duration", required_argument, NULL, 'd'},
+      {"timeout", required_argument, NULL, 't'},
+      {"mix", required_argument, NULL, 'm'},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0}};
+  MmeLoadConfig config;
+  int opt;
+  while ((opt = getopt_long(argc, argv, "e:u:r:d:t:m:h", options, NULL)) !=
+         -1) {
+    switch (opt) {
+      case 'e':
+        config.num_enbs = strtoul(optarg, NULL, 10);
+        break;
+      case 'u':
+        config.num_ues = strtoul(optarg, NULL, 10);
+        break;
+      case 'r':
+        config.rate = strtod(optarg, NULL);
+        break;
+      case 'd':
+        config.duration_sec = strtoul(optarg, NULL, 10);
+        break;
+      case 't':
+        config.timeout_ms = strtoul(optarg, NULL, 10);
+        break;
+      case 'm':
+        if (!magma::lte::parse_procedure_mix(optarg, &config.mix)) {
+          fprintf(stderr, "Invalid procedure mix: %s\n", optarg);
+          return EXIT_FAILURE;
+        }
+        break;
+      default:
+        usage(argv[0]);
+        return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+  }
+  if (config.num_enbs == 0 || config.num_ues == 0 || config.rate <= 0) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  MmeLoadDriver driver(config);
+  MmeLoadReport report = driver.run();
+  report.print(stdout);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,163 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "lte/gateway/c/core/oai/test/mme_load/mme_load_nas.h"
+
+#include <cstring>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/lib/3gpp/3gpp_33.401.h"
+#include "lte/gateway/c/core/oai/lib/secu/secu_defs.h"
+}
+
+#define EPS_MOBILITY_MANAGEMENT_MESSAGE 0x07
+#define LOAD_NAS_SERVICE_REQUEST_HEADER 0xc7
+
+namespace magma {
+namespace lte {
+
+const uint8_t load_nas_kasme[32] = {
+    0xc3, 0x5f, 0x03, 0x8f, 0x5f, 0xbe, 0xcc, 0x23, 0xc4, 0xd1, 0xa7,
+    0xd6, 0x8a, 0xf7, 0x05, 0x32, 0xf2, 0x37, 0xf6, 0x40, 0x47, 0xdd,
+    0x29, 0x6e, 0x7d, 0x0e, 0xf6, 0xe9, 0x26, 0x5f, 0x24, 0x39};
+
+LoadUeNas::LoadUeNas() : ul_count_(0) {
+  memset(knas_int_, 0, sizeof(knas_int_));
+}
+
+void LoadUeNas::reset_security(const uint8_t kasme[32]) {
+  derive_key_nas_int(EIA2_128_ALG_ID, kasme, knas_int_);
+  ul_count_ = 0;
+}
+
+void LoadUeNas::mac(const uint8_t* msg, size_t len, uint8_t out[4]) const {
+  nas_stream_cipher_t stream_cipher = {0};
+  stream_cipher.key = const_cast<uint8_t*>(knas_int_);
+  stream_cipher.key_length = sizeof(knas_int_);
+  stream_cipher.count = ul_count_;
+  stream_cipher.bearer = 0;
+  stream_cipher.direction = SECU_DIRECTION_UPLINK;
+  stream_cipher.message = const_cast<uint8_t*>(msg);
+  stream_cipher.blength = len << 3;
+  nas_stream_encrypt_eia2(&stream_cipher, out);
+}
+
+std::vector<uint8_t> LoadUeNas::protect(uint8_t sh,
+                                        const std::vector<uint8_t>& plain) {
+  // Header, MAC, then the sequence number and the plain message the MAC is
+  // computed on
+  std::vector<uint8_t> msg(6 + plain.size());
+  msg[0] = (sh << 4) | EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  msg[5] = ul_count_ & 0xff;
+  memcpy(&msg[6], plain.data(), plain.size());
+  mac(&msg[5], msg.size() - 5, &msg[1]);
+  ul_count_++;
+  return msg;
+}
+
+std::vector<uint8_t> LoadUeNas::service_request() {
+  // KSI 0 and the 5 least significant bits of the count, followed by the 2
+  // least significant octets of the MAC computed on the first 2 octets
+  std::vector<uint8_t> msg(4);
+  uint8_t mac_out[4];
+  msg[0] = LOAD_NAS_SERVICE_REQUEST_HEADER;
+  msg[1] = ul_count_ & 0x1f;
+  mac(msg.data(), 2, mac_out);
+  msg[2] = mac_out[2];
+  msg[3] = mac_out[3];
+  ul_count_++;
+  return msg;
+}
+
+std::vector<uint8_t> load_nas_attach_request(const std::string& imsi) {
+  // EPS attach, no key available, then the IMSI, UE network capability and
+  // an ESM container with a PDN Connectivity Request
+  std::vector<uint8_t> msg = {0x07, 0x41, 0x71, 0x08};
+  uint8_t digits[15] = {0};
+  for (size_t i = 0; i < 15 && i < imsi.size(); i++) {
+    digits[i] = imsi[i] - '0';
+  }
+  msg.push_back((digits[0] << 4) | 0x09);
+  for (int i = 1; i < 15; i += 2) {
+    msg.push_back((digits[i + 1] << 4) | digits[i]);
+  }
+  const uint8_t tail[] = {0x02, 0xe0, 0xe0, 0x00, 0x04, 0x02, 0x01,
+                          0xd0, 0x11, 0x40, 0x08, 0x04, 0x02, 0x60,
+                          0x04, 0x00, 0x02, 0x1c, 0x00};
+  msg.insert(msg.end(), tail, tail + sizeof(tail));
+  return msg;
+}
+
+std::vector<uint8_t> load_nas_auth_response() {
+  return {0x07, 0x53, 0x10, 0x66, 0xff, 0x47, 0x2d, 0xd4, 0x93, 0xf1,
+          0x5a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+}
+
+std::vector<uint8_t> load_nas_smc_complete() {
+  return {0x07, 0x5e, 0x23, 0x09, 0x33, 0x08, 0x45,
+          0x86, 0x34, 0x12, 0x31, 0x71, 0xf2};
+}
+
+std::vector<uint8_t> load_nas_attach_complete() {
+  // ESM container with an Activate Default EPS Bearer Context Accept
+  return {0x07, 0x43, 0x00, 0x03, 0x52, 0x00, 0xc2};
+}
+
+static void append_guti(std::vector<uint8_t>* msg,
+                        const guti_eps_mobile_identity_t& guti) {
+  msg->push_back(0x0b);
+  msg->push_back(0xf6);
+  msg->push_back((guti.mcc_digit2 << 4) | guti.mcc_digit1);
+  msg->push_back((guti.mnc_digit3 << 4) | guti.mcc_digit3);
+  msg->push_back((guti.mnc_digit2 << 4) | guti.mnc_digit1);
+  msg->push_back(guti.mme_group_id >> 8);
+  msg->push_back(guti.mme_group_id & 0xff);
+  msg->push_back(guti.mme_code);
+  msg->push_back(guti.m_tmsi >> 24);
+  msg->push_back((guti.m_tmsi >> 16) & 0xff);
+  msg->push_back((guti.m_tmsi >> 8) & 0xff);
+  msg->push_back(guti.m_tmsi & 0xff);
+}
+
+std::vector<uint8_t> load_nas_detach_request(
+    const guti_eps_mobile_identity_t& guti) {
+  // Switch off EPS detach with KSI 0, no Detach Accept is expected
+  std::vector<uint8_t> msg = {0x07, 0x45, 0x09};
+  append_guti(&msg, guti);
+  return msg;
+}
+
+std::vector<uint8_t> load_nas_tau_request(
+    const guti_eps_mobile_identity_t& guti) {
+  // TA updating with KSI 0 and without active flag
+  std::vector<uint8_t> msg = {0x07, 0x48, 0x00};
+  append_guti(&msg, guti);
+  return msg;
+}
+
+int load_nas_dl_message_type(const uint8_t* buf, size_t len) {
+  if (len < 2 || (buf[0] & 0x0f) != EPS_MOBILITY_MANAGEMENT_MESSAGE) {
+    return -1;
+  }
+  if ((buf[0] >> 4) == 0) {
+    return buf[1];
+  }
+  // Security protected: header, MAC and sequence number before the plain
+  // message
+  if (len < 8 || (buf[6] & 0x0f) != EPS_MOBILITY_MANAGEMENT_MESSAGE) {
+    return -1;
+  }
+  return buf[7];
+}
+
+}  // namespace lte
+}  // namespace magma
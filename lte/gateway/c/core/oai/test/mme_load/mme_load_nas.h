@@ -0,0 +1,92 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/tasks/nas/ies/EpsMobileIdentity.h"
+}
+
+namespace magma {
+namespace lte {
+
+// EMM message types the load driver sends or reacts to, TS 24.301 9.8
+#define LOAD_NAS_ATTACH_ACCEPT 0x42
+#define LOAD_NAS_ATTACH_REJECT 0x44
+#define LOAD_NAS_DETACH_ACCEPT 0x46
+#define LOAD_NAS_TAU_ACCEPT 0x49
+#define LOAD_NAS_TAU_REJECT 0x4b
+#define LOAD_NAS_SERVICE_REJECT 0x4e
+#define LOAD_NAS_AUTH_REQUEST 0x52
+#define LOAD_NAS_AUTH_REJECT 0x54
+#define LOAD_NAS_SMC 0x5d
+#define LOAD_NAS_EMM_INFORMATION 0x61
+
+// Security header types, TS 24.301 9.3.1
+#define LOAD_NAS_SH_INTEGRITY 0x1
+#define LOAD_NAS_SH_INTEGRITY_CIPHERED 0x2
+#define LOAD_NAS_SH_INTEGRITY_CIPHERED_NEW_CTX 0x4
+
+/*
+ * Uplink NAS of an emulated UE. The MME is configured with EIA2 and EEA0 and
+ * the S6a stub always returns the same vector, so that every UE can compute
+ * its MACs from that vector's KASME without running AKA.
+ */
+class LoadUeNas {
+ public:
+  LoadUeNas();
+
+  // Starts a new NAS security context, as on Security Mode Command
+  void reset_security(const uint8_t kasme[32]);
+
+  // Protected message with header type sh, plain being the plain NAS message.
+  // The uplink NAS count is incremented.
+  std::vector<uint8_t> protect(uint8_t sh, const std::vector<uint8_t>& plain);
+
+  // Service Request with the short MAC. The uplink NAS count is incremented.
+  std::vector<uint8_t> service_request();
+
+  uint32_t ul_count() const { return ul_count_; }
+
+ private:
+  void mac(const uint8_t* msg, size_t len, uint8_t out[4]) const;
+
+  uint8_t knas_int_[16];
+  uint32_t ul_count_;
+};
+
+// Plain NAS messages
+std::vector<uint8_t> load_nas_attach_request(const std::string& imsi);
+std::vector<uint8_t> load_nas_auth_response();
+std::vector<uint8_t> load_nas_smc_complete();
+std::vector<uint8_t> load_nas_attach_complete();
+std::vector<uint8_t> load_nas_detach_request(
+    const guti_eps_mobile_identity_t& guti);
+std::vector<uint8_t> load_nas_tau_request(
+    const guti_eps_mobile_identity_t& guti);
+
+/*
+ * EMM message type of a downlink NAS message, or -1 if it is not an EMM
+ * message. Protected messages are expected to be sent with EEA0.
+ */
+int load_nas_dl_message_type(const uint8_t* buf, size_t len);
+
+// The KASME of the vector returned by the S6a stub
+extern const uint8_t load_nas_kasme[32];
+
+}  // namespace lte
+}  // namespace magma
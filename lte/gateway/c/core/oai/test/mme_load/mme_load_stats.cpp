@@ -0,0 +1,104 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "lte/gateway/c/core/oai/test/mme_load/mme_load_stats.h"
+
+#include <unistd.h>
+#include <cmath>
+#include <cstdio>
+
+#define LATENCY_EXACT_BUCKETS 64
+#define LATENCY_EXACT_BITS 6
+#define LATENCY_SUB_BUCKET_BITS 5
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)
+// Up to 2^40 us, beyond anything a procedure can take
+#define LATENCY_MAX_BIT 40
+#define LATENCY_BUCKETS \
+  (LATENCY_EXACT_BUCKETS +  \
+   (LATENCY_MAX_BIT - LATENCY_EXACT_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+namespace magma {
+namespace lte {
+
+LatencyHistogram::LatencyHistogram()
+    : buckets_(LATENCY_BUCKETS, 0), count_(0), max_(0) {}
+
+size_t LatencyHistogram::bucket_of(uint64_t usec) {
+  if (usec < LATENCY_EXACT_BUCKETS) {
+    return usec;
+  }
+  int msb = 63 - __builtin_clzll(usec);
+  if (msb > LATENCY_MAX_BIT) {
+    return LATENCY_BUCKETS - 1;
+  }
+  uint64_t sub = (usec >> (msb - LATENCY_SUB_BUCKET_BITS)) &
+                 (LATENCY_SUB_BUCKETS - 1);
+  return LATENCY_EXACT_BUCKETS +
+         (msb - LATENCY_EXACT_BITS) * LATENCY_SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucket_high(size_t bucket) {
+  if (bucket < LATENCY_EXACT_BUCKETS) {
+    return bucket;
+  }
+  size_t msb = LATENCY_EXACT_BITS +
+               (bucket - LATENCY_EXACT_BUCKETS) / LATENCY_SUB_BUCKETS;
+  uint64_t sub = (bucket - LATENCY_EXACT_BUCKETS) % LATENCY_SUB_BUCKETS;
+  uint64_t low = (LATENCY_SUB_BUCKETS + sub)
+                 << (msb - LATENCY_SUB_BUCKET_BITS);
+  return low + (1ULL << (msb - LATENCY_SUB_BUCKET_BITS)) - 1;
+}
+
+void LatencyHistogram::record(uint64_t usec) {
+  buckets_[bucket_of(usec)]++;
+  count_++;
+  if (usec > max_) {
+    max_ = usec;
+  }
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  uint64_t rank = static_cast<uint64_t>(std::ceil(q * count_));
+  if (rank == 0) {
+    rank = 1;
+  }
+  uint64_t seen = 0;
+  for (size_t i = 0; i < buckets_.size(); i++) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      uint64_t high = bucket_high(i);
+      return high < max_ ? high : max_;
+    }
+  }
+  return max_;
+}
+
+long load_rss_kb() {
+  FILE* fp = fopen("/proc/self/statm", "r");
+  if (!fp) {
+    return -1;
+  }
+  long size = 0;
+  long resident = 0;
+  int n = fscanf(fp, "%ld %ld", &size, &resident);
+  fclose(fp);
+  if (n != 2) {
+    return -1;
+  }
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+}  // namespace lte
+}  // namespace magma
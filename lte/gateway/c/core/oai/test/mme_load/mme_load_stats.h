@@ -0,0 +1,52 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace magma {
+namespace lte {
+
+/*
+ * Log-linear latency histogram in microseconds: exact below 64 us, then 32
+ * buckets per power of two, i.e. percentiles within about 3% of the
+ * recorded values whatever their range, in constant memory.
+ */
+class LatencyHistogram {
+ public:
+  LatencyHistogram();
+
+  void record(uint64_t usec);
+
+  uint64_t count() const { return count_; }
+  uint64_t max() const { return max_; }
+
+  // Latency under which a fraction q of the recorded values are, 0 if none
+  uint64_t percentile(double q) const;
+
+ private:
+  static size_t bucket_of(uint64_t usec);
+  static uint64_t bucket_high(size_t bucket);
+
+  std::vector<uint64_t> buckets_;
+  uint64_t count_;
+  uint64_t max_;
+};
+
+// Resident set size of the process in kB, -1 if it cannot be read
+long load_rss_kb();
+
+}  // namespace lte
+}  // namespace magma
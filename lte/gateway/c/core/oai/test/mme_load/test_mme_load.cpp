@@ -0,0 +1,139 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+#include "lte/gateway/c/core/oai/test/mme_load/mme_load_driver.h"
+#include "lte/gateway/c/core/oai/test/mme_load/mme_load_nas.h"
+#include "lte/gateway/c/core/oai/test/mme_load/mme_load_stats.h"
+
+namespace magma {
+namespace lte {
+
+// Messages of the MME procedure tests, protected with the vector of the
+// S6a stub
+TEST(MmeLoadNasTest, TestProtectedMessages) {
+  LoadUeNas nas;
+  nas.reset_security(load_nas_kasme);
+
+  std::vector<uint8_t> smc_complete = {0x47, 0xc0, 0xb5, 0x35, 0x6b,
+                                       0x00, 0x07, 0x5e, 0x23, 0x09,
+                                       0x33, 0x08, 0x45, 0x86, 0x34,
+                                       0x12, 0x31, 0x71, 0xf2};
+  EXPECT_EQ(nas.protect(LOAD_NAS_SH_INTEGRITY_CIPHERED_NEW_CTX,
+                        load_nas_smc_complete()),
+            smc_complete);
+
+  std::vector<uint8_t> attach_complete = {0x27, 0xb6, 0x28, 0x5a, 0x49,
+                                          0x01, 0x07, 0x43, 0x00, 0x03,
+                                          0x52, 0x00, 0xc2};
+  EXPECT_EQ(nas.protect(LOAD_NAS_SH_INTEGRITY_CIPHERED,
+                        load_nas_attach_complete()),
+            attach_complete);
+
+  std::vector<uint8_t> service_request = {0xc7, 0x02, 0x79, 0xe0};
+  EXPECT_EQ(nas.service_request(), service_request);
+  EXPECT_EQ(nas.ul_count(), 3);
+}
+
+TEST(MmeLoadNasTest, TestPlainMessages) {
+  std::vector<uint8_t> attach_request = {
+      0x07, 0x41, 0x71, 0x08, 0x09, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00,
+      0x10, 0x02, 0xe0, 0xe0, 0x00, 0x04, 0x02, 0x01, 0xd0, 0x11, 0x40,
+      0x08, 0x04, 0x02, 0x60, 0x04, 0x00, 0x02, 0x1c, 0x00};
+  EXPECT_EQ(load_nas_attach_request("001010000000001"), attach_request);
+
+  guti_eps_mobile_identity_t guti = {0};
+  guti.mcc_digit3 = 1;
+  guti.mnc_digit3 = 0x0f;
+  guti.mnc_digit2 = 1;
+  guti.mme_group_id = 1;
+  guti.mme_code = 1;
+  guti.m_tmsi = 0x4693e8b8;
+  std::vector<uint8_t> detach_request = {0x07, 0x45, 0x09, 0x0b, 0xf6,
+                                         0x00, 0xf1, 0x10, 0x00, 0x01,
+                                         0x01, 0x46, 0x93, 0xe8, 0xb8};
+  EXPECT_EQ(load_nas_detach_request(guti), detach_request);
+
+  std::vector<uint8_t> tau_accept = {0x27, 0x11, 0x22, 0x33, 0x44, 0x03,
+                                     0x07, 0x49, 0x00};
+  EXPECT_EQ(load_nas_dl_message_type(tau_accept.data(), tau_accept.size()),
+            LOAD_NAS_TAU_ACCEPT);
+  std::vector<uint8_t> auth_request = {0x07, 0x52, 0x00};
+  EXPECT_EQ(load_nas_dl_message_type(auth_request.data(), auth_request.size()),
+            LOAD_NAS_AUTH_REQUEST);
+  std::vector<uint8_t> esm = {0x02, 0x01, 0xd0};
+  EXPECT_EQ(load_nas_dl_message_type(esm.data(), esm.size()), -1);
+}
+
+TEST(MmeLoadStatsTest, TestLatencyPercentiles) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.percentile(0.5), 0);
+  for (uint64_t usec = 1; usec <= 100000; usec++) {
+    histogram.record(usec);
+  }
+  EXPECT_EQ(histogram.count(), 100000);
+  EXPECT_EQ(histogram.max(), 100000);
+  // Within the 1/32 resolution of the buckets
+  EXPECT_NEAR(histogram.percentile(0.5), 50000, 50000 / 32);
+  EXPECT_NEAR(histogram.percentile(0.99), 99000, 99000 / 32);
+  EXPECT_NEAR(histogram.percentile(0.999), 99900, 99900 / 32);
+  EXPECT_EQ(histogram.percentile(1), 100000);
+
+  LatencyHistogram exact;
+  exact.record(3);
+  exact.record(40);
+  EXPECT_EQ(exact.percentile(0.5), 3);
+  EXPECT_EQ(exact.percentile(0.99), 40);
+  EXPECT_GT(load_rss_kb(), 0);
+}
+
+TEST(MmeLoadDriverTest, TestParseProcedureMix) {
+  std::array<double, LOAD_PROC_MAX> weights;
+  EXPECT_TRUE(parse_procedure_mix("service=4,release=4,tau=1.5", &weights));
+  EXPECT_EQ(weights[LOAD_PROC_SERVICE_REQUEST], 4);
+  EXPECT_EQ(weights[LOAD_PROC_RELEASE], 4);
+  EXPECT_EQ(weights[LOAD_PROC_TAU], 1.5);
+  EXPECT_EQ(weights[LOAD_PROC_ATTACH], 0);
+  EXPECT_FALSE(parse_procedure_mix("service", &weights));
+  EXPECT_FALSE(parse_procedure_mix("handover=1", &weights));
+  EXPECT_FALSE(parse_procedure_mix("tau=x", &weights));
+  EXPECT_FALSE(parse_procedure_mix("tau=0", &weights));
+}
+
+// A short run against the MME tasks, every procedure of the mix succeeds
+TEST(MmeLoadDriverTest, TestSmokeRun) {
+  MmeLoadConfig config;
+  config.num_enbs = 2;
+  config.num_ues = 20;
+  config.rate = 100;
+  config.duration_sec = 2;
+  MmeLoadDriver driver(config);
+  MmeLoadReport report = driver.run();
+
+  const auto& attach = report.ramp.procedures[LOAD_PROC_ATTACH];
+  EXPECT_EQ(attach.started, 20);
+  EXPECT_EQ(attach.latency.count(), 20);
+  uint64_t completed = 0;
+  for (const auto& stats : report.mix.procedures) {
+    EXPECT_EQ(stats.failed, 0);
+    EXPECT_EQ(stats.timed_out, 0);
+    completed += stats.latency.count();
+  }
+  EXPECT_GT(completed, 0);
+  EXPECT_EQ(report.ues_lost, 0);
+}
+
+}  // namespace lte
+}  // namespace magma
@@ -0,0 +1,341 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lte/gateway/c/core/oai/lib/mobility_client/DelegatedIPAllocator.h"
+
+using grpc::Status;
+using magma::orc8r::Void;
+
+namespace magma {
+namespace lte {
+
+const char* HOLDER = "spgw_app";
+const char* APN = "internet";
+const char* IMSI = "001010000000001";
+const char* OTHER_IMSI = "001010000000002";
+// 192.168.128.0
+const uint32_t LEASE_NET_ADDR = 0xc0a88000;
+
+// Fake mobilityd granting consecutive sub-blocks, responses are delivered
+// when the test calls respond_*, as gRPC would on its response thread
+class FakeLeaseClient : public IPBlockLeaseClient {
+ public:
+  void LeaseIPBlockAsync(
+      const IPBlockLeaseRequest& request,
+      const std::function<void(Status, IPBlockLease)>& callback) override {
+    lease_requests.push_back(request);
+    lease_callbacks.push_back(callback);
+  }
+
+  void RenewIPBlockLeaseAsync(
+      const IPBlockLease& lease,
+      const std::function<void(Status, IPBlockLease)>& callback) override {
+    renewals.push_back(lease);
+    renew_callbacks.push_back(callback);
+  }
+
+  void ListIPBlockLeasesAsync(
+      const IPBlockLeaseHolder& holder,
+      const std::function<void(Status, IPBlockLeaseList)>& callback) override {
+    list_callbacks.push_back(callback);
+  }
+
+  void SyncIPAllocationsAsync(
+      const SyncIPAllocationsRequest& request,
+      const std::function<void(Status, Void)>& callback) override {
+    syncs.push_back(request);
+    sync_callbacks.push_back(callback);
+  }
+
+  IPBlockLease make_lease(uint64_t lease_id, uint32_t prefix_len,
+                          uint32_t expires_in_secs) {
+    IPBlockLease lease;
+    lease.set_lease_id(lease_id);
+    lease.set_holder(HOLDER);
+    lease.set_apn(APN);
+    lease.set_vlan("10");
+    lease.set_expires_in_secs(expires_in_secs);
+    uint32_t net_addr = htonl(LEASE_NET_ADDR + (lease_id - 1) * 256);
+    lease.mutable_block()->set_version(IPBlock::IPV4);
+    lease.mutable_block()->set_net_address(&net_addr, sizeof(net_addr));
+    lease.mutable_block()->set_prefix_len(prefix_len);
+    return lease;
+  }
+
+  void respond_lease(const Status& status, const IPBlockLease& lease) {
+    auto callback = lease_callbacks.front();
+    lease_callbacks.erase(lease_callbacks.begin());
+    callback(status, lease);
+  }
+
+  void respond_sync(const Status& status) {
+    auto callback = sync_callbacks.front();
+    sync_callbacks.erase(sync_callbacks.begin());
+    callback(status, Void());
+  }
+
+  std::vector<IPBlockLeaseRequest> lease_requests;
+  std::vector<std::function<void(Status, IPBlockLease)>> lease_callbacks;
+  std::vector<IPBlockLease> renewals;
+  std::vector<std::function<void(Status, IPBlockLease)>> renew_callbacks;
+  std::vector<std::function<void(Status, IPBlockLeaseList)>> list_callbacks;
+  std::vector<SyncIPAllocationsRequest> syncs;
+  std::vector<std::function<void(Status, Void)>> sync_callbacks;
+};
+
+class DelegatedIPAllocatorTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    config.holder = HOLDER;
+    config.lease_prefix_len = 30;
+    config.low_watermark = 2;
+    config.renew_before_secs = 60;
+    config.max_sync_batch = 2;
+    allocator = std::make_unique<DelegatedIPAllocator>(client, config);
+  }
+
+  FakeLeaseClient client;
+  DelegatedIPAllocatorConfig config;
+  std::unique_ptr<DelegatedIPAllocator> allocator;
+};
+
+TEST_F(DelegatedIPAllocatorTest, TestFallbackUntilLeased) {
+  struct in_addr addr;
+  int vlan = 0;
+
+  // No lease yet, caller falls back to mobilityd and a lease is requested
+  EXPECT_FALSE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  ASSERT_EQ(1, client.lease_requests.size());
+  EXPECT_EQ(APN, client.lease_requests[0].apn());
+  EXPECT_EQ(30, client.lease_requests[0].prefix_len());
+
+  // Only one lease request in flight per APN
+  EXPECT_FALSE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  EXPECT_EQ(1, client.lease_requests.size());
+
+  client.respond_lease(Status::OK, client.make_lease(1, 30, 3600));
+  EXPECT_EQ(4, allocator->free_count(APN));
+
+  EXPECT_TRUE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  EXPECT_EQ(LEASE_NET_ADDR, ntohl(addr.s_addr));
+  EXPECT_EQ(10, vlan);
+  EXPECT_EQ(1, allocator->pending_sync_count());
+}
+
+TEST_F(DelegatedIPAllocatorTest, TestLeaseTopUp) {
+  struct in_addr addr;
+  int vlan = 0;
+  allocator->allocate_ipv4(IMSI, APN, &addr, &vlan);
+  client.respond_lease(Status::OK, client.make_lease(1, 30, 3600));
+
+  // Free addresses drop below the low watermark on the third allocation
+  EXPECT_TRUE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  EXPECT_TRUE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  EXPECT_EQ(1, client.lease_requests.size());
+  EXPECT_TRUE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  EXPECT_EQ(2, client.lease_requests.size());
+
+  client.respond_lease(Status::OK, client.make_lease(2, 30, 3600));
+  EXPECT_EQ(5, allocator->free_count(APN));
+}
+
+TEST_F(DelegatedIPAllocatorTest, TestReleaseAndBatchedSync) {
+  struct in_addr addr;
+  int vlan = 0;
+  allocator->allocate_ipv4(IMSI, APN, &addr, &vlan);
+  client.respond_lease(Status::OK, client.make_lease(1, 30, 3600));
+
+  EXPECT_TRUE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  EXPECT_TRUE(allocator->release_ipv4(IMSI, APN, addr));
+  EXPECT_FALSE(allocator->release_ipv4(IMSI, APN, addr));
+  EXPECT_TRUE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+
+  // Addresses outside of the leases are released through mobilityd
+  struct in_addr other;
+  other.s_addr = htonl(LEASE_NET_ADDR - 1);
+  EXPECT_FALSE(allocator->release_ipv4(IMSI, APN, other));
+
+  EXPECT_EQ(3, allocator->pending_sync_count());
+  allocator->tick();
+  ASSERT_EQ(1, client.syncs.size());
+  EXPECT_EQ(2, client.syncs[0].records_size());
+  EXPECT_FALSE(client.syncs[0].records(0).released());
+  EXPECT_TRUE(client.syncs[0].records(1).released());
+  EXPECT_EQ(1, client.syncs[0].records(0).lease_id());
+
+  // A batch is retried in order on failure
+  client.respond_sync(Status(grpc::UNAVAILABLE, "down"));
+  EXPECT_EQ(3, allocator->pending_sync_count());
+  allocator->tick();
+  ASSERT_EQ(2, client.syncs.size());
+  EXPECT_FALSE(client.syncs[1].records(0).released());
+
+  // The next batch follows as soon as the previous one is acknowledged
+  client.respond_sync(Status::OK);
+  ASSERT_EQ(3, client.syncs.size());
+  EXPECT_EQ(1, client.syncs[2].records_size());
+  client.respond_sync(Status::OK);
+  EXPECT_EQ(0, allocator->pending_sync_count());
+}
+
+TEST_F(DelegatedIPAllocatorTest, TestRenewal) {
+  struct in_addr addr;
+  int vlan = 0;
+  allocator->allocate_ipv4(IMSI, APN, &addr, &vlan);
+  client.respond_lease(Status::OK, client.make_lease(1, 30, 30));
+
+  allocator->tick();
+  ASSERT_EQ(1, client.renewals.size());
+  EXPECT_EQ(1, client.renewals[0].lease_id());
+  // Not renewed twice while the renewal is in flight
+  allocator->tick();
+  EXPECT_EQ(1, client.renewals.size());
+
+  // An expired lease is no longer allocated from
+  client.renew_callbacks[0](Status(grpc::NOT_FOUND, "expired"),
+                            IPBlockLease());
+  EXPECT_EQ(0, allocator->free_count(APN));
+}
+
+TEST_F(DelegatedIPAllocatorTest, TestAllocateAfterExpiry) {
+  struct in_addr addr;
+  int vlan = 0;
+  allocator->allocate_ipv4(IMSI, APN, &addr, &vlan);
+  client.respond_lease(Status::OK, client.make_lease(1, 30, 1));
+  EXPECT_TRUE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+
+  allocator->tick();
+  ASSERT_EQ(1, client.renewals.size());
+  client.renew_callbacks[0](Status(grpc::UNAVAILABLE, "down"),
+                            IPBlockLease());
+
+  // mobilityd returns the sub-block to its pool once the lease expires,
+  // whether or not the renewals reached it
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  struct in_addr other;
+  EXPECT_FALSE(allocator->allocate_ipv4(OTHER_IMSI, APN, &other, &vlan));
+  EXPECT_EQ(0, allocator->free_count(APN));
+  EXPECT_EQ(2, client.lease_requests.size());
+  allocator->tick();
+  EXPECT_EQ(1, client.renewals.size());
+
+  // Addresses still in use are released against the expired lease
+  EXPECT_TRUE(allocator->release_ipv4(IMSI, APN, addr));
+}
+
+TEST_F(DelegatedIPAllocatorTest, TestLeaseRetryBackoff) {
+  config.lease_retry_min_ms = 20;
+  config.lease_retry_max_ms = 40;
+  allocator = std::make_unique<DelegatedIPAllocator>(client, config);
+  struct in_addr addr;
+  int vlan = 0;
+
+  EXPECT_FALSE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  ASSERT_EQ(1, client.lease_requests.size());
+  client.respond_lease(Status(grpc::RESOURCE_EXHAUSTED, "exhausted"),
+                       IPBlockLease());
+
+  // No new request on every miss while backing off
+  EXPECT_FALSE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  EXPECT_EQ(1, client.lease_requests.size());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(25));
+  EXPECT_FALSE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  ASSERT_EQ(2, client.lease_requests.size());
+  client.respond_lease(Status(grpc::RESOURCE_EXHAUSTED, "exhausted"),
+                       IPBlockLease());
+
+  // The delay doubles on consecutive failures
+  std::this_thread::sleep_for(std::chrono::milliseconds(25));
+  EXPECT_FALSE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  EXPECT_EQ(2, client.lease_requests.size());
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  ASSERT_EQ(3, client.lease_requests.size());
+
+  // A granted lease resets the backoff
+  client.respond_lease(Status::OK, client.make_lease(1, 30, 3600));
+  EXPECT_TRUE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  EXPECT_TRUE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  EXPECT_TRUE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  EXPECT_EQ(4, client.lease_requests.size());
+}
+
+TEST_F(DelegatedIPAllocatorTest, TestGetIPv4) {
+  struct in_addr addr;
+  struct in_addr found;
+  int vlan = 0;
+  allocator->allocate_ipv4(IMSI, APN, &addr, &vlan);
+  client.respond_lease(Status::OK, client.make_lease(1, 30, 3600));
+
+  EXPECT_FALSE(allocator->get_ipv4(IMSI, APN, &found));
+  EXPECT_TRUE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  ASSERT_TRUE(allocator->get_ipv4(IMSI, APN, &found));
+  EXPECT_EQ(addr.s_addr, found.s_addr);
+  EXPECT_FALSE(allocator->get_ipv4(OTHER_IMSI, APN, &found));
+  EXPECT_FALSE(allocator->get_ipv4(IMSI, "ims", &found));
+
+  EXPECT_TRUE(allocator->release_ipv4(IMSI, APN, addr));
+  EXPECT_FALSE(allocator->get_ipv4(IMSI, APN, &found));
+}
+
+TEST_F(DelegatedIPAllocatorTest, TestRecovery) {
+  allocator->recover();
+  ASSERT_EQ(1, client.list_callbacks.size());
+
+  // Restored from local UE state while the leases are being recovered
+  struct in_addr restored;
+  restored.s_addr = htonl(LEASE_NET_ADDR + 2);
+  allocator->reserve_ipv4(IMSI, APN, restored);
+
+  // No lease is requested while recovering
+  struct in_addr addr;
+  int vlan = 0;
+  EXPECT_FALSE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  EXPECT_EQ(0, client.lease_requests.size());
+
+  IPBlockLeaseList list;
+  auto lease = client.make_lease(1, 30, 3600);
+  auto entry = lease.add_allocated();
+  uint32_t synced = htonl(LEASE_NET_ADDR);
+  entry->mutable_ip()->set_address(&synced, sizeof(synced));
+  entry->set_apn(APN);
+  entry->mutable_sid()->set_id(OTHER_IMSI);
+  *list.add_leases() = lease;
+  client.list_callbacks[0](Status::OK, list);
+
+  // Recovered assignments are visible to subscriber lookups
+  struct in_addr found;
+  ASSERT_TRUE(allocator->get_ipv4(OTHER_IMSI, APN, &found));
+  EXPECT_EQ(LEASE_NET_ADDR, ntohl(found.s_addr));
+  ASSERT_TRUE(allocator->get_ipv4(IMSI, APN, &found));
+  EXPECT_EQ(LEASE_NET_ADDR + 2, ntohl(found.s_addr));
+
+  EXPECT_EQ(2, allocator->free_count(APN));
+  EXPECT_TRUE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  EXPECT_EQ(LEASE_NET_ADDR + 1, ntohl(addr.s_addr));
+  EXPECT_TRUE(allocator->allocate_ipv4(IMSI, APN, &addr, &vlan));
+  EXPECT_EQ(LEASE_NET_ADDR + 3, ntohl(addr.s_addr));
+}
+
+}  // namespace lte
+}  // namespace magma
@@ -0,0 +1,94 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <set>
+
+#include "lte/gateway/c/core/oai/lib/mobility_client/IPv4BlockAllocator.h"
+
+namespace magma {
+namespace lte {
+
+// 192.168.128.0
+const uint32_t BLOCK_NET_ADDR = 0xc0a88000;
+
+TEST(IPv4BlockAllocatorTest, TestAllocateUntilExhausted) {
+  IPv4BlockAllocator allocator(BLOCK_NET_ADDR, 26);
+  EXPECT_EQ(64, allocator.capacity());
+
+  std::set<uint32_t> allocated;
+  uint32_t addr;
+  while (allocator.allocate(&addr)) {
+    EXPECT_TRUE(allocator.contains(addr));
+    EXPECT_TRUE(allocated.insert(addr).second);
+  }
+  EXPECT_EQ(64, allocated.size());
+  EXPECT_EQ(0, allocator.free_count());
+  EXPECT_EQ(BLOCK_NET_ADDR, *allocated.begin());
+  EXPECT_EQ(BLOCK_NET_ADDR + 63, *allocated.rbegin());
+}
+
+TEST(IPv4BlockAllocatorTest, TestSmallBlock) {
+  IPv4BlockAllocator allocator(BLOCK_NET_ADDR, 30);
+  EXPECT_EQ(4, allocator.capacity());
+
+  uint32_t addr;
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(allocator.allocate(&addr));
+  }
+  EXPECT_FALSE(allocator.allocate(&addr));
+  EXPECT_FALSE(allocator.contains(BLOCK_NET_ADDR + 4));
+}
+
+TEST(IPv4BlockAllocatorTest, TestReleaseAndReuse) {
+  IPv4BlockAllocator allocator(BLOCK_NET_ADDR, 24);
+
+  uint32_t addr;
+  ASSERT_TRUE(allocator.allocate(&addr));
+  EXPECT_TRUE(allocator.is_allocated(addr));
+  EXPECT_TRUE(allocator.release(addr));
+  EXPECT_FALSE(allocator.is_allocated(addr));
+  EXPECT_EQ(256, allocator.free_count());
+
+  // double release and out of block releases are rejected
+  EXPECT_FALSE(allocator.release(addr));
+  EXPECT_FALSE(allocator.release(BLOCK_NET_ADDR - 1));
+  EXPECT_EQ(256, allocator.free_count());
+}
+
+TEST(IPv4BlockAllocatorTest, TestReserve) {
+  IPv4BlockAllocator allocator(BLOCK_NET_ADDR, 30);
+
+  EXPECT_TRUE(allocator.reserve(BLOCK_NET_ADDR + 1));
+  EXPECT_FALSE(allocator.reserve(BLOCK_NET_ADDR + 1));
+  EXPECT_FALSE(allocator.reserve(BLOCK_NET_ADDR + 4));
+  EXPECT_EQ(3, allocator.free_count());
+
+  // reserved addresses are never handed out
+  uint32_t addr;
+  while (allocator.allocate(&addr)) {
+    EXPECT_NE(BLOCK_NET_ADDR + 1, addr);
+  }
+  EXPECT_EQ(0, allocator.free_count());
+}
+
+TEST(IPv4BlockAllocatorTest, TestUnalignedNetAddr) {
+  IPv4BlockAllocator allocator(BLOCK_NET_ADDR + 5, 28);
+  EXPECT_EQ(BLOCK_NET_ADDR, allocator.net_addr());
+  EXPECT_TRUE(allocator.contains(BLOCK_NET_ADDR));
+  EXPECT_FALSE(allocator.contains(BLOCK_NET_ADDR + 16));
+}
+
+}  // namespace lte
+}  // namespace magma
@@ -13,6 +13,12 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
 extern "C" {
 #include "lte/gateway/c/core/oai/common/dynamic_memory_check.h"
 #define CHECK_PROTOTYPE_ONLY
@@ -23,6 +29,7 @@ extern "C" {
 #include "lte/gateway/c/core/oai/common/itti_free_defined_msg.h"
 #include "lte/gateway/c/core/oai/include/s11_messages_types.h"
 #include "lte/gateway/c/core/oai/include/s1ap_messages_types.h"
+#include "lte/gateway/c/core/oai/include/sctp_messages_types.h"
 }
 
 const task_info_t tasks_info[] = {
@@ -91,6 +98,28 @@ class MockMmeAppHandler {
 class MockSctpHandler {
  public:
   MOCK_METHOD0(sctpd_send_dl, void());
+
+  // Keep the payload of a downlink message for the test to decode
+  void record_dl(sctp_assoc_id_t assoc_id, std::string payload) {
+    std::lock_guard<std::mutex> lock(dl_mutex_);
+    dl_payloads_.emplace_back(assoc_id, std::move(payload));
+    dl_cv_.notify_all();
+  }
+
+  // Wait for count downlink messages to be sent, returns them in order
+  std::vector<std::pair<sctp_assoc_id_t, std::string>> wait_for_dl(
+      size_t count, std::chrono::milliseconds timeout =
+                        std::chrono::milliseconds(1000)) {
+    std::unique_lock<std::mutex> lock(dl_mutex_);
+    dl_cv_.wait_for(lock, timeout,
+                    [this, count] { return dl_payloads_.size() >= count; });
+    return dl_payloads_;
+  }
+
+ private:
+  std::mutex dl_mutex_;
+  std::condition_variable dl_cv_;
+  std::vector<std::pair<sctp_assoc_id_t, std::string>> dl_payloads_;
 };
 
 class MockS6aHandler {
@@ -12,6 +12,11 @@
  */
 #include "lte/gateway/c/core/oai/test/mock_tasks/mock_tasks.h"
 
+extern "C" {
+#include "lte/gateway/c/core/oai/common/shared_buffer.h"
+#include "lte/gateway/c/core/oai/lib/bstr/bstrlib.h"
+}
+
 task_zmq_ctx_t task_zmq_ctx_sctp;
 static std::shared_ptr<MockSctpHandler> sctp_handler_;
 
@@ -28,6 +33,17 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
     } break;
 
     case SCTP_DATA_REQ: {
+      sctp_data_req_t* data_req = &SCTP_DATA_REQ(received_message_p);
+      std::string payload;
+      if (data_req->shared_payload) {
+        payload.assign(reinterpret_cast<const char*>(
+                           shared_buffer_data(data_req->shared_payload)),
+                       shared_buffer_length(data_req->shared_payload));
+      } else if (data_req->payload) {
+        payload.assign(reinterpret_cast<const char*>(bdata(data_req->payload)),
+                       blength(data_req->payload));
+      }
+      sctp_handler_->record_dl(data_req->assoc_id, std::move(payload));
       sctp_handler_->sctpd_send_dl();
     } break;
 
@@ -0,0 +1,353 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string.h>
+#include <vector>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/dynamic_memory_check.h"
+#include "lte/gateway/c/core/oai/common/nas_decode_arena.h"
+#include "lte/gateway/c/core/oai/lib/3gpp/3gpp_24.008.h"
+#include "lte/gateway/c/core/oai/tasks/nas/api/network/nas_message.h"
+}
+
+/*
+ * Heap allocations are counted by interposing the libc allocator in this
+ * test binary, only while allocation_counting is set on the calling thread.
+ */
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t nmemb, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+}
+
+static __thread bool allocation_counting = false;
+static __thread uint64_t allocation_count = 0;
+
+extern "C" void* malloc(size_t size) {
+  if (allocation_counting) allocation_count++;
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t nmemb, size_t size) {
+  if (allocation_counting) allocation_count++;
+  return __libc_calloc(nmemb, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+  if (allocation_counting) allocation_count++;
+  return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void* ptr) { __libc_free(ptr); }
+
+namespace magma {
+namespace lte {
+
+// PDUs recorded on a test network, plain NAS so that no security context is
+// needed to decode them
+static const std::vector<uint8_t> kAttachRequest = {
+    0x07, 0x41, 0x71, 0x08, 0x09, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x10,
+    0x02, 0xe0, 0xe0, 0x00, 0x18, 0x02, 0x01, 0xd0, 0x11, 0x28, 0x09, 0x08,
+    0x69, 0x6e, 0x74, 0x65, 0x72, 0x6e, 0x65, 0x74, 0x27, 0x07, 0x80, 0x00,
+    0x0d, 0x00, 0x00, 0x0a, 0x00, 0x40, 0x08, 0x04, 0x02, 0x60, 0x04, 0x00,
+    0x02, 0x1f, 0x02, 0x5c, 0x0a, 0x00};
+static const std::vector<uint8_t> kIdentityResponse = {
+    0x07, 0x56, 0x08, 0x09, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x10};
+static const std::vector<uint8_t> kAuthenticationResponse = {
+    0x07, 0x53, 0x08, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+static const std::vector<uint8_t> kAuthenticationFailure = {
+    0x07, 0x5c, 0x15, 0x30, 0x0e, 0x01, 0x02, 0x03, 0x04, 0x05,
+    0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e};
+static const std::vector<uint8_t> kUplinkNasTransport = {
+    0x07, 0x63, 0x08, 0x19, 0x01, 0x05, 0x00, 0x01, 0x02, 0x03, 0x04};
+static const std::vector<uint8_t> kPdnConnectivityRequest = {
+    0x02, 0x01, 0xd0, 0x11, 0x28, 0x09, 0x08, 0x69, 0x6e, 0x74, 0x65, 0x72,
+    0x6e, 0x65, 0x74, 0x27, 0x07, 0x80, 0x00, 0x0d, 0x00, 0x00, 0x0a, 0x00};
+static const std::vector<uint8_t> kEsmInformationResponse = {
+    0x02, 0x01, 0xda, 0x28, 0x09, 0x08, 0x69, 0x6e, 0x74, 0x65, 0x72,
+    0x6e, 0x65, 0x74, 0x27, 0x07, 0x80, 0x00, 0x0d, 0x00, 0x00, 0x0a, 0x00};
+
+static bool bstring_equals(const_bstring b, const std::vector<uint8_t>& pdu,
+                           size_t offset, size_t length) {
+  return b && (size_t)blength(b) == length &&
+         memcmp(b->data, pdu.data() + offset, length) == 0;
+}
+
+// Free what decoding a recorded PDU allocated, like the message handlers do
+static void release_decoded(nas_message_t* msg) {
+  if (msg->plain.emm.header.protocol_discriminator ==
+      EPS_SESSION_MANAGEMENT_MESSAGE) {
+    ESM_msg* esm = &msg->plain.esm;
+    if (esm->header.message_type == PDN_CONNECTIVITY_REQUEST) {
+      bdestroy_wrapper(&esm->pdn_connectivity_request.accesspointname);
+      clear_protocol_configuration_options(
+          &esm->pdn_connectivity_request.protocolconfigurationoptions);
+    } else if (esm->header.message_type == ESM_INFORMATION_RESPONSE) {
+      bdestroy_wrapper(&esm->esm_information_response.accesspointname);
+      clear_protocol_configuration_options(
+          &esm->esm_information_response.protocolconfigurationoptions);
+    }
+    return;
+  }
+  EMM_msg* emm = &msg->plain.emm;
+  switch (emm->header.message_type) {
+    case ATTACH_REQUEST:
+      bdestroy_wrapper(&emm->attach_request.esmmessagecontainer);
+      bdestroy_wrapper(&emm->attach_request.supportedcodecs);
+      break;
+    case AUTHENTICATION_RESPONSE:
+      bdestroy_wrapper(
+          &emm->authentication_response.authenticationresponseparameter);
+      break;
+    case AUTHENTICATION_FAILURE:
+      bdestroy_wrapper(
+          &emm->authentication_failure.authenticationfailureparameter);
+      break;
+    case UPLINK_NAS_TRANSPORT:
+      bdestroy_wrapper(&emm->uplink_nas_transport.nasmessagecontainer);
+      break;
+    default:
+      break;
+  }
+}
+
+static int decode(const std::vector<uint8_t>& pdu, nas_message_t* msg,
+                  nas_decode_arena_t* arena) {
+  nas_message_decode_status_t status = {0};
+  memset(msg, 0, sizeof(*msg));
+  if (arena) {
+    return nas_message_decode_borrowed(pdu.data(), msg, pdu.size(), nullptr,
+                                       &status, arena);
+  }
+  return nas_message_decode(pdu.data(), msg, pdu.size(), nullptr, &status);
+}
+
+TEST(NasDecodeArenaTest, TestAllocSpillsToChunks) {
+  nas_decode_arena_t arena;
+  nas_decode_arena_init(&arena);
+
+  allocation_counting = true;
+  allocation_count = 0;
+  size_t inline_allocated = 0;
+  while (inline_allocated + 64 <= NAS_DECODE_ARENA_INLINE_SIZE) {
+    void* ptr = nas_decode_arena_alloc(&arena, 50);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 16, 0);
+    memset(ptr, 0xab, 50);
+    inline_allocated += 64;
+  }
+  EXPECT_EQ(allocation_count, 0);
+  EXPECT_EQ(arena.heap_allocations, 0);
+
+  // Past the inline buffer, small allocations share a chunk and large ones
+  // get their own
+  nas_decode_arena_alloc(&arena, 100);
+  nas_decode_arena_alloc(&arena, 100);
+  EXPECT_EQ(arena.heap_allocations, 1);
+  memset(nas_decode_arena_alloc(&arena, 2 * NAS_DECODE_ARENA_CHUNK_SIZE), 0,
+         2 * NAS_DECODE_ARENA_CHUNK_SIZE);
+  EXPECT_EQ(arena.heap_allocations, 2);
+  allocation_counting = false;
+  EXPECT_EQ(allocation_count, 2);
+
+  nas_decode_arena_release(&arena);
+  EXPECT_EQ(arena.chunks, nullptr);
+  EXPECT_EQ(arena.inline_used, 0);
+}
+
+TEST(NasDecodeArenaTest, TestBorrowedAndOwnedBstrings) {
+  const uint8_t data[] = {'i', 'n', 't', 'e', 'r', 'n', 'e', 't'};
+  nas_decode_arena_t arena;
+  nas_decode_arena_init(&arena);
+
+  bstring slice = nas_decode_arena_slice(&arena, data, sizeof(data));
+  EXPECT_TRUE(nas_decode_bstring_is_borrowed(slice));
+  EXPECT_EQ(slice->data, data);
+  // The handlers' bdestroy calls must leave borrowed strings alone
+  EXPECT_EQ(bdestroy(slice), BSTR_ERR);
+  EXPECT_EQ(blength(slice), sizeof(data));
+
+  bstring copy = nas_decode_arena_copy(&arena, data, sizeof(data));
+  EXPECT_NE(copy->data, data);
+  EXPECT_STREQ(bdata(copy), "internet");
+
+  bstring owned = nas_decode_bstring_own(&copy);
+  EXPECT_EQ(copy, nullptr);
+  EXPECT_FALSE(nas_decode_bstring_is_borrowed(owned));
+  EXPECT_STREQ(bdata(owned), "internet");
+
+  // Heap strings are stolen, not copied
+  bstring heap = blk2bstr(data, sizeof(data));
+  bstring stolen = heap;
+  EXPECT_EQ(nas_decode_bstring_own(&heap), stolen);
+  EXPECT_EQ(heap, nullptr);
+
+  // blk2bstr only borrows while an arena is entered, and arenas nest
+  nas_decode_arena_t inner;
+  nas_decode_arena_init(&inner);
+  EXPECT_EQ(nas_decode_arena_current(), nullptr);
+  nas_decode_arena_enter(&arena);
+  nas_decode_arena_enter(&inner);
+  EXPECT_EQ(nas_decode_arena_current(), &inner);
+  bstring borrowed = nas_decode_blk2bstr(data, sizeof(data));
+  nas_decode_arena_leave(&inner);
+  EXPECT_EQ(nas_decode_arena_current(), &arena);
+  nas_decode_arena_leave(&arena);
+  EXPECT_TRUE(nas_decode_bstring_is_borrowed(borrowed));
+  EXPECT_EQ(inner.allocations, 2);
+  bstring allocated = nas_decode_blk2bstr(data, sizeof(data));
+  EXPECT_FALSE(nas_decode_bstring_is_borrowed(allocated));
+
+  bdestroy(owned);
+  bdestroy(stolen);
+  bdestroy(allocated);
+  nas_decode_arena_release(&inner);
+  nas_decode_arena_release(&arena);
+}
+
+TEST(NasDecodeArenaTest, TestBorrowedDecodeMatchesHeapDecode) {
+  nas_message_t heap_msg;
+  nas_message_t borrowed_msg;
+  nas_decode_arena_t arena;
+  nas_decode_arena_init(&arena);
+
+  ASSERT_EQ(decode(kAttachRequest, &heap_msg, nullptr), kAttachRequest.size());
+  allocation_counting = true;
+  allocation_count = 0;
+  ASSERT_EQ(decode(kAttachRequest, &borrowed_msg, &arena),
+            kAttachRequest.size());
+  allocation_counting = false;
+  EXPECT_EQ(allocation_count, 0);
+
+  attach_request_msg* heap_attach = &heap_msg.plain.emm.attach_request;
+  attach_request_msg* borrowed_attach = &borrowed_msg.plain.emm.attach_request;
+  EXPECT_TRUE(
+      nas_decode_bstring_is_borrowed(borrowed_attach->esmmessagecontainer));
+  EXPECT_TRUE(bstring_equals(borrowed_attach->esmmessagecontainer,
+                             kAttachRequest, 17, 24));
+  EXPECT_TRUE(bstring_equals(heap_attach->esmmessagecontainer, kAttachRequest,
+                             17, 24));
+  EXPECT_TRUE(bstring_equals(borrowed_attach->supportedcodecs, kAttachRequest,
+                             43, 8));
+  EXPECT_TRUE(
+      bstring_equals(heap_attach->supportedcodecs, kAttachRequest, 43, 8));
+
+  // The decoded IEs no longer depend on the received PDU
+  std::vector<uint8_t> pdu = kAttachRequest;
+  nas_message_t msg;
+  nas_decode_arena_t pdu_arena;
+  nas_decode_arena_init(&pdu_arena);
+  ASSERT_EQ(decode(pdu, &msg, &pdu_arena), pdu.size());
+  std::fill(pdu.begin(), pdu.end(), 0);
+  EXPECT_TRUE(bstring_equals(msg.plain.emm.attach_request.esmmessagecontainer,
+                             kAttachRequest, 17, 24));
+  nas_decode_arena_release(&pdu_arena);
+
+  // APN labels are decoded into the arena
+  ASSERT_EQ(decode(kPdnConnectivityRequest, &borrowed_msg, &arena),
+            kPdnConnectivityRequest.size());
+  bstring apn = borrowed_msg.plain.esm.pdn_connectivity_request.accesspointname;
+  EXPECT_TRUE(nas_decode_bstring_is_borrowed(apn));
+  EXPECT_STREQ(bdata(apn), "internet");
+  protocol_configuration_options_t* pco =
+      &borrowed_msg.plain.esm.pdn_connectivity_request
+           .protocolconfigurationoptions;
+  EXPECT_EQ(pco->num_protocol_or_container_id, 2);
+
+  // Owning an IE leaves a heap copy valid after the arena is released
+  bstring owned = nas_decode_bstring_own(
+      &borrowed_msg.plain.esm.pdn_connectivity_request.accesspointname);
+  nas_decode_arena_release(&arena);
+  EXPECT_STREQ(bdata(owned), "internet");
+  bdestroy(owned);
+
+  release_decoded(&heap_msg);
+}
+
+/*
+ * Decodes the recorded PDUs of the common UE initiated messages with heap
+ * allocated IEs and with IEs borrowed from a per-message arena, reporting the
+ * heap allocations and the decode time per message.
+ */
+TEST(NasDecodeArenaTest, BenchmarkRecordedPdus) {
+  const int kIterations = 20000;
+  const std::vector<std::pair<const char*, const std::vector<uint8_t>*>>
+      recorded = {
+          {"AttachRequest", &kAttachRequest},
+          {"IdentityResponse", &kIdentityResponse},
+          {"AuthenticationResponse", &kAuthenticationResponse},
+          {"AuthenticationFailure", &kAuthenticationFailure},
+          {"UplinkNasTransport", &kUplinkNasTransport},
+          {"PdnConnectivityRequest", &kPdnConnectivityRequest},
+          {"EsmInformationResponse", &kEsmInformationResponse},
+      };
+
+  std::cout << std::left << std::setw(24) << "message" << std::right
+            << std::setw(14) << "heap allocs" << std::setw(12) << "heap ns"
+            << std::setw(16) << "arena allocs" << std::setw(12) << "arena ns"
+            << std::endl;
+  for (const auto& entry : recorded) {
+    const std::vector<uint8_t>& pdu = *entry.second;
+    nas_message_t msg;
+
+    allocation_count = 0;
+    allocation_counting = true;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; i++) {
+      ASSERT_EQ(decode(pdu, &msg, nullptr), pdu.size()) << entry.first;
+      release_decoded(&msg);
+    }
+    auto heap_elapsed = std::chrono::steady_clock::now() - start;
+    allocation_counting = false;
+    uint64_t heap_allocations = allocation_count;
+
+    allocation_count = 0;
+    allocation_counting = true;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; i++) {
+      nas_decode_arena_t arena;
+      nas_decode_arena_init(&arena);
+      ASSERT_EQ(decode(pdu, &msg, &arena), pdu.size()) << entry.first;
+      // The handlers' frees are no-ops on borrowed IEs
+      release_decoded(&msg);
+      nas_decode_arena_release(&arena);
+    }
+    auto arena_elapsed = std::chrono::steady_clock::now() - start;
+    allocation_counting = false;
+    uint64_t arena_allocations = allocation_count;
+
+    std::cout << std::left << std::setw(24) << entry.first << std::right
+              << std::setw(14) << (double)heap_allocations / kIterations
+              << std::setw(12)
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     heap_elapsed)
+                         .count() /
+                     kIterations
+              << std::setw(16) << (double)arena_allocations / kIterations
+              << std::setw(12)
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     arena_elapsed)
+                         .count() /
+                     kIterations
+              << std::endl;
+    EXPECT_EQ(arena_allocations, 0) << entry.first;
+  }
+}
+
+}  // namespace lte
+}  // namespace magma
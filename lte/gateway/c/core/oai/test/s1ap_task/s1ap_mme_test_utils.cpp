@@ -72,6 +72,42 @@ status_code_e generate_s1_setup_request_pdu(S1ap_S1AP_PDU_t* pdu_s1) {
   return pdu_rc;
 }
 
+void generate_enb_configuration_update_pdu(S1ap_S1AP_PDU_t* pdu,
+                                           const uint8_t plmn_tbcd[3],
+                                           tac_t tac) {
+  memset(pdu, 0, sizeof(*pdu));
+  pdu->present = S1ap_S1AP_PDU_PR_initiatingMessage;
+  pdu->choice.initiatingMessage.procedureCode =
+      S1ap_ProcedureCode_id_ENBConfigurationUpdate;
+  pdu->choice.initiatingMessage.criticality = S1ap_Criticality_reject;
+  pdu->choice.initiatingMessage.value.present =
+      S1ap_InitiatingMessage__value_PR_ENBConfigurationUpdate;
+  S1ap_ENBConfigurationUpdate_t* out =
+      &pdu->choice.initiatingMessage.value.choice.ENBConfigurationUpdate;
+
+  S1ap_ENBConfigurationUpdateIEs_t* ie =
+      (S1ap_ENBConfigurationUpdateIEs_t*)calloc(
+          1, sizeof(S1ap_ENBConfigurationUpdateIEs_t));
+  ie->id = S1ap_ProtocolIE_ID_id_SupportedTAs;
+  ie->criticality = S1ap_Criticality_reject;
+  ie->value.present = S1ap_ENBConfigurationUpdateIEs__value_PR_SupportedTAs;
+
+  S1ap_SupportedTAs_Item_t* ta_item =
+      (S1ap_SupportedTAs_Item_t*)calloc(1, sizeof(S1ap_SupportedTAs_Item_t));
+  ta_item->tAC.buf = (uint8_t*)calloc(2, sizeof(uint8_t));
+  ta_item->tAC.size = 2;
+  ta_item->tAC.buf[0] = tac >> 8;
+  ta_item->tAC.buf[1] = tac & 0xff;
+  S1ap_PLMNidentity_t* plmn =
+      (S1ap_PLMNidentity_t*)calloc(1, sizeof(S1ap_PLMNidentity_t));
+  plmn->buf = (uint8_t*)calloc(3, sizeof(uint8_t));
+  plmn->size = 3;
+  memcpy(plmn->buf, plmn_tbcd, 3);
+  ASN_SEQUENCE_ADD(&ta_item->broadcastPLMNs.list, plmn);
+  ASN_SEQUENCE_ADD(&ie->value.choice.SupportedTAs.list, ta_item);
+  ASN_SEQUENCE_ADD(&out->protocolIEs.list, ie);
+}
+
 void handle_mme_ue_id_notification(s1ap_state_t* s, sctp_assoc_id_t assoc_id) {
   MessageDef* message_p =
       itti_alloc_new_message(TASK_MME_APP, MME_APP_S1AP_MME_UE_ID_NOTIFICATION);
@@ -31,6 +31,11 @@ status_code_e send_s1ap_close_sctp_association(sctp_assoc_id_t assoc_id);
 
 status_code_e generate_s1_setup_request_pdu(S1ap_S1AP_PDU_t* pdu_s1);
 
+// eNB Configuration Update carrying a single Supported TA
+void generate_enb_configuration_update_pdu(S1ap_S1AP_PDU_t* pdu,
+                                           const uint8_t plmn_tbcd[3],
+                                           tac_t tac);
+
 status_code_e send_s1ap_erab_rel_cmd(s1ap_state_t* state,
                                      mme_ue_s1ap_id_t ue_id,
                                      enb_ue_s1ap_id_t enb_ue_id);
@@ -25,6 +25,7 @@ extern "C" {
 #include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_mme_decoder.h"
 #include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_mme_handlers.h"
 #include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_mme_nas_procedures.h"
+#include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_paging_index.h"
 }
 
 #include "lte/gateway/c/core/oai/test/s1ap_task/s1ap_mme_test_utils.h"
@@ -2225,5 +2226,187 @@ TEST_F(S1apMmeHandlersTest, HandleS1apNasNonDelivery) {
   ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1ap_S1AP_PDU, &pdu_s1);
 }
 
+static void ignore_paging_target(sctp_assoc_id_t assoc_id, void* arg) {}
+
+// Decode a downlink message recorded by the SCTP mock
+static status_code_e decode_dl_pdu(const std::string& payload,
+                                   S1ap_S1AP_PDU_t* pdu) {
+  memset(pdu, 0, sizeof(*pdu));
+  bstring raw = blk2bstr(payload.data(), payload.size());
+  status_code_e rc = s1ap_mme_decode_pdu(pdu, raw);
+  bdestroy_wrapper(&raw);
+  return rc;
+}
+
+TEST_F(S1apMmeHandlersTest, HandleEnbConfigurationUpdate) {
+  ASSERT_EQ(task_zmq_ctx_main_s1ap.ready, true);
+
+  // S1 Setup Response, then eNB Configuration Update Failure and Acknowledge
+  EXPECT_CALL(*sctp_handler, sctpd_send_dl()).Times(3);
+
+  S1ap_S1AP_PDU_t pdu_s1;
+  memset(&pdu_s1, 0, sizeof(pdu_s1));
+  ASSERT_EQ(RETURNok, generate_s1_setup_request_pdu(&pdu_s1));
+  ASSERT_EQ(RETURNok,
+            s1ap_mme_handle_message(state, assoc_id, stream_id, &pdu_s1));
+  ASSERT_TRUE(is_enb_state_valid(state, assoc_id, S1AP_READY, 0));
+
+  // S1 Setup indexes the eNB for paging
+  enb_description_t* enb = s1ap_state_get_enb(state, assoc_id);
+  ASSERT_NE(enb, nullptr);
+  ASSERT_GT(enb->supported_ta_list.list_count, 0);
+  supported_tai_items_t served = enb->supported_ta_list.supported_tai_items[0];
+  paging_tai_list_t tai_list = {0};
+  tai_list.tai_list[0].plmn = served.bplmns[0];
+  tai_list.tai_list[0].tac = served.tac;
+  EXPECT_EQ(s1ap_paging_index_lookup(&tai_list, 1, ignore_paging_target,
+                                     nullptr),
+            1u);
+
+  // No PLMN in common with the MME, the current TAs are kept
+  const uint8_t unknown_plmn[] = {0x99, 0xf9, 0x99};
+  S1ap_S1AP_PDU_t pdu_update;
+  generate_enb_configuration_update_pdu(&pdu_update, unknown_plmn,
+                                        served.tac + 1);
+  ASSERT_EQ(RETURNok,
+            s1ap_mme_handle_message(state, assoc_id, stream_id, &pdu_update));
+  EXPECT_EQ(enb->supported_ta_list.list_count, 1);
+  EXPECT_EQ(enb->supported_ta_list.supported_tai_items[0].tac, served.tac);
+  EXPECT_EQ(s1ap_paging_index_lookup(&tai_list, 1, ignore_paging_target,
+                                     nullptr),
+            1u);
+  ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1ap_S1AP_PDU, &pdu_update);
+
+  auto sent = sctp_handler->wait_for_dl(2);
+  ASSERT_EQ(sent.size(), 2);
+  EXPECT_EQ(sent[1].first, assoc_id);
+  S1ap_S1AP_PDU_t pdu_sent;
+  ASSERT_EQ(RETURNok, decode_dl_pdu(sent[1].second, &pdu_sent));
+  ASSERT_EQ(pdu_sent.present, S1ap_S1AP_PDU_PR_unsuccessfulOutcome);
+  ASSERT_EQ(pdu_sent.choice.unsuccessfulOutcome.procedureCode,
+            S1ap_ProcedureCode_id_ENBConfigurationUpdate);
+  ASSERT_EQ(pdu_sent.choice.unsuccessfulOutcome.value.present,
+            S1ap_UnsuccessfulOutcome__value_PR_ENBConfigurationUpdateFailure);
+  S1ap_ENBConfigurationUpdateFailure_t* failure =
+      &pdu_sent.choice.unsuccessfulOutcome.value.choice
+           .ENBConfigurationUpdateFailure;
+  S1ap_ENBConfigurationUpdateFailureIEs_t* failure_ie = NULL;
+  S1AP_FIND_PROTOCOLIE_BY_ID(S1ap_ENBConfigurationUpdateFailureIEs_t,
+                             failure_ie, failure,
+                             S1ap_ProtocolIE_ID_id_Cause, true);
+  ASSERT_NE(failure_ie, nullptr);
+  ASSERT_EQ(failure_ie->value.choice.Cause.present, S1ap_Cause_PR_misc);
+  EXPECT_EQ(failure_ie->value.choice.Cause.choice.misc,
+            S1ap_CauseMisc_unknown_PLMN);
+  S1AP_FIND_PROTOCOLIE_BY_ID(S1ap_ENBConfigurationUpdateFailureIEs_t,
+                             failure_ie, failure,
+                             S1ap_ProtocolIE_ID_id_TimeToWait, false);
+  ASSERT_NE(failure_ie, nullptr);
+  EXPECT_EQ(failure_ie->value.choice.TimeToWait, S1ap_TimeToWait_v20s);
+  ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1ap_S1AP_PDU, &pdu_sent);
+
+  // Served PLMN (001/01, as in the S1 Setup Request) is acknowledged
+  const uint8_t served_plmn[] = {0x00, 0xf1, 0x10};
+  generate_enb_configuration_update_pdu(&pdu_update, served_plmn, served.tac);
+  ASSERT_EQ(RETURNok,
+            s1ap_mme_handle_message(state, assoc_id, stream_id, &pdu_update));
+  EXPECT_EQ(s1ap_paging_index_lookup(&tai_list, 1, ignore_paging_target,
+                                     nullptr),
+            1u);
+
+  sent = sctp_handler->wait_for_dl(3);
+  ASSERT_EQ(sent.size(), 3);
+  EXPECT_EQ(sent[2].first, assoc_id);
+  ASSERT_EQ(RETURNok, decode_dl_pdu(sent[2].second, &pdu_sent));
+  ASSERT_EQ(pdu_sent.present, S1ap_S1AP_PDU_PR_successfulOutcome);
+  EXPECT_EQ(pdu_sent.choice.successfulOutcome.procedureCode,
+            S1ap_ProcedureCode_id_ENBConfigurationUpdate);
+  EXPECT_EQ(
+      pdu_sent.choice.successfulOutcome.value.present,
+      S1ap_SuccessfulOutcome__value_PR_ENBConfigurationUpdateAcknowledge);
+  ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1ap_S1AP_PDU, &pdu_sent);
+
+  // Removing the eNB drops it from the paging index
+  s1ap_remove_enb(state, enb);
+  EXPECT_EQ(s1ap_paging_index_lookup(&tai_list, 1, ignore_paging_target,
+                                     nullptr),
+            0u);
+
+  ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1ap_S1AP_PDU, &pdu_update);
+  ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1ap_S1AP_PDU, &pdu_s1);
+}
+
+TEST_F(S1apMmeHandlersTest, HandleMmeOverloadInd) {
+  ASSERT_EQ(task_zmq_ctx_main_s1ap.ready, true);
+
+  // S1 Setup Response and Overload Start to the eNB, S1 Setup Response and
+  // replayed Overload Start once it sets up again, then Overload Stop
+  EXPECT_CALL(*sctp_handler, sctpd_send_dl()).Times(5);
+
+  S1ap_S1AP_PDU_t pdu_s1;
+  memset(&pdu_s1, 0, sizeof(pdu_s1));
+  ASSERT_EQ(RETURNok, generate_s1_setup_request_pdu(&pdu_s1));
+  ASSERT_EQ(RETURNok,
+            s1ap_mme_handle_message(state, assoc_id, stream_id, &pdu_s1));
+  ASSERT_TRUE(is_enb_state_valid(state, assoc_id, S1AP_READY, 0));
+
+  itti_s1ap_mme_overload_ind_t overload_ind = {0};
+  overload_ind.overload_start = true;
+  overload_ind.traffic_reduction_percent = 50;
+  ASSERT_EQ(RETURNok, s1ap_handle_mme_overload_ind(state, &overload_ind));
+
+  auto sent = sctp_handler->wait_for_dl(2);
+  ASSERT_EQ(sent.size(), 2);
+  EXPECT_EQ(sent[1].first, assoc_id);
+  S1ap_S1AP_PDU_t pdu_sent;
+  ASSERT_EQ(RETURNok, decode_dl_pdu(sent[1].second, &pdu_sent));
+  ASSERT_EQ(pdu_sent.present, S1ap_S1AP_PDU_PR_initiatingMessage);
+  ASSERT_EQ(pdu_sent.choice.initiatingMessage.procedureCode,
+            S1ap_ProcedureCode_id_OverloadStart);
+  S1ap_OverloadStart_t* overload_start =
+      &pdu_sent.choice.initiatingMessage.value.choice.OverloadStart;
+  S1ap_OverloadStartIEs_t* ie = NULL;
+  S1AP_FIND_PROTOCOLIE_BY_ID(S1ap_OverloadStartIEs_t, ie, overload_start,
+                             S1ap_ProtocolIE_ID_id_OverloadResponse, true);
+  ASSERT_NE(ie, nullptr);
+  EXPECT_EQ(ie->value.choice.OverloadResponse.choice.overloadAction,
+            S1ap_OverloadAction_reject_rrc_cr_signalling);
+  S1AP_FIND_PROTOCOLIE_BY_ID(
+      S1ap_OverloadStartIEs_t, ie, overload_start,
+      S1ap_ProtocolIE_ID_id_TrafficLoadReductionIndication, true);
+  ASSERT_NE(ie, nullptr);
+  EXPECT_EQ(ie->value.choice.TrafficLoadReductionIndication, 50);
+  ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1ap_S1AP_PDU, &pdu_sent);
+
+  // An eNB setting up during the overload gets it right after its response.
+  // The same eNB id replaces the first association.
+  sctp_assoc_id_t late_assoc_id = 2;
+  setup_new_association(state, late_assoc_id);
+  ASSERT_EQ(RETURNok, s1ap_mme_handle_message(state, late_assoc_id, stream_id,
+                                              &pdu_s1));
+  sent = sctp_handler->wait_for_dl(4);
+  ASSERT_EQ(sent.size(), 4);
+  EXPECT_EQ(sent[3].first, late_assoc_id);
+  ASSERT_EQ(RETURNok, decode_dl_pdu(sent[3].second, &pdu_sent));
+  ASSERT_EQ(pdu_sent.present, S1ap_S1AP_PDU_PR_initiatingMessage);
+  EXPECT_EQ(pdu_sent.choice.initiatingMessage.procedureCode,
+            S1ap_ProcedureCode_id_OverloadStart);
+  ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1ap_S1AP_PDU, &pdu_sent);
+
+  overload_ind.overload_start = false;
+  overload_ind.traffic_reduction_percent = 0;
+  ASSERT_EQ(RETURNok, s1ap_handle_mme_overload_ind(state, &overload_ind));
+  sent = sctp_handler->wait_for_dl(5);
+  ASSERT_EQ(sent.size(), 5);
+  EXPECT_EQ(sent[4].first, late_assoc_id);
+  ASSERT_EQ(RETURNok, decode_dl_pdu(sent[4].second, &pdu_sent));
+  ASSERT_EQ(pdu_sent.present, S1ap_S1AP_PDU_PR_initiatingMessage);
+  EXPECT_EQ(pdu_sent.choice.initiatingMessage.procedureCode,
+            S1ap_ProcedureCode_id_OverloadStop);
+  ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1ap_S1AP_PDU, &pdu_sent);
+
+  ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1ap_S1AP_PDU, &pdu_s1);
+}
+
 }  // namespace lte
 }  // namespace magma
@@ -0,0 +1,240 @@
+/*
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/dynamic_memory_check.h"
+#include "lte/gateway/c/core/oai/common/shared_buffer.h"
+#include "lte/gateway/c/core/oai/lib/bstr/bstrlib.h"
+#include "lte/gateway/c/core/oai/lib/hashtable/hashtable.h"
+#include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_paging_index.h"
+}
+
+namespace magma {
+namespace lte {
+
+namespace {
+
+plmn_t make_plmn(uint8_t mnc_digit2) {
+  plmn_t plmn = {0};
+  plmn.mcc_digit1 = 0;
+  plmn.mcc_digit2 = 0;
+  plmn.mcc_digit3 = 1;
+  plmn.mnc_digit1 = 0;
+  plmn.mnc_digit2 = mnc_digit2;
+  plmn.mnc_digit3 = 0xf;
+  return plmn;
+}
+
+void add_ta(enb_description_t* enb, tac_t tac, const plmn_t& plmn) {
+  supported_tai_items_t* item =
+      &enb->supported_ta_list
+           .supported_tai_items[enb->supported_ta_list.list_count++];
+  item->tac = tac;
+  item->bplmns[item->bplmnlist_count++] = plmn;
+}
+
+paging_tai_list_t make_tai_list(
+    const std::vector<std::pair<tac_t, plmn_t>>& tais) {
+  paging_tai_list_t tai_list = {0};
+  // numoftac is the number of TAIs beyond the first one
+  tai_list.numoftac = tais.size() - 1;
+  for (size_t idx = 0; idx < tais.size(); idx++) {
+    tai_list.tai_list[idx].tac = tais[idx].first;
+    tai_list.tai_list[idx].plmn = tais[idx].second;
+  }
+  return tai_list;
+}
+
+void collect_assoc(sctp_assoc_id_t assoc_id, void* arg) {
+  static_cast<std::vector<sctp_assoc_id_t>*>(arg)->push_back(assoc_id);
+}
+
+void count_assoc(sctp_assoc_id_t assoc_id, void* arg) {
+  (*static_cast<uint64_t*>(arg)) += assoc_id;
+}
+
+std::vector<sctp_assoc_id_t> lookup(const paging_tai_list_t& tai_list) {
+  std::vector<sctp_assoc_id_t> targets;
+  uint32_t num_targets =
+      s1ap_paging_index_lookup(&tai_list, 1, collect_assoc, &targets);
+  EXPECT_EQ(num_targets, targets.size());
+  std::sort(targets.begin(), targets.end());
+  return targets;
+}
+
+}  // namespace
+
+class S1apPagingIndexTest : public ::testing::Test {
+ protected:
+  void SetUp() override { s1ap_paging_index_clear(); }
+  void TearDown() override { s1ap_paging_index_clear(); }
+
+  enb_description_t* new_enb(sctp_assoc_id_t assoc_id) {
+    enbs_.emplace_back(new enb_description_t());
+    enbs_.back()->sctp_assoc_id = assoc_id;
+    enbs_.back()->s1_state = S1AP_READY;
+    return enbs_.back().get();
+  }
+
+  std::vector<std::unique_ptr<enb_description_t>> enbs_;
+};
+
+TEST_F(S1apPagingIndexTest, TestLookupReportsEachServingEnbOnce) {
+  plmn_t plmn = make_plmn(1);
+  enb_description_t* enb1 = new_enb(1);
+  add_ta(enb1, 1, plmn);
+  add_ta(enb1, 2, plmn);
+  enb_description_t* enb2 = new_enb(2);
+  add_ta(enb2, 2, plmn);
+  enb_description_t* enb3 = new_enb(3);
+  add_ta(enb3, 3, plmn);
+  s1ap_paging_index_update_enb(enb1);
+  s1ap_paging_index_update_enb(enb2);
+  s1ap_paging_index_update_enb(enb3);
+  EXPECT_EQ(s1ap_paging_index_num_tais(), 3u);
+
+  paging_tai_list_t tai_list = make_tai_list({{1, plmn}, {2, plmn}});
+  EXPECT_EQ(lookup(tai_list), std::vector<sctp_assoc_id_t>({1, 2}));
+}
+
+TEST_F(S1apPagingIndexTest, TestLookupMatchesPlmnAndTacOfTheSameTai) {
+  enb_description_t* enb = new_enb(1);
+  add_ta(enb, 1, make_plmn(1));
+  add_ta(enb, 2, make_plmn(2));
+  s1ap_paging_index_update_enb(enb);
+
+  // The TAC of one supported TA with the PLMN of another is not a served TAI
+  paging_tai_list_t tai_list = make_tai_list({{1, make_plmn(2)}});
+  EXPECT_TRUE(lookup(tai_list).empty());
+
+  // A TAI other than the first one of the list still matches
+  tai_list = make_tai_list({{7, make_plmn(1)}, {2, make_plmn(2)}});
+  EXPECT_EQ(lookup(tai_list), std::vector<sctp_assoc_id_t>({1}));
+}
+
+TEST_F(S1apPagingIndexTest, TestUpdateAndRemoveEnb) {
+  plmn_t plmn = make_plmn(1);
+  enb_description_t* enb = new_enb(1);
+  add_ta(enb, 1, plmn);
+  s1ap_paging_index_update_enb(enb);
+
+  // eNB Configuration Update moving the eNB from TAC 1 to TAC 2
+  enb->supported_ta_list.list_count = 0;
+  add_ta(enb, 2, plmn);
+  s1ap_paging_index_update_enb(enb);
+
+  paging_tai_list_t tac1 = make_tai_list({{1, plmn}});
+  paging_tai_list_t tac2 = make_tai_list({{2, plmn}});
+  EXPECT_TRUE(lookup(tac1).empty());
+  EXPECT_EQ(lookup(tac2), std::vector<sctp_assoc_id_t>({1}));
+  EXPECT_EQ(s1ap_paging_index_num_tais(), 1u);
+
+  s1ap_paging_index_remove_enb(1);
+  EXPECT_TRUE(lookup(tac2).empty());
+  EXPECT_EQ(s1ap_paging_index_num_tais(), 0u);
+}
+
+TEST_F(S1apPagingIndexTest, TestRebuildIndexesReadyEnbs) {
+  s1ap_state_t state = {0};
+  bstring name = bfromcstr("paging_index_test_enbs");
+  hashtable_ts_init(&state.enbs, 16, nullptr, free_wrapper, name);
+  bdestroy(name);
+
+  plmn_t plmn = make_plmn(1);
+  for (sctp_assoc_id_t assoc_id = 1; assoc_id <= 2; assoc_id++) {
+    enb_description_t* enb =
+        (enb_description_t*)calloc(1, sizeof(enb_description_t));
+    enb->sctp_assoc_id = assoc_id;
+    enb->s1_state = assoc_id == 1 ? S1AP_READY : S1AP_INIT;
+    add_ta(enb, 1, plmn);
+    hashtable_ts_insert(&state.enbs, (const hash_key_t)assoc_id, enb);
+  }
+  s1ap_paging_index_rebuild(&state);
+
+  paging_tai_list_t tai_list = make_tai_list({{1, plmn}});
+  EXPECT_EQ(lookup(tai_list), std::vector<sctp_assoc_id_t>({1}));
+  hashtable_ts_destroy(&state.enbs);
+}
+
+// Per page cost has to depend on the number of eNBs paged, not on the
+// number of eNBs connected
+TEST_F(S1apPagingIndexTest, TestPagingCostIndependentOfEnbCount) {
+  constexpr int kEnbsPerTac = 4;
+  constexpr int kNumPages = 20000;
+  plmn_t plmn = make_plmn(1);
+
+  auto page_cost_ns = [&](int num_enbs) {
+    s1ap_paging_index_clear();
+    enbs_.clear();
+    for (int i = 0; i < num_enbs; i++) {
+      enb_description_t* enb = new_enb(i + 1);
+      add_ta(enb, 1 + i / kEnbsPerTac, plmn);
+      s1ap_paging_index_update_enb(enb);
+    }
+    uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int page = 0; page < kNumPages; page++) {
+      tac_t tac = 1 + page % (num_enbs / kEnbsPerTac);
+      paging_tai_list_t tai_list = make_tai_list({{tac, plmn}});
+      EXPECT_EQ(s1ap_paging_index_lookup(&tai_list, 1, count_assoc, &checksum),
+                static_cast<uint32_t>(kEnbsPerTac));
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GT(checksum, 0u);
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+               .count() /
+           kNumPages;
+  };
+
+  int64_t cost_100 = page_cost_ns(100);
+  int64_t cost_5000 = page_cost_ns(5000);
+  std::cout << "Paging target selection: " << cost_100 << " ns/page with 100 "
+            << "eNBs, " << cost_5000 << " ns/page with 5000 eNBs" << std::endl;
+  // A scan would be 50 times slower; leave room for cache effects
+  EXPECT_LT(cost_5000, 5 * cost_100 + 1000);
+}
+
+TEST(SharedBufferTest, TestPayloadFreedWithLastReference) {
+  uint8_t* data = (uint8_t*)malloc(4);
+  memcpy(data, "page", 4);
+  shared_buffer_t* buffer = shared_buffer_wrap(data, 4);
+  EXPECT_EQ(shared_buffer_refcount(buffer), 1u);
+
+  // One reference per target association, as taken by SCTP_DATA_REQ
+  std::vector<shared_buffer_t*> refs;
+  for (int i = 0; i < 3; i++) refs.push_back(shared_buffer_ref(buffer));
+  EXPECT_EQ(shared_buffer_refcount(buffer), 4u);
+  shared_buffer_unref(buffer);
+  for (shared_buffer_t* ref : refs) {
+    EXPECT_EQ(memcmp(shared_buffer_data(ref), "page", 4), 0);
+    EXPECT_EQ(shared_buffer_length(ref), 4u);
+  }
+  for (size_t i = 0; i + 1 < refs.size(); i++) shared_buffer_unref(refs[i]);
+  EXPECT_EQ(shared_buffer_refcount(refs.back()), 1u);
+  // Freed here; leak checkers flag a missing release
+  shared_buffer_unref(refs.back());
+}
+
+}  // namespace lte
+}  // namespace magma
@@ -0,0 +1,469 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/log.h"
+#include "lte/gateway/c/core/oai/common/security_types.h"
+#include "lte/gateway/c/core/oai/lib/secu/secu_defs.h"
+}
+
+#include "lte/gateway/c/core/oai/tasks/s6a/s6a_local_hss.h"
+#include "lte/gateway/c/core/oai/tasks/s6a/s6a_subscriber_store.h"
+
+using magma::lte::CoreNetworkType;
+using magma::lte::LocalSubscriber;
+using magma::lte::LTESubscription;
+using magma::lte::S6aLocalHss;
+using magma::lte::S6aSubscriberStore;
+using magma::lte::SubscriberData;
+using magma::lte::SubscriberID;
+
+namespace {
+
+std::string bytes(const char* hex) {
+  std::string result;
+  for (size_t i = 0; hex[i] && hex[i + 1]; i += 2) {
+    result.push_back(
+        static_cast<char>(std::stoi(std::string(hex + i, 2), nullptr, 16)));
+  }
+  return result;
+}
+
+const uint8_t* data(const std::string& s) {
+  return reinterpret_cast<const uint8_t*>(s.data());
+}
+
+std::string str(const uint8_t* buf, size_t len) {
+  return std::string(reinterpret_cast<const char*>(buf), len);
+}
+
+const char* IMSI = "001010000000001";
+const std::string KEY = bytes("8baf473f2f8fd09487cccbd7097c6862");
+const std::string OP = bytes("11111111111111111111111111111111");
+const std::string OPC = bytes("8e27b6af0e692e750f32667a3b14605d");
+const std::string AMF = bytes("8000");
+// Serving network 208.95
+const std::string PLMN = bytes("02f859");
+
+std::string store_path() {
+  return testing::TempDir() + "s6a_local_hss_test.store";
+}
+
+void remove_store() {
+  unlink(store_path().c_str());
+  unlink((store_path() + ".tmp").c_str());
+}
+
+LocalSubscriber make_subscriber(const std::string& imsi, uint64_t next_seq) {
+  LocalSubscriber subscriber = {};
+  strncpy(subscriber.imsi, imsi.c_str(), IMSI_BCD_DIGITS_MAX);
+  subscriber.next_seq = next_seq;
+  return subscriber;
+}
+
+SubscriberData make_subscriber_data(const char* imsi, uint64_t next_seq) {
+  SubscriberData data;
+  data.mutable_sid()->set_id(imsi);
+  data.mutable_sid()->set_type(SubscriberID::IMSI);
+  data.mutable_lte()->set_state(LTESubscription::ACTIVE);
+  data.mutable_lte()->set_auth_algo(LTESubscription::MILENAGE);
+  data.mutable_lte()->set_auth_key(KEY);
+  data.mutable_state()->set_lte_auth_next_seq(next_seq);
+  return data;
+}
+
+void set_plmn(plmn_t* plmn) {
+  plmn->mcc_digit1 = 2;
+  plmn->mcc_digit2 = 0;
+  plmn->mcc_digit3 = 8;
+  plmn->mnc_digit1 = 9;
+  plmn->mnc_digit2 = 5;
+  plmn->mnc_digit3 = 0xf;
+}
+
+void make_air(const char* imsi, s6a_auth_info_req_t* air) {
+  memset(air, 0, sizeof(*air));
+  strncpy(air->imsi, imsi, IMSI_BCD_DIGITS_MAX);
+  air->imsi_length = strlen(imsi);
+  air->nb_of_vectors = 1;
+  set_plmn(&air->visited_plmn);
+}
+
+void seq_to_sqn(uint64_t seq, uint8_t* sqn) {
+  uint64_t value = seq << 5;
+  for (int i = SQN_LENGTH_OCTETS - 1; i >= 0; i--) {
+    sqn[i] = value & 0xff;
+    value >>= 8;
+  }
+}
+
+// SQN of the AUTN of a vector
+uint64_t vector_seq(const eutran_vector_t& vector) {
+  uint8_t ak[AK_LENGTH_OCTETS];
+  milenage_f2345(data(KEY), data(OPC), vector.rand, NULL, NULL, NULL, ak,
+                 NULL);
+  uint64_t sqn = 0;
+  for (int i = 0; i < SQN_LENGTH_OCTETS; i++) {
+    sqn = (sqn << 8) | (vector.autn[i] ^ ak[i]);
+  }
+  return sqn >> 5;
+}
+
+}  // namespace
+
+class S6aSubscriberStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove_store();
+    ASSERT_TRUE(store_.open(store_path(), 16));
+  }
+
+  void TearDown() override {
+    store_.close();
+    remove_store();
+  }
+
+  S6aSubscriberStore store_;
+};
+
+TEST_F(S6aSubscriberStoreTest, test_upsert_lookup) {
+  LocalSubscriber subscriber = {};
+  EXPECT_FALSE(store_.lookup(IMSI, &subscriber));
+  EXPECT_FALSE(store_.contains(IMSI));
+  EXPECT_TRUE(store_.upsert(make_subscriber(IMSI, 5)));
+  EXPECT_EQ(store_.size(), 1);
+  EXPECT_TRUE(store_.contains(IMSI));
+
+  // SEQs are reserved past the copied out one
+  EXPECT_TRUE(store_.lookup(IMSI, &subscriber, 2));
+  EXPECT_EQ(subscriber.next_seq, 5);
+  EXPECT_TRUE(store_.lookup(IMSI, &subscriber));
+  EXPECT_EQ(subscriber.next_seq, 7);
+
+  // A sync never moves the SEQ back
+  EXPECT_TRUE(store_.upsert(make_subscriber(IMSI, 3)));
+  EXPECT_TRUE(store_.lookup(IMSI, &subscriber));
+  EXPECT_EQ(subscriber.next_seq, 7);
+  EXPECT_TRUE(store_.upsert(make_subscriber(IMSI, 10)));
+  EXPECT_TRUE(store_.lookup(IMSI, &subscriber));
+  EXPECT_EQ(subscriber.next_seq, 10);
+  EXPECT_EQ(store_.size(), 1);
+
+  EXPECT_FALSE(store_.upsert(make_subscriber("00101abc", 0)));
+  EXPECT_FALSE(store_.upsert(make_subscriber("", 0)));
+}
+
+TEST_F(S6aSubscriberStoreTest, test_grow_and_remove) {
+  const int nb_subscribers = 1000;
+  for (int i = 0; i < nb_subscribers; i++) {
+    EXPECT_TRUE(store_.upsert(make_subscriber(std::to_string(1000000 + i), i)));
+  }
+  EXPECT_EQ(store_.size(), nb_subscribers);
+  EXPECT_GE(store_.capacity() * 3, nb_subscribers * 4);
+
+  for (int i = 0; i < nb_subscribers; i += 2) {
+    EXPECT_TRUE(store_.remove(std::to_string(1000000 + i).c_str()));
+  }
+  EXPECT_EQ(store_.size(), nb_subscribers / 2);
+  LocalSubscriber subscriber = {};
+  for (int i = 0; i < nb_subscribers; i++) {
+    EXPECT_EQ(store_.lookup(std::to_string(1000000 + i).c_str(), &subscriber),
+              i % 2 == 1);
+    if (i % 2 == 1) {
+      EXPECT_EQ(subscriber.next_seq, i);
+    }
+  }
+}
+
+TEST_F(S6aSubscriberStoreTest, test_sync) {
+  EXPECT_TRUE(store_.upsert(make_subscriber("1000001", 0)));
+  EXPECT_TRUE(store_.upsert(make_subscriber("1000002", 0)));
+  EXPECT_TRUE(store_.upsert(make_subscriber("1000003", 0)));
+
+  store_.begin_sync();
+  EXPECT_TRUE(store_.upsert(make_subscriber("1000002", 0)));
+  EXPECT_TRUE(store_.upsert(make_subscriber("1000004", 0)));
+  EXPECT_EQ(store_.end_sync(), 2);
+
+  LocalSubscriber subscriber = {};
+  EXPECT_FALSE(store_.lookup("1000001", &subscriber));
+  EXPECT_TRUE(store_.lookup("1000002", &subscriber));
+  EXPECT_FALSE(store_.lookup("1000003", &subscriber));
+  EXPECT_TRUE(store_.lookup("1000004", &subscriber));
+  EXPECT_EQ(store_.size(), 2);
+}
+
+TEST_F(S6aSubscriberStoreTest, test_reopen) {
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(store_.upsert(make_subscriber(std::to_string(1000000 + i), 0)));
+  }
+  LocalSubscriber subscriber = {};
+  EXPECT_TRUE(store_.lookup("1000042", &subscriber, 42));
+  uint32_t capacity = store_.capacity();
+  store_.close();
+
+  // The SEQs reserved before a restart are not reused
+  ASSERT_TRUE(store_.open(store_path(), 16));
+  EXPECT_EQ(store_.size(), 100);
+  EXPECT_EQ(store_.capacity(), capacity);
+  EXPECT_TRUE(store_.lookup("1000042", &subscriber));
+  EXPECT_EQ(subscriber.next_seq, 42);
+}
+
+class S6aLocalHssTest : public ::testing::Test {
+ protected:
+  S6aLocalHssTest()
+      : hss_(OP, AMF, LOCAL_HSS_DEFAULT_MAX_UL_BIT_RATE,
+             LOCAL_HSS_DEFAULT_MAX_DL_BIT_RATE) {}
+
+  void SetUp() override {
+    remove_store();
+    ASSERT_TRUE(hss_.open(store_path(), 16));
+  }
+
+  void TearDown() override {
+    hss_.close();
+    remove_store();
+  }
+
+  S6aLocalHss hss_;
+};
+
+TEST_F(S6aLocalHssTest, test_authentication_info) {
+  ASSERT_TRUE(hss_.add_subscriber(make_subscriber_data(IMSI, 7351)));
+  s6a_auth_info_req_t air;
+  s6a_auth_info_ans_t aia = {};
+  make_air(IMSI, &air);
+
+  hss_.authentication_info(&air, &aia);
+  ASSERT_EQ(aia.result.present, S6A_RESULT_BASE);
+  ASSERT_EQ(aia.result.choice.base, DIAMETER_SUCCESS);
+  ASSERT_EQ(aia.auth_info.nb_of_vectors, 1);
+
+  // Same vector as Milenage with the OPc of the OP and the first SEQ
+  uint8_t sqn[SQN_LENGTH_OCTETS];
+  eutran_vector_t expected = {};
+  const eutran_vector_t& vector = aia.auth_info.eutran_vector[0];
+  seq_to_sqn(7351, sqn);
+  milenage_generate_eutran_vector(data(KEY), data(OPC), data(AMF), sqn,
+                                  data(PLMN), vector.rand, &expected);
+  EXPECT_EQ(str(vector.xres.data, vector.xres.size),
+            str(expected.xres.data, expected.xres.size));
+  EXPECT_EQ(str(vector.autn, AUTN_LENGTH_OCTETS),
+            str(expected.autn, AUTN_LENGTH_OCTETS));
+  EXPECT_EQ(str(vector.kasme, KASME_LENGTH_OCTETS),
+            str(expected.kasme, KASME_LENGTH_OCTETS));
+
+  // Each vector consumes a SEQ, RANDs are not reused
+  s6a_auth_info_ans_t next_aia = {};
+  hss_.authentication_info(&air, &next_aia);
+  ASSERT_EQ(next_aia.result.choice.base, DIAMETER_SUCCESS);
+  EXPECT_EQ(vector_seq(next_aia.auth_info.eutran_vector[0]), 7352);
+  EXPECT_NE(str(next_aia.auth_info.eutran_vector[0].rand, RAND_LENGTH_OCTETS),
+            str(vector.rand, RAND_LENGTH_OCTETS));
+  LocalSubscriber subscriber = {};
+  EXPECT_TRUE(hss_.store().lookup(IMSI, &subscriber));
+  EXPECT_EQ(subscriber.next_seq, 7353);
+}
+
+TEST_F(S6aLocalHssTest, test_resync) {
+  ASSERT_TRUE(hss_.add_subscriber(make_subscriber_data(IMSI, 7351)));
+  s6a_auth_info_req_t air;
+  s6a_auth_info_ans_t aia = {};
+  make_air(IMSI, &air);
+  hss_.authentication_info(&air, &aia);
+  ASSERT_EQ(aia.result.choice.base, DIAMETER_SUCCESS);
+
+  // AUTS of the USIM for a SEQ_MS, RAND || AUTS in the resync parameter
+  auto set_resync = [&air](uint64_t seq_ms) {
+    const uint8_t amf_star[AMF_LENGTH_OCTETS] = {0x00, 0x00};
+    uint8_t* rand = air.resync_param;
+    uint8_t* auts = air.resync_param + RAND_LENGTH_OCTETS;
+    uint8_t sqn_ms[SQN_LENGTH_OCTETS];
+    uint8_t ak_star[AK_LENGTH_OCTETS];
+    memset(rand, 0x5a, RAND_LENGTH_OCTETS);
+    seq_to_sqn(seq_ms, sqn_ms);
+    milenage_f2345(data(KEY), data(OPC), rand, NULL, NULL, NULL, NULL,
+                   ak_star);
+    for (int i = 0; i < SQN_LENGTH_OCTETS; i++) {
+      auts[i] = sqn_ms[i] ^ ak_star[i];
+    }
+    milenage_f1(data(KEY), data(OPC), rand, sqn_ms, amf_star, NULL,
+                auts + SQN_LENGTH_OCTETS);
+    air.re_synchronization = 1;
+  };
+
+  // The USIM is ahead, vectors restart past its SEQ
+  set_resync(20000);
+  s6a_auth_info_ans_t resync_aia = {};
+  hss_.authentication_info(&air, &resync_aia);
+  ASSERT_EQ(resync_aia.result.present, S6A_RESULT_BASE);
+  ASSERT_EQ(resync_aia.result.choice.base, DIAMETER_SUCCESS);
+  EXPECT_EQ(vector_seq(resync_aia.auth_info.eutran_vector[0]), 20001);
+
+  // The USIM is slightly behind, it should have accepted the vector
+  set_resync(19000);
+  s6a_auth_info_ans_t behind_aia = {};
+  hss_.authentication_info(&air, &behind_aia);
+  EXPECT_EQ(behind_aia.result.present, S6A_RESULT_EXPERIMENTAL);
+  EXPECT_EQ(behind_aia.result.choice.experimental,
+            DIAMETER_AUTHENTICATION_REJECTED);
+
+  // Invalid MAC-S
+  set_resync(30000);
+  air.resync_param[RAND_LENGTH_OCTETS + AUTS_LENGTH_OCTETS - 1] ^= 0x01;
+  s6a_auth_info_ans_t invalid_aia = {};
+  hss_.authentication_info(&air, &invalid_aia);
+  EXPECT_EQ(invalid_aia.result.present, S6A_RESULT_EXPERIMENTAL);
+  EXPECT_EQ(invalid_aia.result.choice.experimental,
+            DIAMETER_AUTHENTICATION_REJECTED);
+  LocalSubscriber subscriber = {};
+  EXPECT_TRUE(hss_.store().lookup(IMSI, &subscriber));
+  EXPECT_EQ(subscriber.next_seq, 20002);
+}
+
+TEST_F(S6aLocalHssTest, test_authentication_info_errors) {
+  s6a_auth_info_req_t air;
+  s6a_auth_info_ans_t aia = {};
+  make_air(IMSI, &air);
+  // Subscribers missing from the store are left to subscriberdb
+  EXPECT_FALSE(hss_.authentication_info(&air, &aia));
+  EXPECT_EQ(aia.result.choice.base, 0);
+
+  SubscriberData data = make_subscriber_data(IMSI, 0);
+  data.mutable_lte()->set_state(LTESubscription::INACTIVE);
+  ASSERT_TRUE(hss_.add_subscriber(data));
+  aia = {};
+  EXPECT_TRUE(hss_.authentication_info(&air, &aia));
+  EXPECT_EQ(aia.result.present, S6A_RESULT_EXPERIMENTAL);
+  EXPECT_EQ(aia.result.choice.experimental,
+            DIAMETER_ERROR_UNAUTHORIZED_SERVICE);
+
+  data = make_subscriber_data(IMSI, 0);
+  data.mutable_sub_network()->add_forbidden_network_types(
+      CoreNetworkType::NT_EPC);
+  ASSERT_TRUE(hss_.add_subscriber(data));
+  aia = {};
+  EXPECT_TRUE(hss_.authentication_info(&air, &aia));
+  EXPECT_EQ(aia.result.present, S6A_RESULT_EXPERIMENTAL);
+  EXPECT_EQ(aia.result.choice.experimental,
+            DIAMETER_ERROR_UNAUTHORIZED_SERVICE);
+
+  data = make_subscriber_data(IMSI, 0);
+  data.mutable_lte()->set_auth_opc(bytes("0102"));
+  ASSERT_TRUE(hss_.add_subscriber(data));
+  aia = {};
+  EXPECT_TRUE(hss_.authentication_info(&air, &aia));
+  EXPECT_EQ(aia.result.present, S6A_RESULT_EXPERIMENTAL);
+  EXPECT_EQ(aia.result.choice.experimental, DIAMETER_AUTHENTICATION_REJECTED);
+}
+
+TEST_F(S6aLocalHssTest, test_update_location) {
+  s6a_update_location_req_t ulr = {};
+  s6a_update_location_ans_t ula = {};
+  strncpy(ulr.imsi, IMSI, IMSI_BCD_DIGITS_MAX);
+  ulr.imsi_length = strlen(IMSI);
+  EXPECT_FALSE(hss_.update_location(&ulr, &ula));
+  EXPECT_EQ(ula.result.choice.base, 0);
+
+  SubscriberData data = make_subscriber_data(IMSI, 0);
+  data.mutable_non_3gpp()->set_msisdn("12345");
+  auto apn = data.mutable_non_3gpp()->add_apn_config();
+  apn->set_service_selection("magma.ipv4");
+  apn->mutable_qos_profile()->set_class_id(9);
+  apn->mutable_qos_profile()->set_priority_level(15);
+  apn->mutable_qos_profile()->set_preemption_capability(true);
+  apn->mutable_ambr()->set_max_bandwidth_ul(100000000);
+  apn->mutable_ambr()->set_max_bandwidth_dl(200000000);
+  apn = data.mutable_non_3gpp()->add_apn_config();
+  apn->set_service_selection("ims");
+  apn->mutable_qos_profile()->set_class_id(5);
+  apn->set_pdn(magma::lte::APNConfiguration::IPV4V6);
+  ASSERT_TRUE(hss_.add_subscriber(data));
+
+  ula = {};
+  EXPECT_TRUE(hss_.update_location(&ulr, &ula));
+  ASSERT_EQ(ula.result.present, S6A_RESULT_BASE);
+  ASSERT_EQ(ula.result.choice.base, DIAMETER_SUCCESS);
+  const subscription_data_t& sub = ula.subscription_data;
+  EXPECT_EQ(sub.subscribed_ambr.br_ul, LOCAL_HSS_DEFAULT_MAX_UL_BIT_RATE);
+  EXPECT_EQ(sub.subscribed_ambr.br_dl, LOCAL_HSS_DEFAULT_MAX_DL_BIT_RATE);
+  EXPECT_EQ(str(reinterpret_cast<const uint8_t*>(sub.msisdn),
+                sub.msisdn_length),
+            bytes("2143f5"));
+  EXPECT_EQ(sub.apn_config_profile.context_identifier, 0);
+  ASSERT_EQ(sub.apn_config_profile.nb_apns, 2);
+
+  const apn_configuration_t& internet =
+      sub.apn_config_profile.apn_configuration[0];
+  EXPECT_EQ(internet.context_identifier, 0);
+  EXPECT_EQ(std::string(internet.service_selection,
+                        internet.service_selection_length),
+            "magma.ipv4");
+  EXPECT_EQ(internet.pdn_type, IPv4);
+  EXPECT_EQ(internet.subscribed_qos.qci, 9);
+  EXPECT_EQ(
+      internet.subscribed_qos.allocation_retention_priority.priority_level,
+      15);
+  EXPECT_EQ(
+      internet.subscribed_qos.allocation_retention_priority.pre_emp_capability,
+      1);
+  EXPECT_EQ(internet.ambr.br_ul, 100000000);
+  EXPECT_EQ(internet.ambr.br_dl, 200000000);
+
+  const apn_configuration_t& ims = sub.apn_config_profile.apn_configuration[1];
+  EXPECT_EQ(ims.context_identifier, 1);
+  EXPECT_EQ(std::string(ims.service_selection, ims.service_selection_length),
+            "ims");
+  EXPECT_EQ(ims.pdn_type, IPv4_AND_v6);
+  EXPECT_EQ(ims.subscribed_qos.qci, 5);
+}
+
+TEST_F(S6aLocalHssTest, test_update_location_custom_profile) {
+  s6a_update_location_req_t ulr = {};
+  strncpy(ulr.imsi, IMSI, IMSI_BCD_DIGITS_MAX);
+  ulr.imsi_length = strlen(IMSI);
+
+  SubscriberData data = make_subscriber_data(IMSI, 0);
+  data.set_sub_profile("default");
+  ASSERT_TRUE(hss_.add_subscriber(data));
+  s6a_update_location_ans_t ula = {};
+  EXPECT_TRUE(hss_.update_location(&ulr, &ula));
+
+  // Only subscriberdb knows the AMBR of other profiles
+  data.set_sub_profile("gold");
+  ASSERT_TRUE(hss_.add_subscriber(data));
+  ula = {};
+  EXPECT_FALSE(hss_.update_location(&ulr, &ula));
+  EXPECT_EQ(ula.result.choice.base, 0);
+  EXPECT_TRUE(hss_.store().contains(IMSI));
+
+  // AIRs do not depend on the profile
+  s6a_auth_info_req_t air;
+  s6a_auth_info_ans_t aia = {};
+  make_air(IMSI, &air);
+  EXPECT_TRUE(hss_.authentication_info(&air, &aia));
+  EXPECT_EQ(aia.result.choice.base, DIAMETER_SUCCESS);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  OAILOG_INIT("S6A", OAILOG_LEVEL_DEBUG, MAX_LOG_PROTOS);
+  return RUN_ALL_TESTS();
+}
@@ -440,3 +440,136 @@ TEST_F(SgwS8ConfigAndCreateMock, validate_release_access_bearer_proc) {
   // verify that eNB information has been cleared
   ASSERT_TRUE(is_num_s1_bearers_valid(sgw_state, imsi64, 0));
 }
+
+/* TC validates that an attached UE survives a restart of the SGW_S8 task: its
+ * pdn session is recovered from the stored state into the sgw_s11_teid and
+ * imsi hashtables, its tunnels are restored and the session is then released
+ * with the S8 peer
+ */
+TEST_F(SgwS8ConfigAndCreateMock, recover_pdn_session_after_restart) {
+  sgw_state_t* sgw_state = get_sgw_state(false);
+  std::condition_variable cv;
+  std::mutex mx;
+  std::unique_lock<std::mutex> lock(mx);
+
+  uint32_t temporary_create_session_procedure_id = 0;
+  sgw_eps_bearer_context_information_t* sgw_pdn_session =
+      sgw_create_bearer_context_information_in_collection(
+          sgw_state, &temporary_create_session_procedure_id);
+
+  itti_s11_create_session_request_t session_req = {0};
+  fill_itti_csreq(&session_req, default_eps_bearer_id);
+  sgw_update_bearer_context_information_on_csreq(sgw_state, sgw_pdn_session,
+                                                 &session_req, imsi64);
+
+  s8_create_session_response_t csresp = {0};
+  fill_itti_csrsp(&csresp, temporary_create_session_procedure_id,
+                  sgw_s8_up_teid++);
+  // UE address with a zero byte, 192.168.0.1
+  csresp.paa.ipv4_address.s_addr = 0x0100a8c0;
+  EXPECT_CALL(*mme_app_handler, mme_app_handle_create_sess_resp())
+      .Times(1)
+      .WillOnce(ReturnFromAsyncTask(&cv));
+  EXPECT_EQ(sgw_s8_handle_create_session_response(sgw_state, &csresp, imsi64),
+            RETURNok);
+  cv.wait_for(lock, std::chrono::milliseconds(END_OF_TESTCASE_SLEEP_MS));
+
+  itti_s11_modify_bearer_request_t mbr_req = {0};
+  fill_modify_bearer_request(&mbr_req, csresp.context_teid,
+                             csresp.eps_bearer_id);
+  EXPECT_CALL(*mme_app_handler, mme_app_handle_modify_bearer_rsp())
+      .Times(1)
+      .WillOnce(ReturnFromAsyncTask(&cv));
+  sgw_s8_handle_modify_bearer_request(sgw_state, &mbr_req, imsi64);
+  cv.wait_for(lock, std::chrono::milliseconds(END_OF_TESTCASE_SLEEP_MS));
+
+  // State as written to db
+  spgw_ue_context_t* ue_context_p = nullptr;
+  ASSERT_EQ(hashtable_ts_get(sgw_state->imsi_ue_context_htbl, imsi64,
+                             reinterpret_cast<void**>(&ue_context_p)),
+            HASH_TABLE_OK);
+  magma::lte::oai::SgwUeContext ue_proto;
+  magma::lte::SgwStateConverter::ue_to_proto(ue_context_p, &ue_proto);
+  ASSERT_EQ(ue_proto.sgw_bearer_context_size(), 1);
+  magma::lte::oai::SgwState state_proto;
+  magma::lte::SgwStateConverter::state_to_proto(sgw_state, &state_proto);
+  sgw_eps_bearer_ctxt_t bearer_before_restart = *sgw_cm_get_eps_bearer_entry(
+      &sgw_pdn_session->pdn_connection, csresp.eps_bearer_id);
+  teid_t s1u_teid = sgw_state->s1u_teid;
+
+  // Restart drops every context held in memory
+  sgw_state_exit();
+  sgw_state_init(false, config);
+  sgw_state = get_sgw_state(false);
+  EXPECT_EQ(sgw_get_sgw_eps_bearer_context(csresp.context_teid), nullptr);
+  EXPECT_FALSE(is_num_s1_bearers_valid(sgw_state, imsi64, 1));
+
+  magma::lte::SgwStateConverter::proto_to_state(state_proto, sgw_state);
+  EXPECT_EQ(sgw_state->s1u_teid, s1u_teid);
+  EXPECT_EQ(magma::lte::SgwStateManager::getInstance().recover_ue_state(
+                imsi64, ue_proto),
+            RETURNok);
+  EXPECT_EQ(sgw_s8_restore_gtp_up_tunnels(), 1);
+
+  // Recovered pdn session is found by sgw_s11_teid and by imsi
+  sgw_pdn_session = sgw_get_sgw_eps_bearer_context(csresp.context_teid);
+  ASSERT_TRUE(sgw_pdn_session != nullptr);
+  EXPECT_TRUE(is_num_s1_bearers_valid(sgw_state, imsi64, 1));
+  EXPECT_EQ(sgw_pdn_session->imsi64, imsi64);
+  EXPECT_EQ(sgw_pdn_session->mme_teid_S11,
+            session_req.sender_fteid_for_cp.teid);
+  EXPECT_EQ(strcmp(sgw_pdn_session->pdn_connection.apn_in_use, "NO APN"), 0);
+  EXPECT_EQ(sgw_pdn_session->pdn_connection.default_bearer,
+            session_req.default_ebi);
+  EXPECT_EQ(sgw_pdn_session->pdn_connection.p_gw_teid_S5_S8_cp,
+            csresp.pgw_s8_cp_teid.teid);
+  EXPECT_EQ(sgw_pdn_session->pdn_connection.s_gw_teid_S5_S8_cp,
+            csresp.context_teid);
+
+  sgw_eps_bearer_ctxt_t* bearer_ctx_p = sgw_cm_get_eps_bearer_entry(
+      &sgw_pdn_session->pdn_connection, csresp.eps_bearer_id);
+  ASSERT_TRUE(bearer_ctx_p != nullptr);
+  EXPECT_EQ(bearer_ctx_p->paa.ipv4_address.s_addr,
+            csresp.paa.ipv4_address.s_addr);
+  EXPECT_EQ(bearer_ctx_p->p_gw_teid_S5_S8_up,
+            csresp.bearer_context[0].pgw_s8_up.teid);
+  EXPECT_EQ(bearer_ctx_p->p_gw_address_in_use_up.address.ipv4_address.s_addr,
+            bearer_before_restart.p_gw_address_in_use_up.address.ipv4_address
+                .s_addr);
+  EXPECT_EQ(bearer_ctx_p->s_gw_teid_S5_S8_up,
+            bearer_before_restart.s_gw_teid_S5_S8_up);
+  EXPECT_EQ(bearer_ctx_p->s_gw_teid_S1u_S12_S4_up,
+            bearer_before_restart.s_gw_teid_S1u_S12_S4_up);
+  EXPECT_EQ(bearer_ctx_p->enb_teid_S1u,
+            mbr_req.bearer_contexts_to_be_modified.bearer_contexts[0]
+                .s1_eNB_fteid.teid);
+
+  // Recovered state converts back to the stored one, so it is not rewritten
+  ue_context_p = nullptr;
+  ASSERT_EQ(hashtable_ts_get(sgw_state->imsi_ue_context_htbl, imsi64,
+                             reinterpret_cast<void**>(&ue_context_p)),
+            HASH_TABLE_OK);
+  magma::lte::oai::SgwUeContext recovered_proto;
+  magma::lte::SgwStateConverter::ue_to_proto(ue_context_p, &recovered_proto);
+  EXPECT_EQ(recovered_proto.SerializeAsString(), ue_proto.SerializeAsString());
+
+  // Recovered session is released with the S8 peer
+  itti_s11_delete_session_request_t ds_req = {0};
+  fill_delete_session_request(&ds_req, csresp.context_teid,
+                              csresp.eps_bearer_id);
+  EXPECT_EQ(
+      sgw_s8_handle_s11_delete_session_request(sgw_state, &ds_req, imsi64),
+      RETURNok);
+
+  s8_delete_session_response_t ds_rsp = {0};
+  fill_delete_session_response(&ds_rsp, csresp.context_teid, REQUEST_ACCEPTED);
+  EXPECT_CALL(*mme_app_handler,
+              mme_app_handle_delete_sess_rsp(check_cause_in_ds_rsp(
+                  REQUEST_ACCEPTED, session_req.sender_fteid_for_cp.teid)))
+      .Times(1)
+      .WillOnce(ReturnFromAsyncTask(&cv));
+  EXPECT_EQ(sgw_s8_handle_delete_session_response(sgw_state, &ds_rsp, imsi64),
+            RETURNok);
+  cv.wait_for(lock, std::chrono::milliseconds(END_OF_TESTCASE_SLEEP_MS));
+  EXPECT_EQ(sgw_get_sgw_eps_bearer_context(csresp.context_teid), nullptr);
+}
@@ -327,7 +327,7 @@ void SgwS8ConfigAndCreateMock::SetUp() {
   task_grpc.detach();
   task_mme_app.detach();
 
-  sgw_s8_init(config);
+  sgw_s8_init(config, false);
   std::this_thread::sleep_for(
       std::chrono::milliseconds(SLEEP_AT_INITIALIZATION_TIME_MS));
 }
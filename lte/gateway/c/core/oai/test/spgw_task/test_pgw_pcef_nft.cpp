@@ -0,0 +1,313 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <gtest/gtest.h>
+#include <linux/netfilter/nf_tables.h>
+#include <linux/netfilter/nfnetlink.h>
+#include <linux/netlink.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/common_defs.h"
+#include "lte/gateway/c/core/oai/include/pgw_types.h"
+#include "lte/gateway/c/core/oai/lib/3gpp/3gpp_24.008.h"
+#include "lte/gateway/c/core/oai/tasks/sgw/pgw_pcef_nft.h"
+}
+
+namespace magma {
+namespace lte {
+
+#define TEST_UE_POOL "192.168.128.0"
+#define TEST_UE_POOL_PREFIX 24
+
+struct nft_msg {
+  uint16_t type;
+  uint16_t flags;
+  uint32_t seq;
+  uint32_t len;
+  std::string chain;
+  std::vector<std::string> exprs;
+};
+
+// Walks the attributes of payload, calling f on each
+template <typename F>
+void for_each_attr(const char* payload, int len, F f) {
+  const struct nlattr* attr = (const struct nlattr*)payload;
+  while (len >= (int)sizeof(*attr) && attr->nla_len >= sizeof(*attr) &&
+         attr->nla_len <= len) {
+    f(attr, (const char*)attr + NLA_HDRLEN, attr->nla_len - NLA_HDRLEN);
+    len -= NLA_ALIGN(attr->nla_len);
+    attr = (const struct nlattr*)((const char*)attr + NLA_ALIGN(attr->nla_len));
+  }
+}
+
+std::vector<nft_msg> parse_batch(const pcef_nft_batch_t* batch) {
+  std::vector<nft_msg> msgs;
+  int len = batch->len;
+  const struct nlmsghdr* nlh = (const struct nlmsghdr*)batch->buf;
+  for (; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+    nft_msg msg;
+    msg.type = nlh->nlmsg_type;
+    msg.flags = nlh->nlmsg_flags;
+    msg.seq = nlh->nlmsg_seq;
+    msg.len = nlh->nlmsg_len;
+    if (msg.type == ((NFNL_SUBSYS_NFTABLES << 8) | NFT_MSG_NEWRULE)) {
+      const char* attrs =
+          (const char*)NLMSG_DATA(nlh) + NLMSG_ALIGN(sizeof(struct nfgenmsg));
+      int attrs_len = nlh->nlmsg_len - NLMSG_HDRLEN -
+                      NLMSG_ALIGN(sizeof(struct nfgenmsg));
+      for_each_attr(attrs, attrs_len, [&](const struct nlattr* attr,
+                                          const char* data, int data_len) {
+        int type = attr->nla_type & NLA_TYPE_MASK;
+        if (type == NFTA_RULE_CHAIN) msg.chain = data;
+        if (type != NFTA_RULE_EXPRESSIONS) return;
+        for_each_attr(data, data_len, [&](const struct nlattr*,
+                                          const char* elem, int elem_len) {
+          for_each_attr(elem, elem_len, [&](const struct nlattr* expr_attr,
+                                            const char* name, int) {
+            if ((expr_attr->nla_type & NLA_TYPE_MASK) == NFTA_EXPR_NAME) {
+              msg.exprs.push_back(name);
+            }
+          });
+        });
+      });
+    }
+    msgs.push_back(msg);
+  }
+  EXPECT_EQ(len, 0);
+  return msgs;
+}
+
+class PgwPcefNftTest : public ::testing::Test {
+  virtual void SetUp() {
+    inet_pton(AF_INET, TEST_UE_POOL, &ue_pool);
+    memset(&filter, 0, sizeof(filter));
+    filter.direction = TRAFFIC_FLOW_TEMPLATE_DOWNLINK_ONLY;
+  }
+
+ protected:
+  int convert(sdf_id_t sdf_id = SDF_ID_GBR_VOLTE_40K) {
+    return pcef_nft_rules_from_sdf_filter(&filter, sdf_id, ue_pool,
+                                          TEST_UE_POOL_PREFIX, rules);
+  }
+
+  void set_remote_addr(const uint8_t addr[4], const uint8_t mask[4]) {
+    filter.packetfiltercontents.flags |=
+        TRAFFIC_FLOW_TEMPLATE_IPV4_REMOTE_ADDR_FLAG;
+    for (int i = 0; i < 4; i++) {
+      filter.packetfiltercontents.ipv4remoteaddr[i].addr = addr[i];
+      filter.packetfiltercontents.ipv4remoteaddr[i].mask = mask[i];
+    }
+  }
+
+  struct in_addr ue_pool;
+  sdf_filter_t filter;
+  pcef_nft_rule_t rules[PCEF_NFT_CHAIN_MAX];
+};
+
+TEST_F(PgwPcefNftTest, TestRulesFromFilterWithoutRemoteAddr) {
+  ASSERT_EQ(convert(), PCEF_NFT_CHAIN_MAX);
+  EXPECT_EQ(rules[0].chain, PCEF_NFT_CHAIN_POSTROUTING);
+  EXPECT_EQ(rules[1].chain, PCEF_NFT_CHAIN_OUTPUT);
+  for (int i = 0; i < PCEF_NFT_CHAIN_MAX; i++) {
+    EXPECT_EQ(rules[i].error, 0);
+    EXPECT_EQ(rules[i].mark, SDF_ID_GBR_VOLTE_40K);
+    // Downlink traffic of any host towards the UE pool
+    EXPECT_EQ(rules[i].match, PCEF_NFT_MATCH_DADDR);
+    EXPECT_EQ(rules[i].daddr.s_addr, ue_pool.s_addr);
+    EXPECT_EQ(rules[i].dmask.s_addr, htonl(0xffffff00));
+  }
+
+  // Uplink only filters are not marked
+  filter.direction = TRAFFIC_FLOW_TEMPLATE_UPLINK_ONLY;
+  EXPECT_EQ(convert(), 0);
+}
+
+TEST_F(PgwPcefNftTest, TestRulesFromFilterWithRemoteAddrAndPorts) {
+  const uint8_t addr[4] = {10, 0, 2, 77};
+  const uint8_t mask[4] = {255, 255, 255, 0};
+  set_remote_addr(addr, mask);
+  filter.direction = TRAFFIC_FLOW_TEMPLATE_BIDIRECTIONAL;
+  filter.packetfiltercontents.flags |=
+      TRAFFIC_FLOW_TEMPLATE_PROTOCOL_NEXT_HEADER_FLAG |
+      TRAFFIC_FLOW_TEMPLATE_SINGLE_LOCAL_PORT_FLAG |
+      TRAFFIC_FLOW_TEMPLATE_REMOTE_PORT_RANGE_FLAG |
+      TRAFFIC_FLOW_TEMPLATE_TYPE_OF_SERVICE_TRAFFIC_CLASS_FLAG;
+  filter.packetfiltercontents.protocolidentifier_nextheader = IPPROTO_UDP;
+  filter.packetfiltercontents.singlelocalport = 5060;
+  filter.packetfiltercontents.remoteportrange.lowlimit = 1000;
+  filter.packetfiltercontents.remoteportrange.highlimit = 2000;
+  filter.packetfiltercontents.typdeofservice_trafficclass.value = 0xb8;
+
+  ASSERT_EQ(convert(), PCEF_NFT_CHAIN_MAX);
+  const pcef_nft_rule_t& rule = rules[0];
+  EXPECT_EQ(rule.error, 0);
+  EXPECT_EQ(rule.match, PCEF_NFT_MATCH_DADDR | PCEF_NFT_MATCH_PROTOCOL |
+                            PCEF_NFT_MATCH_DPORT | PCEF_NFT_MATCH_SPORT |
+                            PCEF_NFT_MATCH_TOS);
+  struct in_addr expected;
+  inet_pton(AF_INET, "10.0.2.0", &expected);
+  EXPECT_EQ(rule.daddr.s_addr, expected.s_addr);
+  EXPECT_EQ(rule.dmask.s_addr, htonl(0xffffff00));
+  EXPECT_EQ(rule.protocol, IPPROTO_UDP);
+  // Local port of the UE is the destination of downlink packets
+  EXPECT_EQ(rule.dport_low, 5060);
+  EXPECT_EQ(rule.dport_high, 5060);
+  EXPECT_EQ(rule.sport_low, 1000);
+  EXPECT_EQ(rule.sport_high, 2000);
+  EXPECT_EQ(rule.tos, 0xb8);
+  EXPECT_EQ(rule.tos_mask, 0xff);
+}
+
+TEST_F(PgwPcefNftTest, TestRulesFromUnsupportedFilters) {
+  // A port needs a transport protocol
+  filter.packetfiltercontents.flags =
+      TRAFFIC_FLOW_TEMPLATE_SINGLE_REMOTE_PORT_FLAG;
+  ASSERT_EQ(convert(), PCEF_NFT_CHAIN_MAX);
+  EXPECT_EQ(rules[0].error, -EINVAL);
+  EXPECT_EQ(rules[1].error, -EINVAL);
+
+  filter.packetfiltercontents.flags =
+      TRAFFIC_FLOW_TEMPLATE_IPV6_REMOTE_ADDR_FLAG;
+  ASSERT_EQ(convert(), PCEF_NFT_CHAIN_MAX);
+  EXPECT_EQ(rules[0].error, -EOPNOTSUPP);
+
+  filter.packetfiltercontents.flags = TRAFFIC_FLOW_TEMPLATE_FLOW_LABEL_FLAG;
+  ASSERT_EQ(convert(), PCEF_NFT_CHAIN_MAX);
+  EXPECT_EQ(rules[0].error, -EOPNOTSUPP);
+
+  // The SPI implies ESP
+  filter.packetfiltercontents.flags =
+      TRAFFIC_FLOW_TEMPLATE_SECURITY_PARAMETER_INDEX_FLAG;
+  filter.packetfiltercontents.securityparameterindex = 0x1234;
+  ASSERT_EQ(convert(), PCEF_NFT_CHAIN_MAX);
+  EXPECT_EQ(rules[0].error, 0);
+  EXPECT_EQ(rules[0].protocol, IPPROTO_ESP);
+  EXPECT_EQ(rules[0].spi, 0x1234);
+
+  filter.packetfiltercontents.flags |=
+      TRAFFIC_FLOW_TEMPLATE_PROTOCOL_NEXT_HEADER_FLAG;
+  filter.packetfiltercontents.protocolidentifier_nextheader = IPPROTO_TCP;
+  ASSERT_EQ(convert(), PCEF_NFT_CHAIN_MAX);
+  EXPECT_EQ(rules[0].error, -EINVAL);
+}
+
+TEST_F(PgwPcefNftTest, TestSessionBatch) {
+  const uint8_t addr[4] = {10, 0, 2, 77};
+  const uint8_t mask[4] = {255, 255, 255, 255};
+  set_remote_addr(addr, mask);
+  filter.packetfiltercontents.flags |=
+      TRAFFIC_FLOW_TEMPLATE_PROTOCOL_NEXT_HEADER_FLAG |
+      TRAFFIC_FLOW_TEMPLATE_LOCAL_PORT_RANGE_FLAG;
+  filter.packetfiltercontents.protocolidentifier_nextheader = IPPROTO_TCP;
+  filter.packetfiltercontents.localportrange.lowlimit = 8000;
+  filter.packetfiltercontents.localportrange.highlimit = 8080;
+
+  pcef_nft_rule_t session_rules[2 * PCEF_NFT_CHAIN_MAX];
+  ASSERT_EQ(convert(), PCEF_NFT_CHAIN_MAX);
+  memcpy(session_rules, rules, sizeof(rules));
+  filter.packetfiltercontents.flags =
+      TRAFFIC_FLOW_TEMPLATE_SINGLE_REMOTE_PORT_FLAG;
+  ASSERT_EQ(convert(), PCEF_NFT_CHAIN_MAX);
+  memcpy(&session_rules[PCEF_NFT_CHAIN_MAX], rules, sizeof(rules));
+
+  pcef_nft_batch_t batch;
+  ASSERT_EQ(pcef_nft_batch_build(&batch, 100, false, session_rules,
+                                 2 * PCEF_NFT_CHAIN_MAX),
+            RETURNok);
+  std::vector<nft_msg> msgs = parse_batch(&batch);
+
+  // begin, table, 2 chains, the 2 rules without error, end
+  ASSERT_EQ(msgs.size(), 7);
+  EXPECT_EQ(msgs[0].type, NFNL_MSG_BATCH_BEGIN);
+  EXPECT_EQ(msgs[1].type, (NFNL_SUBSYS_NFTABLES << 8) | NFT_MSG_NEWTABLE);
+  EXPECT_EQ(msgs[2].type, (NFNL_SUBSYS_NFTABLES << 8) | NFT_MSG_NEWCHAIN);
+  EXPECT_EQ(msgs[3].type, (NFNL_SUBSYS_NFTABLES << 8) | NFT_MSG_NEWCHAIN);
+  EXPECT_EQ(msgs[6].type, NFNL_MSG_BATCH_END);
+  for (size_t i = 0; i < msgs.size(); i++) {
+    EXPECT_EQ(msgs[i].seq, 100 + i);
+    // Only the last message before the end is acknowledged
+    EXPECT_EQ(!!(msgs[i].flags & NLM_F_ACK), i == 5);
+  }
+
+  EXPECT_EQ(batch.num_rule_msgs, 2);
+  EXPECT_EQ(batch.seq_begin, 100);
+  EXPECT_EQ(batch.seq_rule, 104);
+  EXPECT_EQ(batch.seq_end, 106);
+  EXPECT_EQ(batch.rule_of_seq[0], 0);
+  EXPECT_EQ(batch.rule_of_seq[1], 1);
+
+  // Inserted, not appended, so that the rule order matches iptables -I
+  EXPECT_EQ(msgs[4].type, (NFNL_SUBSYS_NFTABLES << 8) | NFT_MSG_NEWRULE);
+  EXPECT_FALSE(msgs[4].flags & NLM_F_APPEND);
+  EXPECT_EQ(msgs[4].chain, PCEF_NFT_CHAIN_POSTROUTING_NAME);
+  EXPECT_EQ(msgs[5].chain, PCEF_NFT_CHAIN_OUTPUT_NAME);
+  // protocol, host address without mask, port range, mark
+  std::vector<std::string> expected = {"payload", "cmp",       "payload",
+                                       "cmp",     "payload",   "cmp",
+                                       "cmp",     "immediate", "meta"};
+  EXPECT_EQ(msgs[4].exprs, expected);
+  pcef_nft_batch_free(&batch);
+}
+
+TEST_F(PgwPcefNftTest, TestResyncBatch) {
+  filter.packetfiltercontents.flags =
+      TRAFFIC_FLOW_TEMPLATE_PROTOCOL_NEXT_HEADER_FLAG |
+      TRAFFIC_FLOW_TEMPLATE_SINGLE_LOCAL_PORT_FLAG |
+      TRAFFIC_FLOW_TEMPLATE_TYPE_OF_SERVICE_TRAFFIC_CLASS_FLAG;
+  filter.packetfiltercontents.protocolidentifier_nextheader = IPPROTO_UDP;
+  filter.packetfiltercontents.typdeofservice_trafficclass.value = 0xb8;
+  filter.packetfiltercontents.typdeofservice_trafficclass.mask = 0xfc;
+
+  const int num_rules = 10000;
+  std::vector<pcef_nft_rule_t> many(num_rules);
+  for (int i = 0; i < num_rules; i += PCEF_NFT_CHAIN_MAX) {
+    filter.packetfiltercontents.singlelocalport = 1024 + i;
+    ASSERT_EQ(convert((sdf_id_t)(i % SDF_ID_MAX)), PCEF_NFT_CHAIN_MAX);
+    memcpy(&many[i], rules, sizeof(rules));
+  }
+
+  pcef_nft_batch_t batch;
+  ASSERT_EQ(pcef_nft_batch_build(&batch, 1, true, many.data(), num_rules),
+            RETURNok);
+  std::vector<nft_msg> msgs = parse_batch(&batch);
+
+  // The table is replaced whatever the kernel had before
+  ASSERT_EQ(msgs.size(), num_rules + 7);
+  EXPECT_EQ(msgs[1].type, (NFNL_SUBSYS_NFTABLES << 8) | NFT_MSG_NEWTABLE);
+  EXPECT_EQ(msgs[2].type, (NFNL_SUBSYS_NFTABLES << 8) | NFT_MSG_DELTABLE);
+  EXPECT_EQ(msgs[3].type, (NFNL_SUBSYS_NFTABLES << 8) | NFT_MSG_NEWTABLE);
+  EXPECT_EQ(batch.num_rule_msgs, num_rules);
+  EXPECT_EQ(batch.seq_rule, 7);
+  EXPECT_TRUE(msgs[num_rules + 5].flags & NLM_F_ACK);
+  EXPECT_FALSE(msgs[num_rules + 4].flags & NLM_F_ACK);
+
+  // protocol, UE pool under mask, TOS under mask, port, mark
+  std::vector<std::string> expected = {
+      "payload", "cmp", "payload", "bitwise", "cmp",       "payload",
+      "bitwise", "cmp", "payload", "cmp",     "immediate", "meta"};
+  EXPECT_EQ(msgs[6].exprs, expected);
+  for (int i = 6; i < num_rules + 6; i++) {
+    EXPECT_LT(msgs[i].len, PCEF_NFT_RULE_MSG_MAX);
+  }
+  pcef_nft_batch_free(&batch);
+}
+
+}  // namespace lte
+}  // namespace magma
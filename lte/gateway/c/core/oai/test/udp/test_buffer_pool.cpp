@@ -0,0 +1,136 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/buffer_pool.h"
+}
+
+namespace magma {
+namespace lte {
+
+TEST(BufferPoolTest, TestGetPutRecyclesSlab) {
+  buffer_pool_t* pool = buffer_pool_create(4096, 4);
+  buffer_pool_stats_t stats;
+
+  uint8_t* buffers[4];
+  buffer_pool_get_bulk(pool, buffers, 4);
+  std::set<uint8_t*> distinct(buffers, buffers + 4);
+  EXPECT_EQ(distinct.size(), 4);
+  for (auto* buffer : buffers) {
+    // Payload must be usable as a protocol header
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer) % 16, 0);
+    memset(buffer, 0xab, 4096);
+  }
+
+  buffer_pool_get_stats(pool, &stats);
+  EXPECT_EQ(stats.capacity, 4);
+  EXPECT_EQ(stats.available, 0);
+  EXPECT_EQ(stats.outstanding, 4);
+  EXPECT_EQ(stats.overflow, 0);
+
+  buffer_pool_put_bulk(buffers, 4);
+  buffer_pool_get_stats(pool, &stats);
+  EXPECT_EQ(stats.available, 4);
+  EXPECT_EQ(stats.outstanding, 0);
+
+  // Recycled buffers come from the same slab
+  uint8_t* again = buffer_pool_get(pool);
+  EXPECT_EQ(distinct.count(again), 1);
+  buffer_pool_put(again);
+  buffer_pool_put(nullptr);
+
+  buffer_pool_destroy(pool);
+}
+
+TEST(BufferPoolTest, TestOverflowFallsBackToHeap) {
+  buffer_pool_t* pool = buffer_pool_create(128, 2);
+  buffer_pool_stats_t stats;
+
+  uint8_t* buffers[5];
+  buffer_pool_get_bulk(pool, buffers, 5);
+  for (auto* buffer : buffers) {
+    ASSERT_NE(buffer, nullptr);
+    memset(buffer, 0, 128);
+  }
+  buffer_pool_get_stats(pool, &stats);
+  EXPECT_EQ(stats.available, 0);
+  EXPECT_EQ(stats.outstanding, 5);
+  EXPECT_EQ(stats.overflow, 3);
+
+  buffer_pool_put_bulk(buffers, 5);
+  buffer_pool_get_stats(pool, &stats);
+  // Heap buffers are freed, only the slab is recycled
+  EXPECT_EQ(stats.available, 2);
+  EXPECT_EQ(stats.outstanding, 0);
+
+  buffer_pool_destroy(pool);
+}
+
+TEST(BufferPoolTest, TestBuffersOutliveDestroy) {
+  buffer_pool_t* pool = buffer_pool_create(64, 2);
+  uint8_t* held = buffer_pool_get(pool);
+  uint8_t* overflow[2];
+  buffer_pool_get_bulk(pool, overflow, 2);
+
+  buffer_pool_destroy(pool);
+  // Still writable, the pool is released with the last buffer
+  memset(held, 1, 64);
+  buffer_pool_put_bulk(overflow, 2);
+  buffer_pool_put(held);
+}
+
+TEST(BufferPoolTest, TestCrossThreadRelease) {
+  const int kRounds = 20000;
+  buffer_pool_t* pool = buffer_pool_create(256, 64);
+
+  // Producer takes buffers, consumer gives them back, as the UDP task and
+  // the S11 task do with UDP_DATA_IND
+  std::vector<uint8_t*> handoff;
+  std::mutex handoff_mutex;
+  std::thread producer([&]() {
+    for (int i = 0; i < kRounds; i++) {
+      uint8_t* buffer = buffer_pool_get(pool);
+      buffer[0] = static_cast<uint8_t>(i);
+      std::lock_guard<std::mutex> lock(handoff_mutex);
+      handoff.push_back(buffer);
+    }
+  });
+  std::thread consumer([&]() {
+    int released = 0;
+    while (released < kRounds) {
+      std::vector<uint8_t*> batch;
+      {
+        std::lock_guard<std::mutex> lock(handoff_mutex);
+        batch.swap(handoff);
+      }
+      buffer_pool_put_bulk(batch.data(), batch.size());
+      released += batch.size();
+    }
+  });
+  producer.join();
+  consumer.join();
+
+  buffer_pool_stats_t stats;
+  buffer_pool_get_stats(pool, &stats);
+  EXPECT_EQ(stats.outstanding, 0);
+  EXPECT_EQ(stats.available, 64);
+  buffer_pool_destroy(pool);
+}
+
+}  // namespace lte
+}  // namespace magma
@@ -0,0 +1,271 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <poll.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+extern "C" {
+#define CHECK_PROTOTYPE_ONLY
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface_init.h"
+#undef CHECK_PROTOTYPE_ONLY
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface.h"
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface_types.h"
+#include "lte/gateway/c/core/oai/common/itti_free_defined_msg.h"
+#include "lte/gateway/c/core/oai/include/udp_primitives_server.h"
+}
+
+const task_info_t tasks_info[] = {
+    {THREAD_NULL, "TASK_UNKNOWN", "ipc://IPC_TASK_UNKNOWN"},
+#define TASK_DEF(tHREADiD) \
+  {THREAD_##tHREADiD, #tHREADiD, "ipc://IPC_" #tHREADiD},
+#include "lte/gateway/c/core/oai/include/tasks_def.h"
+#undef TASK_DEF
+};
+
+/* Map message id to message information */
+const message_info_t messages_info[] = {
+#define MESSAGE_DEF(iD, sTRUCT, fIELDnAME) {iD, sizeof(sTRUCT), #iD},
+#include "lte/gateway/c/core/oai/include/messages_def.h"
+#undef MESSAGE_DEF
+};
+
+namespace magma {
+namespace lte {
+
+#define UDP_TEST_PORT 42123
+// Typical size of a Create Session Request
+#define UDP_TEST_DATAGRAM_LEN 220
+// Datagrams in flight, keeps the load below the socket receive buffer
+#define UDP_TEST_WINDOW 64
+#define UDP_TEST_TIMEOUT_SEC 30
+
+task_zmq_ctx_t task_zmq_ctx_main_udp;
+task_zmq_ctx_t task_zmq_ctx_s11_udp;
+
+static std::atomic<uint64_t> datagrams_received;
+static std::atomic<uint64_t> datagrams_corrupted;
+
+static struct in_addr loopback_addr;
+
+static int handle_message_s11(zloop_t* loop, zsock_t* reader, void* arg) {
+  MessageDef* received_message_p = receive_msg(reader);
+
+  switch (ITTI_MSG_ID(received_message_p)) {
+    case UDP_DATA_IND: {
+      udp_data_ind_t* udp_data_ind = &received_message_p->ittiMsg.udp_data_ind;
+      if (udp_data_ind->buffer_length != UDP_TEST_DATAGRAM_LEN ||
+          udp_data_ind->msgBuf[0] != 0x48 ||
+          udp_data_ind->msgBuf[UDP_TEST_DATAGRAM_LEN - 1] != 0x48) {
+        datagrams_corrupted++;
+      }
+      datagrams_received++;
+    } break;
+
+    case TERMINATE_MESSAGE: {
+      itti_free_msg_content(received_message_p);
+      free(received_message_p);
+      destroy_task_context(&task_zmq_ctx_s11_udp);
+      pthread_exit(NULL);
+    } break;
+
+    default: {
+    } break;
+  }
+
+  itti_free_msg_content(received_message_p);
+  free(received_message_p);
+  return 0;
+}
+
+// Stands in for the S11 task, the GTPv2-C user of the UDP task
+static void start_s11_udp_task() {
+  task_id_t task_id_list[1] = {TASK_UDP};
+  init_task_context(TASK_S11, task_id_list, 1, handle_message_s11,
+                    &task_zmq_ctx_s11_udp);
+  zloop_start(task_zmq_ctx_s11_udp.event_loop);
+}
+
+static double cpu_seconds() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+class UdpTaskLoadTest : public ::testing::Test {
+  virtual void SetUp() {
+    datagrams_received = 0;
+    datagrams_corrupted = 0;
+    loopback_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
+              NULL, NULL);
+    task_id_t task_id_list[2] = {TASK_UDP, TASK_S11};
+    init_task_context(TASK_MAIN, task_id_list, 2, NULL,
+                      &task_zmq_ctx_main_udp);
+
+    std::thread task_s11(start_s11_udp_task);
+    task_s11.detach();
+    ASSERT_EQ(udp_init(), 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    MessageDef* message_p = itti_alloc_new_message(TASK_S11, UDP_INIT);
+    message_p->ittiMsg.udp_init.in_addr = &loopback_addr;
+    message_p->ittiMsg.udp_init.port = UDP_TEST_PORT;
+    send_msg_to_task(&task_zmq_ctx_s11_udp, TASK_UDP, message_p);
+
+    peer_sd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ASSERT_GE(peer_sd, 0);
+    memset(&peer_addr, 0, sizeof(peer_addr));
+    peer_addr.sin_family = AF_INET;
+    peer_addr.sin_addr = loopback_addr;
+    ASSERT_EQ(bind(peer_sd, (struct sockaddr*)&peer_addr, sizeof(peer_addr)),
+              0);
+    socklen_t len = sizeof(peer_addr);
+    getsockname(peer_sd, (struct sockaddr*)&peer_addr, &len);
+
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(UDP_TEST_PORT);
+    server_addr.sin_addr = loopback_addr;
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  }
+
+  virtual void TearDown() {
+    close(peer_sd);
+    send_terminate_message_fatal(&task_zmq_ctx_main_udp);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    destroy_task_context(&task_zmq_ctx_main_udp);
+    itti_free_desc_threads();
+  }
+
+ protected:
+  int peer_sd;
+  struct sockaddr_in peer_addr;
+  struct sockaddr_in server_addr;
+};
+
+// Load generator: peer blasts GTPv2-C sized datagrams at the UDP task and
+// the S11 stand-in counts the UDP_DATA_IND it receives.
+TEST_F(UdpTaskLoadTest, TestReceiveThroughput) {
+  const uint64_t kDatagrams = 100000;
+  const int kBurst = 32;
+  uint8_t payload[UDP_TEST_DATAGRAM_LEN];
+  memset(payload, 0x48, sizeof(payload));
+
+  struct iovec iovs[kBurst];
+  struct mmsghdr msgs[kBurst];
+  memset(msgs, 0, sizeof(msgs));
+  for (int i = 0; i < kBurst; i++) {
+    iovs[i].iov_base = payload;
+    iovs[i].iov_len = sizeof(payload);
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_name = &server_addr;
+    msgs[i].msg_hdr.msg_namelen = sizeof(server_addr);
+  }
+
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::seconds(UDP_TEST_TIMEOUT_SEC);
+  auto start = std::chrono::steady_clock::now();
+  double cpu_start = cpu_seconds();
+  uint64_t sent = 0;
+  while (datagrams_received < kDatagrams &&
+         std::chrono::steady_clock::now() < deadline) {
+    if (sent < kDatagrams &&
+        sent - datagrams_received + kBurst <= UDP_TEST_WINDOW) {
+      int burst = std::min<uint64_t>(kBurst, kDatagrams - sent);
+      int rc = sendmmsg(peer_sd, msgs, burst, 0);
+      ASSERT_GT(rc, 0);
+      sent += rc;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  double cpu = cpu_seconds() - cpu_start;
+
+  EXPECT_EQ(datagrams_received.load(), kDatagrams);
+  EXPECT_EQ(datagrams_corrupted.load(), 0);
+
+  // CPU includes the generator and the S11 stand-in, it is an upper bound
+  // of what the UDP task spends per datagram.
+  double rate = datagrams_received / elapsed.count();
+  double cpu_per_datagram_us = cpu * 1e6 / std::max<uint64_t>(1, sent);
+  std::cout << "UDP task rx: " << datagrams_received << " datagrams in "
+            << elapsed.count() << " s, " << static_cast<uint64_t>(rate)
+            << " datagrams/s, " << cpu_per_datagram_us
+            << " us CPU/datagram" << std::endl;
+  RecordProperty("rx_datagrams_per_sec", static_cast<int>(rate));
+}
+
+// Bursts of UDP_DATA_REQ are coalesced by the UDP task, all of them must
+// still reach the peer in order.
+TEST_F(UdpTaskLoadTest, TestSendBurst) {
+  const int kBursts = 50;
+  const int kBurst = 48;
+  static uint8_t payload[kBurst][UDP_TEST_DATAGRAM_LEN];
+  static struct sockaddr_in destination;
+  destination = peer_addr;
+
+  auto start = std::chrono::steady_clock::now();
+  double cpu_start = cpu_seconds();
+  int received = 0;
+  for (int burst = 0; burst < kBursts; burst++) {
+    for (int i = 0; i < kBurst; i++) {
+      memset(payload[i], i, sizeof(payload[i]));
+      MessageDef* message_p = itti_alloc_new_message(TASK_S11, UDP_DATA_REQ);
+      udp_data_req_t* udp_data_req = &message_p->ittiMsg.udp_data_req;
+      udp_data_req->buffer = payload[i];
+      udp_data_req->buffer_length = 100 + i;
+      udp_data_req->buffer_offset = 0;
+      udp_data_req->local_port = UDP_TEST_PORT;
+      udp_data_req->peer_address = (struct sockaddr*)&destination;
+      udp_data_req->peer_port = ntohs(destination.sin_port);
+      send_msg_to_task(&task_zmq_ctx_s11_udp, TASK_UDP, message_p);
+    }
+
+    for (int i = 0; i < kBurst; i++) {
+      uint8_t buffer[UDP_DATA_MAX_MSG_LEN];
+      struct pollfd pfd = {peer_sd, POLLIN, 0};
+      ASSERT_EQ(poll(&pfd, 1, 2000), 1);
+      ssize_t len = recv(peer_sd, buffer, sizeof(buffer), 0);
+      ASSERT_EQ(len, 100 + i);
+      EXPECT_EQ(buffer[0], i);
+      received++;
+    }
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  double cpu = cpu_seconds() - cpu_start;
+
+  EXPECT_EQ(received, kBursts * kBurst);
+  std::cout << "UDP task tx: " << received << " datagrams in "
+            << elapsed.count() << " s, "
+            << static_cast<uint64_t>(received / elapsed.count())
+            << " datagrams/s, " << cpu * 1e6 / received
+            << " us CPU/datagram" << std::endl;
+}
+
+}  // namespace lte
+}  // namespace magma
@@ -16,6 +16,7 @@
 #include <arpa/inet.h>
 #include <assert.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <netinet/sctp.h>
 #include <stdlib.h>
 #include <string.h>
@@ -31,23 +32,58 @@ namespace magma {
 namespace sctpd {
 
 const int NUM_EPOLL_EVENTS = 10;
+// Upper bound of messages read from one socket per worker wakeup, so that a
+// busy association cannot starve the others owned by the same worker
+const int MAX_RECV_PER_WAKEUP = 64;
+// Upper bound of downlink messages queued for one association socket while
+// it is not writable
+const size_t MAX_QUEUED_SEND_MSGS = 4096;
+
+static int open_sctp_sock(const InitReq& req) {
+  int sock = create_sctp_sock(req);
+  if (sock < 0) throw std::exception();
+  return sock;
+}
+
+static int create_epoll_fd() {
+  int epoll_fd = epoll_create(1);
+  if (epoll_fd < 0) {
+    MLOG_perror("epoll_create");
+    std::terminate();
+  }
+  return epoll_fd;
+}
 
-SctpConnection::SctpConnection(const InitReq& req, SctpEventHandler& handler)
+SctpConnection::SctpConnection(const InitReq& req, SctpEventHandler& handler,
+                               uint32_t num_workers)
     : _done(false),
       _handler(handler),
       _ppid(req.ppid()),
-      _sctp_desc(0),
+      _sctp_desc(open_sctp_sock(req)),
+      _epoll_fd(create_epoll_fd()),
+      _send_queue(
+          [](int sd, uint32_t ppid, uint32_t stream, const std::string& msg) {
+            return sctp_sendmsg(sd, msg.c_str(), msg.size(), NULL, 0,
+                                htonl(ppid), 0, stream, 0, 0);
+          },
+          [this](int sd, bool writable) { WatchWritable(sd, writable); },
+          MAX_QUEUED_SEND_MSGS),
       _thread(nullptr) {
-  int sock = create_sctp_sock(req);
-  if (sock < 0) throw std::exception();
-
-  _sctp_desc = SctpDesc(sock);
+  for (uint32_t i = 0; i < num_workers; i++) {
+    auto worker = std::make_unique<SctpWorker>();
+    worker->epoll_fd = create_epoll_fd();
+    _workers.push_back(std::move(worker));
+  }
 }
 
 void SctpConnection::Start() {
   assert(_done == false);
   assert(_thread == nullptr);
 
+  for (auto& worker : _workers) {
+    worker->thread = std::make_unique<std::thread>(&SctpConnection::RunWorker,
+                                                   this, worker.get());
+  }
   _thread = std::make_unique<std::thread>(&SctpConnection::Listen, this);
 }
 
@@ -57,12 +93,16 @@ void SctpConnection::Close() {
 
   _done = true;
   _thread->join();
+  for (auto& worker : _workers) {
+    worker->thread->join();
+    close(worker->epoll_fd);
+  }
+  close(_epoll_fd);
 
-  for (auto kv : _sctp_desc) {
-    auto assoc = kv.second;
+  _sctp_desc.forEachAssoc([](const SctpAssoc& assoc) {
     shutdown(assoc.sd, SHUT_RDWR);
     close(assoc.sd);
-  }
+  });
   close(_sctp_desc.sd());
 }
 
@@ -70,30 +110,39 @@ void SctpConnection::Send(uint32_t assoc_id, uint32_t stream,
                           const std::string& msg) {
   assert(_thread != nullptr);
 
-  auto assoc = _sctp_desc.getAssoc(assoc_id);
+  auto assoc = _sctp_desc.getAssoc(assoc_id);  // throws std::out_of_range
   assert(assoc.sd >= 0);
 
-  auto buf = msg.c_str();
-  auto n = msg.size();
-  auto rc = sctp_sendmsg(assoc.sd, buf, n, NULL, 0, htonl(assoc.ppid), 0,
-                         stream, 0, 0);
-
-  if (rc < 0) {
-    MLOG_perror("sctp_sendmsg");
-    throw std::exception();
+  switch (_send_queue.Send(assoc.sd, assoc.ppid, stream, msg)) {
+    case SendResult::SENT: {
+      break;
+    }
+    case SendResult::QUEUED: {
+      MLOG(MDEBUG) << "sd " << std::to_string(assoc.sd)
+                   << " would block, queued msg for assoc "
+                   << std::to_string(assoc_id);
+      break;
+    }
+    case SendResult::FAILED: {
+      if (_send_queue.Queued(assoc.sd) >= MAX_QUEUED_SEND_MSGS) {
+        MLOG(MERROR) << "Send queue of assoc " << std::to_string(assoc_id)
+                     << " is full, dropping msg";
+      } else {
+        MLOG_perror("sctp_sendmsg");
+      }
+      throw std::exception();
+    }
   }
+  _sctp_desc.incMessagesSent(assoc_id);
 }
 
 void SctpConnection::Listen() {
   int server_fd = _sctp_desc.sd();
   MLOG(MINFO) << "starting sctp connection listener sd = "
-              << std::to_string(server_fd);
+              << std::to_string(server_fd) << " with "
+              << std::to_string(_workers.size()) << " workers";
 
-  int epoll_fd = epoll_create(1);
-  if (epoll_fd < 0) {
-    MLOG_perror("epoll_create");
-    std::terminate();
-  }
+  int epoll_fd = _epoll_fd;
 
   struct epoll_event event;
   event.events = EPOLLIN;
@@ -134,32 +183,110 @@ void SctpConnection::Listen() {
           std::terminate();
         }
 
-        struct epoll_event event;
-        event.events = EPOLLIN;
-        event.data.fd = client_sd;
+        if (_workers.empty()) {
+          WatchClientSock(epoll_fd, client_sd);
+          continue;
+        }
 
-        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client_sd, &event) < 0) {
-          MLOG_perror("epoll_ctl");
+        // Workers drain their sockets until EAGAIN, so reads must not block.
+        // Sends that would block are queued until the socket is writable.
+        int flags = fcntl(client_sd, F_GETFL, 0);
+        if (flags < 0 || fcntl(client_sd, F_SETFL, flags | O_NONBLOCK) < 0) {
+          MLOG_perror("fcntl");
           std::terminate();
         }
+        WatchClientSock(WorkerFor(client_sd).epoll_fd, client_sd);
       } else {
-        int client_sd = events[i].data.fd;
+        HandleClientEvents(epoll_fd, events[i], 1);
+      }
+    }
+  }
+}
 
-        auto status = HandleClientSock(client_sd);
+void SctpConnection::RunWorker(SctpWorker* worker) {
+  struct epoll_event events[NUM_EPOLL_EVENTS];
 
-        if ((status == SctpStatus::DISCONNECT) ||
-            (status == SctpStatus::NEW_ASSOC_NOTIF_FAILED)) {
-          if (epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client_sd, nullptr) < 0) {
-            MLOG_perror("epoll_ctl");
-            std::terminate();
-          }
-        }
+  while (!_done) {
+    int timeout = 100;  // milliseconds = .1s
+    int num_events =
+        epoll_wait(worker->epoll_fd, events, NUM_EPOLL_EVENTS, timeout);
 
-        if (status == SctpStatus::NEW_ASSOC_NOTIF_FAILED) {
-          shutdown(client_sd, 0);
-        }
+    if (num_events < 0) {
+      if (errno == EINTR) continue;
+      MLOG_perror("epoll_wait");
+      std::terminate();
+    }
+
+    for (int i = 0; i < num_events; i++) {
+      HandleClientEvents(worker->epoll_fd, events[i], MAX_RECV_PER_WAKEUP);
+    }
+  }
+}
+
+void SctpConnection::WatchClientSock(int epoll_fd, int sd) {
+  struct epoll_event event;
+  event.events = EPOLLIN;
+  event.data.fd = sd;
+
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sd, &event) < 0) {
+    MLOG_perror("epoll_ctl");
+    std::terminate();
+  }
+}
+
+void SctpConnection::HandleClientEvents(int epoll_fd,
+                                        const struct epoll_event& event,
+                                        int max_msgs) {
+  if (event.events & EPOLLOUT) {
+    _send_queue.Flush(event.data.fd);
+  }
+  if (event.events & ~EPOLLOUT) {
+    ServiceClientSock(epoll_fd, event.data.fd, max_msgs);
+  }
+}
+
+void SctpConnection::ServiceClientSock(int epoll_fd, int sd, int max_msgs) {
+  for (int i = 0; i < max_msgs; i++) {
+    auto status = HandleClientSock(sd);
+
+    if (status == SctpStatus::OK) continue;
+
+    if ((status == SctpStatus::DISCONNECT) ||
+        (status == SctpStatus::NEW_ASSOC_NOTIF_FAILED)) {
+      _send_queue.Clear(sd);
+      if (epoll_ctl(epoll_fd, EPOLL_CTL_DEL, sd, nullptr) < 0) {
+        MLOG_perror("epoll_ctl");
+        std::terminate();
+      }
+      if (status == SctpStatus::NEW_ASSOC_NOTIF_FAILED) {
+        shutdown(sd, 0);
       }
     }
+    // Socket drained, closed or errored - level triggered epoll will report
+    // it again if anything is left to read
+    return;
+  }
+}
+
+SctpConnection::SctpWorker& SctpConnection::WorkerFor(int sd) {
+  assert(!_workers.empty());
+  return *_workers[std::hash<int>{}(sd) % _workers.size()];
+}
+
+int SctpConnection::EpollFor(int sd) {
+  return _workers.empty() ? _epoll_fd : WorkerFor(sd).epoll_fd;
+}
+
+void SctpConnection::WatchWritable(int sd, bool writable) {
+  struct epoll_event event;
+  event.events = writable ? EPOLLIN | EPOLLOUT : EPOLLIN;
+  event.data.fd = sd;
+
+  // The socket may already be gone from the poll set when its association
+  // closes with messages still queued
+  if (epoll_ctl(EpollFor(sd), EPOLL_CTL_MOD, sd, &event) < 0 &&
+      errno != ENOENT && errno != EBADF) {
+    MLOG_perror("epoll_ctl");
   }
 }
 
@@ -175,6 +302,7 @@ SctpStatus SctpConnection::HandleClientSock(int sd) {
   int n = sctp_recvmsg(sd, msg, sizeof(msg), nullptr, nullptr, &sinfo, &flags);
 
   if (n < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) return SctpStatus::NO_DATA;
     MLOG_perror("sctp_recvmsg");
     return SctpStatus::FAILURE;
   }
@@ -199,7 +327,7 @@ SctpStatus SctpConnection::HandleClientSock(int sd) {
     }
   } else {
     // Data payload received
-    SctpAssoc&& assoc = SctpAssoc();
+    SctpAssoc assoc;
     try {
       assoc = _sctp_desc.getAssoc(sinfo.sinfo_assoc_id);
     } catch (const std::out_of_range&) {
@@ -209,7 +337,7 @@ SctpStatus SctpConnection::HandleClientSock(int sd) {
       return SctpStatus::FAILURE;
     }
 
-    assoc.messages_recv++;
+    _sctp_desc.incMessagesRecv(assoc.assoc_id);
 
     if (ntohl(sinfo.sinfo_ppid) != assoc.ppid) {
       // may have received unsollicited traffic from stack other than S1AP.
@@ -17,11 +17,14 @@
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <lte/protos/sctpd.grpc.pb.h>
 
 #include "lte/gateway/c/sctpd/src/sctp_desc.h"
+#include "lte/gateway/c/sctpd/src/sctp_send_queue.h"
 
+struct epoll_event;
 struct sctp_assoc_change;
 
 namespace magma {
@@ -33,6 +36,7 @@ enum class SctpStatus {
   FAILURE,                 // General failure - nonfatal
   DISCONNECT,              // Sctp assoc disconnected
   NEW_ASSOC_NOTIF_FAILED,  // GRPC call for new assoc notification failed
+  NO_DATA,                 // Non-blocking socket has nothing left to read
 };
 
 // Interface for upstream Sctp event handling
@@ -53,22 +57,54 @@ class SctpEventHandler {
 };
 
 // Manages Sctp connection including setup/teardown and send/recv
+//
+// With num_workers == 0 a single listener thread accepts and services every
+// association. Otherwise the listener only accepts, and each association
+// socket is handed to one of num_workers epoll workers by hash. A socket is
+// owned by exactly one worker for its lifetime, which preserves per
+// association message ordering. The event handler must therefore be safe to
+// call from several threads when workers are enabled.
 class SctpConnection {
  public:
   // Construct as per the InitReq and sending upstream events to handler
-  SctpConnection(const InitReq& req, SctpEventHandler& handler);
+  SctpConnection(const InitReq& req, SctpEventHandler& handler,
+                 uint32_t num_workers = 0);
 
   // Start SCTP connection and begin listening/relaying events to handler
   void Start();
   // Close the SCTP connection and its associations - blocking call
   void Close();
 
-  // Send a message on the Sctp connection to (assoc_id, stream)
+  // Send a message on the Sctp connection to (assoc_id, stream). If the
+  // association socket would block, the message is queued and sent once the
+  // socket is writable again.
   void Send(uint32_t assoc_id, uint32_t stream, const std::string& msg);
 
  private:
+  // Epoll worker servicing a subset of the association sockets
+  struct SctpWorker {
+    int epoll_fd;
+    std::unique_ptr<std::thread> thread;
+  };
+
   // Listener loop run in separate thread by Start
   void Listen();
+  // Worker loop run in separate thread by Start, one per worker
+  void RunWorker(SctpWorker* worker);
+  // Register client socket sd for EPOLLIN on epoll_fd
+  void WatchClientSock(int epoll_fd, int sd);
+  // Service a readable client socket sd watched by epoll_fd, reading at most
+  // max_msgs messages
+  void ServiceClientSock(int epoll_fd, int sd, int max_msgs);
+  // Return the worker that owns client socket sd
+  SctpWorker& WorkerFor(int sd);
+  // Return the epoll descriptor watching client socket sd
+  int EpollFor(int sd);
+  // Start/stop watching client socket sd for EPOLLOUT
+  void WatchWritable(int sd, bool writable);
+  // Dispatch the epoll events reported for a client socket
+  void HandleClientEvents(int epoll_fd, const struct epoll_event& event,
+                          int max_msgs);
   // Handle an event on a client socket
   SctpStatus HandleClientSock(int sd);
   // Handle an association change event for an association sd/change
@@ -88,8 +124,15 @@ class SctpConnection {
   int _ppid;
   // Keeps track of sctp and assocation info
   SctpDesc _sctp_desc;
+  // Epoll descriptor of the listener
+  int _epoll_fd;
+  // Downlink messages waiting for their association socket to be writable
+  SctpSendQueue _send_queue;
   // Thread for sctp listener to run on
   std::unique_ptr<std::thread> _thread;
+  // Epoll workers the association sockets are sharded across, empty when the
+  // listener services associations itself
+  std::vector<std::unique_ptr<SctpWorker>> _workers;
 };
 
 }  // namespace sctpd
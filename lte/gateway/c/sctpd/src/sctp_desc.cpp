@@ -20,30 +20,74 @@ namespace sctpd {
 
 SctpDesc::SctpDesc(int sd) : _sd(sd) { assert(sd >= 0); }
 
+SctpDesc::AssocShard& SctpDesc::shardFor(uint32_t assoc_id) {
+  return _shards[assoc_id % NUM_ASSOC_SHARDS];
+}
+
+const SctpDesc::AssocShard& SctpDesc::shardFor(uint32_t assoc_id) const {
+  return _shards[assoc_id % NUM_ASSOC_SHARDS];
+}
+
 void SctpDesc::addAssoc(const SctpAssoc& assoc) {
-  _assocs[assoc.assoc_id] = assoc;
+  auto& shard = shardFor(assoc.assoc_id);
+  std::lock_guard<std::mutex> guard(shard.lock);
+  shard.assocs[assoc.assoc_id] = assoc;
 }
 
-SctpAssoc& SctpDesc::getAssoc(uint32_t assoc_id) {
-  return _assocs.at(assoc_id);  // throws std::out_of_range
+SctpAssoc SctpDesc::getAssoc(uint32_t assoc_id) const {
+  auto& shard = shardFor(assoc_id);
+  std::lock_guard<std::mutex> guard(shard.lock);
+  return shard.assocs.at(assoc_id);  // throws std::out_of_range
 }
 
 int SctpDesc::delAssoc(uint32_t assoc_id) {
-  auto num_removed = _assocs.erase(assoc_id);
+  auto& shard = shardFor(assoc_id);
+  std::lock_guard<std::mutex> guard(shard.lock);
+  auto num_removed = shard.assocs.erase(assoc_id);
   return num_removed == 1 ? 0 : -1;
 }
 
-AssocMap::const_iterator SctpDesc::begin() const { return _assocs.cbegin(); }
+int SctpDesc::incMessagesRecv(uint32_t assoc_id) {
+  auto& shard = shardFor(assoc_id);
+  std::lock_guard<std::mutex> guard(shard.lock);
+  auto it = shard.assocs.find(assoc_id);
+  if (it == shard.assocs.end()) return -1;
+  it->second.messages_recv++;
+  return 0;
+}
 
-AssocMap::const_iterator SctpDesc::end() const { return _assocs.cend(); }
+int SctpDesc::incMessagesSent(uint32_t assoc_id) {
+  auto& shard = shardFor(assoc_id);
+  std::lock_guard<std::mutex> guard(shard.lock);
+  auto it = shard.assocs.find(assoc_id);
+  if (it == shard.assocs.end()) return -1;
+  it->second.messages_sent++;
+  return 0;
+}
+
+void SctpDesc::forEachAssoc(
+    const std::function<void(const SctpAssoc&)>& fn) const {
+  for (auto const& shard : _shards) {
+    std::lock_guard<std::mutex> guard(shard.lock);
+    for (auto const& kv : shard.assocs) {
+      fn(kv.second);
+    }
+  }
+}
+
+size_t SctpDesc::size() const {
+  size_t total = 0;
+  for (auto const& shard : _shards) {
+    std::lock_guard<std::mutex> guard(shard.lock);
+    total += shard.assocs.size();
+  }
+  return total;
+}
 
 int SctpDesc::sd() const { return _sd; }
 
 void SctpDesc::dump() const {
-  for (auto const& kv : _assocs) {
-    auto assoc = kv.second;
-    assoc.dump();
-  }
+  forEachAssoc([](const SctpAssoc& assoc) { assoc.dump(); });
 }
 
 }  // namespace sctpd
@@ -13,18 +13,27 @@
 
 #pragma once
 
-#include <map>
-#include <memory>
+#include <array>
+#include <functional>
+#include <mutex>
 #include <stdint.h>
+#include <unordered_map>
 
 #include "lte/gateway/c/sctpd/src/sctp_assoc.h"
 
 namespace magma {
 namespace sctpd {
 
-using AssocMap = std::map<uint32_t, SctpAssoc>;
+using AssocMap = std::unordered_map<uint32_t, SctpAssoc>;
+
+// Number of independently locked shards of the association table
+const size_t NUM_ASSOC_SHARDS = 64;
 
 // Models the state of an SCTP connection and its assocations
+//
+// The association table is sharded by assoc_id so that the gRPC send path
+// and the epoll workers can look up and update associations concurrently
+// without serializing on a single lock.
 class SctpDesc {
  public:
   // Construct a SCTP assocation on socket, sd
@@ -32,15 +41,23 @@ class SctpDesc {
 
   // Add assocation, assoc, to the list of assocations - keyed by assoc_id
   void addAssoc(const SctpAssoc& assoc);
-  // Get association keyed by assoc_id, throw std::out_of_range otherwise
-  SctpAssoc& getAssoc(uint32_t assoc_id);
+  // Get a copy of association keyed by assoc_id, throw std::out_of_range
+  // otherwise
+  SctpAssoc getAssoc(uint32_t assoc_id) const;
   // Remove assoc keyed by assoc_id from assoc list, returns 0/-1 on ok/fail
   int delAssoc(uint32_t assoc_id);
+  // Increment the received message counter of assoc keyed by assoc_id,
+  // returns 0/-1 on ok/fail
+  int incMessagesRecv(uint32_t assoc_id);
+  // Increment the sent message counter of assoc keyed by assoc_id,
+  // returns 0/-1 on ok/fail
+  int incMessagesSent(uint32_t assoc_id);
 
-  // Return the starting const_iterator of associations in the SCTP connection
-  AssocMap::const_iterator begin() const;
-  // Return the ending const_iterator of associations in the SCTP connection
-  AssocMap::const_iterator end() const;
+  // Apply fn to every association of the SCTP connection, one shard at a
+  // time. fn must not call back into this SctpDesc.
+  void forEachAssoc(const std::function<void(const SctpAssoc&)>& fn) const;
+  // Return the number of associations in the SCTP connection
+  size_t size() const;
 
   // Return the socket descriptor for the SCTP connection
   int sd() const;
@@ -49,8 +66,16 @@ class SctpDesc {
   void dump() const;
 
  private:
-  // List (map) of assocations for the SCTP connection
-  AssocMap _assocs;
+  struct AssocShard {
+    mutable std::mutex lock;
+    AssocMap assocs;
+  };
+
+  AssocShard& shardFor(uint32_t assoc_id);
+  const AssocShard& shardFor(uint32_t assoc_id) const;
+
+  // Sharded map of assocations for the SCTP connection
+  std::array<AssocShard, NUM_ASSOC_SHARDS> _shards;
   // Socket descriptor for the SCTP connection
   int _sd;
 };
@@ -0,0 +1,99 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lte/gateway/c/sctpd/src/sctp_send_queue.h"
+
+#include <errno.h>
+
+namespace magma {
+namespace sctpd {
+
+static bool would_block(ssize_t rc) {
+  return rc < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+SctpSendQueue::SctpSendQueue(SendFn send_fn, WatchFn watch_fn,
+                             size_t max_queued)
+    : _send_fn(send_fn), _watch_fn(watch_fn), _max_queued(max_queued) {}
+
+SctpSendQueue::QueueShard& SctpSendQueue::shardFor(int sd) {
+  return _shards[sd % NUM_SEND_QUEUE_SHARDS];
+}
+
+const SctpSendQueue::QueueShard& SctpSendQueue::shardFor(int sd) const {
+  return _shards[sd % NUM_SEND_QUEUE_SHARDS];
+}
+
+SendResult SctpSendQueue::Send(int sd, uint32_t ppid, uint32_t stream,
+                               const std::string& msg) {
+  auto& shard = shardFor(sd);
+  std::lock_guard<std::mutex> guard(shard.lock);
+
+  auto it = shard.queues.find(sd);
+  if (it == shard.queues.end()) {
+    auto rc = _send_fn(sd, ppid, stream, msg);
+    if (rc >= 0) return SendResult::SENT;
+    if (!would_block(rc)) return SendResult::FAILED;
+    if (_max_queued == 0) return SendResult::FAILED;
+
+    shard.queues[sd].push_back({ppid, stream, msg});
+    _watch_fn(sd, true);
+    return SendResult::QUEUED;
+  }
+
+  if (it->second.size() >= _max_queued) return SendResult::FAILED;
+  it->second.push_back({ppid, stream, msg});
+  return SendResult::QUEUED;
+}
+
+size_t SctpSendQueue::Flush(int sd) {
+  auto& shard = shardFor(sd);
+  std::lock_guard<std::mutex> guard(shard.lock);
+
+  auto it = shard.queues.find(sd);
+  if (it == shard.queues.end()) return 0;
+
+  size_t num_sent = 0;
+  auto& queue = it->second;
+  while (!queue.empty()) {
+    auto& pending = queue.front();
+    auto rc = _send_fn(sd, pending.ppid, pending.stream, pending.msg);
+    if (would_block(rc)) return num_sent;
+    if (rc >= 0) num_sent++;
+    queue.pop_front();
+  }
+
+  shard.queues.erase(it);
+  _watch_fn(sd, false);
+  return num_sent;
+}
+
+void SctpSendQueue::Clear(int sd) {
+  auto& shard = shardFor(sd);
+  std::lock_guard<std::mutex> guard(shard.lock);
+
+  if (shard.queues.erase(sd) == 1) {
+    _watch_fn(sd, false);
+  }
+}
+
+size_t SctpSendQueue::Queued(int sd) const {
+  auto& shard = shardFor(sd);
+  std::lock_guard<std::mutex> guard(shard.lock);
+
+  auto it = shard.queues.find(sd);
+  return it == shard.queues.end() ? 0 : it->second.size();
+}
+
+}  // namespace sctpd
+}  // namespace magma
@@ -0,0 +1,94 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <array>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+namespace magma {
+namespace sctpd {
+
+// Number of independently locked shards of the send queues
+const size_t NUM_SEND_QUEUE_SHARDS = 64;
+
+// Outcome of SctpSendQueue::Send
+enum class SendResult {
+  SENT,    // Message was handed to the socket
+  QUEUED,  // Socket would block, message waits for it to become writable
+  FAILED,  // Send failed or the socket's queue is full, message dropped
+};
+
+// Downlink messages waiting for non-blocking association sockets to become
+// writable
+//
+// A message is only sent directly while nothing is queued for its socket, so
+// messages keep their order on each socket. The watch function is called,
+// under the queue lock, with writable = true when a socket's queue becomes
+// non-empty and with writable = false once it has been flushed, so that the
+// caller can add or remove the socket from its writable poll set without
+// racing a concurrent Send.
+class SctpSendQueue {
+ public:
+  // Send msg on socket sd, returning the sendmsg result (-1 and errno set on
+  // error)
+  using SendFn = std::function<ssize_t(int sd, uint32_t ppid, uint32_t stream,
+                                       const std::string& msg)>;
+  // Start/stop waiting for socket sd to become writable
+  using WatchFn = std::function<void(int sd, bool writable)>;
+
+  // Queue at most max_queued messages per socket
+  SctpSendQueue(SendFn send_fn, WatchFn watch_fn, size_t max_queued);
+
+  // Send msg on sd, or queue it if sd would block or already has messages
+  // queued
+  SendResult Send(int sd, uint32_t ppid, uint32_t stream,
+                  const std::string& msg);
+  // Send the messages queued for sd until it would block again, returns the
+  // number of messages sent. Messages failing with another error are dropped.
+  size_t Flush(int sd);
+  // Drop the messages queued for sd, e.g. once its association is closed
+  void Clear(int sd);
+  // Return the number of messages queued for sd
+  size_t Queued(int sd) const;
+
+ private:
+  struct PendingMsg {
+    uint32_t ppid;
+    uint32_t stream;
+    std::string msg;
+  };
+
+  struct QueueShard {
+    mutable std::mutex lock;
+    std::unordered_map<int, std::deque<PendingMsg>> queues;
+  };
+
+  QueueShard& shardFor(int sd);
+  const QueueShard& shardFor(int sd) const;
+
+  SendFn _send_fn;
+  WatchFn _watch_fn;
+  size_t _max_queued;
+  std::array<QueueShard, NUM_SEND_QUEUE_SHARDS> _shards;
+};
+
+}  // namespace sctpd
+}  // namespace magma
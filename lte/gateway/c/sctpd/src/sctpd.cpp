@@ -108,6 +108,13 @@ static uint32_t get_log_verbosity(const YAML::Node& config,
   }
 }
 
+static uint32_t get_num_workers(const YAML::Node& config) {
+  if (!config["num_workers"].IsDefined()) {
+    return 0;
+  }
+  return config["num_workers"].as<uint32_t>();
+}
+
 int main() {
   signalMask();
 
@@ -124,7 +131,7 @@ int main() {
 
   SctpdUplinkClient client(channel);
   SctpdEventHandler handler(client);
-  SctpdDownlinkImpl service(handler);
+  SctpdDownlinkImpl service(handler, get_num_workers(config));
 
   ServerBuilder builder;
   builder.AddListeningPort(DOWNSTREAM_SOCK, grpc::InsecureServerCredentials());
@@ -23,8 +23,10 @@
 namespace magma {
 namespace sctpd {
 
-SctpdDownlinkImpl::SctpdDownlinkImpl(SctpEventHandler& uplink_handler)
+SctpdDownlinkImpl::SctpdDownlinkImpl(SctpEventHandler& uplink_handler,
+                                     uint32_t num_workers)
     : _uplink_handler(uplink_handler),
+      _num_workers(num_workers),
       _sctp_4G_connection(nullptr),
       _sctp_5G_connection(nullptr) {}
 
@@ -43,7 +45,8 @@ Status SctpdDownlinkImpl::create_sctp_connection(
   }
   MLOG(MINFO) << "SctpdDownlinkImpl::Init creating new socket and listener";
   try {
-    sctp_connection = std::make_unique<SctpConnection>(*req, _uplink_handler);
+    sctp_connection =
+        std::make_unique<SctpConnection>(*req, _uplink_handler, _num_workers);
   } catch (...) {
     res->set_result(InitRes::INIT_FAIL);
     return Status::OK;
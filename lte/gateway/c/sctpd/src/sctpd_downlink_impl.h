@@ -35,8 +35,10 @@ using grpc::Status;
 // Implements the sctpd downlink server
 class SctpdDownlinkImpl final : public SctpdDownlink::Service {
  public:
-  // Construct a new SctpdDownlinkImpl service
-  SctpdDownlinkImpl(SctpEventHandler& uplink_handler);
+  // Construct a new SctpdDownlinkImpl service, servicing associations of each
+  // connection on num_workers epoll workers (0 for the listener thread only)
+  SctpdDownlinkImpl(SctpEventHandler& uplink_handler,
+                    uint32_t num_workers = 0);
 
   // Implementation of SctpdDownlink.Init method (see sctpd.proto for more info)
   Status Init(ServerContext* context, const InitReq* request,
@@ -58,6 +60,7 @@ class SctpdDownlinkImpl final : public SctpdDownlink::Service {
 
  private:
   SctpEventHandler& _uplink_handler;
+  uint32_t _num_workers;
   std::unique_ptr<SctpConnection> _sctp_4G_connection;
   std::unique_ptr<SctpConnection> _sctp_5G_connection;
 };
@@ -14,6 +14,9 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include <thread>
+#include <vector>
+
 #include "lte/gateway/c/sctpd/src/sctp_assoc.h"
 #include "lte/gateway/c/sctpd/src/sctp_desc.h"
 
@@ -69,11 +72,9 @@ TEST_F(SctpdDescTest, test_sctpd_desc) {
   // check iteration
   bool found_1 = false;
   bool found_2 = false;
-  for (auto kv : desc) {
-    auto assoc_id = kv.first;
-    auto assoc = kv.second;
+  desc.forEachAssoc([&](const SctpAssoc& assoc) {
+    auto assoc_id = assoc.assoc_id;
 
-    EXPECT_EQ(assoc_id, assoc.assoc_id);
     if (assoc_id == ASSOC_1_ASSOC_ID) {
       found_1 = true;
       check_assoc(ASSOC_1_ASSOC_ID, ASSOC_1_SD, assoc);
@@ -81,11 +82,12 @@ TEST_F(SctpdDescTest, test_sctpd_desc) {
       found_2 = true;
       check_assoc(ASSOC_2_ASSOC_ID, ASSOC_2_SD, assoc);
     } else {
-      FAIL();
+      ADD_FAILURE();
     }
-  }
+  });
 
   EXPECT_TRUE(found_1 && found_2);
+  EXPECT_EQ(2, desc.size());
 
   // check deletion of associations
   desc.delAssoc(assoc_1.assoc_id);
@@ -97,6 +99,56 @@ TEST_F(SctpdDescTest, test_sctpd_desc) {
   desc.delAssoc(assoc_2.assoc_id);
   EXPECT_THROW(desc.getAssoc(ASSOC_1_ASSOC_ID), std::out_of_range);
   EXPECT_THROW(desc.getAssoc(ASSOC_2_ASSOC_ID), std::out_of_range);
+  EXPECT_EQ(0, desc.size());
+}
+
+TEST_F(SctpdDescTest, test_sctpd_desc_counters) {
+  SctpDesc desc(DESC_SD);
+
+  desc.addAssoc(assoc_1);
+  EXPECT_EQ(0, desc.incMessagesRecv(ASSOC_1_ASSOC_ID));
+  EXPECT_EQ(0, desc.incMessagesSent(ASSOC_1_ASSOC_ID));
+  EXPECT_EQ(0, desc.incMessagesSent(ASSOC_1_ASSOC_ID));
+  EXPECT_EQ(-1, desc.incMessagesRecv(ASSOC_2_ASSOC_ID));
+  EXPECT_EQ(-1, desc.incMessagesSent(ASSOC_2_ASSOC_ID));
+
+  auto assoc = desc.getAssoc(ASSOC_1_ASSOC_ID);
+  EXPECT_EQ(1, assoc.messages_recv);
+  EXPECT_EQ(2, assoc.messages_sent);
+}
+
+TEST_F(SctpdDescTest, test_sctpd_desc_concurrent_access) {
+  const int num_threads = 8;
+  const int assocs_per_thread = 1000;
+  SctpDesc desc(DESC_SD);
+
+  // each thread owns a disjoint assoc_id range, as each epoll worker owns a
+  // disjoint set of association sockets
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&desc, t]() {
+      for (int i = 0; i < assocs_per_thread; i++) {
+        SctpAssoc assoc;
+        assoc.assoc_id = t * assocs_per_thread + i;
+        assoc.sd = assoc.assoc_id + DESC_SD + 1;
+        desc.addAssoc(assoc);
+        desc.incMessagesRecv(assoc.assoc_id);
+        EXPECT_EQ(assoc.sd, desc.getAssoc(assoc.assoc_id).sd);
+      }
+      for (int i = 0; i < assocs_per_thread; i += 2) {
+        EXPECT_EQ(0, desc.delAssoc(t * assocs_per_thread + i));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(num_threads * assocs_per_thread / 2, desc.size());
+  desc.forEachAssoc([](const SctpAssoc& assoc) {
+    EXPECT_EQ(1, assoc.assoc_id % 2);
+    EXPECT_EQ(1, assoc.messages_recv);
+  });
 }
 
 }  // namespace sctpd
@@ -0,0 +1,171 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lte/gateway/c/sctpd/src/sctp_send_queue.h"
+
+using ::testing::Test;
+
+namespace magma {
+namespace sctpd {
+
+const size_t MSG_SIZE = 1024;
+const size_t MAX_QUEUED = 64;
+
+// Fixed size message carrying its sequence number
+static std::string make_msg(int seq) {
+  std::string msg = std::to_string(seq);
+  msg.resize(MSG_SIZE, ' ');
+  return msg;
+}
+
+// Stands in for an association socket with a non-blocking SOCK_SEQPACKET
+// socket pair, which keeps message boundaries like SCTP
+class SctpSendQueueTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds), 0);
+    int sndbuf = 4 * MSG_SIZE;
+    setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL, 0) | O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL, 0) | O_NONBLOCK);
+
+    queue.reset(new SctpSendQueue(
+        [](int sd, uint32_t ppid, uint32_t stream, const std::string& msg) {
+          return send(sd, msg.c_str(), msg.size(), 0);
+        },
+        [this](int sd, bool writable) { watches.emplace_back(sd, writable); },
+        MAX_QUEUED));
+  }
+
+  virtual void TearDown() {
+    close(fds[0]);
+    close(fds[1]);
+  }
+
+  // Send messages from seq on until the socket would block, returns the
+  // sequence number of the first queued message
+  int FillSendBuffer(int seq) {
+    while (queue->Send(fds[0], 0, 0, make_msg(seq)) == SendResult::SENT) {
+      seq++;
+    }
+    return seq;
+  }
+
+  // Read every message waiting on the peer socket
+  std::vector<int> Drain() {
+    std::vector<int> seqs;
+    char buf[MSG_SIZE];
+    while (recv(fds[1], buf, sizeof(buf), 0) > 0) {
+      seqs.push_back(std::stoi(std::string(buf, MSG_SIZE)));
+    }
+    return seqs;
+  }
+
+  int fds[2];
+  std::unique_ptr<SctpSendQueue> queue;
+  std::vector<std::pair<int, bool>> watches;
+};
+
+TEST_F(SctpSendQueueTest, test_queue_when_send_buffer_full) {
+  int first_queued = FillSendBuffer(0);
+  EXPECT_GT(first_queued, 0);
+  EXPECT_EQ(queue->Queued(fds[0]), 1);
+  ASSERT_EQ(watches.size(), 1);
+  EXPECT_EQ(watches[0], std::make_pair(fds[0], true));
+
+  // Later messages queue behind the first one even once there is room
+  std::vector<int> seqs = Drain();
+  EXPECT_EQ(seqs.size(), first_queued);
+  EXPECT_EQ(queue->Send(fds[0], 0, 0, make_msg(first_queued + 1)),
+            SendResult::QUEUED);
+  EXPECT_EQ(queue->Queued(fds[0]), 2);
+  EXPECT_EQ(watches.size(), 1);
+
+  EXPECT_EQ(queue->Flush(fds[0]), 2);
+  EXPECT_EQ(queue->Queued(fds[0]), 0);
+  ASSERT_EQ(watches.size(), 2);
+  EXPECT_EQ(watches[1], std::make_pair(fds[0], false));
+
+  for (int seq : Drain()) seqs.push_back(seq);
+  ASSERT_EQ(seqs.size(), first_queued + 2);
+  for (int i = 0; i < static_cast<int>(seqs.size()); i++) {
+    EXPECT_EQ(seqs[i], i);
+  }
+}
+
+TEST_F(SctpSendQueueTest, test_flush_stops_when_send_buffer_full) {
+  int seq = FillSendBuffer(0);
+  for (int i = 1; i < static_cast<int>(MAX_QUEUED); i++) {
+    EXPECT_EQ(queue->Send(fds[0], 0, 0, make_msg(seq + i)),
+              SendResult::QUEUED);
+  }
+  // Queue is full
+  EXPECT_EQ(queue->Send(fds[0], 0, 0, make_msg(seq + MAX_QUEUED)),
+            SendResult::FAILED);
+  EXPECT_EQ(queue->Queued(fds[0]), MAX_QUEUED);
+
+  // Socket is still full, nothing is flushed
+  EXPECT_EQ(queue->Flush(fds[0]), 0);
+  EXPECT_EQ(queue->Queued(fds[0]), MAX_QUEUED);
+
+  std::vector<int> seqs;
+  while (queue->Queued(fds[0]) > 0) {
+    for (int s : Drain()) seqs.push_back(s);
+    queue->Flush(fds[0]);
+  }
+  for (int s : Drain()) seqs.push_back(s);
+  ASSERT_EQ(seqs.size(), seq + MAX_QUEUED);
+  for (int i = 0; i < static_cast<int>(seqs.size()); i++) {
+    EXPECT_EQ(seqs[i], i);
+  }
+  EXPECT_EQ(watches.back(), std::make_pair(fds[0], false));
+}
+
+TEST_F(SctpSendQueueTest, test_clear) {
+  FillSendBuffer(0);
+  EXPECT_EQ(queue->Queued(fds[0]), 1);
+
+  queue->Clear(fds[0]);
+  EXPECT_EQ(queue->Queued(fds[0]), 0);
+  EXPECT_EQ(watches.back(), std::make_pair(fds[0], false));
+  EXPECT_EQ(queue->Flush(fds[0]), 0);
+}
+
+TEST_F(SctpSendQueueTest, test_send_error) {
+  int closed_sd = dup(fds[0]);
+  close(closed_sd);
+  EXPECT_EQ(queue->Send(closed_sd, 0, 0, make_msg(0)), SendResult::FAILED);
+  EXPECT_EQ(queue->Queued(closed_sd), 0);
+  EXPECT_TRUE(watches.empty());
+}
+
+}  // namespace sctpd
+}  // namespace magma
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  FLAGS_logtostderr = 1;
+  FLAGS_v = 10;
+  return RUN_ALL_TESTS();
+}
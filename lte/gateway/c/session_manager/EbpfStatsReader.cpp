@@ -0,0 +1,205 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arpa/inet.h>
+#include <linux/bpf.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "EbpfStatsReader.h"
+#include "magma_logging.h"
+
+namespace magma {
+
+namespace {
+
+int sys_bpf(enum bpf_cmd cmd, union bpf_attr* attr) {
+  return syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+int bpf_obj_get(const std::string& path) {
+  union bpf_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.pathname = reinterpret_cast<uint64_t>(path.c_str());
+  return sys_bpf(BPF_OBJ_GET, &attr);
+}
+
+int bpf_map_get_next_key(int fd, const void* key, void* next_key) {
+  union bpf_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.map_fd = fd;
+  attr.key = reinterpret_cast<uint64_t>(key);
+  attr.next_key = reinterpret_cast<uint64_t>(next_key);
+  return sys_bpf(BPF_MAP_GET_NEXT_KEY, &attr);
+}
+
+int bpf_map_lookup_elem(int fd, const void* key, void* value) {
+  union bpf_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.map_fd = fd;
+  attr.key = reinterpret_cast<uint64_t>(key);
+  attr.value = reinterpret_cast<uint64_t>(value);
+  return sys_bpf(BPF_MAP_LOOKUP_ELEM, &attr);
+}
+
+int bpf_map_delete_elem(int fd, const void* key) {
+  union bpf_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.map_fd = fd;
+  attr.key = reinterpret_cast<uint64_t>(key);
+  return sys_bpf(BPF_MAP_DELETE_ELEM, &attr);
+}
+
+int num_possible_cpus() {
+  std::ifstream file("/sys/devices/system/cpu/possible");
+  std::string possible;
+  std::getline(file, possible);
+  return parse_possible_cpus(possible);
+}
+
+uint64_t delta(uint64_t current, uint64_t last) {
+  return current >= last ? current - last : current;
+}
+
+std::string ipv4_to_str(uint32_t ue_ipv4) {
+  char buf[INET_ADDRSTRLEN];
+  struct in_addr addr;
+  addr.s_addr = ue_ipv4;
+  inet_ntop(AF_INET, &addr, buf, sizeof(buf));
+  return buf;
+}
+
+}  // namespace
+
+int parse_possible_cpus(const std::string& possible) {
+  std::stringstream ranges(possible);
+  std::string range;
+  int num_cpus = 0;
+  while (std::getline(ranges, range, ',')) {
+    int first, last;
+    if (sscanf(range.c_str(), "%d-%d", &first, &last) == 2) {
+      if (last < first) return -1;
+      num_cpus = std::max(num_cpus, last + 1);
+    } else if (sscanf(range.c_str(), "%d", &first) == 1) {
+      num_cpus = std::max(num_cpus, first + 1);
+    } else {
+      return -1;
+    }
+  }
+  return num_cpus > 0 ? num_cpus : -1;
+}
+
+EbpfCounters sum_per_cpu_counters(const EbpfCounters* values, int num_cpus) {
+  EbpfCounters sum;
+  for (int cpu = 0; cpu < num_cpus; cpu++) {
+    sum.packets += values[cpu].packets;
+    sum.bytes += values[cpu].bytes;
+  }
+  return sum;
+}
+
+PinnedEbpfStatsMap::PinnedEbpfStatsMap(const std::string& path)
+    : path_(path), num_cpus_(num_possible_cpus()) {}
+
+bool PinnedEbpfStatsMap::read_all(
+    std::unordered_map<uint32_t, EbpfCounters>* counters) {
+  if (num_cpus_ <= 0) {
+    MLOG(MERROR) << "Unknown number of CPUs, cannot read " << path_;
+    return false;
+  }
+  int fd = bpf_obj_get(path_);
+  if (fd < 0) {
+    MLOG(MDEBUG) << "eBPF stats map " << path_ << " is not pinned";
+    return false;
+  }
+  // struct dp_stats of the datapath is 8-byte aligned, so per-CPU values
+  // are packed without padding
+  std::vector<EbpfCounters> values(num_cpus_);
+  uint32_t key, next_key;
+  const void* prev = nullptr;
+  while (bpf_map_get_next_key(fd, prev, &next_key) == 0) {
+    // An entry removed in between is skipped
+    if (bpf_map_lookup_elem(fd, &next_key, values.data()) == 0) {
+      (*counters)[next_key] = sum_per_cpu_counters(values.data(), num_cpus_);
+    }
+    key = next_key;
+    prev = &key;
+  }
+  close(fd);
+  return true;
+}
+
+void PinnedEbpfStatsMap::erase(uint32_t ue_ipv4) {
+  int fd = bpf_obj_get(path_);
+  if (fd < 0) return;
+  bpf_map_delete_elem(fd, &ue_ipv4);
+  close(fd);
+}
+
+EbpfStatsReader::EbpfStatsReader(std::unique_ptr<EbpfStatsMap> ul_map,
+                                 std::unique_ptr<EbpfStatsMap> dl_map)
+    : ul_map_(std::move(ul_map)), dl_map_(std::move(dl_map)) {}
+
+std::unique_ptr<EbpfStatsReader> EbpfStatsReader::create_pinned() {
+  return std::make_unique<EbpfStatsReader>(
+      std::make_unique<PinnedEbpfStatsMap>(EBPF_UL_STATS_MAP_PATH),
+      std::make_unique<PinnedEbpfStatsMap>(EBPF_DL_STATS_MAP_PATH));
+}
+
+std::unordered_map<std::string, EbpfUsage> EbpfStatsReader::poll() {
+  std::unordered_map<uint32_t, EbpfCounters> ul, dl;
+  if (!ul_map_->read_all(&ul) || !dl_map_->read_all(&dl)) {
+    // Keep the last values, the counters are reported on the next poll
+    return {};
+  }
+
+  std::unordered_map<uint32_t, EbpfUsage> current;
+  for (const auto& it : ul) current[it.first].ul = it.second;
+  for (const auto& it : dl) current[it.first].dl = it.second;
+
+  std::unordered_map<std::string, EbpfUsage> usage;
+  for (const auto& it : current) {
+    const EbpfUsage& now = it.second;
+    EbpfUsage last;
+    auto last_it = last_.find(it.first);
+    if (last_it != last_.end()) last = last_it->second;
+
+    EbpfUsage diff;
+    diff.ul.packets = delta(now.ul.packets, last.ul.packets);
+    diff.ul.bytes = delta(now.ul.bytes, last.ul.bytes);
+    diff.dl.packets = delta(now.dl.packets, last.dl.packets);
+    diff.dl.bytes = delta(now.dl.bytes, last.dl.bytes);
+    if (diff.ul.packets || diff.dl.packets) {
+      usage[ipv4_to_str(it.first)] = diff;
+    }
+  }
+  // UEs no longer in the maps are forgotten with the swap
+  last_.swap(current);
+  return usage;
+}
+
+void EbpfStatsReader::remove_ue(const std::string& ue_ipv4) {
+  struct in_addr addr;
+  if (inet_pton(AF_INET, ue_ipv4.c_str(), &addr) != 1) return;
+  ul_map_->erase(addr.s_addr);
+  dl_map_->erase(addr.s_addr);
+  last_.erase(addr.s_addr);
+}
+
+}  // namespace magma
@@ -0,0 +1,119 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace magma {
+
+#define EBPF_UL_STATS_MAP_PATH "/sys/fs/bpf/ul_stats_map"
+#define EBPF_DL_STATS_MAP_PATH "/sys/fs/bpf/dl_stats_map"
+
+struct EbpfCounters {
+  uint64_t packets = 0;
+  uint64_t bytes = 0;
+};
+
+struct EbpfUsage {
+  EbpfCounters ul;
+  EbpfCounters dl;
+};
+
+/**
+ * One per-CPU stats map of the eBPF datapath (see pipelined's
+ * ebpf_ul_handler.c and ebpf_dl_handler.c), keyed by UE IPv4 address in
+ * network byte order.
+ */
+class EbpfStatsMap {
+ public:
+  virtual ~EbpfStatsMap() = default;
+
+  /**
+   * Fill counters with the values of all UEs, summed over all CPUs
+   * @return false if the map could not be read
+   */
+  virtual bool read_all(
+      std::unordered_map<uint32_t, EbpfCounters>* counters) = 0;
+
+  virtual void erase(uint32_t ue_ipv4) = 0;
+};
+
+/**
+ * EbpfStatsMap on a map pinned in bpffs. The map is opened for every call
+ * since pipelined recreates it when it restarts.
+ */
+class PinnedEbpfStatsMap : public EbpfStatsMap {
+ public:
+  explicit PinnedEbpfStatsMap(const std::string& path);
+
+  bool read_all(std::unordered_map<uint32_t, EbpfCounters>* counters) override;
+
+  void erase(uint32_t ue_ipv4) override;
+
+ private:
+  std::string path_;
+  int num_cpus_;
+};
+
+/**
+ * Reads the per UE counters of the eBPF datapath directly from its maps,
+ * without going through pipelined and OVS flow stats. The counters in the
+ * maps only grow, the reader keeps the last values it saw and reports
+ * deltas.
+ */
+class EbpfStatsReader {
+ public:
+  EbpfStatsReader(std::unique_ptr<EbpfStatsMap> ul_map,
+                  std::unique_ptr<EbpfStatsMap> dl_map);
+
+  /**
+   * Reader on the maps pinned by pipelined
+   */
+  static std::unique_ptr<EbpfStatsReader> create_pinned();
+
+  /**
+   * Usage per UE IPv4 address since the previous poll. UEs without
+   * traffic in between are left out. A counter that went backwards, i.e.
+   * the map was recreated, is reported from zero. Nothing is reported
+   * while the maps cannot be read.
+   */
+  std::unordered_map<std::string, EbpfUsage> poll();
+
+  /**
+   * Remove the counters of a UE whose session ended, so that the next UE
+   * with the same address starts from zero
+   */
+  void remove_ue(const std::string& ue_ipv4);
+
+ private:
+  std::unique_ptr<EbpfStatsMap> ul_map_;
+  std::unique_ptr<EbpfStatsMap> dl_map_;
+  std::unordered_map<uint32_t, EbpfUsage> last_;
+};
+
+/**
+ * Number of possible CPUs from the content of
+ * /sys/devices/system/cpu/possible, e.g. "0-3,5", or -1 if malformed.
+ * Per-CPU map values have one slot per possible CPU.
+ */
+int parse_possible_cpus(const std::string& possible);
+
+/**
+ * Sum the per-CPU values of one map entry
+ */
+EbpfCounters sum_per_cpu_counters(const EbpfCounters* values, int num_cpus);
+
+}  // namespace magma
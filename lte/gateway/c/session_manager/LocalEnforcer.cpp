@@ -18,6 +18,7 @@
 #include <grpcpp/impl/codegen/status.h>
 #include <lte/protos/session_manager.pb.h>
 #include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <experimental/optional>
 #include <iomanip>
@@ -59,6 +60,12 @@ namespace magma {
 bool LocalEnforcer::SEND_ACCESS_TIMEZONE = false;
 bool LocalEnforcer::CLEANUP_DANGLING_FLOWS = true;
 bool LocalEnforcer::SEND_IPFIX = true;
+uint32_t LocalEnforcer::USAGE_REPORT_CHUNK_UPDATES =
+    UsageReportScheduler::DEFAULT_CHUNK_UPDATES;
+uint32_t LocalEnforcer::USAGE_REPORT_MAX_IN_FLIGHT =
+    UsageReportScheduler::DEFAULT_MAX_IN_FLIGHT;
+uint32_t LocalEnforcer::USAGE_REPORT_MAX_RETRIES =
+    UsageReportScheduler::DEFAULT_MAX_RETRIES;
 
 using google::protobuf::RepeatedPtrField;
 
@@ -103,7 +110,9 @@ LocalEnforcer::LocalEnforcer(std::shared_ptr<SessionReporter> reporter,
           quota_exhaustion_termination_on_init_ms),
       retry_timeout_(2000),
       mconfig_(mconfig),
-      access_timezone_(compute_access_timezone()) {}
+      access_timezone_(compute_access_timezone()),
+      report_scheduler_(USAGE_REPORT_CHUNK_UPDATES, USAGE_REPORT_MAX_IN_FLIGHT,
+                        USAGE_REPORT_MAX_RETRIES) {}
 
 void LocalEnforcer::start() { evb_->loopForever(); }
 
@@ -113,7 +122,7 @@ void LocalEnforcer::stop() { evb_->terminateLoopSoon(); }
 
 folly::EventBase& LocalEnforcer::get_event_base() { return *evb_; }
 
-void LocalEnforcer::setup(
+std::unique_ptr<PipelinedSetupSync> LocalEnforcer::setup(
     SessionMap& session_map, const std::uint64_t& epoch,
     std::function<void(Status status, SetupFlowsResult)> callback) {
   std::vector<SessionState::SessionInfo> session_infos;
@@ -160,9 +169,26 @@ void LocalEnforcer::setup(
     pipelined_client_->setup_cwf(session_infos, quota_updates, ue_mac_addrs,
                                  msisdns, apn_mac_addrs, apn_names,
                                  pdp_start_times, epoch, callback);
-  } else {
-    pipelined_client_->setup_lte(session_infos, epoch, callback);
+    return nullptr;
   }
+  // A sessiond restart must not continue the sync of its previous run
+  const uint64_t sync_id =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  return std::make_unique<PipelinedSetupSync>(epoch, sync_id,
+                                              std::move(session_infos));
+}
+
+void LocalEnforcer::send_setup_batch(
+    PipelinedSetupSync& sync,
+    std::function<void(Status status, SetupFlowsResult)> callback) {
+  std::vector<SessionState::SessionInfo> batch_infos;
+  SetupBatch batch = sync.get_next_batch(&batch_infos);
+  MLOG(MINFO) << "Sending PipelineD setup batch " << batch.index() << " with "
+              << batch_infos.size() << " sessions, epoch: " << sync.get_epoch()
+              << (batch.last() ? ", last batch" : "");
+  pipelined_client_->setup_lte(batch_infos, sync.get_epoch(), batch, callback);
 }
 
 void LocalEnforcer::report_session_update_event(
@@ -253,14 +279,50 @@ void LocalEnforcer::check_usage_for_reporting(SessionMap& session_map,
   // request numbers stored for the sessions in SessionStore
   session_store_.sync_request_numbers(session_uc);
 
-  reporter_->report_updates(
-      request,
-      [this, request,
-       session_map_ptr = std::make_shared<SessionMap>(std::move(session_map)),
-       session_uc](Status status, UpdateSessionResponse response) mutable {
-        handle_session_update_response(request, session_map_ptr, session_uc,
-                                       status, response);
-      });
+  auto chunks = report_scheduler_.make_chunks(std::move(request), session_map,
+                                              session_uc);
+  // Subscribers left have nothing to report, no need to wait for an answer
+  if (!session_uc.empty() && !session_store_.update_sessions(session_uc)) {
+    MLOG(MERROR) << "Failed in updating sessions which are not reporting";
+  }
+  MLOG(MDEBUG) << "Queuing " << chunks.size() << " usage report chunks, "
+               << report_scheduler_.get_in_flight() << " in flight";
+  report_scheduler_.enqueue(std::move(chunks));
+  send_queued_usage_reports();
+}
+
+void LocalEnforcer::send_queued_usage_reports() {
+  uint64_t id;
+  while (const auto* chunk = report_scheduler_.pop_ready(&id)) {
+    reporter_->report_updates(
+        chunk->request, [this, id, sent = std::chrono::steady_clock::now()](
+                            Status status, UpdateSessionResponse response) {
+          if (status.ok()) {
+            auto rtt = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - sent);
+            SessionCredit::observe_report_rtt(rtt.count());
+          }
+          handle_usage_report_chunk_response(id, status, response);
+        });
+  }
+}
+
+void LocalEnforcer::handle_usage_report_chunk_response(
+    uint64_t id, Status status, const UpdateSessionResponse& response) {
+  auto chunk = report_scheduler_.complete(id);
+  if (!chunk) {
+    return;
+  }
+  if (!status.ok() && report_scheduler_.retry(chunk, status)) {
+    MLOG(MWARNING) << "Retrying usage report chunk which failed: "
+                   << status.error_message();
+  } else {
+    handle_session_update_response(
+        chunk->request,
+        std::make_shared<SessionMap>(std::move(chunk->session_map)),
+        chunk->session_uc, status, response);
+  }
+  send_queued_usage_reports();
 }
 
 void LocalEnforcer::handle_pipelined_response(Status status,
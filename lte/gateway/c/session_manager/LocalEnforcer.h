@@ -36,6 +36,7 @@
 #include "CreditKey.h"
 #include "DirectorydClient.h"
 #include "PipelinedClient.h"
+#include "PipelinedSetupSync.h"
 #include "RuleStore.h"
 #include "SessionEvents.h"
 #include "SessionReporter.h"
@@ -45,6 +46,7 @@
 #include "SpgwServiceClient.h"
 #include "StoreClient.h"
 #include "Types.h"
+#include "UsageReportScheduler.h"
 #include "lte/protos/pipelined.pb.h"
 #include "lte/protos/session_manager.pb.h"
 
@@ -171,10 +173,21 @@ class LocalEnforcer {
 
   /**
    * Setup rules for all sessions in pipelined, used whenever pipelined
-   * restarts and needs to recover state
+   * restarts and needs to recover state.
+   * CWF sessions are set up in one shot and the callback gets the result.
+   * For LTE, the returned PipelinedSetupSync is to be sent batch by batch
+   * with send_setup_batch and the callback is not used.
    */
-  void setup(SessionMap& session_map, const std::uint64_t& epoch,
-             std::function<void(Status status, SetupFlowsResult)> callback);
+  std::unique_ptr<PipelinedSetupSync> setup(
+      SessionMap& session_map, const std::uint64_t& epoch,
+      std::function<void(Status status, SetupFlowsResult)> callback);
+
+  /**
+   * Send the next batch of a chunked pipelined setup
+   */
+  void send_setup_batch(
+      PipelinedSetupSync& sync,
+      std::function<void(Status status, SetupFlowsResult)> callback);
 
   /**
    * Updates rules to be activated/deactivated based on the current time.
@@ -352,7 +365,9 @@ class LocalEnforcer {
       const std::string& failure_reason);
 
   /*
-   * Report flow stats from pipelined and track the usage per rule
+   * Report flow stats from pipelined and track the usage per rule. The
+   * updates are reported in chunks, the sessions of the subscribers reporting
+   * are moved out of session_map.
    */
   void check_usage_for_reporting(SessionMap& session_map,
                                  SessionUpdate& session_uc);
@@ -392,6 +407,12 @@ class LocalEnforcer {
   static bool CLEANUP_DANGLING_FLOWS;
   // If true, send ipfix related updates to PipelineD
   static bool SEND_IPFIX;
+  // Maximum number of credit and monitor updates in one UpdateSessionRequest
+  static uint32_t USAGE_REPORT_CHUNK_UPDATES;
+  // Maximum number of UpdateSessionRequests waiting for an answer
+  static uint32_t USAGE_REPORT_MAX_IN_FLIGHT;
+  // Number of times a chunk failing on a transient error is sent again
+  static uint32_t USAGE_REPORT_MAX_RETRIES;
 
  private:
   std::shared_ptr<SessionReporter> reporter_;
@@ -410,8 +431,17 @@ class LocalEnforcer {
   std::chrono::milliseconds retry_timeout_;
   magma::mconfig::SessionD mconfig_;
   std::unique_ptr<Timezone> access_timezone_;
+  UsageReportScheduler report_scheduler_;
 
  private:
+  /**
+   * Send the queued usage report chunks the in flight window allows
+   */
+  void send_queued_usage_reports();
+
+  void handle_usage_report_chunk_response(
+      uint64_t id, Status status, const UpdateSessionResponse& response);
+
   /**
    * complete_termination_for_released_sessions completes the termination
    * process for sessions whose flows have been removed in PipelineD. Since
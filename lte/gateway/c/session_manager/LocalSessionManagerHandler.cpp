@@ -95,7 +95,7 @@ void LocalSessionManagerHandlerImpl::ReportRuleStats(
         SessionStore::get_default_session_update(session_map);
     MLOG(MDEBUG) << "Aggregating " << request_cpy.records_size() << " records";
     enforcer_->aggregate_records(session_map, request_cpy, update);
-    check_usage_for_reporting(std::move(session_map), update);
+    enforcer_->check_usage_for_reporting(session_map, update);
   });
 
   reported_epoch_ = request_cpy.epoch();
@@ -115,49 +115,6 @@ void LocalSessionManagerHandlerImpl::ReportRuleStats(
   response_callback(Status::OK, Void());
 }
 
-void LocalSessionManagerHandlerImpl::check_usage_for_reporting(
-    SessionMap session_map, SessionUpdate& session_uc) {
-  std::vector<std::unique_ptr<ServiceAction>> actions;
-  auto request = enforcer_->collect_updates(session_map, actions, session_uc);
-  enforcer_->execute_actions(session_map, actions, session_uc);
-  if (request.updates_size() == 0 && request.usage_monitors_size() == 0) {
-    auto update_success = session_store_.update_sessions(session_uc);
-    if (update_success) {
-      MLOG(MDEBUG) << "Succeeded in updating session after no reporting";
-    } else {
-      MLOG(MERROR) << "Failed in updating session after no reporting";
-    }
-    return;  // nothing to report
-  }
-
-  MLOG(MINFO) << "Sending " << request.updates_size()
-              << " charging updates and " << request.usage_monitors_size()
-              << " monitor updates to OCS and PCRF";
-
-  // set reporting flag for those sessions reporting
-  session_store_.set_and_save_reporting_flag(true, request, session_uc);
-
-  // Before reporting and returning control to the event loop, increment the
-  // request numbers stored for the sessions in SessionStore
-  session_store_.sync_request_numbers(session_uc);
-
-  // report to cloud
-  // NOTE: It is not possible to construct a std::function from a move-only type
-  //       So because of this, we can't directly move session_map into the
-  //       value-capture of the callback. As a workaround, a shared_ptr to
-  //       the session_map is used.
-  //       Check
-  //       https://stackoverflow.com/questions/25421346/how-to-create-an-stdfunction-from-a-move-capturing-lambda-expression
-  reporter_->report_updates(
-      request,
-      [this, request, session_uc,
-       session_map_ptr = std::make_shared<SessionMap>(std::move(session_map))](
-          Status status, UpdateSessionResponse response) mutable {
-        enforcer_->handle_session_update_response(request, session_map_ptr,
-                                                  session_uc, status, response);
-      });
-}
-
 bool LocalSessionManagerHandlerImpl::is_pipelined_restarted() {
   // If 0 also setup pipelined because it always waits for setup instructions
   return (current_epoch_ == 0 || current_epoch_ != reported_epoch_);
@@ -201,11 +158,70 @@ void LocalSessionManagerHandlerImpl::handle_setup_callback(
   });
 }
 
+void LocalSessionManagerHandlerImpl::handle_setup_batch_callback(
+    const std::uint64_t& epoch, const std::uint64_t& sync_id, Status status,
+    SetupFlowsResult resp) {
+  enforcer_->get_event_base().runInEventBaseThread([=] {
+    if (current_epoch_ != epoch || setup_sync_ == nullptr ||
+        setup_sync_->get_epoch() != epoch ||
+        setup_sync_->get_sync_id() != sync_id) {
+      MLOG(MDEBUG) << "Received stale PipelineD setup batch callback for "
+                   << "epoch: " << epoch << ", sync: " << sync_id
+                   << ", current epoch: " << current_epoch_;
+      return;
+    }
+    if (status.ok() && resp.result() == resp.SUCCESS) {
+      setup_sync_->ack_batch(resp);
+      if (setup_sync_->is_complete()) {
+        MLOG(MINFO) << "Successfully setup PipelineD with epoch: " << epoch;
+        setup_sync_.reset();
+        pipelined_state_ = PipelineDState::READY;
+        return;
+      }
+      send_setup_batch(epoch);
+      return;
+    }
+    if (status.ok() && resp.result() == resp.OUTDATED_EPOCH) {
+      MLOG(MWARNING) << "PipelineD setup call has outdated epoch, abandoning.";
+      setup_sync_.reset();
+      pipelined_state_ = PipelineDState::NOT_READY;
+      return;
+    }
+
+    // Resend the batch, the ones already acknowledged are kept
+    if (!status.ok()) {
+      MLOG(MERROR) << "Could not setup PipelineD, rpc failed with: "
+                   << status.error_message() << ", retrying PipelineD setup "
+                   << "batch for epoch: " << epoch;
+    } else {
+      MLOG(MWARNING) << "PipelineD setup batch failed, retrying after delay, "
+                     << "for epoch: " << epoch;
+    }
+    enforcer_->get_event_base().runAfterDelay(
+        [=] { send_setup_batch(epoch); }, retry_timeout_ms_.count());
+  });
+}
+
+void LocalSessionManagerHandlerImpl::send_setup_batch(
+    const std::uint64_t& epoch) {
+  using namespace std::placeholders;
+  if (current_epoch_ != epoch || setup_sync_ == nullptr ||
+      setup_sync_->get_epoch() != epoch) {
+    return;
+  }
+  enforcer_->send_setup_batch(
+      *setup_sync_,
+      std::bind(&LocalSessionManagerHandlerImpl::handle_setup_batch_callback,
+                this, epoch, setup_sync_->get_sync_id(), _1, _2));
+}
+
 void LocalSessionManagerHandlerImpl::call_setup_pipelined(
     const std::uint64_t& epoch, const bool update_rule_versions) {
   using namespace std::placeholders;
-  if (pipelined_state_ == PipelineDState::SETTING_UP) {
-    // Return if there is already a Setup call in progress
+  if (pipelined_state_ == PipelineDState::SETTING_UP &&
+      (setup_sync_ == nullptr || setup_sync_->get_epoch() == epoch)) {
+    // Return if there is already a Setup call in progress. A chunked setup
+    // for an older epoch is abandoned, PipelineD restarted in the middle.
     return;
   }
   if (current_epoch_ != epoch) {
@@ -214,6 +230,7 @@ void LocalSessionManagerHandlerImpl::call_setup_pipelined(
     return;
   }
   pipelined_state_ = PipelineDState::SETTING_UP;
+  setup_sync_.reset();
 
   auto session_map = session_store_.read_all_sessions();
   if (update_rule_versions) {
@@ -222,11 +239,11 @@ void LocalSessionManagerHandlerImpl::call_setup_pipelined(
   }
 
   MLOG(MINFO) << "Sending a setup call to PipelineD with epoch: " << epoch;
-  enforcer_->setup(
+  setup_sync_ = enforcer_->setup(
       session_map, epoch,
       std::bind(&LocalSessionManagerHandlerImpl::handle_setup_callback, this,
                 epoch, _1, _2));
-  return;
+  send_setup_batch(epoch);
 }
 
 static CreateSessionRequest make_create_session_request(
@@ -249,9 +266,16 @@ static CreateSessionRequest make_create_session_request(
   return create_request;
 }
 
-grpc::Status LocalSessionManagerHandlerImpl::check_sessiond_is_ready() {
-  if (pipelined_state_ != READY) {
-    MLOG(MINFO) << "Rejecting requests since PipelineD is still setting up";
+grpc::Status LocalSessionManagerHandlerImpl::check_sessiond_is_ready(
+    const std::string& imsi) {
+  // During a chunked setup, subscribers whose batch is acknowledged are served
+  bool pipelined_ready =
+      pipelined_state_ == READY ||
+      (pipelined_state_ == SETTING_UP && setup_sync_ != nullptr &&
+       setup_sync_->is_subscriber_ready(imsi));
+  if (!pipelined_ready) {
+    MLOG(MINFO) << "Rejecting requests for " << imsi
+                << " since PipelineD is still setting up";
     return Status(grpc::UNAVAILABLE, "PipelineD is not ready");
   }
   if (!session_store_.is_ready()) {
@@ -275,7 +299,7 @@ grpc::Status LocalSessionManagerHandlerImpl::validate_create_session_request(
     events_reporter_->session_create_failure(cfg, failure_msg);
     return Status(grpc::FAILED_PRECONDITION, failure_msg);
   }
-  return check_sessiond_is_ready();
+  return check_sessiond_is_ready(cfg.get_imsi());
 }
 
 void LocalSessionManagerHandlerImpl::CreateSession(
@@ -234,11 +234,11 @@ class LocalSessionManagerHandlerImpl : public LocalSessionManagerHandler {
   uint64_t reported_epoch_;
   std::chrono::milliseconds retry_timeout_ms_;
   PipelineDState pipelined_state_;
+  // Chunked setup in progress while pipelined_state_ is SETTING_UP, LTE only
+  std::unique_ptr<PipelinedSetupSync> setup_sync_;
   static const std::string hex_digit_;
 
  private:
-  void check_usage_for_reporting(SessionMap session_map,
-                                 SessionUpdate& session_uc);
   bool is_pipelined_restarted();
   void call_setup_pipelined(const std::uint64_t& epoch,
                             const bool update_rule_versions);
@@ -316,6 +316,20 @@ class LocalSessionManagerHandlerImpl : public LocalSessionManagerHandler {
   void handle_setup_callback(const std::uint64_t& epoch, Status status,
                              SetupFlowsResult resp);
 
+  /**
+   * Send the next batch of the chunked setup of the epoch, if it is still
+   * the one in progress
+   */
+  void send_setup_batch(const std::uint64_t& epoch);
+
+  /**
+   * Move on to the next batch once a batch is acknowledged, resend it after
+   * a delay if it failed
+   */
+  void handle_setup_batch_callback(const std::uint64_t& epoch,
+                                   const std::uint64_t& sync_id, Status status,
+                                   SetupFlowsResult resp);
+
   void send_local_create_session_response(
       Status status, const std::string& sid,
       std::function<void(Status, LocalCreateSessionResponse)>
@@ -331,13 +345,14 @@ class LocalSessionManagerHandlerImpl : public LocalSessionManagerHandler {
   grpc::Status validate_create_session_request(const SessionConfig cfg);
 
   /**
-   * @brief SessionD will not process any requests if
+   * @brief SessionD will not process any requests for a subscriber if
    * 1. SessionStore is not ready
-   * 2. PipelineD is not ready
+   * 2. PipelineD is not ready, or its setup has not reached the subscriber
    *
+   * @param imsi
    * @return status::OK if SessionD is ready to accept requests
    */
-  grpc::Status check_sessiond_is_ready();
+  grpc::Status check_sessiond_is_ready(const std::string& imsi);
 
   bool initialize_session(SessionMap& session_map,
                           const std::string& session_id,
@@ -369,12 +369,27 @@ void AsyncPipelinedClient::setup_cwf(
 
 void AsyncPipelinedClient::setup_lte(
     const std::vector<SessionState::SessionInfo>& infos,
-    const std::uint64_t& epoch,
+    const std::uint64_t& epoch, const SetupBatch& batch,
     std::function<void(Status status, SetupFlowsResult)> callback) {
-  SetupDefaultRequest setup_default_req = create_setup_default_req(epoch);
-  setup_default_controllers_rpc(setup_default_req, callback);
   SetupPolicyRequest setup_policy_req = create_setup_policy_req(infos, epoch);
-  setup_policy_rpc(setup_policy_req, callback);
+  setup_policy_req.mutable_batch()->CopyFrom(batch);
+  if (batch.index() > 0) {
+    setup_policy_rpc(setup_policy_req, callback);
+    return;
+  }
+  // Policy flows go on top of the default ones, only send the first batch
+  // once the default controllers are set up
+  SetupDefaultRequest setup_default_req = create_setup_default_req(epoch);
+  setup_default_controllers_rpc(
+      setup_default_req,
+      [this, setup_policy_req, callback](Status status,
+                                         SetupFlowsResult resp) {
+        if (!status.ok() || resp.result() != SetupFlowsResult::SUCCESS) {
+          callback(status, resp);
+          return;
+        }
+        setup_policy_rpc(setup_policy_req, callback);
+      });
 }
 
 // Method to Setup UPF Session
@@ -84,15 +84,17 @@ class PipelinedClient {
       std::function<void(Status status, SetupFlowsResult)> callback) = 0;
 
   /**
-   * @brief Set the up lte object
+   * @brief Send one batch of a chunked LTE setup. The first batch of a sync
+   * also sets up the default controllers.
    *
-   * @param infos
+   * @param infos - SessionInfos of the batch
    * @param epoch
+   * @param batch - position of the batch in the sync
    * @param callback
    */
   virtual void setup_lte(
       const std::vector<SessionState::SessionInfo>& infos,
-      const std::uint64_t& epoch,
+      const std::uint64_t& epoch, const SetupBatch& batch,
       std::function<void(Status status, SetupFlowsResult)> callback) = 0;
 
   /**
@@ -259,7 +261,7 @@ class AsyncPipelinedClient : public GRPCReceiver, public PipelinedClient {
                  std::function<void(Status status, SetupFlowsResult)> callback);
 
   void setup_lte(const std::vector<SessionState::SessionInfo>& infos,
-                 const std::uint64_t& epoch,
+                 const std::uint64_t& epoch, const SetupBatch& batch,
                  std::function<void(Status status, SetupFlowsResult)> callback);
 
   void deactivate_flows_for_rules_for_termination(
@@ -0,0 +1,106 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <utility>
+
+#include "PipelinedSetupSync.h"
+#include "magma_logging.h"
+
+namespace magma {
+
+PipelinedSetupSync::PipelinedSetupSync(
+    uint64_t epoch, uint64_t sync_id,
+    std::vector<SessionState::SessionInfo> infos, uint32_t batch_sessions)
+    : epoch_(epoch),
+      sync_id_(sync_id),
+      infos_(std::move(infos)),
+      batch_sessions_(std::max(batch_sessions, 1u)),
+      next_index_(0),
+      acked_(0),
+      in_flight_(false),
+      in_flight_end_(0),
+      complete_(false) {
+  for (size_t i = 0; i < infos_.size(); i++) {
+    subscriber_ends_[infos_[i].imsi] = i + 1;
+  }
+}
+
+SetupBatch PipelinedSetupSync::get_next_batch(
+    std::vector<SessionState::SessionInfo>* infos) {
+  if (!in_flight_) {
+    size_t end = acked_;
+    uint32_t count = 0;
+    while (end < infos_.size() && count < batch_sessions_) {
+      end = std::max(end + 1, subscriber_ends_[infos_[end].imsi]);
+      count = end - acked_;
+    }
+    in_flight_end_ = end;
+    in_flight_ = true;
+  }
+  infos->assign(infos_.begin() + acked_, infos_.begin() + in_flight_end_);
+
+  SetupBatch batch;
+  batch.set_sync_id(sync_id_);
+  batch.set_index(next_index_);
+  batch.set_last(in_flight_end_ == infos_.size());
+  return batch;
+}
+
+void PipelinedSetupSync::ack_batch(const SetupFlowsResult& result) {
+  if (!in_flight_) {
+    MLOG(MWARNING) << "Ignoring PipelineD setup ack with no batch in flight";
+    return;
+  }
+  in_flight_ = false;
+  if (result.next_batch() <= next_index_) {
+    // PipelineD did not apply the batch in flight, nor the ones from
+    // next_batch on
+    MLOG(MWARNING) << "PipelineD expects setup batch " << result.next_batch()
+                   << " after batch " << next_index_ << ", resending";
+    next_index_ = result.next_batch();
+    batch_ends_.resize(next_index_);
+    acked_ = batch_ends_.empty() ? 0 : batch_ends_.back();
+    complete_ = false;
+    return;
+  }
+  if (result.next_batch() > next_index_ + 1) {
+    MLOG(MWARNING) << "PipelineD expects setup batch " << result.next_batch()
+                   << " after batch " << next_index_
+                   << ", which was not sent yet";
+  }
+  batch_ends_.push_back(in_flight_end_);
+  complete_ = in_flight_end_ == infos_.size();
+  acked_ = in_flight_end_;
+  next_index_++;
+  if (result.max_batch_sessions() > 0) {
+    batch_sessions_ = std::min(result.max_batch_sessions(), MAX_BATCH_SESSIONS);
+  }
+  MLOG(MDEBUG) << "PipelineD acknowledged setup batch " << next_index_ - 1
+               << ", " << acked_ << "/" << infos_.size()
+               << " sessions synced, next batch size " << batch_sessions_;
+}
+
+bool PipelinedSetupSync::is_subscriber_ready(const std::string& imsi) const {
+  if (complete_) {
+    return true;
+  }
+  if (next_index_ == 0) {
+    // PipelineD controllers are set up along with the first batch
+    return false;
+  }
+  auto it = subscriber_ends_.find(imsi);
+  return it == subscriber_ends_.end() || it->second <= acked_;
+}
+
+}  // namespace magma
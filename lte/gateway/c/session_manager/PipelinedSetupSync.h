@@ -0,0 +1,92 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <lte/protos/pipelined.pb.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SessionState.h"
+
+namespace magma {
+using namespace lte;
+
+/**
+ * PipelinedSetupSync tracks a chunked setup of PipelineD after it restarted.
+ * The sessions are sent in batches of bounded size, one batch at a time. A
+ * batch is resent until PipelineD acknowledges it, so a failure only retries
+ * that batch. The size of the next batch follows the feedback of PipelineD.
+ *
+ * Batches never split the sessions of a subscriber: once the batch of a
+ * subscriber is acknowledged, its flows are in place and it can be served
+ * while the remaining batches are synced.
+ */
+class PipelinedSetupSync {
+ public:
+  static constexpr uint32_t DEFAULT_BATCH_SESSIONS = 500;
+  static constexpr uint32_t MAX_BATCH_SESSIONS = 5000;
+
+  PipelinedSetupSync(uint64_t epoch, uint64_t sync_id,
+                     std::vector<SessionState::SessionInfo> infos,
+                     uint32_t batch_sessions = DEFAULT_BATCH_SESSIONS);
+
+  uint64_t get_epoch() const { return epoch_; }
+
+  uint64_t get_sync_id() const { return sync_id_; }
+
+  /**
+   * Get the batch to send next, which is the last one returned until it is
+   * acknowledged
+   * @param infos - filled with the SessionInfos of the batch
+   */
+  SetupBatch get_next_batch(std::vector<SessionState::SessionInfo>* infos);
+
+  /**
+   * Mark the batch last returned by get_next_batch as applied by PipelineD.
+   * The sync resumes at the batch PipelineD expects next, which resends the
+   * batches it reports as not applied.
+   * @param result - successful result of the batch
+   */
+  void ack_batch(const SetupFlowsResult& result);
+
+  bool is_complete() const { return complete_; }
+
+  /**
+   * @return true if the flows of the subscriber have been set up, or if it
+   * has no session to set up and PipelineD took the first batch
+   */
+  bool is_subscriber_ready(const std::string& imsi) const;
+
+  uint32_t get_batch_sessions() const { return batch_sessions_; }
+
+ private:
+  uint64_t epoch_;
+  uint64_t sync_id_;
+  std::vector<SessionState::SessionInfo> infos_;
+  // Position after the last session of each subscriber
+  std::unordered_map<std::string, size_t> subscriber_ends_;
+  // Position after the last session of each acknowledged batch
+  std::vector<size_t> batch_ends_;
+  uint32_t batch_sessions_;
+  uint32_t next_index_;
+  // Sessions before acked_ have been applied by PipelineD
+  size_t acked_;
+  // Batch returned by get_next_batch, waiting for its acknowledgement
+  bool in_flight_;
+  size_t in_flight_end_;
+  bool complete_;
+};
+
+}  // namespace magma
@@ -18,15 +18,81 @@
 #include <utility>
 #include <vector>
 
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
 #include "RuleStore.h"
 #include "lte/protos/pipelined.pb.h"
 #include "lte/protos/policydb.pb.h"
 
 namespace magma {
 
+namespace {
+
+struct InternedRules {
+  std::mutex mutex;
+  // serialized definition -> interned instance
+  std::unordered_map<std::string, std::weak_ptr<const PolicyRule>> rules;
+};
+
+// Never destroyed, rules may still be released during static destruction
+InternedRules& interned_rules() {
+  static InternedRules* interned = new InternedRules();
+  return *interned;
+}
+
+// Equal definitions must give equal keys, so the map fields are serialized
+// in a deterministic order
+std::string definition_key(const PolicyRule& rule) {
+  std::string key;
+  {
+    google::protobuf::io::StringOutputStream string_stream(&key);
+    google::protobuf::io::CodedOutputStream coded_stream(&string_stream);
+    coded_stream.SetSerializationDeterministic(true);
+    rule.SerializeToCodedStream(&coded_stream);
+  }
+  return key;
+}
+
+}  // namespace
+
+std::shared_ptr<const PolicyRule> PolicyRuleTable::intern(
+    const PolicyRule& rule) {
+  std::string key = definition_key(rule);
+  InternedRules& interned = interned_rules();
+  std::lock_guard<std::mutex> lock(interned.mutex);
+  auto& entry = interned.rules[key];
+  std::shared_ptr<const PolicyRule> rule_p = entry.lock();
+  if (!rule_p) {
+    rule_p = std::shared_ptr<const PolicyRule>(new PolicyRule(rule),
+                                               &PolicyRuleTable::release);
+    entry = rule_p;
+  }
+  return rule_p;
+}
+
+uint32_t PolicyRuleTable::size() {
+  InternedRules& interned = interned_rules();
+  std::lock_guard<std::mutex> lock(interned.mutex);
+  return interned.rules.size();
+}
+
+void PolicyRuleTable::release(const PolicyRule* rule) {
+  std::string key = definition_key(*rule);
+  delete rule;
+  InternedRules& interned = interned_rules();
+  std::lock_guard<std::mutex> lock(interned.mutex);
+  auto it = interned.rules.find(key);
+  // The definition may have been interned again since the last reference
+  // went away
+  if (it != interned.rules.end() && it->second.expired()) {
+    interned.rules.erase(it);
+  }
+}
+
 template <typename KeyType, typename hash, typename equal>
 void PoliciesByKeyMap<KeyType, hash, equal>::insert(
-    const KeyType& key, std::shared_ptr<PolicyRule> rule_p) {
+    const KeyType& key, std::shared_ptr<const PolicyRule> rule_p) {
   auto iter = rules_by_key_.find(key);
   if (iter == rules_by_key_.end()) {
     rules_by_key_[key] = {rule_p};
@@ -37,19 +103,21 @@ void PoliciesByKeyMap<KeyType, hash, equal>::insert(
 
 template <typename KeyType, typename hash, typename equal>
 void PoliciesByKeyMap<KeyType, hash, equal>::remove(
-    const KeyType& key, std::shared_ptr<PolicyRule> rule_p) {
+    const KeyType& key, std::shared_ptr<const PolicyRule> rule_p) {
   auto iter = rules_by_key_.find(key);
   if (iter == rules_by_key_.end()) {
     return;
   }
 
-  auto rules = iter->second;
+  auto& rules = iter->second;
   auto found = std::find(rules.begin(), rules.end(), rule_p);
   if (found == rules.end()) {
     return;
   }
   rules.erase(found);
-  rules_by_key_[key] = rules;
+  if (rules.empty()) {
+    rules_by_key_.erase(iter);
+  }
 }
 
 template <typename KeyType, typename hash, typename equal>
@@ -108,7 +176,7 @@ void PolicyRuleBiMap::sync_rules(const std::vector<PolicyRule>& rules) {
           &ccHash, &ccEqual);
   rules_by_monitoring_key_ = PoliciesByKeyMap<std::string>();
   for (const auto& rule : rules) {
-    auto rule_p = std::make_shared<PolicyRule>(rule);
+    auto rule_p = PolicyRuleTable::intern(rule);
     rules_by_rule_id_[rule.id()] = rule_p;
     if (should_track_charging_key(rule.tracking_type())) {
       rules_by_charging_key_.insert(CreditKey(rule), rule_p);
@@ -120,8 +188,13 @@ void PolicyRuleBiMap::sync_rules(const std::vector<PolicyRule>& rules) {
 }
 
 void PolicyRuleBiMap::insert_rule(const PolicyRule& rule) {
-  auto rule_p = std::make_shared<PolicyRule>(rule);
+  auto rule_p = PolicyRuleTable::intern(rule);
   std::lock_guard<std::mutex> lock(map_mutex_);
+  auto it = rules_by_rule_id_.find(rule.id());
+  if (it != rules_by_rule_id_.end()) {
+    // A new definition replaces the old one in the key mappings too
+    remove_from_key_maps(it->second);
+  }
   rules_by_rule_id_[rule.id()] = rule_p;
   if (should_track_charging_key(rule.tracking_type())) {
     rules_by_charging_key_.insert(CreditKey(rule), rule_p);
@@ -172,16 +245,21 @@ bool PolicyRuleBiMap::remove_rule(const std::string& rule_id,
 
   // Remove the rule from all mappings
   rules_by_rule_id_.erase(it);
-  if (should_track_charging_key(rule_ptr->tracking_type())) {
-    rules_by_charging_key_.remove(CreditKey(rule_ptr.get()), rule_ptr);
-  }
-  if (should_track_monitoring_key(rule_ptr->tracking_type())) {
-    rules_by_monitoring_key_.remove(rule_ptr->monitoring_key(), rule_ptr);
-  }
+  remove_from_key_maps(rule_ptr);
 
   return true;
 }
 
+void PolicyRuleBiMap::remove_from_key_maps(
+    const std::shared_ptr<const PolicyRule>& rule_p) {
+  if (should_track_charging_key(rule_p->tracking_type())) {
+    rules_by_charging_key_.remove(CreditKey(rule_p.get()), rule_p);
+  }
+  if (should_track_monitoring_key(rule_p->tracking_type())) {
+    rules_by_monitoring_key_.remove(rule_p->monitoring_key(), rule_p);
+  }
+}
+
 bool PolicyRuleBiMap::get_charging_key_for_rule_id(const std::string& rule_id,
                                                    CreditKey* charging_key) {
   std::lock_guard<std::mutex> lock(map_mutex_);
@@ -34,6 +34,25 @@ class SetGroupPDR;
 }  // namespace lte
 
 using namespace lte;
+
+/**
+ * PolicyRuleTable interns PolicyRule definitions process wide. Most
+ * subscribers have the same handful of static and dynamic rules installed,
+ * so instead of every rule store owning a copy of each definition, equal
+ * definitions share one immutable instance. An entry is reference counted
+ * through the returned pointers and leaves the table with the last one.
+ */
+class PolicyRuleTable {
+ public:
+  static std::shared_ptr<const PolicyRule> intern(const PolicyRule& rule);
+
+  // Number of distinct definitions currently interned
+  static uint32_t size();
+
+ private:
+  static void release(const PolicyRule* rule);
+};
+
 /**
  * Template class for keeping track of a map of one key to many policy rules
  */
@@ -42,11 +61,11 @@ template <typename KeyType, typename hash = std::hash<KeyType>,
 class PoliciesByKeyMap {
  public:
   PoliciesByKeyMap() {}
-  PoliciesByKeyMap(hash hasher, equal eq) : rules_by_key_(4, hasher, eq) {}
+  PoliciesByKeyMap(hash hasher, equal eq) : rules_by_key_(0, hasher, eq) {}
 
-  void insert(const KeyType& key, std::shared_ptr<PolicyRule> rule_p);
+  void insert(const KeyType& key, std::shared_ptr<const PolicyRule> rule_p);
 
-  void remove(const KeyType& key, std::shared_ptr<PolicyRule> rule_p);
+  void remove(const KeyType& key, std::shared_ptr<const PolicyRule> rule_p);
 
   uint32_t policy_count();
 
@@ -57,8 +76,8 @@ class PoliciesByKeyMap {
                                     std::vector<PolicyRule>& rules_out);
 
  private:
-  std::unordered_map<KeyType, std::vector<std::shared_ptr<PolicyRule>>, hash,
-                     equal>
+  std::unordered_map<KeyType, std::vector<std::shared_ptr<const PolicyRule>>,
+                     hash, equal>
       rules_by_key_;
 };
 
@@ -123,10 +142,13 @@ class PolicyRuleBiMap {
   virtual bool get_rules(std::vector<PolicyRule>& rules_out);
 
  protected:
+  // Expects map_mutex_ to be held
+  void remove_from_key_maps(const std::shared_ptr<const PolicyRule>& rule_p);
+
   // guards all three maps below
   std::mutex map_mutex_;
-  // rule_id -> PolicyRule
-  std::unordered_map<std::string, std::shared_ptr<PolicyRule>>
+  // rule_id -> PolicyRule, interned in PolicyRuleTable
+  std::unordered_map<std::string, std::shared_ptr<const PolicyRule>>
       rules_by_rule_id_;
   // charging key -> [PolicyRule]
   PoliciesByKeyMap<CreditKey, decltype(&ccHash), decltype(&ccEqual)>
@@ -13,6 +13,7 @@
 
 #include <glog/logging.h>
 #include <stdlib.h>
+#include <algorithm>
 #include <cstdint>
 #include <ostream>
 #include <string>
@@ -29,6 +30,25 @@
 namespace magma {
 
 float SessionCredit::USAGE_REPORTING_THRESHOLD = 0.8;
+bool SessionCredit::RATE_AWARE_REPORTING = false;
+uint64_t SessionCredit::RATE_AWARE_MARGIN_MS = 2000;
+uint64_t SessionCredit::report_rtt_ms_ = 1000;
+
+namespace {
+// Weight of the last sample in the moving averages
+const double RATE_EWMA_WEIGHT = 0.3;
+// Usage of rules sharing a credit is added separately, samples closer than
+// that are merged into the next one
+const uint64_t MIN_RATE_SAMPLE_MS = 1000;
+// Share of the grant kept in reserve whatever the rate, for idle users who
+// start a burst
+const double MIN_RESERVE_RATIO = 0.05;
+
+uint64_t update_average(uint64_t average, uint64_t sample) {
+  return static_cast<uint64_t>(RATE_EWMA_WEIGHT * sample +
+                               (1 - RATE_EWMA_WEIGHT) * average);
+}
+}  // namespace
 bool SessionCredit::TERMINATE_SERVICE_WHEN_QUOTA_EXHAUSTED = true;
 uint64_t SessionCredit::DEFAULT_REQUESTED_UNITS = 10000000;
 
@@ -46,7 +66,8 @@ SessionCredit::SessionCredit(ServiceState start_state,
       grant_tracking_type_(TRACKING_UNSET),
       report_last_credit_(false),
       time_of_first_usage_(0),
-      time_of_last_usage_(0) {}
+      time_of_last_usage_(0),
+      usage_rate_{} {}
 
 SessionCredit::SessionCredit(const StoredSessionCredit& marshaled) {
   reporting_ = marshaled.reporting;
@@ -56,6 +77,7 @@ SessionCredit::SessionCredit(const StoredSessionCredit& marshaled) {
   report_last_credit_ = marshaled.report_last_credit;
   time_of_first_usage_ = marshaled.time_of_first_usage;
   time_of_last_usage_ = marshaled.time_of_last_usage;
+  usage_rate_ = marshaled.usage_rate;
 
   for (int bucket_int = USED_TX; bucket_int != BUCKET_ENUM_MAX_VALUE;
        bucket_int++) {
@@ -75,6 +97,7 @@ StoredSessionCredit SessionCredit::marshal() const {
   marshaled.report_last_credit = report_last_credit_;
   marshaled.time_of_first_usage = time_of_first_usage_;
   marshaled.time_of_last_usage = time_of_last_usage_;
+  marshaled.usage_rate = usage_rate_;
 
   for (int bucket_int = USED_TX; bucket_int != BUCKET_ENUM_MAX_VALUE;
        bucket_int++) {
@@ -92,6 +115,7 @@ SessionCreditUpdateCriteria SessionCredit::get_update_criteria() const {
   credit_uc.report_last_credit = report_last_credit_;
   credit_uc.time_of_first_usage = time_of_first_usage_;
   credit_uc.time_of_last_usage = time_of_last_usage_;
+  credit_uc.usage_rate = usage_rate_;
 
   for (int bucket_int = USED_TX; bucket_int != BUCKET_ENUM_MAX_VALUE;
        bucket_int++) {
@@ -103,6 +127,13 @@ SessionCreditUpdateCriteria SessionCredit::get_update_criteria() const {
 
 void SessionCredit::add_used_credit(uint64_t used_tx, uint64_t used_rx,
                                     SessionCreditUpdateCriteria* credit_uc) {
+  add_used_credit(used_tx, used_rx, credit_uc,
+                  magma::get_time_in_ms_since_epoch());
+}
+
+void SessionCredit::add_used_credit(uint64_t used_tx, uint64_t used_rx,
+                                    SessionCreditUpdateCriteria* credit_uc,
+                                    uint64_t now_ms) {
   if (used_tx > 0 || used_rx > 0) {
     buckets_[USED_TX] += used_tx;
     buckets_[USED_RX] += used_rx;
@@ -112,10 +143,45 @@ void SessionCredit::add_used_credit(uint64_t used_tx, uint64_t used_rx,
     }
     update_usage_timestamps(credit_uc);
   }
+  sample_usage_rate(now_ms, credit_uc);
 
   log_quota_and_usage();
 }
 
+void SessionCredit::sample_usage_rate(uint64_t now_ms,
+                                      SessionCreditUpdateCriteria* credit_uc) {
+  auto& rate = usage_rate_;
+  // The first sample and a clock going back only set the baseline
+  if (rate.sample_time_ms != 0 && now_ms >= rate.sample_time_ms) {
+    uint64_t interval = now_ms - rate.sample_time_ms;
+    if (interval < MIN_RATE_SAMPLE_MS) {
+      return;
+    }
+    uint64_t used_tx = buckets_[USED_TX] > rate.sample_used_tx
+                           ? buckets_[USED_TX] - rate.sample_used_tx
+                           : 0;
+    uint64_t used_rx = buckets_[USED_RX] > rate.sample_used_rx
+                           ? buckets_[USED_RX] - rate.sample_used_rx
+                           : 0;
+    uint64_t rate_tx = used_tx * 1000 / interval;
+    uint64_t rate_rx = used_rx * 1000 / interval;
+    if (rate.sample_interval_ms == 0) {
+      rate.rate_tx = rate_tx;
+      rate.rate_rx = rate_rx;
+    } else {
+      rate.rate_tx = update_average(rate.rate_tx, rate_tx);
+      rate.rate_rx = update_average(rate.rate_rx, rate_rx);
+    }
+    rate.sample_interval_ms = interval;
+  }
+  rate.sample_time_ms = now_ms;
+  rate.sample_used_tx = buckets_[USED_TX];
+  rate.sample_used_rx = buckets_[USED_RX];
+  if (credit_uc) {
+    credit_uc->usage_rate = rate;
+  }
+}
+
 void SessionCredit::update_usage_timestamps(
     SessionCreditUpdateCriteria* credit_uc) {
   auto now = magma::get_time_in_sec_since_epoch();
@@ -277,15 +343,15 @@ bool SessionCredit::is_quota_exhausted(float threshold) const {
     return false;
   }
 
-  bool rx_exhausted =
-      compute_quota_exhausted(buckets_[ALLOWED_RX], buckets_[USED_RX],
-                              threshold, buckets_[ALLOWED_FLOOR_RX]);
-  bool tx_exhausted =
-      compute_quota_exhausted(buckets_[ALLOWED_TX], buckets_[USED_TX],
-                              threshold, buckets_[ALLOWED_FLOOR_TX]);
+  bool rx_exhausted = compute_quota_exhausted(
+      buckets_[ALLOWED_RX], buckets_[USED_RX], threshold,
+      buckets_[ALLOWED_FLOOR_RX], usage_rate_.rate_rx);
+  bool tx_exhausted = compute_quota_exhausted(
+      buckets_[ALLOWED_TX], buckets_[USED_TX], threshold,
+      buckets_[ALLOWED_FLOOR_TX], usage_rate_.rate_tx);
   bool total_exhausted = compute_quota_exhausted(
       buckets_[ALLOWED_TOTAL], buckets_[USED_TX] + buckets_[USED_RX], threshold,
-      buckets_[ALLOWED_FLOOR_TOTAL]);
+      buckets_[ALLOWED_FLOOR_TOTAL], usage_rate_.rate_tx + usage_rate_.rate_rx);
 
   bool is_exhausted = false;
   switch (grant_tracking_type_) {
@@ -318,6 +384,11 @@ bool SessionCredit::is_quota_exhausted(float threshold) const {
     if (threshold == 1) {
       MLOG(MDEBUG) << grant_type_to_str(grant_tracking_type_)
                    << " grant is totally exhausted";
+    } else if (is_rate_aware()) {
+      MLOG(MDEBUG) << grant_type_to_str(grant_tracking_type_)
+                   << " grant is partially exhausted (rate tx="
+                   << usage_rate_.rate_tx << " rx=" << usage_rate_.rate_rx
+                   << " B/s)";
     } else {
       MLOG(MDEBUG) << grant_type_to_str(grant_tracking_type_)
                    << " grant is partially exhausted (threshold " << threshold
@@ -439,7 +510,8 @@ Usage SessionCredit::get_unreported_usage() const {
 bool SessionCredit::compute_quota_exhausted(const uint64_t allowed,
                                             const uint64_t used,
                                             float threshold_ratio,
-                                            const uint64_t floor) const {
+                                            const uint64_t floor,
+                                            const uint64_t rate) const {
   // current_granted_units: difference between current allowed and past
   // allowed (floor). This value is equivalent to the grant received.
   // Credit will be considered exhausted if the remaining credit is below
@@ -460,6 +532,10 @@ bool SessionCredit::compute_quota_exhausted(const uint64_t allowed,
 
   uint64_t remaining_credit = allowed - used;
   uint64_t current_granted_units = allowed - floor;
+  if (threshold_ratio < 1 && is_rate_aware()) {
+    return remaining_credit <=
+           get_rate_aware_reserve(rate, current_granted_units);
+  }
   // this step is necessary to avoid precision issues of float
   int integer_threshold_ratio = 100 - static_cast<int>(threshold_ratio * 100);
   uint64_t threshold = (current_granted_units * integer_threshold_ratio) / 100;
@@ -467,6 +543,28 @@ bool SessionCredit::compute_quota_exhausted(const uint64_t allowed,
   return remaining_credit <= threshold;
 }
 
+bool SessionCredit::is_rate_aware() const {
+  return RATE_AWARE_REPORTING && usage_rate_.sample_interval_ms != 0;
+}
+
+uint64_t SessionCredit::get_rate_aware_reserve(
+    uint64_t rate, uint64_t current_granted_units) const {
+  // Usage is only checked again after another sample interval, and the new
+  // grant then takes a round trip to arrive
+  uint64_t lead_ms =
+      usage_rate_.sample_interval_ms + report_rtt_ms_ + RATE_AWARE_MARGIN_MS;
+  uint64_t reserve = rate * lead_ms / 1000;
+  uint64_t min_reserve =
+      static_cast<uint64_t>(current_granted_units * MIN_RESERVE_RATIO);
+  return std::max(reserve, min_reserve);
+}
+
+void SessionCredit::observe_report_rtt(uint64_t rtt_ms) {
+  report_rtt_ms_ = update_average(report_rtt_ms_, rtt_ms);
+}
+
+uint64_t SessionCredit::get_report_rtt_ms() { return report_rtt_ms_; }
+
 bool SessionCredit::is_reporting() const { return reporting_; }
 
 uint64_t SessionCredit::get_credit(Bucket bucket) const {
@@ -494,6 +592,7 @@ void SessionCredit::apply_update_criteria(
   report_last_credit_ = credit_uc.report_last_credit;
   time_of_first_usage_ = credit_uc.time_of_first_usage;
   time_of_last_usage_ = credit_uc.time_of_last_usage;
+  usage_rate_ = credit_uc.usage_rate;
   // DO NOT UPDATE reporting_. (done by LocalSessionManagerHandler)
 
   // add credit
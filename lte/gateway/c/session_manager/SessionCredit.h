@@ -56,6 +56,14 @@ class SessionCredit {
   void add_used_credit(uint64_t used_tx, uint64_t used_rx,
                        SessionCreditUpdateCriteria* credit_uc);
 
+  /**
+   * add_used_credit with the time of the usage, which is sampled to track
+   * the consumption rate of the credit
+   * @param now_ms - milliseconds since epoch
+   */
+  void add_used_credit(uint64_t used_tx, uint64_t used_rx,
+                       SessionCreditUpdateCriteria* credit_uc, uint64_t now_ms);
+
   /**
    * reset_reporting_credit resets the REPORTING_* to 0
    * Also marks the session as not in reporting.
@@ -143,6 +151,16 @@ class SessionCredit {
    */
   bool is_quota_exhausted(float usage_reporting_threshold) const;
 
+  UsageRate get_usage_rate() const { return usage_rate_; }
+
+  /**
+   * Record the round trip time of an answered usage update. With
+   * RATE_AWARE_REPORTING, that is how long a new grant is expected to take.
+   */
+  static void observe_report_rtt(uint64_t rtt_ms);
+
+  static uint64_t get_report_rtt_ms();
+
   bool current_grant_contains_zero() const;
 
   /**
@@ -154,6 +172,20 @@ class SessionCredit {
    */
   static float USAGE_REPORTING_THRESHOLD;
 
+  /**
+   * Set to true to trigger usage updates from the consumption rate of the
+   * credit instead of USAGE_REPORTING_THRESHOLD, once the rate is known.
+   * The update is sent when the remaining quota would run out before the next
+   * usage sample, plus the report round trip time and RATE_AWARE_MARGIN_MS.
+   * Final units (threshold 1) are not affected.
+   */
+  static bool RATE_AWARE_REPORTING;
+
+  /**
+   * Safety margin added to the projected wait for a new grant
+   */
+  static uint64_t RATE_AWARE_MARGIN_MS;
+
   /**
    * Set to true to terminate service when the quota of a session is exhausted.
    * An user can still use up to the extra margin.
@@ -181,10 +213,28 @@ class SessionCredit {
   // Timestamp for the most recent IP packet to be transmitted and mapped to
   // this service data container (TS 132 298 - V8.4.0 : 5.1.2.2.22A)
   uint64_t time_of_last_usage_;
+  UsageRate usage_rate_;
+  // Moving average of the usage update round trip time, shared by all credits
+  static uint64_t report_rtt_ms_;
 
  private:
   void log_quota_and_usage() const;
 
+  void sample_usage_rate(uint64_t now_ms,
+                         SessionCreditUpdateCriteria* credit_uc);
+
+  /**
+   * @return true if usage updates are triggered from the consumption rate
+   */
+  bool is_rate_aware() const;
+
+  /**
+   * @return the quota to keep in reserve for a leg consuming rate bytes per
+   * second, so that a new grant arrives before it runs out
+   */
+  uint64_t get_rate_aware_reserve(uint64_t rate,
+                                  uint64_t current_granted_units) const;
+
   std::string get_percentage_usage(uint64_t allowed, uint64_t floor,
                                    uint64_t used) const;
 
@@ -202,7 +252,8 @@ class SessionCredit {
 
   bool compute_quota_exhausted(const uint64_t allowed, const uint64_t used,
                                float threshold_ratio,
-                               const uint64_t grantedUnits) const;
+                               const uint64_t grantedUnits,
+                               const uint64_t rate) const;
 
   uint64_t calculate_delta_allowed_floor(CreditUnit cu, Bucket allowed,
                                          Bucket floor,
@@ -97,6 +97,10 @@ SetInterfaceForUserPlaneAsyncService::SetInterfaceForUserPlaneAsyncService(
 void SetInterfaceForUserPlaneAsyncService::init_call_data() {
   MLOG(MINFO) << "Initializing new call data for SetUpfNodeStateCallData";
   new SetUPFNodeStateCallData(cq_.get(), *this, *handler_);
+  MLOG(MINFO) << "Initializing new call data for SetUPFSessionsConfig";
+  new SetUPFSessionsConfigCallData(cq_.get(), *this, *handler_);
+  MLOG(MINFO) << "Initializing new call data for ReconcileUPFSessions";
+  new ReconcileUPFSessionsCallData(cq_.get(), *this, *handler_);
   MLOG(MINFO) << "Initializing new call data for SendPagingRequest";
   new SendPagingRequestCallData(cq_.get(), *this, *handler_);
 }
@@ -353,6 +353,34 @@ class SetUPFSessionsConfigCallData
   UpfMsgManageHandler& handler_;
 };
 
+/*
+ *  Class to handle ReconcileUPFSessions
+ */
+class ReconcileUPFSessionsCallData
+    : public AsyncGRPCRequest<SetInterfaceForUserPlane::AsyncService,
+                              UPFSessionDigestReport, UPFSessionDigestResult> {
+ public:
+  ReconcileUPFSessionsCallData(ServerCompletionQueue* cq,
+                               SetInterfaceForUserPlane::AsyncService& service,
+                               UpfMsgManageHandler& handler)
+      : AsyncGRPCRequest(cq, service), handler_(handler) {
+    service_.RequestReconcileUPFSessions(&ctx_, &request_, &responder_, cq_,
+                                         cq_, (void*)this);
+  }
+
+ protected:
+  void clone() override {
+    new ReconcileUPFSessionsCallData(cq_, service_, handler_);
+  }
+
+  void process() override {
+    handler_.ReconcileUPFSessions(&ctx_, &request_, get_finish_callback());
+  }
+
+ private:
+  UpfMsgManageHandler& handler_;
+};
+
 /**
  * Class to handle CreateSession requests
  */
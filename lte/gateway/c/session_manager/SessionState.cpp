@@ -226,7 +226,9 @@ SessionState::SessionState(const std::string& imsi,
       session_level_key_("") {}
 
 /* get-set methods of new messages  for 5G*/
-uint32_t SessionState::get_current_version() { return current_version_; }
+uint32_t SessionState::get_current_version() const {
+  return current_version_;
+}
 
 void SessionState::set_current_version(uint32_t new_session_version,
                                        SessionStateUpdateCriteria* session_uc) {
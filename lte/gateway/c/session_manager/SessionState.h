@@ -156,7 +156,7 @@ class SessionState {
                const SessionConfig& cfg, StaticRuleStore& rule_store);
 
   /* methods of new messages of 5G and handle other message*/
-  uint32_t get_current_version();
+  uint32_t get_current_version() const;
 
   /* method to set update the session current version */
   void set_current_version(uint32_t new_session_version,
@@ -267,6 +267,8 @@ class SessionState {
 
   std::string get_imsi() const { return config_.common_context.sid().id(); }
 
+  std::string get_ue_ipv4() const { return config_.common_context.ue_ipv4(); }
+
   uint16_t get_shard_id() const { return shard_id_; }
 
   void set_shard_id(uint16_t shard_id) { shard_id_ = shard_id; }
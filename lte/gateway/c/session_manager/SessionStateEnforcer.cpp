@@ -736,6 +736,18 @@ void SessionStateEnforcer::handle_state_update_to_amf(
   return;
 }
 
+void SessionStateEnforcer::send_paging_notification_to_amf(
+    const std::string& imsi) {
+  magma::SetSmNotificationContext notif;
+  auto* req = notif.mutable_rat_specific_notification();
+  auto* req_cmn = notif.mutable_common_context();
+  // Sessions are keyed by the subscriber ID AMF created them with
+  req_cmn->mutable_sid()->set_id(imsi);
+  req->set_notify_ue_event(UE_PAGING_NOTIFY);
+  req->set_m5gsm_cause(magma::lte::M5GSMCause::OPERATION_SUCCESS);
+  amf_srv_client_->handle_notification_to_access(notif);
+}
+
 bool SessionStateEnforcer::default_and_static_rule_init() {
   // Static PDR, FAR, QDR, URR and BAR mapping  and also define 1 PDR and FAR
   SetGroupPDR reqpdr1;
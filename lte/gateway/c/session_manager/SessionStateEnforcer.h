@@ -160,6 +160,12 @@ class SessionStateEnforcer {
                                   const magma::lte::M5GSMCause m5gsmcause,
                                   NotifyUeEvents event);
 
+  /*
+   * Send a paging notification to AMF for an idle subscriber, without
+   * reading its sessions
+   */
+  void send_paging_notification_to_amf(const std::string& imsi);
+
   /* Get next teid */
   uint32_t get_next_teid();
 
@@ -50,6 +50,7 @@ SessionStore::SessionStore(
 
 bool SessionStore::raw_write_sessions(SessionMap session_map) {
   // return true;
+  index_upf_sessions(session_map);
   return store_client_->write_sessions(std::move(session_map));
 }
 
@@ -65,7 +66,15 @@ void SessionStore::set_and_save_reporting_flag(
     bool value, const UpdateSessionRequest& update_session_request,
     SessionUpdate& session_uc) {
   MLOG(MDEBUG) << "saving flag is_reporting = " << value << " on session store";
-  auto session_map = store_client_->read_all_sessions();
+  // Usage is reported in chunks, only read the subscribers of this one
+  auto subscriber_ids = std::set<std::string>{};
+  for (const auto& credit_update : update_session_request.updates()) {
+    subscriber_ids.insert(credit_update.common_context().sid().id());
+  }
+  for (const auto& monitor_update : update_session_request.usage_monitors()) {
+    subscriber_ids.insert(monitor_update.sid());
+  }
+  auto session_map = store_client_->read_sessions(subscriber_ids);
 
   for (const CreditUsageUpdate& credit_update :
        update_session_request.updates()) {
@@ -164,6 +173,7 @@ bool SessionStore::create_sessions(const std::string& subscriber_id,
                                    SessionVector sessions) {
   auto session_map = SessionMap{};
   session_map[subscriber_id] = std::move(sessions);
+  index_upf_sessions(session_map);
   store_client_->write_sessions(std::move(session_map));
   return true;
 }
@@ -206,9 +216,23 @@ bool SessionStore::update_sessions(const SessionUpdate& update_criteria) {
       ++it2;
     }
   }
+  index_upf_sessions(session_map);
   return store_client_->write_sessions(std::move(session_map));
 }
 
+void SessionStore::initialize_upf_session_digest() {
+  upf_session_digest_.clear();
+  index_upf_sessions(store_client_->read_all_sessions());
+  MLOG(MINFO) << "Indexed " << upf_session_digest_.size()
+              << " UPF sessions on startup";
+}
+
+void SessionStore::index_upf_sessions(const SessionMap& session_map) {
+  for (const auto& it : session_map) {
+    upf_session_digest_.update_subscriber(it.first, it.second);
+  }
+}
+
 void SessionStore::initialize_metering_counter() {
   auto session_map = store_client_->read_all_sessions();
   for (auto& sessions_by_imsi : session_map) {
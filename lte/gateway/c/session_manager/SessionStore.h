@@ -27,6 +27,7 @@
 #include "SessionState.h"
 #include "StoreClient.h"
 #include "StoredState.h"
+#include "UpfSessionDigest.h"
 
 namespace magma {
 class StaticRuleStore;
@@ -225,10 +226,23 @@ class SessionStore {
    */
   void initialize_metering_counter();
 
+  /**
+   * Index the sessions found in the store on startup, the index is then kept
+   * up to date by create_sessions, update_sessions and raw_write_sessions
+   */
+  void initialize_upf_session_digest();
+
+  const UpfSessionDigest& get_upf_session_digest() const {
+    return upf_session_digest_;
+  }
+
  private:
   std::shared_ptr<StaticRuleStore> rule_store_;
   std::shared_ptr<StoreClient> store_client_;
   std::shared_ptr<MeteringReporter> metering_reporter_;
+  UpfSessionDigest upf_session_digest_;
+
+  void index_upf_sessions(const SessionMap& session_map);
 };
 
 }  // namespace lte
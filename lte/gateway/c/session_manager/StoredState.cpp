@@ -208,6 +208,14 @@ std::string serialize_stored_session_credit(StoredSessionCredit& stored) {
   marshaled["report_last_credit"] = stored.report_last_credit;
   marshaled["time_of_first_usage"] = std::to_string(stored.time_of_first_usage);
   marshaled["time_of_last_usage"] = std::to_string(stored.time_of_last_usage);
+  const auto& rate = stored.usage_rate;
+  marshaled["usage_rate"] = folly::dynamic::object(
+      "sample_time_ms", std::to_string(rate.sample_time_ms))(
+      "sample_used_tx", std::to_string(rate.sample_used_tx))(
+      "sample_used_rx", std::to_string(rate.sample_used_rx))(
+      "sample_interval_ms", std::to_string(rate.sample_interval_ms))(
+      "rate_tx", std::to_string(rate.rate_tx))(
+      "rate_rx", std::to_string(rate.rate_rx));
 
   for (int bucket_int = USED_TX; bucket_int != BUCKET_ENUM_MAX_VALUE;
        bucket_int++) {
@@ -241,6 +249,21 @@ StoredSessionCredit deserialize_stored_session_credit(
       std::stoul(marshaled["time_of_first_usage"].getString()));
   stored.time_of_last_usage = static_cast<uint64_t>(
       std::stoul(marshaled["time_of_last_usage"].getString()));
+  // Credits stored by older versions have no usage rate yet
+  if (marshaled.count("usage_rate")) {
+    const auto& marshaled_rate = marshaled["usage_rate"];
+    auto get_field = [&marshaled_rate](const char* field) {
+      return static_cast<uint64_t>(
+          std::stoul(marshaled_rate[field].getString()));
+    };
+    auto& rate = stored.usage_rate;
+    rate.sample_time_ms = get_field("sample_time_ms");
+    rate.sample_used_tx = get_field("sample_used_tx");
+    rate.sample_used_rx = get_field("sample_used_rx");
+    rate.sample_interval_ms = get_field("sample_interval_ms");
+    rate.rate_tx = get_field("rate_tx");
+    rate.rate_rx = get_field("rate_rx");
+  }
 
   for (int bucket_int = USED_TX; bucket_int != BUCKET_ENUM_MAX_VALUE;
        bucket_int++) {
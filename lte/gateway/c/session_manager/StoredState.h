@@ -36,6 +36,19 @@
 namespace magma {
 using std::experimental::optional;
 
+// Consumption rate of a credit, sampled from the usage reported by PipelineD
+struct UsageRate {
+  // Time of the last sample, and the usage at that time
+  uint64_t sample_time_ms;
+  uint64_t sample_used_tx;
+  uint64_t sample_used_rx;
+  // Time between the last two samples, 0 until a rate is known
+  uint64_t sample_interval_ms;
+  // Moving averages in bytes per second
+  uint64_t rate_tx;
+  uint64_t rate_rx;
+};
+
 struct StoredSessionCredit {
   bool reporting;
   CreditLimitType credit_limit_type;
@@ -45,6 +58,7 @@ struct StoredSessionCredit {
   bool report_last_credit;
   uint64_t time_of_first_usage;
   uint64_t time_of_last_usage;
+  UsageRate usage_rate;
 };
 
 struct StoredMonitor {
@@ -121,6 +135,7 @@ struct SessionCreditUpdateCriteria {
 
   uint64_t time_of_first_usage;
   uint64_t time_of_last_usage;
+  UsageRate usage_rate;
 
   bool suspended;
 };
@@ -11,6 +11,7 @@
 #include "UpfMsgManageHandler.h"
 
 #include <arpa/inet.h>
+#include <chrono>
 #include <folly/io/async/EventBase.h>
 #include <glog/logging.h>
 #include <grpcpp/impl/codegen/status.h>
@@ -20,6 +21,7 @@
 #include <memory>
 #include <ostream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "GrpcMagmaUtils.h"
@@ -28,11 +30,13 @@
 #include "SessionStateEnforcer.h"
 #include "SessionStore.h"
 #include "Types.h"
+#include "UpfSessionDigest.h"
 #include "lte/protos/mobilityd.pb.h"
 #include "lte/protos/session_manager.pb.h"
 #include "lte/protos/subscriberdb.pb.h"
 #include "magma_logging.h"
 #include "Utilities.h"
+#include "includes/MetricsHelpers.h"
 
 namespace google {
 namespace protobuf {
@@ -45,6 +49,13 @@ class ServerContext;
 
 using grpc::Status;
 
+namespace {
+// Time from the UPF paging request to the notification sent to AMF
+const char* PAGING_LATENCY_HISTOGRAM = "upf_paging_notify_latency_ms";
+// How the session was resolved: "local" index or "mobilityd"
+const char* LABEL_LOOKUP = "lookup";
+}  // namespace
+
 namespace magma {
 /**
  * SetInterfaceForUserPlaneHandler processes gRPC requests for the sessionD
@@ -107,62 +118,175 @@ void UpfMsgManageHandler::SetUPFSessionsConfig(
     ServerContext* context, const UPFSessionConfigState* sess_config,
     std::function<void(Status, SmContextVoid)> response_callback) {
   auto& ses_config = *sess_config;
-  int32_t count = 0;
-  conv_enforcer_->get_event_base().runInEventBaseThread([this, &count,
-                                                         ses_config]() {
+  conv_enforcer_->get_event_base().runInEventBaseThread([this, ses_config]() {
+    const UpfSessionDigest& digest = session_store_.get_upf_session_digest();
+    std::unordered_map<std::string, std::vector<uint32_t>> to_resend;
+    int32_t count = 0;
     for (auto& upf_session : ses_config.upf_session_state()) {
-      // Deleting the IMSI prefix from imsi
-      std::string imsi_upf = upf_session.subscriber_id();
-      std::string imsi = imsi_upf.substr(4, imsi_upf.length() - 4);
       uint32_t version = upf_session.session_version();
       uint32_t teid = upf_session.local_f_teid();
-      auto session_map = session_store_.read_sessions({imsi});
-      /* Search with session search criteria of IMSI and session_id and
-       * find  respective session to operate
-       */
-      SessionSearchCriteria criteria(imsi, IMSI_AND_TEID, teid);
-      auto session_it = session_store_.find_session(session_map, criteria);
-      if (!session_it) {
-        MLOG(MERROR) << "No session found in SessionMap for IMSI " << imsi
-                     << " with teid " << teid;
+      // The index answers without reading the session, only outdated
+      // sessions are read to be resent
+      const auto* entry = digest.find(teid);
+      if (!entry) {
+        MLOG(MERROR) << "No session found in SessionMap for IMSI "
+                     << upf_session.subscriber_id() << " with teid " << teid;
         continue;
       }
-      auto& session = **session_it;
-      auto cur_version = session->get_current_version();
-      if (version < cur_version) {
-        MLOG(MINFO) << "UPF verions of session imsi " << imsi << " of  teid "
-                    << teid << " recevied version " << version
-                    << " SMF latest version: " << cur_version << " Resending";
-        if (conv_enforcer_->is_incremented_rtx_counter_within_max(session)) {
-          RulesToProcess pending_activation, pending_deactivation;
-          const CreateSessionResponse& csr =
-              session->get_create_session_response();
-          std::vector<StaticRuleInstall> static_rule_installs =
-              conv_enforcer_->to_vec(csr.static_rules());
-          std::vector<DynamicRuleInstall> dynamic_rule_installs =
-              conv_enforcer_->to_vec(csr.dynamic_rules());
-
-          session->process_get_5g_rule_installs(
-              static_rule_installs, dynamic_rule_installs, &pending_activation,
-              &pending_deactivation);
-          conv_enforcer_->m5g_send_session_request_to_upf(
-              session, pending_activation, pending_deactivation);
-        }
+      if (version < entry->version) {
+        MLOG(MINFO) << "UPF verions of session imsi " << entry->imsi
+                    << " of  teid " << teid << " recevied version " << version
+                    << " SMF latest version: " << entry->version
+                    << " Resending";
+        to_resend[entry->imsi].push_back(teid);
       } else {
         count++;
       }
     }
-#if 0
+    resend_sessions_to_upf(to_resend);
     if (ses_config.upf_session_state_size() != count) {
       MLOG(MINFO) << "UPF periodic report config missmatch session:"
                   << (ses_config.upf_session_state_size() - count);
     }
-#endif
   });
   response_callback(Status::OK, SmContextVoid());
   return;
 }
 
+void UpfMsgManageHandler::ReconcileUPFSessions(
+    ServerContext* context, const UPFSessionDigestReport* digest_report,
+    std::function<void(Status, UPFSessionDigestResult)> response_callback) {
+  auto& report = *digest_report;
+  if (report.bucket_count() != UpfSessionDigest::BUCKET_COUNT) {
+    MLOG(MERROR) << "UPF session digest over " << report.bucket_count()
+                 << " buckets, SMF uses " << UpfSessionDigest::BUCKET_COUNT;
+    response_callback(
+        Status(grpc::INVALID_ARGUMENT, "Unexpected session bucket count"),
+        UPFSessionDigestResult());
+    return;
+  }
+  auto is_valid_range = [](const UPFSessionRangeDigest& range) {
+    return range.bucket_start() < range.bucket_end() &&
+           range.bucket_end() <= UpfSessionDigest::BUCKET_COUNT;
+  };
+  for (const auto& range : report.range_digests()) {
+    if (!is_valid_range(range)) {
+      response_callback(Status(grpc::INVALID_ARGUMENT, "Invalid bucket range"),
+                        UPFSessionDigestResult());
+      return;
+    }
+  }
+  for (const auto& range : report.listed_ranges()) {
+    if (!is_valid_range(range)) {
+      response_callback(Status(grpc::INVALID_ARGUMENT, "Invalid bucket range"),
+                        UPFSessionDigestResult());
+      return;
+    }
+  }
+
+  conv_enforcer_->get_event_base().runInEventBaseThread([this, report,
+                                                         response_callback]() {
+    const UpfSessionDigest& digest = session_store_.get_upf_session_digest();
+    UPFSessionDigestResult result;
+    for (const auto& range : report.range_digests()) {
+      auto smf_range =
+          digest.get_range_digest(range.bucket_start(), range.bucket_end());
+      if (smf_range.session_count == range.session_count() &&
+          smf_range.digest == range.digest()) {
+        continue;
+      }
+      auto* mismatch = result.add_mismatching_ranges();
+      mismatch->set_bucket_start(range.bucket_start());
+      mismatch->set_bucket_end(range.bucket_end());
+      mismatch->set_session_count(smf_range.session_count);
+      mismatch->set_digest(smf_range.digest);
+    }
+
+    std::unordered_map<uint32_t, uint32_t> upf_versions;
+    for (const auto& upf_session : report.upf_session_state()) {
+      upf_versions[upf_session.local_f_teid()] = upf_session.session_version();
+    }
+    // Sessions of the listed ranges the UPF lacks or holds an older version of
+    std::unordered_map<std::string, std::vector<uint32_t>> to_resend;
+    for (const auto& range : report.listed_ranges()) {
+      for (uint32_t teid :
+           digest.get_teids(range.bucket_start(), range.bucket_end())) {
+        const auto* entry = digest.find(teid);
+        auto it = upf_versions.find(teid);
+        if (it != upf_versions.end() && it->second >= entry->version) {
+          continue;
+        }
+        MLOG(MINFO) << "UPF version of session imsi " << entry->imsi
+                    << " of teid " << teid << " is "
+                    << (it == upf_versions.end() ? 0 : it->second)
+                    << ", SMF latest version: " << entry->version
+                    << " Resending";
+        to_resend[entry->imsi].push_back(teid);
+      }
+    }
+    for (const auto& upf_session : report.upf_session_state()) {
+      if (!digest.find(upf_session.local_f_teid())) {
+        MLOG(MERROR) << "No session found in SessionMap for IMSI "
+                     << upf_session.subscriber_id() << " with teid "
+                     << upf_session.local_f_teid();
+      }
+    }
+    result.set_resent_sessions(resend_sessions_to_upf(to_resend));
+    if (result.mismatching_ranges_size() || result.resent_sessions()) {
+      MLOG(MDEBUG) << "UPF session reconciliation: "
+                   << result.mismatching_ranges_size() << " of "
+                   << report.range_digests_size()
+                   << " ranges mismatching, " << result.resent_sessions()
+                   << " sessions resent";
+    }
+    response_callback(Status::OK, result);
+  });
+}
+
+uint32_t UpfMsgManageHandler::resend_sessions_to_upf(
+    const std::unordered_map<std::string, std::vector<uint32_t>>&
+        teids_by_imsi) {
+  if (teids_by_imsi.empty()) {
+    return 0;
+  }
+  SessionRead imsis;
+  for (const auto& it : teids_by_imsi) {
+    imsis.insert(it.first);
+  }
+  auto session_map = session_store_.read_sessions(imsis);
+  uint32_t resent = 0;
+  for (const auto& it : teids_by_imsi) {
+    const std::string& imsi = it.first;
+    for (uint32_t teid : it.second) {
+      SessionSearchCriteria criteria(imsi, IMSI_AND_TEID, teid);
+      auto session_it = session_store_.find_session(session_map, criteria);
+      if (!session_it) {
+        MLOG(MERROR) << "No session found in SessionMap for IMSI " << imsi
+                     << " with teid " << teid;
+        continue;
+      }
+      auto& session = **session_it;
+      if (!conv_enforcer_->is_incremented_rtx_counter_within_max(session)) {
+        continue;
+      }
+      RulesToProcess pending_activation, pending_deactivation;
+      const CreateSessionResponse& csr = session->get_create_session_response();
+      std::vector<StaticRuleInstall> static_rule_installs =
+          conv_enforcer_->to_vec(csr.static_rules());
+      std::vector<DynamicRuleInstall> dynamic_rule_installs =
+          conv_enforcer_->to_vec(csr.dynamic_rules());
+
+      session->process_get_5g_rule_installs(
+          static_rule_installs, dynamic_rule_installs, &pending_activation,
+          &pending_deactivation);
+      conv_enforcer_->m5g_send_session_request_to_upf(
+          session, pending_activation, pending_deactivation);
+      resent++;
+    }
+  }
+  return resent;
+}
+
 void UpfMsgManageHandler::SendPagingRequest(
     ServerContext* context, const UPFPagingInfo* page_request,
     std::function<void(Status, SmContextVoid)> response_callback) {
@@ -170,6 +294,33 @@ void UpfMsgManageHandler::SendPagingRequest(
 
   uint32_t fte_id = pag_req.local_f_teid();
   std::string ip_addr = pag_req.ue_ip_addr();
+  auto received = std::chrono::steady_clock::now();
+  conv_enforcer_->get_event_base().runInEventBaseThread(
+      [this, fte_id, ip_addr, received, response_callback]() {
+        // Resolve the session locally, MobilityD is only asked for sessions
+        // missing from the index
+        const UpfSessionDigest& index = session_store_.get_upf_session_digest();
+        uint32_t teid = fte_id;
+        const auto* entry = index.find(teid);
+        if (!entry) {
+          teid = index.find_teid_by_ue_ipv4(ip_addr);
+          entry = teid ? index.find(teid) : nullptr;
+        }
+        if (entry) {
+          page_indexed_session(*entry, teid, received, response_callback);
+          return;
+        }
+        MLOG(MDEBUG) << "No indexed session for paging of teid " << fte_id
+                     << " and ip " << ip_addr << ", asking MobilityD";
+        get_subscriberid_from_mobilityd(fte_id, ip_addr, received,
+                                        response_callback);
+      });
+}
+
+void UpfMsgManageHandler::get_subscriberid_from_mobilityd(
+    uint32_t fte_id, const std::string& ip_addr,
+    std::chrono::steady_clock::time_point received,
+    std::function<void(Status, SmContextVoid)> response_callback) {
   struct in_addr ue_ip;
   IPAddress req = IPAddress();
 
@@ -178,68 +329,105 @@ void UpfMsgManageHandler::SendPagingRequest(
   req.set_address(&ue_ip, sizeof(struct in_addr));
 
   mobilityd_client_->get_subscriberid_from_ipv4(
-      req, [this, fte_id, response_callback](Status status,
-                                             const SubscriberID& sid) {
+      req, [this, fte_id, received, response_callback](
+               Status status, const SubscriberID& sid) {
         if (!status.ok()) {
           MLOG(MERROR) << "Subscriber could not be found for ip ";
         }
         std::string imsi = prepend_imsi_with_prefix(sid.id());
-        get_session_from_imsi(imsi, fte_id, response_callback);
+        get_session_from_imsi(imsi, fte_id, received, response_callback);
         return;
       });
 }
 
 void UpfMsgManageHandler::get_session_from_imsi(
     const std::string& imsi, uint32_t te_id,
+    std::chrono::steady_clock::time_point received,
     std::function<void(Status, SmContextVoid)> response_callback) {
-  conv_enforcer_->get_event_base().runInEventBaseThread([this, imsi, te_id,
-                                                         response_callback]() {
-    if (!imsi.length()) {
-      MLOG(MERROR) << "get_subscriberid_from_ipv4 for IP"
-                      "returned an empty subscriber ID";
-      Status status(grpc::NOT_FOUND,
-                    "Session Not found because"
-                    "subscriber ID not found for IP");
-      response_callback(status, SmContextVoid());
-      return;
-    }
+  conv_enforcer_->get_event_base().runInEventBaseThread(
+      [this, imsi, te_id, received, response_callback]() {
+        if (!imsi.length()) {
+          MLOG(MERROR) << "get_subscriberid_from_ipv4 for IP"
+                          "returned an empty subscriber ID";
+          Status status(grpc::NOT_FOUND,
+                        "Session Not found because"
+                        "subscriber ID not found for IP");
+          response_callback(status, SmContextVoid());
+          return;
+        }
+        page_session(imsi, te_id, received, "mobilityd", response_callback);
+      });
+}
 
-    // retrieve session_map entry
-    auto session_map = session_store_.read_sessions({imsi});
-    /* Search with session search criteria of IMSI and session_id and
-     * find  respective session to operate
-     */
-    SessionSearchCriteria criteria(imsi, IMSI_AND_TEID, te_id);
-
-    auto session_it = session_store_.find_session(session_map, criteria);
-    if (!session_it) {
-      MLOG(MERROR) << "No session found in SessionMap for IMSI " << imsi
-                   << " with teid " << te_id;
-      Status status(grpc::NOT_FOUND,
-                    "Session was not found for IMSI with teid");
-      response_callback(status, SmContextVoid());
-      return;
-    }
+void UpfMsgManageHandler::page_session(
+    const std::string& imsi, uint32_t te_id,
+    std::chrono::steady_clock::time_point received, const char* lookup,
+    std::function<void(Status, SmContextVoid)> response_callback) {
+  // retrieve session_map entry
+  auto session_map = session_store_.read_sessions({imsi});
+  /* Search with session search criteria of IMSI and session_id and
+   * find  respective session to operate
+   */
+  SessionSearchCriteria criteria(imsi, IMSI_AND_TEID, te_id);
 
-    auto& session = **session_it;
-    MLOG(MINFO) << "IDLE_MODE::: Session found in SendingPaging "
-                   "Request of imsi: "
-                << imsi << "  session_id: " << session->get_session_id();
-    /* Generate Paging notification to AMF, only if session is in INACTIVE
-     * state.
-     */
-    if (session->get_state() == INACTIVE) {
-      conv_enforcer_->handle_state_update_to_amf(
-          *session, magma::lte::M5GSMCause::OPERATION_SUCCESS,
-          UE_PAGING_NOTIFY);
-      MLOG(MDEBUG) << "UPF Paging notification forwarded to AMF of imsi:"
-                   << imsi;
-      response_callback(Status::OK, SmContextVoid());
-    } else {
-      MLOG(MDEBUG) << "Can not Trigger Paging notification to AMF, as session "
-                      "is not an INACTIVE state.";
-      return;
-    }
-  });
+  auto session_it = session_store_.find_session(session_map, criteria);
+  if (!session_it) {
+    MLOG(MERROR) << "No session found in SessionMap for IMSI " << imsi
+                 << " with teid " << te_id;
+    Status status(grpc::NOT_FOUND, "Session was not found for IMSI with teid");
+    response_callback(status, SmContextVoid());
+    return;
+  }
+
+  auto& session = **session_it;
+  MLOG(MINFO) << "IDLE_MODE::: Session found in SendingPaging "
+                 "Request of imsi: "
+              << imsi << "  session_id: " << session->get_session_id();
+  /* Generate Paging notification to AMF, only if session is in INACTIVE
+   * state.
+   */
+  if (session->get_state() != INACTIVE) {
+    MLOG(MDEBUG) << "Can not Trigger Paging notification to AMF, as session "
+                    "is not an INACTIVE state.";
+    response_callback(
+        Status(grpc::FAILED_PRECONDITION, "Session is not INACTIVE"),
+        SmContextVoid());
+    return;
+  }
+  conv_enforcer_->handle_state_update_to_amf(
+      *session, magma::lte::M5GSMCause::OPERATION_SUCCESS, UE_PAGING_NOTIFY);
+  observe_paging_latency(received, lookup);
+  MLOG(MDEBUG) << "UPF Paging notification forwarded to AMF of imsi:" << imsi;
+  response_callback(Status::OK, SmContextVoid());
+}
+
+void UpfMsgManageHandler::page_indexed_session(
+    const UpfSessionDigest::Entry& entry, uint32_t te_id,
+    std::chrono::steady_clock::time_point received,
+    std::function<void(Status, SmContextVoid)> response_callback) {
+  // The index follows every session write, the store is not read
+  if (!entry.inactive) {
+    MLOG(MDEBUG) << "Can not Trigger Paging notification to AMF, as session "
+                    "with teid "
+                 << te_id << " is not an INACTIVE state.";
+    response_callback(
+        Status(grpc::FAILED_PRECONDITION, "Session is not INACTIVE"),
+        SmContextVoid());
+    return;
+  }
+  conv_enforcer_->send_paging_notification_to_amf(entry.imsi);
+  observe_paging_latency(received, "local");
+  MLOG(MDEBUG) << "UPF Paging notification forwarded to AMF of imsi:"
+               << entry.imsi;
+  response_callback(Status::OK, SmContextVoid());
+}
+
+void UpfMsgManageHandler::observe_paging_latency(
+    std::chrono::steady_clock::time_point received, const char* lookup) {
+  std::chrono::duration<double, std::milli> latency =
+      std::chrono::steady_clock::now() - received;
+  // Buckets in milliseconds
+  observe_histogram(PAGING_LATENCY_HISTOGRAM, latency.count(), size_t(1),
+                    LABEL_LOOKUP, lookup, size_t(5), 1., 5., 10., 50., 100.);
 }
 }  // end namespace magma
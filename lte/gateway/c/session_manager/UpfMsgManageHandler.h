@@ -15,9 +15,12 @@
 #include <grpc++/grpc++.h>
 #include <lte/protos/session_manager.grpc.pb.h>
 #include <stdint.h>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "MobilitydClient.h"
 #include "SessionID.h"
@@ -40,6 +43,8 @@ class SmContextVoid;
 class UPFNodeState;
 class UPFPagingInfo;
 class UPFSessionConfigState;
+class UPFSessionDigestReport;
+class UPFSessionDigestResult;
 }  // namespace lte
 }  // namespace magma
 
@@ -73,6 +78,15 @@ class UpfMsgHandler {
       ServerContext* context, const UPFSessionConfigState* sess_config,
       std::function<void(Status, SmContextVoid)> response_callback) = 0;
 
+  /**
+   * Periodic digests of the UPF sessions over ranges of TEID buckets,
+   * answered with the ranges that do not match the SMF
+   */
+  virtual void ReconcileUPFSessions(
+      ServerContext* context, const UPFSessionDigestReport* digest_report,
+      std::function<void(Status, UPFSessionDigestResult)>
+          response_callback) = 0;
+
   // Paging Notification handling
   virtual void SendPagingRequest(
       ServerContext* context, const UPFPagingInfo* paging_req,
@@ -109,6 +123,15 @@ class UpfMsgManageHandler : public UpfMsgHandler {
       ServerContext* context, const UPFSessionConfigState* sess_config,
       std::function<void(Status, SmContextVoid)> response_callback);
 
+  /**
+   * Periodic digests of the UPF sessions over ranges of TEID buckets. The
+   * sessions of the ranges the UPF lists are compared one by one, and the
+   * ones the UPF lacks or holds an older version of are resent
+   */
+  virtual void ReconcileUPFSessions(
+      ServerContext* context, const UPFSessionDigestReport* digest_report,
+      std::function<void(Status, UPFSessionDigestResult)> response_callback);
+
   virtual void SendPagingRequest(
       ServerContext* context, const UPFPagingInfo* paging_req,
       std::function<void(Status, SmContextVoid)> response_callback);
@@ -118,9 +141,45 @@ class UpfMsgManageHandler : public UpfMsgHandler {
   std::shared_ptr<SessionStateEnforcer> conv_enforcer_;
   std::shared_ptr<MobilitydClient> mobilityd_client_;
 
+  void get_subscriberid_from_mobilityd(
+      uint32_t fte_id, const std::string& ip_addr,
+      std::chrono::steady_clock::time_point received,
+      std::function<void(Status, SmContextVoid)> response_callback);
+
   void get_session_from_imsi(
       const std::string& imsi, uint32_t te_id,
+      std::chrono::steady_clock::time_point received,
       std::function<void(Status, SmContextVoid)> response_callback);
+
+  /**
+   * Notify AMF of downlink data for an INACTIVE session, on the event base
+   * @param lookup - how the session was resolved, for the latency metric
+   */
+  void page_session(
+      const std::string& imsi, uint32_t te_id,
+      std::chrono::steady_clock::time_point received, const char* lookup,
+      std::function<void(Status, SmContextVoid)> response_callback);
+
+  /**
+   * Notify AMF of downlink data for a session found in the UPF session
+   * index, on the event base
+   */
+  void page_indexed_session(
+      const UpfSessionDigest::Entry& entry, uint32_t te_id,
+      std::chrono::steady_clock::time_point received,
+      std::function<void(Status, SmContextVoid)> response_callback);
+
+  void observe_paging_latency(std::chrono::steady_clock::time_point received,
+                              const char* lookup);
+
+  /**
+   * Resend sessions to the UPF, within their retransmission limit
+   * @param teids_by_imsi - local TEIDs of the sessions to resend
+   * @return the number of sessions resent
+   */
+  uint32_t resend_sessions_to_upf(
+      const std::unordered_map<std::string, std::vector<uint32_t>>&
+          teids_by_imsi);
 };
 
 }  // namespace magma
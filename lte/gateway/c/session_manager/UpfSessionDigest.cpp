@@ -0,0 +1,162 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "UpfSessionDigest.h"
+
+#include <algorithm>
+
+#include "Types.h"
+
+namespace magma {
+
+UpfSessionDigest::UpfSessionDigest() : buckets_(BUCKET_COUNT, Bucket{0, {}}) {}
+
+uint64_t UpfSessionDigest::hash_session(uint32_t teid, uint32_t version) {
+  // SplitMix64 finalizer
+  uint64_t z = ((static_cast<uint64_t>(teid) << 32) | version) +
+               0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+bool UpfSessionDigest::is_held_by_upf(const SessionState& session) {
+  if (!session.is_5g_session() || !session.get_upf_local_teid()) {
+    return false;
+  }
+  switch (session.get_state()) {
+    case CREATED:
+    case SESSION_ACTIVE:
+    case INACTIVE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+void UpfSessionDigest::update_subscriber(
+    const std::string& imsi,
+    const std::vector<std::unique_ptr<SessionState>>& sessions) {
+  auto it = teids_by_imsi_.find(imsi);
+  if (it != teids_by_imsi_.end()) {
+    for (uint32_t teid : it->second) {
+      erase(teid);
+    }
+    teids_by_imsi_.erase(it);
+  }
+  std::vector<uint32_t> teids;
+  for (const auto& session : sessions) {
+    if (!is_held_by_upf(*session)) {
+      continue;
+    }
+    uint32_t teid = session->get_upf_local_teid();
+    insert(teid, imsi, session->get_current_version(),
+           session->get_ue_ipv4(), session->get_state() == INACTIVE);
+    teids.push_back(teid);
+  }
+  if (!teids.empty()) {
+    teids_by_imsi_[imsi] = std::move(teids);
+  }
+}
+
+void UpfSessionDigest::clear() {
+  for (auto& bucket : buckets_) {
+    bucket.digest = 0;
+    bucket.teids.clear();
+  }
+  sessions_.clear();
+  teids_by_imsi_.clear();
+  teids_by_ue_ipv4_.clear();
+}
+
+UpfSessionDigest::RangeDigest UpfSessionDigest::get_range_digest(
+    uint32_t bucket_start, uint32_t bucket_end) const {
+  RangeDigest range{0, 0};
+  for (uint32_t i = bucket_start; i < bucket_end; i++) {
+    range.session_count += buckets_[i].teids.size();
+    range.digest ^= buckets_[i].digest;
+  }
+  return range;
+}
+
+const UpfSessionDigest::Entry* UpfSessionDigest::find(uint32_t teid) const {
+  auto it = sessions_.find(teid);
+  if (it == sessions_.end()) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
+uint32_t UpfSessionDigest::find_teid_by_ue_ipv4(
+    const std::string& ue_ipv4) const {
+  auto it = teids_by_ue_ipv4_.find(ue_ipv4);
+  if (it == teids_by_ue_ipv4_.end()) {
+    return 0;
+  }
+  return it->second;
+}
+
+std::vector<uint32_t> UpfSessionDigest::get_teids(uint32_t bucket_start,
+                                                  uint32_t bucket_end) const {
+  std::vector<uint32_t> teids;
+  for (uint32_t i = bucket_start; i < bucket_end; i++) {
+    teids.insert(teids.end(), buckets_[i].teids.begin(),
+                 buckets_[i].teids.end());
+  }
+  return teids;
+}
+
+void UpfSessionDigest::insert(uint32_t teid, const std::string& imsi,
+                              uint32_t version, const std::string& ue_ipv4,
+                              bool inactive) {
+  // A TEID is only reused once its session is gone, drop a stale owner
+  auto it = sessions_.find(teid);
+  if (it != sessions_.end()) {
+    auto owner_it = teids_by_imsi_.find(it->second.imsi);
+    if (owner_it != teids_by_imsi_.end()) {
+      auto& stale_teids = owner_it->second;
+      stale_teids.erase(
+          std::remove(stale_teids.begin(), stale_teids.end(), teid),
+          stale_teids.end());
+      if (stale_teids.empty()) {
+        teids_by_imsi_.erase(owner_it);
+      }
+    }
+    erase(teid);
+  }
+  sessions_[teid] = Entry{imsi, version, ue_ipv4, inactive};
+  if (!ue_ipv4.empty()) {
+    teids_by_ue_ipv4_[ue_ipv4] = teid;
+  }
+  Bucket& bucket = buckets_[get_bucket(teid)];
+  bucket.digest ^= hash_session(teid, version);
+  bucket.teids.push_back(teid);
+}
+
+void UpfSessionDigest::erase(uint32_t teid) {
+  auto it = sessions_.find(teid);
+  if (it == sessions_.end()) {
+    return;
+  }
+  Bucket& bucket = buckets_[get_bucket(teid)];
+  bucket.digest ^= hash_session(teid, it->second.version);
+  bucket.teids.erase(std::find(bucket.teids.begin(), bucket.teids.end(), teid));
+  // The address may have moved to a newer session already
+  auto ip_it = teids_by_ue_ipv4_.find(it->second.ue_ipv4);
+  if (ip_it != teids_by_ue_ipv4_.end() && ip_it->second == teid) {
+    teids_by_ue_ipv4_.erase(ip_it);
+  }
+  sessions_.erase(it);
+}
+
+}  // namespace magma
@@ -0,0 +1,123 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SessionState.h"
+
+namespace magma {
+
+/**
+ * UpfSessionDigest indexes by local TEID the 5G sessions the UPF is expected
+ * to hold, along with their version, and keeps a digest per TEID bucket. The
+ * UPF reports digests over ranges of buckets, so that only the ranges which
+ * differ need to be looked into session by session.
+ *
+ * The index is kept up to date by SessionStore on every write, and answers
+ * range digests and TEID or UE IPv4 lookups without reading the sessions.
+ * The UE IPv4 lookup lets downlink data notifications of idle sessions be
+ * resolved without asking MobilityD.
+ */
+class UpfSessionDigest {
+ public:
+  static constexpr uint32_t BUCKET_COUNT = 4096;
+
+  struct Entry {
+    std::string imsi;
+    uint32_t version;
+    std::string ue_ipv4;
+    // Set while the UE is idle, paging is only sent for inactive sessions
+    bool inactive;
+  };
+
+  struct RangeDigest {
+    uint32_t session_count;
+    uint64_t digest;
+  };
+
+  UpfSessionDigest();
+
+  /**
+   * @return the hash a session contributes to the digest of its bucket, the
+   * UPF computes the same
+   */
+  static uint64_t hash_session(uint32_t teid, uint32_t version);
+
+  static uint32_t get_bucket(uint32_t teid) { return teid % BUCKET_COUNT; }
+
+  /**
+   * @return true for 5G sessions which have been installed in the UPF and
+   * are not being released
+   */
+  static bool is_held_by_upf(const SessionState& session);
+
+  /**
+   * Replace the indexed sessions of a subscriber with the ones given
+   * @param imsi
+   * @param sessions - all the sessions of the subscriber, none if it is gone
+   */
+  void update_subscriber(
+      const std::string& imsi,
+      const std::vector<std::unique_ptr<SessionState>>& sessions);
+
+  void clear();
+
+  /**
+   * @return the session count and digest of buckets [bucket_start,
+   * bucket_end), which must be within BUCKET_COUNT
+   */
+  RangeDigest get_range_digest(uint32_t bucket_start,
+                               uint32_t bucket_end) const;
+
+  /**
+   * @return the indexed session with the local TEID, nullptr if none
+   */
+  const Entry* find(uint32_t teid) const;
+
+  /**
+   * @return the local TEID of the indexed session with the UE IPv4 address,
+   * 0 if none
+   */
+  uint32_t find_teid_by_ue_ipv4(const std::string& ue_ipv4) const;
+
+  /**
+   * @return the local TEIDs of the sessions in buckets [bucket_start,
+   * bucket_end)
+   */
+  std::vector<uint32_t> get_teids(uint32_t bucket_start,
+                                  uint32_t bucket_end) const;
+
+  size_t size() const { return sessions_.size(); }
+
+ private:
+  struct Bucket {
+    uint64_t digest;
+    std::vector<uint32_t> teids;
+  };
+
+  void insert(uint32_t teid, const std::string& imsi, uint32_t version,
+              const std::string& ue_ipv4, bool inactive);
+  void erase(uint32_t teid);
+
+  std::vector<Bucket> buckets_;
+  std::unordered_map<uint32_t, Entry> sessions_;
+  std::unordered_map<std::string, std::vector<uint32_t>> teids_by_imsi_;
+  std::unordered_map<std::string, uint32_t> teids_by_ue_ipv4_;
+};
+
+}  // namespace magma
@@ -0,0 +1,169 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "UsageReportScheduler.h"
+#include "magma_logging.h"
+
+namespace magma {
+
+namespace {
+// Updates of one subscriber, in the order they were collected
+struct SubscriberUpdates {
+  std::string imsi;
+  std::vector<int> credit_updates;
+  std::vector<int> monitor_updates;
+  bool urgent;
+
+  uint32_t size() const {
+    return credit_updates.size() + monitor_updates.size();
+  }
+};
+}  // namespace
+
+UsageReportScheduler::UsageReportScheduler(uint32_t chunk_updates,
+                                           uint32_t max_in_flight,
+                                           uint32_t max_retries)
+    : chunk_updates_(std::max(chunk_updates, 1u)),
+      max_in_flight_(std::max(max_in_flight, 1u)),
+      max_retries_(max_retries),
+      next_id_(0) {}
+
+bool UsageReportScheduler::is_urgent(const CreditUsageUpdate& update) {
+  switch (update.usage().type()) {
+    case CreditUsage::QUOTA_EXHAUSTED:
+    case CreditUsage::POOL_EXHAUSTED:
+    case CreditUsage::TERMINATED:
+    // Final grants only report once their validity expires
+    case CreditUsage::VALIDITY_TIMER_EXPIRED:
+      return true;
+    default:
+      return false;
+  }
+}
+
+std::vector<std::unique_ptr<UsageReportChunk>>
+UsageReportScheduler::make_chunks(UpdateSessionRequest request,
+                                  SessionMap& session_map,
+                                  SessionUpdate& session_uc) const {
+  std::vector<SubscriberUpdates> subscribers;
+  std::unordered_map<std::string, size_t> index_by_imsi;
+  auto get_subscriber = [&](const std::string& imsi) -> SubscriberUpdates& {
+    auto it = index_by_imsi.find(imsi);
+    if (it == index_by_imsi.end()) {
+      it = index_by_imsi.emplace(imsi, subscribers.size()).first;
+      subscribers.push_back(SubscriberUpdates{imsi, {}, {}, false});
+    }
+    return subscribers[it->second];
+  };
+  for (int i = 0; i < request.updates_size(); i++) {
+    const auto& update = request.updates(i);
+    auto& subscriber = get_subscriber(update.common_context().sid().id());
+    subscriber.credit_updates.push_back(i);
+    subscriber.urgent |= is_urgent(update);
+  }
+  for (int i = 0; i < request.usage_monitors_size(); i++) {
+    auto& subscriber = get_subscriber(request.usage_monitors(i).sid());
+    subscriber.monitor_updates.push_back(i);
+  }
+  std::stable_partition(
+      subscribers.begin(), subscribers.end(),
+      [](const SubscriberUpdates& subscriber) { return subscriber.urgent; });
+
+  std::vector<std::unique_ptr<UsageReportChunk>> chunks;
+  uint32_t chunk_size = 0;
+  for (const auto& subscriber : subscribers) {
+    // Urgent updates are not held back by the others sharing their chunk. A
+    // subscriber with more updates than a chunk holds gets a chunk of its own.
+    if (chunks.empty() || chunks.back()->urgent != subscriber.urgent ||
+        (chunk_size > 0 && chunk_size + subscriber.size() > chunk_updates_)) {
+      chunks.push_back(std::unique_ptr<UsageReportChunk>(
+          new UsageReportChunk{UpdateSessionRequest(), SessionMap(),
+                               SessionUpdate(), subscriber.urgent, 0}));
+      chunk_size = 0;
+    }
+    auto& chunk = *chunks.back();
+    for (int i : subscriber.credit_updates) {
+      chunk.request.add_updates()->Swap(request.mutable_updates(i));
+    }
+    for (int i : subscriber.monitor_updates) {
+      chunk.request.add_usage_monitors()->Swap(
+          request.mutable_usage_monitors(i));
+    }
+    chunk_size += subscriber.size();
+
+    auto session_it = session_map.find(subscriber.imsi);
+    if (session_it != session_map.end()) {
+      chunk.session_map[subscriber.imsi] = std::move(session_it->second);
+      session_map.erase(session_it);
+    }
+    auto uc_it = session_uc.find(subscriber.imsi);
+    if (uc_it != session_uc.end()) {
+      chunk.session_uc[subscriber.imsi] = std::move(uc_it->second);
+      session_uc.erase(uc_it);
+    }
+  }
+  return chunks;
+}
+
+void UsageReportScheduler::enqueue(
+    std::vector<std::unique_ptr<UsageReportChunk>> chunks) {
+  for (auto& chunk : chunks) {
+    auto& queue = chunk->urgent ? urgent_ : queue_;
+    queue.push_back(std::move(chunk));
+  }
+}
+
+const UsageReportChunk* UsageReportScheduler::pop_ready(uint64_t* id) {
+  if (in_flight_.size() >= max_in_flight_) {
+    return nullptr;
+  }
+  auto& queue = urgent_.empty() ? queue_ : urgent_;
+  if (queue.empty()) {
+    return nullptr;
+  }
+  *id = next_id_++;
+  auto& chunk = in_flight_[*id];
+  chunk = std::move(queue.front());
+  queue.pop_front();
+  chunk->attempts++;
+  return chunk.get();
+}
+
+std::unique_ptr<UsageReportChunk> UsageReportScheduler::complete(uint64_t id) {
+  auto it = in_flight_.find(id);
+  if (it == in_flight_.end()) {
+    MLOG(MWARNING) << "Ignoring answer of unknown usage report chunk " << id;
+    return nullptr;
+  }
+  auto chunk = std::move(it->second);
+  in_flight_.erase(it);
+  return chunk;
+}
+
+bool UsageReportScheduler::retry(std::unique_ptr<UsageReportChunk>& chunk,
+                                 const grpc::Status& status) {
+  bool transient = status.error_code() == grpc::UNAVAILABLE ||
+                   status.error_code() == grpc::DEADLINE_EXCEEDED;
+  if (!transient || chunk->attempts > max_retries_) {
+    return false;
+  }
+  auto& queue = chunk->urgent ? urgent_ : queue_;
+  queue.push_front(std::move(chunk));
+  return true;
+}
+
+}  // namespace magma
@@ -0,0 +1,115 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <grpc++/grpc++.h>
+#include <lte/protos/session_manager.pb.h>
+#include <stdint.h>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "SessionStore.h"
+#include "StoreClient.h"
+
+namespace magma {
+using namespace lte;
+
+/**
+ * UsageReportChunk is one UpdateSessionRequest sent to the OCS/PCRF, along
+ * with the sessions and update criteria of its subscribers, so that its
+ * answer or failure is handled without touching the other chunks.
+ */
+struct UsageReportChunk {
+  UpdateSessionRequest request;
+  SessionMap session_map;
+  SessionUpdate session_uc;
+  // Holds updates of exhausted quota or final units
+  bool urgent;
+  uint32_t attempts;
+};
+
+/**
+ * UsageReportScheduler splits the usage updates collected from all sessions
+ * into chunks of bounded size and hands them out within a window of chunks in
+ * flight. A slow or failed answer only holds one chunk, and a chunk which
+ * failed on a transient error is retried on its own.
+ *
+ * Chunks never split the updates of a subscriber. Updates of exhausted quota
+ * or final units are chunked first, and their chunks are sent ahead of any
+ * other queued chunk.
+ */
+class UsageReportScheduler {
+ public:
+  static constexpr uint32_t DEFAULT_CHUNK_UPDATES = 200;
+  static constexpr uint32_t DEFAULT_MAX_IN_FLIGHT = 4;
+  static constexpr uint32_t DEFAULT_MAX_RETRIES = 1;
+
+  UsageReportScheduler(uint32_t chunk_updates = DEFAULT_CHUNK_UPDATES,
+                       uint32_t max_in_flight = DEFAULT_MAX_IN_FLIGHT,
+                       uint32_t max_retries = DEFAULT_MAX_RETRIES);
+
+  /**
+   * @return true if the update reports exhausted quota or final units
+   */
+  static bool is_urgent(const CreditUsageUpdate& update);
+
+  /**
+   * Split the request into chunks. The sessions and update criteria of the
+   * subscribers reporting are moved from session_map and session_uc into the
+   * chunks, the ones left have nothing to report.
+   */
+  std::vector<std::unique_ptr<UsageReportChunk>> make_chunks(
+      UpdateSessionRequest request, SessionMap& session_map,
+      SessionUpdate& session_uc) const;
+
+  void enqueue(std::vector<std::unique_ptr<UsageReportChunk>> chunks);
+
+  /**
+   * Take the next chunk to send, it stays in flight until complete is called
+   * with its id
+   * @param id (out) - id of the chunk
+   * @return the chunk, nullptr if the window is full or nothing is queued
+   */
+  const UsageReportChunk* pop_ready(uint64_t* id);
+
+  /**
+   * Take back a chunk in flight once it is answered
+   * @return the chunk, nullptr if the id is unknown
+   */
+  std::unique_ptr<UsageReportChunk> complete(uint64_t id);
+
+  /**
+   * Queue a chunk again ahead of the others if its failure is transient and
+   * it has retries left
+   * @return true if the chunk was queued, in which case it is taken
+   */
+  bool retry(std::unique_ptr<UsageReportChunk>& chunk,
+             const grpc::Status& status);
+
+  size_t get_in_flight() const { return in_flight_.size(); }
+
+  size_t get_queued() const { return urgent_.size() + queue_.size(); }
+
+ private:
+  uint32_t chunk_updates_;
+  uint32_t max_in_flight_;
+  uint32_t max_retries_;
+  uint64_t next_id_;
+  std::unordered_map<uint64_t, std::unique_ptr<UsageReportChunk>> in_flight_;
+  std::deque<std::unique_ptr<UsageReportChunk>> urgent_;
+  std::deque<std::unique_ptr<UsageReportChunk>> queue_;
+};
+
+}  // namespace magma
@@ -47,6 +47,13 @@ uint64_t get_time_in_sec_since_epoch() {
       .count();
 }
 
+uint64_t get_time_in_ms_since_epoch() {
+  auto now = std::chrono::system_clock::now();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             now.time_since_epoch())
+      .count();
+}
+
 std::chrono::milliseconds time_difference_from_now(
     const google::protobuf::Timestamp& timestamp) {
   const auto rule_time_sec =
@@ -157,6 +157,15 @@ void set_consts(const YAML::Node& config) {
   magma::SessionCredit::TERMINATE_SERVICE_WHEN_QUOTA_EXHAUSTED =
       config["terminate_service_when_quota_exhausted"].as<bool>();
 
+  if (config["usage_reporting_rate_aware"].IsDefined()) {
+    magma::SessionCredit::RATE_AWARE_REPORTING =
+        config["usage_reporting_rate_aware"].as<bool>();
+  }
+  if (config["usage_reporting_rate_margin_ms"].IsDefined()) {
+    magma::SessionCredit::RATE_AWARE_MARGIN_MS =
+        config["usage_reporting_rate_margin_ms"].as<uint64_t>();
+  }
+
   if (config["default_requested_units"].IsDefined()) {
     magma::SessionCredit::DEFAULT_REQUESTED_UNITS =
         config["default_requested_units"].as<uint64_t>();
@@ -174,11 +183,27 @@ void set_consts(const YAML::Node& config) {
   if (config["enable_ipfix"].IsDefined()) {
     magma::LocalEnforcer::SEND_IPFIX = config["enable_ipfix"].as<bool>();
   }
+  if (config["usage_report_chunk_updates"].IsDefined()) {
+    magma::LocalEnforcer::USAGE_REPORT_CHUNK_UPDATES =
+        config["usage_report_chunk_updates"].as<uint32_t>();
+  }
+  if (config["usage_report_max_in_flight"].IsDefined()) {
+    magma::LocalEnforcer::USAGE_REPORT_MAX_IN_FLIGHT =
+        config["usage_report_max_in_flight"].as<uint32_t>();
+  }
+  if (config["usage_report_max_retries"].IsDefined()) {
+    magma::LocalEnforcer::USAGE_REPORT_MAX_RETRIES =
+        config["usage_report_max_retries"].as<uint32_t>();
+  }
 
   // log all configs on startup
   MLOG(MINFO) << "==== Constants/Configs loaded from sessiond.yml ====";
   MLOG(MINFO) << "USAGE_REPORTING_THRESHOLD: "
               << magma::SessionCredit::USAGE_REPORTING_THRESHOLD;
+  MLOG(MINFO) << "RATE_AWARE_REPORTING: "
+              << magma::SessionCredit::RATE_AWARE_REPORTING;
+  MLOG(MINFO) << "RATE_AWARE_MARGIN_MS: "
+              << magma::SessionCredit::RATE_AWARE_MARGIN_MS;
   MLOG(MINFO) << "TERMINATE_SERVICE_WHEN_QUOTA_EXHAUSTED: "
               << magma::SessionCredit::TERMINATE_SERVICE_WHEN_QUOTA_EXHAUSTED;
   MLOG(MINFO) << "DEFAULT_REQUESTED_UNITS: "
@@ -188,6 +213,12 @@ void set_consts(const YAML::Node& config) {
   MLOG(MINFO) << "CLEANUP_DANGLING_FLOWS: "
               << magma::LocalEnforcer::CLEANUP_DANGLING_FLOWS;
   MLOG(MINFO) << "SEND_IPFIX: " << magma::LocalEnforcer::SEND_IPFIX;
+  MLOG(MINFO) << "USAGE_REPORT_CHUNK_UPDATES: "
+              << magma::LocalEnforcer::USAGE_REPORT_CHUNK_UPDATES;
+  MLOG(MINFO) << "USAGE_REPORT_MAX_IN_FLIGHT: "
+              << magma::LocalEnforcer::USAGE_REPORT_MAX_IN_FLIGHT;
+  MLOG(MINFO) << "USAGE_REPORT_MAX_RETRIES: "
+              << magma::LocalEnforcer::USAGE_REPORT_MAX_RETRIES;
   MLOG(MINFO) << "==== Constants/Configs loaded from sessiond.yml ====";
 }
 
@@ -352,6 +383,8 @@ int main(int argc, char* argv[]) {
   // service restart clears the UE metering metrics, so we need to offset
   // metering_reporter with existing usage
   session_store->initialize_metering_counter();
+  // 5G sessions are reconciled with the UPF against an in-memory index
+  session_store->initialize_upf_session_digest();
 
   // Some setup work for the SessionCredit class
   set_consts(config);
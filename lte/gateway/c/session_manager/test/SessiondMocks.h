@@ -97,10 +97,10 @@ class MockPipelinedClient : public PipelinedClient {
            const std::vector<std::uint64_t> pdp_start_times,
            const std::uint64_t& epoch,
            std::function<void(Status status, SetupFlowsResult)> callback));
-  MOCK_METHOD3(
+  MOCK_METHOD4(
       setup_lte,
       void(const std::vector<SessionState::SessionInfo>& infos,
-           const std::uint64_t& epoch,
+           const std::uint64_t& epoch, const SetupBatch& batch,
            std::function<void(Status status, SetupFlowsResult)> callback));
   MOCK_METHOD6(deactivate_flows_for_rules,
                void(const std::string& imsi, const std::string& ip_addr,
@@ -0,0 +1,139 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "EbpfStatsReader.h"
+
+namespace magma {
+
+class FakeEbpfStatsMap : public EbpfStatsMap {
+ public:
+  bool read_all(
+      std::unordered_map<uint32_t, EbpfCounters>* counters) override {
+    if (!pinned) return false;
+    *counters = entries;
+    return true;
+  }
+
+  void erase(uint32_t ue_ipv4) override { entries.erase(ue_ipv4); }
+
+  void set(const std::string& ue_ipv4, uint64_t packets, uint64_t bytes) {
+    struct in_addr addr;
+    inet_pton(AF_INET, ue_ipv4.c_str(), &addr);
+    entries[addr.s_addr].packets = packets;
+    entries[addr.s_addr].bytes = bytes;
+  }
+
+  std::unordered_map<uint32_t, EbpfCounters> entries;
+  bool pinned = true;
+};
+
+class EbpfStatsReaderTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    auto ul = std::make_unique<FakeEbpfStatsMap>();
+    auto dl = std::make_unique<FakeEbpfStatsMap>();
+    ul_map = ul.get();
+    dl_map = dl.get();
+    reader = std::make_unique<EbpfStatsReader>(std::move(ul), std::move(dl));
+  }
+
+ protected:
+  FakeEbpfStatsMap* ul_map;
+  FakeEbpfStatsMap* dl_map;
+  std::unique_ptr<EbpfStatsReader> reader;
+};
+
+TEST_F(EbpfStatsReaderTest, test_poll_reports_deltas) {
+  ul_map->set("192.168.128.11", 10, 1000);
+  dl_map->set("192.168.128.11", 20, 20000);
+  dl_map->set("192.168.128.12", 1, 100);
+
+  auto usage = reader->poll();
+  EXPECT_EQ(usage.size(), 2);
+  EXPECT_EQ(usage["192.168.128.11"].ul.packets, 10);
+  EXPECT_EQ(usage["192.168.128.11"].ul.bytes, 1000);
+  EXPECT_EQ(usage["192.168.128.11"].dl.packets, 20);
+  EXPECT_EQ(usage["192.168.128.11"].dl.bytes, 20000);
+  EXPECT_EQ(usage["192.168.128.12"].ul.packets, 0);
+  EXPECT_EQ(usage["192.168.128.12"].dl.bytes, 100);
+
+  // Only the growth since the last poll, idle UEs are left out
+  ul_map->set("192.168.128.11", 15, 1500);
+  usage = reader->poll();
+  EXPECT_EQ(usage.size(), 1);
+  EXPECT_EQ(usage["192.168.128.11"].ul.packets, 5);
+  EXPECT_EQ(usage["192.168.128.11"].ul.bytes, 500);
+  EXPECT_EQ(usage["192.168.128.11"].dl.packets, 0);
+
+  EXPECT_TRUE(reader->poll().empty());
+}
+
+TEST_F(EbpfStatsReaderTest, test_recreated_map_and_removed_ue) {
+  ul_map->set("192.168.128.11", 10, 1000);
+  ul_map->set("192.168.128.12", 10, 1000);
+  reader->poll();
+
+  // pipelined restarted and recreated the map
+  ul_map->set("192.168.128.11", 2, 200);
+  auto usage = reader->poll();
+  EXPECT_EQ(usage["192.168.128.11"].ul.packets, 2);
+  EXPECT_EQ(usage["192.168.128.11"].ul.bytes, 200);
+
+  // Nothing is lost or counted twice while a map is being recreated
+  ul_map->set("192.168.128.11", 5, 500);
+  dl_map->pinned = false;
+  EXPECT_TRUE(reader->poll().empty());
+  dl_map->pinned = true;
+  usage = reader->poll();
+  EXPECT_EQ(usage["192.168.128.11"].ul.packets, 3);
+
+  // The address of a removed UE starts from zero for the next UE
+  reader->remove_ue("192.168.128.12");
+  EXPECT_EQ(ul_map->entries.size(), 1);
+  ul_map->set("192.168.128.12", 3, 300);
+  usage = reader->poll();
+  EXPECT_EQ(usage["192.168.128.12"].ul.packets, 3);
+  EXPECT_EQ(usage["192.168.128.12"].ul.bytes, 300);
+}
+
+TEST(EbpfStatsHelpersTest, test_parse_possible_cpus) {
+  EXPECT_EQ(parse_possible_cpus("0"), 1);
+  EXPECT_EQ(parse_possible_cpus("0-7"), 8);
+  EXPECT_EQ(parse_possible_cpus("0-3,5"), 6);
+  EXPECT_EQ(parse_possible_cpus(""), -1);
+  EXPECT_EQ(parse_possible_cpus("3-1"), -1);
+  EXPECT_EQ(parse_possible_cpus("cpu"), -1);
+}
+
+TEST(EbpfStatsHelpersTest, test_sum_per_cpu_counters) {
+  EbpfCounters values[4];
+  for (int cpu = 0; cpu < 4; cpu++) {
+    values[cpu].packets = cpu + 1;
+    values[cpu].bytes = 100 * (cpu + 1);
+  }
+  EbpfCounters sum = sum_per_cpu_counters(values, 4);
+  EXPECT_EQ(sum.packets, 10);
+  EXPECT_EQ(sum.bytes, 1000);
+}
+
+}  // namespace magma
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
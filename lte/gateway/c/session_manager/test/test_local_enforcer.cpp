@@ -2783,11 +2783,14 @@ TEST_F(LocalEnforcerTest, test_pipelined_lte_setup) {
       *pipelined_client,
       setup_lte(CheckSessionInfos(imsi_list, ip_address_list, ipv6_address_list,
                                   test_cfg_, rule_list, version_list),
-                testing::_, testing::_))
+                testing::_, testing::_, testing::_))
       .Times(1);
 
-  local_enforcer->setup(session_map, epoch,
-                        [](Status status, SetupFlowsResult resp) {});
+  auto sync = local_enforcer->setup(
+      session_map, epoch, [](Status status, SetupFlowsResult resp) {});
+  ASSERT_NE(sync, nullptr);
+  local_enforcer->send_setup_batch(
+      *sync, [](Status status, SetupFlowsResult resp) {});
 }
 
 TEST_F(LocalEnforcerTest, test_valid_apn_parsing) {
@@ -0,0 +1,209 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "PipelinedSetupSync.h"
+
+namespace magma {
+
+const uint64_t EPOCH = 1234;
+const uint64_t SYNC_ID = 42;
+
+class PipelinedSetupSyncTest : public ::testing::Test {
+ protected:
+  void add_session(const std::string& imsi) {
+    SessionState::SessionInfo info;
+    info.imsi = imsi;
+    infos.push_back(info);
+  }
+
+  SetupFlowsResult success(uint32_t next_batch,
+                           uint32_t max_batch_sessions = 0) {
+    SetupFlowsResult result;
+    result.set_result(SetupFlowsResult::SUCCESS);
+    result.set_next_batch(next_batch);
+    result.set_max_batch_sessions(max_batch_sessions);
+    return result;
+  }
+
+  static std::vector<std::string> imsis(
+      const std::vector<SessionState::SessionInfo>& batch_infos) {
+    std::vector<std::string> result;
+    for (const auto& info : batch_infos) {
+      result.push_back(info.imsi);
+    }
+    return result;
+  }
+
+ protected:
+  std::vector<SessionState::SessionInfo> infos;
+};
+
+TEST_F(PipelinedSetupSyncTest, test_bounded_batches) {
+  for (int i = 0; i < 5; i++) {
+    add_session("IMSI" + std::to_string(i));
+  }
+  PipelinedSetupSync sync(EPOCH, SYNC_ID, infos, 2);
+  std::vector<SessionState::SessionInfo> batch_infos;
+
+  auto batch = sync.get_next_batch(&batch_infos);
+  EXPECT_EQ(batch.sync_id(), SYNC_ID);
+  EXPECT_EQ(batch.index(), 0);
+  EXPECT_FALSE(batch.last());
+  EXPECT_EQ(imsis(batch_infos), std::vector<std::string>({"IMSI0", "IMSI1"}));
+  sync.ack_batch(success(1));
+
+  batch = sync.get_next_batch(&batch_infos);
+  EXPECT_EQ(batch.index(), 1);
+  EXPECT_FALSE(batch.last());
+  EXPECT_EQ(imsis(batch_infos), std::vector<std::string>({"IMSI2", "IMSI3"}));
+  sync.ack_batch(success(2));
+  EXPECT_FALSE(sync.is_complete());
+
+  batch = sync.get_next_batch(&batch_infos);
+  EXPECT_EQ(batch.index(), 2);
+  EXPECT_TRUE(batch.last());
+  EXPECT_EQ(imsis(batch_infos), std::vector<std::string>({"IMSI4"}));
+  sync.ack_batch(success(3));
+  EXPECT_TRUE(sync.is_complete());
+}
+
+TEST_F(PipelinedSetupSyncTest, test_resend_unacknowledged_batch) {
+  for (int i = 0; i < 4; i++) {
+    add_session("IMSI" + std::to_string(i));
+  }
+  PipelinedSetupSync sync(EPOCH, SYNC_ID, infos, 2);
+  std::vector<SessionState::SessionInfo> batch_infos;
+
+  sync.get_next_batch(&batch_infos);
+  sync.ack_batch(success(1));
+  sync.get_next_batch(&batch_infos);
+  // The batch failed, it is sent again without the acknowledged one
+  auto batch = sync.get_next_batch(&batch_infos);
+  EXPECT_EQ(batch.index(), 1);
+  EXPECT_TRUE(batch.last());
+  EXPECT_EQ(imsis(batch_infos), std::vector<std::string>({"IMSI2", "IMSI3"}));
+}
+
+TEST_F(PipelinedSetupSyncTest, test_resume_at_next_batch) {
+  for (int i = 0; i < 6; i++) {
+    add_session("IMSI" + std::to_string(i));
+  }
+  PipelinedSetupSync sync(EPOCH, SYNC_ID, infos, 2);
+  std::vector<SessionState::SessionInfo> batch_infos;
+
+  sync.get_next_batch(&batch_infos);
+  sync.ack_batch(success(1));
+  sync.get_next_batch(&batch_infos);
+  sync.ack_batch(success(2));
+  sync.get_next_batch(&batch_infos);
+  // PipelineD only applied the first batch, the sync resumes after it
+  sync.ack_batch(success(1));
+  EXPECT_FALSE(sync.is_complete());
+  EXPECT_TRUE(sync.is_subscriber_ready("IMSI1"));
+  EXPECT_FALSE(sync.is_subscriber_ready("IMSI2"));
+
+  auto batch = sync.get_next_batch(&batch_infos);
+  EXPECT_EQ(batch.index(), 1);
+  EXPECT_FALSE(batch.last());
+  EXPECT_EQ(imsis(batch_infos), std::vector<std::string>({"IMSI2", "IMSI3"}));
+  sync.ack_batch(success(2));
+  batch = sync.get_next_batch(&batch_infos);
+  EXPECT_EQ(batch.index(), 2);
+  EXPECT_TRUE(batch.last());
+  sync.ack_batch(success(3));
+  EXPECT_TRUE(sync.is_complete());
+}
+
+TEST_F(PipelinedSetupSyncTest, test_batch_size_feedback) {
+  for (int i = 0; i < 10; i++) {
+    add_session("IMSI" + std::to_string(i));
+  }
+  PipelinedSetupSync sync(EPOCH, SYNC_ID, infos, 2);
+  std::vector<SessionState::SessionInfo> batch_infos;
+
+  sync.get_next_batch(&batch_infos);
+  sync.ack_batch(success(1, 5));
+  EXPECT_EQ(sync.get_batch_sessions(), 5);
+  sync.get_next_batch(&batch_infos);
+  EXPECT_EQ(batch_infos.size(), 5);
+
+  // No preference keeps the current size, too large is capped
+  sync.ack_batch(success(2));
+  EXPECT_EQ(sync.get_batch_sessions(), 5);
+  sync.get_next_batch(&batch_infos);
+  sync.ack_batch(success(3, 1000000));
+  EXPECT_EQ(sync.get_batch_sessions(), PipelinedSetupSync::MAX_BATCH_SESSIONS);
+}
+
+TEST_F(PipelinedSetupSyncTest, test_subscriber_not_split) {
+  add_session("IMSI1");
+  add_session("IMSI2");
+  add_session("IMSI2");
+  add_session("IMSI2");
+  add_session("IMSI3");
+  PipelinedSetupSync sync(EPOCH, SYNC_ID, infos, 2);
+  std::vector<SessionState::SessionInfo> batch_infos;
+
+  sync.get_next_batch(&batch_infos);
+  EXPECT_EQ(imsis(batch_infos),
+            std::vector<std::string>({"IMSI1", "IMSI2", "IMSI2", "IMSI2"}));
+  sync.ack_batch(success(1));
+  auto batch = sync.get_next_batch(&batch_infos);
+  EXPECT_TRUE(batch.last());
+  EXPECT_EQ(imsis(batch_infos), std::vector<std::string>({"IMSI3"}));
+}
+
+TEST_F(PipelinedSetupSyncTest, test_subscriber_readiness) {
+  add_session("IMSI1");
+  add_session("IMSI2");
+  PipelinedSetupSync sync(EPOCH, SYNC_ID, infos, 1);
+  std::vector<SessionState::SessionInfo> batch_infos;
+
+  // Nothing is ready until PipelineD took the first batch
+  sync.get_next_batch(&batch_infos);
+  EXPECT_FALSE(sync.is_subscriber_ready("IMSI1"));
+  EXPECT_FALSE(sync.is_subscriber_ready("IMSI_NEW"));
+
+  sync.ack_batch(success(1));
+  EXPECT_TRUE(sync.is_subscriber_ready("IMSI1"));
+  EXPECT_FALSE(sync.is_subscriber_ready("IMSI2"));
+  EXPECT_TRUE(sync.is_subscriber_ready("IMSI_NEW"));
+
+  sync.get_next_batch(&batch_infos);
+  EXPECT_FALSE(sync.is_subscriber_ready("IMSI2"));
+  sync.ack_batch(success(2));
+  EXPECT_TRUE(sync.is_subscriber_ready("IMSI2"));
+  EXPECT_TRUE(sync.is_complete());
+}
+
+TEST_F(PipelinedSetupSyncTest, test_no_sessions) {
+  PipelinedSetupSync sync(EPOCH, SYNC_ID, infos);
+  std::vector<SessionState::SessionInfo> batch_infos;
+
+  auto batch = sync.get_next_batch(&batch_infos);
+  EXPECT_EQ(batch.index(), 0);
+  EXPECT_TRUE(batch.last());
+  EXPECT_TRUE(batch_infos.empty());
+  sync.ack_batch(success(1));
+  EXPECT_TRUE(sync.is_complete());
+}
+
+}  // namespace magma
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
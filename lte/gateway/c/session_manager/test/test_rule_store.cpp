@@ -0,0 +1,166 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <malloc.h>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "RuleStore.h"
+#include "lte/protos/policydb.pb.h"
+
+// Heap accounting for the memory benchmark below
+static std::atomic<int64_t> heap_bytes{0};
+
+void* operator new(size_t size) {
+  void* ptr = malloc(size ? size : 1);
+  if (!ptr) throw std::bad_alloc();
+  heap_bytes += malloc_usable_size(ptr);
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+  if (!ptr) return;
+  heap_bytes -= malloc_usable_size(ptr);
+  free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+
+namespace magma {
+
+const uint32_t NUM_RULES = 5;
+
+// Dynamic rules the way PCRF sends them to every subscriber of a plan
+static PolicyRule make_rule(uint32_t index) {
+  PolicyRule rule;
+  rule.set_id("plan-rule-" + std::to_string(index));
+  rule.set_priority(10 + index);
+  rule.set_rating_group(index + 1);
+  rule.set_monitoring_key("plan-mkey-" + std::to_string(index));
+  rule.set_tracking_type(PolicyRule::OCS_AND_PCRF);
+  rule.mutable_qos()->set_max_req_bw_ul(100000000);
+  rule.mutable_qos()->set_max_req_bw_dl(100000000);
+  for (uint32_t i = 0; i < 4; i++) {
+    auto* flow = rule.add_flow_list();
+    flow->mutable_match()->mutable_ip_dst()->set_address(
+        "10.0." + std::to_string(index) + "." + std::to_string(i) + "/24");
+    flow->mutable_match()->set_tcp_dst(443);
+    flow->set_action(FlowDescription::PERMIT);
+  }
+  return rule;
+}
+
+// What SessionState keeps per session: Gx, Gy and scheduled dynamic rules
+struct SessionRuleStores {
+  DynamicRuleStore dynamic_rules;
+  DynamicRuleStore gy_dynamic_rules;
+  DynamicRuleStore scheduled_dynamic_rules;
+};
+
+TEST(PolicyRuleTableTest, test_equal_definitions_are_shared) {
+  DynamicRuleStore store1, store2;
+  PolicyRule rule = make_rule(0);
+  store1.insert_rule(rule);
+  store2.insert_rule(rule);
+  EXPECT_EQ(PolicyRuleTable::size(), 1);
+
+  // A different definition under the same ID is kept apart
+  rule.set_priority(99);
+  store2.insert_rule(rule);
+  EXPECT_EQ(PolicyRuleTable::size(), 2);
+
+  PolicyRule rule_out;
+  EXPECT_TRUE(store1.get_rule("plan-rule-0", &rule_out));
+  EXPECT_EQ(rule_out.priority(), 10);
+  EXPECT_TRUE(store2.get_rule("plan-rule-0", &rule_out));
+  EXPECT_EQ(rule_out.priority(), 99);
+
+  // Entries leave the table with the last store referencing them
+  store1.remove_rule("plan-rule-0", nullptr);
+  EXPECT_EQ(PolicyRuleTable::size(), 1);
+  store2.remove_rule("plan-rule-0", nullptr);
+  EXPECT_EQ(PolicyRuleTable::size(), 0);
+}
+
+TEST(PolicyRuleTableTest, test_lookups_by_key) {
+  DynamicRuleStore store;
+  store.sync_rules({make_rule(0), make_rule(1)});
+  CreditKey key(make_rule(1));
+  std::vector<std::string> rule_ids;
+  EXPECT_TRUE(store.get_rule_ids_for_charging_key(key, rule_ids));
+  EXPECT_EQ(rule_ids, std::vector<std::string>{"plan-rule-1"});
+  std::string monitoring_key;
+  EXPECT_TRUE(
+      store.get_monitoring_key_for_rule_id("plan-rule-0", &monitoring_key));
+  EXPECT_EQ(monitoring_key, "plan-mkey-0");
+  EXPECT_EQ(store.monitored_rules_count(), 2);
+
+  store.remove_rule("plan-rule-1", nullptr);
+  rule_ids.clear();
+  EXPECT_FALSE(store.get_rule_ids_for_charging_key(key, rule_ids));
+  EXPECT_EQ(store.monitored_rules_count(), 1);
+}
+
+/**
+ * Reports the heap taken per session by the rule stores of 10k sessions
+ * that all have the same NUM_RULES dynamic rules installed.
+ */
+TEST(PolicyRuleTableTest, test_memory_per_session) {
+  const uint32_t num_sessions = 10000;
+  std::vector<PolicyRule> rules;
+  for (uint32_t i = 0; i < NUM_RULES; i++) {
+    rules.push_back(make_rule(i));
+  }
+  int64_t before_copies = heap_bytes;
+  { std::vector<PolicyRule> copies(rules); }
+  int64_t start = heap_bytes;
+  std::vector<PolicyRule> copies(rules);
+  int64_t definition_bytes = heap_bytes - start;
+  copies.clear();
+  copies.shrink_to_fit();
+  EXPECT_EQ(heap_bytes, before_copies);
+
+  std::vector<std::unique_ptr<SessionRuleStores>> sessions;
+  sessions.reserve(num_sessions);
+  start = heap_bytes;
+  for (uint32_t i = 0; i < num_sessions; i++) {
+    auto session = std::make_unique<SessionRuleStores>();
+    for (const auto& rule : rules) {
+      session->dynamic_rules.insert_rule(rule);
+    }
+    sessions.push_back(std::move(session));
+  }
+  int64_t bytes_per_session = (heap_bytes - start) / num_sessions;
+  std::cout << "Rule stores take " << bytes_per_session
+            << " bytes per session, the " << NUM_RULES
+            << " rule definitions take " << definition_bytes << " bytes"
+            << std::endl;
+  EXPECT_EQ(PolicyRuleTable::size(), NUM_RULES);
+  // No session pays for its own copy of the definitions
+  EXPECT_LT(bytes_per_session, definition_bytes);
+
+  sessions.clear();
+  EXPECT_EQ(PolicyRuleTable::size(), 0);
+}
+
+}  // namespace magma
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -14,6 +14,7 @@
 
 #include <chrono>
 #include <thread>
+#include <vector>
 
 #include "ProtobufCreators.h"
 #include "SessionCredit.h"
@@ -405,6 +406,188 @@ TEST(test_is_quota_exhausted_after_empty_grant, test_session_credit) {
   EXPECT_TRUE(credit.is_quota_exhausted(0.8));
 }
 
+TEST(test_usage_rate, test_session_credit) {
+  SessionCredit credit;
+  SessionCreditUpdateCriteria uc{};
+  uint64_t now = 1000000;
+
+  // The first usage only sets the baseline
+  credit.add_used_credit(1000, 2000, &uc, now);
+  EXPECT_EQ(credit.get_usage_rate().sample_interval_ms, 0);
+  // Samples closer than a second are merged into the next one
+  credit.add_used_credit(1000, 2000, &uc, now + 500);
+  EXPECT_EQ(credit.get_usage_rate().sample_interval_ms, 0);
+
+  credit.add_used_credit(3000, 6000, &uc, now + 2000);
+  auto rate = credit.get_usage_rate();
+  EXPECT_EQ(rate.sample_interval_ms, 2000);
+  EXPECT_EQ(rate.rate_tx, 2000);
+  EXPECT_EQ(rate.rate_rx, 4000);
+  EXPECT_EQ(uc.usage_rate.rate_tx, 2000);
+  EXPECT_EQ(uc.usage_rate.rate_rx, 4000);
+
+  // Later samples are averaged with the previous rate
+  credit.add_used_credit(0, 0, &uc, now + 4000);
+  rate = credit.get_usage_rate();
+  EXPECT_NEAR(rate.rate_tx, 1400, 1);
+  EXPECT_NEAR(rate.rate_rx, 2800, 1);
+  // A clock going back only resets the baseline
+  credit.add_used_credit(100, 100, &uc, now);
+  EXPECT_EQ(credit.get_usage_rate().rate_tx, rate.rate_tx);
+  EXPECT_EQ(credit.get_usage_rate().sample_time_ms, now);
+
+  // The rate is kept across marshal/unmarshal
+  SessionCredit credit_2(credit.marshal());
+  EXPECT_EQ(credit_2.get_usage_rate().rate_tx, rate.rate_tx);
+  EXPECT_EQ(credit_2.get_usage_rate().rate_rx, rate.rate_rx);
+}
+
+TEST(test_is_quota_exhausted_rate_aware, test_session_credit) {
+  SessionCredit::RATE_AWARE_REPORTING = true;
+  uint64_t now = 1000000;
+  GrantedUnits gsu;
+  uint64_t grant = 10000;
+  create_granted_units(&grant, NULL, NULL, &gsu);
+
+  // Until the rate is known, the threshold applies
+  SessionCredit unknown;
+  SessionCreditUpdateCriteria uc{};
+  unknown.receive_credit(gsu, &uc);
+  unknown.add_used_credit(8000, 0, &uc, now);
+  EXPECT_TRUE(unknown.is_quota_exhausted(0.8));
+
+  // A heavy user reports well before the threshold
+  SessionCredit heavy;
+  heavy.receive_credit(gsu, &uc);
+  heavy.add_used_credit(0, 0, &uc, now);
+  heavy.add_used_credit(3000, 0, &uc, now + 2000);
+  EXPECT_TRUE(heavy.is_quota_exhausted(0.8));
+
+  // A light user reports after it
+  SessionCredit light;
+  light.receive_credit(gsu, &uc);
+  light.add_used_credit(0, 0, &uc, now);
+  for (int i = 1; i <= 20; i++) {
+    light.add_used_credit(425, 0, &uc, now + i * 5000);
+  }
+  EXPECT_EQ(light.get_usage_rate().rate_tx, 85);
+  EXPECT_FALSE(light.is_quota_exhausted(0.8));
+  // Final units are unchanged
+  EXPECT_FALSE(light.is_quota_exhausted(1));
+  light.add_used_credit(1100, 0, &uc, now + 105000);
+  EXPECT_TRUE(light.is_quota_exhausted(0.8));
+
+  // Whatever the rate, 5% of the grant is kept in reserve
+  SessionCredit idle;
+  idle.receive_credit(gsu, &uc);
+  idle.add_used_credit(9400, 0, &uc, now);
+  idle.add_used_credit(0, 0, &uc, now + 5000);
+  EXPECT_EQ(idle.get_usage_rate().rate_tx, 0);
+  EXPECT_FALSE(idle.is_quota_exhausted(0.8));
+  idle.add_used_credit(100, 0, &uc, now + 10000);
+  EXPECT_TRUE(idle.is_quota_exhausted(0.8));
+
+  SessionCredit::RATE_AWARE_REPORTING = false;
+  EXPECT_FALSE(heavy.is_quota_exhausted(0.8));
+}
+
+struct SimulatedSession {
+  // Bytes per second the user would consume with no quota limit
+  uint64_t demand_rate;
+  uint64_t duration_ms;
+};
+
+struct SimulationResult {
+  uint64_t usage_updates;
+  // 100ms ticks during which the demand could not be served
+  uint64_t stall_ticks;
+  uint64_t served_bytes;
+};
+
+// Run sessions against an OCS answering every usage update with a fixed grant
+// after a round trip. Pipelined reports the usage every 5 seconds, which is
+// when the quota is checked.
+SimulationResult simulate_sessions(
+    const std::vector<SimulatedSession>& sessions, uint64_t grant) {
+  const uint64_t tick_ms = 100, poll_ms = 5000, rtt_ms = 1500;
+  const uint64_t start_ms = 1000000;
+  GrantedUnits gsu;
+  create_granted_units(&grant, NULL, NULL, &gsu);
+
+  SimulationResult result{0, 0, 0};
+  for (const auto& session : sessions) {
+    SessionCredit credit;
+    SessionCreditUpdateCriteria uc{};
+    credit.receive_credit(gsu, &uc);
+    uint64_t unreported = 0, answer_at = 0;
+    for (uint64_t t = 0; t < session.duration_ms; t += tick_ms) {
+      uint64_t now = start_ms + t;
+      if (answer_at != 0 && now >= answer_at) {
+        credit.receive_credit(gsu, &uc);
+        SessionCredit::observe_report_rtt(rtt_ms);
+        answer_at = 0;
+      }
+      uint64_t used =
+          credit.get_credit(USED_TX) + credit.get_credit(USED_RX) + unreported;
+      uint64_t allowed = credit.get_credit(ALLOWED_TOTAL);
+      uint64_t served = session.demand_rate * tick_ms / 1000;
+      if (used + served > allowed) {
+        result.stall_ticks++;
+        served = allowed > used ? allowed - used : 0;
+      }
+      unreported += served;
+      result.served_bytes += served;
+      if (t % poll_ms != 0) {
+        continue;
+      }
+      credit.add_used_credit(unreported, 0, &uc, now);
+      unreported = 0;
+      if (answer_at == 0 &&
+          credit.is_quota_exhausted(SessionCredit::USAGE_REPORTING_THRESHOLD)) {
+        credit.get_usage_for_reporting(&uc);
+        result.usage_updates++;
+        answer_at = now + rtt_ms;
+      }
+    }
+  }
+  return result;
+}
+
+SimulationResult simulate_sessions_rate_aware(
+    const std::vector<SimulatedSession>& sessions, uint64_t grant) {
+  SessionCredit::RATE_AWARE_REPORTING = true;
+  auto result = simulate_sessions(sessions, grant);
+  SessionCredit::RATE_AWARE_REPORTING = false;
+  return result;
+}
+
+TEST(test_rate_aware_reporting_simulation, test_session_credit) {
+  const uint64_t grant = 10000000;
+  // Light and short sessions should not have to report before the end of
+  // their quota
+  std::vector<SimulatedSession> light;
+  for (uint64_t i = 0; i < 40; i++) {
+    light.push_back({2000 + i * 1000, (5 + i % 12 * 5) * 60 * 1000});
+  }
+  auto ratio = simulate_sessions(light, grant);
+  auto rate_aware = simulate_sessions_rate_aware(light, grant);
+  EXPECT_LT(rate_aware.usage_updates, ratio.usage_updates);
+  EXPECT_EQ(rate_aware.stall_ticks, 0);
+
+  // Heavy sessions should not run out of quota. With a fixed grant, the
+  // updates follow the usage served, but not more than one per grant.
+  std::vector<SimulatedSession> heavy;
+  for (uint64_t i = 0; i < 4; i++) {
+    heavy.push_back({(1 + i) * 250000, 60 * 60 * 1000});
+  }
+  ratio = simulate_sessions(heavy, grant);
+  rate_aware = simulate_sessions_rate_aware(heavy, grant);
+  EXPECT_GT(ratio.stall_ticks, 0);
+  EXPECT_EQ(rate_aware.stall_ticks, 0);
+  EXPECT_GT(rate_aware.served_bytes, ratio.served_bytes);
+  EXPECT_LE(rate_aware.usage_updates, rate_aware.served_bytes / grant);
+}
+
 TEST(test_get_credit_summary, test_session_credit) {
   SessionCredit credit;
   SessionCreditUpdateCriteria uc{};
@@ -41,9 +41,11 @@ Teids teids1;
 
 ACTION_P(CallSetupCallback, result) {
   auto cb =
-      static_cast<std::function<void(Status status, SetupFlowsResult)>>(arg2);
+      static_cast<std::function<void(Status status, SetupFlowsResult)>>(arg3);
   SetupFlowsResult setup_result;
   setup_result.set_result(result);
+  // PipelineD expects the batch after the one it was sent
+  setup_result.set_next_batch(arg2.index() + 1);
   cb(grpc::Status::OK, setup_result);
 }
 
@@ -116,7 +118,7 @@ class SessionManagerHandlerTest : public ::testing::Test {
   void send_empty_table_and_wait_for_successful_setup() {
     send_empty_table();
     EXPECT_CALL(*pipelined_client,
-                setup_lte(testing::_, testing::_, testing::_))
+                setup_lte(testing::_, testing::_, testing::_, testing::_))
         .Times(1)
         .WillOnce(CallSetupCallback(SetupFlowsResult_Result_SUCCESS));
     evb->loopOnce();
@@ -372,7 +374,8 @@ TEST_F(SessionManagerHandlerTest, test_create_session) {
 TEST_F(SessionManagerHandlerTest, test_create_session_pipelined_unavailable) {
   send_empty_table();
   // On failure cases, LocalEnforcer will endlessly retry the setup call
-  EXPECT_CALL(*pipelined_client, setup_lte(testing::_, testing::_, testing::_))
+  EXPECT_CALL(*pipelined_client,
+              setup_lte(testing::_, testing::_, testing::_, testing::_))
       .WillRepeatedly(CallSetupCallback(SetupFlowsResult_Result_FAILURE));
   evb->loopOnce();
   evb->loopOnce();
@@ -69,6 +69,10 @@ class StoredStateTest : public ::testing::Test {
     stored.buckets[USED_TX] = 12345;
     stored.buckets[ALLOWED_TOTAL] = 54321;
 
+    stored.usage_rate.sample_time_ms = 1600000000000;
+    stored.usage_rate.sample_interval_ms = 5000;
+    stored.usage_rate.rate_tx = 4096;
+
     stored.grant_tracking_type = TX_ONLY;
     return stored;
   };
@@ -237,6 +241,11 @@ TEST_F(StoredStateTest, test_stored_session_credit) {
   EXPECT_EQ(deserialized.buckets[USED_TX], 12345);
   EXPECT_EQ(deserialized.buckets[ALLOWED_TOTAL], 54321);
 
+  EXPECT_EQ(deserialized.usage_rate.sample_time_ms, 1600000000000);
+  EXPECT_EQ(deserialized.usage_rate.sample_interval_ms, 5000);
+  EXPECT_EQ(deserialized.usage_rate.rate_tx, 4096);
+  EXPECT_EQ(deserialized.usage_rate.rate_rx, 0);
+
   EXPECT_EQ(deserialized.grant_tracking_type, TX_ONLY);
 }
 
@@ -0,0 +1,350 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <folly/io/async/EventBase.h>
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "SessionState.h"
+#include "SessionStateEnforcer.h"
+#include "SessionStore.h"
+#include "SessiondMocks.h"
+#include "StoredState.h"
+#include "UpfMsgManageHandler.h"
+#include "UpfSessionDigest.h"
+
+using ::testing::Test;
+
+#define session_force_termination_timeout_ms 5000
+#define session_max_rtx_count 3
+
+namespace magma {
+
+const uint32_t NUM_SESSIONS = 10000;
+// Ranges of the first report round, as the UPF sends them
+const uint32_t RANGE_BUCKETS = 256;
+
+class UpfSessionDigestTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    rule_store = std::make_shared<StaticRuleStore>();
+    reporter = std::make_shared<MockSessionReporter>();
+    session_store = std::make_shared<SessionStore>(
+        rule_store, std::make_shared<MeteringReporter>());
+    std::unordered_multimap<std::string, uint32_t> pdr_map;
+    pipelined_client = std::make_shared<MockPipelinedClient>();
+    amf_srv_client = std::make_shared<MockAmfServiceClient>();
+    mobilityd_client = std::make_shared<MockMobilitydClient>();
+    auto events_reporter = std::make_shared<MockEventsReporter>();
+    magma::mconfig::SessionD mconfig;
+    mconfig.set_log_level(magma::orc8r::LogLevel::INFO);
+
+    session_enforcer = std::make_shared<SessionStateEnforcer>(
+        rule_store, *session_store, pdr_map, pipelined_client, amf_srv_client,
+        reporter.get(), events_reporter, mconfig,
+        session_force_termination_timeout_ms, session_max_rtx_count);
+    evb = new folly::EventBase();
+    session_enforcer->attachEventBase(evb);
+    upf_msg_handler = std::make_shared<UpfMsgManageHandler>(
+        session_enforcer, mobilityd_client, *session_store);
+  }
+
+  virtual void TearDown() { delete evb; }
+
+  std::unique_ptr<SessionState> make_session(const std::string& imsi,
+                                             uint32_t teid, uint32_t version,
+                                             SessionFsmState state) {
+    SessionConfig cfg;
+    cfg.common_context.mutable_sid()->set_id(imsi);
+    cfg.common_context.set_rat_type(RATType::TGPP_NR);
+    cfg.common_context.set_ue_ipv4(get_ue_ipv4(teid));
+    cfg.rat_specific_context.mutable_m5gsm_session_context()
+        ->set_pdu_session_id(5);
+    auto session = std::make_unique<SessionState>(
+        imsi, imsi + "-" + std::to_string(teid), cfg, *rule_store);
+    auto uc = get_default_update_criteria();
+    session->set_upf_teid_endpoint("192.168.60.112", teid, &uc);
+    session->set_fsm_state(state, nullptr);
+    session->set_current_version(version, nullptr);
+    return session;
+  }
+
+  static std::string get_imsi(uint32_t teid) {
+    return "IMSI00101" + std::to_string(1000000000 + teid);
+  }
+
+  static std::string get_ue_ipv4(uint32_t teid) {
+    return "10.1." + std::to_string(teid / 256) + "." +
+           std::to_string(teid % 256);
+  }
+
+  Status page(uint32_t teid, const std::string& ue_ipv4) {
+    UPFPagingInfo paging_info;
+    paging_info.set_local_f_teid(teid);
+    paging_info.set_ue_ip_addr(ue_ipv4);
+    Status result;
+    bool answered = false;
+    upf_msg_handler->SendPagingRequest(
+        nullptr, &paging_info,
+        [&result, &answered](Status status, SmContextVoid response) {
+          result = status;
+          answered = true;
+        });
+    // The MobilityD fallback takes a second hop to the event base
+    while (!answered) {
+      evb->loopOnce();
+    }
+    return result;
+  }
+
+  // Sessions the UPF holds, by local TEID, and the digests it computes
+  std::map<uint32_t, uint32_t> upf_sessions;
+
+  UPFSessionRangeDigest upf_range_digest(uint32_t bucket_start,
+                                         uint32_t bucket_end) {
+    UPFSessionRangeDigest range;
+    range.set_bucket_start(bucket_start);
+    range.set_bucket_end(bucket_end);
+    uint32_t count = 0;
+    uint64_t digest = 0;
+    for (const auto& it : upf_sessions) {
+      uint32_t bucket = it.first % UpfSessionDigest::BUCKET_COUNT;
+      if (bucket >= bucket_start && bucket < bucket_end) {
+        count++;
+        digest ^= UpfSessionDigest::hash_session(it.first, it.second);
+      }
+    }
+    range.set_session_count(count);
+    range.set_digest(digest);
+    return range;
+  }
+
+  void add_upf_sessions(uint32_t bucket_start, uint32_t bucket_end,
+                        UPFSessionDigestReport* report) {
+    for (const auto& it : upf_sessions) {
+      uint32_t bucket = it.first % UpfSessionDigest::BUCKET_COUNT;
+      if (bucket >= bucket_start && bucket < bucket_end) {
+        auto* upf_session = report->add_upf_session_state();
+        upf_session->set_subscriber_id(get_imsi(it.first));
+        upf_session->set_session_version(it.second);
+        upf_session->set_local_f_teid(it.first);
+      }
+    }
+  }
+
+  UPFSessionDigestResult reconcile(const UPFSessionDigestReport& report) {
+    UPFSessionDigestResult result;
+    bool answered = false;
+    upf_msg_handler->ReconcileUPFSessions(
+        nullptr, &report,
+        [&result, &answered](Status status, UPFSessionDigestResult response) {
+          EXPECT_TRUE(status.ok());
+          result = response;
+          answered = true;
+        });
+    evb->loopOnce();
+    EXPECT_TRUE(answered);
+    return result;
+  }
+
+  std::shared_ptr<StaticRuleStore> rule_store;
+  std::shared_ptr<MockSessionReporter> reporter;
+  std::shared_ptr<SessionStore> session_store;
+  std::shared_ptr<MockPipelinedClient> pipelined_client;
+  std::shared_ptr<MockAmfServiceClient> amf_srv_client;
+  std::shared_ptr<MockMobilitydClient> mobilityd_client;
+  std::shared_ptr<SessionStateEnforcer> session_enforcer;
+  std::shared_ptr<UpfMsgManageHandler> upf_msg_handler;
+  folly::EventBase* evb;
+};
+
+TEST_F(UpfSessionDigestTest, test_digest_follows_session_store) {
+  const auto& digest = session_store->get_upf_session_digest();
+  const std::string imsi = get_imsi(1);
+  SessionVector sessions;
+  sessions.push_back(make_session(imsi, 1, 2, SESSION_ACTIVE));
+  sessions.push_back(make_session(imsi, 2, 2, CREATING));
+  session_store->create_sessions(imsi, std::move(sessions));
+
+  // A session not installed in the UPF yet is left out
+  EXPECT_EQ(digest.size(), 1);
+  ASSERT_TRUE(digest.find(1) != nullptr);
+  EXPECT_EQ(digest.find(1)->imsi, imsi);
+  EXPECT_EQ(digest.find(1)->version, 2);
+  auto range = digest.get_range_digest(0, UpfSessionDigest::BUCKET_COUNT);
+  EXPECT_EQ(range.session_count, 1);
+  EXPECT_EQ(range.digest, UpfSessionDigest::hash_session(1, 2));
+
+  // Version bumps are followed
+  SessionUpdate update;
+  auto& uc = update[imsi][imsi + "-1"];
+  uc = get_default_update_criteria();
+  uc.is_current_version_updated = true;
+  uc.updated_current_version = 3;
+  EXPECT_TRUE(session_store->update_sessions(update));
+  EXPECT_EQ(digest.find(1)->version, 3);
+  range = digest.get_range_digest(0, UpfSessionDigest::BUCKET_COUNT);
+  EXPECT_EQ(range.digest, UpfSessionDigest::hash_session(1, 3));
+
+  // Ended sessions leave the index
+  uc = get_default_update_criteria();
+  uc.is_session_ended = true;
+  EXPECT_TRUE(session_store->update_sessions(update));
+  EXPECT_EQ(digest.size(), 0);
+  range = digest.get_range_digest(0, UpfSessionDigest::BUCKET_COUNT);
+  EXPECT_EQ(range.session_count, 0);
+  EXPECT_EQ(range.digest, 0);
+}
+
+TEST_F(UpfSessionDigestTest, test_digest_rebuilt_from_store) {
+  for (uint32_t teid = 1; teid <= 100; teid++) {
+    SessionVector sessions;
+    sessions.push_back(make_session(get_imsi(teid), teid, 1, SESSION_ACTIVE));
+    session_store->create_sessions(get_imsi(teid), std::move(sessions));
+  }
+  auto before = session_store->get_upf_session_digest().get_range_digest(
+      0, UpfSessionDigest::BUCKET_COUNT);
+  session_store->initialize_upf_session_digest();
+  auto after = session_store->get_upf_session_digest().get_range_digest(
+      0, UpfSessionDigest::BUCKET_COUNT);
+  EXPECT_EQ(after.session_count, 100);
+  EXPECT_EQ(after.digest, before.digest);
+}
+
+/**
+ * With NUM_SESSIONS in sync but two, the UPF narrows down to the two ranges
+ * holding them and only those two sessions are resent.
+ */
+TEST_F(UpfSessionDigestTest, test_reconciliation_proportional_to_drift) {
+  for (uint32_t teid = 1; teid <= NUM_SESSIONS; teid++) {
+    SessionVector sessions;
+    sessions.push_back(make_session(get_imsi(teid), teid, 2, SESSION_ACTIVE));
+    session_store->create_sessions(get_imsi(teid), std::move(sessions));
+    upf_sessions[teid] = 2;
+  }
+
+  // All in sync, nothing to look into
+  UPFSessionDigestReport report;
+  report.set_bucket_count(UpfSessionDigest::BUCKET_COUNT);
+  for (uint32_t start = 0; start < UpfSessionDigest::BUCKET_COUNT;
+       start += RANGE_BUCKETS) {
+    *report.add_range_digests() =
+        upf_range_digest(start, start + RANGE_BUCKETS);
+  }
+  EXPECT_CALL(*pipelined_client, set_upf_session(_, _, _, _)).Times(0);
+  auto result = reconcile(report);
+  EXPECT_EQ(result.mismatching_ranges_size(), 0);
+
+  // The UPF missed an update of one session and lost another one
+  upf_sessions[10] = 1;
+  upf_sessions.erase(5000);
+  report.clear_range_digests();
+  for (uint32_t start = 0; start < UpfSessionDigest::BUCKET_COUNT;
+       start += RANGE_BUCKETS) {
+    *report.add_range_digests() =
+        upf_range_digest(start, start + RANGE_BUCKETS);
+  }
+  result = reconcile(report);
+  ASSERT_EQ(result.mismatching_ranges_size(), 2);
+  EXPECT_EQ(result.mismatching_ranges(0).bucket_start(), 0);
+  EXPECT_EQ(result.mismatching_ranges(1).bucket_start(),
+            (5000 % UpfSessionDigest::BUCKET_COUNT) / RANGE_BUCKETS *
+                RANGE_BUCKETS);
+
+  // Next round the UPF lists the sessions of the mismatching ranges
+  UPFSessionDigestReport listing;
+  listing.set_bucket_count(UpfSessionDigest::BUCKET_COUNT);
+  for (const auto& mismatch : result.mismatching_ranges()) {
+    auto* listed = listing.add_listed_ranges();
+    listed->set_bucket_start(mismatch.bucket_start());
+    listed->set_bucket_end(mismatch.bucket_end());
+    add_upf_sessions(mismatch.bucket_start(), mismatch.bucket_end(), &listing);
+  }
+  EXPECT_CALL(*pipelined_client, set_upf_session(_, _, _, _)).Times(2);
+  result = reconcile(listing);
+  EXPECT_EQ(result.resent_sessions(), 2);
+}
+
+TEST_F(UpfSessionDigestTest, test_paging_resolved_locally) {
+  for (uint32_t teid = 1; teid <= 100; teid++) {
+    SessionVector sessions;
+    sessions.push_back(make_session(get_imsi(teid), teid, 2,
+                                    teid == 2 ? SESSION_ACTIVE : INACTIVE));
+    session_store->create_sessions(get_imsi(teid), std::move(sessions));
+  }
+  EXPECT_CALL(*mobilityd_client, get_subscriberid_from_ipv4(_, _)).Times(0);
+  std::vector<SetSmNotificationContext> notifs;
+  EXPECT_CALL(*amf_srv_client, handle_notification_to_access(_))
+      .Times(2)
+      .WillRepeatedly(testing::DoAll(
+          testing::Invoke([&notifs](const SetSmNotificationContext& notif) {
+            notifs.push_back(notif);
+          }),
+          testing::Return(true)));
+
+  // By local TEID, then by UE IP when the TEID is not known
+  EXPECT_TRUE(page(1, get_ue_ipv4(1)).ok());
+  EXPECT_TRUE(page(1000, get_ue_ipv4(10)).ok());
+  ASSERT_EQ(notifs.size(), 2);
+  EXPECT_EQ(notifs[0].common_context().sid().id(), get_imsi(1));
+  EXPECT_EQ(notifs[1].common_context().sid().id(), get_imsi(10));
+  EXPECT_EQ(notifs[1].rat_specific_notification().notify_ue_event(),
+            UE_PAGING_NOTIFY);
+  // An active session is not paged
+  EXPECT_EQ(page(2, get_ue_ipv4(2)).error_code(), grpc::FAILED_PRECONDITION);
+}
+
+TEST_F(UpfSessionDigestTest, test_paging_falls_back_to_mobilityd) {
+  SessionVector sessions;
+  sessions.push_back(make_session(get_imsi(1), 1, 2, INACTIVE));
+  session_store->create_sessions(get_imsi(1), std::move(sessions));
+
+  SubscriberID sid;
+  sid.set_id(get_imsi(1).substr(4));
+  EXPECT_CALL(*mobilityd_client, get_subscriberid_from_ipv4(_, _))
+      .WillOnce(testing::InvokeArgument<1>(Status::OK, sid));
+  EXPECT_CALL(*amf_srv_client, handle_notification_to_access(_)).Times(0);
+  // Neither the TEID nor the UE IP are known locally
+  EXPECT_EQ(page(1000, "10.2.0.1").error_code(), grpc::NOT_FOUND);
+}
+
+TEST_F(UpfSessionDigestTest, test_invalid_report_rejected) {
+  UPFSessionDigestReport report;
+  report.set_bucket_count(UpfSessionDigest::BUCKET_COUNT / 2);
+  grpc::StatusCode code = grpc::OK;
+  auto callback = [&code](Status status, UPFSessionDigestResult response) {
+    code = status.error_code();
+  };
+  upf_msg_handler->ReconcileUPFSessions(nullptr, &report, callback);
+  EXPECT_EQ(code, grpc::INVALID_ARGUMENT);
+
+  report.set_bucket_count(UpfSessionDigest::BUCKET_COUNT);
+  auto* range = report.add_range_digests();
+  range->set_bucket_start(0);
+  range->set_bucket_end(UpfSessionDigest::BUCKET_COUNT + 1);
+  code = grpc::OK;
+  upf_msg_handler->ReconcileUPFSessions(nullptr, &report, callback);
+  EXPECT_EQ(code, grpc::INVALID_ARGUMENT);
+}
+
+}  // namespace magma
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,176 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "UsageReportScheduler.h"
+
+namespace magma {
+
+class UsageReportSchedulerTest : public ::testing::Test {
+ protected:
+  void add_credit_update(
+      const std::string& imsi,
+      CreditUsage::UpdateType type = CreditUsage::THRESHOLD) {
+    auto* update = request.add_updates();
+    update->mutable_common_context()->mutable_sid()->set_id(imsi);
+    update->set_session_id(imsi + "-1");
+    update->mutable_usage()->set_type(type);
+    add_subscriber(imsi);
+  }
+
+  void add_monitor_update(const std::string& imsi) {
+    auto* update = request.add_usage_monitors();
+    update->set_sid(imsi);
+    update->set_session_id(imsi + "-1");
+    add_subscriber(imsi);
+  }
+
+  void add_subscriber(const std::string& imsi) {
+    session_map[imsi];
+    session_uc[imsi][imsi + "-1"] = get_default_update_criteria();
+  }
+
+  static std::vector<std::string> imsis(const UsageReportChunk& chunk) {
+    std::vector<std::string> result;
+    for (const auto& update : chunk.request.updates()) {
+      result.push_back(update.common_context().sid().id());
+    }
+    for (const auto& update : chunk.request.usage_monitors()) {
+      result.push_back(update.sid());
+    }
+    return result;
+  }
+
+  std::vector<std::unique_ptr<UsageReportChunk>> make_chunks(
+      uint32_t chunk_updates) {
+    UsageReportScheduler scheduler(chunk_updates);
+    return scheduler.make_chunks(std::move(request), session_map, session_uc);
+  }
+
+  std::vector<std::unique_ptr<UsageReportChunk>> single_chunk(bool urgent) {
+    std::vector<std::unique_ptr<UsageReportChunk>> chunks;
+    chunks.push_back(std::unique_ptr<UsageReportChunk>(new UsageReportChunk{
+        UpdateSessionRequest(), SessionMap(), SessionUpdate(), urgent, 0}));
+    return chunks;
+  }
+
+ protected:
+  UpdateSessionRequest request;
+  SessionMap session_map;
+  SessionUpdate session_uc;
+};
+
+TEST_F(UsageReportSchedulerTest, test_bounded_chunks) {
+  add_credit_update("IMSI1");
+  add_credit_update("IMSI2");
+  add_monitor_update("IMSI1");
+  add_credit_update("IMSI3");
+  add_credit_update("IMSI4");
+  add_monitor_update("IMSI4");
+  add_monitor_update("IMSI4");
+  // Not reporting
+  add_subscriber("IMSI5");
+
+  auto chunks = make_chunks(2);
+  ASSERT_EQ(chunks.size(), 3);
+  // The updates of a subscriber are never split
+  EXPECT_EQ(imsis(*chunks[0]), std::vector<std::string>({"IMSI1", "IMSI1"}));
+  EXPECT_EQ(imsis(*chunks[1]), std::vector<std::string>({"IMSI2", "IMSI3"}));
+  // Even when there are more than a chunk holds
+  EXPECT_EQ(imsis(*chunks[2]),
+            std::vector<std::string>({"IMSI4", "IMSI4", "IMSI4"}));
+
+  // Sessions and update criteria follow their chunk
+  EXPECT_EQ(chunks[1]->session_map.size(), 2);
+  EXPECT_EQ(chunks[1]->session_uc.count("IMSI3"), 1);
+  EXPECT_EQ(session_map.size(), 1);
+  EXPECT_EQ(session_uc.size(), 1);
+  EXPECT_EQ(session_uc.count("IMSI5"), 1);
+}
+
+TEST_F(UsageReportSchedulerTest, test_urgent_updates_first) {
+  add_credit_update("IMSI1");
+  add_credit_update("IMSI2", CreditUsage::QUOTA_EXHAUSTED);
+  add_credit_update("IMSI3");
+  add_credit_update("IMSI4", CreditUsage::VALIDITY_TIMER_EXPIRED);
+  add_credit_update("IMSI4");
+
+  auto chunks = make_chunks(10);
+  ASSERT_EQ(chunks.size(), 2);
+  EXPECT_TRUE(chunks[0]->urgent);
+  EXPECT_EQ(imsis(*chunks[0]),
+            std::vector<std::string>({"IMSI2", "IMSI4", "IMSI4"}));
+  EXPECT_FALSE(chunks[1]->urgent);
+  EXPECT_EQ(imsis(*chunks[1]), std::vector<std::string>({"IMSI1", "IMSI3"}));
+}
+
+TEST_F(UsageReportSchedulerTest, test_in_flight_window) {
+  UsageReportScheduler scheduler(10, 2);
+  for (int i = 0; i < 3; i++) {
+    scheduler.enqueue(single_chunk(false));
+  }
+  uint64_t id1, id2, id3;
+  ASSERT_NE(scheduler.pop_ready(&id1), nullptr);
+  ASSERT_NE(scheduler.pop_ready(&id2), nullptr);
+  EXPECT_EQ(scheduler.pop_ready(&id3), nullptr);
+  EXPECT_EQ(scheduler.get_in_flight(), 2);
+
+  // Urgent chunks go ahead of the queued ones
+  scheduler.enqueue(single_chunk(true));
+  EXPECT_TRUE(scheduler.complete(id2));
+  EXPECT_FALSE(scheduler.complete(id2));
+  const auto* chunk = scheduler.pop_ready(&id3);
+  ASSERT_NE(chunk, nullptr);
+  EXPECT_TRUE(chunk->urgent);
+  EXPECT_EQ(scheduler.get_queued(), 1);
+}
+
+TEST_F(UsageReportSchedulerTest, test_retry) {
+  UsageReportScheduler scheduler(10, 1, 1);
+  scheduler.enqueue(single_chunk(false));
+  scheduler.enqueue(single_chunk(false));
+
+  uint64_t id;
+  const auto* sent = scheduler.pop_ready(&id);
+  auto chunk = scheduler.complete(id);
+  EXPECT_TRUE(
+      scheduler.retry(chunk, grpc::Status(grpc::UNAVAILABLE, "unavailable")));
+  EXPECT_FALSE(chunk);
+
+  // Retried ahead of the chunk left
+  EXPECT_EQ(scheduler.pop_ready(&id), sent);
+  EXPECT_EQ(sent->attempts, 2);
+  chunk = scheduler.complete(id);
+  EXPECT_FALSE(scheduler.retry(
+      chunk, grpc::Status(grpc::DEADLINE_EXCEEDED, "deadline exceeded")));
+  ASSERT_TRUE(chunk);
+
+  ASSERT_NE(scheduler.pop_ready(&id), nullptr);
+  chunk = scheduler.complete(id);
+  // Not transient
+  EXPECT_FALSE(
+      scheduler.retry(chunk, grpc::Status(grpc::INVALID_ARGUMENT, "invalid")));
+  EXPECT_EQ(scheduler.get_queued(), 0);
+  EXPECT_EQ(scheduler.get_in_flight(), 0);
+}
+
+}  // namespace magma
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
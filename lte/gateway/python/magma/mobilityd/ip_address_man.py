@@ -51,7 +51,7 @@ import ipaddress
 import logging
 import threading
 from ipaddress import ip_address, ip_network
-from typing import List, Optional, Tuple
+from typing import Dict, List, Optional, Tuple
 
 from lte.protos.mobilityd_pb2 import GWInfo, IPAddress
 from magma.mobilityd.ip_descriptor import IPState
@@ -446,6 +446,106 @@ class IPAddressManager:
                 self.ipv6_allocator.release_ip(ip_desc)
                 del self._store.sid_ips_map[ip_desc.sid]
 
+    def reserve_ip_block(
+        self, prefix_len: int,
+        owner: str,
+    ) -> Optional[ip_network]:
+        """ Take a free IPv4 sub-block out of the pool, e.g. to lease it to a
+        delegated allocator
+
+        Only sub-blocks whose every address is FREE are reserved. The
+        addresses are moved to the RESERVED state with owner as their SID
+        until return_ip_block is called.
+
+        Args:
+            prefix_len (int): prefix length of the sub-block
+            owner (str): SID the reserved addresses are marked with
+
+        Returns:
+            ipaddress.ip_network: the reserved sub-block, None if no free
+            sub-block of prefix_len is left
+        """
+        with self._lock:
+            ip_state_map = self._store.ip_state_map
+            for block in self.ip_allocator.list_added_ip_blocks():
+                if block.version != 4 or block.prefixlen > prefix_len:
+                    continue
+                for sub_block in block.subnets(new_prefix=prefix_len):
+                    if not all(
+                        ip_state_map.test_ip_state(ip, IPState.FREE)
+                        for ip in sub_block
+                    ):
+                        continue
+                    for ip in sub_block:
+                        ip_desc = ip_state_map.remove_ip_from_state(
+                            ip, IPState.FREE,
+                        )
+                        ip_desc.sid = owner
+                        ip_desc.state = IPState.RESERVED
+                        ip_state_map.add_ip_to_state(
+                            ip, ip_desc, IPState.RESERVED,
+                        )
+                    return sub_block
+            return None
+
+    def return_ip_block(
+        self, ip_block: ip_network,
+        allocated: Dict[ip_address, str],
+    ):
+        """ Return a sub-block reserved by reserve_ip_block to the pool
+
+        Addresses in use by a UE stay allocated to it, as if they had been
+        allocated by alloc_ip_address, and are freed once released. The
+        others are freed right away.
+
+        Args:
+            ip_block (ipaddress.ip_network): sub-block to return
+            allocated (dict): SID of each address of ip_block still in use
+        """
+        with self._lock:
+            ip_state_map = self._store.ip_state_map
+            for ip in ip_block:
+                ip_desc = ip_state_map.remove_ip_from_state(
+                    ip, IPState.RESERVED,
+                )
+                if ip_desc is None:
+                    continue
+                sid = allocated.get(ip)
+                if sid is not None and sid not in self._store.sid_ips_map:
+                    ip_desc.sid = sid
+                    ip_desc.state = IPState.ALLOCATED
+                    ip_state_map.add_ip_to_state(
+                        ip, ip_desc, IPState.ALLOCATED,
+                    )
+                    self._store.sid_ips_map[sid] = ip_desc
+                else:
+                    ip_desc.sid = None
+                    ip_desc.state = IPState.FREE
+                    ip_state_map.add_ip_to_state(ip, ip_desc, IPState.FREE)
+
+    def adopt_ip_address(self, sid: str, ip: ip_address) -> bool:
+        """ Record a FREE IPv4 address as allocated to sid, e.g. when a
+        delegated allocator reports an address allocated from a lease that
+        has expired in between
+
+        Returns:
+            True if the address was FREE and is now allocated to sid
+        """
+        with self._lock:
+            if sid in self._store.sid_ips_map or \
+                    not self.is_ip_in_state(ip, IPState.FREE):
+                return False
+            ip_desc = self._store.ip_state_map.remove_ip_from_state(
+                ip, IPState.FREE,
+            )
+            ip_desc.sid = sid
+            ip_desc.state = IPState.ALLOCATED
+            self._store.ip_state_map.add_ip_to_state(
+                ip, ip_desc, IPState.ALLOCATED,
+            )
+            self._store.sid_ips_map[sid] = ip_desc
+            return True
+
     def list_gateway_info(self) -> List[GWInfo]:
         with self._lock:
             return self._store.dhcp_gw_info.get_all_router_ips()
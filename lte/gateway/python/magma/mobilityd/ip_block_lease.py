@@ -0,0 +1,283 @@
+"""
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+IP block leases let a delegated allocator, e.g. the SPGW task, allocate UE
+IPv4 addresses itself instead of calling AllocateIPAddress for every UE.
+
+A lease reserves a sub-block of the IPv4 pool for one holder and APN. The
+holder allocates addresses out of it locally and reports its allocations and
+releases back in ordered batches, which are recorded against the lease so
+that the holder can recover them after a restart. A lease that is not
+renewed in time expires: its sub-block is returned to the pool, and the
+addresses still in use stay allocated to their UEs as regular allocations.
+
+Leases are persisted to Redis, keyed by lease id. Lease ids come from a
+persisted monotonic counter and are never reused:
+    - lease_id (int)
+    - holder (str)
+    - apn (str)
+    - block (str): leased sub-block, e.g. "192.168.128.0/24"
+    - expires_at (float): wall clock expiry time, in seconds
+    - allocated: {ip (str) => [SID, APN]}
+"""
+
+import logging
+import threading
+import time
+from ipaddress import ip_address, ip_network
+from typing import Iterable, List, Optional, Tuple
+
+from lte.protos.mobilityd_pb2 import IPAllocationRecord
+from magma.subscriberdb.sid import SIDUtils
+
+from .ip_address_man import IPAddressManager
+from .ip_allocator_base import (
+    IPNotInUseError,
+    MappingNotFoundError,
+    NoAvailableIPError,
+)
+from .mobility_store import MobilityStore
+
+DEFAULT_LEASE_DURATION_SECS = 600
+# Leased sub-blocks must fit the delegated allocator's bitmap
+MIN_LEASE_PREFIX_LEN = 16
+MAX_LEASE_PREFIX_LEN = 32
+LEASE_OWNER_PREFIX = "IPBlockLease"
+
+
+class IPBlockLeaseManager:
+    """ A thread-safe manager of the IPv4 sub-blocks leased to delegated
+    allocators.
+    """
+
+    def __init__(
+        self,
+        ip_address_manager: IPAddressManager,
+        store: MobilityStore,
+        lease_duration: int = DEFAULT_LEASE_DURATION_SECS,
+    ):
+        """ Initializes a new IP block lease manager
+
+        Args:
+            ip_address_manager (IPAddressManager): owner of the IPv4 pool the
+                sub-blocks are leased from
+            store (MobilityStore): mobilityd storage instance
+            lease_duration (int): time, in seconds, a lease lasts unless it
+                is renewed
+        """
+        self._lock = threading.Lock()
+        self._ip_address_man = ip_address_manager
+        self._leases = store.ip_block_leases
+        self._lease_ids = store.ip_block_lease_ids
+        self._lease_duration = lease_duration
+        # Leases persisted before the id counter existed
+        self._lease_ids.advance_to(
+            max((int(key) for key in self._leases), default=0),
+        )
+        # (SID, APN) => ip of every allocation recorded against a lease
+        self._sid_apn_ips = {}
+        for lease in self._leases.values():
+            self._index_lease(lease)
+
+    def lease_block(self, holder: str, apn: str, prefix_len: int) -> dict:
+        """ Lease a free sub-block of the IPv4 pool
+
+        Raises:
+            InvalidLeaseRequestError: if prefix_len is out of range
+            NoAvailableIPError: if no free sub-block of prefix_len is left
+        """
+        if not MIN_LEASE_PREFIX_LEN <= prefix_len <= MAX_LEASE_PREFIX_LEN:
+            raise InvalidLeaseRequestError(
+                "Invalid lease prefix length %d" % prefix_len,
+            )
+        with self._lock:
+            self._expire_leases()
+            # Never reused, a holder of an expired lease must not renew or
+            # sync against a newer lease of the same id
+            lease_id = self._lease_ids.next_id()
+            block = self._ip_address_man.reserve_ip_block(
+                prefix_len, _lease_owner(lease_id),
+            )
+            if block is None:
+                raise NoAvailableIPError(
+                    "No free /%d IP block to lease" % prefix_len,
+                )
+            lease = {
+                'lease_id': lease_id,
+                'holder': holder,
+                'apn': apn,
+                'block': str(block),
+                'expires_at': time.time() + self._lease_duration,
+                'allocated': {},
+            }
+            self._leases[str(lease_id)] = lease
+            logging.info(
+                "Leased IP block %s for apn %s to %s, lease %d",
+                block, apn, holder, lease_id,
+            )
+            return lease
+
+    def renew_lease(self, holder: str, lease_id: int) -> dict:
+        """ Extend a lease by the lease duration
+
+        Raises:
+            LeaseNotFoundError: if the lease has expired
+        """
+        with self._lock:
+            self._expire_leases()
+            lease = self._get_lease(holder, lease_id)
+            lease['expires_at'] = time.time() + self._lease_duration
+            self._leases[str(lease_id)] = lease
+            return lease
+
+    def list_leases(self, holder: str) -> List[dict]:
+        """ Return every live lease of holder """
+        with self._lock:
+            self._expire_leases()
+            return [
+                lease for lease in self._leases.values()
+                if lease['holder'] == holder
+            ]
+
+    def sync_allocations(
+        self, holder: str,
+        records: Iterable[IPAllocationRecord],
+    ):
+        """ Apply, in order, the allocations and releases reported by holder
+
+        Records of a lease that has expired in between are applied to the
+        regular allocations the lease's addresses were turned into.
+        """
+        with self._lock:
+            self._expire_leases()
+            updated = {}
+            for record in records:
+                lease_key = str(record.lease_id)
+                lease = updated.get(lease_key) or self._leases.get(lease_key)
+                if lease is None or lease['holder'] != holder:
+                    self._sync_expired(record)
+                    continue
+                if self._sync_record(lease, record):
+                    updated[lease_key] = lease
+            for lease_key, lease in updated.items():
+                self._leases[lease_key] = lease
+
+    def get_ip_for_sid(self, sid: str, apn: str) -> Optional[ip_address]:
+        """ Return the address allocated to (sid, apn) out of a lease """
+        with self._lock:
+            return self._sid_apn_ips.get((sid, apn))
+
+    def get_sid_for_ip(self, ip: ip_address) -> Optional[str]:
+        """ Return the SID an address was allocated to out of a lease """
+        with self._lock:
+            for lease in self._leases.values():
+                sid_apn = lease['allocated'].get(str(ip))
+                if sid_apn is not None:
+                    return sid_apn[0]
+            return None
+
+    def get_sid_ip_table(self) -> List[Tuple[str, str, ip_address]]:
+        """ Return (sid, apn, ip) of every allocation out of a lease """
+        with self._lock:
+            return [
+                (sid, apn, ip) for (sid, apn), ip in self._sid_apn_ips.items()
+            ]
+
+    def _get_lease(self, holder: str, lease_id: int) -> dict:
+        lease = self._leases.get(str(lease_id))
+        if lease is None or lease['holder'] != holder:
+            raise LeaseNotFoundError("IP block lease %d not found" % lease_id)
+        return lease
+
+    def _sync_record(self, lease: dict, record: IPAllocationRecord) -> bool:
+        """ Apply a record to a live lease, returns True if it changed """
+        ip = ip_address(record.entry.ip.address)
+        if ip not in ip_network(lease['block']):
+            logging.warning(
+                "Ignoring IP %s out of IP block lease %d",
+                ip, lease['lease_id'],
+            )
+            return False
+        sid = _record_sid(record)
+        apn = record.entry.apn
+        if record.released:
+            if lease['allocated'].pop(str(ip), None) is None:
+                return False
+            if self._sid_apn_ips.get((sid, apn)) == ip:
+                del self._sid_apn_ips[(sid, apn)]
+        else:
+            lease['allocated'][str(ip)] = [sid, apn]
+            self._sid_apn_ips[(sid, apn)] = ip
+        return True
+
+    def _sync_expired(self, record: IPAllocationRecord):
+        ip = ip_address(record.entry.ip.address)
+        composite_sid = _composite_sid(_record_sid(record), record.entry.apn)
+        if record.released:
+            try:
+                self._ip_address_man.release_ip_address(composite_sid, ip)
+            except (MappingNotFoundError, IPNotInUseError):
+                pass
+        elif not self._ip_address_man.adopt_ip_address(composite_sid, ip):
+            logging.error(
+                "IP %s allocated to %s out of expired IP block lease %d is "
+                "in use", ip, composite_sid, record.lease_id,
+            )
+
+    def _expire_leases(self):
+        now = time.time()
+        for lease_key, lease in list(self._leases.items()):
+            if lease['expires_at'] > now:
+                continue
+            allocated = {
+                ip_address(ip): _composite_sid(sid, apn)
+                for ip, (sid, apn) in lease['allocated'].items()
+            }
+            self._ip_address_man.return_ip_block(
+                ip_network(lease['block']), allocated,
+            )
+            for (sid, apn) in lease['allocated'].values():
+                self._sid_apn_ips.pop((sid, apn), None)
+            del self._leases[lease_key]
+            logging.warning(
+                "IP block lease %d of %s expired, %d addresses in use",
+                lease['lease_id'], lease['holder'], len(allocated),
+            )
+
+    def _index_lease(self, lease: dict):
+        for ip, (sid, apn) in lease['allocated'].items():
+            self._sid_apn_ips[(sid, apn)] = ip_address(ip)
+
+
+def _lease_owner(lease_id: int) -> str:
+    return "%s%d" % (LEASE_OWNER_PREFIX, lease_id)
+
+
+def _record_sid(record: IPAllocationRecord) -> str:
+    return SIDUtils.to_str(record.entry.sid)
+
+
+def _composite_sid(sid: str, apn: str) -> str:
+    """ SID key of IPv4 allocations, as built by the rpc servicer """
+    if apn:
+        sid = sid + "." + apn
+    return sid + ",ipv4"
+
+
+class InvalidLeaseRequestError(Exception):
+    """ Exception thrown when a lease request is invalid """
+    pass
+
+
+class LeaseNotFoundError(Exception):
+    """ Exception thrown when a lease is unknown or has expired """
+    pass
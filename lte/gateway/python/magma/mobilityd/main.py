@@ -26,6 +26,10 @@ from magma.mobilityd.ip_allocator_dhcp import IPAllocatorDHCP
 from magma.mobilityd.ip_allocator_multi_apn import IPAllocatorMultiAPNWrapper
 from magma.mobilityd.ip_allocator_pool import IpAllocatorPool
 from magma.mobilityd.ip_allocator_static import IPAllocatorStaticWrapper
+from magma.mobilityd.ip_block_lease import (
+    DEFAULT_LEASE_DURATION_SECS,
+    IPBlockLeaseManager,
+)
 from magma.mobilityd.ipv6_allocator_pool import IPv6AllocatorPool
 from magma.mobilityd.mobility_store import MobilityStore
 from magma.mobilityd.rpc_servicer import MobilityServiceRpcServicer
@@ -193,6 +197,10 @@ def main():
 
     # Load IPAddressManager
     ip_address_man = IPAddressManager(ipv4_allocator, ipv6_allocator, store)
+    ip_block_lease_man = IPBlockLeaseManager(
+        ip_address_man, store,
+        config.get('ip_block_lease_secs', DEFAULT_LEASE_DURATION_SECS),
+    )
 
     # Load IPv4 and IPv6 blocks from the configurable mconfig file
     # No dynamic reloading support for now, assume restart after updates
@@ -223,6 +231,7 @@ def main():
     # Add all servicers to the server
     mobility_service_servicer = MobilityServiceRpcServicer(
         ip_address_man, config.get('print_grpc_payload', False),
+        ip_block_lease_man,
     )
     mobility_service_servicer.add_to_server(service.rpc_server)
     service.run()
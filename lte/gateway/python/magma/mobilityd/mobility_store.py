@@ -30,6 +30,8 @@ MAC_TO_IP_REDIS_TYPE = "mobilityd_mac_to_ip"
 DHCP_GW_INFO_REDIS_TYPE = "mobilityd_gw_info"
 ALLOCATED_IID_REDIS_TYPE = "mobilityd_allocated_iid"
 ALLOCATED_SESSION_PREFIX_TYPE = "mobilityd_allocated_session_prefix"
+IP_BLOCK_LEASE_REDIS_TYPE = "mobilityd_ip_block_lease"
+IP_BLOCK_LEASE_ID_REDIS_KEY = "mobilityd_ip_block_lease_id"
 
 
 class MobilityStore(object):
@@ -53,6 +55,8 @@ class MobilityStore(object):
         self.dhcp_store = MacToIP(client)  # mac => DHCP_State
         self.allocated_iid = AllocatedIID(client)
         self.sid_session_prefix_allocated = AllocatedSessionPrefix(client)
+        self.ip_block_leases = IPBlockLeaseDict(client)
+        self.ip_block_lease_ids = IPBlockLeaseIdCounter(client)
 
 
 class AssignedIpBlocksSet(RedisSet):
@@ -166,3 +170,36 @@ class AllocatedSessionPrefix(RedisFlatDict):
     def __missing__(self, key):
         """Instead of throwing a key error, return None when key not found"""
         return None
+
+
+class IPBlockLeaseDict(RedisFlatDict):
+    """
+    Used for tracking IPv4 sub-blocks leased to delegated allocators, keyed
+    by lease id
+    """
+
+    def __init__(self, client):
+        serde = RedisSerde(
+            IP_BLOCK_LEASE_REDIS_TYPE,
+            get_json_serializer(), get_json_deserializer(),
+        )
+        super().__init__(client, serde, writethrough=True)
+
+
+class IPBlockLeaseIdCounter(object):
+    """
+    Monotonic counter of IP block lease ids, ids of expired leases are never
+    handed out again
+    """
+
+    def __init__(self, client):
+        self._client = client
+
+    def next_id(self) -> int:
+        return self._client.incr(IP_BLOCK_LEASE_ID_REDIS_KEY)
+
+    def advance_to(self, lease_id: int):
+        """ Make sure ids up to lease_id are never handed out """
+        current = int(self._client.get(IP_BLOCK_LEASE_ID_REDIS_KEY) or 0)
+        if current < lease_id:
+            self._client.set(IP_BLOCK_LEASE_ID_REDIS_KEY, lease_id)
@@ -13,6 +13,8 @@ limitations under the License.
 
 import ipaddress
 import logging
+import time
+from typing import Optional
 
 import grpc
 from google.protobuf.json_format import MessageToJson
@@ -21,11 +23,14 @@ from lte.protos.mobilityd_pb2 import (
     AllocateIPRequest,
     IPAddress,
     IPBlock,
+    IPBlockLease,
+    IPBlockLeaseList,
     ListAddedIPBlocksResponse,
     ListAllocatedIPsResponse,
     ListGWInfoResponse,
     RemoveIPBlockResponse,
     SubscriberIPTable,
+    SubscriberIPTableEntry,
 )
 from lte.protos.mobilityd_pb2_grpc import (
     MobilityServiceServicer,
@@ -47,6 +52,11 @@ from .ip_allocator_base import (
     NoAvailableIPError,
     OverlappedIPBlocksError,
 )
+from .ip_block_lease import (
+    InvalidLeaseRequestError,
+    IPBlockLeaseManager,
+    LeaseNotFoundError,
+)
 from .ipv6_allocator_pool import MaxCalculationError
 from .subscriberdb_client import (
     SubscriberDBConnectionError,
@@ -61,9 +71,11 @@ class MobilityServiceRpcServicer(MobilityServiceServicer):
     def __init__(
         self, ip_address_manager: IPAddressManager,
         print_grpc_payload: bool = False,
+        ip_block_lease_manager: Optional[IPBlockLeaseManager] = None,
     ):
         """Initialize mobilityd GRPC endpoints."""
         self._ip_address_man = ip_address_manager
+        self._ip_block_leases = ip_block_lease_manager
         self._print_grpc_payload = print_grpc_payload
 
         if self._print_grpc_payload:
@@ -324,6 +336,11 @@ class MobilityServiceRpcServicer(MobilityServiceServicer):
             composite_sid += ",ipv6"
 
         ip = self._ip_address_man.get_ip_for_sid(composite_sid)
+        if ip is None and self._ip_block_leases is not None and \
+                request.version == IPAddress.IPV4:
+            ip = self._ip_block_leases.get_ip_for_sid(
+                SIDUtils.to_str(request.sid), request.apn,
+            )
         if ip is None:
             context.set_details(
                 'SID %s not found'
@@ -344,6 +361,8 @@ class MobilityServiceRpcServicer(MobilityServiceServicer):
 
         sent_ip = ipaddress.ip_address(ip_addr.address)
         sid = self._ip_address_man.get_sid_for_ip(sent_ip)
+        if sid is None and self._ip_block_leases is not None:
+            sid = self._ip_block_leases.get_sid_for_ip(sent_ip)
 
         if sid is None:
             context.set_details('IP address %s not found' % str(sent_ip))
@@ -372,6 +391,13 @@ class MobilityServiceRpcServicer(MobilityServiceServicer):
             version = IPAddress.IPV4 if ip.version == 4 else IPAddress.IPV6
             ip_msg = IPAddress(version=version, address=ip.packed)
             resp.entries.add(sid=sid_pb, ip=ip_msg, apn=apn)
+        if self._ip_block_leases is not None:
+            for sid, apn, ip in self._ip_block_leases.get_sid_ip_table():
+                resp.entries.add(
+                    sid=SIDUtils.to_pb(sid),
+                    ip=IPAddress(version=IPAddress.IPV4, address=ip.packed),
+                    apn=apn,
+                )
         self._print_grpc(resp)
         return resp
 
@@ -393,6 +419,109 @@ class MobilityServiceRpcServicer(MobilityServiceServicer):
         self._print_grpc(info)
         self._ip_address_man.set_gateway_info(info)
 
+    def LeaseIPBlock(self, request, context):
+        """ Lease a sub-block of the IPv4 pool for delegated allocation """
+        logging.debug("Received LeaseIPBlock")
+        self._print_grpc(request)
+        if self._ip_block_leases is None:
+            self._unimplemented_ip_block_leases_error(context)
+            return IPBlockLease()
+
+        resp = IPBlockLease()
+        try:
+            lease = self._ip_block_leases.lease_block(
+                request.holder, request.apn, request.prefix_len,
+            )
+            resp = self._ip_block_lease_msg(lease)
+        except InvalidLeaseRequestError as err:
+            context.set_details(str(err))
+            context.set_code(grpc.StatusCode.INVALID_ARGUMENT)
+        except NoAvailableIPError:
+            context.set_details(
+                'No free /%d IP block available' % request.prefix_len,
+            )
+            context.set_code(grpc.StatusCode.RESOURCE_EXHAUSTED)
+
+        self._print_grpc(resp)
+        return resp
+
+    def RenewIPBlockLease(self, request, context):
+        """ Extend an IP block lease """
+        logging.debug("Received RenewIPBlockLease")
+        self._print_grpc(request)
+        if self._ip_block_leases is None:
+            self._unimplemented_ip_block_leases_error(context)
+            return IPBlockLease()
+
+        resp = IPBlockLease()
+        try:
+            lease = self._ip_block_leases.renew_lease(
+                request.holder, request.lease_id,
+            )
+            resp = self._ip_block_lease_msg(lease)
+        except LeaseNotFoundError:
+            context.set_details(
+                'IP block lease %d not found' % request.lease_id,
+            )
+            context.set_code(grpc.StatusCode.NOT_FOUND)
+
+        self._print_grpc(resp)
+        return resp
+
+    def ListIPBlockLeases(self, request, context):
+        """ Return every live IP block lease of a holder """
+        logging.debug("Received ListIPBlockLeases")
+        self._print_grpc(request)
+        resp = IPBlockLeaseList()
+        if self._ip_block_leases is None:
+            self._unimplemented_ip_block_leases_error(context)
+            return resp
+
+        for lease in self._ip_block_leases.list_leases(request.holder):
+            resp.leases.append(self._ip_block_lease_msg(lease))
+        self._print_grpc(resp)
+        return resp
+
+    @return_void
+    def SyncIPAllocations(self, request, context):
+        """ Record a batch of delegated allocations and releases """
+        logging.debug("Received SyncIPAllocations")
+        self._print_grpc(request)
+        if self._ip_block_leases is None:
+            self._unimplemented_ip_block_leases_error(context)
+            return
+
+        self._ip_block_leases.sync_allocations(
+            request.holder, request.records,
+        )
+
+    def _ip_block_lease_msg(self, lease):
+        """ convert an IP block lease to IPBlockLease """
+        block = ipaddress.ip_network(lease['block'])
+        resp = IPBlockLease(
+            lease_id=lease['lease_id'],
+            holder=lease['holder'],
+            apn=lease['apn'],
+            block=IPBlock(
+                version=IPBlock.IPV4,
+                net_address=block.network_address.packed,
+                prefix_len=block.prefixlen,
+            ),
+            expires_in_secs=max(0, int(lease['expires_at'] - time.time())),
+        )
+        for ip, (sid, apn) in lease['allocated'].items():
+            resp.allocated.append(
+                SubscriberIPTableEntry(
+                    sid=SIDUtils.to_pb(sid),
+                    ip=IPAddress(
+                        version=IPAddress.IPV4,
+                        address=ipaddress.ip_address(ip).packed,
+                    ),
+                    apn=apn,
+                ),
+            )
+        return resp
+
     def _get_allocate_ip_response(
         self, composite_sid, version, context,
         request,
@@ -471,6 +600,10 @@ class MobilityServiceRpcServicer(MobilityServiceServicer):
         context.set_details("IPv6 is not yet supported")
         context.set_code(grpc.StatusCode.UNIMPLEMENTED)
 
+    def _unimplemented_ip_block_leases_error(self, context):
+        context.set_details("IP block leases are not enabled")
+        context.set_code(grpc.StatusCode.UNIMPLEMENTED)
+
     def _print_grpc(self, message):
         if self._print_grpc_payload:
             log_msg = "{} {}".format(
@@ -0,0 +1,341 @@
+"""
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import ipaddress
+import time
+import unittest
+import unittest.mock
+from concurrent import futures
+
+import fakeredis
+import grpc
+from lte.protos.mobilityd_pb2 import (
+    IPAddress,
+    IPAllocationRecord,
+    IPBlock,
+    IPBlockLease,
+    IPBlockLeaseHolder,
+    IPBlockLeaseRequest,
+    IPLookupRequest,
+    SubscriberIPTableEntry,
+    SyncIPAllocationsRequest,
+)
+from lte.protos.mobilityd_pb2_grpc import MobilityServiceStub
+from magma.mobilityd.ip_address_man import IPAddressManager
+from magma.mobilityd.ip_allocator_pool import IpAllocatorPool
+from magma.mobilityd.ip_block_lease import IPBlockLeaseManager
+from magma.mobilityd.ip_descriptor import IPState
+from magma.mobilityd.ipv6_allocator_pool import IPv6AllocatorPool
+from magma.mobilityd.mobility_store import MobilityStore
+from magma.mobilityd.rpc_servicer import MobilityServiceRpcServicer
+from magma.subscriberdb.sid import SIDUtils
+from orc8r.protos.common_pb2 import Void
+
+HOLDER = 'spgw'
+APN = 'internet'
+LEASE_DURATION = 600
+
+
+class IPBlockLeaseTests(unittest.TestCase):
+    """
+    Tests for the IP block lease RPCs of the mobilityd servicer
+    """
+
+    def setUp(self):
+        # Bind the rpc server to a free port
+        thread_pool = futures.ThreadPoolExecutor(max_workers=10)
+        self._rpc_server = grpc.server(thread_pool)
+        port = self._rpc_server.add_insecure_port('0.0.0.0:0')
+
+        self._redis = fakeredis.FakeStrictRedis()
+        self._store = MobilityStore(self._redis)
+        self._store.dhcp_gw_info.read_default_gw()
+        ipv6_allocator = IPv6AllocatorPool(
+            self._store,
+            session_prefix_alloc_mode='RANDOM',
+        )
+        self._allocator = IPAddressManager(
+            IpAllocatorPool(self._store),
+            ipv6_allocator,
+            self._store,
+        )
+        self._block = ipaddress.ip_network('192.168.1.0/24')
+        self._allocator.add_ip_block(self._block)
+        self._lease_man = IPBlockLeaseManager(
+            self._allocator, self._store, LEASE_DURATION,
+        )
+
+        # Add the servicer
+        self._servicer = MobilityServiceRpcServicer(
+            self._allocator, False, self._lease_man,
+        )
+        self._servicer.add_to_server(self._rpc_server)
+        self._rpc_server.start()
+
+        # Create a rpc stub
+        channel = grpc.insecure_channel('0.0.0.0:{}'.format(port))
+        self._stub = MobilityServiceStub(channel)
+
+        self._sid0 = SIDUtils.to_pb('IMSI0')
+        self._sid1 = SIDUtils.to_pb('IMSI1')
+
+    def tearDown(self):
+        self._rpc_server.stop(0)
+
+    def _lease(self, prefix_len=28):
+        return self._stub.LeaseIPBlock(
+            IPBlockLeaseRequest(
+                holder=HOLDER, apn=APN, prefix_len=prefix_len,
+            ),
+        )
+
+    def _record(self, lease, sid, ip, released=False):
+        return IPAllocationRecord(
+            lease_id=lease.lease_id,
+            entry=SubscriberIPTableEntry(
+                sid=sid,
+                ip=IPAddress(version=IPAddress.IPV4, address=ip.packed),
+                apn=APN,
+            ),
+            released=released,
+        )
+
+    def _sync(self, *records):
+        self._stub.SyncIPAllocations(
+            SyncIPAllocationsRequest(holder=HOLDER, records=records),
+        )
+
+    @staticmethod
+    def _block_of(lease):
+        return ipaddress.ip_network(
+            '%s/%d' % (
+                ipaddress.ip_address(lease.block.net_address),
+                lease.block.prefix_len,
+            ),
+        )
+
+    def test_lease_ip_block(self):
+        """ a leased sub-block is reserved out of the IPv4 pool """
+        lease = self._lease()
+        block = self._block_of(lease)
+        self.assertEqual(lease.holder, HOLDER)
+        self.assertEqual(lease.apn, APN)
+        self.assertEqual(lease.block.version, IPBlock.IPV4)
+        self.assertTrue(block.subnet_of(self._block))
+        self.assertGreater(lease.expires_in_secs, 0)
+        for ip in block:
+            self.assertTrue(self._allocator.is_ip_in_state(
+                ip, IPState.RESERVED,
+            ))
+
+        # Leases never overlap
+        other = self._block_of(self._lease())
+        self.assertFalse(block.overlaps(other))
+        self.assertNotEqual(self._lease().lease_id, lease.lease_id)
+
+    def test_lease_invalid_prefix_len(self):
+        """ leasing a sub-block too large should raise INVALID_ARGUMENT """
+        with self.assertRaises(grpc.RpcError) as err:
+            self._lease(prefix_len=8)
+        self.assertEqual(
+            err.exception.code(),
+            grpc.StatusCode.INVALID_ARGUMENT,
+        )
+
+    def test_lease_run_out_of_blocks(self):
+        """ leasing more than the pool holds should raise RESOURCE_EXHAUSTED """
+        with self.assertRaises(grpc.RpcError) as err:
+            self._lease(prefix_len=24)
+        self.assertEqual(
+            err.exception.code(),
+            grpc.StatusCode.RESOURCE_EXHAUSTED,
+        )
+
+    def test_renew_lease(self):
+        """ renewing extends a live lease, unknown leases are NOT_FOUND """
+        lease = self._lease()
+        renewed = self._stub.RenewIPBlockLease(lease)
+        self.assertEqual(renewed.lease_id, lease.lease_id)
+        self.assertEqual(renewed.block, lease.block)
+
+        with self.assertRaises(grpc.RpcError) as err:
+            self._stub.RenewIPBlockLease(
+                IPBlockLease(holder=HOLDER, lease_id=lease.lease_id + 1),
+            )
+        self.assertEqual(err.exception.code(), grpc.StatusCode.NOT_FOUND)
+
+        # Leases of other holders are not visible
+        with self.assertRaises(grpc.RpcError) as err:
+            self._stub.RenewIPBlockLease(
+                IPBlockLease(holder='other', lease_id=lease.lease_id),
+            )
+        self.assertEqual(err.exception.code(), grpc.StatusCode.NOT_FOUND)
+
+    def test_sync_and_list_leases(self):
+        """ synced allocations are recorded against the lease """
+        lease = self._lease()
+        ips = list(self._block_of(lease))
+        self._sync(
+            self._record(lease, self._sid0, ips[0]),
+            self._record(lease, self._sid1, ips[1]),
+            self._record(lease, self._sid1, ips[1], released=True),
+        )
+
+        resp = self._stub.ListIPBlockLeases(IPBlockLeaseHolder(holder=HOLDER))
+        self.assertEqual(len(resp.leases), 1)
+        self.assertEqual(resp.leases[0].lease_id, lease.lease_id)
+        self.assertEqual(len(resp.leases[0].allocated), 1)
+        entry = resp.leases[0].allocated[0]
+        self.assertEqual(entry.sid, self._sid0)
+        self.assertEqual(entry.apn, APN)
+        self.assertEqual(ipaddress.ip_address(entry.ip.address), ips[0])
+
+        resp = self._stub.ListIPBlockLeases(IPBlockLeaseHolder(holder='other'))
+        self.assertEqual(len(resp.leases), 0)
+
+        # Out of lease addresses are ignored
+        self._sync(
+            self._record(
+                lease, self._sid1, ips[-1] + 1,
+            ),
+        )
+        self.assertIsNone(self._lease_man.get_sid_for_ip(ips[-1] + 1))
+
+    def test_lookups_see_delegated_allocations(self):
+        """ subscriber lookups find addresses allocated out of a lease """
+        lease = self._lease()
+        ip = list(self._block_of(lease))[3]
+        self._sync(self._record(lease, self._sid0, ip))
+
+        ip_msg = self._stub.GetIPForSubscriber(
+            IPLookupRequest(sid=self._sid0, apn=APN),
+        )
+        self.assertEqual(ipaddress.ip_address(ip_msg.address), ip)
+
+        sid = self._stub.GetSubscriberIDFromIP(
+            IPAddress(version=IPAddress.IPV4, address=ip.packed),
+        )
+        self.assertEqual(sid, self._sid0)
+
+        table = self._stub.GetSubscriberIPTable(Void())
+        self.assertIn(
+            SubscriberIPTableEntry(
+                sid=self._sid0,
+                ip=IPAddress(version=IPAddress.IPV4, address=ip.packed),
+                apn=APN,
+            ),
+            table.entries,
+        )
+
+        self._sync(self._record(lease, self._sid0, ip, released=True))
+        with self.assertRaises(grpc.RpcError) as err:
+            self._stub.GetIPForSubscriber(
+                IPLookupRequest(sid=self._sid0, apn=APN),
+            )
+        self.assertEqual(err.exception.code(), grpc.StatusCode.NOT_FOUND)
+
+    def test_leases_survive_restart(self):
+        """ leases and their allocations are reloaded from the store """
+        lease = self._lease()
+        ip = list(self._block_of(lease))[0]
+        self._sync(self._record(lease, self._sid0, ip))
+
+        lease_man = IPBlockLeaseManager(
+            self._allocator, MobilityStore(self._redis), LEASE_DURATION,
+        )
+        leases = lease_man.list_leases(HOLDER)
+        self.assertEqual(len(leases), 1)
+        self.assertEqual(leases[0]['lease_id'], lease.lease_id)
+        self.assertEqual(lease_man.get_ip_for_sid('IMSI0', APN), ip)
+
+    def test_lease_expiry(self):
+        """ an expired lease is returned to the pool, in use addresses stay
+        allocated to their UEs
+        """
+        lease = self._lease()
+        ips = list(self._block_of(lease))
+        self._sync(self._record(lease, self._sid0, ips[0]))
+
+        expired = time.time() + LEASE_DURATION + 1
+        with unittest.mock.patch(
+            'magma.mobilityd.ip_block_lease.time.time',
+            return_value=expired,
+        ):
+            resp = self._stub.ListIPBlockLeases(
+                IPBlockLeaseHolder(holder=HOLDER),
+            )
+            self.assertEqual(len(resp.leases), 0)
+
+            with self.assertRaises(grpc.RpcError) as err:
+                self._stub.RenewIPBlockLease(lease)
+            self.assertEqual(err.exception.code(), grpc.StatusCode.NOT_FOUND)
+
+            self.assertTrue(self._allocator.is_ip_in_state(
+                ips[0], IPState.ALLOCATED,
+            ))
+            for ip in ips[1:]:
+                self.assertTrue(self._allocator.is_ip_in_state(
+                    ip, IPState.FREE,
+                ))
+            self.assertEqual(
+                self._allocator.get_ip_for_sid('IMSI0.%s,ipv4' % APN),
+                ips[0],
+            )
+
+            # Records of the expired lease apply to regular allocations
+            self._sync(
+                self._record(lease, self._sid0, ips[0], released=True),
+                self._record(lease, self._sid1, ips[1]),
+            )
+            self.assertFalse(self._allocator.is_ip_in_state(
+                ips[0], IPState.ALLOCATED,
+            ))
+            self.assertEqual(
+                self._allocator.get_ip_for_sid('IMSI1.%s,ipv4' % APN),
+                ips[1],
+            )
+
+    def test_expired_lease_id_not_reused(self):
+        """ a new lease never takes the id of an expired lease """
+        lease = self._lease()
+        expired = time.time() + LEASE_DURATION + 1
+        with unittest.mock.patch(
+            'magma.mobilityd.ip_block_lease.time.time',
+            return_value=expired,
+        ):
+            new_lease = self._lease()
+            self.assertNotEqual(new_lease.lease_id, lease.lease_id)
+
+            with self.assertRaises(grpc.RpcError) as err:
+                self._stub.RenewIPBlockLease(lease)
+            self.assertEqual(err.exception.code(), grpc.StatusCode.NOT_FOUND)
+
+        # Nor after a restart
+        lease_man = IPBlockLeaseManager(
+            self._allocator, MobilityStore(self._redis), LEASE_DURATION,
+        )
+        self.assertGreater(
+            lease_man.lease_block(HOLDER, APN, 28)['lease_id'],
+            new_lease.lease_id,
+        )
+
+    def test_leases_not_enabled(self):
+        """ lease RPCs raise UNIMPLEMENTED without a lease manager """
+        self._servicer._ip_block_leases = None
+        with self.assertRaises(grpc.RpcError) as err:
+            self._lease()
+        self.assertEqual(err.exception.code(), grpc.StatusCode.UNIMPLEMENTED)
+
+
+if __name__ == "__main__":
+    unittest.main()
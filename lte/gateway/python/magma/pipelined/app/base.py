@@ -129,6 +129,23 @@ class MagmaController(app_manager.RyuApp):
             "Received Setup request with epoch - %d, current "
             "epoch  is - %d", epoch, global_epoch,
         )
+        ret = self.check_setup_batch_epoch(epoch)
+        if ret is not None:
+            return ret
+
+        if self.init_finished:
+            self.logger.warning('Controller already initialized, ignoring')
+            return SetupFlowsResult.SUCCESS
+
+        return None
+
+    def check_setup_batch_epoch(self, epoch):
+        """
+        Check if the controller can take a batch of a chunked setup, the
+        controller is initialized from the first batch on
+        returns:    status code if epoch is invalid
+                    None if the batch can be applied
+        """
         if epoch != global_epoch:
             self.logger.warning(
                 "Received SetupFlowsRequest has outdated epoch - %d, current "
@@ -140,10 +157,6 @@ class MagmaController(app_manager.RyuApp):
             self.logger.warning("Datapath not initilized, setup failed")
             return SetupFlowsResult.FAILURE
 
-        if self.init_finished:
-            self.logger.warning('Controller already initialized, ignoring')
-            return SetupFlowsResult.SUCCESS
-
         return None
 
     def is_controller_ready(self):
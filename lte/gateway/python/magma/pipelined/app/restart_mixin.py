@@ -29,6 +29,9 @@ class RestartMixin(metaclass=ABCMeta):
     Mixin class for controller restart handling
     """
 
+    # Startup flows not matched yet by the restart sync in progress
+    _restart_flows_map = None
+
     def handle_restart(self, requests) -> SetupFlowsResult:
         """
         Sets up the controller after the restart
@@ -36,14 +39,22 @@ class RestartMixin(metaclass=ABCMeta):
          - Remove stale flows (not default and not in passed requsts)
          requests argument is controller specific
         """
+        res = self.start_restart_sync()
+        if res.result != SetupFlowsResult.SUCCESS:
+            return res
+        return self.handle_restart_batch(requests, last=True)
+
+    def start_restart_sync(self) -> SetupFlowsResult:
+        """
+        Starts a restart sync done in batches: adds the default/missing
+        default flows and takes the startup flows the batches are matched
+        against
+        """
         if not self._datapath:
             self.logger.error('Controller restart not ready, datapath is None')
             return SetupFlowsResult(result=SetupFlowsResult.FAILURE)
         dp = self._datapath
 
-        if requests is None:
-            requests = []
-
         if self._clean_restart:
             self.delete_all_flows(dp)
             self.cleanup_state()
@@ -79,29 +90,36 @@ class RestartMixin(metaclass=ABCMeta):
             )
 
         default_msgs = self._get_default_flow_msgs(dp)
-        for table, msgs_to_install in default_msgs.items():
-            msgs, remaining_flows = self._msg_hub \
-                .filter_msgs_if_not_in_flow_list(
-                    dp, msgs_to_install,
-                    startup_flows_map[table],
-                )
-            if msgs:
-                chan = self._msg_hub.send(msgs, dp)
-                self._wait_for_responses(chan, len(msgs))
-            startup_flows_map[table] = remaining_flows
+        self._install_missing_flows(default_msgs, startup_flows_map)
+
+        self._restart_flows_map = startup_flows_map
+        self._restart_deferred_requests = []
+        return SetupFlowsResult(result=SetupFlowsResult.SUCCESS)
+
+    def handle_restart_batch(self, requests, last) -> SetupFlowsResult:
+        """
+        Adds the missing flows of a batch of the restart sync. The controller
+        serves requests from the first batch on, the stale flows are removed
+        with the last one.
+        """
+        if self._restart_flows_map is None:
+            self.logger.error('Restart batch received before restart sync')
+            return SetupFlowsResult(result=SetupFlowsResult.FAILURE)
+
+        if requests is None:
+            requests = []
 
         ue_msgs = self._get_ue_specific_flow_msgs(requests)
-        for table, msgs_to_install in ue_msgs.items():
-            msgs, remaining_flows = self._msg_hub \
-                .filter_msgs_if_not_in_flow_list(
-                    dp, msgs_to_install,
-                    startup_flows_map[table],
-                )
-            if msgs:
-                chan = self._msg_hub.send(msgs, dp)
-                self._wait_for_responses(chan, len(msgs))
-            startup_flows_map[table] = remaining_flows
+        self._install_missing_flows(ue_msgs, self._restart_flows_map)
+
+        if not last:
+            # Redirection flows are reinserted once stale flows are removed
+            self._restart_deferred_requests.extend(requests)
+            self.finish_init([])
+            self.init_finished = True
+            return SetupFlowsResult(result=SetupFlowsResult.SUCCESS)
 
+        startup_flows_map = self._restart_flows_map
         for tbl in startup_flows_map:
             self.logger.debug(
                 'Startup flows to be deleted: tbl %d -> %s',
@@ -110,11 +128,27 @@ class RestartMixin(metaclass=ABCMeta):
             )
         self._remove_extra_flows(startup_flows_map)
 
+        requests = self._restart_deferred_requests + list(requests)
+        self._restart_flows_map = None
+        self._restart_deferred_requests = []
         self.finish_init(requests)
         self.init_finished = True
 
         return SetupFlowsResult(result=SetupFlowsResult.SUCCESS)
 
+    def _install_missing_flows(self, msgs_by_table, startup_flows_map):
+        dp = self._datapath
+        for table, msgs_to_install in msgs_by_table.items():
+            msgs, remaining_flows = self._msg_hub \
+                .filter_msgs_if_not_in_flow_list(
+                    dp, msgs_to_install,
+                    startup_flows_map[table],
+                )
+            if msgs:
+                chan = self._msg_hub.send(msgs, dp)
+                self._wait_for_responses(chan, len(msgs))
+            startup_flows_map[table] = remaining_flows
+
     def _remove_extra_flows(self, extra_flows):
         msg_list = []
         for tbl in extra_flows:
@@ -18,6 +18,13 @@
 #include <linux/if_ether.h>
 #include <uapi/linux/ipv6.h>
 
+// Per packet tracing is only compiled in with -DEBPF_DEBUG.
+#ifdef EBPF_DEBUG
+#define DP_DEBUG(fmt, ...) bpf_trace_printk(fmt, ##__VA_ARGS__)
+#else
+#define DP_DEBUG(fmt, ...)
+#endif
+
 // UE sessions map definitions.
 struct dl_map_key {
   u32 ue_ip;
@@ -26,7 +33,6 @@ struct dl_map_key {
 struct dl_map_info {
   u32 remote_ipv4;
   u32 tunnel_id;
-  u64 bytes;
   u8 user_data[64];
 };
 
@@ -43,6 +49,17 @@ struct cfg_array_info {
 BPF_TABLE_PINNED(
     "array", u32, struct cfg_array_info, cfg_array, 1, "/sys/fs/bpf/cfg_array");
 
+// Per UE counters. The map is per CPU so the handler updates it without
+// atomics, readers sum the values of all CPUs.
+struct dp_stats {
+  u64 packets;
+  u64 bytes;
+};
+
+BPF_TABLE_PINNED(
+    "percpu_hash", struct dl_map_key, struct dp_stats, dl_stats_map,
+    1024 * 512, "/sys/fs/bpf/dl_stats_map");
+
 // Ingress handler for Uplink traffic.
 int gtpu_egress_handler(struct __sk_buff* skb) {
   int ret;
@@ -58,8 +75,11 @@ int gtpu_egress_handler(struct __sk_buff* skb) {
   int len  = data_end - data;
 
   if ((data + ip_hdr) > data_end) {
-    bpf_trace_printk(
-        "ERR: truncated packet: len: %d, data sz %d\n", skb->len, len);
+    DP_DEBUG("ERR: truncated packet: len: %d, data sz %d\n", skb->len, len);
+    return TC_ACT_OK;
+  }
+  struct ethhdr* eth = data;
+  if (eth->h_proto != htons(ETH_P_IP)) {
     return TC_ACT_OK;
   }
 
@@ -68,7 +88,7 @@ int gtpu_egress_handler(struct __sk_buff* skb) {
   struct dl_map_key lookup_key = {iph->daddr};
   struct dl_map_info* fwd      = dl_map.lookup(&lookup_key);
   if (!fwd) {
-    bpf_trace_printk("ERR: UE for IP %x not found\n", iph->daddr);
+    DP_DEBUG("ERR: UE for IP %x not found\n", iph->daddr);
     return TC_ACT_OK;
   }
 
@@ -81,20 +101,24 @@ int gtpu_egress_handler(struct __sk_buff* skb) {
 
   ret = bpf_skb_set_tunnel_key(skb, &tun_info, sizeof(tun_info), BPF_F_ZERO_CSUM_TX);
   if (ret < 0) {
-      bpf_trace_printk("ERR: bpf_skb_set_tunnel_key failed with %d", ret);
-      return TC_ACT_SHOT;
+    DP_DEBUG("ERR: bpf_skb_set_tunnel_key failed with %d", ret);
+    return TC_ACT_SHOT;
   }
-  bpf_trace_printk("INFO: set: key %d remote ip 0x%x ret = %d\n", tun_info.tunnel_id, tun_info.remote_ipv4, ret);
 
   u32  cfg_key   = 0;
   struct cfg_array_info* cfg = cfg_array.lookup(&cfg_key);
   if (!cfg) {
-    bpf_trace_printk("ERR: Config array lookup failed\n");
+    DP_DEBUG("ERR: Config array lookup failed\n");
     return TC_ACT_OK;
   }
 
-  // TODO: Add lock for accessing bytes
-  fwd->bytes += skb->len;
+  // 3. account the packet before encapsulation
+  struct dp_stats zero   = {};
+  struct dp_stats* stats = dl_stats_map.lookup_or_try_init(&lookup_key, &zero);
+  if (stats) {
+    stats->packets++;
+    stats->bytes += skb->len;
+  }
 
   return bpf_redirect(cfg->if_idx, 0);
 }
@@ -37,8 +37,12 @@ BASE_MAP_FS = "/sys/fs/bpf/"
 BPF_UL_FILE = "/var/opt/magma/ebpf/ebpf_ul_handler.c"
 BPF_DL_FILE = "/var/opt/magma/ebpf/ebpf_dl_handler.c"
 UL_MAP_NAME = "ul_map"
+UL_TUNNEL_MAP_NAME = "ul_tunnel_map"
 DL_MAP_NAME = "dl_map"
 DL_CFG_ARRAY_NAME = "cfg_array"
+UL_CFG_ARRAY_NAME = "ul_cfg_array"
+UL_STATS_MAP_NAME = "ul_stats_map"
+DL_STATS_MAP_NAME = "dl_stats_map"
 
 """
     Use pipelineD configuration to initialize eBPF manager for AGW.
@@ -59,7 +63,11 @@ def get_ebpf_manager(config):
         if gw.ip.version != IPAddress.IPV4:
             continue
         if gw.vlan in {"NO_VLAN", ""}:
-            bpf_man = ebpf_manager(config['nat_iface'], config['enodeb_iface'], gw.ip)
+            bpf_man = ebpf_manager(
+                config['nat_iface'], config['enodeb_iface'], gw.ip,
+                xdp_ul=config['ebpf'].get('xdp_ul', False),
+                debug=config['ebpf'].get('debug', False),
+            )
             # TODO: For Development purpose dettch and attach latest eBPF code.
             # Remove this for production deployment
             bpf_man.detach_ul_ebpf()
@@ -83,15 +91,26 @@ def get_ebpf_manager(config):
 
 
 class ebpf_manager:
-    def __init__(self, sgi_if_name: str, s1_if_name: str, gw_ip: IPAddress, bpf_ul_file: str = BPF_UL_FILE, bpf_dl_file: str = BPF_DL_FILE):
+    def __init__(
+        self, sgi_if_name: str, s1_if_name: str, gw_ip: IPAddress, bpf_ul_file: str = BPF_UL_FILE, bpf_dl_file: str = BPF_DL_FILE,
+        xdp_ul: bool = False, debug: bool = False,
+    ):
         self.enabled = True
-        self.b_ul = BPF(src_file=bpf_ul_file, cflags=[''])
-        self.b_dl = BPF(src_file=bpf_dl_file, cflags=[''])
+        cflags = ['-DEBPF_DEBUG'] if debug else ['']
+        self.b_ul = BPF(src_file=bpf_ul_file, cflags=cflags)
+        self.b_dl = BPF(src_file=bpf_dl_file, cflags=cflags)
         self.s1_fn = self.b_ul.load_func("gtpu_ingress_handler", BPF.SCHED_CLS)
+        self.s1_xdp_fn = None
+        if xdp_ul:
+            self.s1_xdp_fn = self.b_ul.load_func("gtpu_xdp_ul_handler", BPF.XDP)
         self.sgi_fn = self.b_dl.load_func("gtpu_egress_handler", BPF.SCHED_CLS)
         self.ul_map = self.b_ul.get_table(UL_MAP_NAME)
+        self.ul_tunnel_map = self.b_ul.get_table(UL_TUNNEL_MAP_NAME)
+        self.ul_cfg_array = self.b_ul.get_table(UL_CFG_ARRAY_NAME)
+        self.ul_stats_map = self.b_ul.get_table(UL_STATS_MAP_NAME)
         self.dl_map = self.b_dl.get_table(DL_MAP_NAME)
         self.cfg_array = self.b_dl.get_table(DL_CFG_ARRAY_NAME)
+        self.dl_stats_map = self.b_dl.get_table(DL_STATS_MAP_NAME)
         self.sgi_if_name = sgi_if_name
         self.s1_if_name = s1_if_name
         self.ul_src_mac = self._get_mac_address(sgi_if_name)
@@ -120,6 +139,16 @@ class ebpf_manager:
         except NetlinkError as ex:
             LOG.error("error adding ingress ")
 
+        key = self.ul_cfg_array.Key(0)
+        self.ul_cfg_array[key] = self.ul_cfg_array.Leaf(
+            self.sgi_if_index, self.ul_src_mac, self.ul_gw_mac,
+        )
+
+        if self.s1_xdp_fn:
+            # Unmarked sessions are decapsulated in XDP, everything the XDP
+            # handler passes still goes through the TC handler above.
+            self.b_ul.attach_xdp(self.s1_if_name, self.s1_xdp_fn, 0)
+
         LOG.debug("Attach done")
 
     def attach_dl_ebpf(self):
@@ -165,9 +194,15 @@ class ebpf_manager:
             ipr.tc("del", "ingress", s1_if_index, "ffff:")
         except NetlinkError as ex:
             pass
-        sys_file = BASE_MAP_FS + UL_MAP_NAME
-        out1 = subprocess.run(["unlink", sys_file], capture_output=True)
-        LOG.debug(out1)
+        if self.s1_xdp_fn:
+            BPF.remove_xdp(self.s1_if_name, 0)
+        for map_name in (
+            UL_MAP_NAME, UL_TUNNEL_MAP_NAME, UL_CFG_ARRAY_NAME,
+            UL_STATS_MAP_NAME,
+        ):
+            sys_file = BASE_MAP_FS + map_name
+            out1 = subprocess.run(["unlink", sys_file], capture_output=True)
+            LOG.debug(out1)
 
     def detach_dl_ebpf(self):
         """
@@ -186,6 +221,9 @@ class ebpf_manager:
         sys_file = BASE_MAP_FS + DL_CFG_ARRAY_NAME
         out1 = subprocess.run(["unlink", sys_file], capture_output=True)
         LOG.debug(out1)
+        sys_file = BASE_MAP_FS + DL_STATS_MAP_NAME
+        out1 = subprocess.run(["unlink", sys_file], capture_output=True)
+        LOG.debug(out1)
 
     """Add uplink session entry
     """
@@ -193,17 +231,30 @@ class ebpf_manager:
     def add_ul_entry(self, mark: int, ue_ip: str):
         if not self.enabled:
             return
-        sz = len(self.ul_map)
         ip_addr = self._pack_ip(ue_ip)
-        LOG.debug(
-            "Add entry: ip: %x mac src %s mac dst: %s" %
-            (ip_addr, self._unpack_mac_addr(self.ul_src_mac), self._unpack_mac_addr(self.ul_gw_mac)),
-        )
+        LOG.debug("Add entry: ip: %x mark %d" % (ip_addr, mark))
 
+        # The tunnel is programmed by the SGW in ul_tunnel_map
         key = self.ul_map.Key(ip_addr)
-        val = self.ul_map.Leaf(mark, self.sgi_if_index, self.ul_src_mac, self.ul_gw_mac, 0)
+        val = self.ul_map.Leaf(mark)
         self.ul_map[key] = val
 
+    def add_ul_tunnel(self, ue_ip: str, tunnel_id: int):
+        """
+        Set the uplink tunnel of a UE, as the SGW does on tunnel add
+        """
+        if not self.enabled:
+            return
+        key = self.ul_tunnel_map.Key(self._pack_ip(ue_ip))
+        self.ul_tunnel_map[key] = self.ul_tunnel_map.Leaf(tunnel_id)
+
+    def del_ul_tunnel(self, ue_ip: str):
+        """
+        Remove the uplink tunnel of a UE, as the SGW does on tunnel delete
+        """
+        key = self.ul_tunnel_map.Key(self._pack_ip(ue_ip))
+        self.ul_tunnel_map.pop(key, None)
+
     def add_dl_entry(self, ue_ip: str, remote_ipv4: str, tunnel_id: int, imsi: str):
         """
         Add downlink session entry
@@ -225,7 +276,6 @@ class ebpf_manager:
         val = self.dl_map.Leaf(
             self._pack_ip(remote_ipv4),
             socket.htonl(tunnel_id),
-            0,
             imsi_arr,
         )
         self.dl_map[key] = val
@@ -238,6 +288,7 @@ class ebpf_manager:
         key = self.ul_map.Key(ip_addr)
 
         self.ul_map.pop(key, None)
+        self.ul_stats_map.pop(self.ul_stats_map.Key(ip_addr), None)
 
     def del_dl_entry(self, ue_ip: str):
         """
@@ -247,23 +298,44 @@ class ebpf_manager:
         key = self.dl_map.Key(ip_addr)
 
         self.dl_map.pop(key, None)
+        self.dl_stats_map.pop(self.dl_stats_map.Key(ip_addr), None)
+
+    def get_ul_stats(self):
+        """
+        Uplink packets and bytes per UE IP, summed over all CPUs
+        """
+        return self._get_stats(self.ul_stats_map)
+
+    def get_dl_stats(self):
+        """
+        Downlink packets and bytes per UE IP, summed over all CPUs
+        """
+        return self._get_stats(self.dl_stats_map)
 
     """Dump entire ulink session eBPF map
     """
 
     def print_ul_map(self):
 
+        for _, cfg in self.ul_cfg_array.items():
+            egress_dev_index = cfg.e_if_index
+            egress_dev_name = self._get_if_name(egress_dev_index)
+            dst_mac = self._unpack_mac_addr(cfg.mac_dst)
+            src_mac = self._unpack_mac_addr(cfg.mac_src)
+            print(
+                "UL egress: dev: %s (%d), src_mac %s dst_mac %s" %
+                (egress_dev_name, egress_dev_index, src_mac, dst_mac),
+            )
+
+        ul_stats = self.get_ul_stats()
+        tunnels = {k.ue_ip: v.tei for k, v in self.ul_tunnel_map.items()}
         for k, v in self.ul_map.items():
             ue_ip = self._unpack_ip(k.ue_ip)
-            mark = v.mark
-            egress_dev_index = v.e_if_index
-            egress_dev_name = self._get_if_name(egress_dev_index)
-            dst_mac = self._unpack_mac_addr(v.mac_dst)
-            src_mac = self._unpack_mac_addr(v.mac_src)
+            packets, bytes = ul_stats.get(ue_ip, (0, 0))
 
             print(
-                "UE: %s -> {mark: %d, dev: %s (%d), src_mac %s dst_mac %s" %
-                (ue_ip, mark, egress_dev_name, egress_dev_index, src_mac, dst_mac),
+                "UE: %s -> {mark: %d, tei: %s, packets: %d, bytes: %d}" %
+                (ue_ip, v.mark, tunnels.get(k.ue_ip), packets, bytes),
             )
 
     def print_dl_map(self):
@@ -271,16 +343,17 @@ class ebpf_manager:
         Dump entire downlink session eBPF map
         """
         print("DL MAP:")
+        dl_stats = self.get_dl_stats()
         for k, v in self.dl_map.items():
             ue_ip = self._unpack_ip(k.ue_ip)
             remote_ipv4 = self._unpack_ip(v.remote_ipv4)
             tunnel_id = socket.ntohl(v.tunnel_id)
             imsi = self._unpack_imsi(v.user_data)
-            bytes = v.bytes
+            packets, bytes = dl_stats.get(ue_ip, (0, 0))
 
             print(
-                "UE: %s -> {imsi %s, remote_ipv4: %s, tunnel_id: %d, bytes: %d}" %
-                (ue_ip, imsi, remote_ipv4, tunnel_id, bytes),
+                "UE: %s -> {imsi %s, remote_ipv4: %s, tunnel_id: %d, packets: %d, bytes: %d}" %
+                (ue_ip, imsi, remote_ipv4, tunnel_id, packets, bytes),
             )
 
     def print_dl_cfg(self):
@@ -296,6 +369,15 @@ class ebpf_manager:
                 (ifindex),
             )
 
+    def _get_stats(self, stats_map):
+        stats = {}
+        for k, per_cpu in stats_map.items():
+            stats[self._unpack_ip(k.ue_ip)] = (
+                sum(v.packets for v in per_cpu),
+                sum(v.bytes for v in per_cpu),
+            )
+        return stats
+
     def _get_ifindex(self, if_name: str):
         sys_file = "/sys/class/net/" + if_name + "/ifindex"
         ifindex = subprocess.run(["cat", sys_file], capture_output=True)
@@ -9,6 +9,7 @@
 #include <bcc/proto.h>
 #include <linux/if_ether.h>
 #include <linux/if_packet.h>
+#include <linux/in.h>
 #include <linux/ip.h>
 #include <linux/types.h>
 #include <linux/socket.h>
@@ -16,6 +17,13 @@
 #include <linux/erspan.h>
 #include <linux/udp.h>
 
+// Per packet tracing is only compiled in with -DEBPF_DEBUG.
+#ifdef EBPF_DEBUG
+#define DP_DEBUG(fmt, ...) bpf_trace_printk(fmt, ##__VA_ARGS__)
+#else
+#define DP_DEBUG(fmt, ...)
+#endif
+
 // GTP protocol definitions
 // TODO: Move this into header file
 struct gtp1_header { /* According to 3GPP TS 29.060. */
@@ -27,103 +35,213 @@ struct gtp1_header { /* According to 3GPP TS 29.060. */
 
 static const int GTP_PORT_NO  = 2152;
 static const int gtp_hdr_size = 8;
+// Version 1, PT set, no E, S or PN bit: the header is exactly gtp_hdr_size.
+static const int GTP_FLAGS_NO_OPT = 0x30;
+static const int GTP_TYPE_GPDU    = 0xff;
 
 // UE sessions map definitions.
 struct ul_map_key {
   u32 ue_ip;
 };
 
+// Each UE session is programmed by two writers, each owning its own map so
+// that neither has to read-modify-write the other's state: pipelined adds
+// the ul_map entry with the QoS mark for an enforcement rule the datapath
+// can handle, the SGW adds the ul_tunnel_map entry when it adds the tunnel.
+// Packets are only forwarded once both entries are present.
 struct ul_map_info {
   u32 mark;
+};
+
+struct ul_tunnel_info {
+  u32 tei;
+};
+
+// The maps are pinned so that they can be accessed by pipelined, the SGW or
+// debugging tools to examine datapath state.
+BPF_TABLE_PINNED(
+    "hash", struct ul_map_key, struct ul_map_info, ul_map, 1024 * 512,
+    "/sys/fs/bpf/ul_map");
+
+BPF_TABLE_PINNED(
+    "hash", struct ul_map_key, struct ul_tunnel_info, ul_tunnel_map,
+    1024 * 512, "/sys/fs/bpf/ul_tunnel_map");
+
+// Egress interface of the uplink, set by pipelined on attach.
+struct ul_cfg_info {
   u32 e_if_index;
   u8 mac_src[ETH_ALEN];
   u8 mac_dst[ETH_ALEN];
-  u64 bytes;
 };
 
-// The map is pinned so that it can be accessed by pipelined or debugging tool
-// to examine datapath state.
 BPF_TABLE_PINNED(
-    "hash", struct ul_map_key, struct ul_map_info, ul_map, 1024 * 512,
-    "/sys/fs/bpf/ul_map");
+    "array", u32, struct ul_cfg_info, ul_cfg_array, 1,
+    "/sys/fs/bpf/ul_cfg_array");
 
-// Ingress handler for Uplink traffic.
-int gtpu_ingress_handler(struct __sk_buff* skb) {
-  int ret;
-  struct iphdr* iph;
-  void* data;
-  void* data_end;
+// Per UE counters. The map is per CPU so the handlers update it without
+// atomics, readers sum the values of all CPUs.
+struct dp_stats {
+  u64 packets;
+  u64 bytes;
+};
 
+BPF_TABLE_PINNED(
+    "percpu_hash", struct ul_map_key, struct dp_stats, ul_stats_map,
+    1024 * 512, "/sys/fs/bpf/ul_stats_map");
+
+static inline void count_packet(struct ul_map_key* key, u32 len) {
+  struct dp_stats zero = {};
+  struct dp_stats* stats = ul_stats_map.lookup_or_try_init(key, &zero);
+  if (stats) {
+    stats->packets++;
+    stats->bytes += len;
+  }
+}
+
+// Returns the inner IP header of a G-PDU for an uplink UE session, NULL if
+// the packet has to take the slow path.
+static inline struct iphdr* parse_gpdu(
+    void* data, void* data_end, struct gtp1_header** gtp1) {
   int gtp_offset =
       sizeof(struct ethhdr) + sizeof(struct iphdr) + sizeof(struct udphdr);
-  int inner_ip_hdr = sizeof(struct ethhdr) + sizeof(struct iphdr) +
-                     sizeof(struct udphdr) + gtp_hdr_size +
-                     sizeof(struct iphdr);
-  // 1. a. check GTP HDR
-  data     = (void*) (long) skb->data;
-  data_end = (void*) (long) skb->data_end;
-  int len  = data_end - data;
+  int inner_ip_hdr = gtp_offset + gtp_hdr_size + sizeof(struct iphdr);
 
   if ((data + inner_ip_hdr) > data_end) {
-    bpf_trace_printk(
-        "ERR: truncated packet: len: %d, data sz %d\n", skb->len, len);
-    return TC_ACT_OK;
+    return NULL;
+  }
+  struct ethhdr* eth = data;
+  if (eth->h_proto != htons(ETH_P_IP)) {
+    return NULL;
+  }
+  struct iphdr* iph = data + sizeof(struct ethhdr);
+  if (iph->ihl != 5 || iph->protocol != IPPROTO_UDP) {
+    return NULL;
   }
-  struct gtp1_header* gtp1 = (struct gtp1_header*) (data + gtp_offset);
-  int tid                  = ntohl(gtp1->tid);
-
   struct udphdr* uh = data + sizeof(struct ethhdr) + sizeof(struct iphdr);
   if (uh->dest != htons(GTP_PORT_NO)) {
     // not GTP packet, let it continue.
-    bpf_trace_printk("ERR: Not GTP packet: %d\n", ntohs(uh->dest));
+    return NULL;
+  }
+  *gtp1 = (struct gtp1_header*) (data + gtp_offset);
+  if ((*gtp1)->flags != GTP_FLAGS_NO_OPT || (*gtp1)->type != GTP_TYPE_GPDU) {
+    // Signalling, end markers and optional fields are left to OVS.
+    return NULL;
+  }
+  return data + gtp_offset + gtp_hdr_size;
+}
+
+static inline struct ul_map_info* lookup_session(
+    struct iphdr* inner_iph, struct gtp1_header* gtp1,
+    struct ul_map_key* key) {
+  key->ue_ip              = inner_iph->saddr;
+  struct ul_map_info* fwd = ul_map.lookup(key);
+  if (!fwd) {
+    DP_DEBUG("ERR: UE for IP %x not found\n", inner_iph->saddr);
+    return NULL;
+  }
+  struct ul_tunnel_info* tunnel = ul_tunnel_map.lookup(key);
+  if (!tunnel || tunnel->tei != ntohl(gtp1->tid)) {
+    DP_DEBUG("ERR: UE %x no tunnel for tei %d\n", key->ue_ip, ntohl(gtp1->tid));
+    return NULL;
+  }
+  return fwd;
+}
+
+// Ingress handler for Uplink traffic.
+int gtpu_ingress_handler(struct __sk_buff* skb) {
+  int ret;
+  void* data;
+  void* data_end;
+  struct gtp1_header* gtp1;
+  struct ul_map_key key;
+
+  // 1. check GTP HDR and UE map
+  data                    = (void*) (long) skb->data;
+  data_end                = (void*) (long) skb->data_end;
+  struct iphdr* inner_iph = parse_gpdu(data, data_end, &gtp1);
+  if (!inner_iph) {
     return TC_ACT_OK;
   }
-  // 1. b. check UE map
-  iph                     = data + gtp_offset + gtp_hdr_size;
-  struct ul_map_key key   = {iph->saddr};
-  struct ul_map_info* fwd = ul_map.lookup(&key);
+  struct ul_map_info* fwd = lookup_session(inner_iph, gtp1, &key);
   if (!fwd) {
-    bpf_trace_printk("ERR: UE for IP %x not found\n", iph->saddr);
     // No UE entry.
     return TC_ACT_OK;
   }
+  u32 cfg_key            = 0;
+  struct ul_cfg_info* cfg = ul_cfg_array.lookup(&cfg_key);
+  if (!cfg || !cfg->e_if_index) {
+    return TC_ACT_OK;
+  }
 
   // 2. process inner packet.
-  iph          = NULL;
   int rem_hdrs = sizeof(struct iphdr) + sizeof(struct udphdr) + gtp_hdr_size;
   ret          = bpf_skb_adjust_room(skb, -rem_hdrs, BPF_ADJ_ROOM_MAC, 0);
   if (ret) {
-    bpf_trace_printk(
-        "ERR: get: error adjust %d proto: %x, offset %d\n", ret, skb->protocol,
-        skb->len);
+    DP_DEBUG("ERR: adjust %d proto: %x\n", ret, skb->protocol);
     return TC_ACT_OK;
   }
   data     = (void*) (long) skb->data;
   data_end = (void*) (long) skb->data_end;
-  len      = data_end - data;
 
   if ((data + sizeof(struct ethhdr)) > data_end) {
-    bpf_trace_printk(
-        "ERR: truncated inner packet: len: %d, data sz %d\n", skb->len, len);
-    return TC_ACT_OK;
+    return TC_ACT_SHOT;
   }
 
   struct ethhdr* eth = data;
 
   // 2.1. Update dest mac
-  __builtin_memcpy(eth->h_dest, fwd->mac_dst, ETH_ALEN);
+  __builtin_memcpy(eth->h_dest, cfg->mac_dst, ETH_ALEN);
   // 2.2. Update src  mac
-  __builtin_memcpy(eth->h_source, fwd->mac_src, ETH_ALEN);
+  __builtin_memcpy(eth->h_source, cfg->mac_src, ETH_ALEN);
 
   // 2.3 skb mark for qos
   skb->mark = fwd->mark;
 
-  // 2.4 increment bytes
-  // TODO: Add lock for accessing bytes
-  fwd->bytes += len;
+  // 2.4 account the decapsulated packet
+  count_packet(&key, skb->len);
+
+  return bpf_redirect(cfg->e_if_index, 0);
+}
+
+// XDP variant of the uplink handler. XDP cannot set the skb mark used for
+// QoS, sessions with a mark are passed on to gtpu_ingress_handler.
+int gtpu_xdp_ul_handler(struct xdp_md* ctx) {
+  void* data     = (void*) (long) ctx->data;
+  void* data_end = (void*) (long) ctx->data_end;
+  struct gtp1_header* gtp1;
+  struct ul_map_key key;
+
+  struct iphdr* inner_iph = parse_gpdu(data, data_end, &gtp1);
+  if (!inner_iph) {
+    return XDP_PASS;
+  }
+  struct ul_map_info* fwd = lookup_session(inner_iph, gtp1, &key);
+  if (!fwd || fwd->mark) {
+    return XDP_PASS;
+  }
+  u32 cfg_key            = 0;
+  struct ul_cfg_info* cfg = ul_cfg_array.lookup(&cfg_key);
+  if (!cfg || !cfg->e_if_index) {
+    return XDP_PASS;
+  }
+
+  // Drop outer IP, UDP and GTP headers and write a new ethernet header
+  // in front of the inner packet.
+  int rem_hdrs = sizeof(struct iphdr) + sizeof(struct udphdr) + gtp_hdr_size;
+  if (bpf_xdp_adjust_head(ctx, rem_hdrs)) {
+    return XDP_PASS;
+  }
+  data     = (void*) (long) ctx->data;
+  data_end = (void*) (long) ctx->data_end;
+  if ((data + sizeof(struct ethhdr)) > data_end) {
+    return XDP_DROP;
+  }
+  struct ethhdr* eth = data;
+  __builtin_memcpy(eth->h_dest, cfg->mac_dst, ETH_ALEN);
+  __builtin_memcpy(eth->h_source, cfg->mac_src, ETH_ALEN);
+  eth->h_proto = htons(ETH_P_IP);
+
+  count_packet(&key, data_end - data);
 
-  bpf_trace_printk(
-      "INFO: UL-fwd: tid %d egress: %d mark: %d\n", tid, fwd->e_if_index,
-      fwd->mark);
-  return bpf_redirect(fwd->e_if_index, 0);
+  return bpf_redirect(cfg->e_if_index, 0);
 }
@@ -0,0 +1,128 @@
+"""
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+from typing import Callable, Dict, List, Optional, Tuple
+
+from lte.protos.session_manager_pb2 import (
+    UPFSessionDigestReport,
+    UPFSessionDigestResult,
+    UPFSessionRangeDigest,
+    UPFSessionState,
+)
+
+# Must match UpfSessionDigest::BUCKET_COUNT in sessiond
+SESSION_DIGEST_BUCKETS = 4096
+# Mismatching ranges are split into that many ranges for the next round,
+# the first round covers all the buckets the same way
+SESSION_DIGEST_FANOUT = 16
+# A mismatching range with at most that many sessions on either side is
+# listed instead of being split further
+SESSION_LIST_THRESHOLD = 64
+
+_MASK64 = (1 << 64) - 1
+
+BucketRange = Tuple[int, int]
+
+
+def session_hash(local_f_teid: int, version: int) -> int:
+    """
+    SplitMix64 hash of a session, the same sessiond computes
+    """
+    z = (((local_f_teid << 32) | version) + 0x9e3779b97f4a7c15) & _MASK64
+    z = ((z ^ (z >> 30)) * 0xbf58476d1ce4e5b9) & _MASK64
+    z = ((z ^ (z >> 27)) * 0x94d049bb133111eb) & _MASK64
+    return z ^ (z >> 31)
+
+
+def _split(bucket_range: BucketRange) -> List[BucketRange]:
+    start, end = bucket_range
+    step = max(1, -(-(end - start) // SESSION_DIGEST_FANOUT))
+    return [(s, min(s + step, end)) for s in range(start, end, step)]
+
+
+class SessionDigest:
+    """
+    Per bucket digests of the sessions the UPF holds, keyed by local TEID
+    """
+
+    def __init__(self, sessions: Dict[int, UPFSessionState]):
+        self._counts = [0] * SESSION_DIGEST_BUCKETS
+        self._digests = [0] * SESSION_DIGEST_BUCKETS
+        self._sessions = [[] for _ in range(SESSION_DIGEST_BUCKETS)]
+        for session in sessions.values():
+            bucket = session.local_f_teid % SESSION_DIGEST_BUCKETS
+            self._counts[bucket] += 1
+            self._digests[bucket] ^= session_hash(
+                session.local_f_teid, session.session_version,
+            )
+            self._sessions[bucket].append(session)
+
+    def range_digest(self, bucket_range: BucketRange) -> UPFSessionRangeDigest:
+        start, end = bucket_range
+        digest = 0
+        for bucket in range(start, end):
+            digest ^= self._digests[bucket]
+        return UPFSessionRangeDigest(
+            bucket_start=start,
+            bucket_end=end,
+            session_count=sum(self._counts[start:end]),
+            digest=digest,
+        )
+
+    def sessions(self, bucket_range: BucketRange) -> List[UPFSessionState]:
+        start, end = bucket_range
+        return [s for bucket in self._sessions[start:end] for s in bucket]
+
+
+def reconcile_sessions(
+    sessions: Dict[int, UPFSessionState],
+    send_report: Callable[[UPFSessionDigestReport], Optional[UPFSessionDigestResult]],
+) -> Optional[int]:
+    """
+    Reconcile the UPF sessions with sessiond. Digests of wide ranges are
+    sent first, and only the ranges sessiond reports as mismatching are
+    looked into, until their sessions are listed and sessiond resends the
+    ones that diverged.
+
+    Returns the number of sessions sessiond resent, None if a report failed
+    """
+    digest = SessionDigest(sessions)
+    ranges = _split((0, SESSION_DIGEST_BUCKETS))
+    listed = []
+    resent = 0
+    while ranges or listed:
+        report = UPFSessionDigestReport(
+            bucket_count=SESSION_DIGEST_BUCKETS,
+            range_digests=[digest.range_digest(r) for r in ranges],
+        )
+        for bucket_range in listed:
+            report.listed_ranges.add(
+                bucket_start=bucket_range[0], bucket_end=bucket_range[1],
+            )
+            report.upf_session_state.extend(digest.sessions(bucket_range))
+        result = send_report(report)
+        if result is None:
+            return None
+        resent += result.resent_sessions
+
+        ranges = []
+        listed = []
+        for mismatch in result.mismatching_ranges:
+            bucket_range = (mismatch.bucket_start, mismatch.bucket_end)
+            upf_count = digest.range_digest(bucket_range).session_count
+            if bucket_range[1] - bucket_range[0] == 1 or \
+                    max(upf_count, mismatch.session_count) <= SESSION_LIST_THRESHOLD:
+                listed.append(bucket_range)
+            else:
+                ranges.extend(_split(bucket_range))
+    return resent
@@ -20,14 +20,12 @@ from lte.protos.pipelined_pb2 import (
     PdrState,
     UPFSessionContextState,
 )
-from lte.protos.session_manager_pb2 import (
-    UPFSessionConfigState,
-    UPFSessionState,
-)
+from lte.protos.session_manager_pb2 import UPFSessionState
+from magma.pipelined.ng_manager.session_digest import reconcile_sessions
 from magma.pipelined.ng_manager.session_state_manager_util import (
     pdr_create_rule_entry,
 )
-from magma.pipelined.set_interface_client import send_periodic_session_update
+from magma.pipelined.set_interface_client import send_session_digest_report
 
 # Help to build failure report
 MsgParseOutput = NamedTuple(
@@ -152,10 +150,11 @@ class SessionStateManager:
         if SessionStateManager.send_message_offset % 5:
             return
 
-        session_config_list = []
-        for index in session_config_dict:
-            session_config_list.append(session_config_dict[index])
-
-        session_config_msg = UPFSessionConfigState(upf_session_state=session_config_list)
-        if send_periodic_session_update(session_config_msg, sessiond_stub) == True:
+        # Only the sessions of the ranges whose digests differ from sessiond
+        # are sent
+        resent = reconcile_sessions(
+            session_config_dict,
+            lambda report: send_session_digest_report(report, sessiond_stub),
+        )
+        if resent is not None:
             SessionStateManager.periodic_config_msg_count += 1
@@ -14,6 +14,7 @@ import concurrent.futures
 import logging
 import os
 import queue
+import time
 from collections import OrderedDict
 from concurrent.futures import Future
 from typing import List, Tuple
@@ -76,6 +77,22 @@ from magma.pipelined.policy_converters import (
 
 grpc_msg_queue = queue.Queue()
 DEFAULT_CALL_TIMEOUT = 5
+# Time a batch of a chunked policy setup should take, sessiond is asked for
+# batches of the size processed in that time
+DEFAULT_SETUP_BATCH_TARGET_SECS = 1
+
+
+class PolicySetupSync(object):
+    """
+    Progress of a chunked SetupPolicyFlows sync from sessiond
+    """
+
+    def __init__(self, epoch: int, sync_id: int):
+        self.epoch = epoch
+        self.sync_id = sync_id
+        self.next_batch = 0
+        self.started = False
+        self.complete = False
 
 
 class PipelinedRpcServicer(pipelined_pb2_grpc.PipelinedServicer):
@@ -109,6 +126,11 @@ class PipelinedRpcServicer(pipelined_pb2_grpc.PipelinedServicer):
             'call_timeout',
             DEFAULT_CALL_TIMEOUT,
         )
+        self._setup_batch_target_secs = service_config.get(
+            'setup_batch_target_secs',
+            DEFAULT_SETUP_BATCH_TARGET_SECS,
+        )
+        self._policy_setup_sync = None
         self._print_grpc_payload = os.environ.get('MAGMA_PRINT_GRPC_PAYLOAD')
         if self._print_grpc_payload is None:
             self._print_grpc_payload = \
@@ -163,6 +185,9 @@ class PipelinedRpcServicer(pipelined_pb2_grpc.PipelinedServicer):
             context.set_details('Service not enabled!')
             return None
 
+        if request.HasField('batch'):
+            return self._setup_policy_flows_batch(request, context)
+
         for controller in [
             self._gy_app, self._enforcer_app,
             self._enforcement_stats,
@@ -199,6 +224,125 @@ class PipelinedRpcServicer(pipelined_pb2_grpc.PipelinedServicer):
         self._enforcement_stats.handle_restart(gx_reqs)
         fut.set_result(enforcement_res)
 
+    def _setup_policy_flows_batch(self, request, context) -> SetupFlowsResult:
+        for controller in [
+            self._gy_app, self._enforcer_app,
+            self._enforcement_stats,
+        ]:
+            ret = controller.check_setup_batch_epoch(request.epoch)
+            if ret is not None:
+                return SetupFlowsResult(result=ret)
+
+        fut = Future()
+        self._loop.call_soon_threadsafe(self._setup_flows_batch, request, fut)
+        try:
+            return fut.result(timeout=self._call_timeout)
+        except concurrent.futures.TimeoutError:
+            logging.error("SetupPolicyFlows batch processing timed out")
+            context.set_code(grpc.StatusCode.DEADLINE_EXCEEDED)
+            context.set_details('SetupPolicyFlows processing timed out')
+            return SetupFlowsResult(result=SetupFlowsResult.FAILURE)
+
+    def _setup_flows_batch(
+        self, request: SetupPolicyRequest,
+        fut: 'Future[SetupFlowsResult]',
+    ):
+        """
+        Applies the batches of a sync in order. A batch already applied is
+        acknowledged again, sessiond resends the batches it has no answer
+        for.
+        """
+        batch = request.batch
+        sync = self._policy_setup_sync
+        if sync is None or sync.epoch != request.epoch \
+                or sync.sync_id != batch.sync_id:
+            if batch.index != 0:
+                fut.set_result(
+                    SetupFlowsResult(
+                        result=SetupFlowsResult.FAILURE,
+                        next_batch=0,
+                    ),
+                )
+                return
+            new_sync = PolicySetupSync(request.epoch, batch.sync_id)
+            if sync is not None and sync.epoch == request.epoch:
+                # sessiond restarted, the flows it already synced are kept
+                new_sync.started = sync.started
+                new_sync.complete = sync.complete
+            else:
+                # Set up in one shot already
+                new_sync.complete = self._enforcer_app.init_finished
+            sync = self._policy_setup_sync = new_sync
+
+        if sync.complete:
+            logging.info("Policy flows already set up, ignoring batch")
+            fut.set_result(
+                SetupFlowsResult(
+                    result=SetupFlowsResult.SUCCESS,
+                    next_batch=batch.index + 1,
+                ),
+            )
+            return
+        if batch.index != sync.next_batch:
+            # A batch already applied is acknowledged again
+            result = SetupFlowsResult.SUCCESS \
+                if batch.index < sync.next_batch else SetupFlowsResult.FAILURE
+            fut.set_result(
+                SetupFlowsResult(result=result, next_batch=sync.next_batch),
+            )
+            return
+
+        start = time.monotonic()
+        controllers = [
+            self._enforcer_app, self._gy_app, self._enforcement_stats,
+        ]
+        if not sync.started:
+            for controller in controllers:
+                res = controller.start_restart_sync()
+                if res.result != SetupFlowsResult.SUCCESS:
+                    fut.set_result(res)
+                    return
+            sync.started = True
+
+        gx_reqs = [
+            req for req in request.requests
+            if req.request_origin.type == RequestOriginType.GX
+        ]
+        gy_reqs = [
+            req for req in request.requests
+            if req.request_origin.type == RequestOriginType.GY
+        ]
+        for controller, reqs in zip(controllers, [gx_reqs, gy_reqs, gx_reqs]):
+            res = controller.handle_restart_batch(reqs, batch.last)
+            if res.result != SetupFlowsResult.SUCCESS:
+                fut.set_result(res)
+                return
+
+        sync.next_batch += 1
+        sync.complete = batch.last
+        fut.set_result(
+            SetupFlowsResult(
+                result=SetupFlowsResult.SUCCESS,
+                next_batch=sync.next_batch,
+                max_batch_sessions=self._get_max_batch_sessions(
+                    request, time.monotonic() - start,
+                ),
+            ),
+        )
+
+    def _get_max_batch_sessions(self, request, elapsed) -> int:
+        """
+        Number of sessions to ask for in the next batch, for batches to take
+        about setup_batch_target_secs
+        """
+        sessions = len({
+            (req.sid.id, req.ip_addr, req.ipv6_addr)
+            for req in request.requests
+        })
+        if sessions == 0 or elapsed <= 0:
+            return 0
+        return max(1, int(sessions * self._setup_batch_target_secs / elapsed))
+
     def ActivateFlows(self, request, context):
         """
         Activate flows for a subscriber based on the pre-defined rules
@@ -17,7 +17,7 @@ import grpc
 from lte.protos.session_manager_pb2 import (
     UPFNodeState,
     UPFPagingInfo,
-    UPFSessionConfigState,
+    UPFSessionDigestReport,
 )
 from lte.protos.session_manager_pb2_grpc import SetInterfaceForUserPlaneStub
 from magma.common.rpc_utils import indicates_connection_error
@@ -46,24 +46,24 @@ def send_node_state_association_request(
         return False
 
 
-def send_periodic_session_update(
-    upf_session_config_state: UPFSessionConfigState,
+def send_session_digest_report(
+    digest_report: UPFSessionDigestReport,
     setinterface_stub: SetInterfaceForUserPlaneStub,
 ):
     """
-    Make RPC call to send periodic messages to smf about sessions state.
+    Make RPC call to send a round of the periodic session digests to smf.
+    Returns the UPFSessionDigestResult, None on failure.
     """
     try:
-        setinterface_stub.SetUPFSessionsConfig(upf_session_config_state, DEFAULT_GRPC_TIMEOUT)
-        return True
+        return setinterface_stub.ReconcileUPFSessions(digest_report, DEFAULT_GRPC_TIMEOUT)
     except grpc.RpcError as err:
         logging.error(
-            "send_periodic_session_update error[%s] %s",
+            "send_session_digest_report error[%s] %s",
             err.code(),
             err.details(),
             extra=EXCLUDE_FROM_ERROR_MONITORING if indicates_connection_error(err) else None,
         )
-        return False
+        return None
 
 
 def send_paging_intiated_notification(
@@ -135,8 +135,10 @@ class eBpfDatapathDLTest(unittest.TestCase):
         cls.sendPacket(cls.inner_src_ip, cls.inner_dst_ip)
 
         self.assertEqual(cls.count_udp_packet(), 2)
+        self.assertEqual(cls.ebpf_man.get_dl_stats()[cls.inner_dst_ip][0], 2)
 
         cls.ebpf_man.del_dl_entry(cls.inner_dst_ip)
+        self.assertNotIn(cls.inner_dst_ip, cls.ebpf_man.get_dl_stats())
         cls.ebpf_man.print_dl_map()
         cls.sendPacket(cls.inner_src_ip, cls.inner_dst_ip)
         self.assertEqual(cls.count_udp_packet(), 2)
@@ -28,6 +28,8 @@ from scapy.layers.inet import IP, UDP
 GTP_SCRIPT = "/home/vagrant/magma/lte/gateway/python/magma/pipelined/tests/script/gtp-packet.py"
 PY_PATH = "/home/vagrant/build/python/bin/python"
 UL_HANDLER = "/home/vagrant/magma/lte/gateway/python/magma/pipelined/ebpf/ebpf_ul_handler.c"
+# TEID of the packets sent by GTP_SCRIPT
+GTP_SCRIPT_TEID = 104
 
 
 # This test works when ran separately.
@@ -129,14 +131,29 @@ class eBpfDatapathULTest(unittest.TestCase):
 
         cls.ebpf_man.add_ul_entry(100, cls.inner_src_ip)
         cls.sendPacket(cls.gtp_pkt_src, cls.gtp_pkt_dst, cls.inner_src_ip, cls.inner_dst_ip)
+        # Not forwarded until the SGW has programmed the tunnel as well
+        self.assertEqual(cls.count_udp_packet(), 0)
+
+        cls.ebpf_man.add_ul_tunnel(cls.inner_src_ip, GTP_SCRIPT_TEID)
+        cls.sendPacket(cls.gtp_pkt_src, cls.gtp_pkt_dst, cls.inner_src_ip, cls.inner_dst_ip)
 
         self.assertEqual(cls.count_udp_packet(), 1)
         cls.sendPacket(cls.gtp_pkt_src, cls.gtp_pkt_dst, cls.inner_src_ip, cls.inner_dst_ip)
 
         self.assertEqual(cls.count_udp_packet(), 2)
+        self.assertEqual(cls.ebpf_man.get_ul_stats()[cls.inner_src_ip][0], 2)
 
         cls.ebpf_man.del_ul_entry(cls.inner_src_ip)
+        self.assertNotIn(cls.inner_src_ip, cls.ebpf_man.get_ul_stats())
+        cls.sendPacket(cls.gtp_pkt_src, cls.gtp_pkt_dst, cls.inner_src_ip, cls.inner_dst_ip)
+
+        self.assertEqual(cls.count_udp_packet(), 2)
+
+        # Removing the tunnel alone stops forwarding as well
+        cls.ebpf_man.add_ul_entry(100, cls.inner_src_ip)
+        cls.ebpf_man.del_ul_tunnel(cls.inner_src_ip)
         cls.sendPacket(cls.gtp_pkt_src, cls.gtp_pkt_dst, cls.inner_src_ip, cls.inner_dst_ip)
 
         self.assertEqual(cls.count_udp_packet(), 2)
+        cls.ebpf_man.del_ul_entry(cls.inner_src_ip)
         cls.tearDownClassDevices()
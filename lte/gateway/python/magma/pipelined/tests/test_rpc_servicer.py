@@ -21,6 +21,8 @@ from lte.protos.pipelined_pb2 import (
     ActivateFlowsRequest,
     DeactivateFlowsRequest,
     RequestOriginType,
+    SetupBatch,
+    SetupFlowsResult,
     SetupPolicyRequest,
     VersionedPolicy,
     VersionedPolicyID,
@@ -63,7 +65,13 @@ class RPCServicerTest(unittest.TestCase):
             self._enforcement_stats,
         ]:
             controller.check_setup_request_epoch.side_effect = lambda x: None
+            controller.check_setup_batch_epoch.side_effect = lambda x: None
             controller.is_controller_ready = lambda: True
+            controller.init_finished = False
+            controller.start_restart_sync.return_value = \
+                SetupFlowsResult(result=SetupFlowsResult.SUCCESS)
+            controller.handle_restart_batch.return_value = \
+                SetupFlowsResult(result=SetupFlowsResult.SUCCESS)
 
         self.pipelined_srv = PipelinedRpcServicer(
             self._loop,
@@ -96,6 +104,73 @@ class RPCServicerTest(unittest.TestCase):
         self._enforcement_stats.handle_restart.assert_called_with([gx_req1, gx_req2])
         self._gy_app.handle_restart.assert_called_with([gy_req])
 
+    def test_setup_flows_batches(self):
+        gx_req1 = ActivateFlowsRequest(sid=SubscriberID(id="imsi1"))
+        gx_req2 = ActivateFlowsRequest(sid=SubscriberID(id="imsi2"))
+        gy_req = ActivateFlowsRequest(
+            sid=SubscriberID(id="imsi2"),
+            request_origin=RequestOriginType(type=RequestOriginType.GY),
+        )
+        batch0 = SetupPolicyRequest(
+            requests=[gx_req1],
+            batch=SetupBatch(sync_id=1, index=0),
+        )
+        batch1 = SetupPolicyRequest(
+            requests=[gx_req2, gy_req],
+            batch=SetupBatch(sync_id=1, index=1, last=True),
+        )
+
+        res = self.pipelined_srv.SetupPolicyFlows(batch0, MagicMock())
+        self.assertEqual(res.result, SetupFlowsResult.SUCCESS)
+        self.assertEqual(res.next_batch, 1)
+        self._enforcer_app.start_restart_sync.assert_called_once()
+        self._enforcer_app.handle_restart_batch.assert_called_with(
+            [gx_req1], False,
+        )
+        self._gy_app.handle_restart_batch.assert_called_with([], False)
+
+        # Skipping a batch fails, resending an applied one is acknowledged
+        # without applying it again
+        res = self.pipelined_srv.SetupPolicyFlows(
+            SetupPolicyRequest(batch=SetupBatch(sync_id=1, index=2)),
+            MagicMock(),
+        )
+        self.assertEqual(res.result, SetupFlowsResult.FAILURE)
+        self.assertEqual(res.next_batch, 1)
+        res = self.pipelined_srv.SetupPolicyFlows(batch0, MagicMock())
+        self.assertEqual(res.result, SetupFlowsResult.SUCCESS)
+        self.assertEqual(res.next_batch, 1)
+        self.assertEqual(self._enforcer_app.handle_restart_batch.call_count, 1)
+
+        res = self.pipelined_srv.SetupPolicyFlows(batch1, MagicMock())
+        self.assertEqual(res.result, SetupFlowsResult.SUCCESS)
+        self.assertEqual(res.next_batch, 2)
+        self._enforcer_app.start_restart_sync.assert_called_once()
+        self._enforcer_app.handle_restart_batch.assert_called_with(
+            [gx_req2], True,
+        )
+        self._enforcement_stats.handle_restart_batch.assert_called_with(
+            [gx_req2], True,
+        )
+        self._gy_app.handle_restart_batch.assert_called_with([gy_req], True)
+
+    def test_setup_flows_batch_failure(self):
+        self._gy_app.handle_restart_batch.return_value = \
+            SetupFlowsResult(result=SetupFlowsResult.FAILURE)
+        batch0 = SetupPolicyRequest(batch=SetupBatch(sync_id=1, index=0))
+
+        res = self.pipelined_srv.SetupPolicyFlows(batch0, MagicMock())
+        self.assertEqual(res.result, SetupFlowsResult.FAILURE)
+
+        # The batch is applied again when resent, the sync is not restarted
+        self._gy_app.handle_restart_batch.return_value = \
+            SetupFlowsResult(result=SetupFlowsResult.SUCCESS)
+        res = self.pipelined_srv.SetupPolicyFlows(batch0, MagicMock())
+        self.assertEqual(res.result, SetupFlowsResult.SUCCESS)
+        self.assertEqual(res.next_batch, 1)
+        self._enforcer_app.start_restart_sync.assert_called_once()
+        self.assertEqual(self._enforcer_app.handle_restart_batch.call_count, 2)
+
     def test_activate_flows_req(self):
         rule = PolicyRule(id="rule1", priority=100, flow_list=[])
         policies = [VersionedPolicy(rule=rule, version=1)]
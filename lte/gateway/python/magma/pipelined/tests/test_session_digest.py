@@ -0,0 +1,112 @@
+"""
+Copyright 2022 The Magma Authors.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+
+from lte.protos.session_manager_pb2 import (
+    UPFSessionDigestResult,
+    UPFSessionState,
+)
+from magma.pipelined.ng_manager.session_digest import (
+    SESSION_DIGEST_BUCKETS,
+    SessionDigest,
+    reconcile_sessions,
+    session_hash,
+)
+
+
+class FakeSmf:
+    """
+    Answers the digest reports the way sessiond does
+    """
+
+    def __init__(self, versions):
+        self.digest = SessionDigest({
+            teid: UPFSessionState(local_f_teid=teid, session_version=version)
+            for teid, version in versions.items()
+        })
+        self.reports = []
+
+    def __call__(self, report):
+        self.reports.append(report)
+        digest = self.digest
+        result = UPFSessionDigestResult()
+        for upf_range in report.range_digests:
+            smf_range = digest.range_digest(
+                (upf_range.bucket_start, upf_range.bucket_end),
+            )
+            if smf_range.session_count != upf_range.session_count or \
+                    smf_range.digest != upf_range.digest:
+                result.mismatching_ranges.append(smf_range)
+        upf_versions = {
+            s.local_f_teid: s.session_version for s in report.upf_session_state
+        }
+        for listed in report.listed_ranges:
+            for session in digest.sessions((listed.bucket_start, listed.bucket_end)):
+                if upf_versions.get(session.local_f_teid, 0) < session.session_version:
+                    result.resent_sessions += 1
+        return result
+
+
+class SessionDigestTest(unittest.TestCase):
+
+    def _upf_sessions(self, versions):
+        return {
+            teid: UPFSessionState(
+                subscriber_id="IMSI00101%010d" % teid,
+                session_version=version,
+                local_f_teid=teid,
+            )
+            for teid, version in versions.items()
+        }
+
+    def test_hash_matches_sessiond(self):
+        # Values of UpfSessionDigest::hash_session
+        self.assertEqual(session_hash(1, 2), 12929899232056340514)
+        self.assertEqual(
+            session_hash(0xffffffff, 0xffffffff), 16490336266968443936,
+        )
+
+    def test_in_sync_takes_one_round(self):
+        versions = {teid: 2 for teid in range(1, 10001)}
+        smf = FakeSmf(dict(versions))
+        resent = reconcile_sessions(self._upf_sessions(versions), smf)
+        self.assertEqual(resent, 0)
+        self.assertEqual(len(smf.reports), 1)
+        self.assertEqual(len(smf.reports[0].range_digests), 16)
+        self.assertEqual(len(smf.reports[0].upf_session_state), 0)
+        covered = sum(
+            r.bucket_end - r.bucket_start for r in smf.reports[0].range_digests
+        )
+        self.assertEqual(covered, SESSION_DIGEST_BUCKETS)
+
+    def test_only_drifted_ranges_are_listed(self):
+        versions = {teid: 2 for teid in range(1, 100001)}
+        smf = FakeSmf(dict(versions))
+        # The UPF missed an update of one session and lost another one
+        versions[10] = 1
+        del versions[50000]
+        resent = reconcile_sessions(self._upf_sessions(versions), smf)
+        self.assertEqual(resent, 2)
+        listed = sum(len(r.upf_session_state) for r in smf.reports)
+        self.assertLess(listed, 100)
+
+    def test_failed_report(self):
+        versions = {1: 1}
+        self.assertIsNone(
+            reconcile_sessions(self._upf_sessions(versions), lambda r: None),
+        )
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -11,6 +11,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 """
 
+import base64
+import hashlib
 import logging
 from typing import NamedTuple
 
@@ -22,6 +24,7 @@ from magma.subscriberdb.store.base import (
     DuplicateSubscriberError,
     SubscriberNotFoundError,
 )
+from orc8r.protos.digest_pb2 import Digest, LeafDigest, LeafDigests
 
 suci_profile_data = NamedTuple(
     'suci_profile_data', [
@@ -148,6 +151,46 @@ class SubscriberDBRpcServicer(subscriberdb_pb2_grpc.SubscriberDBServicer):
         )
         return response
 
+    def ListSubscriberDigests(self, request, context):  # pylint:disable=unused-argument
+        """
+        Return a digest of the subscription of each subscriber in the store
+        """
+        print_grpc(
+            request, self._print_grpc_payload,
+            "List Subscriber Digests Request:",
+        )
+        digests = []
+        for sid in self._store.list_subscribers():
+            try:
+                data = self._store.get_subscriber_data(sid)
+            except SubscriberNotFoundError:
+                # Deleted since listed
+                continue
+            digests.append(
+                LeafDigest(
+                    id=sid,
+                    digest=Digest(md5_base64_digest=_subscription_digest(data)),
+                ),
+            )
+        response = LeafDigests(digests=digests)
+        print_grpc(
+            response, self._print_grpc_payload,
+            "List Subscriber Digests Response:",
+        )
+        return response
+
+
+def _subscription_digest(data: subscriberdb_pb2.SubscriberData) -> str:
+    """
+    Digest of a subscriber, leaving out its state, e.g. the SEQ of its next
+    authentication vector
+    """
+    subscription = subscriberdb_pb2.SubscriberData()
+    subscription.CopyFrom(data)
+    subscription.ClearField('state')
+    md5 = hashlib.md5(subscription.SerializeToString(deterministic=True))
+    return base64.b64encode(md5.digest()).decode('ascii')
+
 
 class SuciProfileDBRpcServicer(subscriberdb_pb2_grpc.SuciProfileDBServicer):
     """
@@ -133,6 +133,40 @@ class RpcTests(unittest.TestCase):
             self._stub.UpdateSubscriber(update)
         self.assertEqual(err.exception.code(), grpc.StatusCode.NOT_FOUND)
 
+    def test_list_subscriber_digests(self):
+        """
+        Test if the digests change with the subscription but not the state
+        """
+        sid1 = SIDUtils.to_pb('IMSI1')
+        sid2 = SIDUtils.to_pb('IMSI2')
+        self._stub.AddSubscriber(SubscriberData(sid=sid1))
+        self._stub.AddSubscriber(SubscriberData(sid=sid2))
+
+        def digests():
+            return {
+                leaf.id: leaf.digest.md5_base64_digest
+                for leaf in self._stub.ListSubscriberDigests(Void()).digests
+            }
+        before = digests()
+        self.assertEqual(set(before), {'IMSI1', 'IMSI2'})
+
+        update = SubscriberUpdate()
+        update.data.sid.CopyFrom(sid1)
+        update.data.state.lte_auth_next_seq = 10
+        update.mask.paths.append('state.lte_auth_next_seq')
+        self._stub.UpdateSubscriber(update)
+        self.assertEqual(digests(), before)
+
+        update.data.lte.auth_key = b'\xab\xcd'
+        update.mask.paths.append('lte.auth_key')
+        self._stub.UpdateSubscriber(update)
+        after = digests()
+        self.assertNotEqual(after['IMSI1'], before['IMSI1'])
+        self.assertEqual(after['IMSI2'], before['IMSI2'])
+
+        self._stub.DeleteSubscriber(sid2)
+        self.assertEqual(set(digests()), {'IMSI1'})
+
 
 class RpcTestsSuciExt(unittest.TestCase):
     """
@@ -18,7 +18,7 @@ import socket
 
 from create_oai_certs import generate_mme_certs
 from generate_service_config import generate_template_config
-from lte.protos.mconfig.mconfigs_pb2 import MME
+from lte.protos.mconfig.mconfigs_pb2 import MME, SubscriberDB
 from magma.common.misc_utils import (
     IpPreference,
     get_if_ip_with_netmask,
@@ -407,6 +407,43 @@ def _get_amf_pointer(service_mconfig: object) -> str:
     return service_mconfig.amf_pointer or DEFAULT_NGAP_AMF_POINTER
 
 
+def _get_local_hss_config():
+    """
+    Get the local S6a HSS configuration of the MME. The OP, AMF and default
+    subscription profile are the ones of subscriberdb, so that the MME answers
+    as subscriberdb would.
+    """
+    enabled = get_service_config_value("mme", "s6a_local_hss", False)
+    if not enabled:
+        return {"s6a_local_hss": False}
+    subscriberdb_mconfig = load_service_mconfig("subscriberdb", SubscriberDB())
+    if "default" in subscriberdb_mconfig.sub_profiles:
+        default_profile = subscriberdb_mconfig.sub_profiles["default"]
+        max_ul_bit_rate = default_profile.max_ul_bit_rate
+        max_dl_bit_rate = default_profile.max_dl_bit_rate
+    else:
+        max_ul_bit_rate = get_service_config_value(
+            "subscriberdb", "default_max_ul_bit_rate", 2000000000,
+        )
+        max_dl_bit_rate = get_service_config_value(
+            "subscriberdb", "default_max_dl_bit_rate", 4000000000,
+        )
+    return {
+        "s6a_local_hss": True,
+        "s6a_local_hss_store_file": get_service_config_value(
+            "mme", "s6a_local_hss_store_file",
+            "/var/opt/magma/mme_subscribers.store",
+        ),
+        "s6a_local_hss_sync_interval_sec": get_service_config_value(
+            "mme", "s6a_local_hss_sync_interval_sec", 60,
+        ),
+        "s6a_local_hss_op": subscriberdb_mconfig.lte_auth_op.hex(),
+        "s6a_local_hss_amf": subscriberdb_mconfig.lte_auth_amf.hex() or "8000",
+        "s6a_local_hss_max_ul_bit_rate": max_ul_bit_rate,
+        "s6a_local_hss_max_dl_bit_rate": max_dl_bit_rate,
+    }
+
+
 def _get_context():
     """
     Create the context which has the interface IP and the OAI log level to use.
@@ -469,8 +506,13 @@ def _get_context():
         "amf_set_id": _get_amf_set_id(mme_service_config),
         "amf_pointer": _get_amf_pointer(mme_service_config),
         "default_dnn": _get_default_dnn_config(mme_service_config),
+        "suci_profiles": get_service_config_value(
+            "mme", "suci_profiles", [],
+        ),
     }
 
+    context.update(_get_local_hss_config())
+
     context["s1u_ip"] = mme_service_config.ipv4_sgw_s1u_addr or _get_iface_ip(
         "spgw", "s1u_iface_name",
     )
@@ -45,7 +45,6 @@ class Service;
 
 using grpc::InsecureServerCredentials;
 using grpc::Status;
-using io::prometheus::client::MetricFamily;
 using magma::orc8r::GetOperationalStatesResponse;
 using magma::orc8r::ReloadConfigResponse;
 using magma::orc8r::Service303;
@@ -146,15 +145,12 @@ Status MagmaService::StopService(__attribute__((unused)) ServerContext* context,
 Status MagmaService::GetMetrics(__attribute__((unused)) ServerContext* context,
                                 __attribute__((unused)) const Void* request,
                                 MetricsContainer* response) {
+  steady_clock::time_point scrape_start = steady_clock::now();
   // Set all common metrics
   setSharedMetrics();
 
-  MetricsSingleton& instance = MetricsSingleton::Instance();
-  const std::vector<MetricFamily>& collected = instance.registry_->Collect();
-  for (auto it = collected.begin(); it != collected.end(); it++) {
-    MetricFamily* family = response->add_family();
-    family->CopyFrom(*it);
-  }
+  MetricsSingleton::Instance().Collect(response);
+  setScrapeDuration(steady_clock::now() - scrape_start);
   return Status::OK;
 }
 
@@ -240,3 +236,10 @@ void MagmaService::setMemoryUsage() {
   MetricsSingleton::Instance().SetGauge("process_resident_memory_bytes",
                                         mem_info.physical_mem, 0, ap);
 }
+
+void MagmaService::setScrapeDuration(steady_clock::duration duration) {
+  va_list ap;
+  MetricsSingleton::Instance().SetGauge(
+      "metrics_scrape_duration_seconds",
+      duration_cast<std::chrono::duration<double>>(duration).count(), 0, ap);
+}
@@ -76,3 +76,7 @@ void observe_histogram(const char* name, double observation, size_t n_labels,
                                                 ap);
   va_end(ap);
 }
+
+void set_metric_max_label_sets(const char* name, size_t max_label_sets) {
+  MetricsSingleton::Instance().SetMaxLabelSets(name, max_label_sets);
+}
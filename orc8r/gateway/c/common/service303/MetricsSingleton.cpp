@@ -121,3 +121,16 @@ void MetricsSingleton::ObserveHistogram(const char* name, double observation,
   histograms_.Get(name, labels, Histogram::BucketBoundaries(boundaries))
       .Observe(observation);
 }
+
+void MetricsSingleton::SetMaxLabelSets(const char* name,
+                                       size_t max_label_sets) {
+  counters_.SetMaxLabelSets(name, max_label_sets);
+  gauges_.SetMaxLabelSets(name, max_label_sets);
+  histograms_.SetMaxLabelSets(name, max_label_sets);
+}
+
+void MetricsSingleton::Collect(MetricsContainer* container) {
+  counters_.Collect(container);
+  gauges_.Collect(container);
+  histograms_.Collect(container);
+}
@@ -154,7 +154,9 @@ class MagmaService final : public Service303::Service {
 
   /*
    * Collects timeseries samples from prometheus client interface on this
-   * process
+   * process. Families are serialized one at a time straight into the
+   * response, and the time it takes is reported by the next scrape as
+   * metrics_scrape_duration_seconds.
    *
    * @param context: the grpc Server context
    * @param request: void request param
@@ -227,6 +229,11 @@ class MagmaService final : public Service303::Service {
    */
   void setMemoryUsage();
 
+  /*
+   * Helper function to set the metrics_scrape_duration_seconds in metrics
+   */
+  void setScrapeDuration(std::chrono::steady_clock::duration duration);
+
  private:
   const std::string name_;
   const std::string version_;
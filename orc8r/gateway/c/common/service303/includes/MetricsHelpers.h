@@ -90,6 +90,14 @@ double get_gauge(const char* name, size_t n_labels, ...);
 void observe_histogram(const char* name, double observation, size_t n_labels,
                        ...);
 
+/**
+ * Bounds the label sets of a metric, 10000 by default. Further label sets
+ * share a single instance with every label value set to "overflow".
+ * @param name
+ * @param max_label_sets label sets kept before the overflow instance
+ */
+void set_metric_max_label_sets(const char* name, size_t max_label_sets);
+
 #ifdef __cplusplus
 }
 #endif
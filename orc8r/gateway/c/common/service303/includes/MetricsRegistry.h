@@ -22,10 +22,13 @@
 #include <cstddef>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 namespace prometheus {
 class Registry;
@@ -44,12 +47,20 @@ using namespace orc8r;
  * MetricsRegistry is a dictionary for metrics instances. It ensures we
  * constuct a single instance of a metric family per name and a single
  * instance for each label set in that family.
+ *
+ * The label sets of a family are bounded. Once a family holds its maximum,
+ * further label sets share a single overflow instance, with every label value
+ * set to OVERFLOW_LABEL_VALUE.
  */
 template <typename T, typename MetricFamilyFactory>
 class MetricsRegistry {
  public:
+  static constexpr std::size_t DEFAULT_MAX_LABEL_SETS = 10000;
+  static constexpr const char* OVERFLOW_LABEL_VALUE = "overflow";
+
   MetricsRegistry(const std::shared_ptr<prometheus::Registry>& registry,
-                  const MetricFamilyFactory& factory);
+                  const MetricFamilyFactory& factory,
+                  std::size_t default_max_label_sets = DEFAULT_MAX_LABEL_SETS);
 
   /**
    * Get or create a metric instance matching this name and label set
@@ -71,9 +82,29 @@ class MetricsRegistry {
   void Remove(const std::string& name,
               const std::map<std::string, std::string>& labels);
 
-  const std::size_t SizeFamilies() { return families_.size(); }
+  /**
+   * Bound the label sets of a family, instances created above the new bound
+   * are kept
+   * @param name: the metric name
+   * @param max_label_sets: label sets kept before the overflow instance
+   */
+  void SetMaxLabelSets(const std::string& name, std::size_t max_label_sets);
+
+  /**
+   * Collect the families one at a time straight into the container, without
+   * materializing the whole registry first
+   */
+  void Collect(MetricsContainer* container);
+
+  const std::size_t SizeFamilies() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return families_.size();
+  }
 
-  const std::size_t SizeMetrics() { return metrics_.size(); }
+  const std::size_t SizeMetrics() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return metrics_.size();
+  }
 
  private:
   static std::size_t hash_name_and_labels(
@@ -82,23 +113,43 @@ class MetricsRegistry {
   // Convert labels to enums if applicable
   static void parse_labels(const std::map<std::string, std::string>& labels,
                            std::map<std::string, std::string>& parsed_labels);
+  // Get the label set limit of a family, must be called with mutex_ held
+  std::size_t get_max_label_sets(std::size_t name_hash);
   std::unordered_map<std::size_t, Family<T>*> families_;
   std::unordered_map<std::size_t, T*> metrics_;
+  // Label sets of each family, overflow instances excluded
+  std::unordered_map<std::size_t, std::size_t> label_sets_;
+  std::unordered_map<std::size_t, std::size_t> max_label_sets_;
+  std::unordered_set<std::size_t> overflow_metrics_;
+  const std::size_t default_max_label_sets_;
   const std::shared_ptr<prometheus::Registry>& registry_;
   const MetricFamilyFactory& factory_;
+  // Metrics are updated from any thread and collected from the service thread
+  std::mutex mutex_;
 };
 
+template <typename T, typename MetricFamilyFactory>
+constexpr std::size_t
+    MetricsRegistry<T, MetricFamilyFactory>::DEFAULT_MAX_LABEL_SETS;
+
+template <typename T, typename MetricFamilyFactory>
+constexpr const char*
+    MetricsRegistry<T, MetricFamilyFactory>::OVERFLOW_LABEL_VALUE;
+
 template <typename T, typename MetricFamilyFactory>
 MetricsRegistry<T, MetricFamilyFactory>::MetricsRegistry(
     const std::shared_ptr<prometheus::Registry>& registry,
-    const MetricFamilyFactory& factory)
-    : registry_(registry), factory_(factory) {}
+    const MetricFamilyFactory& factory, std::size_t default_max_label_sets)
+    : default_max_label_sets_(default_max_label_sets),
+      registry_(registry),
+      factory_(factory) {}
 
 template <typename T, typename MetricFamilyFactory>
 template <typename... Args>
 T& MetricsRegistry<T, MetricFamilyFactory>::Get(
     const std::string& name, const std::map<std::string, std::string>& labels,
     Args&&... args) {
+  std::lock_guard<std::mutex> lock(mutex_);
   // Create the family if we haven't seen it before
   Family<T>* family;
   size_t name_hash = std::hash<std::string>{}(name);
@@ -120,19 +171,40 @@ T& MetricsRegistry<T, MetricFamilyFactory>::Get(
   size_t metric_hash = hash_name_and_labels(name, labels);
   auto metric_it = metrics_.find(metric_hash);
   if (metric_it != metrics_.end()) {
-    metric = metric_it->second;
-  } else {
+    return *metric_it->second;
+  }
+
+  auto& label_sets = label_sets_[name_hash];
+  if (label_sets < get_max_label_sets(name_hash)) {
     std::map<std::string, std::string> converted_labels;
     parse_labels(labels, converted_labels);
     metric = &family->Add(converted_labels, std::forward<Args>(args)...);
     metrics_.insert({{metric_hash, metric}});
+    label_sets++;
+    return *metric;
   }
+
+  std::map<std::string, std::string> overflow_labels;
+  for (const auto& label_pair : labels) {
+    overflow_labels[label_pair.first] = OVERFLOW_LABEL_VALUE;
+  }
+  size_t overflow_hash = hash_name_and_labels(name, overflow_labels);
+  metric_it = metrics_.find(overflow_hash);
+  if (metric_it != metrics_.end()) {
+    return *metric_it->second;
+  }
+  std::map<std::string, std::string> converted_labels;
+  parse_labels(overflow_labels, converted_labels);
+  metric = &family->Add(converted_labels, std::forward<Args>(args)...);
+  metrics_.insert({{overflow_hash, metric}});
+  overflow_metrics_.insert(overflow_hash);
   return *metric;
 }
 
 template <typename T, typename MetricFamilyFactory>
 void MetricsRegistry<T, MetricFamilyFactory>::Remove(
     const std::string& name, const std::map<std::string, std::string>& labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
   Family<T>* family;
   size_t name_hash = std::hash<std::string>{}(name);
   auto family_it = families_.find(name_hash);
@@ -150,6 +222,43 @@ void MetricsRegistry<T, MetricFamilyFactory>::Remove(
   metric = metric_it->second;
   family->Remove(metric);
   metrics_.erase(metric_hash);
+  if (overflow_metrics_.erase(metric_hash) == 0) {
+    label_sets_[name_hash]--;
+  }
+}
+
+template <typename T, typename MetricFamilyFactory>
+void MetricsRegistry<T, MetricFamilyFactory>::SetMaxLabelSets(
+    const std::string& name, std::size_t max_label_sets) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_label_sets_[std::hash<std::string>{}(name)] = max_label_sets;
+}
+
+template <typename T, typename MetricFamilyFactory>
+std::size_t MetricsRegistry<T, MetricFamilyFactory>::get_max_label_sets(
+    std::size_t name_hash) {
+  auto it = max_label_sets_.find(name_hash);
+  return it != max_label_sets_.end() ? it->second : default_max_label_sets_;
+}
+
+template <typename T, typename MetricFamilyFactory>
+void MetricsRegistry<T, MetricFamilyFactory>::Collect(
+    MetricsContainer* container) {
+  // Families are never removed, they are collected without holding mutex_ so
+  // that metrics can still be updated meanwhile
+  std::vector<Family<T>*> families;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    families.reserve(families_.size());
+    for (const auto& family_pair : families_) {
+      families.push_back(family_pair.second);
+    }
+  }
+  for (auto* family : families) {
+    for (auto& collected : family->Collect()) {
+      container->add_family()->Swap(&collected);
+    }
+  }
 }
 
 template <typename T, typename MetricFamilyFactory>
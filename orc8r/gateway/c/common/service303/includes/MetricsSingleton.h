@@ -104,6 +104,10 @@ class MetricsSingleton {
   void ObserveHistogram(const char* name, double observation,
                         size_t label_count, va_list& args);
   double GetGauge(const char* name, size_t label_count, va_list& args);
+  // Bound the label sets of the counter, gauge or histogram with this name
+  void SetMaxLabelSets(const char* name, size_t max_label_sets);
+  // Collect all metrics into the container
+  void Collect(MetricsContainer* container);
 
  private:
   MetricsSingleton();                         // Prevent construction
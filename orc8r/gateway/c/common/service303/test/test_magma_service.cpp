@@ -12,7 +12,13 @@
  */
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "orc8r/gateway/c/common/service303/ProcFileUtils.h"
 #include "orc8r/gateway/c/common/service303/includes/MagmaService.h"
+#include "orc8r/gateway/c/common/service303/includes/MetricsHelpers.h"
 
 using ::testing::Test;
 
@@ -107,6 +113,58 @@ TEST(test_magma_service, test_ReloadServiceConfig) {
   EXPECT_EQ(response.result(), ReloadConfigResponse::RELOAD_UNSUPPORTED);
 }
 
+// Scrape with per-subscriber labels above the label set limit
+TEST(test_magma_service, test_GetMetrics_bounded_label_sets) {
+  const size_t label_sets = 100000, max_label_sets = 1000;
+  const char* name = "test_subscriber_bytes";
+  MagmaService magma_service(SERVICE_NAME, SERVICE_VERSION);
+  set_metric_max_label_sets(name, max_label_sets);
+  for (size_t i = 0; i < label_sets; i++) {
+    increment_counter(name, 1, 1, "imsi", std::to_string(i).c_str());
+  }
+
+  auto memory_before = ProcFileUtils::getMemoryInfo().physical_mem;
+  auto scrape_start = std::chrono::steady_clock::now();
+  MetricsContainer response;
+  magma_service.GetMetrics(nullptr, nullptr, &response);
+  auto scrape_duration = std::chrono::steady_clock::now() - scrape_start;
+  auto memory_growth =
+      ProcFileUtils::getMemoryInfo().physical_mem - memory_before;
+  std::cout << "Scraped " << response.ByteSizeLong() << " bytes in "
+            << std::chrono::duration_cast<std::chrono::microseconds>(
+                   scrape_duration)
+                   .count()
+            << "us, resident memory grew by " << memory_growth << " bytes"
+            << std::endl;
+
+  bool found = false;
+  for (const auto& family : response.family()) {
+    if (family.name() != name) {
+      continue;
+    }
+    found = true;
+    ASSERT_EQ(family.metric_size(), max_label_sets + 1);
+    double total = 0;
+    for (const auto& metric : family.metric()) {
+      total += metric.counter().value();
+    }
+    EXPECT_EQ(total, label_sets);
+  }
+  EXPECT_TRUE(found);
+  // Bounded by the label set limit, not by the label sets seen
+  EXPECT_LT(response.ByteSizeLong(), 1 << 20);
+  EXPECT_LT(memory_growth, 16 << 20);
+
+  // The scrape reports its own duration on the next one
+  response.Clear();
+  magma_service.GetMetrics(nullptr, nullptr, &response);
+  found = false;
+  for (const auto& family : response.family()) {
+    found |= family.name() == "metrics_scrape_duration_seconds";
+  }
+  EXPECT_TRUE(found);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
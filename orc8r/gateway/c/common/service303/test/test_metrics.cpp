@@ -14,8 +14,10 @@
 #include <gtest/gtest.h>
 #include "orc8r/gateway/c/common/service303/includes/MetricsRegistry.h"
 #include <prometheus/registry.h>
+#include <string>
 
 using io::prometheus::client::MetricFamily;
+using magma::orc8r::MetricsContainer;
 using magma::service303::MetricsRegistry;
 using prometheus::BuildCounter;
 using prometheus::Registry;
@@ -27,7 +29,7 @@ namespace magma {
 // Tests the MetricsRegistry properly initializes and retrieves metrics
 TEST_F(Test, test_metrics_registry) {
   auto prometheus_registry = std::make_shared<Registry>();
-  auto registry = MetricsRegistry<prometheus::Counter, CounterBuilder (&)()>(
+  MetricsRegistry<prometheus::Counter, CounterBuilder (&)()> registry(
       prometheus_registry, BuildCounter);
   EXPECT_EQ(registry.SizeFamilies(), 0);
   EXPECT_EQ(registry.SizeMetrics(), 0);
@@ -50,6 +52,42 @@ TEST_F(Test, test_metrics_registry) {
   EXPECT_EQ(registry.SizeMetrics(), 4);
 }
 
+// Tests label sets above the limit of a family share an overflow instance
+TEST_F(Test, test_metrics_registry_max_label_sets) {
+  auto prometheus_registry = std::make_shared<Registry>();
+  MetricsRegistry<prometheus::Counter, CounterBuilder (&)()> registry(
+      prometheus_registry, BuildCounter, 2);
+  registry.SetMaxLabelSets("bounded", 3);
+
+  for (int i = 0; i < 5; i++) {
+    registry.Get("test", {{"key", std::to_string(i)}}).Increment();
+    registry.Get("bounded", {{"key", std::to_string(i)}}).Increment();
+  }
+  // Limit + 1 overflow instance per family
+  EXPECT_EQ(registry.SizeFamilies(), 2);
+  EXPECT_EQ(registry.SizeMetrics(), 7);
+  auto& overflow = registry.Get("test", {{"key", "overflow"}});
+  EXPECT_EQ(&overflow, &registry.Get("test", {{"key", "5"}}));
+  EXPECT_EQ(overflow.Value(), 3);
+
+  // Removing a label set makes room for a new one
+  registry.Remove("test", {{"key", "0"}});
+  auto& counter = registry.Get("test", {{"key", "6"}});
+  EXPECT_NE(&counter, &overflow);
+  // The overflow instance does not count against the limit
+  registry.Remove("test", {{"key", "overflow"}});
+  EXPECT_EQ(registry.SizeMetrics(), 6);
+  EXPECT_NE(&registry.Get("test", {{"key", "7"}}), &counter);
+  EXPECT_EQ(registry.SizeMetrics(), 7);
+
+  MetricsContainer container;
+  registry.Collect(&container);
+  ASSERT_EQ(container.family_size(), 2);
+  for (const auto& family : container.family()) {
+    EXPECT_EQ(family.metric_size(), family.name() == "test" ? 3 : 4);
+  }
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();